@@ -0,0 +1,244 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <unordered_set>
+
+namespace dxvk {
+
+  enum class ShaderFlags {
+    None = 0,
+    UI_Hook = 1 << 0
+  };
+
+  constexpr ShaderFlags operator~(ShaderFlags a) {
+    return static_cast<ShaderFlags>(~static_cast<uint32_t>(a));
+  }
+  inline ShaderFlags& operator&=(ShaderFlags& a, ShaderFlags b) {
+    return reinterpret_cast<ShaderFlags&>(reinterpret_cast<uint32_t&>(a) &= static_cast<uint32_t>(b));
+  }
+  constexpr ShaderFlags operator&(ShaderFlags a, ShaderFlags b) {
+    return static_cast<ShaderFlags>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+  }
+  inline ShaderFlags& operator|=(ShaderFlags& a, ShaderFlags b) {
+    return reinterpret_cast<ShaderFlags&>(reinterpret_cast<uint32_t&>(a) |= static_cast<uint32_t>(b));
+  }
+  constexpr ShaderFlags operator|(ShaderFlags a, ShaderFlags b) {
+    return static_cast<ShaderFlags>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+  }
+  inline ShaderFlags& operator^=(ShaderFlags& a, ShaderFlags b) {
+    return reinterpret_cast<ShaderFlags&>(reinterpret_cast<uint32_t&>(a) ^= static_cast<uint32_t>(b));
+  }
+  constexpr ShaderFlags operator^(ShaderFlags a, ShaderFlags b) {
+    return static_cast<ShaderFlags>(static_cast<uint32_t>(a) ^ static_cast<uint32_t>(b));
+  }
+
+  enum class ShaderType {
+    Vertex = 0,
+    Pixel = 1,
+    Count = 2,
+  };
+
+  /**
+   * \brief Registers of the semantics in one shader
+   *
+   * Resolved from the constant table of the shader when it is
+   * created, see \c D3D9ConstantSemanticTable. Semantics the
+   * constant table doesn't name keep their default register.
+   */
+  class D3D9ShaderSemantics {
+
+  public:
+
+    static constexpr uint32_t MaxSemantics = 32;
+
+    D3D9ShaderSemantics() {
+      m_registers.fill(Unresolved);
+    }
+
+    bool isResolved(uint32_t semantic) const {
+      return m_registers[semantic] != Unresolved;
+    }
+
+    uint32_t getRegister(uint32_t semantic, uint32_t defaultRegister) const {
+      return isResolved(semantic) ? m_registers[semantic] : defaultRegister;
+    }
+
+    void setRegister(uint32_t semantic, uint32_t reg) {
+      m_registers[semantic] = uint16_t(reg);
+    }
+
+  private:
+
+    static constexpr uint16_t Unresolved = 0xFFFF;
+
+    std::array<uint16_t, MaxSemantics> m_registers;
+
+  };
+
+  struct ShaderDesc
+  {
+    // vs_3_0 has the most float constant registers
+    static constexpr uint32_t MaxConstantRegisters = 256;
+    using ConstantMask = std::bitset<MaxConstantRegisters>;
+
+    ShaderFlags flags = ShaderFlags::None;
+    bool activated = true;
+
+    bool bindedWorldMatrix = false;
+    std::unordered_set<uint32_t> constantVs;
+    std::unordered_set<uint32_t> constantPs;
+
+    // Bit masks of constantVs and constantPs, see updateConstantMasks
+    ConstantMask constantVsMask;
+    ConstantMask constantPsMask;
+
+    D3D9ShaderSemantics semantics;
+
+    // Frame generation in which the shader was last bound, 0 if never
+    uint32_t boundGeneration = 0;
+
+    // Has to be called whenever constantVs or constantPs change
+    void updateConstantMasks() {
+      constantVsMask = getMask(constantVs);
+      constantPsMask = getMask(constantPs);
+    }
+
+  private:
+    static ConstantMask getMask(const std::unordered_set<uint32_t>& constants) {
+      ConstantMask mask;
+      for (uint32_t constant : constants) {
+        if (constant < MaxConstantRegisters)
+          mask.set(constant);
+      }
+      return mask;
+    }
+  };
+
+  /**
+   * \brief Descriptor of a bound shader
+   *
+   * Copied from the \c ShaderDesc when the shader is bound, so
+   * that the queries made for every draw don't need any lookup.
+   */
+  struct BoundShader {
+    ShaderDesc*              desc = nullptr;
+    uint32_t                 hash = 0;
+    ShaderFlags              flags = ShaderFlags::None;
+    bool                     activated = true;
+    bool                     bindedWorldMatrix = false;
+    ShaderDesc::ConstantMask constants;
+    D3D9ShaderSemantics      semantics;
+  };
+
+  /**
+   * \brief Bound vertex and pixel shader descriptors
+   *
+   * Also tracks which shaders were bound in the current frame: each
+   * frame has a generation number, binding a shader stamps it into
+   * the descriptor, so starting a frame doesn't need to clear anything.
+   */
+  class BoundShaders {
+
+  public:
+
+    /**
+     * \brief Binds a shader
+     *
+     * \param [in] type Shader stage
+     * \param [in] hash Shader hash, 0 for unknown shaders
+     * \param [in] desc Shader descriptor, may be \c nullptr
+     */
+    void bind(ShaderType type, uint32_t hash, ShaderDesc* desc) {
+      BoundShader& bound = m_bound[(uint32_t) type];
+      bound.desc = desc;
+      bound.hash = hash;
+
+      if (desc != nullptr)
+        desc->boundGeneration = m_generation;
+
+      resolve(type);
+    }
+
+    /**
+     * \brief Starts a new frame
+     *
+     * Shaders only count as bound in the new frame once they are
+     * bound again. Also picks up changes made to the descriptors
+     * of the bound shaders, e.g. from the developer menu.
+     */
+    void nextFrame() {
+      ++m_generation;
+
+      for (uint32_t i = 0; i < (uint32_t) ShaderType::Count; ++i)
+        resolve((ShaderType) i);
+    }
+
+    const BoundShader& get(ShaderType type) const {
+      return m_bound[(uint32_t) type];
+    }
+
+    bool isActivated() const {
+      return m_bound[0].activated && m_bound[1].activated;
+    }
+
+    bool hasConstant(uint32_t constant, ShaderType type) const {
+      return constant < ShaderDesc::MaxConstantRegisters
+          && m_bound[(uint32_t) type].constants.test(constant);
+    }
+
+    bool hasFlag(ShaderFlags flags) const {
+      return ((m_bound[0].flags | m_bound[1].flags) & flags) != ShaderFlags::None;
+    }
+
+    bool isWorldBinded() const {
+      return m_bound[0].bindedWorldMatrix || m_bound[1].bindedWorldMatrix;
+    }
+
+    /**
+     * \brief Marks the bound shader as binding the world matrix
+     */
+    void setWorldBinded(ShaderType type) {
+      BoundShader& bound = m_bound[(uint32_t) type];
+
+      if (bound.desc != nullptr) {
+        bound.desc->bindedWorldMatrix = true;
+        bound.bindedWorldMatrix = true;
+      }
+    }
+
+    /**
+     * \brief Checks whether a shader was bound in the current frame
+     */
+    bool wasBoundThisFrame(const ShaderDesc& desc) const {
+      return desc.boundGeneration == m_generation;
+    }
+
+  private:
+
+    void resolve(ShaderType type) {
+      BoundShader& bound = m_bound[(uint32_t) type];
+
+      if (bound.desc != nullptr) {
+        bound.flags = bound.desc->flags;
+        bound.activated = bound.desc->activated;
+        bound.bindedWorldMatrix = bound.desc->bindedWorldMatrix;
+        bound.constants = type == ShaderType::Vertex
+          ? bound.desc->constantVsMask
+          : bound.desc->constantPsMask;
+        bound.semantics = bound.desc->semantics;
+      } else {
+        bound.flags = ShaderFlags::None;
+        bound.activated = true;
+        bound.bindedWorldMatrix = false;
+        bound.constants.reset();
+        bound.semantics = D3D9ShaderSemantics();
+      }
+    }
+
+    BoundShader m_bound[(uint32_t) ShaderType::Count];
+
+    uint32_t    m_generation = 1;
+  };
+
+}
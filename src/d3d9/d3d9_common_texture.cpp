@@ -6,6 +6,7 @@
 #include <d3d9types.h>
 
 #include "../util/util_shared_res.h"
+#include "../util/util_fastops.h"
 
 #include <algorithm>
 #include <iostream>
@@ -93,8 +94,11 @@ namespace dxvk {
     if (m_size != 0)
       m_device->ChangeReportedMemory(m_size);
 
+    // A texture still waiting for its hash was never registered with ImGUI
+    const bool registered = m_pendingImGuiHash == nullptr || !m_device->RTX().RemovePendingTexture(this);
+
     // Release this texture from ImGUI 
-    if (m_image != nullptr) {
+    if (m_image != nullptr && registered) {
       if (m_image->getHash() != 0) {
         ImGUI::ReleaseTexture(m_image->getHash());
       }
@@ -660,7 +664,7 @@ namespace dxvk {
     if (m_type != D3DRTYPE_TEXTURE || (m_desc.Usage & D3DUSAGE_DEPTHSTENCIL))
       return;
 
-    if (m_image->getHash() != 0) {
+    if (m_image->hasHash()) {
       // Already setup.
       return;
     }
@@ -677,23 +681,31 @@ namespace dxvk {
       RtxOptions::Get()->shouldUseObsoleteHashOnTextureUpload();
 
     // Generate hash from CPU buffer
-    XXH64_hash_t imageHash;
-
     if (unlikely(useObsoleteHashMethod)) {
-      imageHash = XXH64(buffer->mapPtr(0), buffer->info().size, 0);
+      m_image->setHash(XXH64(buffer->mapPtr(0), buffer->info().size, 0));
     } else {
-      imageHash = XXH3_64bits(buffer->mapPtr(0), buffer->info().size);
+      // Large textures are hashed on the texture hashing threads, only the first use of the hash waits for it
+      Rc<DxvkPendingHash> pendingHash = m_device->RTX().HashTextureAsync(buffer);
+
+      if (pendingHash != nullptr) {
+        m_image->setPendingHash(pendingHash);
+        // Several textures may be uploaded from the same source before it is written again,
+        // keep every job that is still reading the buffer and drop the finished ones
+        auto& sourceHashes = source->m_pendingBufferHashes;
+        sourceHashes.erase(std::remove_if(sourceHashes.begin(), sourceHashes.end(),
+          [](const Rc<DxvkPendingHash>& hash) { return hash->isReady(); }), sourceHashes.end());
+        sourceHashes.push_back(pendingHash);
+        m_pendingImGuiHash = pendingHash;
+        m_device->RTX().AddPendingTexture(this);
+      } else {
+        m_image->setHash(fast::parallel_XXH3_64bits(buffer->mapPtr(0), buffer->info().size));
+      }
     }
-    // save hash to dxvkImage
-    m_image->setHash(imageHash);
 
     // Let ImGUI know about this texture
-    // MHFZ start : gather original crc 32 hash from D3D9 common texture and send it to ImGui
-    uint32_t hash = m_device->GetLegacyManager().getTextureHash(this);
-    uint32_t origin = m_device->GetLegacyManager().getTextureOrigin(this);
-    LegacyMaterialLayer* legacyMaterialLayer = m_device->GetLegacyManager().getLegacyMaterialLayer(this);
-    ImGUI::AddTexture(imageHash, m_sampleView.Color, ImGUI::kTextureFlagsDefault, legacyMaterialLayer, hash, origin);
-    // MHFZ end
+    if (m_pendingImGuiHash == nullptr)
+      RegisterWithImGui();
+
     if (IsRenderTarget()) {
       // Generate descriptor hash from the image properties (not including actual pixel data)
       XXH64_hash_t descriptorHash = m_desc.CalculateHash();
@@ -704,6 +716,24 @@ namespace dxvk {
     }
   }
 
+  bool D3D9CommonTexture::TryRegisterWithImGui() {
+    if (!m_pendingImGuiHash->isReady())
+      return false;
+
+    m_pendingImGuiHash = nullptr;
+    RegisterWithImGui();
+    return true;
+  }
+
+  void D3D9CommonTexture::RegisterWithImGui() {
+    // MHFZ start : gather original crc 32 hash from D3D9 common texture and send it to ImGui
+    uint32_t hash = m_device->GetLegacyManager().getTextureHash(this);
+    uint32_t origin = m_device->GetLegacyManager().getTextureOrigin(this);
+    LegacyMaterialLayer* legacyMaterialLayer = m_device->GetLegacyManager().getLegacyMaterialLayer(this);
+    ImGUI::AddTexture(m_image->getHash(), m_sampleView.Color, ImGUI::kTextureFlagsDefault, legacyMaterialLayer, hash, origin);
+    // MHFZ end
+  }
+
   void D3D9CommonTexture::SetupForRtx() {
     SetupForRtxFrom(this);
   }
@@ -409,6 +409,26 @@ namespace dxvk {
 
     void SetupForRtx();
     void SetupForRtxFrom(const D3D9CommonTexture* source);
+
+    /**
+     * \brief Registers the texture with ImGUI if its hash is ready
+     * \returns \c true if the texture was registered
+     */
+    bool TryRegisterWithImGui();
+
+    /**
+     * \brief Waits for all hashing jobs that read the first subresource buffer
+     *
+     * Must be called before the buffer is written again.
+     */
+    void WaitForPendingHash() const {
+      if (unlikely(!m_pendingBufferHashes.empty())) {
+        for (const auto& pendingHash : m_pendingBufferHashes)
+          pendingHash->wait();
+
+        m_pendingBufferHashes.clear();
+      }
+    }
     
     void AddDirtyBox(CONST D3DBOX* pDirtyBox, uint32_t layer) {
       if (pDirtyBox) {
@@ -523,6 +543,14 @@ namespace dxvk {
 
     std::array<D3DBOX, 6>         m_dirtyBoxes;
 
+    // Hashing jobs reading m_buffers[0], these may hash other textures uploaded from this one
+    mutable std::vector<Rc<DxvkPendingHash>> m_pendingBufferHashes;
+
+    // Hash of m_image that has to be ready before the texture is registered with ImGUI
+    Rc<DxvkPendingHash>           m_pendingImGuiHash;
+
+    void RegisterWithImGui();
+
     /**
      * \brief Mip level
      * \returns Size of packed mip level in bytes
@@ -0,0 +1,215 @@
+#include "d3d9_constant_semantics.h"
+
+#include <cmath>
+#include <iterator>
+#include <sstream>
+
+#include "../util/log/log.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+
+  namespace {
+    const char* const RoleNames[uint32_t(D3D9ConstantRole::Count)] = {
+      "fadeColor",
+      "materialDiffuse",
+      "materialAlbedo",
+      "ambientColor",
+      "materialPower",
+      "depthView",
+      "lightDirection",
+      "worldMatrix",
+      "worldTransform",
+    };
+
+    const char* const CombineNames[] = {
+      "none",
+      "multiply",
+      "powW",
+    };
+
+    // vs_3_0 has the most float constant registers
+    constexpr uint32_t MaxRegisters = 256;
+
+    std::vector<std::string> split(const std::string& str, char delimiter) {
+      std::vector<std::string> result;
+      std::stringstream stream(str);
+      std::string item;
+
+      while (std::getline(stream, item, delimiter))
+        result.push_back(item);
+
+      // getline drops a trailing empty field
+      if (!str.empty() && str.back() == delimiter)
+        result.push_back(std::string());
+
+      return result;
+    }
+
+    std::string trim(const std::string& str) {
+      const size_t begin = str.find_first_not_of(" \t\r\n");
+
+      if (begin == std::string::npos)
+        return std::string();
+
+      return str.substr(begin, str.find_last_not_of(" \t\r\n") - begin + 1);
+    }
+
+    bool parseRole(const std::string& str, D3D9ConstantRole& role) {
+      for (uint32_t i = 0; i < uint32_t(D3D9ConstantRole::Count); i++) {
+        if (str == RoleNames[i]) {
+          role = D3D9ConstantRole(i);
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool parseCombine(const std::string& str, D3D9ConstantCombine& combine) {
+      for (uint32_t i = 0; i < std::size(CombineNames); i++) {
+        if (str == CombineNames[i]) {
+          combine = D3D9ConstantCombine(i);
+          return true;
+        }
+      }
+      return false;
+    }
+
+    bool parseStages(const std::string& str, uint32_t& stages) {
+      stages = 0;
+
+      for (const std::string& stage : split(str, '|')) {
+        if (stage == "vs")
+          stages |= D3D9ConstantStages::Vertex;
+        else if (stage == "ps")
+          stages |= D3D9ConstantStages::Pixel;
+        else
+          return false;
+      }
+
+      return stages != 0;
+    }
+
+    bool parseRegister(const std::string& str, uint32_t& reg) {
+      if (str.empty() || str.find_first_not_of("0123456789") != std::string::npos || str.size() > 3)
+        return false;
+
+      reg = uint32_t(std::stoul(str));
+      return reg < MaxRegisters;
+    }
+
+    bool parseEntry(const std::string& str, D3D9ConstantSemantic& entry) {
+      std::vector<std::string> fields = split(str, ',');
+
+      if (fields.size() != 5 && fields.size() != 6)
+        return false;
+
+      for (std::string& field : fields)
+        field = trim(field);
+
+      entry.name = fields[1];
+
+      if (!parseRole(fields[0], entry.role)
+       || !parseRegister(fields[2], entry.reg)
+       || !parseStages(fields[3], entry.stages)
+       || !parseCombine(fields[4], entry.combine))
+        return false;
+
+      entry.unlessRoles = 0;
+
+      if (fields.size() == 6) {
+        for (const std::string& name : split(fields[5], '|')) {
+          D3D9ConstantRole role;
+
+          if (!parseRole(name, role))
+            return false;
+
+          entry.unlessRoles |= 1u << uint32_t(role);
+        }
+      }
+
+      return true;
+    }
+  }
+
+
+  const char* D3D9ConstantSemanticTable::getDefaultString() {
+    return
+      "fadeColor,gFadeColor,2,vs,multiply;"
+      "materialDiffuse,gMaterialDiffuse,170,vs|ps,multiply;"
+      "materialAlbedo,gMaterialAlbedo,171,vs|ps,multiply;"
+      "ambientColor,gAmbientColor,1,vs,multiply,materialDiffuse|fadeColor;"
+      "materialPower,gMatPower,4,vs,powW;"
+      "depthView,gDepthView,186,vs,none;"
+      "lightDirection,,188,vs,none;"
+      "worldMatrix,,195,vs,none;"
+      "worldTransform,,38,vs,none;"
+      "worldTransform,,42,vs,none";
+  }
+
+
+  D3D9ConstantSemanticTable D3D9ConstantSemanticTable::parse(const std::string& str) {
+    D3D9ConstantSemanticTable table;
+
+    for (const std::string& item : split(str.empty() ? getDefaultString() : str, ';')) {
+      if (trim(item).empty())
+        continue;
+
+      D3D9ConstantSemantic entry;
+
+      if (!parseEntry(item, entry)) {
+        Logger::warn(str::format("D3D9ConstantSemanticTable: Ignoring malformed entry \"", item, "\""));
+        continue;
+      }
+
+      if (table.m_semantics.size() == D3D9ShaderSemantics::MaxSemantics) {
+        Logger::warn(str::format("D3D9ConstantSemanticTable: More than ", D3D9ShaderSemantics::MaxSemantics, " entries, ignoring \"", item, "\""));
+        continue;
+      }
+
+      table.m_semantics.push_back(std::move(entry));
+    }
+
+    return table;
+  }
+
+
+  D3D9ShaderSemantics D3D9ConstantSemanticTable::resolve(uint32_t stage, const std::vector<DxsoCtab::Constant>& constants) const {
+    D3D9ShaderSemantics result;
+
+    for (uint32_t i = 0; i < m_semantics.size(); i++) {
+      const D3D9ConstantSemantic& entry = m_semantics[i];
+
+      if (!(entry.stages & stage) || entry.name.empty())
+        continue;
+
+      for (const DxsoCtab::Constant& constant : constants) {
+        if (constant.name == entry.name && constant.registerIndex < MaxRegisters) {
+          result.setRegister(i, constant.registerIndex);
+          break;
+        }
+      }
+    }
+
+    return result;
+  }
+
+
+  void D3D9ConstantSemanticTable::combineValue(D3D9ConstantCombine combine, const float* value, float* color) {
+    switch (combine) {
+      case D3D9ConstantCombine::Multiply:
+        for (uint32_t i = 0; i < 4; i++)
+          color[i] *= value[i];
+        break;
+
+      case D3D9ConstantCombine::PowW:
+        for (uint32_t i = 0; i < 3; i++)
+          color[i] = std::pow(color[i], value[3]);
+        break;
+
+      default:
+        break;
+    }
+  }
+
+}
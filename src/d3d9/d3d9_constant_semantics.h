@@ -0,0 +1,165 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "d3d9_bound_shaders.h"
+
+#include "../dxso/dxso_ctab.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Meaning of a shader constant for the RTX material extraction
+   */
+  enum class D3D9ConstantRole : uint32_t {
+    FadeColor,
+    MaterialDiffuse,
+    MaterialAlbedo,
+    AmbientColor,
+    MaterialPower,
+    DepthView,
+    LightDirection,
+    WorldMatrix,
+    // Matrices that include the world transform, cleared along with it
+    WorldTransform,
+    Count
+  };
+
+  /**
+   * \brief How a constant is combined into the diffuse color
+   */
+  enum class D3D9ConstantCombine : uint32_t {
+    // Read by the code handling the role, e.g. matrices
+    None,
+    // Multiplies all four components
+    Multiply,
+    // Raises rgb to the power of w
+    PowW,
+  };
+
+  /**
+   * \brief Shader stages a semantic is looked up in
+   *
+   * Bit indices match \c ShaderType, the vertex
+   * shader is always looked at before the pixel shader.
+   */
+  namespace D3D9ConstantStages {
+    constexpr uint32_t Vertex = 1u << 0;
+    constexpr uint32_t Pixel  = 1u << 1;
+  }
+
+  /**
+   * \brief Maps a named shader constant to a role
+   */
+  struct D3D9ConstantSemantic {
+    D3D9ConstantRole    role = D3D9ConstantRole::Count;
+    D3D9ConstantCombine combine = D3D9ConstantCombine::None;
+    // Name in the constant table, empty to only match by register
+    std::string         name;
+    // Register used when the constant table doesn't name the constant
+    uint32_t            reg = 0;
+    uint32_t            stages = 0;
+    // Roles that, when bound in the same stage, skip this semantic
+    uint32_t            unlessRoles = 0;
+  };
+
+  /**
+   * \brief Table of the shader constants the RTX material extraction reads
+   *
+   * Parsed from a string of entries separated by \c ';', each being
+   * \c role,name,register,stages,combine[,unless], e.g.
+   * \c ambientColor,gAmbientColor,1,vs,multiply,materialDiffuse|fadeColor.
+   * Stages are \c vs, \c ps or \c vs|ps, the name may be empty to match
+   * the register only. Materials are combined in the order of the table.
+   */
+  class D3D9ConstantSemanticTable {
+
+  public:
+
+    /**
+     * \brief Table matching the constants of the MHFZ shaders
+     */
+    static const char* getDefaultString();
+
+    /**
+     * \brief Parses a table
+     *
+     * Malformed entries are skipped with a warning.
+     * \param [in] str Table string, the default table if empty
+     */
+    static D3D9ConstantSemanticTable parse(const std::string& str);
+
+    const std::vector<D3D9ConstantSemantic>& getSemantics() const {
+      return m_semantics;
+    }
+
+    /**
+     * \brief Resolves the registers of the semantics in a shader
+     *
+     * \param [in] stage Stage bit of the shader
+     * \param [in] constants Constant table of the shader
+     */
+    D3D9ShaderSemantics resolve(uint32_t stage, const std::vector<DxsoCtab::Constant>& constants) const;
+
+    /**
+     * \brief Combines the material semantics into a color
+     *
+     * \param [in,out] color RGBA color to combine into
+     * \param [in] lookup Takes the semantic index and stage bit and returns
+     *    the four floats of the constant, or \c nullptr if it isn't bound
+     */
+    template<typename Lookup>
+    void combine(float* color, const Lookup& lookup) const {
+      uint32_t bound[2] = { 0u, 0u };
+
+      // Semantics only exclude each other within a stage
+      for (uint32_t i = 0; i < m_semantics.size(); i++) {
+        for (uint32_t s = 0; s < 2; s++) {
+          if ((m_semantics[i].stages & (1u << s)) && lookup(i, 1u << s) != nullptr)
+            bound[s] |= 1u << uint32_t(m_semantics[i].role);
+        }
+      }
+
+      for (uint32_t i = 0; i < m_semantics.size(); i++) {
+        const D3D9ConstantSemantic& entry = m_semantics[i];
+
+        if (entry.combine == D3D9ConstantCombine::None)
+          continue;
+
+        for (uint32_t s = 0; s < 2; s++) {
+          const float* value = (entry.stages & (1u << s)) ? lookup(i, 1u << s) : nullptr;
+
+          if (value == nullptr)
+            continue;
+
+          if (!(bound[s] & entry.unlessRoles))
+            combineValue(entry.combine, value, color);
+
+          break;
+        }
+      }
+    }
+
+    /**
+     * \brief Finds the first semantic with a role
+     * \returns Index of the semantic, or -1
+     */
+    int32_t find(D3D9ConstantRole role) const {
+      for (uint32_t i = 0; i < m_semantics.size(); i++) {
+        if (m_semantics[i].role == role)
+          return int32_t(i);
+      }
+      return -1;
+    }
+
+  private:
+
+    std::vector<D3D9ConstantSemantic> m_semantics;
+
+    static void combineValue(D3D9ConstantCombine combine, const float* value, float* color);
+
+  };
+
+}
@@ -9,6 +9,10 @@
 #include "../util/util_math.h"
 #include "../util/util_vector.h"
 
+// NV-DXVK start: constant upload dedup
+#include "d3d9_constant_upload.h"
+// NV-DXVK end
+
 #include <cstdint>
 
 namespace dxvk {
@@ -49,6 +53,9 @@ namespace dxvk {
     Rc<DxvkBuffer>            buffer;
     DxsoShaderMetaInfo        meta  = {};
     bool                      dirty = true;
+    // NV-DXVK start: constant upload dedup
+    D3D9ConstantUploadShadow  upload;
+    // NV-DXVK end
   };
 
 }
\ No newline at end of file
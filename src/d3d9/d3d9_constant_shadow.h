@@ -0,0 +1,161 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace dxvk {
+
+  struct Constant {
+    uint32_t m_startRegister;
+    uint32_t m_vector4Count;
+
+    // Four values per register
+    std::vector<float> m_copy;
+  };
+
+  /**
+   * \brief Shadow copy of the constant registers set for a shader
+   *
+   * Register values are written in place into a dense array of
+   * four-component registers, so setting constants doesn't allocate
+   * once the array has grown to the highest register in use. A bit per
+   * register records which registers were written and where each
+   * write started, from which the list of constant ranges is built
+   * when it is queried. The shadow is not synchronized, readers on other
+   * threads must hold the lock its writer holds.
+   */
+  class ConstantShadow {
+
+  public:
+
+    /**
+     * \brief Writes a range of registers
+     *
+     * \param [in] startRegister First register
+     * \param [in] count Number of registers
+     * \param [in] pData Register values, 32 bits per component
+     * \param [in] componentCount Components per register in \c pData,
+     *    4 for float and integer constants, 1 for bool constants
+     */
+    void write(uint32_t startRegister, uint32_t count, const void* pData, uint32_t componentCount) {
+      if (count == 0)
+        return;
+
+      const uint32_t end = startRegister + count;
+      reserve(end);
+
+      if (componentCount == 4) {
+        std::memcpy(&m_registers[startRegister], pData, count * sizeof(Register));
+      } else {
+        const uint32_t* src = reinterpret_cast<const uint32_t*>(pData);
+
+        for (uint32_t i = 0; i < count; i++) {
+          m_registers[startRegister + i] = Register { };
+          std::memcpy(m_registers[startRegister + i].data(), &src[i * componentCount], componentCount * sizeof(uint32_t));
+        }
+      }
+
+      setBits(m_written, startRegister, end, true);
+
+      // The range replaces the ranges that started inside of it
+      setBits(m_starts, startRegister + 1, end, false);
+      setBits(m_starts, startRegister, startRegister + 1, true);
+    }
+
+    /**
+     * \brief Whether a register was ever written
+     */
+    bool isWritten(uint32_t reg) const {
+      return reg < getRegisterCount() && testBit(m_written, reg);
+    }
+
+    /**
+     * \brief Number of registers currently backed by the shadow
+     */
+    uint32_t getRegisterCount() const {
+      return uint32_t(m_registers.size());
+    }
+
+    /**
+     * \brief Current value of a register
+     */
+    template<typename T>
+    T get(uint32_t reg, uint32_t component) const {
+      T value;
+      std::memcpy(&value, &m_registers[reg][component], sizeof(value));
+      return value;
+    }
+
+    /**
+     * \brief Written constant ranges with their current values
+     *
+     * There is one range per register a write started at, running up
+     * to the next such register or the first register never written.
+     * The list is a copy, it stays valid while the shadow is written.
+     */
+    std::vector<Constant> getConstants() const {
+      std::vector<Constant> constants;
+
+      for (uint32_t reg = 0; reg < getRegisterCount(); reg++) {
+        if (!testBit(m_starts, reg))
+          continue;
+
+        uint32_t end = reg + 1;
+
+        while (end < getRegisterCount() && testBit(m_written, end) && !testBit(m_starts, end))
+          end++;
+
+        Constant constant = { reg, end - reg, std::vector<float>((end - reg) * 4) };
+        std::memcpy(constant.m_copy.data(), &m_registers[reg], constant.m_copy.size() * sizeof(float));
+        constants.push_back(std::move(constant));
+      }
+
+      return constants;
+    }
+
+  private:
+
+    using Register = std::array<uint32_t, 4>;
+
+    // Registers are added in blocks of one bit mask word
+    static constexpr uint32_t BlockSize = 32;
+
+    std::vector<Register> m_registers;
+    std::vector<uint32_t> m_written;
+    std::vector<uint32_t> m_starts;
+
+    void reserve(uint32_t registerCount) {
+      if (registerCount <= getRegisterCount())
+        return;
+
+      const uint32_t blockCount = (registerCount + BlockSize - 1) / BlockSize;
+      m_registers.resize(blockCount * BlockSize);
+      m_written.resize(blockCount);
+      m_starts.resize(blockCount);
+    }
+
+    static bool testBit(const std::vector<uint32_t>& bits, uint32_t index) {
+      return (bits[index / 32] >> (index % 32)) & 1u;
+    }
+
+    static void setBits(std::vector<uint32_t>& bits, uint32_t begin, uint32_t end, bool value) {
+      while (begin < end) {
+        const uint32_t word = begin / 32;
+        const uint32_t first = begin % 32;
+        const uint32_t last = std::min(end - word * 32, 32u);
+        const uint32_t mask = (last - first == 32 ? ~0u : ((1u << (last - first)) - 1u)) << first;
+
+        if (value)
+          bits[word] |= mask;
+        else
+          bits[word] &= ~mask;
+
+        begin = (word + 1) * 32;
+      }
+    }
+
+  };
+
+}
@@ -0,0 +1,179 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace dxvk {
+
+  /**
+   * \brief Copy of the last constant buffer upload of a stage
+   *
+   * Games often set the same constants again between draws, which
+   * marks the stage dirty without changing what the shader reads.
+   * The shadow holds the integer and float registers as they were
+   * last uploaded, so an upload whose data is unchanged can keep
+   * using the current buffer slice instead of allocating a new one.
+   *
+   * Registers the application writes are marked dirty, and only the
+   * dirty registers are compared. The shadow also is the source of
+   * the upload, with the defined constants of the shader applied.
+   */
+  class D3D9ConstantUploadShadow {
+
+  public:
+
+    void markFloats(uint32_t start, uint32_t count) {
+      m_dirtyFloats.add(start, count);
+    }
+
+    void markInts(uint32_t start, uint32_t count) {
+      m_dirtyInts.add(start, count);
+    }
+
+    /**
+     * \brief Compares all registers on the next update
+     *
+     * Needed when the defined constants written over
+     * the float registers change, i.e. on shader changes.
+     */
+    void invalidate() {
+      m_dirtyInts.add(0, uint32_t(m_ints.size()));
+      m_dirtyFloats.add(0, uint32_t(m_floats.size()));
+    }
+
+    /**
+     * \brief Forgets the uploaded data
+     *
+     * Needed when the buffer is replaced, the
+     * next update always reports a change.
+     */
+    void reset() {
+      m_ints.clear();
+      m_floats.clear();
+      m_dirtyInts = Range();
+      m_dirtyFloats = Range();
+    }
+
+    /**
+     * \brief Updates the shadow with the data of the next upload
+     *
+     * \param [in] pInts Integer registers set by the application
+     * \param [in] intCount Number of integer registers to upload
+     * \param [in] pFloats Float registers set by the application
+     * \param [in] floatCount Number of float registers to upload
+     * \param [in] pCopies Defined constants written over the float
+     *    registers, with \c uboIdx and \c float32 members, or \c nullptr
+     * \returns \c true if the data differs from the last upload
+     */
+    template<typename Copies>
+    bool update(
+      const void*    pInts,
+            uint32_t intCount,
+      const void*    pFloats,
+            uint32_t floatCount,
+      const Copies*  pCopies) {
+      bool changed = updateRegisters(m_ints, m_dirtyInts, pInts, intCount);
+      changed |= updateRegisters(m_floats, m_dirtyFloats, pFloats, floatCount);
+
+      if (pCopies != nullptr) {
+        for (const auto& constant : *pCopies) {
+          if (constant.uboIdx >= floatCount)
+            continue;
+
+          Register& reg = m_floats[constant.uboIdx];
+
+          if (std::memcmp(reg.data(), constant.float32, sizeof(Register))) {
+            std::memcpy(reg.data(), constant.float32, sizeof(Register));
+            changed = true;
+          }
+        }
+      }
+
+      return changed;
+    }
+
+    /**
+     * \brief Register data to upload
+     *
+     * Covers every register uploaded so far, which can be more than
+     * the last update asked for, so that the buffer always matches.
+     */
+    const void* getInts() const {
+      return m_ints.data();
+    }
+
+    uint32_t getIntCount() const {
+      return uint32_t(m_ints.size());
+    }
+
+    const void* getFloats() const {
+      return m_floats.data();
+    }
+
+    uint32_t getFloatCount() const {
+      return uint32_t(m_floats.size());
+    }
+
+  private:
+
+    using Register = std::array<uint32_t, 4>;
+
+    struct Range {
+      uint32_t begin = ~0u;
+      uint32_t end   = 0u;
+
+      void add(uint32_t start, uint32_t count) {
+        if (count == 0)
+          return;
+
+        begin = std::min(begin, start);
+        end   = std::max(end, start + count);
+      }
+    };
+
+    std::vector<Register> m_ints;
+    std::vector<Register> m_floats;
+
+    Range m_dirtyInts;
+    Range m_dirtyFloats;
+
+    static bool updateRegisters(std::vector<Register>& shadow, Range& dirty, const void* pSrc, uint32_t count) {
+      const Register* src = reinterpret_cast<const Register*>(pSrc);
+      const uint32_t oldCount = uint32_t(shadow.size());
+      bool changed = false;
+
+      // Registers that weren't part of the last upload
+      if (count > oldCount) {
+        shadow.resize(count);
+        std::memcpy(&shadow[oldCount], &src[oldCount], (count - oldCount) * sizeof(Register));
+        changed = true;
+      }
+
+      const uint32_t begin = dirty.begin;
+      const uint32_t end = std::min(dirty.end, std::min(count, oldCount));
+
+      if (begin < end) {
+        const size_t size = (end - begin) * sizeof(Register);
+
+        if (std::memcmp(&shadow[begin], &src[begin], size)) {
+          std::memcpy(&shadow[begin], &src[begin], size);
+          changed = true;
+        }
+      }
+
+      // Dirty registers past this upload stay dirty until they are part of one
+      const uint32_t keepBegin = std::max(dirty.begin, count);
+      const uint32_t keepEnd = dirty.end;
+
+      dirty = Range();
+      if (keepBegin < keepEnd)
+        dirty.add(keepBegin, keepEnd - keepBegin);
+
+      return changed;
+    }
+
+  };
+
+}
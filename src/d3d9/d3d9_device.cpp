@@ -40,6 +40,7 @@
 #include "../dxvk/dxvk_instance.h"
 
 #include "../util/util_bit.h"
+#include "../util/util_filesys.h"
 #include "../util/util_math.h"
 
 #include "../dxvk/rtx_render/rtx_context.h"
@@ -50,6 +51,7 @@
 
 #include <algorithm>
 #include <cfloat>
+#include <version.h>
 #include <thread>
 #include <future>
 #include <xutility>
@@ -141,6 +143,23 @@ namespace dxvk {
 // NV-DXVK start: external API
     , m_withExternalSwapchain { WithExternalSwapchain } {
 // NV-DXVK end
+    // NV-DXVK start: on-disk cache of generated shaders
+    if (D3D9Rtx::enableShaderDiskCache()) {
+      // Generated shaders depend on the build and on the settings read during generation
+      const uint32_t settings[] = {
+        m_d3d9Options.invariantPosition,
+        TerrainBaker::Material::replacementSupportInPS_fixedFunction(),
+        TerrainBaker::Material::replacementSupportInPS_programmableShaders() };
+
+      XXH64_hash_t settingsHash = XXH3_64bits(DXVK_VERSION, sizeof(DXVK_VERSION) - 1);
+      settingsHash = XXH3_64bits_withSeed(settings, sizeof(settings), settingsHash);
+
+      const std::string cachePath = (util::RtxFileSys::path(util::RtxFileSys::Caches) / "d3d9_shaders.rtxcache").string();
+      m_shaderDiskCache = std::make_unique<D3D9ShaderDiskCache>(cachePath, settingsHash);
+      m_shaderDiskCache->load();
+    }
+    // NV-DXVK end
+
     // If we can SWVP, then we use an extended constant set
     // as SWVP has many more slots available than HWVP.
     bool canSWVP = CanSWVP();
@@ -202,10 +221,21 @@ namespace dxvk {
     // NV-DXVK start: Consolidate RTX state
     m_rtx.Initialize();
     // NV-DXVK
+
+    // NV-DXVK start: on-disk cache of generated shaders
+    DxsoModuleInfo moduleInfo;
+    moduleInfo.options = m_dxsoOptions;
+
+    m_shaderModules->PrewarmFromDiskCache(this, &moduleInfo, D3D9Rtx::numShaderPrewarmThreads(), D3D9Rtx::maxShaderPrewarmCount());
+    // NV-DXVK end
   }
 
 
   D3D9DeviceEx::~D3D9DeviceEx() {
+    // NV-DXVK start: on-disk cache of generated shaders
+    m_shaderModules->StopPrewarm();
+    // NV-DXVK end
+
     Flush();
     SynchronizeCsThread();
 
@@ -3165,7 +3195,7 @@ namespace dxvk {
 
     *ppShader = ref(new D3D9VertexShader(this, module));
     // MHFZ start: hash vertex shader
-    m_dxvkDevice->getShaderHasher().hashShader(VK_SHADER_STAGE_VERTEX_BIT, pFunction, (uint64_t) *ppShader);
+    m_dxvkDevice->getShaderHasher().hashShader(VK_SHADER_STAGE_VERTEX_BIT, pFunction, module.GetConstantTable(), (uint64_t) *ppShader);
     // MHFZ end
     return D3D_OK;
   }
@@ -3190,6 +3220,10 @@ namespace dxvk {
     bool newCopies = newShader && newShader->GetMeta().needsConstantCopies;
 
     m_consts[DxsoProgramTypes::VertexShader].dirty |= oldCopies || newCopies || !oldShader;
+    // NV-DXVK start: constant upload dedup
+    if (oldCopies || newCopies)
+      m_consts[DxsoProgramTypes::VertexShader].upload.invalidate();
+    // NV-DXVK end
     m_consts[DxsoProgramTypes::VertexShader].meta  = newShader ? newShader->GetMeta() : DxsoShaderMetaInfo();
 
     if (newShader && oldShader) {
@@ -3513,7 +3547,7 @@ namespace dxvk {
 
     *ppShader = ref(new D3D9PixelShader(this, module));
     // MHFZ start: hesh pixel shader
-    m_dxvkDevice->getShaderHasher().hashShader(VK_SHADER_STAGE_FRAGMENT_BIT, pFunction, (uint64_t) *ppShader);
+    m_dxvkDevice->getShaderHasher().hashShader(VK_SHADER_STAGE_FRAGMENT_BIT, pFunction, module.GetConstantTable(), (uint64_t) *ppShader);
     // MHFZ end
     return D3D_OK;
   }
@@ -3538,6 +3572,10 @@ namespace dxvk {
     bool newCopies = newShader && newShader->GetMeta().needsConstantCopies;
 
     m_consts[DxsoProgramTypes::PixelShader].dirty |= oldCopies || newCopies || !oldShader;
+    // NV-DXVK start: constant upload dedup
+    if (oldCopies || newCopies)
+      m_consts[DxsoProgramTypes::PixelShader].upload.invalidate();
+    // NV-DXVK end
     m_consts[DxsoProgramTypes::PixelShader].meta  = newShader ? newShader->GetMeta() : DxsoShaderMetaInfo();
 
     if (newShader && oldShader) {
@@ -4708,6 +4746,10 @@ namespace dxvk {
     if (unlikely(!m_d3d9Options.allowDoNotWait))
       Flags &= ~D3DLOCK_DONOTWAIT;
 
+    // The buffer may still be read by a texture hashing job
+    if (Subresource == 0 && !(Flags & D3DLOCK_READONLY))
+      pResource->WaitForPendingHash();
+
     if (unlikely((Flags & (D3DLOCK_DISCARD | D3DLOCK_NOOVERWRITE)) == (D3DLOCK_DISCARD | D3DLOCK_NOOVERWRITE)))
       Flags &= ~D3DLOCK_DISCARD;
 
@@ -5494,6 +5536,11 @@ namespace dxvk {
                           DxsoProgramType::PixelShader,
                           DxsoConstantBuffers::PSConstantBuffer);
 
+    // NV-DXVK start: constant upload dedup
+    m_consts[DxsoProgramTypes::VertexShader].upload.reset();
+    m_consts[DxsoProgramTypes::PixelShader].upload.reset();
+    // NV-DXVK end
+
     m_vsClipPlanes =
       CreateConstantBuffer(false,
                            caps::MaxClipPlanes * sizeof(D3D9ClipPlane),
@@ -5655,6 +5702,20 @@ namespace dxvk {
       boundConstantBufferSize = bufferSize;
     }
 
+    // NV-DXVK start: constant upload dedup
+    // Keep the current slice if the constants match what it already holds
+    const uint32_t intCount = constSet.meta.maxConstIndexI != 0 ? intDataSize / uint32_t(sizeof(Vector4i)) : 0u;
+    const uint32_t uploadFloatCount = constSet.meta.maxConstIndexF != 0 ? floatDataSize / uint32_t(sizeof(Vector4)) : 0u;
+    const DxsoDefinedConstants* copies = constSet.meta.needsConstantCopies
+      ? &GetCommonShader(Shader)->GetConstants()
+      : nullptr;
+
+    if (!constSet.upload.update(Src.iConsts, intCount, Src.fConsts, uploadFloatCount, copies)) {
+      m_constantUploadsSkipped += 1;
+      m_constantUploadBytesSaved += (intCount + uploadFloatCount) * sizeof(Vector4);
+      return;
+    }
+
     DxvkBufferSliceHandle slice = constSet.buffer->allocSlice();
 
     EmitCs([
@@ -5666,21 +5727,12 @@ namespace dxvk {
 
     auto* dst = reinterpret_cast<HardwareLayoutType*>(slice.mapPtr);
 
-    if (constSet.meta.maxConstIndexI != 0)
-      std::memcpy(dst->iConsts, Src.iConsts, intDataSize);
-    if (constSet.meta.maxConstIndexF != 0)
-      std::memcpy(dst->fConsts, Src.fConsts, floatDataSize);
-
-    if (constSet.meta.needsConstantCopies) {
-      Vector4* data = reinterpret_cast<Vector4*>(dst->fConsts);
-
-      auto& shaderConsts = GetCommonShader(Shader)->GetConstants();
-
-      for (const auto& constant : shaderConsts) {
-        if (constant.uboIdx < constSet.meta.maxConstIndexF)
-          data[constant.uboIdx] = *reinterpret_cast<const Vector4*>(constant.float32);
-      }
-    }
+    // The shadow has the defined constants applied already
+    if (constSet.upload.getIntCount() != 0)
+      std::memcpy(dst->iConsts, constSet.upload.getInts(), constSet.upload.getIntCount() * sizeof(Vector4i));
+    if (constSet.upload.getFloatCount() != 0)
+      std::memcpy(dst->fConsts, constSet.upload.getFloats(), constSet.upload.getFloatCount() * sizeof(Vector4));
+    // NV-DXVK end
   }
 
 
@@ -7121,6 +7173,13 @@ namespace dxvk {
         : m_consts[ProgramType].meta.maxConstIndexI;
 
       m_consts[ProgramType].dirty |= StartRegister < maxCount;
+
+      // NV-DXVK start: constant upload dedup
+      if constexpr (ConstantType == D3D9ConstantType::Float)
+        m_consts[ProgramType].upload.markFloats(StartRegister, Count);
+      else
+        m_consts[ProgramType].upload.markInts(StartRegister, Count);
+      // NV-DXVK end
     } else if constexpr (ProgramType == DxsoProgramType::VertexShader) {
       if (unlikely(CanSWVP())) {
         m_consts[DxsoProgramType::VertexShader].dirty |= StartRegister < m_consts[ProgramType].meta.maxConstIndexB;
@@ -23,6 +23,7 @@
 #include "d3d9_sampler.h"
 #include "d3d9_fixed_function.h"
 #include "d3d9_swvp_emu.h"
+#include "d3d9_shader_disk_cache.h"
 
 #include "d3d9_shader_permutations.h"
 
@@ -903,6 +904,12 @@ namespace dxvk {
       return &m_d3d9Options;
     }
 
+    // NV-DXVK start: on-disk cache of generated shaders
+    D3D9ShaderDiskCache* GetShaderDiskCache() const {
+      return m_shaderDiskCache.get();
+    }
+    // NV-DXVK end
+
     Direct3DState9* GetRawState() {
       return &m_state;
     }
@@ -967,6 +974,18 @@ namespace dxvk {
       return m_dxvkDevice->getShaderHasher().isShaderWorldBinded();
     }
 
+    const D3D9ConstantSemanticTable& GetConstantSemantics() {
+      return m_dxvkDevice->getShaderHasher().getConstantSemantics();
+    }
+
+    bool GetBoundSemanticRegister(uint32_t semantic, ShaderType shaderType, uint32_t& reg) {
+      return m_dxvkDevice->getShaderHasher().getBoundSemanticRegister(semantic, shaderType, reg);
+    }
+
+    uint32_t GetSemanticRegister(uint32_t semantic, ShaderType shaderType) {
+      return m_dxvkDevice->getShaderHasher().getSemanticRegister(semantic, shaderType);
+    }
+
     void ResetFrame() {
       // MHFZ start : experiment auto sky
       if (m_rayTraceThisFrame == false)
@@ -1241,6 +1260,9 @@ namespace dxvk {
     D3D9Initializer*                m_initializer = nullptr;
     D3D9FormatHelper*               m_converter   = nullptr;
 
+    // NV-DXVK start: on-disk cache of generated shaders
+    std::unique_ptr<D3D9ShaderDiskCache> m_shaderDiskCache;
+    // NV-DXVK end
     D3D9FFShaderModuleSet           m_ffModules;
     D3D9SWVPEmulator                m_swvpEmulator;
 
@@ -1338,6 +1360,12 @@ namespace dxvk {
     VkDeviceSize                    m_boundVSConstantsBufferSize = 0;
     VkDeviceSize                    m_boundPSConstantsBufferSize = 0;
 
+    // NV-DXVK start: constant upload dedup
+    // Since the last frame, uploads that kept the current slice and the bytes they didn't copy
+    uint64_t                        m_constantUploadsSkipped = 0;
+    uint64_t                        m_constantUploadBytesSaved = 0;
+    // NV-DXVK end
+
     D3D9ConstantLayout              m_vsLayout;
     D3D9ConstantLayout              m_psLayout;
     D3D9ConstantSets                m_consts[DxsoProgramTypes::Count];
@@ -1,6 +1,7 @@
 #include "d3d9_fixed_function.h"
 
 #include "d3d9_device.h"
+#include "d3d9_shader.h"
 #include "d3d9_util.h"
 #include "d3d9_spec_constants.h"
 
@@ -2737,13 +2738,23 @@ namespace dxvk {
 
     std::string name = str::format("FF_", shaderKey.toString());
 
-    D3D9FFShaderCompiler compiler(
-      pDevice->GetDXVKDevice(),
-      Key, name,
-      pDevice->GetOptions());
+    // NV-DXVK start: fixed function shaders generated in a previous session
+    m_shader = LoadCachedShader(pDevice->GetShaderDiskCache(),
+      D3D9ShaderCacheKind::FixedFunctionVS, &Key, sizeof(Key));
 
-    m_shader = compiler.compile();
-    m_isgn   = compiler.isgn();
+    if (m_shader == nullptr) {
+      D3D9FFShaderCompiler compiler(
+        pDevice->GetDXVKDevice(),
+        Key, name,
+        pDevice->GetOptions());
+
+      m_shader = compiler.compile();
+      m_isgn   = compiler.isgn();
+
+      StoreCachedShader(pDevice->GetShaderDiskCache(),
+        D3D9ShaderCacheKind::FixedFunctionVS, &Key, sizeof(Key), m_shader);
+    }
+    // NV-DXVK end
 
     Dump(Key, name);
 
@@ -2760,13 +2771,23 @@ namespace dxvk {
 
     std::string name = str::format("FF_", shaderKey.toString());
 
-    D3D9FFShaderCompiler compiler(
-      pDevice->GetDXVKDevice(),
-      Key, name,
-      pDevice->GetOptions());
+    // NV-DXVK start: fixed function shaders generated in a previous session
+    m_shader = LoadCachedShader(pDevice->GetShaderDiskCache(),
+      D3D9ShaderCacheKind::FixedFunctionFS, &Key, sizeof(Key));
 
-    m_shader = compiler.compile();
-    m_isgn   = compiler.isgn();
+    if (m_shader == nullptr) {
+      D3D9FFShaderCompiler compiler(
+        pDevice->GetDXVKDevice(),
+        Key, name,
+        pDevice->GetOptions());
+
+      m_shader = compiler.compile();
+      m_isgn   = compiler.isgn();
+
+      StoreCachedShader(pDevice->GetShaderDiskCache(),
+        D3D9ShaderCacheKind::FixedFunctionFS, &Key, sizeof(Key), m_shader);
+    }
+    // NV-DXVK end
 
     Dump(Key, name);
 
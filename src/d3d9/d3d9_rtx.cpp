@@ -28,7 +28,8 @@ namespace dxvk {
     : m_rtStagingData(d3d9Device->GetDXVKDevice(), "RtxStagingDataAlloc: D3D9", (VkMemoryPropertyFlagBits) (VK_MEMORY_PROPERTY_HOST_CACHED_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
     , m_parent(d3d9Device)
     , m_enableDrawCallConversion(enableDrawCallConversion)
-    , m_pGeometryWorkers(enableDrawCallConversion ? std::make_unique<GeometryProcessor>(numGeometryProcessingThreads(), "geometry-processing") : nullptr) {
+    , m_pGeometryWorkers(enableDrawCallConversion ? std::make_unique<GeometryProcessor>(numGeometryProcessingThreads(), "geometry-processing") : nullptr)
+    , m_pTextureHashWorkers(numTextureHashingThreads() > 0 ? std::make_unique<TextureHashProcessor>(numTextureHashingThreads(), "texture-hashing") : nullptr) {
 
     // Add space for 256 objects skinned with 256 bones each.
     m_stagedBones.resize(256 * 256);
@@ -59,43 +60,36 @@ namespace dxvk {
   // MHFZ start: emulate MHFZ shader computation of albedo all stored in diffuseEmulated and send to shader in albedoOpacityConstant
   void D3D9Rtx::diffuseEstimation() {
     if (RtxOptions::Get()->enableRaytracing()) {
-      d3d9State().diffuseEmulated = d3d9State().material.Diffuse;
-
-      bool fadeColor = m_parent->IsShaderBindedConstant(2, ShaderType::Vertex);
-      bool materialDiffuseVertex = m_parent->IsShaderBindedConstant(170, ShaderType::Vertex);
-
-      auto combineColor = [](const Vector4& input, D3DCOLORVALUE& ouput) {
-        ouput.r *= input.r;
-        ouput.g *= input.g;
-        ouput.b *= input.b;
-        ouput.a *= input.a;
-        };
-
-      if (fadeColor) {
-        combineColor(d3d9State().vsConsts.fConsts[2], d3d9State().diffuseEmulated);
-      }
+      D3DCOLORVALUE& diffuse = d3d9State().diffuseEmulated;
+      diffuse = d3d9State().material.Diffuse;
+
+      // The constant semantic table says which constants are combined and how
+      auto lookup = [this](uint32_t semantic, uint32_t stage) -> const float* {
+        uint32_t reg;
+
+        if (stage == D3D9ConstantStages::Vertex) {
+          if (m_parent->GetBoundSemanticRegister(semantic, ShaderType::Vertex, reg))
+            return d3d9State().vsConsts.fConsts[reg].data;
+        } else if (m_parent->GetBoundSemanticRegister(semantic, ShaderType::Pixel, reg) && reg < caps::MaxFloatConstantsPS) {
+          return d3d9State().psConsts.fConsts[reg].data;
+        }
 
-      if (materialDiffuseVertex) {
-        combineColor(d3d9State().vsConsts.fConsts[170], d3d9State().diffuseEmulated);
-      } else if (m_parent->IsShaderBindedConstant(170, ShaderType::Pixel)) {
-        combineColor(d3d9State().psConsts.fConsts[170], d3d9State().diffuseEmulated);
-      }
+        return nullptr;
+      };
 
-      if (m_parent->IsShaderBindedConstant(171, ShaderType::Vertex)) {
-        combineColor(d3d9State().vsConsts.fConsts[171], d3d9State().diffuseEmulated);
-      } else if (m_parent->IsShaderBindedConstant(171, ShaderType::Pixel)) {
-        combineColor(d3d9State().psConsts.fConsts[171], d3d9State().diffuseEmulated);
-      }
+      m_parent->GetConstantSemantics().combine(&diffuse.r, lookup);
+    }
+  }
 
-      if (m_parent->IsShaderBindedConstant(1, ShaderType::Vertex) && materialDiffuseVertex == false && fadeColor == false) {
-        combineColor(d3d9State().vsConsts.fConsts[1], d3d9State().diffuseEmulated);
-      }
+  void D3D9Rtx::lightDirectionEstimation() {
+    const D3D9ConstantSemanticTable& semantics = m_parent->GetConstantSemantics();
+    const int32_t depthView = semantics.find(D3D9ConstantRole::DepthView);
+    const int32_t lightDirection = semantics.find(D3D9ConstantRole::LightDirection);
 
-      if (m_parent->IsShaderBindedConstant(4, ShaderType::Vertex)) {
-        d3d9State().diffuseEmulated.r = pow(d3d9State().diffuseEmulated.r, d3d9State().vsConsts.fConsts[4].w);
-        d3d9State().diffuseEmulated.g = pow(d3d9State().diffuseEmulated.g, d3d9State().vsConsts.fConsts[4].w);
-        d3d9State().diffuseEmulated.b = pow(d3d9State().diffuseEmulated.b, d3d9State().vsConsts.fConsts[4].w);
-      }
+    uint32_t reg;
+    if (depthView >= 0 && lightDirection >= 0 && m_parent->GetBoundSemanticRegister(depthView, ShaderType::Vertex, reg)) {
+      reg = m_parent->GetSemanticRegister(lightDirection, ShaderType::Vertex);
+      m_parent->GetDXVKDevice()->getAreaManager().setOriLightDir(-d3d9State().vsConsts.fConsts[reg].xyz());
     }
   }
   // MHFZ end
@@ -209,14 +203,29 @@ namespace dxvk {
     Matrix4 WorldToProj;
     if (reduceLocalPos) {
       if (d3d9State().pixelShader.ptr() != nullptr) {
+        const D3D9ConstantSemanticTable& semantics = m_parent->GetConstantSemantics();
+        const int32_t worldSemantic = semantics.find(D3D9ConstantRole::WorldMatrix);
+
         Matrix4 world;
-        memcpy(world.data, d3d9State().vsConsts.fConsts[195].data, 4 * 4 * sizeof(float));
+        if (worldSemantic >= 0) {
+          const uint32_t reg = m_parent->GetSemanticRegister(worldSemantic, ShaderType::Vertex);
+          memcpy(world.data, d3d9State().vsConsts.fConsts[reg].data, 4 * 4 * sizeof(float));
+        }
 
-        // clear world matrix
+        // clear world matrix and the matrices that include it
         Matrix4 matrix;
-        memcpy(d3d9State().vsConsts.fConsts[38].data, matrix.data, 4 * 4 * sizeof(float));
-        memcpy(d3d9State().vsConsts.fConsts[42].data, matrix.data, 4 * 4 * sizeof(float));
-        memcpy(d3d9State().vsConsts.fConsts[195].data, matrix.data, 4 * 4 * sizeof(float));
+        for (uint32_t i = 0; i < semantics.getSemantics().size(); ++i) {
+          const D3D9ConstantRole role = semantics.getSemantics()[i].role;
+
+          if (role == D3D9ConstantRole::WorldMatrix || role == D3D9ConstantRole::WorldTransform) {
+            const uint32_t reg = m_parent->GetSemanticRegister(i, ShaderType::Vertex);
+
+            if (reg + 4 <= caps::MaxFloatConstantsVS) {
+              memcpy(d3d9State().vsConsts.fConsts[reg].data, matrix.data, 4 * 4 * sizeof(float));
+              m_parent->m_consts[DxsoProgramTypes::VertexShader].upload.markFloats(reg, 4);
+            }
+          }
+        }
 
         if (m_parent->IsShaderWorldBinded())
           m_activeDrawCallState.transformData.objectToWorld = transpose(world);
@@ -904,17 +913,35 @@ namespace dxvk {
 
     // Copy bones up to the max bone we have registered so far.
     const uint32_t maxBone = m_maxBone > 0 ? m_maxBone : 255;
+    const uint32_t paletteSize = maxBone + 1;
     const uint32_t startBoneTransform = GetTransformIndex(D3DTS_WORLDMATRIX(0));
-
-    if (m_stagedBonesCount + maxBone >= m_stagedBones.size()) {
-      throw DxvkError("Bones temp storage is too small.");
+    const Matrix4* pSrcBones = d3d9State().transforms.data() + startBoneTransform;
+
+    // Many skinned draws in a frame share a palette (e.g. several body parts of one character), stage each unique palette once
+    const XXH64_hash_t paletteHash = XXH3_64bits(pSrcBones, sizeof(Matrix4) * paletteSize);
+    ++m_bonePaletteLookups;
+
+    const Matrix4* boneMatrices = nullptr;
+    std::vector<Matrix4> overflowBones;
+    auto stagedPalette = m_stagedBonePalettes.find(paletteHash);
+    if (stagedPalette != m_stagedBonePalettes.end() &&
+        stagedPalette->second.count == paletteSize &&
+        memcmp(m_stagedBones.data() + stagedPalette->second.offset, pSrcBones, sizeof(Matrix4) * paletteSize) == 0) {
+      boneMatrices = m_stagedBones.data() + stagedPalette->second.offset;
+      ++m_bonePaletteHits;
+    } else if (m_stagedBonesCount + paletteSize <= m_stagedBones.size()) {
+      Matrix4* stagedBones = m_stagedBones.data() + m_stagedBonesCount;
+      memcpy(stagedBones, pSrcBones, sizeof(Matrix4) * paletteSize);
+      m_stagedBonePalettes[paletteHash] = StagedBonePalette { m_stagedBonesCount, paletteSize };
+      m_stagedBonesCount += paletteSize;
+      boneMatrices = stagedBones;
+    } else {
+      // The staging storage can't grow while workers still read from it, so let this draw own its palette instead
+      ONCE(Logger::warn("[RTX] Bone palette staging storage exhausted, falling back to per draw copies."));
+      overflowBones.assign(pSrcBones, pSrcBones + paletteSize);
     }
 
-    Matrix4* boneMatrices = m_stagedBones.data() + m_stagedBonesCount;
-    memcpy(boneMatrices, d3d9State().transforms.data() + startBoneTransform, sizeof(Matrix4)*(maxBone + 1));
-    m_stagedBonesCount += maxBone + 1;
-
-    return m_pGeometryWorkers->Schedule([boneMatrices, blendIndices, numBonesPerVertex, vertexCount]()->SkinningData {
+    return m_pGeometryWorkers->Schedule([boneMatrices, overflowBones, paletteSize, paletteHash, blendIndices, numBonesPerVertex, vertexCount]()->SkinningData {
       ScopedCpuProfileZone();
       uint32_t numBones = numBonesPerVertex;
 
@@ -935,19 +962,26 @@ namespace dxvk {
         blendIndices.ref->decRef();
       }
 
+      // Indices past the end of the palette have no transform to read from
+      numBones = std::min(numBones, paletteSize);
+
       // Pass bone data to RT back-end
 
-      SkinningData skinningData;
-      skinningData.pBoneMatrices.reserve(numBones);
+      const Matrix4* pBones = overflowBones.empty() ? boneMatrices : overflowBones.data();
 
-      for (uint32_t n = 0; n < numBones; n++) {
-        skinningData.pBoneMatrices.push_back(boneMatrices[n]);
-      }
+      SkinningData skinningData;
+      skinningData.pBoneMatrices.assign(pBones, pBones + numBones);
 
       skinningData.minBoneIndex = minBoneIndex;
       skinningData.numBones = numBones;
       skinningData.numBonesPerVertex = numBonesPerVertex;
-      skinningData.computeHash(); // Computes the hash and stores it in the skinningData itself
+
+      // The palette hash already covers the hashed range when the whole palette is used
+      if (minBoneIndex == 0 && numBones == paletteSize) {
+        skinningData.boneHash = paletteHash;
+      } else {
+        skinningData.computeHash(); // Computes the hash and stores it in the skinningData itself
+      }
 
       return skinningData;
     });
@@ -1229,11 +1263,7 @@ namespace dxvk {
     diffuseEstimation();
 
 #ifdef REMIX_DEVELOPMENT
-    bool lightBinded = m_parent->IsShaderBindedConstant(186, ShaderType::Vertex);
-
-    if (lightBinded) {
-      m_parent->GetDXVKDevice()->getAreaManager().setOriLightDir(-d3d9State().vsConsts.fConsts[188].xyz());
-    }
+    lightDirectionEstimation();
 #endif
 
     bool ignoreDraw = d3d9State().isMaterialEnable() == false || m_parent->IsShaderBindedActivated() == false;
@@ -1316,11 +1346,7 @@ namespace dxvk {
     diffuseEstimation();
 
 #ifdef REMIX_DEVELOPMENT
-    bool lightBinded = m_parent->IsShaderBindedConstant(186, ShaderType::Vertex);
-
-    if (lightBinded) {
-      m_parent->GetDXVKDevice()->getAreaManager().setOriLightDir(-d3d9State().vsConsts.fConsts[188].xyz());
-    }
+    lightDirectionEstimation();
 #endif
 
     bool ignoreDraw = d3d9State().isMaterialEnable() == false || m_parent->IsShaderBindedActivated() == false;
@@ -1408,8 +1434,62 @@ namespace dxvk {
     });
   }
 
+  Rc<DxvkPendingHash> D3D9Rtx::HashTextureAsync(const Rc<DxvkBuffer>& buffer) {
+    if (m_pTextureHashWorkers == nullptr || buffer->info().size < kMinAsyncTextureHashSize)
+      return nullptr;
+
+    // Completes the hash on destruction, so that a job cancelled on shutdown doesn't leave its waiters hanging
+    struct HashJob {
+      Rc<DxvkBuffer> buffer;
+      Rc<DxvkPendingHash> pendingHash;
+
+      void operator()() const {
+        pendingHash->set(fast::parallel_XXH3_64bits(buffer->mapPtr(0), buffer->info().size));
+      }
+
+      HashJob(const Rc<DxvkBuffer>& buffer, const Rc<DxvkPendingHash>& pendingHash) : buffer(buffer), pendingHash(pendingHash) { }
+      HashJob(HashJob&& other) = default;
+
+      ~HashJob() {
+        if (pendingHash != nullptr && !pendingHash->isReady())
+          (*this)();
+      }
+    };
+
+    Rc<DxvkPendingHash> pendingHash = new DxvkPendingHash();
+    if (!m_pTextureHashWorkers->Schedule(HashJob(buffer, pendingHash)).valid())
+      return nullptr;
+
+    return pendingHash;
+  }
+
+  void D3D9Rtx::AddPendingTexture(D3D9CommonTexture* texture) {
+    std::lock_guard<dxvk::mutex> lock(m_pendingTexturesMutex);
+    m_pendingTextures.insert(texture);
+  }
+
+  bool D3D9Rtx::RemovePendingTexture(D3D9CommonTexture* texture) {
+    std::lock_guard<dxvk::mutex> lock(m_pendingTexturesMutex);
+    return m_pendingTextures.erase(texture) > 0;
+  }
+
+  void D3D9Rtx::registerPendingTextures() {
+    ScopedCpuProfileZone();
+    std::lock_guard<dxvk::mutex> lock(m_pendingTexturesMutex);
+
+    for (auto iter = m_pendingTextures.begin(); iter != m_pendingTextures.end(); ) {
+      if ((*iter)->TryRegisterWithImGui()) {
+        iter = m_pendingTextures.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+  }
+
   void D3D9Rtx::EndFrame(const Rc<DxvkImage>& targetImage, bool callInjectRtx) {
     const auto currentReflexFrameId = GetReflexFrameId();
+
+    registerPendingTextures();
     
     // Flush any pending game and RTX work
     m_parent->Flush();
@@ -1419,12 +1499,30 @@ namespace dxvk {
       static_cast<RtxContext*>(ctx)->endFrame(currentReflexFrameId, targetImage, callInjectRtx); 
     });
 
+    const uint64_t bonePaletteHitRate = m_bonePaletteLookups > 0 ? 100ull * m_bonePaletteHits / m_bonePaletteLookups : 0;
+    m_parent->EmitCs([bonePaletteHitRate](DxvkContext* ctx) {
+      ctx->getDevice()->statCounters().setCtr(DxvkStatCounter::RtxBonePaletteHitRate, bonePaletteHitRate);
+    });
+
+    m_parent->EmitCs([
+      cUploadsSkipped = m_parent->m_constantUploadsSkipped,
+      cBytesSaved     = m_parent->m_constantUploadBytesSaved
+    ] (DxvkContext* ctx) {
+      ctx->getDevice()->statCounters().setCtr(DxvkStatCounter::RtxConstantUploadsSkipped, cUploadsSkipped);
+      ctx->getDevice()->statCounters().setCtr(DxvkStatCounter::RtxConstantUploadBytesSaved, cBytesSaved);
+    });
+    m_parent->m_constantUploadsSkipped = 0;
+    m_parent->m_constantUploadBytesSaved = 0;
+
     // Reset for the next frame
     m_rtxInjectTriggered = false;
     m_drawCallID = 0;
     m_seenCameraPositionsPrev = std::move(m_seenCameraPositions);
 
     m_stagedBonesCount = 0;
+    m_stagedBonePalettes.clear();
+    m_bonePaletteLookups = 0;
+    m_bonePaletteHits = 0;
   }
 
   void D3D9Rtx::OnPresent(const Rc<DxvkImage>& targetImage) {
@@ -3,12 +3,15 @@
 #include "d3d9_state.h"
 #include "../dxvk/dxvk_buffer.h"
 #include "../util/util_threadpool.h"
+#include "../util/util_fast_cache.h"
 
 #include <vector>
 #include <optional>
+#include <unordered_set>
 
 namespace dxvk {
   struct D3D9BufferSlice;
+  class D3D9CommonTexture;
   class DxvkDevice;
 
   enum class D3D9RtxFlag : uint32_t {
@@ -41,6 +44,10 @@ namespace dxvk {
     RTX_OPTION("rtx", bool, useVertexCapturedNormals, true, "When enabled, vertex normals are read from the input assembler and used in raytracing.  This doesn't always work as normals can be in any coordinate space, but can help sometimes.");
     RTX_OPTION("rtx", bool, useWorldMatricesForShaders, true, "When enabled, Remix will utilize the world matrices being passed from the game via D3D9 fixed function API, even when running with shaders.  Sometimes games pass these matrices and they are useful, however for some games they are very unreliable, and should be filtered out.  If you're seeing precision related issues with shader vertex capture, try disabling this setting.");
     RTX_OPTION("rtx", bool, enableIndexBufferMemoization, true, "CPU performance optimization, should generally be enabled.  Will reduce main thread time by caching processIndexBuffer operations and reusing when possible, this will come at the expense of some CPU RAM.");
+    RTX_OPTION("rtx", uint32_t, numTextureHashingThreads, 2, "The number of CPU threads used to hash texture contents on upload, so the main thread doesn't stall on large textures.  Set to 0 to hash textures on the thread uploading them.");
+    RTX_OPTION("rtx", bool, enableShaderDiskCache, true, "When enabled, fixed function and software vertex processing shaders generated by Remix, and the translations of the game's shaders, are stored on disk, so they don't need to be generated again on the next launch.");
+    RTX_OPTION("rtx", uint32_t, numShaderPrewarmThreads, 2, "The number of CPU threads used to restore the game's shaders from the shader disk cache when the device is created, so that creating them later doesn't stall the game thread.  Set to 0 to restore shaders when the game creates them.");
+    RTX_OPTION("rtx", uint32_t, maxShaderPrewarmCount, 2048, "The maximum number of the game's shaders restored from the shader disk cache when the device is created.  Every restored shader is kept in memory for the lifetime of the device, so this bounds the memory used by shaders the game may never create again.  Other cached shaders are restored when the game creates them.");
     RTX_OPTION("rtx", uint32_t, numGeometryProcessingThreads, 2, "The desired number of CPU threads to dedicate to geometry processing  Will be limited by the number of CPU cores.  There may be some advantage to lowering this number in games which are fairly simple and use a low number of draw calls per frame.  The default was determined by looking at a game with around 2000 draw calls per frame, and with a reasonably high average triangle count per draw.");
 
     // Copy of the parameters issued to D3D9 on DrawXXX
@@ -171,10 +178,35 @@ namespace dxvk {
       return m_reflexFrameId;
     }
 
+    /**
+      * \brief: Schedules the content hash of a staging buffer on the texture hashing threads.
+      *
+      * \param [in] buffer: The buffer to hash, it must not be written until the hash is ready.
+      *
+      * Returns nullptr if the buffer is small, or no hashing thread is available, in which case the caller hashes it.
+      */
+    Rc<DxvkPendingHash> HashTextureAsync(const Rc<DxvkBuffer>& buffer);
+
+    /**
+      * \brief: Registers a texture with ImGUI once its hash is ready, see RegisterPendingTextures.
+      */
+    void AddPendingTexture(D3D9CommonTexture* texture);
+
+    /**
+      * \brief: Forgets a texture destroyed before its hash was ready.
+      *
+      * Returns false if the texture was already registered.
+      */
+    bool RemovePendingTexture(D3D9CommonTexture* texture);
+
   private: 
     inline static const uint32_t kMaxConcurrentDraws = 6 * 1024; // some games issuing >3000 draw calls per frame...  account for some consumer thread lag with x2
     using GeometryProcessor = WorkerThreadPool<kMaxConcurrentDraws>;
     const std::unique_ptr<GeometryProcessor> m_pGeometryWorkers;
+    inline static const uint32_t kMaxConcurrentTextureHashes = 1024;
+    inline static const size_t kMinAsyncTextureHashSize = 64 * 1024; // smaller textures hash faster than the hand off
+    using TextureHashProcessor = WorkerThreadPool<kMaxConcurrentTextureHashes, true, false>;
+    const std::unique_ptr<TextureHashProcessor> m_pTextureHashWorkers;
     AtomicQueue<DrawCallState, kMaxConcurrentDraws> m_drawCallStateQueue;
 
     DrawCallState m_activeDrawCallState;
@@ -194,6 +226,15 @@ namespace dxvk {
 
     std::vector<Matrix4> m_stagedBones;
     uint32_t m_stagedBonesCount = 0;
+
+    // Palettes staged this frame, keyed by the hash of their contents
+    struct StagedBonePalette {
+      uint32_t offset;
+      uint32_t count;
+    };
+    fast_unordered_cache<StagedBonePalette> m_stagedBonePalettes;
+    uint32_t m_bonePaletteLookups = 0;
+    uint32_t m_bonePaletteHits = 0;
     uint32_t m_maxBone = 0;
 
     const bool m_enableDrawCallConversion;
@@ -207,6 +248,10 @@ namespace dxvk {
 
     fast_unordered_cache<Rc<DxvkSampler>> m_samplerCache;
 
+    // Textures whose hash is computed on the texture hashing threads, registered with ImGUI at the end of the frame
+    dxvk::mutex m_pendingTexturesMutex;
+    std::unordered_set<D3D9CommonTexture*> m_pendingTextures;
+
     // NOTE: to avoid calculating matrix inverse,
     //       m_seenCameraPositions doesn't contain the actual positions,
     //       but only relative values, see USE_TRUE_CAMERA_POSITION_FOR_COMPARISON
@@ -238,6 +283,8 @@ namespace dxvk {
     // MHFZ end
     // MHFZ start:
     void diffuseEstimation();
+
+    void lightDirectionEstimation();
     // MHFZ end
     template<typename T>
     static void copyIndices(const uint32_t indexCount, T*& pIndicesDst, T* pIndices, uint32_t& minIndex, uint32_t& maxIndex);
@@ -276,5 +323,7 @@ namespace dxvk {
     Future<GeometryHashes> computeHash(const RasterGeometry& geoData, const uint32_t maxIndexValue);
 
     void submitActiveDrawCallState();
+
+    void registerPendingTextures();
   };
 }
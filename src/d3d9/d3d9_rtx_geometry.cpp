@@ -43,7 +43,7 @@ namespace dxvk {
 
   // Sorts and deduplicates a set of integers, storing the result in a vector
   template<typename T>
-  void deduplicateSortIndices(const void* pIndexData, const size_t indexCount, const uint32_t maxIndexValue, std::vector<T>& uniqueIndicesOut) {
+  void deduplicateSortIndices(const void* pIndexData, const size_t indexCount, const uint32_t maxIndexValue, frame_vector<T>& uniqueIndicesOut) {
     // TODO (REMIX-657): Implement optimized variant of this function
     // We know there will be at most, this many unique indices
     const uint32_t indexRange = maxIndexValue + 1;
@@ -76,8 +76,8 @@ namespace dxvk {
 
     const HashRule& globalHashRule = RtxOptions::Get()->GeometryHashGenerationRule;
 
-    // TODO (REMIX-658): Improve this by reducing allocation overhead of vector
-    std::vector<T> uniqueIndices(0);
+    // Only lives for the duration of this task, so it can come from the frame arena
+    frame_vector<T> uniqueIndices;
     if constexpr (!std::is_same<T, NoIndices>::value) {
       assert((indexCount > 0 && indexBufferRef));
       deduplicateSortIndices(pIndexData, indexCount, maxIndexValue, uniqueIndices);
@@ -226,8 +226,7 @@ namespace dxvk {
 
     const void* pVertexData = geoData.positionBuffer.mapPtr((size_t)geoData.positionBuffer.offsetFromSlice());
     // MHFZ start : visit color buffer to suppose if the mesh can be use as a custom blend mesh
-    bool haveColorBuffer = geoData.color0Buffer.buffer().ptr() != nullptr;
-    void* cVertexData = geoData.positionBuffer.mapPtr((size_t) geoData.color0Buffer.offsetFromSlice());
+    const void* cVertexData = geoData.color0Buffer.defined() ? geoData.color0Buffer.mapPtr((size_t) geoData.color0Buffer.offsetFromSlice()) : nullptr;
     const size_t colorStride = geoData.color0Buffer.stride();
     // MHFZ end
     const uint32_t vertexCount = geoData.vertexCount;
@@ -237,8 +236,8 @@ namespace dxvk {
       return Future<AxisAlignedBoundingBox>();
     }
     // MHFZ start
-    DxvkBuffer* colorBuffer;
-    if (haveColorBuffer) {
+    DxvkBuffer* colorBuffer = nullptr;
+    if (cVertexData != nullptr) {
       colorBuffer = geoData.color0Buffer.buffer().ptr();
       colorBuffer->incRef();
     }
@@ -247,52 +246,29 @@ namespace dxvk {
     vertexBuffer->incRef();
 
     // MHFZ start
-    return m_pGeometryWorkers->Schedule([pVertexData, vertexCount, vertexStride, vertexBuffer, cVertexData, colorBuffer, colorStride, haveColorBuffer]()->AxisAlignedBoundingBox {
+    return m_pGeometryWorkers->Schedule([pVertexData, vertexCount, vertexStride, vertexBuffer, cVertexData, colorBuffer, colorStride]()->AxisAlignedBoundingBox {
     // MHFZ end
       ScopedCpuProfileZone();
 
-      __m128 minPos = _mm_set_ps1(FLT_MAX);
-      __m128 maxPos = _mm_set_ps1(-FLT_MAX);
+      // Positions and colors are read in the same pass
+      fast::VertexBounds bounds;
+      fast::computeVertexBounds(pVertexData, vertexStride, cVertexData, colorStride, vertexCount, bounds);
 
-      // MHFZ start
-      uint8_t* cVertex = static_cast<uint8_t*>(cVertexData);
-      bool canBeCustomBlend = false;
-      bool fullyOpaqueVertexColor = true;
+      // MHFZ start : colors are D3DCOLOR, alpha is the last byte
+      const bool fullyOpaqueVertexColor = bounds.minColor[3] == 0xFF;
       // MHFZ end
 
-      const uint8_t* pVertex = static_cast<const uint8_t*>(pVertexData);
-      for (uint32_t vertexIdx = 0; vertexIdx < vertexCount; ++vertexIdx) {
-        const Vector3* const pVertexPos = reinterpret_cast<const Vector3* const>(pVertex);
-        // MHFZ start
-        if (haveColorBuffer) {
-          uint8_t* colorVertex = cVertex;
-          colorVertex += 3 * (sizeof(char));
-          canBeCustomBlend |= *colorVertex != 0xFF;
-          fullyOpaqueVertexColor &= *colorVertex == 0xFF;
-        }
-        // MHFZ end
-
-        __m128 vertexPos = _mm_set_ps(0.0f, pVertexPos->z, pVertexPos->y, pVertexPos->x);
-        minPos = _mm_min_ps(minPos, vertexPos);
-        maxPos = _mm_max_ps(maxPos, vertexPos);
-
-        pVertex += vertexStride;
-        // MHFZ start
-        cVertex += colorStride;
-        // MHFZ end
-      }
-
       AxisAlignedBoundingBox boundingBox{
-        Vector3{ minPos.m128_f32[0], minPos.m128_f32[1], minPos.m128_f32[2] },
-        Vector3{ maxPos.m128_f32[0], maxPos.m128_f32[1], maxPos.m128_f32[2] },
+        Vector3{ bounds.minPos[0], bounds.minPos[1], bounds.minPos[2] },
+        Vector3{ bounds.maxPos[0], bounds.maxPos[1], bounds.maxPos[2] },
         // MHFZ start
-        canBeCustomBlend && fullyOpaqueVertexColor == false, fullyOpaqueVertexColor
+        !fullyOpaqueVertexColor, fullyOpaqueVertexColor
         // MHFZ end
       };
 
       vertexBuffer->decRef();
       // MHFZ start
-      if (haveColorBuffer) {
+      if (colorBuffer != nullptr) {
         colorBuffer->decRef();
       }
       // MHFZ end
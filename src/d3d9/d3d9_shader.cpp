@@ -2,12 +2,90 @@
 
 #include "d3d9_caps.h"
 #include "d3d9_device.h"
+#include "d3d9_shader_cache_util.h"
 #include "d3d9_util.h"
 #include "../dxvk/dxvk_scoped_annotation.h"
 
+#include <algorithm>
+
 
 namespace dxvk {
 
+  namespace {
+    const D3D9ConstantLayout& GetConstantLayout(D3D9DeviceEx* pDevice, VkShaderStageFlagBits ShaderStage) {
+      return ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
+        ? pDevice->GetVertexConstantLayout()
+        : pDevice->GetPixelConstantLayout();
+    }
+
+    bool LoadCachedModule(
+            D3D9ShaderDiskCache*    pCache,
+      const D3D9DxsoCacheKey&       Key,
+            D3D9CachedShaderModule& Cached) {
+      if (pCache == nullptr || !pCache->find(D3D9ShaderCacheKind::Dxso, &Key, sizeof(Key), Cached))
+        return false;
+
+      // The base permutation always exists
+      return (Cached.permutationMask & 1u)
+          && (Cached.permutationMask >> D3D9ShaderPermutations::Count) == 0
+          && Cached.isgn.size() <= 2 * DxsoMaxInterfaceRegs
+          && Cached.osgn.size() <= 2 * DxsoMaxInterfaceRegs;
+    }
+
+    void StoreCachedModule(
+            D3D9ShaderDiskCache*    pCache,
+      const D3D9DxsoCacheKey&       Key,
+      const D3D9CommonShader&       Shader) {
+      if (pCache == nullptr)
+        return;
+
+      D3D9CachedShaderModule cached;
+      cached.bytecode = Shader.GetBytecode();
+
+      for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+        const Rc<DxvkShader> shader = Shader.GetShader(D3D9ShaderPermutation(i));
+
+        if (shader == nullptr)
+          continue;
+
+        if (!ToCachedShader(shader, cached.shaders.emplace_back()))
+          return;
+
+        cached.permutationMask |= 1u << i;
+      }
+
+      ToCachedIsgn(Shader.GetIsgn(), cached.isgn);
+      ToCachedIsgn(Shader.GetOsgn(), cached.osgn);
+
+      const D3D9ShaderMasks masks = Shader.GetShaderMask();
+      cached.usedSamplers = masks.samplerMask;
+      cached.usedRTs      = masks.rtMask;
+
+      const DxsoProgramInfo& info = Shader.GetInfo();
+      cached.programType  = uint32_t(info.type());
+      cached.minorVersion = info.minorVersion();
+      cached.majorVersion = info.majorVersion();
+
+      const DxsoShaderMetaInfo& meta = Shader.GetMeta();
+      cached.needsConstantCopies = meta.needsConstantCopies;
+      cached.maxConstIndexF      = meta.maxConstIndexF;
+      cached.maxConstIndexI      = meta.maxConstIndexI;
+      cached.maxConstIndexB      = meta.maxConstIndexB;
+      cached.boolConstantMask    = meta.boolConstantMask;
+
+      for (const auto& constant : Shader.GetConstants()) {
+        D3D9CachedDefinedConstant& entry = cached.constants.emplace_back();
+        entry.uboIdx = constant.uboIdx;
+        std::memcpy(entry.float32, constant.float32, sizeof(entry.float32));
+      }
+
+      cached.maxDefinedConst = Shader.GetMaxDefinedConstant();
+
+      pCache->store(D3D9ShaderCacheKind::Dxso, &Key, sizeof(Key), cached);
+    }
+  }
+
+
   D3D9CommonShader::D3D9CommonShader() {}
 
   D3D9CommonShader::D3D9CommonShader(
@@ -55,9 +133,7 @@ namespace dxvk {
     // Decide whether we need to create a pass-through
     // geometry shader for vertex shader stream output
 
-    const D3D9ConstantLayout& constantLayout = ShaderStage == VK_SHADER_STAGE_VERTEX_BIT
-      ? pDevice->GetVertexConstantLayout()
-      : pDevice->GetPixelConstantLayout();
+    const D3D9ConstantLayout& constantLayout = GetConstantLayout(pDevice, ShaderStage);
     m_shaders      = pModule->compile(*pDxsoModuleInfo, name, AnalysisInfo, constantLayout);
     m_isgn         = pModule->isgn();
     // NV-DXVK start: expose shader outputs for vertex capture
@@ -100,6 +176,56 @@ namespace dxvk {
   }
 
 
+  D3D9CommonShader::D3D9CommonShader(
+    const Rc<DxvkDevice>&         Device,
+    const DxvkShaderKey&          Key,
+          D3D9CachedShaderModule& Cached) {
+    Logger::debug(str::format("Restoring shader ", Key.toString()));
+
+    m_bytecode = std::move(Cached.bytecode);
+
+    auto cachedShader = Cached.shaders.begin();
+
+    for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+      if (Cached.permutationMask & (1u << i))
+        m_shaders[i] = FromCachedShader(*(cachedShader++));
+    }
+
+    FromCachedIsgn(Cached.isgn, m_isgn);
+    // NV-DXVK start: expose shader outputs for vertex capture
+    FromCachedIsgn(Cached.osgn, m_osgn);
+    // NV-DXVK end
+    m_usedSamplers = Cached.usedSamplers;
+    m_usedRTs      = Cached.usedRTs;
+
+    m_info = DxsoProgramInfo(DxsoProgramType(Cached.programType), Cached.minorVersion, Cached.majorVersion);
+
+    m_meta.needsConstantCopies = Cached.needsConstantCopies != 0;
+    m_meta.maxConstIndexF      = Cached.maxConstIndexF;
+    m_meta.maxConstIndexI      = Cached.maxConstIndexI;
+    m_meta.maxConstIndexB      = Cached.maxConstIndexB;
+    m_meta.boolConstantMask    = Cached.boolConstantMask;
+
+    for (const auto& constant : Cached.constants) {
+      DxsoDefinedConstant& entry = m_constants.emplace_back();
+      entry.uboIdx = constant.uboIdx;
+      std::memcpy(entry.float32, constant.float32, sizeof(entry.float32));
+    }
+
+    m_maxDefinedConst = Cached.maxDefinedConst;
+
+    m_shaders[0]->setShaderKey(Key);
+
+    if (m_shaders[1] != nullptr)
+      m_shaders[1]->setShaderKey({ VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, Key.sha1() });
+
+    Device->registerShader(m_shaders[0]);
+
+    if (m_shaders[1] != nullptr)
+      Device->registerShader(m_shaders[1]);
+  }
+
+
   void D3D9ShaderModuleSet::GetShaderModule(
             D3D9DeviceEx*         pDevice,
             D3D9CommonShader*     pShaderModule,
@@ -130,28 +256,222 @@ namespace dxvk {
       auto entry = m_modules.find(lookupKey);
       if (entry != m_modules.end()) {
         *pShaderModule = entry->second;
+        // MHFZ start: shaders restored from the disk cache lack the constant table, the analysis above decoded it
+        pShaderModule->SetConstantTable(module.ctab());
+        // MHFZ end
         return;
       }
     }
     
     // This shader has not been compiled yet, so we have to create a
-    // new module. This takes a while, so we won't lock the structure.
-    *pShaderModule = D3D9CommonShader(
-      pDevice, ShaderStage, lookupKey,
-      pDxbcModuleInfo, pShaderBytecode,
-      info, &module);
+    // new module, unless the translation is in the disk cache. This
+    // takes a while, so we won't lock the structure.
+    D3D9ShaderDiskCache* diskCache = pDevice->GetShaderDiskCache();
+
+    // Translate when dumping so that the dumps are complete
+    if (!env::getEnvVar("DXVK_SHADER_DUMP_PATH").empty())
+      diskCache = nullptr;
+
+    const D3D9DxsoCacheKey cacheKey = MakeDxsoCacheKey(ShaderStage, lookupKey.sha1(),
+      pDxbcModuleInfo->options, GetConstantLayout(pDevice, ShaderStage));
+
+    D3D9CachedShaderModule cached;
+
+    if (LoadCachedModule(diskCache, cacheKey, cached)
+     && cached.bytecode.size() == info.bytecodeByteLength
+     && !std::memcmp(cached.bytecode.data(), pShaderBytecode, info.bytecodeByteLength)) {
+      *pShaderModule = D3D9CommonShader(
+        pDevice->GetDXVKDevice(), lookupKey, cached);
+    } else {
+      *pShaderModule = D3D9CommonShader(
+        pDevice, ShaderStage, lookupKey,
+        pDxbcModuleInfo, pShaderBytecode,
+        info, &module);
+
+      StoreCachedModule(diskCache, cacheKey, *pShaderModule);
+    }
     
+    InsertShaderModule(lookupKey, pShaderModule);
+
+    // MHFZ start: same as for modules found in the lookup table
+    pShaderModule->SetConstantTable(module.ctab());
+    // MHFZ end
+  }
+
+
+  void D3D9ShaderModuleSet::InsertShaderModule(
+    const DxvkShaderKey&        Key,
+          D3D9CommonShader*     pShaderModule) {
     // Insert the new module into the lookup table. If another thread
     // has compiled the same shader in the meantime, we should return
     // that object instead and discard the newly created module.
-    { std::unique_lock<dxvk::mutex> lock(m_mutex);
-      
-      auto status = m_modules.insert({ lookupKey, *pShaderModule });
-      if (!status.second) {
-        *pShaderModule = status.first->second;
-        return;
-      }
+    std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+    auto status = m_modules.insert({ Key, *pShaderModule });
+    if (!status.second)
+      *pShaderModule = status.first->second;
+  }
+
+
+  void D3D9ShaderModuleSet::PrewarmFromDiskCache(
+          D3D9DeviceEx*         pDevice,
+    const DxsoModuleInfo*       pDxbcModuleInfo,
+          uint32_t              NumThreads,
+          uint32_t              MaxShaders) {
+    D3D9ShaderDiskCache* diskCache = pDevice->GetShaderDiskCache();
+
+    if (diskCache == nullptr || NumThreads == 0 || MaxShaders == 0 || m_prewarmWorkers != nullptr)
+      return;
+
+    struct PrewarmItem {
+      D3D9DxsoCacheKey cacheKey;
+      bool             upToDate;
+    };
+
+    // Entries translated with the current options are preferred, any
+    // other shader is translated from its bytecode once
+    std::unordered_map<DxvkShaderKey, PrewarmItem, DxvkHash, DxvkEq> items;
+
+    for (const auto& keyData : diskCache->getKeys(D3D9ShaderCacheKind::Dxso)) {
+      D3D9DxsoCacheKey cacheKey;
+
+      if (keyData.size() != sizeof(cacheKey))
+        continue;
+
+      std::memcpy(&cacheKey, keyData.data(), sizeof(cacheKey));
+
+      const DxvkShaderKey shaderKey = cacheKey.shaderKey();
+      const VkShaderStageFlagBits stage = VkShaderStageFlagBits(cacheKey.stage);
+
+      if (stage != VK_SHADER_STAGE_VERTEX_BIT && stage != VK_SHADER_STAGE_FRAGMENT_BIT)
+        continue;
+
+      const D3D9DxsoCacheKey currentKey = MakeDxsoCacheKey(stage, shaderKey.sha1(),
+        pDxbcModuleInfo->options, GetConstantLayout(pDevice, stage));
+
+      const bool upToDate = !std::memcmp(&cacheKey, &currentKey, sizeof(cacheKey));
+      auto entry = items.insert({ shaderKey, PrewarmItem { cacheKey, upToDate } });
+
+      if (!entry.second && upToDate)
+        entry.first->second = PrewarmItem { cacheKey, upToDate };
+    }
+
+    if (items.empty())
+      return;
+
+    struct PrewarmWork {
+      std::vector<std::pair<DxvkShaderKey, PrewarmItem>> items;
+      std::atomic<size_t>                                next = { 0 };
+    };
+
+    auto work = std::make_shared<PrewarmWork>();
+    work->items.assign(items.begin(), items.end());
+
+    // Restored shaders live as long as the device, only keep the cheapest ones to restore
+    if (work->items.size() > MaxShaders) {
+      std::stable_partition(work->items.begin(), work->items.end(),
+        [] (const auto& item) { return item.second.upToDate; });
+      work->items.resize(MaxShaders);
+    }
+
+    Logger::info(str::format("D3D9: Prewarming ", work->items.size(), " shaders from the disk cache"));
+
+    NumThreads = uint32_t(std::min<size_t>({ NumThreads, work->items.size(), UINT8_MAX }));
+    m_prewarmWorkers = std::make_unique<PrewarmWorkers>(uint8_t(NumThreads), "shader-prewarm");
+
+    for (uint32_t i = 0; i < NumThreads; i++) {
+      m_prewarmWorkers->Schedule([this, pDevice, diskCache, moduleInfo = *pDxbcModuleInfo, work] {
+        size_t index;
+
+        while (!m_stopPrewarm && (index = work->next++) < work->items.size()) {
+          const DxvkShaderKey& shaderKey = work->items[index].first;
+          const PrewarmItem&   item      = work->items[index].second;
+
+          { std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+            if (m_modules.find(shaderKey) != m_modules.end())
+              continue;
+          }
+
+          D3D9CachedShaderModule cached;
+
+          if (!LoadCachedModule(diskCache, item.cacheKey, cached))
+            continue;
+
+          try {
+            D3D9CommonShader shaderModule;
+
+            if (item.upToDate) {
+              shaderModule = D3D9CommonShader(pDevice->GetDXVKDevice(), shaderKey, cached);
+            } else {
+              const VkShaderStageFlagBits stage = VkShaderStageFlagBits(item.cacheKey.stage);
+
+              DxsoReader reader(
+                reinterpret_cast<const char*>(cached.bytecode.data()));
+
+              DxsoModule module(reader);
+
+              if (module.info().majorVersion() > moduleInfo.options.shaderModel
+               || module.info().shaderStage() != stage)
+                continue;
+
+              DxsoAnalysisInfo info = module.analyze();
+
+              shaderModule = D3D9CommonShader(
+                pDevice, stage, shaderKey,
+                &moduleInfo, cached.bytecode.data(),
+                info, &module);
+
+              StoreCachedModule(diskCache, MakeDxsoCacheKey(stage, shaderKey.sha1(),
+                moduleInfo.options, GetConstantLayout(pDevice, stage)), shaderModule);
+            }
+
+            InsertShaderModule(shaderKey, &shaderModule);
+          } catch (const DxvkError& e) {
+            Logger::warn(str::format("D3D9: Failed to prewarm shader ", shaderKey.toString(), ": ", e.message()));
+          }
+        }
+      });
     }
   }
 
+
+  void D3D9ShaderModuleSet::StopPrewarm() {
+    m_stopPrewarm = true;
+    m_prewarmWorkers = nullptr;
+  }
+
+
+  D3D9ShaderModuleSet::~D3D9ShaderModuleSet() {
+    StopPrewarm();
+  }
+
+
+  Rc<DxvkShader> LoadCachedShader(
+          D3D9ShaderDiskCache*  pCache,
+          D3D9ShaderCacheKind   Kind,
+    const void*                 pKey,
+          size_t                KeySize) {
+    D3D9CachedShader cached;
+
+    if (pCache == nullptr || !pCache->find(Kind, pKey, KeySize, cached))
+      return nullptr;
+
+    return FromCachedShader(cached);
+  }
+
+
+  void StoreCachedShader(
+          D3D9ShaderDiskCache*  pCache,
+          D3D9ShaderCacheKind   Kind,
+    const void*                 pKey,
+          size_t                KeySize,
+    const Rc<DxvkShader>&       Shader) {
+    D3D9CachedShader cached;
+
+    if (pCache != nullptr && ToCachedShader(Shader, cached))
+      pCache->store(Kind, pKey, KeySize, cached);
+  }
+
+
 }
@@ -4,6 +4,8 @@
 #include "../dxso/dxso_module.h"
 #include "d3d9_shader_permutations.h"
 #include "d3d9_util.h"
+#include "d3d9_shader_disk_cache.h"
+#include "../util/util_threadpool.h"
 
 #include <array>
 
@@ -32,6 +34,14 @@ namespace dxvk {
       const DxsoAnalysisInfo&     AnalysisInfo,
             DxsoModule*           pModule);
 
+    /**
+     * \brief Restores a translated shader from the disk cache
+     */
+    D3D9CommonShader(
+      const Rc<DxvkDevice>&         Device,
+      const DxvkShaderKey&          Key,
+            D3D9CachedShaderModule& Cached);
+
 
     Rc<DxvkShader> GetShader(D3D9ShaderPermutation Permutation) const {
       return m_shaders[Permutation];
@@ -64,6 +74,12 @@ namespace dxvk {
 
     uint32_t GetMaxDefinedConstant() const { return m_maxDefinedConst; }
 
+    // MHFZ start: expose the constant table decoded by the DXSO module
+    const std::vector<DxsoCtab::Constant>& GetConstantTable() const { return m_constantTable; }
+
+    void SetConstantTable(const DxsoCtab& Ctab) { m_constantTable = Ctab.m_constantData; }
+    // MHFZ end
+
   private:
 
     DxsoIsgn              m_isgn;
@@ -82,6 +98,10 @@ namespace dxvk {
 
     std::vector<uint8_t>  m_bytecode;
 
+    // MHFZ start: expose the constant table decoded by the DXSO module
+    std::vector<DxsoCtab::Constant> m_constantTable;
+    // MHFZ end
+
   };
 
   /**
@@ -188,8 +208,41 @@ namespace dxvk {
             VkShaderStageFlagBits ShaderStage,
       const DxsoModuleInfo*       pDxbcModuleInfo,
       const void*                 pShaderBytecode);
+
+    /**
+     * \brief Prepares the shaders stored in the disk cache
+     *
+     * Restores the cached translations on background threads, so that
+     * creating one of these shaders is a lookup. Cached shaders that
+     * were translated with different options or constant layouts are
+     * translated again from their bytecode. At most \p MaxShaders are
+     * prepared, preferring the ones that don't need a translation, the
+     * others are restored from the disk cache when they are created.
+     */
+    void PrewarmFromDiskCache(
+            D3D9DeviceEx*         pDevice,
+      const DxsoModuleInfo*       pDxbcModuleInfo,
+            uint32_t              NumThreads,
+            uint32_t              MaxShaders);
+
+    /**
+     * \brief Waits for the background threads started by
+     *        \ref PrewarmFromDiskCache, skipping remaining work
+     */
+    void StopPrewarm();
+
+    ~D3D9ShaderModuleSet();
     
   private:
+
+    void InsertShaderModule(
+      const DxvkShaderKey&        Key,
+            D3D9CommonShader*     pShaderModule);
+
+    using PrewarmWorkers = WorkerThreadPool<16, true, false>;
+
+    std::unique_ptr<PrewarmWorkers> m_prewarmWorkers;
+    std::atomic<bool>               m_stopPrewarm = { false };
     
     dxvk::mutex m_mutex;
     
@@ -205,4 +258,30 @@ namespace dxvk {
     return pShader != nullptr ? pShader->GetCommonShader() : nullptr;
   }
 
+
+  /**
+   * \brief Recreates a shader from the shader disk cache
+   *
+   * \param [in] pCache The disk cache, may be \c nullptr
+   * \returns The shader, or \c nullptr if it is not cached
+   */
+  Rc<DxvkShader> LoadCachedShader(
+          D3D9ShaderDiskCache*  pCache,
+          D3D9ShaderCacheKind   Kind,
+    const void*                 pKey,
+          size_t                KeySize);
+
+  /**
+   * \brief Stores a generated shader in the shader disk cache
+   *
+   * Shaders that reference descriptor set layouts are not cached.
+   * \param [in] pCache The disk cache, may be \c nullptr
+   */
+  void StoreCachedShader(
+          D3D9ShaderDiskCache*  pCache,
+          D3D9ShaderCacheKind   Kind,
+    const void*                 pKey,
+          size_t                KeySize,
+    const Rc<DxvkShader>&       Shader);
+
 }
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "d3d9_shader_cache_util.h"
+
+namespace dxvk {
+
+  // Bump when the output of the DXSO compiler changes
+  // without the build version changing along with it
+  constexpr uint32_t DxsoCacheVersion = 1;
+
+
+  DxvkShaderKey D3D9DxsoCacheKey::shaderKey() const {
+    Sha1Digest digest;
+    std::memcpy(digest.data(), sha1, sizeof(sha1));
+    return DxvkShaderKey(VkShaderStageFlagBits(stage), Sha1Hash(digest));
+  }
+
+
+  D3D9DxsoCacheKey MakeDxsoCacheKey(
+          VkShaderStageFlagBits ShaderStage,
+    const Sha1Hash&             Hash,
+    const DxsoOptions&          Options,
+    const D3D9ConstantLayout&   Layout) {
+    D3D9DxsoCacheKey key;
+    key.cacheVersion = DxsoCacheVersion;
+    key.stage        = uint32_t(ShaderStage);
+
+    for (uint32_t i = 0; i < 5; i++)
+      key.sha1[i] = Hash.dword(i);
+
+    key.useDemoteToHelperInvocation     = Options.useDemoteToHelperInvocation;
+    key.useSubgroupOpsForEarlyDiscard   = Options.useSubgroupOpsForEarlyDiscard;
+    key.strictConstantCopies            = Options.strictConstantCopies;
+    key.d3d9FloatEmulation              = uint32_t(Options.d3d9FloatEmulation);
+    key.strictPow                       = Options.strictPow;
+    key.shaderModel                     = Options.shaderModel;
+    key.invariantPosition               = Options.invariantPosition;
+    key.forceSamplerTypeSpecConstants   = Options.forceSamplerTypeSpecConstants;
+    key.vertexFloatConstantBufferAsSSBO = Options.vertexFloatConstantBufferAsSSBO;
+    key.longMad                         = Options.longMad;
+    key.alphaTestWiggleRoom             = Options.alphaTestWiggleRoom;
+    key.robustness2Supported            = Options.robustness2Supported;
+    key.floatCount                      = Layout.floatCount;
+    key.intCount                        = Layout.intCount;
+    key.boolCount                       = Layout.boolCount;
+    key.bitmaskCount                    = Layout.bitmaskCount;
+    return key;
+  }
+
+
+  bool ToCachedShader(
+    const Rc<DxvkShader>&       Shader,
+          D3D9CachedShader&     Cached) {
+    static_assert(MaxNumXfbBuffers == std::tuple_size_v<decltype(D3D9CachedShader::xfbStrides)>);
+
+    const DxvkShaderOptions options = Shader->shaderOptions();
+
+    // Descriptor set layouts are device objects
+    if (!options.extraLayouts.empty())
+      return false;
+
+    Cached.stage = uint32_t(Shader->stage());
+
+    for (const auto& slot : Shader->resourceSlots()) {
+      Cached.slots.push_back(D3D9CachedShaderSlot {
+        slot.slot, uint32_t(slot.type), uint32_t(slot.view),
+        uint32_t(slot.access), slot.count, uint32_t(slot.flags) });
+    }
+
+    const DxvkInterfaceSlots iface = Shader->interfaceSlots();
+    Cached.inputSlots       = iface.inputSlots;
+    Cached.outputSlots      = iface.outputSlots;
+    Cached.pushConstOffset  = iface.pushConstOffset;
+    Cached.pushConstSize    = iface.pushConstSize;
+    Cached.rasterizedStream = options.rasterizedStream;
+    std::copy(std::begin(options.xfbStrides), std::end(options.xfbStrides), Cached.xfbStrides.begin());
+
+    const DxvkShaderConstData& constData = Shader->shaderConstants();
+    Cached.constData.assign(constData.data(), constData.data() + constData.sizeInBytes() / sizeof(uint32_t));
+
+    const SpirvCompressedBuffer& code = Shader->compressedCode();
+    Cached.codeDwords = code.getDwordCount();
+    Cached.codeMask   = code.getMask();
+    Cached.code       = code.getCode();
+    return true;
+  }
+
+
+  Rc<DxvkShader> FromCachedShader(
+          D3D9CachedShader&     Cached) {
+    std::vector<DxvkResourceSlot> slots;
+    slots.reserve(Cached.slots.size());
+
+    for (const auto& slot : Cached.slots) {
+      slots.emplace_back(slot.slot, VkDescriptorType(slot.type), VkImageViewType(slot.view),
+        VkAccessFlags(slot.access), slot.count, VkDescriptorBindingFlags(slot.flags));
+    }
+
+    DxvkInterfaceSlots iface;
+    iface.inputSlots      = Cached.inputSlots;
+    iface.outputSlots     = Cached.outputSlots;
+    iface.pushConstOffset = Cached.pushConstOffset;
+    iface.pushConstSize   = Cached.pushConstSize;
+
+    DxvkShaderOptions options = { };
+    options.rasterizedStream = Cached.rasterizedStream;
+    std::copy(Cached.xfbStrides.begin(), Cached.xfbStrides.end(), options.xfbStrides);
+
+    SpirvCompressedBuffer code(Cached.codeDwords, std::move(Cached.codeMask), std::move(Cached.code));
+
+    return new DxvkShader(
+      VkShaderStageFlagBits(Cached.stage),
+      slots.size(), slots.data(), iface,
+      code.decompress(), options,
+      DxvkShaderConstData(Cached.constData.size(), Cached.constData.data()));
+  }
+
+
+  void ToCachedIsgn(
+    const DxsoIsgn&                         Isgn,
+          std::vector<D3D9CachedIsgnEntry>& Entries) {
+    for (uint32_t i = 0; i < Isgn.elemCount; i++) {
+      const DxsoIsgnEntry& elem = Isgn.elems[i];
+
+      uint32_t mask = 0;
+
+      for (uint32_t c = 0; c < 4; c++)
+        mask |= elem.mask[c] ? (1u << c) : 0u;
+
+      Entries.push_back(D3D9CachedIsgnEntry {
+        elem.regNumber, elem.slot,
+        uint32_t(elem.semantic.usage), elem.semantic.usageIndex,
+        mask, elem.centroid });
+    }
+  }
+
+
+  void FromCachedIsgn(
+    const std::vector<D3D9CachedIsgnEntry>& Entries,
+          DxsoIsgn&                         Isgn) {
+    Isgn.elemCount = uint32_t(Entries.size());
+
+    for (uint32_t i = 0; i < Isgn.elemCount; i++) {
+      DxsoIsgnEntry& elem = Isgn.elems[i];
+      elem.regNumber = Entries[i].regNumber;
+      elem.slot      = Entries[i].slot;
+      elem.semantic  = DxsoSemantic { DxsoUsage(Entries[i].usage), Entries[i].usageIndex };
+      elem.mask      = DxsoRegMask(uint8_t(Entries[i].mask));
+      elem.centroid  = Entries[i].centroid != 0;
+    }
+  }
+
+}
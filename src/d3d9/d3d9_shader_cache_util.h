@@ -0,0 +1,72 @@
+#pragma once
+
+#include "d3d9_constant_layout.h"
+#include "d3d9_shader_disk_cache.h"
+
+#include "../dxso/dxso_isgn.h"
+#include "../dxso/dxso_options.h"
+#include "../dxvk/dxvk_shader.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Disk cache key of a translated shader
+   *
+   * Everything the DXSO translation depends on besides
+   * the bytecode, which is identified by its hash.
+   */
+  struct D3D9DxsoCacheKey {
+    uint32_t cacheVersion;
+    uint32_t stage;
+    uint32_t sha1[5];
+    uint32_t useDemoteToHelperInvocation;
+    uint32_t useSubgroupOpsForEarlyDiscard;
+    uint32_t strictConstantCopies;
+    uint32_t d3d9FloatEmulation;
+    uint32_t strictPow;
+    uint32_t shaderModel;
+    uint32_t invariantPosition;
+    uint32_t forceSamplerTypeSpecConstants;
+    uint32_t vertexFloatConstantBufferAsSSBO;
+    uint32_t longMad;
+    uint32_t alphaTestWiggleRoom;
+    uint32_t robustness2Supported;
+    uint32_t floatCount;
+    uint32_t intCount;
+    uint32_t boolCount;
+    uint32_t bitmaskCount;
+
+    DxvkShaderKey shaderKey() const;
+  };
+
+  D3D9DxsoCacheKey MakeDxsoCacheKey(
+          VkShaderStageFlagBits ShaderStage,
+    const Sha1Hash&             Hash,
+    const DxsoOptions&          Options,
+    const D3D9ConstantLayout&   Layout);
+
+  /**
+   * \brief Converts a shader to its disk cache representation
+   * \returns \c false if the shader can't be cached
+   */
+  bool ToCachedShader(
+    const Rc<DxvkShader>&       Shader,
+          D3D9CachedShader&     Cached);
+
+  /**
+   * \brief Recreates a shader from the disk cache
+   *
+   * Moves the code out of \c Cached.
+   */
+  Rc<DxvkShader> FromCachedShader(
+          D3D9CachedShader&     Cached);
+
+  void ToCachedIsgn(
+    const DxsoIsgn&                         Isgn,
+          std::vector<D3D9CachedIsgnEntry>& Entries);
+
+  void FromCachedIsgn(
+    const std::vector<D3D9CachedIsgnEntry>& Entries,
+          DxsoIsgn&                         Isgn);
+
+}
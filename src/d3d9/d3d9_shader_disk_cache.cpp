@@ -0,0 +1,429 @@
+#include "d3d9_shader_disk_cache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+
+#include "../util/log/log.h"
+#include "../util/util_bit.h"
+#include "../util/util_string.h"
+
+namespace dxvk {
+
+  namespace {
+    // Keys and payloads larger than this can only come from a corrupted file
+    constexpr uint32_t kMaxKeySize = 64 * 1024;
+    constexpr uint32_t kMaxPayloadSize = 64 * 1024 * 1024;
+
+    class PayloadWriter {
+    public:
+      explicit PayloadWriter(std::vector<uint8_t>& data) : m_data(data) { }
+
+      template<typename T>
+      void write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const size_t offset = m_data.size();
+        m_data.resize(offset + sizeof(T));
+        std::memcpy(m_data.data() + offset, &value, sizeof(T));
+      }
+
+      template<typename T>
+      void writeArray(const std::vector<T>& values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        write(uint32_t(values.size()));
+        const size_t offset = m_data.size();
+        m_data.resize(offset + values.size() * sizeof(T));
+        if (!values.empty())
+          std::memcpy(m_data.data() + offset, values.data(), values.size() * sizeof(T));
+      }
+
+    private:
+      std::vector<uint8_t>& m_data;
+    };
+
+    class PayloadReader {
+    public:
+      PayloadReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) { }
+
+      template<typename T>
+      bool read(T& value) {
+        if (m_size - m_offset < sizeof(T))
+          return false;
+        std::memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+      }
+
+      template<typename T>
+      bool readArray(std::vector<T>& values) {
+        uint32_t count = 0;
+        if (!read(count) || (m_size - m_offset) / sizeof(T) < count)
+          return false;
+        values.resize(count);
+        if (count > 0)
+          std::memcpy(values.data(), m_data + m_offset, count * sizeof(T));
+        m_offset += count * sizeof(T);
+        return true;
+      }
+
+      bool isAtEnd() const { return m_offset == m_size; }
+
+    private:
+      const uint8_t* m_data;
+      size_t         m_size;
+      size_t         m_offset = 0;
+    };
+
+    XXH64_hash_t hashEntry(const std::string& lookupKey, const void* payload, size_t payloadSize) {
+      return XXH3_64bits_withSeed(payload, payloadSize, XXH3_64bits(lookupKey.data(), lookupKey.size()));
+    }
+  }
+
+
+  void D3D9CachedShader::serialize(std::vector<uint8_t>& data) const {
+    PayloadWriter writer(data);
+    writer.write(stage);
+    writer.writeArray(slots);
+    writer.write(inputSlots);
+    writer.write(outputSlots);
+    writer.write(pushConstOffset);
+    writer.write(pushConstSize);
+    writer.write(rasterizedStream);
+    writer.write(xfbStrides);
+    writer.writeArray(constData);
+    writer.write(codeDwords);
+    writer.writeArray(codeMask);
+    writer.writeArray(code);
+  }
+
+
+  bool D3D9CachedShader::deserialize(const uint8_t* data, size_t size) {
+    PayloadReader reader(data, size);
+    return reader.read(stage)
+        && reader.readArray(slots)
+        && reader.read(inputSlots)
+        && reader.read(outputSlots)
+        && reader.read(pushConstOffset)
+        && reader.read(pushConstSize)
+        && reader.read(rasterizedStream)
+        && reader.read(xfbStrides)
+        && reader.readArray(constData)
+        && reader.read(codeDwords)
+        && reader.readArray(codeMask)
+        && reader.readArray(code)
+        && reader.isAtEnd();
+  }
+
+
+  void D3D9CachedShaderModule::serialize(std::vector<uint8_t>& data) const {
+    PayloadWriter writer(data);
+    writer.writeArray(bytecode);
+    writer.write(permutationMask);
+    writer.write(uint32_t(shaders.size()));
+
+    std::vector<uint8_t> shaderData;
+
+    for (const auto& shader : shaders) {
+      shaderData.clear();
+      shader.serialize(shaderData);
+      writer.writeArray(shaderData);
+    }
+
+    writer.writeArray(isgn);
+    writer.writeArray(osgn);
+    writer.write(usedSamplers);
+    writer.write(usedRTs);
+    writer.write(programType);
+    writer.write(minorVersion);
+    writer.write(majorVersion);
+    writer.write(needsConstantCopies);
+    writer.write(maxConstIndexF);
+    writer.write(maxConstIndexI);
+    writer.write(maxConstIndexB);
+    writer.write(boolConstantMask);
+    writer.writeArray(constants);
+    writer.write(maxDefinedConst);
+  }
+
+
+  bool D3D9CachedShaderModule::deserialize(const uint8_t* data, size_t size) {
+    PayloadReader reader(data, size);
+
+    uint32_t shaderCount = 0;
+
+    if (!reader.readArray(bytecode)
+     || !reader.read(permutationMask)
+     || !reader.read(shaderCount)
+     || shaderCount != uint32_t(bit::popcnt(permutationMask)))
+      return false;
+
+    shaders.resize(shaderCount);
+
+    std::vector<uint8_t> shaderData;
+
+    for (auto& shader : shaders) {
+      if (!reader.readArray(shaderData)
+       || !shader.deserialize(shaderData.data(), shaderData.size()))
+        return false;
+    }
+
+    return reader.readArray(isgn)
+        && reader.readArray(osgn)
+        && reader.read(usedSamplers)
+        && reader.read(usedRTs)
+        && reader.read(programType)
+        && reader.read(minorVersion)
+        && reader.read(majorVersion)
+        && reader.read(needsConstantCopies)
+        && reader.read(maxConstIndexF)
+        && reader.read(maxConstIndexI)
+        && reader.read(maxConstIndexB)
+        && reader.read(boolConstantMask)
+        && reader.readArray(constants)
+        && reader.read(maxDefinedConst)
+        && reader.isAtEnd();
+  }
+
+
+  D3D9ShaderDiskCache::D3D9ShaderDiskCache(const std::string& filePath, XXH64_hash_t settingsHash)
+  : m_filePath(filePath), m_settingsHash(settingsHash) {
+
+  }
+
+
+  bool D3D9ShaderDiskCache::load() {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    m_entries.clear();
+    m_validSize = 0;
+    m_headerValid = false;
+
+    std::error_code ec;
+    const uint64_t fileSize = std::filesystem::file_size(m_filePath, ec);
+
+    if (ec)
+      return false;
+
+    m_readStream.open(m_filePath, std::ios_base::binary);
+
+    D3D9ShaderDiskCacheHeader expected;
+    expected.settingsHash = m_settingsHash;
+
+    D3D9ShaderDiskCacheHeader header;
+
+    if (!m_readStream.read(reinterpret_cast<char*>(&header), sizeof(header))
+     || std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0
+     || header.version != expected.version
+     || header.settingsHash != expected.settingsHash) {
+      Logger::info(str::format("D3D9: Discarding shader cache written by a different version or with different settings: ", m_filePath));
+      m_readStream.close();
+      return false;
+    }
+
+    m_headerValid = true;
+    m_validSize = sizeof(header);
+
+    D3D9ShaderDiskCacheEntry entry;
+    std::string lookupKey;
+
+    while (m_readStream.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+      if (entry.keySize == 0 || entry.keySize > kMaxKeySize || entry.payloadSize > kMaxPayloadSize)
+        break;
+
+      const uint64_t payloadOffset = m_validSize + sizeof(entry) + entry.keySize;
+
+      if (payloadOffset + entry.payloadSize > fileSize)
+        break;
+
+      lookupKey.resize(sizeof(entry.kind) + entry.keySize);
+      std::memcpy(lookupKey.data(), &entry.kind, sizeof(entry.kind));
+
+      if (!m_readStream.read(lookupKey.data() + sizeof(entry.kind), entry.keySize)
+       || !m_readStream.seekg(payloadOffset + entry.payloadSize))
+        break;
+
+      // Later entries for the same key replace earlier ones
+      m_entries[lookupKey] = IndexEntry { payloadOffset, entry.payloadSize, entry.hash };
+      m_validSize = payloadOffset + entry.payloadSize;
+    }
+
+    m_readStream.clear();
+
+    if (m_validSize != fileSize)
+      Logger::warn(str::format("D3D9: Shader cache ", m_filePath, " is truncated, keeping the first ", m_entries.size(), " entries"));
+
+    Logger::info(str::format("D3D9: Loaded ", m_entries.size(), " shaders from ", m_filePath));
+    return true;
+  }
+
+
+  template<typename T>
+  bool D3D9ShaderDiskCache::findEntry(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, T& value) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    const std::string lookupKey = makeLookupKey(kind, pKey, keySize);
+
+    auto iter = m_entries.find(lookupKey);
+
+    if (iter == m_entries.end()) {
+      m_statistics.numMisses++;
+      return false;
+    }
+
+    if (!m_readStream.is_open())
+      m_readStream.open(m_filePath, std::ios_base::binary);
+
+    const IndexEntry& entry = iter->second;
+    std::vector<uint8_t> payload(entry.payloadSize);
+
+    m_readStream.clear();
+
+    const bool intact = m_readStream.seekg(entry.payloadOffset)
+                     && m_readStream.read(reinterpret_cast<char*>(payload.data()), payload.size())
+                     && hashEntry(lookupKey, payload.data(), payload.size()) == entry.hash
+                     && value.deserialize(payload.data(), payload.size());
+
+    if (!intact) {
+      // Drop the entry, the shader gets generated and appended again
+      Logger::warn(str::format("D3D9: Ignoring corrupted entry in shader cache ", m_filePath));
+      m_entries.erase(iter);
+      m_statistics.numCorrupted++;
+      m_statistics.numMisses++;
+      return false;
+    }
+
+    m_statistics.numHits++;
+    return true;
+  }
+
+
+  template<typename T>
+  void D3D9ShaderDiskCache::storeEntry(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, const T& value) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    if (keySize == 0 || keySize > kMaxKeySize || !openWriteStream())
+      return;
+
+    std::vector<uint8_t> payload;
+    value.serialize(payload);
+
+    if (payload.size() > kMaxPayloadSize)
+      return;
+
+    const std::string lookupKey = makeLookupKey(kind, pKey, keySize);
+
+    D3D9ShaderDiskCacheEntry entry;
+    entry.kind        = uint32_t(kind);
+    entry.keySize     = uint32_t(keySize);
+    entry.payloadSize = uint32_t(payload.size());
+    entry.hash        = hashEntry(lookupKey, payload.data(), payload.size());
+
+    m_writeStream.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    m_writeStream.write(reinterpret_cast<const char*>(pKey), keySize);
+    m_writeStream.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    m_writeStream.flush();
+
+    if (!m_writeStream) {
+      Logger::warn(str::format("D3D9: Failed to write shader cache ", m_filePath));
+      m_writeStream.close();
+      m_writeFailed = true;
+      return;
+    }
+
+    const uint64_t payloadOffset = m_validSize + sizeof(entry) + keySize;
+    m_entries[lookupKey] = IndexEntry { payloadOffset, entry.payloadSize, entry.hash };
+    m_validSize = payloadOffset + entry.payloadSize;
+
+    m_statistics.numStored++;
+  }
+
+
+  bool D3D9ShaderDiskCache::find(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, D3D9CachedShader& shader) {
+    return findEntry(kind, pKey, keySize, shader);
+  }
+
+
+  bool D3D9ShaderDiskCache::find(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, D3D9CachedShaderModule& module) {
+    return findEntry(kind, pKey, keySize, module);
+  }
+
+
+  void D3D9ShaderDiskCache::store(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, const D3D9CachedShader& shader) {
+    storeEntry(kind, pKey, keySize, shader);
+  }
+
+
+  void D3D9ShaderDiskCache::store(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, const D3D9CachedShaderModule& module) {
+    storeEntry(kind, pKey, keySize, module);
+  }
+
+
+  std::vector<std::vector<uint8_t>> D3D9ShaderDiskCache::getKeys(D3D9ShaderCacheKind kind) {
+    std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+    std::vector<std::vector<uint8_t>> keys;
+    const uint32_t kindValue = uint32_t(kind);
+
+    for (const auto& entry : m_entries) {
+      const std::string& lookupKey = entry.first;
+
+      if (std::memcmp(lookupKey.data(), &kindValue, sizeof(kindValue)) == 0)
+        keys.emplace_back(lookupKey.begin() + sizeof(kindValue), lookupKey.end());
+    }
+
+    return keys;
+  }
+
+
+  std::string D3D9ShaderDiskCache::makeLookupKey(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize) {
+    std::string lookupKey(sizeof(uint32_t) + keySize, '\0');
+    const uint32_t kindValue = uint32_t(kind);
+    std::memcpy(lookupKey.data(), &kindValue, sizeof(kindValue));
+    std::memcpy(lookupKey.data() + sizeof(kindValue), pKey, keySize);
+    return lookupKey;
+  }
+
+
+  bool D3D9ShaderDiskCache::openWriteStream() {
+    if (m_writeStream.is_open())
+      return true;
+
+    if (m_writeFailed)
+      return false;
+
+    std::error_code ec;
+    const std::filesystem::path parentPath = std::filesystem::path(m_filePath).parent_path();
+
+    if (!parentPath.empty())
+      std::filesystem::create_directories(parentPath, ec);
+
+    if (m_headerValid) {
+      // Cut off an entry that was only partially written by a previous session
+      if (std::filesystem::file_size(m_filePath, ec) != m_validSize)
+        std::filesystem::resize_file(m_filePath, m_validSize, ec);
+
+      m_writeStream.open(m_filePath, std::ios_base::binary | std::ios_base::app);
+    } else {
+      m_readStream.close();
+      m_writeStream.open(m_filePath, std::ios_base::binary | std::ios_base::trunc);
+
+      D3D9ShaderDiskCacheHeader header;
+      header.settingsHash = m_settingsHash;
+      m_writeStream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+      m_entries.clear();
+      m_validSize = sizeof(header);
+      m_headerValid = true;
+    }
+
+    if (!m_writeStream) {
+      Logger::warn(str::format("D3D9: Failed to open shader cache ", m_filePath, " for writing"));
+      m_writeStream.close();
+      m_writeFailed = true;
+      return false;
+    }
+
+    return true;
+  }
+
+}
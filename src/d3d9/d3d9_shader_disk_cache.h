@@ -0,0 +1,268 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../util/thread.h"
+#include "../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Kinds of shaders stored in the disk cache
+   *
+   * Part of the lookup key, so that keys of different
+   * shader kinds with the same bytes don't alias.
+   */
+  enum class D3D9ShaderCacheKind : uint32_t {
+    FixedFunctionVS = 0,
+    FixedFunctionFS = 1,
+    SWVP            = 2,
+    Dxso            = 3,
+  };
+
+
+  /**
+   * \brief Resource slot of a cached shader
+   *
+   * Mirrors \c DxvkResourceSlot with fixed size members.
+   */
+  struct D3D9CachedShaderSlot {
+    uint32_t slot;
+    uint32_t type;
+    uint32_t view;
+    uint32_t access;
+    uint32_t count;
+    uint32_t flags;
+  };
+
+
+  /**
+   * \brief Shader as stored in the disk cache
+   *
+   * Everything needed to recreate a \c DxvkShader without
+   * generating its SPIR-V again. The code is kept in the
+   * \c SpirvCompressedBuffer representation.
+   */
+  struct D3D9CachedShader {
+    uint32_t                          stage = 0;
+    std::vector<D3D9CachedShaderSlot> slots;
+    uint32_t                          inputSlots = 0;
+    uint32_t                          outputSlots = 0;
+    uint32_t                          pushConstOffset = 0;
+    uint32_t                          pushConstSize = 0;
+    int32_t                           rasterizedStream = 0;
+    std::array<uint32_t, 4>           xfbStrides = { };
+    std::vector<uint32_t>             constData;
+    uint32_t                          codeDwords = 0;
+    std::vector<uint64_t>             codeMask;
+    std::vector<uint64_t>             code;
+
+    void serialize(std::vector<uint8_t>& data) const;
+
+    /**
+     * \brief Reads a shader written by \ref serialize
+     * \returns \c false if the data is malformed
+     */
+    bool deserialize(const uint8_t* data, size_t size);
+  };
+
+
+  /**
+   * \brief Input or output signature entry of a cached shader
+   *
+   * Mirrors \c DxsoIsgnEntry with fixed size members.
+   */
+  struct D3D9CachedIsgnEntry {
+    uint32_t regNumber;
+    uint32_t slot;
+    uint32_t usage;
+    uint32_t usageIndex;
+    uint32_t mask;
+    uint32_t centroid;
+  };
+
+
+  /**
+   * \brief Defined constant of a cached shader
+   *
+   * Mirrors \c DxsoDefinedConstant.
+   */
+  struct D3D9CachedDefinedConstant {
+    uint32_t uboIdx;
+    float    float32[4];
+  };
+
+
+  /**
+   * \brief Translated D3D9 shader as stored in the disk cache
+   *
+   * The SPIR-V permutations of an application shader, together with
+   * the signatures and metadata that \c D3D9CommonShader exposes, so
+   * the DXSO translation can be skipped. The bytecode is kept so that
+   * a module can be restored before the application creates it.
+   */
+  struct D3D9CachedShaderModule {
+    std::vector<uint8_t>                   bytecode;
+    // Bit i is set if permutation i is present in shaders
+    uint32_t                               permutationMask = 0;
+    std::vector<D3D9CachedShader>          shaders;
+    std::vector<D3D9CachedIsgnEntry>       isgn;
+    std::vector<D3D9CachedIsgnEntry>       osgn;
+    uint32_t                               usedSamplers = 0;
+    uint32_t                               usedRTs = 0;
+    uint32_t                               programType = 0;
+    uint32_t                               minorVersion = 0;
+    uint32_t                               majorVersion = 0;
+    uint32_t                               needsConstantCopies = 0;
+    uint32_t                               maxConstIndexF = 0;
+    uint32_t                               maxConstIndexI = 0;
+    uint32_t                               maxConstIndexB = 0;
+    uint32_t                               boolConstantMask = 0;
+    std::vector<D3D9CachedDefinedConstant> constants;
+    uint32_t                               maxDefinedConst = 0;
+
+    void serialize(std::vector<uint8_t>& data) const;
+
+    /**
+     * \brief Reads a module written by \ref serialize
+     * \returns \c false if the data is malformed
+     */
+    bool deserialize(const uint8_t* data, size_t size);
+  };
+
+
+  /**
+   * \brief On-disk cache of generated shaders
+   *
+   * Stores the SPIR-V of shaders that D3D9 generates itself (fixed function
+   * and SWVP permutations) and of translated application shaders, keyed by
+   * the shader kind and the bytes of the shader key, so they don't need to
+   * be generated again on the next launch.
+   *
+   * The file starts with a header that holds a version and a hash of the
+   * settings the shaders depend on, a mismatch discards the whole file.
+   * Entries are appended as they are generated:
+   *   [D3D9ShaderDiskCacheEntry][key][payload]
+   *
+   * Only the entry headers and keys are read on startup, payloads are read
+   * when a shader is first requested and checked against the entry hash.
+   */
+  struct D3D9ShaderDiskCacheHeader {
+    char         magic[4] = { 'D', '9', 'S', 'C' };
+    uint32_t     version = 1;
+    XXH64_hash_t settingsHash = 0;
+  };
+
+  static_assert(sizeof(D3D9ShaderDiskCacheHeader) == 16);
+
+  struct D3D9ShaderDiskCacheEntry {
+    uint32_t     kind = 0;
+    uint32_t     keySize = 0;
+    uint32_t     payloadSize = 0;
+    uint32_t     reserved = 0;
+    // Hash of the key and the payload, used to detect a corrupted file
+    XXH64_hash_t hash = 0;
+  };
+
+  static_assert(sizeof(D3D9ShaderDiskCacheEntry) == 24);
+
+  class D3D9ShaderDiskCache {
+
+  public:
+
+    D3D9ShaderDiskCache(const std::string& filePath, XXH64_hash_t settingsHash);
+
+    /**
+     * \brief Reads the entries of the cache file
+     *
+     * \returns \c false if the file is missing, or was written by
+     *    a different version or with different settings
+     */
+    bool load();
+
+    /**
+     * \brief Looks up a shader
+     *
+     * \param [in] kind Shader kind
+     * \param [in] pKey Shader key
+     * \param [in] keySize Size of the shader key in bytes
+     * \param [out] shader The cached shader
+     * \returns \c true if the shader was found and is intact
+     */
+    bool find(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, D3D9CachedShader& shader);
+
+    /**
+     * \brief Looks up a translated shader module
+     * \returns \c true if the module was found and is intact
+     */
+    bool find(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, D3D9CachedShaderModule& module);
+
+    /**
+     * \brief Appends a shader to the cache file
+     */
+    void store(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, const D3D9CachedShader& shader);
+
+    /**
+     * \brief Appends a translated shader module to the cache file
+     */
+    void store(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, const D3D9CachedShaderModule& module);
+
+    /**
+     * \brief Keys of all entries of the given kind
+     */
+    std::vector<std::vector<uint8_t>> getKeys(D3D9ShaderCacheKind kind);
+
+    uint32_t size() const { return uint32_t(m_entries.size()); }
+
+    struct Statistics {
+      uint32_t numHits = 0;
+      uint32_t numMisses = 0;
+      uint32_t numStored = 0;
+      uint32_t numCorrupted = 0;
+    };
+
+    const Statistics& getStatistics() const { return m_statistics; }
+
+  private:
+
+    struct IndexEntry {
+      uint64_t     payloadOffset;
+      uint32_t     payloadSize;
+      XXH64_hash_t hash;
+    };
+
+    static std::string makeLookupKey(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize);
+
+    template<typename T>
+    bool findEntry(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, T& value);
+
+    template<typename T>
+    void storeEntry(D3D9ShaderCacheKind kind, const void* pKey, size_t keySize, const T& value);
+
+    bool openWriteStream();
+
+    dxvk::mutex   m_mutex;
+
+    std::string   m_filePath;
+    XXH64_hash_t  m_settingsHash;
+
+    std::unordered_map<std::string, IndexEntry> m_entries;
+
+    std::ifstream m_readStream;
+    std::ofstream m_writeStream;
+
+    // End of the last intact entry, anything after it is truncated before appending
+    uint64_t      m_validSize = 0;
+    bool          m_headerValid = false;
+    bool          m_writeFailed = false;
+
+    Statistics    m_statistics;
+
+  };
+
+}
@@ -1,6 +1,7 @@
 #include "d3d9_shaders_hasher.h"
 #include "../util/log/log.h"
 #include "../util/util_string.h"
+#include "../dxvk/rtx_render/rtx_options.h"
 #include <filesystem>
 
 #include "../../lssusd/usd_include_begin.h"
@@ -13,11 +14,6 @@ using namespace pxr;
 namespace dxvk {
 
   namespace helpers {
-    void directCopy(const void* value, std::vector<float>& dst, size_t size) {
-      dst.resize(size);
-
-      memcpy(dst.data(), (float*)value, size);
-    }
     inline uint32_t compute_crc32(const uint8_t* data, size_t size) {
       static constexpr uint32_t crc32_table[256] = { // CRC polynomial 0xEDB88320
         0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3,
@@ -61,7 +57,9 @@ namespace dxvk {
     }
   }
 
-  ShadersHasher::ShadersHasher() { }
+  ShadersHasher::ShadersHasher()
+  : m_semanticTable(D3D9ConstantSemanticTable::parse(RtxOptions::shaderConstantSemantics())),
+    m_worldSemantic(m_semanticTable.find(D3D9ConstantRole::WorldMatrix)) { }
 
 
   void ShadersHasher::parseShaderAsm(uint32_t shader_hash, ShaderDesc& shaderDesc, ShaderType shaderType) {
@@ -69,61 +67,29 @@ namespace dxvk {
     GetModuleFileNameW(nullptr, file_prefix, ARRAYSIZE(file_prefix));
     std::filesystem::path asmPath = file_prefix;
     asmPath = asmPath.parent_path();
-    if (shaderType == ShaderType::Vertex) {
-      asmPath /= "DumpShader/Vertex/asm";
-      std::string hash = std::to_string(shader_hash);
-      asmPath /= hash + ".asm";
-      std::ifstream file(asmPath);
-
-      std::string line;
-      while (getline(file, line)) {
-        if (line.find("gFadeColor") != std::string::npos) {
-          shaderDesc.constantVs.emplace(2);
-
-        }
-        if (line.find("gMaterialDiffuse") != std::string::npos) {
-          shaderDesc.constantVs.emplace(170);
-
-        }
-        if (line.find("gMaterialAlbedo") != std::string::npos) {
-          shaderDesc.constantVs.emplace(171);
-
-        }
-        if (line.find("gMatPower") != std::string::npos) {
-          shaderDesc.constantVs.emplace(4);
-
-        }
-        if (line.find("gAmbientColor") != std::string::npos) {
-          shaderDesc.constantVs.emplace(1);
-
+    asmPath /= shaderType == ShaderType::Vertex ? "DumpShader/Vertex/asm" : "DumpShader/Pixel/asm";
+    std::string hash = std::to_string(shader_hash);
+    asmPath /= hash + ".asm";
+    std::ifstream file(asmPath);
+
+    const uint32_t stage = 1u << (uint32_t) shaderType;
+    const auto& semantics = m_semanticTable.getSemantics();
+    auto& constants = shaderType == ShaderType::Vertex ? shaderDesc.constantVs : shaderDesc.constantPs;
+
+    std::string line;
+    while (getline(file, line)) {
+      for (uint32_t i = 0; i < semantics.size(); ++i) {
+        if ((semantics[i].stages & stage) && !semantics[i].name.empty() && line.find(semantics[i].name) != std::string::npos) {
+          constants.emplace(shaderDesc.semantics.getRegister(i, semantics[i].reg));
         }
-        if (line.find("gDepthView") != std::string::npos) {
-          shaderDesc.constantVs.emplace(186);
-        }
-      }
-      file.close();
-    } else {
-      asmPath /= "DumpShader/Pixel/asm";
-      std::string hash = std::to_string(shader_hash);
-      asmPath /= hash + ".asm";
-      std::ifstream file(asmPath);
-
-      std::string line;
-      while (getline(file, line)) {
-        if (line.find("gMaterialDiffuse") != std::string::npos) {
-          shaderDesc.constantPs.emplace(170);
-        }
-        if (line.find("gMaterialAlbedo") != std::string::npos) {
-          shaderDesc.constantPs.emplace(171);
-        }
-
       }
-      file.close();
     }
+    file.close();
 
+    shaderDesc.updateConstantMasks();
   }
 
-  void ShadersHasher::hashShader(VkShaderStageFlagBits shaderType, const DWORD* pFunction, uint64_t shader) {
+  void ShadersHasher::hashShader(VkShaderStageFlagBits shaderType, const DWORD* pFunction, const std::vector<DxsoCtab::Constant>& constantTable, uint64_t shader) {
 
 
     uint32_t size = sizeof(DWORD);
@@ -131,151 +97,89 @@ namespace dxvk {
       size += sizeof(DWORD);
 
     uint32_t shader_hash = helpers::compute_crc32(reinterpret_cast<const uint8_t*>(pFunction), size);
-    ShaderDesc desc;
+
+    ShaderType type;
     switch (shaderType) {
     case VK_SHADER_STAGE_VERTEX_BIT:
-    {
-      m_shaders[(uint32_t) ShaderType::Vertex].try_emplace(shader_hash, std::move(desc));
-      m_shadersToHash[(uint32_t) ShaderType::Vertex].try_emplace(shader, shader_hash);
+      type = ShaderType::Vertex;
       break;
-    }
     case VK_SHADER_STAGE_FRAGMENT_BIT:
-    {
-      m_shaders[(uint32_t) ShaderType::Pixel].try_emplace(shader_hash, std::move(desc));
-      m_shadersToHash[(uint32_t) ShaderType::Pixel].try_emplace(shader, shader_hash);
+      type = ShaderType::Pixel;
       break;
-    }
     default:
       Logger::err("Unsupported Shader Type");
-      break;
+      return;
+    }
+
+    auto [it, inserted] = m_shaders[(uint32_t) type].try_emplace(shader_hash, ShaderDesc());
+    m_shadersToHash[(uint32_t) type].try_emplace(shader, ShaderHash { shader_hash, &it->second });
+
+    // Find the registers of the semantics from the names in the constant table
+    ShaderDesc& desc = it->second;
+    desc.semantics = m_semanticTable.resolve(1u << (uint32_t) type, constantTable);
+
+    // The profile decides which constants known shaders use, new ones use what their constant table names
+    if (inserted) {
+      auto& constants = type == ShaderType::Vertex ? desc.constantVs : desc.constantPs;
+
+      for (uint32_t i = 0; i < m_semanticTable.getSemantics().size(); ++i) {
+        if (desc.semantics.isResolved(i))
+          constants.emplace(desc.semantics.getRegister(i, 0));
+      }
+
+      desc.updateConstantMasks();
     }
   }
 
   void ShadersHasher::bindShader(VkShaderStageFlagBits shaderType, uint64_t shader) {
+    ShaderType type;
     switch (shaderType) {
     case VK_SHADER_STAGE_VERTEX_BIT:
-    {
-      m_currentBindedShader[(uint32_t) ShaderType::Vertex] = shader;
-      m_shadersBinded[(uint32_t) ShaderType::Vertex].emplace(shader);
+      type = ShaderType::Vertex;
       break;
-    }
     case VK_SHADER_STAGE_FRAGMENT_BIT:
-    {
-      m_currentBindedShader[(uint32_t) ShaderType::Pixel] = shader;
-      m_shadersBinded[(uint32_t) ShaderType::Pixel].emplace(shader);
+      type = ShaderType::Pixel;
       break;
-    }
     default:
       Logger::err("Unsupported Shader Type");
-      break;
+      return;
     }
 
-    m_preUIBindedThisFrame |= isShaderBindedHasFlag(ShaderFlags::UI_Hook);
-  }
-
-  bool ShadersHasher::isPreUIBinded() {
-    return m_preUIBindedThisFrame;
-  }
-
-  bool ShadersHasher::isShaderBindedActivated() {
-
-    for (uint32_t i = 0; i < (uint32_t) ShaderType::Count; ++i) {
-      auto it = m_shadersToHash[i].find(m_currentBindedShader[i]);
-      if (it != m_shadersToHash[i].end()) {
-        auto itShader = m_shaders[i].find(it->second);
-        if (itShader != m_shaders[i].end() && itShader->second.activated == false) {
-          return false;
-        }
-      }
-    }
-
-    return true;
-  }
-
-  bool ShadersHasher::isShaderBindedConstant(uint32_t constant, ShaderType shaderType) {
-
-    uint32_t i = (uint32_t) shaderType;
-
-    {
-      auto it = m_shadersToHash[i].find(m_currentBindedShader[i]);
-      if (it != m_shadersToHash[i].end()) {
-        auto itShader = m_shaders[i].find(it->second);
-        if (shaderType == ShaderType::Vertex) {
-          if (itShader != m_shaders[i].end() && itShader->second.constantVs.find(constant) != itShader->second.constantVs.end()) {
-            return true;
-          }
-        } else {
-          if (itShader != m_shaders[i].end() && itShader->second.constantPs.find(constant) != itShader->second.constantPs.end()) {
-            return true;
-          }
-        }
-      }
+    // Resolve the descriptor once, the per-draw queries only look at the snapshot
+    auto it = m_shadersToHash[(uint32_t) type].find(shader);
+    if (it != m_shadersToHash[(uint32_t) type].end()) {
+      m_boundShaders.bind(type, it->second.hash, it->second.desc);
+    } else {
+      m_boundShaders.bind(type, 0, nullptr);
     }
 
-    return false;
+    m_preUIBindedThisFrame |= isShaderBindedHasFlag(ShaderFlags::UI_Hook);
   }
 
   void ShadersHasher::reset() {
     m_preUIBindedThisFrame = false;
 
-    for (uint32_t i = 0; i < (uint32_t) ShaderType::Count; ++i) {
-      m_shadersBinded[i].clear();
-    }
+    m_boundShaders.nextFrame();
   }
 
   void ShadersHasher::pushConstant(DxsoProgramTypes::DxsoProgramType shaderType, D3D9ConstantType constantType, UINT startRegister, UINT vector4fCount, const void* pConstantData) {
-    uint32_t hash = 0;
-
-    auto itShader = m_shadersToHash[(uint32_t) shaderType].find(m_currentBindedShader[(uint32_t) shaderType]);
-    if (itShader != m_shadersToHash[(uint32_t) shaderType].end()) {
-      hash = itShader->second;
-    }
+    uint32_t hash = m_boundShaders.get((ShaderType) shaderType).hash;
 
-    bool bindedWorldMatrix = shaderType == DxsoProgramTypes::DxsoProgramType::VertexShader && startRegister == 195;
+    bool bindedWorldMatrix = shaderType == DxsoProgramTypes::DxsoProgramType::VertexShader && m_worldSemantic >= 0
+                          && startRegister == getSemanticRegister(m_worldSemantic, ShaderType::Vertex);
     if (bindedWorldMatrix) {
-      auto itShaderDesc = m_shaders[(uint32_t) shaderType].find(hash);
-      if (itShaderDesc != m_shaders[(uint32_t) shaderType].end()) {
-        itShaderDesc->second.bindedWorldMatrix = bindedWorldMatrix;
-      }
+      m_boundShaders.setWorldBinded(ShaderType::Vertex);
     }
 
-    auto [it, inserted] = m_constants[(uint32_t) constantType].try_emplace(hash);
-    auto bindingIt = std::find_if(it->second.begin(), it->second.end(), [startRegister](const Constant& constant) { return constant.m_startRegister == startRegister; });
+    std::lock_guard<dxvk::mutex> lock(m_constantMutex);
 
-    std::vector<float> cpy;
-
-    helpers::directCopy(pConstantData, cpy, vector4fCount * 4 * sizeof(float));
-
-    if (bindingIt == it->second.end()) {
-      Constant constant = Constant { startRegister, vector4fCount * sizeof(float), std::move(cpy) };
-      it->second.push_back(std::move(constant));
-    } else {
-      bindingIt->m_copy = std::move(cpy);
+    ConstantTarget& target = m_constantTargets[(uint32_t) shaderType][(uint32_t) constantType];
+    if (target.shadow == nullptr || target.hash != hash) {
+      target = ConstantTarget { hash, &m_constants[(uint32_t) constantType][hash] };
     }
 
-  }
-
-  bool ShadersHasher::isShaderWorldBinded() {
-    for (uint32_t i = 0; i < (uint32_t) ShaderType::Count; ++i) {
-      auto it = m_shadersToHash[i].find(m_currentBindedShader[i]);
-      if (it != m_shadersToHash[i].end()) {
-        auto itShader = m_shaders[i].find(it->second);
-        if (itShader != m_shaders[i].end() && itShader->second.bindedWorldMatrix) {
-          return true;
-        }
-      }
-    }
-    return false;
-  }
-
-  bool ShadersHasher::isShaderHashBinded(uint32_t hash, ShaderType shaderType) {
-    auto it = std::find_if(m_shadersToHash[(uint32_t) shaderType].begin(), m_shadersToHash[(uint32_t) shaderType].end(), [hash](const std::pair<uint64_t, XXH64_hash_t>& p) {
-      return p.second == hash;
-    });
-    if (it != m_shadersToHash[(uint32_t) shaderType].end()) {
-      return m_shadersBinded[(uint32_t) shaderType].find(it->first) != m_shadersBinded[(uint32_t) shaderType].end();
-    }
-    return false;
+    // Bool constants are one BOOL per register
+    target.shadow->write(startRegister, vector4fCount, pConstantData, constantType == D3D9ConstantType::Bool ? 1 : 4);
   }
 
   static constexpr char* ShaderTypeStr[(uint32_t) ShaderType::Count] { "VertexShaders", "PixelShaders" };
@@ -316,6 +220,7 @@ namespace dxvk {
           auto constantPsAttr = shader.GetAttribute(TfToken("constantPs"));
           constantPsAttr.Get(&cPS);
           shaderDesc.constantPs = std::unordered_set<uint32_t>(cPS.begin(), cPS.end());
+          shaderDesc.updateConstantMasks();
 
           m_shaders[i].try_emplace(hash, std::move(shaderDesc));
         }
@@ -389,27 +294,16 @@ namespace dxvk {
     stage->GetRootLayer()->Save();
   }
 
-  bool ShadersHasher::isShaderBindedHasFlag(ShaderFlags flags) {
-    for (uint32_t i = 0; i < (uint32_t) ShaderType::Count; ++i) {
-      auto it = m_shadersToHash[i].find(m_currentBindedShader[i]);
-      if (it != m_shadersToHash[i].end()) {
-        auto itShader = m_shaders[i].find(it->second);
-        if (itShader != m_shaders[i].end() && (itShader->second.flags & flags) != ShaderFlags::None) {
-          return true;
-        }
-      }
-    }
-    return false;
-  }
+  std::vector<Constant> ShadersHasher::getConstants(D3D9ConstantType constantType, uint32_t hash, bool& founded) const {
+    std::lock_guard<dxvk::mutex> lock(m_constantMutex);
 
-  const std::vector<Constant>& ShadersHasher::getConstants(D3D9ConstantType constantType, uint32_t hash, bool& founded) const {
     auto it = m_constants[(uint32_t) constantType].find(hash);
     if (it != m_constants[(uint32_t) constantType].end()) {
       founded = true;
-      return it->second;
+      return it->second.getConstants();
     }
     founded = false;
-    return m_constants[(uint32_t) constantType].end()->second;
+    return { };
   }
 
 }
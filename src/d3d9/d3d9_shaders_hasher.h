@@ -5,63 +5,23 @@
 #include <d3d9.h>
 #include "../dxso/dxso_common.h"
 #include "d3d9_constant_set.h"
+#include "d3d9_bound_shaders.h"
+#include "d3d9_constant_semantics.h"
+#include "d3d9_constant_shadow.h"
+#include "../util/thread.h"
 
 namespace dxvk {
 
-  enum class ShaderFlags {
-    None = 0,
-    UI_Hook = 1 << 0
-  };
-
-  constexpr ShaderFlags operator~(ShaderFlags a) {
-    return static_cast<ShaderFlags>(~static_cast<uint32_t>(a));
-  }
-  inline ShaderFlags& operator&=(ShaderFlags& a, ShaderFlags b) {
-    return reinterpret_cast<ShaderFlags&>(reinterpret_cast<uint32_t&>(a) &= static_cast<uint32_t>(b));
-  }
-  constexpr ShaderFlags operator&(ShaderFlags a, ShaderFlags b) {
-    return static_cast<ShaderFlags>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
-  }
-  inline ShaderFlags& operator|=(ShaderFlags& a, ShaderFlags b) {
-    return reinterpret_cast<ShaderFlags&>(reinterpret_cast<uint32_t&>(a) |= static_cast<uint32_t>(b));
-  }
-  constexpr ShaderFlags operator|(ShaderFlags a, ShaderFlags b) {
-    return static_cast<ShaderFlags>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
-  }
-  inline ShaderFlags& operator^=(ShaderFlags& a, ShaderFlags b) {
-    return reinterpret_cast<ShaderFlags&>(reinterpret_cast<uint32_t&>(a) ^= static_cast<uint32_t>(b));
-  }
-  constexpr ShaderFlags operator^(ShaderFlags a, ShaderFlags b) {
-    return static_cast<ShaderFlags>(static_cast<uint32_t>(a) ^ static_cast<uint32_t>(b));
-  }
-
-  enum class ShaderType {
-    Vertex = 0,
-    Pixel = 1,
-    Count = 2,
-  };
-
-  struct ShaderDesc
-  {
-    ShaderFlags flags = ShaderFlags::None;
-    bool activated = true;
-
-    bool bindedWorldMatrix = false;
-    std::unordered_set<uint32_t> constantVs;
-    std::unordered_set<uint32_t> constantPs;
-  };
-
-  struct Constant {
-    uint32_t m_startRegister;
-    uint32_t m_vector4Count;
+  using ConstantList = std::unordered_map<uint32_t, ConstantShadow>;
+  using ShadersHashList = std::unordered_map<uint32_t, ShaderDesc>;
 
-    std::vector<float> m_copy;
+  struct ShaderHash {
+    uint32_t hash;
+    // Points into the ShadersHashList, whose elements never move
+    ShaderDesc* desc;
   };
 
-  using ConstantList = std::unordered_map<uint32_t, std::vector<Constant>>;
-  using ShadersHashList = std::unordered_map<uint32_t, ShaderDesc>;
-  using ShaderToHash = std::unordered_map<uint64_t, uint32_t>;
-  using ShaderBinded = std::unordered_set<uint64_t>;
+  using ShaderToHash = std::unordered_map<uint64_t, ShaderHash>;
 
   class ShadersHasher {
 
@@ -69,13 +29,18 @@ namespace dxvk {
 
     ShadersHasher();
 
-    void hashShader(VkShaderStageFlagBits shaderType, const DWORD* pFunction, uint64_t shader);
+    void hashShader(VkShaderStageFlagBits shaderType, const DWORD* pFunction, const std::vector<DxsoCtab::Constant>& constantTable, uint64_t shader);
 
     void bindShader(VkShaderStageFlagBits shaderType, uint64_t shader);
 
-    bool isPreUIBinded();
+    bool isPreUIBinded() const {
+      return m_preUIBindedThisFrame;
+    }
+
+    bool isShaderBindedActivated() const {
+      return m_boundShaders.isActivated();
+    }
 
-    bool isShaderBindedActivated();
     void reset();
 
     ShadersHashList& geShadersHashList(ShaderType shaderType) {
@@ -84,32 +49,84 @@ namespace dxvk {
 
     void pushConstant(DxsoProgramTypes::DxsoProgramType shaderType, D3D9ConstantType constantType, UINT startRegister, UINT vector4fCount ,const void* pConstantData);
 
-    bool isShaderWorldBinded();
+    bool isShaderWorldBinded() const {
+      return m_boundShaders.isWorldBinded();
+    }
+
+    // Not cached, this is called from the D3D9 and the ImGui threads
+    bool isShaderHashBinded(uint32_t hash, ShaderType shaderType) const {
+      const ShadersHashList& shaders = m_shaders[(uint32_t) shaderType];
+      auto it = shaders.find(hash);
+      return it != shaders.end() && isShaderBinded(it->second);
+    }
 
-    bool isShaderHashBinded(uint32_t hash, ShaderType shaderType);
+    bool isShaderBinded(const ShaderDesc& desc) const {
+      return m_boundShaders.wasBoundThisFrame(desc);
+    }
 
-    bool isShaderBindedConstant(uint32_t constant, ShaderType _shaderType);
+    bool isShaderBindedConstant(uint32_t constant, ShaderType shaderType) const {
+      return m_boundShaders.hasConstant(constant, shaderType);
+    }
 
     void loadProfil();
 
     void saveProfil();
-    bool isShaderBindedHasFlag(ShaderFlags flags);
 
-    const std::vector<Constant>& getConstants(D3D9ConstantType constantType, uint32_t hash, bool& founded) const;
+    bool isShaderBindedHasFlag(ShaderFlags flags) const {
+      return m_boundShaders.hasFlag(flags);
+    }
+
+    // Snapshot of the constants set for a shader, safe to call from the ImGui thread
+    std::vector<Constant> getConstants(D3D9ConstantType constantType, uint32_t hash, bool& founded) const;
+
+    const D3D9ConstantSemanticTable& getConstantSemantics() const {
+      return m_semanticTable;
+    }
+
+    /**
+     * \brief Register of a semantic in the bound shader
+     *
+     * \param [in] semantic Index into the semantic table
+     * \param [in] shaderType Stage of the shader
+     * \param [out] reg The register
+     * \returns \c true if the bound shader uses the register
+     */
+    bool getBoundSemanticRegister(uint32_t semantic, ShaderType shaderType, uint32_t& reg) const {
+      reg = getSemanticRegister(semantic, shaderType);
+      return m_boundShaders.hasConstant(reg, shaderType);
+    }
+
+    uint32_t getSemanticRegister(uint32_t semantic, ShaderType shaderType) const {
+      return m_boundShaders.get(shaderType).semantics.getRegister(semantic, m_semanticTable.getSemantics()[semantic].reg);
+    }
 
   private:
 
     void parseShaderAsm(uint32_t shader_hash, ShaderDesc& shaderDesc, ShaderType shaderType);
 
+    // Written on the D3D9 thread, read by the developer menu
+    mutable dxvk::mutex m_constantMutex;
     ConstantList m_constants[3];
 
     ShadersHashList m_shaders[(uint32_t)ShaderType::Count];
 
     ShaderToHash m_shadersToHash[(uint32_t) ShaderType::Count];
 
-    ShaderBinded m_shadersBinded[(uint32_t) ShaderType::Count];
+    D3D9ConstantSemanticTable m_semanticTable;
+
+    // Index of the world matrix semantic, -1 if the table has none
+    int32_t m_worldSemantic = -1;
+
+    BoundShaders m_boundShaders;
+
+    // Constants of the shader that constants were last set for, per program and constant type
+    struct ConstantTarget {
+      uint32_t hash;
+      // Points into m_constants, whose elements never move
+      ConstantShadow* shadow;
+    };
 
-    uint64_t m_currentBindedShader[(uint32_t) ShaderType::Count];
+    ConstantTarget m_constantTargets[(uint32_t) ShaderType::Count][3] = { };
 
 
     //Every draw after fall in rasterization
@@ -1209,6 +1209,11 @@ namespace dxvk {
       SubmitPresent(sync, i, imageIndex);
     }
 
+    // NV-DXVK start: option snapshots
+    // The UI has written this frame's option changes, publish them for the other threads
+    RtxOptionImpl::publishSnapshot();
+    // NV-DXVK end
+
     // Rotate swap chain buffers so that the back
     // buffer at index 0 becomes the front buffer.
     for (uint32_t i = 1; i < m_backBuffers.size(); i++)
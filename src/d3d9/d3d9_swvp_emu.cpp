@@ -1,6 +1,7 @@
 #include "d3d9_swvp_emu.h"
 
 #include "d3d9_device.h"
+#include "d3d9_shader.h"
 #include "d3d9_vertex_declaration.h"
 
 #include "../spirv/spirv_module.h"
@@ -326,11 +327,21 @@ namespace dxvk {
     DxvkShaderKey key = { VK_SHADER_STAGE_GEOMETRY_BIT , hash };
     std::string name = str::format("SWVP_", key.toString());
     
-    // This shader has not been compiled yet, so we have to create a
-    // new module. This takes a while, so we won't lock the structure.
-    D3D9SWVPEmulatorGenerator generator(name);
-    generator.compile(pDecl);
-    Rc<DxvkShader> shader = generator.finalize();
+    // NV-DXVK start: SWVP shaders generated in a previous session
+    Rc<DxvkShader> shader = LoadCachedShader(pDevice->GetShaderDiskCache(),
+      D3D9ShaderCacheKind::SWVP, elements.data(), elements.size() * sizeof(elements[0]));
+
+    if (shader == nullptr) {
+      // This shader has not been compiled yet, so we have to create a
+      // new module. This takes a while, so we won't lock the structure.
+      D3D9SWVPEmulatorGenerator generator(name);
+      generator.compile(pDecl);
+      shader = generator.finalize();
+
+      StoreCachedShader(pDevice->GetShaderDiskCache(),
+        D3D9ShaderCacheKind::SWVP, elements.data(), elements.size() * sizeof(elements[0]), shader);
+    }
+    // NV-DXVK end
 
     shader->setShaderKey(key);
     pDevice->GetDXVKDevice()->registerShader(shader);
@@ -29,6 +29,10 @@
 
 namespace dxvk {
   
+  // NV-DXVK start: unique buffer identifier
+  std::atomic<uint64_t> DxvkBuffer::s_cookie = { 0ull };
+  // NV-DXVK end
+
   DxvkBuffer::DxvkBuffer(
           DxvkDevice*           device,
     const DxvkBufferCreateInfo& createInfo,
@@ -353,6 +353,20 @@ namespace dxvk {
     }
     // NV-DXVK end
 
+    // NV-DXVK start: unique buffer identifier
+    /**
+     * \brief Unique object identifier
+     *
+     * Can be used to identify an object even when
+     * the lifetime of the object is unknown, and
+     * without referencing the actual object.
+     * \returns Unique identifier
+     */
+    uint64_t cookie() const {
+      return m_cookie;
+    }
+    // NV-DXVK end
+
   protected:
     DxvkDevice*             m_device;
     DxvkBufferCreateInfo    m_info;
@@ -384,6 +398,12 @@ namespace dxvk {
     DxvkMemoryStats::Category m_category;
     GpuMemoryTracker m_tracker;
 
+    // NV-DXVK start: unique buffer identifier
+    uint64_t m_cookie = ++s_cookie;
+
+    static std::atomic<uint64_t> s_cookie;
+    // NV-DXVK end
+
     void pushSlice(const DxvkBufferHandle& handle, uint32_t index) {
       DxvkBufferSliceHandle slice;
       slice.handle = handle.buffer;
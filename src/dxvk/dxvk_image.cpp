@@ -256,6 +256,27 @@ namespace dxvk {
   }
 
 
+  // NV-DXVK start: Hashes to identify textures.
+  void DxvkImage::setPendingHash(const Rc<DxvkPendingHash>& pendingHash) {
+    std::lock_guard<dxvk::mutex> lock(m_pendingHashMutex);
+    m_pendingHash = pendingHash;
+    m_hashPending.store(true, std::memory_order_release);
+  }
+
+
+  void DxvkImage::resolvePendingHash() const {
+    std::lock_guard<dxvk::mutex> lock(m_pendingHashMutex);
+
+    if (m_pendingHash == nullptr)
+      return;
+
+    m_hash = m_pendingHash->wait();
+    m_pendingHash = nullptr;
+    m_hashPending.store(false, std::memory_order_release);
+  }
+  // NV-DXVK end
+
+
   HANDLE DxvkImage::sharedHandle() const {
     HANDLE handle = INVALID_HANDLE_VALUE;
 
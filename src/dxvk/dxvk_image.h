@@ -154,6 +154,46 @@ namespace dxvk {
     VkImage     image = VK_NULL_HANDLE;
     DxvkMemory  memory;
   };
+
+  // NV-DXVK start: Hashes to identify textures.
+  /**
+   * \brief Image hash computed on a worker thread
+   *
+   * Set once by the worker, consumers block in \ref wait
+   * until the hash is available.
+   */
+  class DxvkPendingHash : public RcObject {
+  public:
+
+    void set(XXH64_hash_t hash) {
+      { std::lock_guard<dxvk::mutex> lock(m_mutex);
+        m_hash = hash;
+        m_ready.store(true, std::memory_order_release);
+      }
+      m_cond.notify_all();
+    }
+
+    bool isReady() const {
+      return m_ready.load(std::memory_order_acquire);
+    }
+
+    XXH64_hash_t wait() {
+      if (!isReady()) {
+        std::unique_lock<dxvk::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this] { return isReady(); });
+      }
+      return m_hash;
+    }
+
+  private:
+
+    dxvk::mutex              m_mutex;
+    dxvk::condition_variable m_cond;
+    std::atomic<bool>        m_ready = { false };
+    XXH64_hash_t             m_hash = 0;
+
+  };
+  // NV-DXVK end
   
   /**
    * \brief DXVK image
@@ -352,7 +392,23 @@ namespace dxvk {
       m_hash = hash;
     }
 
+    /**
+     * \brief Sets a hash that is still being computed
+     *
+     * The first \ref getHash call that needs it waits for it.
+     */
+    void setPendingHash(const Rc<DxvkPendingHash>& pendingHash);
+
+    /**
+     * \brief Checks whether the image has or will have a hash, without waiting for it
+     */
+    bool hasHash() const {
+      return m_hashPending.load(std::memory_order_acquire) || m_hash != 0;
+    }
+
     XXH64_hash_t getHash() const {
+      if (unlikely(m_hashPending.load(std::memory_order_acquire)))
+        resolvePendingHash();
       return m_hash;
     }
 
@@ -398,8 +454,13 @@ namespace dxvk {
     VkMemoryPropertyFlags m_memFlags;
     DxvkPhysicalImage     m_image;
     // NV-DXVK start: Hashes to identify textures.
-    XXH64_hash_t          m_hash = 0;
-    XXH64_hash_t          m_descriptorHash = 0;
+    mutable XXH64_hash_t          m_hash = 0;
+    XXH64_hash_t                  m_descriptorHash = 0;
+    mutable dxvk::mutex           m_pendingHashMutex;
+    mutable Rc<DxvkPendingHash>   m_pendingHash;
+    mutable std::atomic<bool>     m_hashPending = { false };
+
+    void resolvePendingHash() const;
     // NV-DXVK end
     bool m_shared = false;
 
@@ -3,6 +3,10 @@
 
 namespace dxvk {
 
+  // NV-DXVK start
+  std::atomic<uint64_t> DxvkSampler::s_cookie = { 0ull };
+  // NV-DXVK end
+
   DxvkSampler::DxvkSampler(
           DxvkDevice*             device,
     const DxvkSamplerCreateInfo&  info)
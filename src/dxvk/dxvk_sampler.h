@@ -92,6 +92,17 @@ namespace dxvk {
     const XXH64_hash_t hash() const {
       return m_hash;
     }
+
+    /**
+     * \brief Unique object identifier
+     *
+     * Unlike the handle, never reused by
+     * a sampler created later on.
+     * \returns Unique identifier
+     */
+    uint64_t cookie() const {
+      return m_cookie;
+    }
     // NV-DXVK end
     
   private:
@@ -101,6 +112,9 @@ namespace dxvk {
     // NV-DXVK start
     DxvkSamplerCreateInfo   m_createInfo;
     XXH64_hash_t m_hash;
+    uint64_t m_cookie = ++s_cookie;
+
+    static std::atomic<uint64_t> s_cookie;
     // NV-DXVK end
 
     static VkBorderColor getBorderColor(
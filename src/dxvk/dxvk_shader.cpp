@@ -107,7 +107,9 @@ namespace dxvk {
           SpirvCodeBuffer         code,
     const DxvkShaderOptions&      options,
           DxvkShaderConstData&&   constData)
-  : m_stage(stage), m_code(code), m_interface(iface),
+  // NV-DXVK start: shaders stay resident for the lifetime of the device, use the LZ4 tier
+  : m_stage(stage), m_code(code, true), m_interface(iface),
+  // NV-DXVK end
     m_options(options), m_constData(std::move(constData)) {
     // Write back resource slot infos
     for (uint32_t i = 0; i < slotCount; i++)
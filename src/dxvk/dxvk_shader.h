@@ -184,6 +184,22 @@ namespace dxvk {
       return !m_slots.empty();
     }
 
+    // NV-DXVK start: expose the shader contents, e.g. to store them in a disk cache
+    /**
+     * \brief Resource slot definitions
+     */
+    const std::vector<DxvkResourceSlot>& resourceSlots() const {
+      return m_slots;
+    }
+
+    /**
+     * \brief Compressed SPIR-V code
+     */
+    const SpirvCompressedBuffer& compressedCode() const {
+      return m_code;
+    }
+    // NV-DXVK end
+
     /**
      * \brief Creates a shader module
      * 
@@ -38,8 +38,16 @@ namespace dxvk {
     RtxVolumeMaterialCount,            ///< Number of volume materials in the scene
     RtxLightCount,                     ///< Number of lights currently present in the scene
     RtxSamplers,                       ///< Number of samplers currently present in the scene
+    RtxSceneDataUploadBytes,           ///< Number of bytes of surface and material data uploaded this frame
+    RtxBindlessDescriptorWrites,       ///< Number of bindless descriptors written this frame
+    RtxBonePaletteHitRate,             ///< Percentage of skinned draws this frame whose bone palette was already staged
+    RtxConstantUploadsSkipped,         ///< Number of D3D9 constant buffer uploads this frame skipped because the constants were unchanged
+    RtxConstantUploadBytesSaved,       ///< Number of bytes of D3D9 constants not uploaded this frame
     RtxTexturesInFlight,               ///< Number of texture currently being loaded
     RtxLastTextureBatchDuration,       ///< Duration in ms of the last processed texture batch
+    RtxFrameArenaAllocations,          ///< Number of allocations served by the frame arena this frame
+    RtxFrameArenaBytes,                ///< Number of bytes allocated from the frame arena this frame
+    RtxFrameArenaHeapFallbacks,        ///< Number of frame arena allocations this frame too large for its blocks
     // NV-DXVK end
 
     NumCounters,              ///< Number of counters available
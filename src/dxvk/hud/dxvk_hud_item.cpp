@@ -823,8 +823,16 @@ namespace dxvk::hud {
                                    "# Volume Materials:" , 
                                    "# Lights:",
                                    "# Samplers:",
+                                   "# Scene data upload (B):",
+                                   "# Bindless desc. writes:",
+                                   "# Bone palette hits (%):",
+                                   "# Const. uploads skipped:",
+                                   "# Const. bytes saved:",
                                    "# Textures in-flight:",
-                                   "# Last tex. batch (ms):"}; 
+                                   "# Last tex. batch (ms):",
+                                   "# Frame arena allocs:",
+                                   "# Frame arena (KB):",
+                                   "# Frame arena heap allocs:"}; 
     const uint64_t values[] = { counters.getCtr(DxvkStatCounter::QueuePresentCount),
                                 counters.getCtr(DxvkStatCounter::RtxBlasCount),
                                 counters.getCtr(DxvkStatCounter::RtxBufferCount),
@@ -835,8 +843,16 @@ namespace dxvk::hud {
                                 counters.getCtr(DxvkStatCounter::RtxVolumeMaterialCount),
                                 counters.getCtr(DxvkStatCounter::RtxLightCount),
                                 counters.getCtr(DxvkStatCounter::RtxSamplers),
+                                counters.getCtr(DxvkStatCounter::RtxSceneDataUploadBytes),
+                                counters.getCtr(DxvkStatCounter::RtxBindlessDescriptorWrites),
+                                counters.getCtr(DxvkStatCounter::RtxBonePaletteHitRate),
+                                counters.getCtr(DxvkStatCounter::RtxConstantUploadsSkipped),
+                                counters.getCtr(DxvkStatCounter::RtxConstantUploadBytesSaved),
                                 counters.getCtr(DxvkStatCounter::RtxTexturesInFlight),
-                                counters.getCtr(DxvkStatCounter::RtxLastTextureBatchDuration)};
+                                counters.getCtr(DxvkStatCounter::RtxLastTextureBatchDuration),
+                                counters.getCtr(DxvkStatCounter::RtxFrameArenaAllocations),
+                                counters.getCtr(DxvkStatCounter::RtxFrameArenaBytes) / 1024,
+                                counters.getCtr(DxvkStatCounter::RtxFrameArenaHeapFallbacks)};
 
     const uint32_t kNumLabels = sizeof(labels) / sizeof(labels[0]);
     static_assert(kNumLabels == sizeof(values) / sizeof(values[0]));
@@ -2874,6 +2874,7 @@ namespace dxvk {
         AreaManager& areaManager = device->getAreaManager();
         ImGui::Text("Time %u",areaManager.getTime());
 
+        auto areaLock = areaManager.lockCurrentArea();
         AreaData& currentArea = areaManager.getCurrentAreaData();
 
         if (ImGui::TreeNode("Current Area")) {
@@ -2933,7 +2934,7 @@ namespace dxvk {
               continue;
             bool binded = true;
             if (selectedItem > 0) {
-              binded = shaderHasher.isShaderHashBinded(hash, _shaderType);
+              binded = shaderHasher.isShaderBinded(desc);
             }
             if (selectedItem == 2 && binded == false) {
               continue;
@@ -2977,7 +2978,7 @@ namespace dxvk {
                 for (uint32_t type = 0; type < 3; ++type) {
                   if (ImGui::TreeNode(constantTtype[type])) {
                     bool founded = false;
-                    const std::vector<Constant>& constants = shaderHasher.getConstants((D3D9ConstantType) type, hash, founded);
+                    const std::vector<Constant> constants = shaderHasher.getConstants((D3D9ConstantType) type, hash, founded);
                     if (founded) {
                       for (const Constant& constant : constants) {
                         ImGui::Text("Start Register %u", constant.m_startRegister);
@@ -2985,7 +2986,7 @@ namespace dxvk {
                         ImGui::Text("Count %u", constant.m_vector4Count);
                         ImGui::PushID(constant.m_startRegister);
                         if (ImGui::TreeNode("Value")) {
-                          printBuffer(constant.m_copy, constant.m_vector4Count * 4);
+                          printBuffer(constant.m_copy, constant.m_copy.size() * sizeof(float));
                           ImGui::TreePop();
                         }
                         ImGui::PopID();
@@ -251,6 +251,10 @@ namespace dxvk {
 
   void ImGuiCapture::Progress::update(const Rc<DxvkContext>& ctx) {
     const auto& state = ctx->getCommonObjects()->capturer()->getState();
+    if (state == m_prevState && state.has<GameCapturer::State::Exporting>()) {
+      m_percent = 0.60f + 0.40f * ctx->getCommonObjects()->capturer()->getExportProgress();
+      return;
+    }
     if (state != m_prevState) {
       m_prevState = state;
       m_output.clear();
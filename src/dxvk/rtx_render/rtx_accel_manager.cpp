@@ -54,6 +54,7 @@ namespace dxvk {
     //    // only allocated with a 64 byte alignment.
     //    // Note: This could use the value of m_scratchAlignment, but this is duplicated to avoid potential future initialization order issues.
     , m_scratchAlignment(device->properties().khrDeviceAccelerationStructureProperties.minAccelerationStructureScratchOffsetAlignment) {
+    m_surfaceStagingAlloc = std::make_unique<RtxStagingDataAlloc>(device, "RtxStagingDataAlloc: Surface Buffer");
   }
 
   void AccelManager::clear() {
@@ -384,11 +385,12 @@ namespace dxvk {
       Logger::debug("DxvkRaytrace: Vulkan Transform Buffer Realloc");
     }
 
-    std::vector<VkTransformMatrixKHR> instanceTransforms;
+    // Per-instance build inputs only live until the builds are recorded, so they come from the frame arena
+    frame_vector<VkTransformMatrixKHR> instanceTransforms;
     instanceTransforms.reserve(instances.size());
 
-    std::vector<VkAccelerationStructureBuildGeometryInfoKHR> blasToBuild;
-    std::vector<VkAccelerationStructureBuildRangeInfoKHR*> blasRangesToBuild;
+    frame_vector<VkAccelerationStructureBuildGeometryInfoKHR> blasToBuild;
+    frame_vector<VkAccelerationStructureBuildRangeInfoKHR*> blasRangesToBuild;
 
     blasToBuild.reserve(instances.size());
     blasRangesToBuild.reserve(instances.size());
@@ -414,7 +416,7 @@ namespace dxvk {
     size_t totalScratchMemory = 0;
 
     // NOTE: Would like to use the BLAS Linked instances here, but that misses viewmodel and virtual instances
-    std::unordered_map<BlasEntry*, std::vector<RtInstance*>> uniqueBlas;
+    frame_unordered_map<BlasEntry*, frame_vector<RtInstance*>> uniqueBlas;
 
     for (RtInstance* instance : instances) {
       if (instance->isHidden()) {
@@ -519,7 +521,7 @@ namespace dxvk {
     }
 
     // Build/Update the dynamic BLAS
-    for (const std::pair<BlasEntry*, std::vector<RtInstance*>> pair : uniqueBlas) {
+    for (const auto& pair : uniqueBlas) {
       BlasEntry* blasEntry = pair.first;
       if (pair.second.size() == 0) {
         continue;
@@ -730,8 +732,8 @@ namespace dxvk {
 
   void AccelManager::createBlasBuffersAndInstances(Rc<DxvkContext> ctx, 
                                                    const std::vector<std::unique_ptr<BlasBucket>>& blasBuckets,
-                                                   std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
-                                                   std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
+                                                   frame_vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
+                                                   frame_vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
                                                    size_t& totalScratchMemory) {
 
     const uint32_t currentFrame = m_device->getCurrentFrameId();
@@ -1024,12 +1026,14 @@ namespace dxvk {
 
   void AccelManager::uploadSurfaceData(Rc<DxvkContext> ctx) {
     ScopedCpuProfileZone();
+    m_surfaceUploadBytes = 0;
     if (m_reorderedSurfaces.empty()) {
       return;
     }
 
     // Simplify syntax for accessing the persistent containers
     auto& surfacesGPUData = uploadSurfaceDataFuncState.surfacesGPUData;
+    auto& surfacesDirtyTracker = uploadSurfaceDataFuncState.surfacesDirtyTracker;
     auto& surfaceIndexMapping = uploadSurfaceDataFuncState.surfaceIndexMapping;
 
     // Surface buffer
@@ -1044,22 +1048,29 @@ namespace dxvk {
     info.size = align(surfacesGPUSize, kBufferAlignment);
     if (m_surfaceBuffer == nullptr || info.size > m_surfaceBuffer->info().size) {
       m_surfaceBuffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXAccelerationStructure, "Surface Buffer");
+      surfacesDirtyTracker.invalidate();
     }
 
     uint32_t maxPreviousSurfaceIndex = 0;
 
-    // Write surface data
-    std::size_t dataOffset = 0;
+    // Write surface data. Surfaces are rebuilt every frame and have no stable tag, so each one is written to
+    // a scratch element and compared against last frame's contents, only the surfaces that changed are uploaded.
     surfacesGPUData.resize(surfacesGPUSize);
+    surfacesDirtyTracker.beginFrame(m_reorderedSurfaces.size());
 
     for (uint32_t i = 0; i < m_reorderedSurfaces.size(); ++i) {
       const auto& currentInstance = *m_reorderedSurfaces[i];
       RtSurface& currentSurface = m_reorderedSurfaces[i]->surface;
 
       // Split instance geometry need to have their first index offset set in their corresponding surface instances
+      unsigned char surfaceGPUData[kSurfaceGPUSize] = {};
+      std::size_t dataOffset = 0;
       currentSurface.firstIndex += m_reorderedSurfacesFirstIndexOffset[i];
-      currentSurface.writeGPUData(surfacesGPUData.data(), dataOffset, i);
+      currentSurface.writeGPUData(surfaceGPUData, dataOffset, i);
       currentSurface.firstIndex -= m_reorderedSurfacesFirstIndexOffset[i];
+      assert(dataOffset == kSurfaceGPUSize);
+
+      surfacesDirtyTracker.updateData(i, surfaceGPUData, surfacesGPUData.data(), kSurfaceGPUSize);
 
       // Find the size of the surface mapping buffer
       if (currentInstance.surface.instancesToObject) {
@@ -1069,10 +1080,9 @@ namespace dxvk {
       }
     }
 
-    assert(dataOffset == surfacesGPUSize);
     assert(surfacesGPUData.size() == surfacesGPUSize);
 
-    ctx->writeToBuffer(m_surfaceBuffer, 0, surfacesGPUData.size(), surfacesGPUData.data());
+    m_surfaceUploadBytes = surfacesDirtyTracker.upload(ctx, *m_surfaceStagingAlloc, m_surfaceBuffer, surfacesGPUData.data(), kSurfaceGPUSize);
 
     // Allocate and initialize the surface mapping buffer
     surfaceIndexMapping.resize(maxPreviousSurfaceIndex + 1);
@@ -1147,8 +1157,8 @@ namespace dxvk {
                                  const std::vector<TextureRef>& textures,
                                  const std::vector<RtInstance*>& instances,
                                  const std::vector<std::unique_ptr<BlasBucket>>& blasBuckets,
-                                 std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
-                                 std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
+                                 frame_vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
+                                 frame_vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
                                  float frameTimeMilliseconds,
                                  size_t& totalScratchMemory) {
     ScopedGpuProfileZone(ctx, "buildBLAS");
@@ -29,8 +29,10 @@
 #include "rtx_types.h"
 #include "rtx_common_object.h"
 #include "rtx_staging.h"
+#include "rtx_dirty_range_tracker.h"
 #include "../util/util_vector.h"
 #include "../util/util_matrix.h"
+#include "../util/util_frame_arena.h"
 
 namespace dxvk 
 {
@@ -108,6 +110,8 @@ public:
   static uint32_t getBlasCount();
 
   uint32_t getSurfaceCount() const { return m_reorderedSurfaces.size(); }
+  // Bytes of surface data uploaded by the last uploadSurfaceData()
+  size_t getSurfaceUploadBytes() const { return m_surfaceUploadBytes; }
   const std::vector<RtInstance*>& getOrderedInstances() const { return m_reorderedSurfaces; }
 
 private:
@@ -126,6 +130,7 @@ private:
   // Persistent containers to reduce frame to frame reallocations in ::uploadSurfaceData()
   struct {
     std::vector<unsigned char> surfacesGPUData;
+    DirtyRangeTracker surfacesDirtyTracker;
     std::vector<uint32_t> surfaceIndexMapping;
   } uploadSurfaceDataFuncState;
 
@@ -133,15 +138,15 @@ private:
                    const CameraManager& cameraManager, OpacityMicromapManager* opacityMicromapManager, const InstanceManager& instanceManager,
                    const std::vector<TextureRef>& textures, const std::vector<RtInstance*>& instances,
                    const std::vector<std::unique_ptr<BlasBucket>>& blasBuckets, 
-                   std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
-                   std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
+                   frame_vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
+                   frame_vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
                    float elapsedTime,
                    size_t& currentScratchOffset);
   void addBlas(RtInstance* instance, BlasEntry* blasEntry, const Matrix4* instanceToObject);
   void createBlasBuffersAndInstances(Rc<DxvkContext> ctx, 
                                      const std::vector<std::unique_ptr<BlasBucket>>& blasBuckets,
-                                     std::vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
-                                     std::vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
+                                     frame_vector<VkAccelerationStructureBuildGeometryInfoKHR>& blasToBuild,
+                                     frame_vector<VkAccelerationStructureBuildRangeInfoKHR*>& blasRangesToBuild,
                                      size_t& currentScratchOffset);
   template<Tlas::Type type>
   void internalBuildTlas(Rc<DxvkContext> ctx, size_t& totalScratchSize);
@@ -157,6 +162,8 @@ private:
 
   Rc<DxvkBuffer> m_vkInstanceBuffer; // Note: Holds Vulkan AS Instances, not RtInstances
   Rc<DxvkBuffer> m_surfaceBuffer;
+  std::unique_ptr<RtxStagingDataAlloc> m_surfaceStagingAlloc;
+  size_t m_surfaceUploadBytes = 0;
   Rc<DxvkBuffer> m_surfaceMappingBuffer;
   Rc<DxvkBuffer> m_transformBuffer;
   Rc<DxvkBuffer> m_primitiveIDPrefixSumBuffer;
@@ -0,0 +1,406 @@
+#pragma once
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../../util/thread.h"
+#include "../../util/util_env.h"
+#include "../../util/util_string.h"
+#include "../../util/log/log.h"
+
+namespace dxvk {
+
+  /**
+   * \brief Cache of area data loaded on demand
+   *
+   * Areas are loaded by a background thread into immutable snapshots,
+   * prefetching the areas reachable from the current one so that a
+   * transition finds its data loaded. Areas that aren't pinned are
+   * evicted least recently used first once the cache is full, holders
+   * of a snapshot keep it alive after it was evicted.
+   */
+  template<typename T>
+  class AreaCache {
+
+  public:
+
+    using Loader = std::function<std::shared_ptr<const T>(uint32_t area)>;
+    using Graph = std::unordered_map<uint32_t, std::vector<uint32_t>>;
+
+    struct Stats {
+      uint32_t hits = 0;
+      uint32_t misses = 0;
+      uint32_t loads = 0;
+      uint32_t evictions = 0;
+    };
+
+    /**
+     * \brief Parses a prefetch graph
+     *
+     * Entries are separated by \c ';' and list the areas to
+     * prefetch for an area, e.g. \c 200:500|501;173:501.
+     * Malformed entries are skipped with a warning.
+     */
+    static Graph parseGraph(const std::string& str) {
+      Graph graph;
+      size_t begin = 0;
+
+      while (begin < str.size()) {
+        size_t end = str.find(';', begin);
+
+        if (end == std::string::npos)
+          end = str.size();
+
+        const std::string item = str.substr(begin, end - begin);
+        begin = end + 1;
+
+        if (item.find_first_not_of(" \t") == std::string::npos)
+          continue;
+
+        std::vector<uint32_t> areas;
+        size_t pos = 0;
+        bool valid = true;
+
+        // The first number is the area, the others are its neighbours
+        while (valid && pos <= item.size()) {
+          const size_t next = item.find(areas.empty() ? ':' : '|', pos);
+          const std::string number = item.substr(pos, next == std::string::npos ? std::string::npos : next - pos);
+
+          const size_t first = number.find_first_not_of(" \t");
+          const size_t last = number.find_last_not_of(" \t");
+          const std::string digits = first == std::string::npos ? std::string() : number.substr(first, last - first + 1);
+
+          valid = !digits.empty() && digits.size() <= 9 && digits.find_first_not_of("0123456789") == std::string::npos;
+
+          if (valid)
+            areas.push_back(uint32_t(std::stoul(digits)));
+
+          if (next == std::string::npos)
+            break;
+
+          pos = next + 1;
+        }
+
+        if (!valid || areas.size() < 2) {
+          Logger::warn(str::format("AreaCache: Ignoring malformed prefetch graph entry \"", item, "\""));
+          continue;
+        }
+
+        std::vector<uint32_t>& neighbours = graph[areas[0]];
+        neighbours.insert(neighbours.end(), areas.begin() + 1, areas.end());
+      }
+
+      return graph;
+    }
+
+    AreaCache(Loader loader, size_t capacity)
+    : m_loader(std::move(loader)), m_capacity(capacity) { }
+
+    ~AreaCache() {
+      stop();
+    }
+
+    AreaCache(const AreaCache&) = delete;
+    AreaCache& operator = (const AreaCache&) = delete;
+
+    void start() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+      if (m_running)
+        return;
+
+      m_running = true;
+      m_thread = dxvk::thread([this] { this->threadFunc(); });
+    }
+
+    void stop() {
+      {
+        std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+        if (!m_running)
+          return;
+
+        m_running = false;
+        m_queue.clear();
+      }
+
+      m_cond.notify_all();
+
+      if (m_thread.joinable())
+        m_thread.join();
+    }
+
+    /**
+     * \brief Sets the areas to prefetch for each area
+     */
+    void setGraph(Graph graph) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_graph = std::move(graph);
+    }
+
+    void setCapacity(size_t capacity) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_capacity = capacity;
+      evict();
+    }
+
+    /**
+     * \brief Queues an area and its neighbours for loading
+     *
+     * Replaces the areas queued before, which were
+     * prefetched for an area that is no longer current.
+     */
+    void prefetch(uint32_t area) {
+      {
+        std::lock_guard<dxvk::mutex> lock(m_mutex);
+        m_queue.clear();
+        enqueue(area);
+
+        auto it = m_graph.find(area);
+
+        if (it != m_graph.end()) {
+          for (uint32_t neighbour : it->second)
+            enqueue(neighbour);
+        }
+      }
+
+      m_cond.notify_all();
+    }
+
+    /**
+     * \brief Returns an area, loading it on a miss
+     *
+     * Waits for the background thread if it is loading the area,
+     * otherwise loads it on the calling thread.
+     * \returns The area, \c nullptr if it failed to load
+     */
+    std::shared_ptr<const T> get(uint32_t area) {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      auto entry = m_entries.find(area);
+
+      if (entry != m_entries.end()) {
+        m_stats.hits++;
+        touch(entry->second);
+        return entry->second.data;
+      }
+
+      m_stats.misses++;
+
+      if (m_loading.count(area)) {
+        m_cond.wait(lock, [&] { return !m_loading.count(area); });
+
+        entry = m_entries.find(area);
+
+        if (entry != m_entries.end()) {
+          touch(entry->second);
+          return entry->second.data;
+        }
+      }
+
+      for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+        if (*it == area) {
+          m_queue.erase(it);
+          break;
+        }
+      }
+
+      return load(lock, area);
+    }
+
+    /**
+     * \brief Returns an area if it is loaded
+     */
+    std::shared_ptr<const T> tryGet(uint32_t area) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      auto entry = m_entries.find(area);
+      return entry != m_entries.end() ? entry->second.data : nullptr;
+    }
+
+    /**
+     * \brief Checks whether an area is queued or being loaded
+     */
+    bool isPending(uint32_t area) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      return m_loading.count(area) || std::find(m_queue.begin(), m_queue.end(), area) != m_queue.end();
+    }
+
+    /**
+     * \brief Replaces the data of an area
+     *
+     * \param [in] area Area ID
+     * \param [in] data New data
+     * \param [in] pin Whether to keep the area out of the eviction
+     */
+    void put(uint32_t area, std::shared_ptr<const T> data, bool pin) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      Entry& entry = insert(area, std::move(data));
+      entry.pinned |= pin;
+      evict();
+    }
+
+    /**
+     * \brief Lets an area be evicted again
+     */
+    void unpin(uint32_t area) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      auto entry = m_entries.find(area);
+
+      if (entry != m_entries.end()) {
+        entry->second.pinned = false;
+        evict();
+      }
+    }
+
+    /**
+     * \brief Returns the pinned areas
+     */
+    std::vector<std::pair<uint32_t, std::shared_ptr<const T>>> getPinned() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      std::vector<std::pair<uint32_t, std::shared_ptr<const T>>> result;
+
+      for (const auto& [area, entry] : m_entries) {
+        if (entry.pinned)
+          result.emplace_back(area, entry.data);
+      }
+
+      return result;
+    }
+
+    size_t size() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      return m_entries.size();
+    }
+
+    Stats getStats() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      return m_stats;
+    }
+
+    /**
+     * \brief Waits until the background thread is idle
+     */
+    void waitIdle() {
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+      m_cond.wait(lock, [&] { return !m_running || (m_queue.empty() && m_loading.empty()); });
+    }
+
+  private:
+
+    struct Entry {
+      std::shared_ptr<const T>      data;
+      std::list<uint32_t>::iterator lru;
+      bool                          pinned = false;
+    };
+
+    Loader                                m_loader;
+    size_t                                m_capacity;
+
+    dxvk::mutex                           m_mutex;
+    dxvk::condition_variable              m_cond;
+    dxvk::thread                          m_thread;
+    bool                                  m_running = false;
+
+    Graph                                 m_graph;
+    std::unordered_map<uint32_t, Entry>   m_entries;
+    // Most recently used first
+    std::list<uint32_t>                   m_lru;
+    std::deque<uint32_t>                  m_queue;
+    std::unordered_set<uint32_t>          m_loading;
+    Stats                                 m_stats;
+
+    void enqueue(uint32_t area) {
+      if (!m_entries.count(area) && !m_loading.count(area))
+        m_queue.push_back(area);
+    }
+
+    void touch(Entry& entry) {
+      m_lru.splice(m_lru.begin(), m_lru, entry.lru);
+    }
+
+    Entry& insert(uint32_t area, std::shared_ptr<const T> data) {
+      auto [it, inserted] = m_entries.try_emplace(area);
+
+      if (inserted) {
+        m_lru.push_front(area);
+        it->second.lru = m_lru.begin();
+      } else {
+        touch(it->second);
+      }
+
+      it->second.data = std::move(data);
+      return it->second;
+    }
+
+    void evict() {
+      for (auto it = m_lru.end(); m_entries.size() > m_capacity && it != m_lru.begin(); ) {
+        --it;
+        auto entry = m_entries.find(*it);
+
+        if (entry->second.pinned)
+          continue;
+
+        m_entries.erase(entry);
+        it = m_lru.erase(it);
+        m_stats.evictions++;
+      }
+    }
+
+    // Loads an area without holding the lock, returns with the lock held
+    std::shared_ptr<const T> load(std::unique_lock<dxvk::mutex>& lock, uint32_t area) {
+      m_loading.insert(area);
+      lock.unlock();
+
+      std::shared_ptr<const T> data;
+
+      try {
+        data = m_loader(area);
+      } catch (const std::exception& e) {
+        Logger::err(str::format("AreaCache: Failed to load area ", area, ": ", e.what()));
+      }
+
+      lock.lock();
+      m_loading.erase(area);
+      m_stats.loads++;
+
+      if (data != nullptr) {
+        insert(area, data);
+        evict();
+      }
+
+      m_cond.notify_all();
+      return data;
+    }
+
+    void threadFunc() {
+      env::setThreadName("rtx-area-loader");
+
+      std::unique_lock<dxvk::mutex> lock(m_mutex);
+
+      while (true) {
+        m_cond.wait(lock, [&] { return !m_running || !m_queue.empty(); });
+
+        if (!m_running)
+          break;
+
+        const uint32_t area = m_queue.front();
+        m_queue.pop_front();
+
+        if (m_entries.count(area) || m_loading.count(area)) {
+          m_cond.notify_all();
+          continue;
+        }
+
+        load(lock, area);
+      }
+    }
+
+  };
+
+}
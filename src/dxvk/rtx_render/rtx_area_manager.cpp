@@ -12,25 +12,31 @@
 #include "imgui/imgui.h"
 #include "rtx_light_manager.h"
 #include "rtx_particle_system.h"
+#include "rtx_options.h"
 
 using namespace pxr;
 
 namespace dxvk {
 
+    AreaManager::AreaManager()
+    : m_cache([this](uint32_t area) { return loadArea(area); }, RtxOptions::areaCacheSize()) { }
+
     void AreaManager::setArea(uint32_t area)
     {
-      if (m_currentArea != area && ( area != 200 || m_currentArea != 500))
+      const uint32_t currentArea = m_currentArea.load();
+      if (currentArea != area && ( area != 200 || currentArea != 500))
       {
         m_currentRoughnessFactor = 0.0f;
         m_lightFactor = 1.0f;
         m_currentSkyBrightnessAtt = 1.0f;
+        // Queue the load first so that an area which is neither loaded nor pending has failed to load
+        m_cache.prefetch(area);
         m_currentArea = area;
-        auto [it, emplaced] = m_areas.try_emplace(area, AreaData{});
-        it->second.lightDirty = true;
       }
     }
 
     void AreaManager::update() { 
+      syncCurrentArea();
       particleFetched = false;
     }
 
@@ -52,12 +58,31 @@ namespace dxvk {
       return m_currentArea;
     }
 
-    AreaData& AreaManager::getAreaData(uint32_t area){
-      return m_areas[area];
+    AreaData& AreaManager::getCurrentAreaData() {
+      return m_currentData;
     }
 
-    AreaData& AreaManager::getCurrentAreaData() {
-      return m_areas[m_currentArea];
+    void AreaManager::syncCurrentArea() {
+      const uint32_t area = m_currentArea.load();
+
+      if (area == m_loadedArea)
+        return;
+
+      // Keep rendering the previous area until the snapshot arrives, a failed load falls back to the defaults
+      std::shared_ptr<const AreaData> data = m_cache.tryGet(area);
+
+      if (data == nullptr && m_cache.isPending(area))
+        return;
+
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+      // Keep the changes made in the developer menu until they are saved
+      if (m_currentData.edited)
+        m_cache.put(m_loadedArea, std::make_shared<const AreaData>(m_currentData), true);
+
+      m_currentData = data != nullptr ? *data : AreaData{};
+      m_currentData.lightDirty = true;
+      m_loadedArea = area;
     }
 
     bool AreaManager::isParticleSystemFetched()
@@ -74,248 +99,270 @@ namespace dxvk {
     void AreaManager::load() {
         wchar_t file_prefix[MAX_PATH] = L"";
         GetModuleFileNameW(nullptr, file_prefix, ARRAYSIZE(file_prefix));
-        std::filesystem::path path = file_prefix;
-        path = path.parent_path();
+        m_path = std::filesystem::path(file_prefix).parent_path();
 
-        for (uint32_t areaId = 0; areaId <= 502; ++areaId){
-          std::filesystem::path usdPath = path / "Area" / std::string(std::to_string(areaId) + ".usda");
+        m_cache.setGraph(AreaCache<AreaData>::parseGraph(RtxOptions::areaPrefetchGraph()));
+        m_cache.setCapacity(RtxOptions::areaCacheSize());
+        m_cache.start();
+        m_cache.prefetch(m_currentArea.load());
+    }
 
-          if (std::filesystem::exists(usdPath)){
-            AreaData area;
-            UsdStageRefPtr stage = UsdStage::Open(usdPath.u8string());
-            {
-              UsdPrim generic = stage->GetPrimAtPath(SdfPath("/Generic"));
+    std::shared_ptr<const AreaData> AreaManager::loadArea(uint32_t areaId) const {
+      std::filesystem::path usdPath = m_path / "Area" / std::string(std::to_string(areaId) + ".usda");
 
-              auto skyBrightnessAttr = generic.GetAttribute(TfToken("skyBrightness"));
-              skyBrightnessAttr.Get(&area.skyBrightness);
-            }
+      if (!std::filesystem::exists(usdPath))
+        return std::make_shared<const AreaData>();
 
-            {
-              UsdPrim volumetric = stage->GetPrimAtPath(SdfPath("/Volumetric"));
+      auto area = std::make_shared<AreaData>();
+      UsdStageRefPtr stage = UsdStage::Open(usdPath.u8string());
 
-              auto transmittanceColorAttr = volumetric.GetAttribute(TfToken("transmittanceColor"));
-              GfVec3f transmittanceColor;
-              transmittanceColorAttr.Get(&transmittanceColor);
-              area.transmittanceColor = Vector3(transmittanceColor[0], transmittanceColor[1], transmittanceColor[2]);
+      if (!stage) {
+        Logger::err(str::format("Failed to open area ", usdPath.u8string()));
+        return area;
+      }
+      {
+        UsdPrim generic = stage->GetPrimAtPath(SdfPath("/Generic"));
 
-              auto singleScatteringAlbedoAttr = volumetric.GetAttribute(TfToken("singleScatteringAlbedo"));
-              GfVec3f singleScatteringAlbedo;
-              singleScatteringAlbedoAttr.Get(&singleScatteringAlbedo);
-              area.singleScatteringAlbedo = Vector3(singleScatteringAlbedo[0], singleScatteringAlbedo[1], singleScatteringAlbedo[2]);
+        auto skyBrightnessAttr = generic.GetAttribute(TfToken("skyBrightness"));
+        skyBrightnessAttr.Get(&area->skyBrightness);
+      }
 
-              auto transmittanceMeasurementDistanceMetersAttr = volumetric.GetAttribute(TfToken("transmittanceMeasurementDistanceMeters"));
-              transmittanceMeasurementDistanceMetersAttr.Get(&area.transmittanceMeasurementDistanceMeters);
-            }
-            {
-              UsdPrim prism = stage->GetPrimAtPath(SdfPath("/ParticleEmitters"));
-              uint32_t particleEmitterId = 0;
-              for (const UsdPrim& particleEmitter : prism.GetAllChildren()) {
-                ParticleData particleSystem;
-                std::string path = std::string("/ParticleEmitters/ParticleEmitter_" + std::to_string(particleEmitterId));
-                RtxParticleSystemManager::load(particleEmitter.GetPath().GetString(), stage, particleSystem.particleDesc, particleSystem.particleMaterial, particleSystem.spawnCtx);
-                area.particleSystems.emplace_back(std::move(particleSystem));
-                ++particleEmitterId;
-              }
-            }
-            {
-              UsdPrim prism = stage->GetPrimAtPath(SdfPath("/DistantLights"));
-   
-              for (const UsdPrim& light : prism.GetAllChildren()) {
-                AreaLightDataDir dirLight;
-                auto colorAttr = light.GetAttribute(TfToken("inputs:color"));
-                GfVec3f color;
-                colorAttr.Get(&color);
-                dirLight.lightRadiance = Vector3(color[0], color[1], color[2]);
-
-                auto directionAttr = light.GetAttribute(TfToken("direction"));
-                GfVec3f lightDirection;
-                directionAttr.Get(&lightDirection);
-                dirLight.lightDirection = Vector3(lightDirection[0], lightDirection[1], lightDirection[2]);
-
-                area.dirLightsData.emplace_back(std::move(dirLight));
-              }
-            }
+      {
+        UsdPrim volumetric = stage->GetPrimAtPath(SdfPath("/Volumetric"));
 
-            {
-              UsdPrim prism = stage->GetPrimAtPath(SdfPath("/SphereLights"));
+        auto transmittanceColorAttr = volumetric.GetAttribute(TfToken("transmittanceColor"));
+        GfVec3f transmittanceColor;
+        transmittanceColorAttr.Get(&transmittanceColor);
+        area->transmittanceColor = Vector3(transmittanceColor[0], transmittanceColor[1], transmittanceColor[2]);
 
-              for (const UsdPrim& light : prism.GetAllChildren()) {
-                AreaLightDataPoint pointLight;
-                auto colorAttr = light.GetAttribute(TfToken("inputs:color"));
-                GfVec3f color;
-                colorAttr.Get(&color);
-                pointLight.lightRadiance = Vector3(color[0], color[1], color[2]);
+        auto singleScatteringAlbedoAttr = volumetric.GetAttribute(TfToken("singleScatteringAlbedo"));
+        GfVec3f singleScatteringAlbedo;
+        singleScatteringAlbedoAttr.Get(&singleScatteringAlbedo);
+        area->singleScatteringAlbedo = Vector3(singleScatteringAlbedo[0], singleScatteringAlbedo[1], singleScatteringAlbedo[2]);
 
-                auto radiusAttr = light.GetAttribute(TfToken("inputs:radius"));
-                radiusAttr.Get(&pointLight.lightRadius);
+        auto transmittanceMeasurementDistanceMetersAttr = volumetric.GetAttribute(TfToken("transmittanceMeasurementDistanceMeters"));
+        transmittanceMeasurementDistanceMetersAttr.Get(&area->transmittanceMeasurementDistanceMeters);
+      }
+      {
+        UsdPrim prism = stage->GetPrimAtPath(SdfPath("/ParticleEmitters"));
+        uint32_t particleEmitterId = 0;
+        for (const UsdPrim& particleEmitter : prism.GetAllChildren()) {
+          ParticleData particleSystem;
+          std::string path = std::string("/ParticleEmitters/ParticleEmitter_" + std::to_string(particleEmitterId));
+          RtxParticleSystemManager::load(particleEmitter.GetPath().GetString(), stage, particleSystem.particleDesc, particleSystem.particleMaterial, particleSystem.spawnCtx);
+          area->particleSystems.emplace_back(std::move(particleSystem));
+          ++particleEmitterId;
+        }
+      }
+      {
+        UsdPrim prism = stage->GetPrimAtPath(SdfPath("/DistantLights"));
+   
+        for (const UsdPrim& light : prism.GetAllChildren()) {
+          AreaLightDataDir dirLight;
+          auto colorAttr = light.GetAttribute(TfToken("inputs:color"));
+          GfVec3f color;
+          colorAttr.Get(&color);
+          dirLight.lightRadiance = Vector3(color[0], color[1], color[2]);
+
+          auto directionAttr = light.GetAttribute(TfToken("direction"));
+          GfVec3f lightDirection;
+          directionAttr.Get(&lightDirection);
+          dirLight.lightDirection = Vector3(lightDirection[0], lightDirection[1], lightDirection[2]);
+
+          area->dirLightsData.emplace_back(std::move(dirLight));
+        }
+      }
 
-                UsdGeomXformable xformable(light);
+      {
+        UsdPrim prism = stage->GetPrimAtPath(SdfPath("/SphereLights"));
 
-                bool resetsXformStack;
-                std::vector<UsdGeomXformOp> xformOps = xformable.GetOrderedXformOps(&resetsXformStack);
+        for (const UsdPrim& light : prism.GetAllChildren()) {
+          AreaLightDataPoint pointLight;
+          auto colorAttr = light.GetAttribute(TfToken("inputs:color"));
+          GfVec3f color;
+          colorAttr.Get(&color);
+          pointLight.lightRadiance = Vector3(color[0], color[1], color[2]);
 
-                for (const auto& op : xformOps) {
-                  if (op.GetOpType() == UsdGeomXformOp::TypeTranslate) {
-                    GfVec3d translate;
-                    op.Get(&translate);
-                    pointLight.lightPosition = Vector3(translate[0], translate[1], translate[2]);
-                  }
-                }
-                area.pointLightsData.emplace_back(std::move(pointLight));
-              }
-            }
+          auto radiusAttr = light.GetAttribute(TfToken("inputs:radius"));
+          radiusAttr.Get(&pointLight.lightRadius);
 
-            {
-              UsdPrim prism = stage->GetPrimAtPath(SdfPath("/RectLights"));
+          UsdGeomXformable xformable(light);
 
-              for (const UsdPrim& light : prism.GetAllChildren()) {
-                AreaLightDataRect rectLight;
-                auto colorAttr = light.GetAttribute(TfToken("inputs:color"));
-                GfVec3f color;
-                colorAttr.Get(&color);
-                rectLight.lightRadiance = Vector3(color[0], color[1], color[2]);
+          bool resetsXformStack;
+          std::vector<UsdGeomXformOp> xformOps = xformable.GetOrderedXformOps(&resetsXformStack);
 
-                auto widthAttr = light.GetAttribute(TfToken("inputs:width"));
-                widthAttr.Get(&rectLight.dimensions.x);
+          for (const auto& op : xformOps) {
+            if (op.GetOpType() == UsdGeomXformOp::TypeTranslate) {
+              GfVec3d translate;
+              op.Get(&translate);
+              pointLight.lightPosition = Vector3(translate[0], translate[1], translate[2]);
+            }
+          }
+          area->pointLightsData.emplace_back(std::move(pointLight));
+        }
+      }
 
-                auto heightAttr = light.GetAttribute(TfToken("inputs:height"));
-                heightAttr.Get(&rectLight.dimensions.y);
+      {
+        UsdPrim prism = stage->GetPrimAtPath(SdfPath("/RectLights"));
 
-                UsdGeomXformable xformable(light);
+        for (const UsdPrim& light : prism.GetAllChildren()) {
+          AreaLightDataRect rectLight;
+          auto colorAttr = light.GetAttribute(TfToken("inputs:color"));
+          GfVec3f color;
+          colorAttr.Get(&color);
+          rectLight.lightRadiance = Vector3(color[0], color[1], color[2]);
 
-                bool resetsXformStack;
-                std::vector<UsdGeomXformOp> xformOps = xformable.GetOrderedXformOps(&resetsXformStack);
+          auto widthAttr = light.GetAttribute(TfToken("inputs:width"));
+          widthAttr.Get(&rectLight.dimensions.x);
 
-                for (const auto& op : xformOps) {
-                  if (op.GetOpType() == UsdGeomXformOp::TypeTranslate) {
-                    GfVec3d translate;
-                    op.Get(&translate);
-                    rectLight.lightPosition = Vector3(translate[0], translate[1], translate[2]);
-                  }
+          auto heightAttr = light.GetAttribute(TfToken("inputs:height"));
+          heightAttr.Get(&rectLight.dimensions.y);
 
-                  if (op.GetOpType() == UsdGeomXformOp::TypeRotateXYZ) {
-                    GfVec3f rotate;
-                    op.Get(&rotate);
-                    rectLight.rotation = Vector3(rotate[0], rotate[1], rotate[2]);
-                  }
-                }
+          UsdGeomXformable xformable(light);
 
-                area.rectLightsData.emplace_back(std::move(rectLight));
-              }
+          bool resetsXformStack;
+          std::vector<UsdGeomXformOp> xformOps = xformable.GetOrderedXformOps(&resetsXformStack);
+
+          for (const auto& op : xformOps) {
+            if (op.GetOpType() == UsdGeomXformOp::TypeTranslate) {
+              GfVec3d translate;
+              op.Get(&translate);
+              rectLight.lightPosition = Vector3(translate[0], translate[1], translate[2]);
             }
 
-            m_areas.try_emplace(areaId, area);
+            if (op.GetOpType() == UsdGeomXformOp::TypeRotateXYZ) {
+              GfVec3f rotate;
+              op.Get(&rotate);
+              rectLight.rotation = Vector3(rotate[0], rotate[1], rotate[2]);
+            }
           }
+
+          area->rectLightsData.emplace_back(std::move(rectLight));
         }
+      }
+
+      return area;
     }
 
     void AreaManager::save() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+
+      // Areas are only kept in memory on demand, only the edited ones have changes to write.
+      // Written areas replace their snapshot and can be evicted again.
+      if (m_currentData.edited) {
+        saveArea(m_loadedArea, m_currentData);
+        m_currentData.edited = false;
+        m_cache.put(m_loadedArea, std::make_shared<const AreaData>(m_currentData), false);
+      }
 
+      for (const auto& [areaId, area] : m_cache.getPinned()) {
+        if (areaId != m_loadedArea) {
+          auto saved = std::make_shared<AreaData>(*area);
+          saveArea(areaId, *saved);
+          saved->edited = false;
+          m_cache.put(areaId, std::move(saved), false);
+        }
 
-      wchar_t file_prefix[MAX_PATH] = L"";
-      GetModuleFileNameW(nullptr, file_prefix, ARRAYSIZE(file_prefix));
-      std::filesystem::path path = file_prefix;
-      path = path.parent_path();
-
-      // USD
-      for(auto& [id, area] : m_areas)
-      {
-        std::filesystem::path usdPath = path / "Area" / std::string(std::to_string(id) + ".usda");
+        m_cache.unpin(areaId);
+      }
+    }
 
-        UsdStageRefPtr stage = UsdStage::CreateNew(usdPath.u8string());
+    void AreaManager::saveArea(uint32_t areaId, const AreaData& area) const {
+      std::filesystem::path usdPath = m_path / "Area" / std::string(std::to_string(areaId) + ".usda");
 
-        {
-          UsdPrim generic = stage->DefinePrim(SdfPath { "/Generic" });
-          auto skyBrightnessAttr = generic.CreateAttribute(
-          TfToken("skyBrightness"),
-          SdfValueTypeNames->Float,
-          true
-          );
-          skyBrightnessAttr.Set(area.skyBrightness);
+      UsdStageRefPtr stage = UsdStage::CreateNew(usdPath.u8string());
 
-        }
+      {
+        UsdPrim generic = stage->DefinePrim(SdfPath { "/Generic" });
+        auto skyBrightnessAttr = generic.CreateAttribute(
+        TfToken("skyBrightness"),
+        SdfValueTypeNames->Float,
+        true
+        );
+        skyBrightnessAttr.Set(area.skyBrightness);
 
-        {
-          UsdPrim volumetric = stage->DefinePrim(SdfPath { "/Volumetric" });
-          auto transmittanceColorAttr = volumetric.CreateAttribute(
-          TfToken("transmittanceColor"),
-          SdfValueTypeNames->Color3f,
-          true
-          );
-          transmittanceColorAttr.Set(GfVec3f(area.transmittanceColor.x, area.transmittanceColor.y, area.transmittanceColor.z));
+      }
 
-          auto singleScatteringAlbedoAttr = volumetric.CreateAttribute(
-          TfToken("singleScatteringAlbedo"),
-          SdfValueTypeNames->Color3f,
-          true
-          );
-          singleScatteringAlbedoAttr.Set(GfVec3f(area.singleScatteringAlbedo.x, area.singleScatteringAlbedo.y, area.singleScatteringAlbedo.z));
+      {
+        UsdPrim volumetric = stage->DefinePrim(SdfPath { "/Volumetric" });
+        auto transmittanceColorAttr = volumetric.CreateAttribute(
+        TfToken("transmittanceColor"),
+        SdfValueTypeNames->Color3f,
+        true
+        );
+        transmittanceColorAttr.Set(GfVec3f(area.transmittanceColor.x, area.transmittanceColor.y, area.transmittanceColor.z));
+
+        auto singleScatteringAlbedoAttr = volumetric.CreateAttribute(
+        TfToken("singleScatteringAlbedo"),
+        SdfValueTypeNames->Color3f,
+        true
+        );
+        singleScatteringAlbedoAttr.Set(GfVec3f(area.singleScatteringAlbedo.x, area.singleScatteringAlbedo.y, area.singleScatteringAlbedo.z));
+
+        auto transmittanceMeasurementDistanceMetersAttr = volumetric.CreateAttribute(
+        TfToken("transmittanceMeasurementDistanceMeters"),
+        SdfValueTypeNames->Float,
+        true
+        );
+        transmittanceMeasurementDistanceMetersAttr.Set(area.transmittanceMeasurementDistanceMeters);
 
-          auto transmittanceMeasurementDistanceMetersAttr = volumetric.CreateAttribute(
-          TfToken("transmittanceMeasurementDistanceMeters"),
-          SdfValueTypeNames->Float,
-          true
-          );
-          transmittanceMeasurementDistanceMetersAttr.Set(area.transmittanceMeasurementDistanceMeters);
+      }
 
+      {
+        UsdPrim particles = stage->DefinePrim(SdfPath { "/ParticleEmitters" });
+        uint32_t particleEmitterId = 0;
+        for (auto& particleSystem : area.particleSystems) {
+          std::string path = std::string("/ParticleEmitters/ParticleEmitter_" + std::to_string(particleEmitterId));
+          UsdPrim particle = stage->DefinePrim(SdfPath { path });
+          RtxParticleSystemManager::save(path, stage, particleSystem.particleDesc, particleSystem.particleMaterial, particleSystem.spawnCtx);
+          ++particleEmitterId;
         }
+      }
 
-        {
-          UsdPrim particles = stage->DefinePrim(SdfPath { "/ParticleEmitters" });
-          uint32_t particleEmitterId = 0;
-          for (auto& particleSystem : area.particleSystems) {
-            std::string path = std::string("/ParticleEmitters/ParticleEmitter_" + std::to_string(particleEmitterId));
-            UsdPrim particle = stage->DefinePrim(SdfPath { path });
-            RtxParticleSystemManager::save(path, stage, particleSystem.particleDesc, particleSystem.particleMaterial, particleSystem.spawnCtx);
-            ++particleEmitterId;
-          }
-        }
+      {
+        UsdPrim light = stage->DefinePrim(SdfPath { "/DistantLights" });
+        uint32_t dirLightIndex = 0;
+        for (auto& lightDir : area.dirLightsData) {
+          UsdLuxDistantLight light = UsdLuxDistantLight::Define(stage, SdfPath { std::string("/DistantLights/DistantLight_" + std::to_string(dirLightIndex)) });
+          light.CreateColorAttr().Set(GfVec3f(lightDir.lightRadiance.x, lightDir.lightRadiance.y, lightDir.lightRadiance.z));
+
+          auto dirAttr = light.GetPrim().CreateAttribute(
+            TfToken("direction"),
+            SdfValueTypeNames->Vector3f,
+            true
+          );
 
-        {
-          UsdPrim light = stage->DefinePrim(SdfPath { "/DistantLights" });
-          uint32_t dirLightIndex = 0;
-          for (auto& lightDir : area.dirLightsData) {
-            UsdLuxDistantLight light = UsdLuxDistantLight::Define(stage, SdfPath { std::string("/DistantLights/DistantLight_" + std::to_string(dirLightIndex)) });
-            light.CreateColorAttr().Set(GfVec3f(lightDir.lightRadiance.x, lightDir.lightRadiance.y, lightDir.lightRadiance.z));
-
-            auto dirAttr = light.GetPrim().CreateAttribute(
-              TfToken("direction"),
-              SdfValueTypeNames->Vector3f,
-              true
-            );
-
-            dirAttr.Set(GfVec3f(lightDir.lightDirection.x, lightDir.lightDirection.y, lightDir.lightDirection.z));
-            ++dirLightIndex;
-          }
+          dirAttr.Set(GfVec3f(lightDir.lightDirection.x, lightDir.lightDirection.y, lightDir.lightDirection.z));
+          ++dirLightIndex;
         }
+      }
 
-        {
-          UsdPrim light = stage->DefinePrim(SdfPath { "/SphereLights" });
-          uint32_t pointLightIndex = 0;
-          for (auto& pointLight : area.pointLightsData) {
-            UsdLuxSphereLight light = UsdLuxSphereLight::Define(stage, SdfPath { std::string("/SphereLights/SphereLight_" + std::to_string(pointLightIndex)) });
-            light.CreateColorAttr().Set(GfVec3f(pointLight.lightRadiance.x, pointLight.lightRadiance.y, pointLight.lightRadiance.z));
-            light.CreateRadiusAttr().Set(pointLight.lightRadius);
-            light.AddTranslateOp().Set(GfVec3d(pointLight.lightPosition.x, pointLight.lightPosition.y, pointLight.lightPosition.z));
-            ++pointLightIndex;
-          }
+      {
+        UsdPrim light = stage->DefinePrim(SdfPath { "/SphereLights" });
+        uint32_t pointLightIndex = 0;
+        for (auto& pointLight : area.pointLightsData) {
+          UsdLuxSphereLight light = UsdLuxSphereLight::Define(stage, SdfPath { std::string("/SphereLights/SphereLight_" + std::to_string(pointLightIndex)) });
+          light.CreateColorAttr().Set(GfVec3f(pointLight.lightRadiance.x, pointLight.lightRadiance.y, pointLight.lightRadiance.z));
+          light.CreateRadiusAttr().Set(pointLight.lightRadius);
+          light.AddTranslateOp().Set(GfVec3d(pointLight.lightPosition.x, pointLight.lightPosition.y, pointLight.lightPosition.z));
+          ++pointLightIndex;
         }
-        {
-          UsdPrim light = stage->DefinePrim(SdfPath { "/RectLights" });
-          uint32_t rectLightIndex = 0;
-          for (auto& rectLight : area.rectLightsData) {
-            UsdLuxRectLight  light = UsdLuxRectLight::Define(stage, SdfPath { std::string("/RectLights/RectLight_" + std::to_string(rectLightIndex)) });
-            light.CreateColorAttr().Set(GfVec3f(rectLight.lightRadiance.x, rectLight.lightRadiance.y, rectLight.lightRadiance.z));
-            light.CreateWidthAttr().Set(rectLight.dimensions.x);
-            light.CreateHeightAttr().Set(rectLight.dimensions.y);
-            light.AddTranslateOp().Set(GfVec3d(rectLight.lightPosition.x, rectLight.lightPosition.y, rectLight.lightPosition.z));
-            light.AddRotateXYZOp().Set(GfVec3f(rectLight.rotation.x, rectLight.rotation.y, rectLight.rotation.z));
-            ++rectLightIndex;
-          }
+      }
+      {
+        UsdPrim light = stage->DefinePrim(SdfPath { "/RectLights" });
+        uint32_t rectLightIndex = 0;
+        for (auto& rectLight : area.rectLightsData) {
+          UsdLuxRectLight  light = UsdLuxRectLight::Define(stage, SdfPath { std::string("/RectLights/RectLight_" + std::to_string(rectLightIndex)) });
+          light.CreateColorAttr().Set(GfVec3f(rectLight.lightRadiance.x, rectLight.lightRadiance.y, rectLight.lightRadiance.z));
+          light.CreateWidthAttr().Set(rectLight.dimensions.x);
+          light.CreateHeightAttr().Set(rectLight.dimensions.y);
+          light.AddTranslateOp().Set(GfVec3d(rectLight.lightPosition.x, rectLight.lightPosition.y, rectLight.lightPosition.z));
+          light.AddRotateXYZOp().Set(GfVec3f(rectLight.rotation.x, rectLight.rotation.y, rectLight.rotation.z));
+          ++rectLightIndex;
         }
-
-        stage->GetRootLayer()->Save();
       }
+
+      stage->GetRootLayer()->Save();
     }
 
     void AreaLightDataRect::buildMatrix() {
@@ -517,6 +564,7 @@ namespace dxvk {
       }
       if (areaDirty) {
         lightDirty = true;
+        edited = true;
         lightManager.resetLightFallback();
       }
     }
@@ -1,9 +1,12 @@
 #pragma once
+#include <atomic>
+#include <filesystem>
 #include <unordered_map>
 #include <string>
 #include "../util/util_vector.h"
 #include "../dxvk/dxvk_include.h"
 #include "rtx_types.h"
+#include "rtx_area_cache.h"
 namespace dxvk {
 
   struct LightManager;
@@ -59,11 +62,29 @@ namespace dxvk {
     float noiseFieldDensityScale = 1.0f;
     float skyBrightness = 1.0f;
     bool lightDirty = true;
+    // Changed in the developer menu since it was loaded
+    bool edited = false;
     void showImguiSettings(const AreaManager& areaManager, const Vector3& cameraPosition, LightManager& lightManager);
   };
 
+  /**
+   * \brief Per-area lights, particles and volumetrics
+   *
+   * Areas are loaded on demand from Area/<id>.usda by the background
+   * thread of an \c AreaCache, which prefetches the areas reachable
+   * from the current one. The current area is a copy of its snapshot
+   * that the developer menu can edit, edited areas stay in the cache
+   * until they are saved.
+   *
+   * The current area is only switched by \c update on the render thread
+   * once its snapshot is loaded, the previous area is kept until then.
+   * The developer menu runs on another thread, the current area data
+   * must only be accessed while holding \c lockCurrentArea.
+   */
   class AreaManager {
   public:
+    AreaManager();
+
     void setArea(uint32_t area);
     void setTime(uint32_t time) {
       m_time = time;
@@ -86,7 +107,9 @@ namespace dxvk {
     void setDay();
 
     uint32_t getCurrentAreaID();
-    AreaData& getAreaData(uint32_t area);
+    std::unique_lock<dxvk::mutex> lockCurrentArea() {
+      return std::unique_lock<dxvk::mutex>(m_mutex);
+    }
     AreaData& getCurrentAreaData();
 
     bool isParticleSystemFetched();
@@ -110,7 +133,8 @@ namespace dxvk {
     }
 
     float getSkyBrightness() {
-      return getCurrentAreaData().skyBrightness * m_currentSkyBrightnessAtt;
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      return m_currentData.skyBrightness * m_currentSkyBrightnessAtt;
     }
 
     float getRoughnessFactor() {
@@ -125,26 +149,35 @@ namespace dxvk {
       m_currentSkyBrightnessAtt = 0.05f;
       m_currentRoughnessFactor = 0.5f;
       if (m_lightFactor == 1) {
-        getCurrentAreaData().lightDirty = true;
+        std::lock_guard<dxvk::mutex> lock(m_mutex);
+        m_currentData.lightDirty = true;
       }
       m_lightFactor = 0.15f;
     }
 
-    std::unordered_map<uint32_t, AreaData>& getAreas() {
-      return m_areas;
-    }
-
   private:
 
+    std::shared_ptr<const AreaData> loadArea(uint32_t area) const;
+    void saveArea(uint32_t area, const AreaData& data) const;
+    void syncCurrentArea();
+
     bool particleFetched = false;
-    std::unordered_map<uint32_t, AreaData> m_areas;
+    std::filesystem::path m_path;
+    // Guards the current area between the render thread and the developer menu
+    dxvk::mutex m_mutex;
+    // Copy of the current area, the developer menu edits it in place
+    AreaData m_currentData;
+    uint32_t m_loadedArea = ~0u;
     Vector3 m_oriLightDir;
     Vector3 m_playerPos;
-    uint32_t m_currentArea = 0;
+    // Set by the game, the data follows once it is loaded
+    std::atomic<uint32_t> m_currentArea = 0;
     uint32_t m_time = 0;
     uint32_t m_questID = 0;
     float m_currentSkyBrightnessAtt = 1.0f;
     float m_currentRoughnessFactor = 0.0f;
     float m_lightFactor = 1.0f;
+    // Last so that the loader thread stops before anything it reads is destroyed
+    AreaCache<AreaData> m_cache;
   };
 }
\ No newline at end of file
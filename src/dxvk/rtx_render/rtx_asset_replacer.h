@@ -116,6 +116,22 @@ namespace dxvk {
       map.emplace(hash, std::move(v));
     }
 
+    // Stores replacements of type T for a hash value, overwriting any replacements stored before.
+    template<AssetReplacement::Type T>
+    void replace(XXH64_hash_t hash, std::vector<AssetReplacement>&& v) {
+      std::lock_guard<sync::Spinlock> lock(m_spinlock);
+      auto& map = T == AssetReplacement::eMesh ? m_meshReplacers : m_lightReplacers;
+      map.insert_or_assign(hash, std::move(v));
+    }
+
+    // Removes replacements of type T for a hash value.
+    template<AssetReplacement::Type T>
+    void remove(XXH64_hash_t hash) {
+      std::lock_guard<sync::Spinlock> lock(m_spinlock);
+      auto& map = T == AssetReplacement::eMesh ? m_meshReplacers : m_lightReplacers;
+      map.erase(hash);
+    }
+
     // Returns a pointer to the stored object of type T for a given hash value.
     // Return false if no object was found.
     template<typename T>
@@ -152,6 +168,27 @@ namespace dxvk {
       }
     }
 
+    // Stores the object of type T for a hash value.  An object already stored for the hash is overwritten
+    // in place, so replacements pointing to it pick up the new contents.
+    template<typename T>
+    T& replaceObject(XXH64_hash_t hash, T&& obj) {
+      std::lock_guard<sync::Spinlock> lock(m_spinlock);
+      if constexpr (std::is_same_v<T, MaterialData>) {
+        auto [it, inserted] = m_materials.try_emplace(hash, std::move(obj));
+        if (!inserted) {
+          it->second = std::move(obj);
+        }
+        return it->second;
+      } else {
+        static_assert(std::is_same_v<T, MeshReplacement>);
+        auto [it, inserted] = m_geometries.try_emplace(hash, std::move(obj));
+        if (!inserted) {
+          it->second = std::move(obj);
+        }
+        return it->second;
+      }
+    }
+
     // Removes the object of type T for a hash value.
     template<typename T>
     void removeObject(XXH64_hash_t hash) {
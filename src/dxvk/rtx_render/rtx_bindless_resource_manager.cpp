@@ -54,67 +54,117 @@ namespace dxvk {
     return m_tables[type][currentIdx()]->bindlessDescSet;
   }
 
+  namespace {
+    template<typename Handle>
+    uint64_t getHandleBits(Handle handle) {
+      static_assert(sizeof(Handle) <= sizeof(uint64_t));
+      uint64_t bits = 0;
+      memcpy(&bits, &handle, sizeof(handle));
+      return bits;
+    }
+  }
+
   template<VkDescriptorType Type, typename T, typename U>
   void BindlessResourceManager::createDescriptorSet(const Rc<DxvkContext>& ctx, const std::vector<U>& engineObjects, const T& dummyDescriptor) {
     const size_t numDescriptors = std::max((size_t) 1, engineObjects.size()); // Must always leave 1 to have a valid binding set
     assert(numDescriptors <= kMaxBindlessResources);
 
-    std::vector<T> descriptorInfos(numDescriptors);
-    descriptorInfos[0] = dummyDescriptor; // we set the first descriptor to be a dummy (size is always at least 1) and overwrite it if there are valid engine objects
+    constexpr Table tableType = Type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE ? Table::Textures :
+                                Type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER ? Table::Buffers : Table::Samplers;
+    BindlessTable& table = *m_tables[tableType][currentIdx()];
+
+    m_descriptorWriteCount[tableType] = 0;
+
+    if (!table.allocateSet(Type)) {
+      return;
+    }
+
+    std::vector<T>* descriptorInfos;
+    BindlessSlotTracker::Slot dummySlot = {};
+
+    if constexpr (std::is_same_v<T, VkDescriptorImageInfo>) {
+      descriptorInfos = &table.imageInfos;
+      dummySlot.handle = Type == VK_DESCRIPTOR_TYPE_SAMPLER ? getHandleBits(dummyDescriptor.sampler) : getHandleBits(dummyDescriptor.imageView);
+      dummySlot.offset = static_cast<uint64_t>(dummyDescriptor.imageLayout);
+    } else if constexpr (std::is_same_v<T, VkDescriptorBufferInfo>) {
+      descriptorInfos = &table.bufferInfos;
+      dummySlot.handle = getHandleBits(dummyDescriptor.buffer);
+      dummySlot.offset = dummyDescriptor.offset;
+      dummySlot.range = dummyDescriptor.range;
+    }
+
+    // The tables persist across frames, each copy only needs the slots that changed since it was last written
+    descriptorInfos->resize(numDescriptors);
+    table.slots.beginFrame(numDescriptors);
+
+    // we set the first descriptor to be a dummy (size is always at least 1) when there are no valid engine objects
+    if (engineObjects.empty()) {
+      (*descriptorInfos)[0] = dummyDescriptor;
+      table.slots.update(0, dummySlot);
+    }
 
     uint32_t idx = 0;
     for (auto&& engineObject : engineObjects) {
-      descriptorInfos[idx] = dummyDescriptor;
+      T& descriptorInfo = (*descriptorInfos)[idx];
+      BindlessSlotTracker::Slot slot = dummySlot;
+      descriptorInfo = dummyDescriptor;
 
       if constexpr (Type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE) {
         DxvkImageView* imageView = engineObject.getImageView();
         if (imageView != nullptr) {
-          descriptorInfos[idx].sampler = nullptr;
-          descriptorInfos[idx].imageView = imageView->handle();
-          descriptorInfos[idx].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+          descriptorInfo.sampler = nullptr;
+          descriptorInfo.imageView = imageView->handle();
+          descriptorInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+          slot = { imageView->cookie(), getHandleBits(descriptorInfo.imageView), static_cast<uint64_t>(descriptorInfo.imageLayout), 0 };
           ctx->getCommandList()->trackResource<DxvkAccess::Read>(imageView);
         }
       } else if constexpr (Type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) {
         if (engineObject.defined()) {
-          descriptorInfos[idx] = engineObject.getDescriptor().buffer;
+          descriptorInfo = engineObject.getDescriptor().buffer;
+          slot = { engineObject.buffer()->cookie(), getHandleBits(descriptorInfo.buffer), descriptorInfo.offset, descriptorInfo.range };
           ctx->getCommandList()->trackResource<DxvkAccess::Read>(engineObject.buffer());
         }
       } else if constexpr (Type == VK_DESCRIPTOR_TYPE_SAMPLER) {
         if (engineObject != nullptr) {
-          descriptorInfos[idx].sampler = engineObject->handle();
-          descriptorInfos[idx].imageView = nullptr;
+          descriptorInfo.sampler = engineObject->handle();
+          descriptorInfo.imageView = nullptr;
+          slot = { engineObject->cookie(), getHandleBits(descriptorInfo.sampler), 0, 0 };
         }
       } else {
         static_assert(Type != VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || Type != VK_DESCRIPTOR_TYPE_STORAGE_BUFFER || Type != VK_DESCRIPTOR_TYPE_SAMPLER, "Support for this descriptor type has not been implemented yet.");
         return;
       }
 
+      table.slots.update(idx, slot);
+
       ++idx;
     }
 
-    VkWriteDescriptorSet descWrites;
-    memset(&descWrites, 0, sizeof(descWrites));
-    descWrites.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-    descWrites.descriptorCount = numDescriptors;
-    descWrites.descriptorType = Type;
+    // One write per run of changed slots
+    const std::vector<BindlessSlotTracker::Range> ranges = table.slots.getWriteRanges();
 
-    if constexpr (std::is_same_v<T, VkDescriptorImageInfo>) {
-      descWrites.pImageInfo = &descriptorInfos[0];
-    } else if constexpr (std::is_same_v<T, VkDescriptorBufferInfo>) {
-      descWrites.pBufferInfo = &descriptorInfos[0];
-    }
+    table.writes.clear();
+
+    for (const BindlessSlotTracker::Range& range : ranges) {
+      VkWriteDescriptorSet descWrites;
+      memset(&descWrites, 0, sizeof(descWrites));
+      descWrites.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+      descWrites.dstArrayElement = range.begin;
+      descWrites.descriptorCount = range.end - range.begin;
+      descWrites.descriptorType = Type;
+
+      if constexpr (std::is_same_v<T, VkDescriptorImageInfo>) {
+        descWrites.pImageInfo = &(*descriptorInfos)[range.begin];
+      } else if constexpr (std::is_same_v<T, VkDescriptorBufferInfo>) {
+        descWrites.pBufferInfo = &(*descriptorInfos)[range.begin];
+      }
 
-    switch (Type) {
-    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
-      m_tables[Table::Textures][currentIdx()]->updateDescriptors(descWrites);
-      break;
-    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
-      m_tables[Table::Buffers][currentIdx()]->updateDescriptors(descWrites);
-      break;
-    case VK_DESCRIPTOR_TYPE_SAMPLER:
-      m_tables[Table::Samplers][currentIdx()]->updateDescriptors(descWrites);
-      break;
+      table.writes.push_back(descWrites);
     }
+
+    table.updateDescriptors();
+
+    m_descriptorWriteCount[tableType] = BindlessSlotTracker::getSlotCount(ranges);
   }
 
   void BindlessResourceManager::prepareSceneData(const Rc<DxvkContext> ctx, const std::vector<TextureRef>& rtTextures, const std::vector<RaytraceBuffer>& rtBuffers, const std::vector<Rc<DxvkSampler>>& samplers) {
@@ -135,6 +185,9 @@ namespace dxvk {
     createDescriptorSet<VK_DESCRIPTOR_TYPE_STORAGE_BUFFER>(ctx, rtBuffers, dummyBuffer);
     createDescriptorSet<VK_DESCRIPTOR_TYPE_SAMPLER>(ctx, samplers, dummySampler);
 
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxBindlessDescriptorWrites,
+      m_descriptorWriteCount[Table::Textures] + m_descriptorWriteCount[Table::Buffers] + m_descriptorWriteCount[Table::Samplers]);
+
     m_frameLastUpdated = m_device->getCurrentFrameId();
   }
 
@@ -177,22 +230,35 @@ namespace dxvk {
       throw DxvkError("BindlessTable: Failed to create descriptor set layout");
   }
 
-  void BindlessResourceManager::BindlessTable::updateDescriptors(VkWriteDescriptorSet set) {
+  bool BindlessResourceManager::BindlessTable::allocateSet(const VkDescriptorType type) {
     if (bindlessDescSet == nullptr) {
       // Allocate the descriptor set
       bindlessDescSet = m_pManager->m_globalBindlessPool[m_pManager->currentIdx()]->alloc(layout, "bindless descriptor set");
       if (bindlessDescSet == nullptr) {
-        Logger::err(str::format("BindlessTable: failed to allocate a descriptor set for ", set.descriptorCount, " ",
-                                (set.descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) ? "buffers" : "textures"));
-        return;
+        Logger::err(str::format("BindlessTable: failed to allocate a descriptor set for ",
+                                (type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) ? "buffers" : "textures"));
+        return false;
       }
+
+      // Nothing has been written to the new set yet
+      slots.invalidate();
+    }
+
+    return true;
+  }
+
+  void BindlessResourceManager::BindlessTable::updateDescriptors() {
+    if (writes.empty()) {
+      return;
     }
 
-    // Update the write descriptor with our set
-    set.dstSet = bindlessDescSet;
+    // Update the write descriptors with our set
+    for (VkWriteDescriptorSet& write : writes) {
+      write.dstSet = bindlessDescSet;
+    }
 
-    // Do the write
-    vkd()->vkUpdateDescriptorSets(vkd()->device(), 1, &set, 0, nullptr);
+    // Do the writes
+    vkd()->vkUpdateDescriptorSets(vkd()->device(), static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
   }
 
   void BindlessResourceManager::createGlobalBindlessDescPool() {
@@ -22,6 +22,7 @@
 #pragma once
 #include "rtx_utils.h"
 #include "rtx_common_object.h"
+#include "rtx_bindless_slot_tracker.h"
 
 namespace dxvk {
   class DxvkDevice;
@@ -53,6 +54,11 @@ namespace dxvk {
       return m_tables[type][currentIdx()]->layout;
     }
 
+    // Number of descriptors written to the given table in the last update
+    uint32_t getDescriptorWriteCount(Table type) const {
+      return m_descriptorWriteCount[type];
+    }
+
   private:
 
     struct BindlessTable {
@@ -65,8 +71,15 @@ namespace dxvk {
       VkDescriptorSetLayout layout = VK_NULL_HANDLE;
       VkDescriptorSet bindlessDescSet = VK_NULL_HANDLE;
 
+      // What this copy of the table currently holds, so only changed slots get written
+      BindlessSlotTracker slots;
+      std::vector<VkDescriptorImageInfo> imageInfos;
+      std::vector<VkDescriptorBufferInfo> bufferInfos;
+      std::vector<VkWriteDescriptorSet> writes;
+
       void createLayout(const VkDescriptorType type);
-      void updateDescriptors(VkWriteDescriptorSet set);
+      bool allocateSet(const VkDescriptorType type);
+      void updateDescriptors();
 
     private:
       const Rc<vk::DeviceFn> vkd() const;
@@ -81,6 +94,7 @@ namespace dxvk {
 
     uint32_t m_globalBindlessDescSetIdx = 0;
     uint32_t m_frameLastUpdated = UINT_MAX;
+    uint32_t m_descriptorWriteCount[Table::Count] = {};
 
 
     uint32_t currentIdx() const {
@@ -0,0 +1,86 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rtx_dirty_range_tracker.h"
+
+namespace dxvk {
+
+  /*
+  *  Bindless Slot Tracker
+  *
+  *  Remembers what was last written to each slot of one copy of a bindless descriptor table, so
+  *  that a frame only writes the slots whose descriptor changed since that copy was last written.
+  *  Each copy needs its own tracker, as a copy that was skipped for a frame has missed the writes
+  *  made to the other copies.  Slots are keyed by the cookie of the object they reference as well
+  *  as the descriptor contents, since the handles of destroyed objects can be reused.
+  */
+  class BindlessSlotTracker {
+  public:
+    using Range = DirtyRangeTracker::Range;
+
+    struct Slot {
+      uint64_t cookie;
+      uint64_t handle;
+      uint64_t offset;
+      uint64_t range;
+    };
+
+    // Clean slots between dirty ones are rewritten too when that saves starting a new write
+    static constexpr uint32_t kMaxCoalesceGap = 8;
+
+    // Starts a new frame for a table copy with the given number of slots
+    void beginFrame(uint32_t slotCount) {
+      m_slots.resize(slotCount);
+      m_tracker.beginFrame(slotCount);
+    }
+
+    // Returns true if the slot needs to be written this frame
+    bool update(uint32_t index, const Slot& slot) {
+      return m_tracker.updateData(index, &slot, reinterpret_cast<uint8_t*>(m_slots.data()), sizeof(Slot));
+    }
+
+    // Forces every slot to be written on the next frame, e.g. when the descriptor set was reallocated
+    void invalidate() {
+      m_tracker.invalidate();
+    }
+
+    uint32_t getDirtyCount() const { return m_tracker.getDirtyCount(); }
+
+    // Slot ranges to write this frame
+    std::vector<Range> getWriteRanges() const {
+      return m_tracker.getDirtyRanges(kMaxCoalesceGap);
+    }
+
+    static uint32_t getSlotCount(const std::vector<Range>& ranges) {
+      return static_cast<uint32_t>(DirtyRangeTracker::getRangesSize(ranges, 1));
+    }
+
+  private:
+    DirtyRangeTracker m_tracker;
+    std::vector<Slot> m_slots;
+  };
+
+}
@@ -22,6 +22,8 @@
 #pragma once
 #include "../util/util_singleton.h"
 #include "../util/util_messagechannel.h"
+#include "../util/util_env.h"
+#include "../util/log/log.h"
 
 namespace dxvk {
 
@@ -31,7 +33,28 @@ namespace dxvk {
   public:
     BridgeMessageChannel()
     : MessageChannelServer("UWM_REMIX_BRIDGE_REGISTER_THREADPROC_MSG")
-    { }
+    {
+      // When the Bridge names a shared memory channel, messages go through its
+      // rings instead of window messages: it creates "<name>_up" before loading
+      // the renderer and opens "<name>_down" once the renderer created it.
+      const std::string sharedMemoryName = env::getEnvVar("DXVK_REMIX_BRIDGE_SHARED_MEMORY_CHANNEL");
+
+      if (sharedMemoryName.empty()) {
+        return;
+      }
+
+      auto receiver = std::make_unique<SharedMemoryTransport>();
+      auto sender = std::make_unique<SharedMemoryTransport>();
+
+      if (!receiver->openReceiver(sharedMemoryName + "_up") || !sender->createSender(sharedMemoryName + "_down")) {
+        Logger::err(str::format("Unable to open the bridge shared memory channel ", sharedMemoryName, ", using window messages."));
+        return;
+      }
+
+      setReceiver(std::move(receiver));
+      setTransport(std::move(sender));
+      Logger::info(str::format("Bridge message channel uses shared memory channel ", sharedMemoryName, "."));
+    }
   };
 
 }
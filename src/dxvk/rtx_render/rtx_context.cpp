@@ -68,6 +68,7 @@
 #include "../util/util_fastops.h"
 
 #include "../util/util_globaltime.h"
+#include "../util/util_frame_arena.h"
 
 // Destructor requires the struct definitions
 #include "rtx_sky.h"
@@ -717,6 +718,12 @@ namespace dxvk {
     }
 
     GlobalTime::get().update();
+
+    // Memory the frame arena handed out a few frames ago is reused from here on
+    const FrameArena::Stats arenaStats = FrameArena::get().nextFrame();
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxFrameArenaAllocations, arenaStats.allocations);
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxFrameArenaBytes, arenaStats.bytes);
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxFrameArenaHeapFallbacks, arenaStats.heapFallbacks);
   }
 
   // Called right before D3D9 present
@@ -1196,8 +1203,11 @@ namespace dxvk {
     const RtxGlobalVolumetrics& globalVolumetrics = getCommonObjects()->metaGlobalVolumetrics();
     // MHFZ start : send areaData for fill volumetric accordingly
     AreaManager& areaManager = m_device->getAreaManager();
-    const AreaData& area = areaManager.getCurrentAreaData();
-    constants.volumeArgs = globalVolumetrics.getVolumeArgs(cameraManager, getSceneManager().getFogState(), enablePortalVolumes, area);
+    {
+      auto areaLock = areaManager.lockCurrentArea();
+      const AreaData& area = areaManager.getCurrentAreaData();
+      constants.volumeArgs = globalVolumetrics.getVolumeArgs(cameraManager, getSceneManager().getFogState(), enablePortalVolumes, area);
+    }
     // MHFZ end
     constants.startInMediumMaterialIndex = getSceneManager().getStartInMediumMaterialIndex();
     RtxOptions::Get()->opaqueMaterialOptions.fillShaderParams(constants.opaqueMaterialArgs);
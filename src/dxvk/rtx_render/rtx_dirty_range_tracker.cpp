@@ -0,0 +1,53 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_dirty_range_tracker.h"
+#include "rtx_staging.h"
+#include "../dxvk_context.h"
+
+namespace dxvk {
+
+  size_t DirtyRangeTracker::upload(const Rc<DxvkContext>& ctx, RtxStagingDataAlloc& stagingAlloc, const Rc<DxvkBuffer>& buffer,
+                                   const uint8_t* tableData, size_t stride) const {
+    ScopedCpuProfileZone();
+
+    const std::vector<Range> ranges = getDirtyRanges(getMaxCoalesceGap(stride));
+    const size_t uploadSize = getRangesSize(ranges, stride);
+    if (uploadSize == 0) {
+      return 0;
+    }
+
+    DxvkBufferSlice staging = stagingAlloc.alloc(CACHE_LINE_SIZE, uploadSize);
+    uint8_t* stagingPtr = reinterpret_cast<uint8_t*>(staging.mapPtr(0));
+
+    size_t stagingOffset = 0;
+    for (const Range& range : ranges) {
+      const size_t offset = range.begin * stride;
+      const size_t size = (range.end - range.begin) * stride;
+      memcpy(stagingPtr + stagingOffset, tableData + offset, size);
+      ctx->copyBuffer(buffer, offset, staging.buffer(), staging.offset() + stagingOffset, size);
+      stagingOffset += size;
+    }
+
+    return uploadSize;
+  }
+
+}
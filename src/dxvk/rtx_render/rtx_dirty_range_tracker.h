@@ -0,0 +1,147 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "../../util/rc/util_rc_ptr.h"
+
+namespace dxvk {
+
+  class DxvkBuffer;
+  class DxvkContext;
+  class RtxStagingDataAlloc;
+
+  /*
+  *  Dirty Range Tracker
+  *
+  *  Tracks which elements of a GPU table changed since the previous upload.  Each frame the
+  *  owner either reports a tag for every element it is about to upload (e.g. the cache index and
+  *  generation of the object written to that element), or writes the element's data and lets
+  *  the tracker compare it against the previous contents.  Elements that changed are marked
+  *  dirty, and are coalesced into ranges which are then uploaded with one staging allocation.
+  */
+  class DirtyRangeTracker {
+  public:
+    struct Range {
+      uint32_t begin;
+      uint32_t end;
+    };
+
+    // Gaps between dirty ranges up to this many bytes are uploaded as well rather than splitting the copy
+    static constexpr size_t kMaxCoalesceGapBytes = 256;
+
+    // Starts a new frame for a table with the given number of elements
+    void beginFrame(uint32_t elementCount) {
+      if (elementCount != m_tags.size()) {
+        m_tags.resize(elementCount, kInvalidTag);
+      }
+      m_dirty.assign(elementCount, false);
+      m_numDirty = 0;
+    }
+
+    // Returns true if the element needs to be written this frame
+    bool update(uint32_t index, uint64_t tag) {
+      if (m_tags[index] == tag) {
+        return false;
+      }
+      m_tags[index] = tag;
+      markDirty(index);
+      return true;
+    }
+
+    // For tables without a stable tag, compares the new element data against the CPU copy of the
+    // table and updates it if it differs.  Returns true if the element changed.
+    bool updateData(uint32_t index, const void* element, uint8_t* tableData, size_t stride) {
+      uint8_t* dst = tableData + index * stride;
+      if (m_tags[index] == kValidDataTag && std::memcmp(dst, element, stride) == 0) {
+        return false;
+      }
+      std::memcpy(dst, element, stride);
+      m_tags[index] = kValidDataTag;
+      markDirty(index);
+      return true;
+    }
+
+    void markDirty(uint32_t index) {
+      if (!m_dirty[index]) {
+        m_dirty[index] = true;
+        ++m_numDirty;
+      }
+    }
+
+    // Forces every element to be written on the next frame, e.g. when the GPU buffer was recreated
+    void invalidate() {
+      m_tags.assign(m_tags.size(), kInvalidTag);
+    }
+
+    uint32_t getDirtyCount() const { return m_numDirty; }
+    uint32_t getElementCount() const { return static_cast<uint32_t>(m_tags.size()); }
+
+    // Runs of elements updated this frame, runs separated by at most maxGap clean elements are merged
+    std::vector<Range> getDirtyRanges(uint32_t maxGap = 0) const {
+      std::vector<Range> ranges;
+      if (m_numDirty == 0) {
+        return ranges;
+      }
+      for (uint32_t i = 0; i < m_dirty.size(); ++i) {
+        if (!m_dirty[i]) {
+          continue;
+        }
+        if (!ranges.empty() && i - ranges.back().end <= maxGap) {
+          ranges.back().end = i + 1;
+        } else {
+          ranges.push_back(Range { i, i + 1 });
+        }
+      }
+      return ranges;
+    }
+
+    static uint32_t getMaxCoalesceGap(size_t stride) {
+      return static_cast<uint32_t>(kMaxCoalesceGapBytes / stride);
+    }
+
+    static size_t getRangesSize(const std::vector<Range>& ranges, size_t stride) {
+      size_t size = 0;
+      for (const Range& range : ranges) {
+        size += (range.end - range.begin) * stride;
+      }
+      return size;
+    }
+
+    // Copies the dirty ranges of tableData (the CPU copy of the whole table) to buffer through a single
+    // staging allocation.  Returns the number of bytes uploaded.
+    size_t upload(const Rc<DxvkContext>& ctx, RtxStagingDataAlloc& stagingAlloc, const Rc<DxvkBuffer>& buffer,
+                  const uint8_t* tableData, size_t stride) const;
+
+  private:
+    static constexpr uint64_t kInvalidTag = UINT64_MAX;
+    static constexpr uint64_t kValidDataTag = 0;
+
+    std::vector<uint64_t> m_tags;
+    std::vector<bool> m_dirty;
+    uint32_t m_numDirty = 0;
+  };
+
+}
@@ -50,7 +50,7 @@ DrawCallCache::CacheState DrawCallCache::get(const DrawCallState& drawCall, Blas
   // First, find the right bucket:
   const XXH64_hash_t hash = drawCall.getGeometryData().getHashForRule<rules::TopologicalHash>();
   auto range = m_entries.equal_range(hash);
-  if (range.first == m_entries.end()) {
+  if (range.empty()) {
     // New bucket
     *out = allocateEntry(hash, drawCall);
     return CacheState::kNew;
@@ -60,7 +60,7 @@ DrawCallCache::CacheState DrawCallCache::get(const DrawCallState& drawCall, Blas
   iter++;
   if (iter == range.second) {
     // Only 1 element
-    BlasEntry& entry = range.first->second;
+    BlasEntry& entry = *range.first;
 
     const bool updatedThisFrame = entry.frameLastTouched == m_device->getCurrentFrameId();
     const bool vertexDataMatches = entry.input.getGeometryData().getHashForRule<rules::VertexDataHash>() == drawCall.getGeometryData().getHashForRule<rules::VertexDataHash>();
@@ -88,7 +88,7 @@ DrawCallCache::CacheState DrawCallCache::get(const DrawCallState& drawCall, Blas
   const Vector3 newWorldPosition = drawCall.getGeometryData().boundingBox.getTransformedCentroid(newTransform);
 
   for (auto bucketIter = range.first; bucketIter != range.second; bucketIter++) {
-    BlasEntry& blas  = bucketIter->second;
+    BlasEntry& blas  = *bucketIter;
     if (exactMatch(drawCall, blas)) {
       *out = &blas;
       return CacheState::kExisted;
@@ -128,8 +128,7 @@ DrawCallCache::CacheState DrawCallCache::get(const DrawCallState& drawCall, Blas
 }
 
 BlasEntry* DrawCallCache::allocateEntry(XXH64_hash_t hash, const DrawCallState& drawCall) {
-  auto iter = m_entries.emplace(hash, drawCall);
-  BlasEntry* result = &iter->second;
+  BlasEntry* result = &m_entries.emplace(hash, drawCall);
   result->frameCreated = m_device->getCurrentFrameId();
   return result;
 }
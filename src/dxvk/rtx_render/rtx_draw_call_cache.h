@@ -23,9 +23,9 @@
 
 #include <vector>
 #include <limits>
-#include <unordered_map>
 
 #include "../util/util_vector.h"
+#include "../util/util_slab_map.h"
 #include "dxvk_scoped_annotation.h"
 
 #include "rtx_types.h"
@@ -37,10 +37,10 @@ namespace dxvk
 class DxvkDevice;
 
 // A cache of the BlasEntries across frames.  This maintains stable BlasEntry pointers until that BlasEntry
-// is erased by sceneManager's garbage collection.
+// is erased by sceneManager's garbage collection.  Entries are stored in slabs keyed by the topological hash.
 class DrawCallCache : public CommonDeviceObject {
 public:
-  using MultimapType = std::unordered_multimap<XXH64_hash_t, BlasEntry, XXH64_hash_passthrough>;
+  using EntryMap = slab_multimap<BlasEntry>;
 
   enum class CacheState
   {
@@ -56,20 +56,20 @@ public:
 
   CacheState get(const DrawCallState& drawCall, BlasEntry** out);
 
-  MultimapType& getEntries() {return m_entries;}
+  EntryMap& getEntries() {return m_entries;}
 
   void clear() {
     m_entries.clear();
   }
   
   void rebuildSpatialMaps() {
-    for (auto iter = m_entries.begin(); iter != m_entries.end(); ++iter) {
-      iter->second.rebuildSpatialMap();
+    for (BlasEntry& entry : m_entries) {
+      entry.rebuildSpatialMap();
     }
   }
 
 private:
-  MultimapType m_entries;
+  EntryMap m_entries;
 
   BlasEntry* allocateEntry(XXH64_hash_t hash, const DrawCallState& drawCall);
 };
@@ -124,6 +124,13 @@ namespace dxvk {
   }
 
   GameCapturer::~GameCapturer() {
+    // Don't keep writing stages for a capturer that is going away, the export
+    // thread uses the progress and state members until it returns
+    m_exportProgress.bCancel = true;
+
+    if (m_exportThread.joinable()) {
+      m_exportThread.join();
+    }
   }
 
   void GameCapturer::step(const Rc<DxvkContext> ctx, const float frameTimeMilliseconds, const HWND hwnd) {
@@ -463,6 +470,7 @@ namespace dxvk {
         m_pCap->meshes[meshHash] = std::make_shared<Mesh>();
         m_pCap->meshes[meshHash]->instanceCount = 0;
         m_pCap->meshes[meshHash]->matHash = matHash;
+        initMeshBufferTracks(*m_pCap->meshes[meshHash]);
       }
       instanceNum = m_pCap->meshes[meshHash]->instanceCount++;
     }
@@ -538,11 +546,11 @@ namespace dxvk {
     const size_t numIndices = geomData.indexCount;
     const bool isDoubleSided = geomData.cullMode == VK_CULL_MODE_NONE;
     if (bIsNewMesh) {
-      assert(pMesh->lssData.buffers.positionBufs.size() == 0);
-      assert(pMesh->lssData.buffers.normalBufs.size() == 0);
-      assert(pMesh->lssData.buffers.idxBufs.size() == 0);
-      assert(pMesh->lssData.buffers.texcoordBufs.size() == 0);
-      assert(pMesh->lssData.buffers.colorBufs.size() == 0);
+      assert(pMesh->bufferTracks.position.empty());
+      assert(pMesh->bufferTracks.normal.empty());
+      assert(pMesh->bufferTracks.idx.empty());
+      assert(pMesh->bufferTracks.texcoord.empty());
+      assert(pMesh->bufferTracks.color.empty());
       pMesh->lssData.meshName = dxvk::hashToString(currentMeshHash);
       for (uint32_t i = 0; i < (uint32_t) HashComponents::Count; i++) {
         const HashComponents component = (HashComponents) i;
@@ -628,14 +636,8 @@ namespace dxvk {
         pMesh->originCalc.compareAndSwap(originCalc);
       }
       assert(positions.size() > 0);
-      // Create comparison function that returns float
-      static auto positionsDifferentEnough = [](const pxr::GfVec3f& a, const pxr::GfVec3f& b) {
-        const static float captureMeshPositionDelta = RtxOptions::Get()->getCaptureMeshPositionDelta();
-        const static float captureMeshPositionDeltaSq = captureMeshPositionDelta * captureMeshPositionDelta;
-        return (a - b).GetLengthSq() > captureMeshPositionDeltaSq;
-      };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.positionBufs, positions, currentFrameNum, positionsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->bufferTracks.position, positions, currentFrameNum);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, inputPositionBuffer, captureMeshPositionsAsync);
@@ -667,14 +669,8 @@ namespace dxvk {
         normals.push_back(pxr::GfVec3f(&pVkNormalBuf[idx * normalStride]));
       }
       assert(normals.size() > 0);
-      // Create comparison function that returns float
-      static auto normalsDifferentEnough = [](const pxr::GfVec3f& a, const pxr::GfVec3f& b) {
-        const static float captureMeshNormalDelta = RtxOptions::Get()->getCaptureMeshNormalDelta();
-        const static float captureMeshNormalDeltaSq = captureMeshNormalDelta * captureMeshNormalDelta;
-        return (a - b).GetLengthSq() > captureMeshNormalDeltaSq;
-      };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.normalBufs, normals, currentFrameNum, normalsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->bufferTracks.normal, normals, currentFrameNum);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, inputNormalBuffer, captureMeshNormalsAsync);
@@ -730,12 +726,8 @@ namespace dxvk {
         }
       }
 
-      // Create comparison function that returns float
-      static auto differentIndices = [](const int a, const int b) {
-        return a != b;
-      };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.idxBufs, indices, currentFrameNum, differentIndices);
+      evalNewBufferAndCache(pMesh, pMesh->bufferTracks.idx, indices, currentFrameNum);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.indexBuffer, captureMeshIndicesAsync);
@@ -768,14 +760,8 @@ namespace dxvk {
                                          1.0f - pVkTexcoordsBuf[idx * texcoordStride + 1]));
       }
       assert(texcoords.size() > 0);
-      // Create comparison function that returns float
-      static auto differentIndices = [](const pxr::GfVec2f& a, const pxr::GfVec2f& b) {
-        const static float captureMeshTexcoordDelta = RtxOptions::Get()->getCaptureMeshTexcoordDelta();
-        const static float captureMeshTexcoordDeltaSq = captureMeshTexcoordDelta * captureMeshTexcoordDelta;
-        return (a - b).GetLengthSq() > captureMeshTexcoordDeltaSq;
-      };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.texcoordBufs, texcoords, currentFrameNum, differentIndices);
+      evalNewBufferAndCache(pMesh, pMesh->bufferTracks.texcoord, texcoords, currentFrameNum);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.texcoordBuffer, captureMeshTexCoordsAsync);
@@ -809,14 +795,8 @@ namespace dxvk {
                                       (float) pVkColorBuf[idx * colorStride + 3] / 255.f));
       }
       assert(colors.size() > 0);
-      // Create comparison function that returns float
-      static auto colorsDifferentEnough = [](const pxr::GfVec4f& a, const pxr::GfVec4f& b) {
-        const static float captureMeshColorDelta = RtxOptions::Get()->getCaptureMeshColorDelta();
-        const static float captureMeshColorDeltaSq = captureMeshColorDelta * captureMeshColorDelta;
-        return (a - b).GetLengthSq() > captureMeshColorDeltaSq;
-      };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.colorBufs, colors, currentFrameNum, colorsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->bufferTracks.color, colors, currentFrameNum);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.color0Buffer, captureMeshColorAsync);
@@ -860,13 +840,8 @@ namespace dxvk {
         targetBuffer.push_back(lastWeight);
       }
       assert(targetBuffer.size() > 0);
-      // Create comparison function that returns float
-      static auto weightsDifferentEnough = [](const float& a, const float& b) {
-        const static float delta = RtxOptions::Get()->getCaptureMeshBlendWeightDelta();
-        return std::abs(a - b) > delta;
-      };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendWeightBufs, targetBuffer, currentFrameNum, weightsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->bufferTracks.blendWeight, targetBuffer, currentFrameNum);
     };
     AssetExporter::BufferCallback captureMeshBlendIndicesAsync = [ctx, geomData, currentFrameNum, pMesh](Rc<DxvkBuffer> inBuf) {
       assert(geomData.blendIndicesBuffer.vertexFormat() == VK_FORMAT_R8G8B8A8_USCALED);
@@ -890,12 +865,8 @@ namespace dxvk {
         }
       }
       assert(targetBuffer.size() > 0);
-      // Create comparison function that returns float
-      static auto weightsDifferentEnough = [](const int& a, const int& b) {
-        return a != b;
-      };
       // Cache buffer iff new buffer differs from previous buffer
-      evalNewBufferAndCache(pMesh, pMesh->lssData.buffers.blendIndicesBufs, targetBuffer, currentFrameNum, weightsDifferentEnough);
+      evalNewBufferAndCache(pMesh, pMesh->bufferTracks.blendIndices, targetBuffer, currentFrameNum);
     };
     pMesh->meshSync.numOutstandingInc();
     m_exporter.copyBufferFromGPU(ctx, geomData.blendWeightBuffer, captureMeshBlendWeightsAsync);
@@ -905,43 +876,34 @@ namespace dxvk {
     }
   }
 
-  template <typename T, typename CompareTReturnBool>
-  static void GameCapturer::evalNewBufferAndCache(std::shared_ptr<Mesh> pMesh,
-                                                  std::map<float, pxr::VtArray<T>>& bufferCache,
-                                                  pxr::VtArray<T>& newBuffer,
-                                                  const float currentFrameNum,
-                                                  CompareTReturnBool compareT) {
-    std::lock_guard lock(pMesh->meshSync.mutex);
-    // Discover whether the new buffer is worth cacheing
-    bool bSufficientlyDifferent = false;
-    if (bufferCache.size() > 0) {
-      const auto& prevBuf = (--bufferCache.cend())->second;
-      assert(newBuffer.size() == prevBuf.size());
-      for (size_t idx = 0; idx < newBuffer.size(); ++idx) {
-        const T& newVal = newBuffer[idx];
-        const T& prevVal = prevBuf[idx];
-        bSufficientlyDifferent = compareT(newVal, prevVal);
-        if (bSufficientlyDifferent) {
-          // Early out as soon as we've found enough of a difference
-          break;
-        }
-      }
-    } else {
-      bSufficientlyDifferent = true;
-    }
-    // Cache VtArray if there is a large enough delta
-    if (bSufficientlyDifferent) {
-      bufferCache[currentFrameNum] = std::move(newBuffer);
-    }
-    pMesh->meshSync.numOutstanding--;
-    pMesh->meshSync.cond.notify_all();
+  void GameCapturer::initMeshBufferTracks(Mesh& mesh) {
+    BufferDedup& dedup = m_pCap->bufferDedup;
+    const bool bSparse = m_options.bSparseDeltas;
+    MeshBufferTracks& tracks = mesh.bufferTracks;
+    tracks.idx.init(0.f, bSparse, &dedup.integer);
+    tracks.position.init(m_options.dPos, bSparse, &dedup.vec3);
+    tracks.normal.init(m_options.dNorm, bSparse, &dedup.vec3);
+    tracks.texcoord.init(m_options.dTexcoord, bSparse, &dedup.vec2);
+    tracks.color.init(m_options.dColor, bSparse, &dedup.vec4);
+    tracks.blendWeight.init(m_options.dBlendweight, bSparse, &dedup.scalar);
+    tracks.blendIndices.init(0.f, bSparse, &dedup.integer);
+  }
+
+  template <typename T>
+  void GameCapturer::evalNewBufferAndCache(std::shared_ptr<Mesh> pMesh,
+                                           CaptureBufferTrack<T>& bufferTrack,
+                                           pxr::VtArray<T>& newBuffer,
+                                           const float currentFrameNum) {
+    // Tracks are locked individually, so the buffers of one mesh are compared concurrently
+    bufferTrack.push(currentFrameNum, std::move(newBuffer));
+    pMesh->meshSync.numOutstandingDec();
   }
 
   void GameCapturer::exportUsd(const Rc<DxvkContext> ctx) {
     assert(m_state.has<State::BeginExport>());
     assert(!m_state.has<State::PreppingExport>());
     assert(!m_state.has<State::Exporting>());
-    static auto exportThreadTask = [this](const Rc<DxvkContext> ctx,
+    auto exportThreadTask = [this](const Rc<DxvkContext> ctx,
                                           std::unique_ptr<Capture> pCap,
                                           State* pState,
                                           CompletedCapture* complete,
@@ -957,7 +919,11 @@ namespace dxvk {
       pState->set<State::Exporting, true>();
 
       Logger::info("[GameCapturer][" + cap.idStr + "] Begin USD export");
-      lss::GameExporter::exportUsd(exportPrep);
+      if (!lss::GameExporter::exportUsd(exportPrep, &m_exportProgress)) {
+        Logger::warn("[GameCapturer][" + cap.idStr + "] USD export cancelled");
+        pState->set<State::Exporting, false>();
+        return;
+      }
       Logger::info("[GameCapturer][" + cap.idStr + "] End USD export");
 
       // Necessary step for being able to properly diff and check for regressions
@@ -972,14 +938,20 @@ namespace dxvk {
       pState->set<State::Complete, true>();
     };
 
+    // The previous export finished before this one could begin
+    if (m_exportThread.joinable()) {
+      m_exportThread.join();
+    }
+
+    m_exportProgress.reset();
     m_state.set<State::PreppingExport, true>();
     m_state.set<State::BeginExport, false>();
-    std::thread(exportThreadTask,
-                ctx,
-                std::move(m_pCap),
-                &m_state,
-                &m_completeCapture,
-                static_cast<float>(m_options.fps)).detach();
+    m_exportThread = std::thread(exportThreadTask,
+                                 ctx,
+                                 std::move(m_pCap),
+                                 &m_state,
+                                 &m_completeCapture,
+                                 static_cast<float>(m_options.fps));
   }
 
   lss::Export GameCapturer::prepExport(const Capture& cap,
@@ -1058,11 +1030,24 @@ namespace dxvk {
         pMesh->lssData.origin = pMesh->originCalc.calc();
         stageOriginCalc.compareAndSwap(pMesh->lssData.origin);
       }
+      const MeshBufferTracks& tracks = pMesh->bufferTracks;
+      lss::MeshBuffers& buffers = pMesh->lssData.buffers;
+      tracks.idx.resolve(buffers.idxBufs);
+      tracks.position.resolve(buffers.positionBufs);
+      tracks.normal.resolve(buffers.normalBufs);
+      tracks.texcoord.resolve(buffers.texcoordBufs);
+      tracks.color.resolve(buffers.colorBufs);
+      tracks.blendWeight.resolve(buffers.blendWeightBufs);
+      tracks.blendIndices.resolve(buffers.blendIndicesBufs);
       exportPrep.meshes[hash] = pMesh->lssData;
     }
     if(m_correctBakedTransforms) {
       exportPrep.stageOrigin = stageOriginCalc.calc();
     }
+    const BufferDedup& dedup = cap.bufferDedup;
+    const size_t numShared = dedup.vec2.getNumShared() + dedup.vec3.getNumShared() + dedup.vec4.getNumShared() +
+                             dedup.scalar.getNumShared() + dedup.integer.getNumShared();
+    Logger::debug(str::format("[GameCapturer][", cap.idStr, "] Identical mesh buffers shared: ", numShared));
   }
 
   void GameCapturer::prepExportInstances(const Capture& cap, lss::Export& exportPrep) {
@@ -85,6 +85,7 @@
 #include <vector>
 #include <unordered_map>
 #include <mutex>
+#include <thread>
 
 namespace dxvk 
 {
@@ -155,6 +156,10 @@ public:
   const CompletedCapture& queryCompleteCapture() const {
     return m_completeCapture;
   }
+  // Fraction of the captured assets written to USD so far, while exporting
+  float getExportProgress() const {
+    return m_exportProgress.getFraction();
+  }
 
 private:
   GameCapturer() = delete;
@@ -180,8 +185,28 @@ private:
     void numOutstandingDec() { { std::lock_guard lock(mutex); numOutstanding--; } cond.notify_all(); }
   };
 
+  struct BufferDedup {
+    CaptureBufferDedup<pxr::GfVec2f> vec2;
+    CaptureBufferDedup<pxr::GfVec3f> vec3;
+    CaptureBufferDedup<pxr::GfVec4f> vec4;
+    CaptureBufferDedup<float>        scalar;
+    CaptureBufferDedup<int>          integer;
+  };
+
+  // Captured time samples, resolved into lssData.buffers at export
+  struct MeshBufferTracks {
+    CaptureBufferTrack<lss::Index>       idx;
+    CaptureBufferTrack<lss::Pos>         position;
+    CaptureBufferTrack<lss::Norm>        normal;
+    CaptureBufferTrack<lss::Texcoord>    texcoord;
+    CaptureBufferTrack<lss::Color>       color;
+    CaptureBufferTrack<lss::BlendWeight> blendWeight;
+    CaptureBufferTrack<lss::BlendIdx>    blendIndices;
+  };
+
   struct Mesh {
     lss::Mesh        lssData;
+    MeshBufferTracks bufferTracks;
     size_t           instanceCount = 0;
     XXH64_hash_t     matHash;
     MeshSync         meshSync;
@@ -245,12 +270,12 @@ private:
                            const RasterGeometry& geomData,
                            const float currentCaptureTime,
                            std::shared_ptr<Mesh> pMesh);
-  template <typename T, typename CompareTReturnBool>
+  void initMeshBufferTracks(Mesh& mesh);
+  template <typename T>
   static void evalNewBufferAndCache(std::shared_ptr<Mesh> pMesh,
-                                    std::map<float,pxr::VtArray<T>>& bufferCache,
+                                    CaptureBufferTrack<T>& bufferTrack,
                                     pxr::VtArray<T>& newBuffer,
-                                    const float currentCaptureTime,
-                                    CompareTReturnBool compareT);
+                                    const float currentCaptureTime);
   void exportUsd(const Rc<DxvkContext> ctx);
   struct Capture;
   static lss::Export prepExport(const Capture& cap,
@@ -289,6 +314,7 @@ private:
     float dTexcoord;
     float dColor;
     float dBlendweight;
+    bool bSparseDeltas;
   } m_options;
 
   static Options getOptions() {
@@ -302,12 +328,16 @@ private:
              RtxOptions::Get()->getCaptureMeshNormalDelta(),
              RtxOptions::Get()->getCaptureMeshTexcoordDelta(),
              RtxOptions::Get()->getCaptureMeshColorDelta(),
-             RtxOptions::Get()->getCaptureMeshBlendWeightDelta() };
+             RtxOptions::Get()->getCaptureMeshBlendWeightDelta(),
+             RtxOptions::Get()->getCaptureMeshSparseDeltas() };
   }
 
   // State
   bool m_bTriggerCapture = false;
   State m_state;
+  lss::ExportProgress m_exportProgress;
+  // Joined on destruction, it writes m_state, m_exportProgress and m_completeCapture
+  std::thread m_exportThread;
 
   // Handles
   DxvkDevice* const m_pDevice;
@@ -334,6 +364,7 @@ private:
     std::unordered_map<XXH64_hash_t, Material> materials;
     std::unordered_map<XXH64_hash_t, Instance> instances;
     std::unordered_map<XXH64_hash_t, uint8_t> instanceFlags;
+    BufferDedup bufferDedup;
     HWND hwnd;
   };
   std::unique_ptr<Capture> m_pCap;
@@ -25,9 +25,20 @@
 #include <pxr/base/gf/vec3f.h>
 #include <pxr/base/gf/matrix4f.h>
 #include <pxr/base/gf/matrix4d.h>
+#include <pxr/base/vt/array.h>
 #include "../../lssusd/usd_include_end.h"
 
+#include "../../util/thread.h"
+#include "../../util/util_fastops.h"
+#include "../../util/xxHash/xxhash.h"
+
 #include <atomic>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 namespace dxvk {
 
@@ -119,4 +130,191 @@ static inline T swapBasis(const T& xform) {
   return XYflip * xform * XYflip;
 }
 
+// Returns true if any element of newBuf differs from prevBuf by more than threshold. Integer buffers
+// (indices) ignore the threshold and must match exactly.
+template<typename T>
+static inline bool isCaptureBufferDifferent(const pxr::VtArray<T>& newBuf,
+                                            const pxr::VtArray<T>& prevBuf,
+                                            const float threshold) {
+  assert(newBuf.size() == prevBuf.size());
+  if constexpr (std::is_integral_v<T>) {
+    return std::memcmp(newBuf.cdata(), prevBuf.cdata(), newBuf.size() * sizeof(T)) != 0;
+  } else {
+    static_assert(sizeof(T) % sizeof(float) == 0 && sizeof(T) <= 4 * sizeof(float),
+                  "Captured buffers must be packed float vectors");
+    return fast::anyDistanceExceeds(reinterpret_cast<const float*>(newBuf.cdata()),
+                                    reinterpret_cast<const float*>(prevBuf.cdata()),
+                                    newBuf.size(), sizeof(T) / sizeof(float), threshold);
+  }
+}
+
+// Capture-wide content hash of stored buffers. Animated meshes often repeat a pose, and instanced
+// skinned meshes often share one, so identical time samples share a single VtArray allocation.
+template<typename T>
+struct CaptureBufferDedup {
+  // Replaces buffer with an already stored buffer of identical contents, if there is one
+  inline bool share(pxr::VtArray<T>& buffer) {
+    const size_t numBytes = buffer.size() * sizeof(T);
+    const XXH64_hash_t hash = XXH3_64bits(buffer.cdata(), numBytes);
+    std::lock_guard lock(m_mutex);
+    auto range = m_buffers.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second.size() == buffer.size() && std::memcmp(it->second.cdata(), buffer.cdata(), numBytes) == 0) {
+        buffer = it->second;
+        m_numShared.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+    }
+    m_buffers.emplace(hash, buffer);
+    return false;
+  }
+  // Safe to read while other threads are still sharing buffers
+  inline size_t getNumShared() const {
+    return m_numShared.load(std::memory_order_relaxed);
+  }
+private:
+  dxvk::mutex m_mutex;
+  std::unordered_multimap<XXH64_hash_t, pxr::VtArray<T>> m_buffers;
+  std::atomic<size_t> m_numShared = 0;
+};
+
+// Time samples of one mesh buffer (positions, normals, ...) over a capture.
+//
+// A new buffer is only stored if it differs enough from the latest stored sample. When sparse deltas
+// are enabled and few elements changed, only the changed elements are stored, and the full buffers
+// are rebuilt by resolve() at export time. Every element that differs bitwise is part of the delta,
+// so the resolved samples are identical to storing every buffer in full.
+template<typename T>
+struct CaptureBufferTrack {
+  inline void init(const float threshold, const bool bSparseDeltas, CaptureBufferDedup<T>* pDedup) {
+    m_threshold = threshold;
+    m_bSparseDeltas = bSparseDeltas;
+    m_pDedup = pDedup;
+  }
+
+  // Returns true if newBuffer was stored as a time sample
+  inline bool push(const float timeCode, pxr::VtArray<T>&& newBuffer) {
+    std::lock_guard lock(m_mutex);
+    if (!m_samples.empty()) {
+      if (!isCaptureBufferDifferent(newBuffer, m_latest, m_threshold)) {
+        return false;
+      }
+      if (m_bSparseDeltas && timeCode > m_latestTime && storeDelta(timeCode, newBuffer)) {
+        m_latest = std::move(newBuffer);
+        return true;
+      }
+    }
+    if (m_pDedup) {
+      m_pDedup->share(newBuffer);
+    }
+    if (m_samples.empty() || timeCode >= m_latestTime) {
+      m_latest = newBuffer;
+      m_latestTime = timeCode;
+    } else if (m_samples.count(timeCode) > 0) {
+      // A sample arriving out of order replaces an older one, deltas based on it must keep their contents
+      for (auto& [otherTime, other] : m_samples) {
+        if (other.bDelta && other.baseTime == timeCode) {
+          other.full = resolveSample(otherTime);
+          other.bDelta = false;
+          other.deltaIndices = {};
+          other.deltaValues = {};
+        }
+      }
+    }
+    Sample& sample = m_samples[timeCode];
+    sample = Sample();
+    sample.full = std::move(newBuffer);
+    return true;
+  }
+
+  inline bool empty() const {
+    return m_samples.empty();
+  }
+
+  inline size_t getNumDeltas() const {
+    return m_numDeltas;
+  }
+
+  // Builds the full buffer of every stored time sample
+  inline void resolve(std::map<float, pxr::VtArray<T>>& bufSet) const {
+    bufSet.clear();
+    for (const auto& [timeCode, sample] : m_samples) {
+      if (!sample.bDelta) {
+        bufSet.emplace_hint(bufSet.end(), timeCode, sample.full);
+        continue;
+      }
+      // Copying shares the base sample's storage, the first write detaches it
+      pxr::VtArray<T> buffer = bufSet.at(sample.baseTime);
+      applyDelta(sample, buffer);
+      bufSet.emplace_hint(bufSet.end(), timeCode, std::move(buffer));
+    }
+  }
+
+private:
+  struct Sample {
+    pxr::VtArray<T> full;
+    bool bDelta = false;
+    float baseTime = 0.f;
+    std::vector<uint32_t> deltaIndices;
+    std::vector<T> deltaValues;
+  };
+
+  static inline void applyDelta(const Sample& sample, pxr::VtArray<T>& buffer) {
+    T* const pData = buffer.data();
+    for (size_t i = 0; i < sample.deltaIndices.size(); ++i) {
+      pData[sample.deltaIndices[i]] = sample.deltaValues[i];
+    }
+  }
+
+  inline pxr::VtArray<T> resolveSample(const float timeCode) const {
+    std::vector<const Sample*> chain;
+    const Sample* pSample = &m_samples.at(timeCode);
+    while (pSample->bDelta) {
+      chain.push_back(pSample);
+      pSample = &m_samples.at(pSample->baseTime);
+    }
+    pxr::VtArray<T> buffer = pSample->full;
+    for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+      applyDelta(**it, buffer);
+    }
+    return buffer;
+  }
+
+  // A delta is only worth it if it takes less than half the memory of the full buffer
+  inline bool storeDelta(const float timeCode, const pxr::VtArray<T>& newBuffer) {
+    const size_t maxChanged = newBuffer.size() * sizeof(T) / (2 * (sizeof(T) + sizeof(uint32_t)));
+    std::vector<uint32_t> indices;
+    const T* const pNew = newBuffer.cdata();
+    const T* const pLatest = m_latest.cdata();
+    for (size_t i = 0; i < newBuffer.size(); ++i) {
+      if (std::memcmp(&pNew[i], &pLatest[i], sizeof(T)) != 0) {
+        if (indices.size() == maxChanged) {
+          return false;
+        }
+        indices.push_back(static_cast<uint32_t>(i));
+      }
+    }
+    Sample& sample = m_samples[timeCode];
+    sample.bDelta = true;
+    sample.baseTime = m_latestTime;
+    sample.deltaValues.reserve(indices.size());
+    for (const uint32_t idx : indices) {
+      sample.deltaValues.push_back(pNew[idx]);
+    }
+    sample.deltaIndices = std::move(indices);
+    m_latestTime = timeCode;
+    ++m_numDeltas;
+    return true;
+  }
+
+  dxvk::mutex m_mutex;
+  float m_threshold = 0.f;
+  bool m_bSparseDeltas = false;
+  CaptureBufferDedup<T>* m_pDedup = nullptr;
+  std::map<float, Sample> m_samples;
+  pxr::VtArray<T> m_latest;
+  float m_latestTime = 0.f;
+  size_t m_numDeltas = 0;
+};
+
 }
@@ -103,7 +103,7 @@ namespace dxvk {
   }
 
   template<typename T>
-  XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const std::vector<T>& uniqueIndices) {
+  XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const frame_vector<T>& uniqueIndices) {
     ScopedCpuProfileZone();
 
     XXH64_hash_t result = 0;
@@ -217,9 +217,9 @@ namespace dxvk {
   }
 
   // Supported template params
-  template XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const std::vector<uint16_t>& uniqueIndices);
-  template XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const std::vector<uint32_t>& uniqueIndices);
-  template XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const std::vector<int>& uniqueIndices);
+  template XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const frame_vector<uint16_t>& uniqueIndices);
+  template XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const frame_vector<uint32_t>& uniqueIndices);
+  template XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const frame_vector<int>& uniqueIndices);
 
   template XXH64_hash_t hashIndicesLegacy<uint16_t>(const void* pIndexData, const size_t indexCount);
   template XXH64_hash_t hashIndicesLegacy<uint32_t>(const void* pIndexData, const size_t indexCount);
@@ -28,6 +28,7 @@
 #include "../util/xxHash/xxhash.h"
 #include "../util/rc/util_rc_ptr.h"
 #include "../util/util_flags.h"
+#include "../util/util_frame_arena.h"
 
 namespace dxvk {
   enum class HashComponents : uint32_t {
@@ -210,7 +211,7 @@ namespace dxvk {
     *   uniqueIndices [in]: indices (byte offsets as multiples of query.stride) to hash
     */
   template<typename T>
-  XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const std::vector<T>& uniqueIndices);
+  XXH64_hash_t hashVertexRegionIndexed(const HashQuery& query, const frame_vector<T>& uniqueIndices);
 
   template<typename T>
   [[deprecated("(REMIX-656): Remove this once we can transition content to new hash)")]]
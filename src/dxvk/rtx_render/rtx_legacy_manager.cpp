@@ -577,90 +577,16 @@ namespace dxvk {
 
   void LegacyManager::pushToLoad(uint32_t texturehash, D3D9CommonTexture* texture){
 
-    std::optional<std::string> albedoPath;
-    std::optional<std::string> normalPath;
-    std::optional<std::string> roughnessPath;
-    std::optional<std::string> metallicPath;
-    std::optional<std::string> heightPath;
-    std::optional<std::string> emissivePath;
-
     wchar_t file_prefix[MAX_PATH] = L"";
     GetModuleFileNameW(nullptr, file_prefix, ARRAYSIZE(file_prefix));
-    bool found = false;
     std::filesystem::path folderPath = file_prefix;
     folderPath = folderPath.parent_path();
     folderPath = folderPath.parent_path();
     folderPath /= "PBRData";
-    HRESULT result = FALSE;
-    if (std::filesystem::exists(folderPath)) {
-      wchar_t hash_string[11];
-      swprintf_s(hash_string, L"%x", texturehash);
-      std::wstring strHash = hash_string;
-      for (const auto& entry : std::filesystem::directory_iterator(folderPath)) {
-        std::filesystem::path albedoPathTexturePath = entry;
-        albedoPathTexturePath /= strHash;
-        albedoPathTexturePath += ".a.rtex.dds";
-
-        if (std::filesystem::exists(albedoPathTexturePath)) {
-   
-          albedoPath = albedoPathTexturePath.string();
-          for (const auto& entryPbr : std::filesystem::directory_iterator(folderPath)) {
-              std::filesystem::path normalTexturePath = entryPbr;
-              normalTexturePath /= strHash;
-              normalTexturePath += "_normal_dx_OTH_Normal.n.rtex.dds";
-              if (std::filesystem::exists(normalTexturePath)) {
-                normalPath = normalTexturePath.string();
-              } 
-              std::filesystem::path roughnessTexturePath = entryPbr;
-              roughnessTexturePath /= strHash;
-              roughnessTexturePath += "_roughness.r.rtex.dds";
-              if (std::filesystem::exists(roughnessTexturePath)) {
-                roughnessPath = roughnessTexturePath.string();
-              }
-              std::filesystem::path metallicTexturePath = entryPbr;
-              metallicTexturePath /= strHash;
-              metallicTexturePath += "_metallic.m.rtex.dds";
-              if (std::filesystem::exists(metallicTexturePath)) {
-                metallicPath = metallicTexturePath.string();
-              }
-              std::filesystem::path heightTexturePath = entryPbr;
-              heightTexturePath /= strHash;
-              heightTexturePath += "_height.h.rtex.dds";
-              if (std::filesystem::exists(heightTexturePath)) {
-                heightPath = heightTexturePath.string();
-              }
-              std::filesystem::path emissiveTexturePath = entryPbr;
-              emissiveTexturePath /= strHash;
-              emissiveTexturePath += "_emissive.e.rtex.dds";
-              if (std::filesystem::exists(emissiveTexturePath)) {
-                emissivePath = emissiveTexturePath.string();
-              }
-            }
-        }
-      }
-    }
-    TextureOrigin origin = TextureOrigin::None;
-    if (albedoPath.has_value()) {
-      const std::string& path = albedoPath.value();
-      if (path.find("stage") != std::string::npos) {
-        origin = TextureOrigin::Stage;
-      }
-      else if (path.find("emmodel") != std::string::npos) {
-        origin = TextureOrigin::Emmodel;
-      }
-      else if (path.find("extend") != std::string::npos) {
-        origin = TextureOrigin::Extend;
-      }
-      else if (path.find("npc") != std::string::npos) {
-        origin = TextureOrigin::NPC;
-      }
-      else if (path.find("parts") != std::string::npos) {
-        origin = TextureOrigin::Parts;
-      }
-      else if (path.find("effect") != std::string::npos) {
-        origin = TextureOrigin::Effect;
-      }
-    }
+
+    LegacyTexturePaths paths = findLegacyTexturePaths(folderPath, texturehash);
+    const TextureOrigin origin = getLegacyTextureOrigin(paths.albedo);
+
     auto [it,_] = m_legacyMaterialsLayer.try_emplace(texturehash, LegacyMaterialLayer {});
     LegacyMaterialLayer& material = it->second;
 
@@ -668,50 +594,15 @@ namespace dxvk {
       material.features |= LegacyMaterialFeature::Particle;
     }
 
-    if (origin == TextureOrigin::Extend || origin == TextureOrigin::Parts || origin == TextureOrigin::NPC) {
-      material.features |= LegacyMaterialFeature::NoFade;
-    }
-    if (origin == TextureOrigin::Extend || origin == TextureOrigin::Parts || origin == TextureOrigin::NPC || origin == TextureOrigin::Effect) {
-      material.features |= LegacyMaterialFeature::RejectDecal;
-    }
-    if (origin == TextureOrigin::Emmodel) {
-      material.normalStrength = -1.0f;
-      material.features &= ~LegacyMaterialFeature::BackFaceCulling;
-    }
-
-    if (material.testFeatures(LegacyMaterialFeature::Particle)) {
-      albedoPath.reset();
-      normalPath.reset();
-      roughnessPath.reset();
-      metallicPath.reset();
-      heightPath.reset();
-    }
+    applyLegacyOriginDefaults(origin, material.features, material.normalStrength);
 
-    if (material.testFeatures(LegacyMaterialFeature::Sky)) {
-      normalPath.reset();
-      roughnessPath.reset();
-      metallicPath.reset();
-      heightPath.reset();
-    }
-#ifndef REMIX_DEVELOPMENT
-    if (material.testFeatures(LegacyMaterialFeature::Albedo) == false) {
-      albedoPath.reset();
-    }
-    if (material.testFeatures(LegacyMaterialFeature::Normal) == false) {
-      normalPath.reset();
-    }
-    if (material.testFeatures(LegacyMaterialFeature::Roughness) == false) {
-      roughnessPath.reset();
-    }
-    if (material.testFeatures(LegacyMaterialFeature::Metallic) == false) {
-      metallicPath.reset();
-    }
-    if (material.testFeatures(LegacyMaterialFeature::Height) == false) {
-      heightPath.reset();
-    }
+#ifdef REMIX_DEVELOPMENT
+    filterLegacyTexturePaths(material.features, true, paths);
+#else
+    filterLegacyTexturePaths(material.features, false, paths);
 #endif
 
-    m_textures[0].emplace(texture, LegacyTexture { texturehash , albedoPath, normalPath, roughnessPath, metallicPath, heightPath, emissivePath, origin, &(it->second) });
+    m_textures[0].emplace(texture, LegacyTexture { texturehash , paths.albedo, paths.normal, paths.roughness, paths.metallic, paths.height, paths.emissive, origin, &(it->second) });
 
   }
 
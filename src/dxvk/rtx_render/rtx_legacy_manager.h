@@ -5,6 +5,7 @@
 #include "rtx_texture.h"
 #include "d3d9.h"
 #include "rtx_option.h"
+#include "rtx_legacy_texture_lookup.h"
 #include "rtx/pass/particles/particle_system_common.h"
 
 namespace dxvk {
@@ -21,61 +22,6 @@ namespace dxvk {
 
   class RtxTextureManager;
 
-  enum class TextureOrigin {
-    None = 0,
-    Stage,
-    Emmodel,
-    Extend,
-    NPC,
-    Parts,
-    Effect,
-  };
-
-  enum class LegacyMaterialFeature : uint32_t {
-    None = 0,
-    Albedo = 1 << 0,
-    Normal = 1 << 1,
-    Roughness = 1 << 2,
-    Metallic = 1 << 3,
-    Height = 1 << 4,
-    Emissive = 1 << 5,
-    Sky = 1 << 7,
-    RejectDecal = 1 << 8,
-    BackFaceCulling = 1 << 9,
-    NoFade = 1 << 10,
-    Water = 1 << 11,
-    Particle = 1 << 12,
-    Decals = 1 << 13,
-    IgnoreOriginal = 1 << 14,
-    RainTexture = 1 << 15,
-    ParticleIgnoreLight = 1 << 16,
-    ParticleEmitter = 1 << 17,
-    Default = Albedo | Normal | Roughness | Metallic,
-    All = Albedo | Normal | Roughness | Metallic | Height,
-  };
-
-  constexpr LegacyMaterialFeature operator~(LegacyMaterialFeature a) {
-    return static_cast<LegacyMaterialFeature>(~static_cast<uint32_t>(a));
-  }
-  inline LegacyMaterialFeature& operator&=(LegacyMaterialFeature& a, LegacyMaterialFeature b) {
-    return reinterpret_cast<LegacyMaterialFeature&>(reinterpret_cast<uint32_t&>(a) &= static_cast<uint32_t>(b));
-  }
-  constexpr LegacyMaterialFeature operator&(LegacyMaterialFeature a, LegacyMaterialFeature b) {
-    return static_cast<LegacyMaterialFeature>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
-  }
-  inline LegacyMaterialFeature& operator|=(LegacyMaterialFeature& a, LegacyMaterialFeature b) {
-    return reinterpret_cast<LegacyMaterialFeature&>(reinterpret_cast<uint32_t&>(a) |= static_cast<uint32_t>(b));
-  }
-  constexpr LegacyMaterialFeature operator|(LegacyMaterialFeature a, LegacyMaterialFeature b) {
-    return static_cast<LegacyMaterialFeature>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
-  }
-  inline LegacyMaterialFeature& operator^=(LegacyMaterialFeature& a, LegacyMaterialFeature b) {
-    return reinterpret_cast<LegacyMaterialFeature&>(reinterpret_cast<uint32_t&>(a) ^= static_cast<uint32_t>(b));
-  }
-  constexpr LegacyMaterialFeature operator^(LegacyMaterialFeature a, LegacyMaterialFeature b) {
-    return static_cast<LegacyMaterialFeature>(static_cast<uint32_t>(a) ^ static_cast<uint32_t>(b));
-  }
-
   class LegacyManager;
 
   struct LegacyMaterialLayer {
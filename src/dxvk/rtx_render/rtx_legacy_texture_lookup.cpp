@@ -0,0 +1,114 @@
+#include "rtx_legacy_texture_lookup.h"
+
+#include <cstdio>
+
+namespace dxvk {
+
+  namespace {
+    void findMap(const std::filesystem::path& folder, const std::string& hash, const char* suffix, std::optional<std::string>& path) {
+      std::filesystem::path mapPath = folder / hash;
+      mapPath += suffix;
+
+      if (std::filesystem::exists(mapPath))
+        path = mapPath.string();
+    }
+  }
+
+  LegacyTexturePaths findLegacyTexturePaths(const std::filesystem::path& pbrDataPath, uint32_t textureHash) {
+    LegacyTexturePaths paths;
+
+    if (!std::filesystem::exists(pbrDataPath))
+      return paths;
+
+    char hashString[11];
+    std::snprintf(hashString, sizeof(hashString), "%x", textureHash);
+    const std::string hash = hashString;
+
+    for (const auto& entry : std::filesystem::directory_iterator(pbrDataPath))
+      findMap(entry, hash, ".a.rtex.dds", paths.albedo);
+
+    if (!paths.albedo.has_value())
+      return paths;
+
+    for (const auto& entry : std::filesystem::directory_iterator(pbrDataPath)) {
+      findMap(entry, hash, "_normal_dx_OTH_Normal.n.rtex.dds", paths.normal);
+      findMap(entry, hash, "_roughness.r.rtex.dds", paths.roughness);
+      findMap(entry, hash, "_metallic.m.rtex.dds", paths.metallic);
+      findMap(entry, hash, "_height.h.rtex.dds", paths.height);
+      findMap(entry, hash, "_emissive.e.rtex.dds", paths.emissive);
+    }
+
+    return paths;
+  }
+
+  TextureOrigin getLegacyTextureOrigin(const std::optional<std::string>& albedoPath) {
+    if (!albedoPath.has_value())
+      return TextureOrigin::None;
+
+    const std::string& path = albedoPath.value();
+
+    if (path.find("stage") != std::string::npos)
+      return TextureOrigin::Stage;
+    if (path.find("emmodel") != std::string::npos)
+      return TextureOrigin::Emmodel;
+    if (path.find("extend") != std::string::npos)
+      return TextureOrigin::Extend;
+    if (path.find("npc") != std::string::npos)
+      return TextureOrigin::NPC;
+    if (path.find("parts") != std::string::npos)
+      return TextureOrigin::Parts;
+    if (path.find("effect") != std::string::npos)
+      return TextureOrigin::Effect;
+
+    return TextureOrigin::None;
+  }
+
+  void applyLegacyOriginDefaults(TextureOrigin origin, LegacyMaterialFeature& features, float& normalStrength) {
+    if (origin == TextureOrigin::Extend || origin == TextureOrigin::Parts || origin == TextureOrigin::NPC) {
+      features |= LegacyMaterialFeature::NoFade;
+    }
+    if (origin == TextureOrigin::Extend || origin == TextureOrigin::Parts || origin == TextureOrigin::NPC || origin == TextureOrigin::Effect) {
+      features |= LegacyMaterialFeature::RejectDecal;
+    }
+    if (origin == TextureOrigin::Emmodel) {
+      normalStrength = -1.0f;
+      features &= ~LegacyMaterialFeature::BackFaceCulling;
+    }
+  }
+
+  void filterLegacyTexturePaths(LegacyMaterialFeature features, bool keepDisabled, LegacyTexturePaths& paths) {
+    auto test = [features](LegacyMaterialFeature feature) {
+      return (features & feature) != LegacyMaterialFeature::None;
+    };
+
+    if (test(LegacyMaterialFeature::Particle)) {
+      paths.albedo.reset();
+      paths.normal.reset();
+      paths.roughness.reset();
+      paths.metallic.reset();
+      paths.height.reset();
+    }
+
+    if (test(LegacyMaterialFeature::Sky)) {
+      paths.normal.reset();
+      paths.roughness.reset();
+      paths.metallic.reset();
+      paths.height.reset();
+    }
+
+    if (keepDisabled)
+      return;
+
+    if (!test(LegacyMaterialFeature::Albedo))
+      paths.albedo.reset();
+    if (!test(LegacyMaterialFeature::Normal))
+      paths.normal.reset();
+    if (!test(LegacyMaterialFeature::Roughness))
+      paths.roughness.reset();
+    if (!test(LegacyMaterialFeature::Metallic))
+      paths.metallic.reset();
+    if (!test(LegacyMaterialFeature::Height))
+      paths.height.reset();
+  }
+
+}
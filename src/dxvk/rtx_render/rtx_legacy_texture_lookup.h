@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace dxvk {
+
+  enum class TextureOrigin {
+    None = 0,
+    Stage,
+    Emmodel,
+    Extend,
+    NPC,
+    Parts,
+    Effect,
+  };
+
+  enum class LegacyMaterialFeature : uint32_t {
+    None = 0,
+    Albedo = 1 << 0,
+    Normal = 1 << 1,
+    Roughness = 1 << 2,
+    Metallic = 1 << 3,
+    Height = 1 << 4,
+    Emissive = 1 << 5,
+    Sky = 1 << 7,
+    RejectDecal = 1 << 8,
+    BackFaceCulling = 1 << 9,
+    NoFade = 1 << 10,
+    Water = 1 << 11,
+    Particle = 1 << 12,
+    Decals = 1 << 13,
+    IgnoreOriginal = 1 << 14,
+    RainTexture = 1 << 15,
+    ParticleIgnoreLight = 1 << 16,
+    ParticleEmitter = 1 << 17,
+    Default = Albedo | Normal | Roughness | Metallic,
+    All = Albedo | Normal | Roughness | Metallic | Height,
+  };
+
+  constexpr LegacyMaterialFeature operator~(LegacyMaterialFeature a) {
+    return static_cast<LegacyMaterialFeature>(~static_cast<uint32_t>(a));
+  }
+  inline LegacyMaterialFeature& operator&=(LegacyMaterialFeature& a, LegacyMaterialFeature b) {
+    return reinterpret_cast<LegacyMaterialFeature&>(reinterpret_cast<uint32_t&>(a) &= static_cast<uint32_t>(b));
+  }
+  constexpr LegacyMaterialFeature operator&(LegacyMaterialFeature a, LegacyMaterialFeature b) {
+    return static_cast<LegacyMaterialFeature>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+  }
+  inline LegacyMaterialFeature& operator|=(LegacyMaterialFeature& a, LegacyMaterialFeature b) {
+    return reinterpret_cast<LegacyMaterialFeature&>(reinterpret_cast<uint32_t&>(a) |= static_cast<uint32_t>(b));
+  }
+  constexpr LegacyMaterialFeature operator|(LegacyMaterialFeature a, LegacyMaterialFeature b) {
+    return static_cast<LegacyMaterialFeature>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+  }
+  inline LegacyMaterialFeature& operator^=(LegacyMaterialFeature& a, LegacyMaterialFeature b) {
+    return reinterpret_cast<LegacyMaterialFeature&>(reinterpret_cast<uint32_t&>(a) ^= static_cast<uint32_t>(b));
+  }
+  constexpr LegacyMaterialFeature operator^(LegacyMaterialFeature a, LegacyMaterialFeature b) {
+    return static_cast<LegacyMaterialFeature>(static_cast<uint32_t>(a) ^ static_cast<uint32_t>(b));
+  }
+
+  /**
+   * \brief PBR maps found for a legacy texture
+   */
+  struct LegacyTexturePaths {
+    std::optional<std::string> albedo;
+    std::optional<std::string> normal;
+    std::optional<std::string> roughness;
+    std::optional<std::string> metallic;
+    std::optional<std::string> height;
+    std::optional<std::string> emissive;
+  };
+
+  /**
+   * \brief Finds the PBR maps of a texture
+   *
+   * Maps are stored in the sub folders of PBRData, named after the
+   * texture hash in hex. The other maps are only looked up when a sub
+   * folder has the albedo map, they can be in any sub folder.
+   * \param [in] pbrDataPath Path of the PBRData folder
+   * \param [in] textureHash Hash of the texture
+   */
+  LegacyTexturePaths findLegacyTexturePaths(const std::filesystem::path& pbrDataPath, uint32_t textureHash);
+
+  /**
+   * \brief Categorizes a texture by the folder of its albedo map
+   */
+  TextureOrigin getLegacyTextureOrigin(const std::optional<std::string>& albedoPath);
+
+  /**
+   * \brief Applies the material defaults of a texture origin
+   *
+   * \param [in] origin Origin of the texture
+   * \param [in,out] features Material features
+   * \param [in,out] normalStrength Normal map strength
+   */
+  void applyLegacyOriginDefaults(TextureOrigin origin, LegacyMaterialFeature& features, float& normalStrength);
+
+  /**
+   * \brief Drops the maps a material doesn't use
+   *
+   * \param [in] features Material features
+   * \param [in] keepDisabled Keep the maps of disabled features, so that
+   *    they can be enabled in the developer menu
+   * \param [in,out] paths Maps of the texture
+   */
+  void filterLegacyTexturePaths(LegacyMaterialFeature features, bool keepDisabled, LegacyTexturePaths& paths);
+
+}
@@ -185,27 +185,16 @@ namespace dxvk {
         continue;
       }
 
-      float currentSimilarity = -1.f;
       // Note: Using an iterator for the found similar light is safe here because the m_lights map will not change between where
       // it is found and where it is accessed.
-      std::optional<decltype(m_lights)::iterator> similarLight;
-      for (auto similarLightIterator = m_lights.begin(); similarLightIterator != m_lights.end(); ++similarLightIterator) {
-        const RtLight& newLight = similarLightIterator->second;
-        // Skip comparing to old lights, this check implicitly avoids comparing the exact same light.
-        if (newLight.getBufferIdx() != kNewLightIdx || newLight.isChildOfMesh())
-          continue;
-
-        const float similarity = isSimilar(light, newLight, RtxOptions::uniqueObjectDistance());
-        // Update the cached light if it's similar.
-        if (similarity > currentSimilarity) {
-          similarLight = similarLightIterator;
-          currentSimilarity = similarity;
-        }
-      }
+      // Skip comparing to old lights, this check implicitly avoids comparing the exact same light.
+      const auto similarLight = findMostSimilarLight(m_lights.begin(), m_lights.end(), getMatchKey(light), RtxOptions::uniqueObjectDistance(),
+        [](const auto& pair) { return getMatchKey(pair.second); },
+        [](const auto& pair) { return pair.second.getBufferIdx() == kNewLightIdx && !pair.second.isChildOfMesh(); });
 
-      if (currentSimilarity >= 0 && similarLight.has_value()) {
+      if (similarLight != m_lights.end()) {
         // This is a dynamic light!
-        RtLight& dynamicLight = (*similarLight)->second;
+        RtLight& dynamicLight = similarLight->second;
         dynamicLight.isDynamic = true;
 
         // This is the same light, so update our new light
@@ -223,9 +212,6 @@ namespace dxvk {
   void LightManager::prepareSceneData(Rc<DxvkContext> ctx, CameraManager const& cameraManager, AreaManager& areaManager) {
   // MHFZ end
     ScopedCpuProfileZone();
-    // MHFZ start 
-    AreaData& area = areaManager.getCurrentAreaData();
-    // MHFZ end
     // Note: Early outing in this function (via returns) should be done carefully (or not at all ideally) as it may skip important
     // logic such as swapping the current/previous frame light buffer, updating light count information or allocating/updating the
     // light buffer which may cause issues in some cases (or rather already has, which is why this warning exists).
@@ -338,6 +324,9 @@ namespace dxvk {
     }
 
     // MHFZ start : use area data
+    auto areaLock = areaManager.lockCurrentArea();
+    AreaData& area = areaManager.getCurrentAreaData();
+
     if (area.lightDirty) {
       area.lightDirty = false;
       m_areaLight.clear();
@@ -373,6 +362,8 @@ namespace dxvk {
 
     }
 
+    areaLock.unlock();
+
     for (RtLight& lightData : m_areaLight) {
       m_linearizedLights.emplace_back(&lightData);
     }
@@ -519,52 +510,33 @@ namespace dxvk {
     m_externalActiveLightList.clear();
   }
 
-  static const float kNotSimilar = -1.f;
-  float LightManager::isSimilar(const RtLight& a, const RtLight& b, float distanceThreshold) {
-    static const float kCosAngleSimilarityThreshold = cos(5.f * kPi / 180.f);
-
-    // Basic similarity check.
-    const bool sameType = a.getType() == b.getType();
-
-    if (!sameType)
-      return kNotSimilar;
+  namespace {
+    LightMatchVector toMatchVector(const Vector3& v) {
+      return LightMatchVector { v.x, v.y, v.z };
+    }
+  }
 
-    if (a.getType() == RtLightType::Distant) {
-      // Distant lights should be compared against their direction
-      const float cosAngle = dot(a.getDirection(), b.getDirection());
-      const bool similarDirection = cosAngle >= kCosAngleSimilarityThreshold;
+  RtLightMatchKey LightManager::getMatchKey(const RtLight& light) {
+    RtLightMatchKey key;
+    key.type = static_cast<uint32_t>(light.getType());
 
-      return similarDirection ? cosAngle : kNotSimilar;
-    } else {
-      // This is just an epsilon, at which distance should we collapse similar lights into a single light.
-      const float distNormalized = length(a.getPosition() - b.getPosition()) / distanceThreshold;
-      const bool similarPosition = distNormalized <= 1.f;
-
-      if (a.getType() == RtLightType::Sphere) {
-        const RtLightShaping& aShaping = a.getSphereLight().getShaping();
-        const RtLightShaping& bShaping = b.getSphereLight().getShaping();
-        if (aShaping.getEnabled() != bShaping.getEnabled()) {
-          return kNotSimilar;
-        }
+    if (light.getType() == RtLightType::Distant) {
+      key.distant = true;
+      key.direction = toMatchVector(light.getDirection());
+      return key;
+    }
 
-        if (aShaping.getEnabled() && bShaping.getEnabled()) {
-          const float cosAxis = dot(aShaping.getDirection(), bShaping.getDirection());
-          if (cosAxis < kCosAngleSimilarityThreshold) {
-            return kNotSimilar;
-          }
-          const float coneAngleDelta = std::abs(aShaping.getCosConeAngle() - bShaping.getCosConeAngle());
-          if (coneAngleDelta > 0.01f) {
-            return kNotSimilar;
-          }
-          float coneSoftnessDelta = std::abs(aShaping.getConeSoftness() - bShaping.getConeSoftness());
-          if (coneSoftnessDelta > 0.01f) {
-            return kNotSimilar;
-          }
-        }
-      }
+    key.position = toMatchVector(light.getPosition());
 
-      return similarPosition ? (1.f - distNormalized) : kNotSimilar;
+    if (light.getType() == RtLightType::Sphere) {
+      const RtLightShaping& shaping = light.getSphereLight().getShaping();
+      key.shapingEnabled = shaping.getEnabled();
+      key.shapingDirection = toMatchVector(shaping.getDirection());
+      key.cosConeAngle = shaping.getCosConeAngle();
+      key.coneSoftness = shaping.getConeSoftness();
     }
+
+    return key;
   }
 
   void LightManager::updateLight(const RtLight& in, RtLight& out) {
@@ -668,21 +640,17 @@ namespace dxvk {
 
     } else {
       //  Try find a similar light
+      // Update the cached light if it's similar.  This should catch minor perturbations in static lights (e.g. due to precision loss)
+      const float kDistanceThresholdMeters = 0.02f;
+      const float kDistanceThresholdWorldUnits = kDistanceThresholdMeters * RtxOptions::Get()->getMeterToWorldUnitScale();
+      const auto similarLightIt = findMostSimilarLight(m_lights.cbegin(), m_lights.cend(), getMatchKey(rtLight), kDistanceThresholdWorldUnits,
+        [](const auto& pair) { return getMatchKey(pair.second); },
+        [](const auto&) { return true; });
+
+      // Copy off light state.
       std::optional<RtLight> similarLight;
-      float bestSimilarity = kNotSimilar;
-      for (auto&& pair : m_lights) {
-        const RtLight& light = pair.second;
-
-        // Update the cached light if it's similar.  This should catch minor perturbations in static lights (e.g. due to precision loss)
-        const float kDistanceThresholdMeters = 0.02f;
-        const float kDistanceThresholdWorldUnits = kDistanceThresholdMeters * RtxOptions::Get()->getMeterToWorldUnitScale();
-        const float thisLightsSimilarity = isSimilar(light, rtLight, kDistanceThresholdWorldUnits);
-
-        if (thisLightsSimilarity >= 0.f && thisLightsSimilarity > bestSimilarity) {
-          // Copy off light state.
-          similarLight = light;
-          bestSimilarity = thisLightsSimilarity;
-        } 
+      if (similarLightIt != m_lights.cend()) {
+        similarLight = similarLightIt->second;
       }
 
       if (similarLight.has_value()) {
@@ -29,6 +29,7 @@
 #include "rtx/utility/shader_types.h"
 #include "rtx/concept/light/light_types.h"
 #include "rtx_lights.h"
+#include "rtx_light_matching.h"
 #include "rtx_camera_manager.h"
 #include "rtx_common_object.h"
 #include "rtx/pass/common_binding_indices.h"
@@ -137,10 +138,8 @@ private:
 
   void garbageCollectionInternal();
 
-  // Similarity check.
-  //  Returns -1 if not similar
-  //  Returns 0~1 if similar, higher is more similar
-  static float isSimilar(const RtLight& a, const RtLight& b, float distanceThreshold);
+  // Properties the similarity check compares, see getLightSimilarity()
+  static RtLightMatchKey getMatchKey(const RtLight& light);
   static void updateLight(const RtLight& in, RtLight& out);
 
   RTX_OPTION("rtx", bool, suppressLightKeeping, false, 
@@ -0,0 +1,123 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// Only depends on the standard library so that the matching builds on any host, see tests/rtx/headless
+namespace dxvk {
+  // Vector3 lives in util_vector.h, which pulls in the Win32 logging, so the keys use a plain vector
+  struct LightMatchVector {
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+  };
+
+  inline float dot(const LightMatchVector& a, const LightMatchVector& b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+  }
+
+  inline float distance(const LightMatchVector& a, const LightMatchVector& b) {
+    const LightMatchVector d { a.x - b.x, a.y - b.y, a.z - b.z };
+    return std::sqrt(dot(d, d));
+  }
+
+  // Properties used to recognize a light across frames, kept separate from RtLight so that the
+  // matching can run (and be tested) without the GPU light representation.
+  struct RtLightMatchKey {
+    // Lights of different types never match
+    uint32_t type = 0;
+    // Distant lights are matched by direction, all other lights by position
+    bool distant = false;
+    LightMatchVector position;
+    LightMatchVector direction;
+
+    // Sphere light shaping, lights with and without shaping never match
+    bool shapingEnabled = false;
+    LightMatchVector shapingDirection;
+    float cosConeAngle = 0.0f;
+    float coneSoftness = 0.0f;
+  };
+
+  static constexpr float kLightNotSimilar = -1.f;
+
+  // Returns how similar two lights are in [0, 1], or kLightNotSimilar. Positional lights are similar
+  // when they are at most distanceThreshold apart, distant lights when their directions are within 5 degrees.
+  inline float getLightSimilarity(const RtLightMatchKey& a, const RtLightMatchKey& b, float distanceThreshold) {
+    static const float kCosAngleSimilarityThreshold = std::cos(5.f * 3.141592653589793f / 180.f);
+
+    if (a.type != b.type || a.distant != b.distant) {
+      return kLightNotSimilar;
+    }
+
+    if (a.distant) {
+      const float cosAngle = dot(a.direction, b.direction);
+      return cosAngle >= kCosAngleSimilarityThreshold ? cosAngle : kLightNotSimilar;
+    }
+
+    if (a.shapingEnabled != b.shapingEnabled) {
+      return kLightNotSimilar;
+    }
+
+    if (a.shapingEnabled) {
+      if (dot(a.shapingDirection, b.shapingDirection) < kCosAngleSimilarityThreshold ||
+          std::abs(a.cosConeAngle - b.cosConeAngle) > 0.01f ||
+          std::abs(a.coneSoftness - b.coneSoftness) > 0.01f) {
+        return kLightNotSimilar;
+      }
+    }
+
+    // This is just an epsilon, at which distance should we collapse similar lights into a single light.
+    const float distNormalized = distance(a.position, b.position) / distanceThreshold;
+    return distNormalized <= 1.f ? (1.f - distNormalized) : kLightNotSimilar;
+  }
+
+  // Finds the candidate most similar to a light, the first one on ties. getKey returns the
+  // RtLightMatchKey of a candidate, candidates rejected by filter are skipped.
+  // Returns end if no candidate is similar.
+  template<typename Iterator, typename GetKey, typename Filter>
+  Iterator findMostSimilarLight(Iterator begin, Iterator end, const RtLightMatchKey& light, float distanceThreshold,
+                                const GetKey& getKey, const Filter& filter, float* pSimilarity = nullptr) {
+    Iterator result = end;
+    float bestSimilarity = kLightNotSimilar;
+
+    for (Iterator it = begin; it != end; ++it) {
+      if (!filter(*it)) {
+        continue;
+      }
+
+      const float similarity = getLightSimilarity(getKey(*it), light, distanceThreshold);
+
+      if (similarity >= 0.f && similarity > bestSimilarity) {
+        result = it;
+        bestSimilarity = similarity;
+      }
+    }
+
+    if (pSimilarity != nullptr) {
+      *pSimilarity = bestSimilarity;
+    }
+
+    return result;
+  }
+}
@@ -1710,6 +1710,28 @@ struct MaterialData {
     }
   }
 
+  MaterialData(MaterialData&& materialData) :
+    m_ignored { materialData.m_ignored }, m_type { materialData.m_type } {
+    switch (m_type) {
+    default:
+      assert(false);
+
+      [[fallthrough]];
+    case MaterialDataType::Legacy:
+      new (&m_legacyMaterialData) LegacyMaterialData{ std::move(materialData.m_legacyMaterialData) };
+      break;
+    case MaterialDataType::Opaque:
+      new (&m_opaqueMaterialData) OpaqueMaterialData{ std::move(materialData.m_opaqueMaterialData) };
+      break;
+    case MaterialDataType::Translucent:
+      new (&m_translucentMaterialData) TranslucentMaterialData{ std::move(materialData.m_translucentMaterialData) };
+      break;
+    case MaterialDataType::RayPortal:
+      new (&m_rayPortalMaterialData) RayPortalMaterialData{ std::move(materialData.m_rayPortalMaterialData) };
+      break;
+    }
+  }
+
   ~MaterialData() {
     switch (m_type) {
     default:
@@ -1758,6 +1780,16 @@ struct MaterialData {
     return *this;
   }
 
+  // Rebuilds the object as the type may change, e.g. when a hot reload overwrites a material in place
+  MaterialData& operator=(MaterialData&& materialData) {
+    if (this != &materialData) {
+      this->~MaterialData();
+      new (this) MaterialData { std::move(materialData) };
+    }
+
+    return *this;
+  }
+
   const bool getIgnored() const {
     return m_ignored;
   }
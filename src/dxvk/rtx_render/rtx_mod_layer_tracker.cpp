@@ -0,0 +1,189 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_mod_layer_tracker.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace dxvk {
+
+  ModLayerTracker::FileState ModLayerTracker::readFileState(const std::string& path, const FileState* recorded) {
+    FileState state;
+    std::error_code ec;
+    state.modificationTime = fs::last_write_time(fs::path(path), ec);
+    state.exists = !ec;
+    if (!state.exists) {
+      return state;
+    }
+
+    // Only hash the contents when the file was touched since it was last recorded
+    if (recorded && recorded->exists && recorded->modificationTime == state.modificationTime) {
+      state.contentHash = recorded->contentHash;
+      return state;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      state.exists = false;
+      return state;
+    }
+
+    XXH3_state_t* hashState = XXH3_createState();
+    XXH3_64bits_reset(hashState);
+
+    char buffer[64 * 1024];
+    while (file) {
+      file.read(buffer, sizeof(buffer));
+      XXH3_64bits_update(hashState, buffer, static_cast<size_t>(file.gcount()));
+    }
+
+    state.contentHash = XXH3_64bits_digest(hashState);
+    XXH3_freeState(hashState);
+    return state;
+  }
+
+  bool ModLayerTracker::refreshFileState(const std::string& path, FileState& state) {
+    const FileState current = readFileState(path, &state);
+    const bool changed = current.exists != state.exists || current.contentHash != state.contentHash;
+    state = current;
+    return changed;
+  }
+
+  std::vector<std::string> ModLayerTracker::setLayers(const std::vector<std::string>& layerPaths) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<std::string> addedOrRemoved;
+    std::unordered_map<std::string, FileState> files;
+    for (const std::string& path : layerPaths) {
+      auto iter = m_files.find(path);
+      if (iter != m_files.end()) {
+        files.emplace(path, iter->second);
+        m_files.erase(iter);
+      } else if (files.find(path) == files.end()) {
+        files.emplace(path, readFileState(path, nullptr));
+        addedOrRemoved.push_back(path);
+      }
+    }
+
+    for (const auto& [path, state] : m_files) {
+      addedOrRemoved.push_back(path);
+    }
+
+    m_files = std::move(files);
+    return addedOrRemoved;
+  }
+
+  bool ModLayerTracker::hasChanges() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto& [path, recorded] : m_files) {
+      // Check for changed contents without recording them, collectChanges reports them later
+      FileState state = recorded;
+      if (refreshFileState(path, state)) {
+        return true;
+      }
+      // Touched but unchanged files keep the new timestamp so they aren't hashed again
+      recorded = state;
+    }
+    return false;
+  }
+
+  std::vector<std::string> ModLayerTracker::collectChanges() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    std::vector<std::string> changed;
+    for (auto& [path, recorded] : m_files) {
+      if (refreshFileState(path, recorded)) {
+        changed.push_back(path);
+      }
+    }
+    return changed;
+  }
+
+  void ModLayerTracker::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.clear();
+  }
+
+  uint32_t ModLayerDependencies::getLayerId(const std::string& path) {
+    return m_layerIds.try_emplace(path, static_cast<uint32_t>(m_layerIds.size())).first->second;
+  }
+
+  void ModLayerDependencies::beginUpdate(const std::vector<std::string>& changedLayers) {
+    m_changedLayers.clear();
+    for (const std::string& path : changedLayers) {
+      m_changedLayers.insert(getLayerId(path));
+    }
+  }
+
+  bool ModLayerDependencies::updateRoot(XXH64_hash_t root, const std::vector<std::string>& layerPaths) {
+    auto [iter, isNew] = m_roots.try_emplace(root);
+    RootState& state = iter->second;
+
+    bool dirty = isNew;
+    if (!state.updated) {
+      state.updated = true;
+      state.pendingLayers.clear();
+      for (uint32_t layer : state.layers) {
+        dirty |= m_changedLayers.count(layer) > 0;
+      }
+    }
+
+    for (const std::string& path : layerPaths) {
+      const uint32_t layer = getLayerId(path);
+      dirty |= m_changedLayers.count(layer) > 0;
+      if (std::find(state.pendingLayers.begin(), state.pendingLayers.end(), layer) == state.pendingLayers.end()) {
+        state.pendingLayers.push_back(layer);
+      }
+    }
+
+    return dirty;
+  }
+
+  std::vector<XXH64_hash_t> ModLayerDependencies::endUpdate() {
+    std::vector<XXH64_hash_t> removed;
+    for (auto iter = m_roots.begin(); iter != m_roots.end(); ) {
+      RootState& state = iter->second;
+      if (!state.updated) {
+        removed.push_back(iter->first);
+        iter = m_roots.erase(iter);
+        continue;
+      }
+      state.layers = std::move(state.pendingLayers);
+      state.pendingLayers.clear();
+      state.updated = false;
+      ++iter;
+    }
+
+    m_changedLayers.clear();
+    return removed;
+  }
+
+  void ModLayerDependencies::clear() {
+    m_layerIds.clear();
+    m_changedLayers.clear();
+    m_roots.clear();
+  }
+
+}
@@ -0,0 +1,117 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "../../util/xxHash/xxhash.h"
+
+namespace dxvk {
+
+  /*
+  *  Mod Layer Tracker
+  *
+  *  Tracks the state of the layer files a mod is composed of.  Files are compared by modification
+  *  time first and then by a hash of their contents, so saving a file without changing it does not
+  *  count as a change.  The file state is guarded by a mutex, as changes are polled on a watchdog thread.
+  */
+  class ModLayerTracker {
+  public:
+    // Replaces the set of tracked layer files, recording the state of files not tracked before.
+    // Returns the files added to or removed from the set.
+    std::vector<std::string> setLayers(const std::vector<std::string>& layerPaths);
+
+    // Returns true if any tracked file changed since its state was last recorded
+    bool hasChanges();
+
+    // Returns the tracked files that changed since their state was last recorded, and records their current state
+    std::vector<std::string> collectChanges();
+
+    void clear();
+
+    size_t getLayerCount() {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_files.size();
+    }
+
+  private:
+    struct FileState {
+      std::filesystem::file_time_type modificationTime {};
+      XXH64_hash_t contentHash = 0;
+      bool exists = false;
+    };
+
+    static FileState readFileState(const std::string& path, const FileState* recorded);
+
+    // Returns true and updates the recorded state if the file contents changed
+    static bool refreshFileState(const std::string& path, FileState& state);
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, FileState> m_files;
+  };
+
+  /*
+  *  Mod Layer Dependencies
+  *
+  *  Records which layers each replacement root was composed from, so that a hot reload only has to
+  *  re-process the roots touched by an edit.  A root needs to be re-processed when a layer it was
+  *  composed from, or is now composed from, has changed.
+  */
+  class ModLayerDependencies {
+  public:
+    // Starts a pass over all roots, the given layers are treated as changed
+    void beginUpdate(const std::vector<std::string>& changedLayers);
+
+    // Records layers the root is composed of, may be called several times per root during a pass.
+    // Returns true if the root is new, or was or is now composed from a changed layer.
+    bool updateRoot(XXH64_hash_t root, const std::vector<std::string>& layerPaths);
+
+    // Ends the pass, returns the roots which were not updated during it.  Those are no longer tracked.
+    std::vector<XXH64_hash_t> endUpdate();
+
+    void clear();
+
+    size_t getRootCount() const {
+      return m_roots.size();
+    }
+
+  private:
+    struct RootState {
+      std::vector<uint32_t> layers;
+      std::vector<uint32_t> pendingLayers;
+      bool updated = false;
+    };
+
+    uint32_t getLayerId(const std::string& path);
+
+    std::unordered_map<std::string, uint32_t> m_layerIds;
+    std::unordered_set<uint32_t> m_changedLayers;
+    std::unordered_map<XXH64_hash_t, RootState> m_roots;
+  };
+
+}
@@ -31,6 +31,7 @@
 #include "rtx_utils.h"
 #include "rtx_asset_data_manager.h"
 #include "rtx_texture_manager.h"
+#include "rtx_mod_usd_reload.h"
 
 #include "../../lssusd/usd_include_begin.h"
 #include <pxr/base/gf/matrix4f.h>
@@ -40,6 +41,7 @@
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usd/prim.h>
 #include <pxr/usd/usd/primCompositionQuery.h>
+#include <pxr/usd/usd/primRange.h>
 #include <pxr/usd/usd/attribute.h>
 #include <pxr/usd/usdGeom/mesh.h>
 #include <pxr/usd/usdGeom/pointInstancer.h>
@@ -66,6 +68,7 @@
 #include "rtx_lights_data.h"
 #include <filesystem>
 #include <algorithm>
+#include <tuple>
 
 namespace fs = std::filesystem;
 
@@ -98,6 +101,23 @@ private:
   bool haveFilesChanged();
 
   void processUSD(const Rc<DxvkContext>& context);
+  bool processChangedLayers(const Rc<DxvkContext>& context, const std::vector<std::string>& changedLayers);
+
+  void updateStatus(const pxr::UsdStageRefPtr& stage);
+
+  // Returns true if the object for this hash has been processed, and wasn't invalidated by a hot reload since
+  template<typename T>
+  bool getProcessedObject(XXH64_hash_t hash, T*& obj) {
+    return m_owner.m_replacements->getObject(hash, obj) && !m_reload.isStale(hash);
+  }
+
+  template<typename T>
+  T& storeProcessedObject(XXH64_hash_t hash, T&& obj) {
+    if (m_reload.clearStale(hash)) {
+      return m_owner.m_replacements->replaceObject(hash, std::move(obj));
+    }
+    return m_owner.m_replacements->storeObject(hash, std::move(obj));
+  }
 
   void TEMP_parseSecretReplacementVariants(const fast_unordered_cache<uint32_t>& variants);
   Rc<ManagedTexture> getTexture(const Args& args, const pxr::UsdPrim& shader, const pxr::TfToken& textureToken, bool forcePreload = false) const;
@@ -120,9 +140,11 @@ private:
     return XXH64(&id, sizeof(id), kEmptyHash);
   }
 
-  std::filesystem::file_time_type m_fileModificationTime;
   std::string m_openedFilePath;
 
+  // Kept open so that a hot reload only has to reload the changed layers
+  UsdModReload m_reload;
+
   Watchdog<1000> m_usdChangeWatchdog;
 
   void addReplacementsSync(dxvk::Rc<dxvk::DxvkCommandList> cmdList, XXH64_hash_t hash, std::vector<AssetReplacement>& replacementVec);
@@ -133,90 +155,6 @@ private:
 
 // context and member variable arguments to pass down to anonymous functions (to avoid having USD in the header)
 
-namespace {
-// Find the first prim in the layer stack that has a non-xform or material binding attribute
-// return the hash of the filename and prim path.
-XXH64_hash_t getStrongestOpinionatedPathHash(const pxr::UsdPrim& prim) {
-  static const char* kXformPrefix = "xform";
-  static const size_t kXformLen = strlen(kXformPrefix);
-  static const pxr::TfToken kMaterialBinding("material:binding");
-  auto stack = prim.GetPrimStack();
-  for (auto spec : stack) {
-    for (auto property : spec->GetProperties()) {
-      if (property->GetName().compare(0, kXformLen, kXformPrefix) == 0) {
-        // xform property
-        continue;
-      } else if (property->GetNameToken() == kMaterialBinding) {
-        //material binding
-        continue;
-      }
-      // This is the primSpec to use
-      std::string originOfMeshFile = spec->GetLayer()->GetRealPath();
-      std::string originPath = spec->GetPath().GetString();
-
-      XXH64_hash_t usdOriginHash = 0;
-      usdOriginHash = StringToXXH64(originOfMeshFile, usdOriginHash);
-      usdOriginHash = StringToXXH64(originPath, usdOriginHash);
-
-      return usdOriginHash;
-    }
-  }
-  Logger::err(str::format("Asset Replacement failed to find a source prim for ", prim.GetPath().GetString()));
-  // fall back to using the prim's path in replacements.usda.  Potentially worse performance, since it may lead to duplicates.
-  std::string name = prim.GetPath().GetString();
-  return XXH3_64bits(name.c_str(), name.size());
-}
-
-XXH64_hash_t getNamedHash(const std::string& name, const char* prefix, const size_t len) {
-  if (name.compare(0, len, prefix) == 0) {
-    // is a mesh replacement.
-    return std::strtoull(name.c_str()+len, nullptr, 16);
-  } else {
-    // Not a mesh replacements
-    return 0;
-  }
-}
-
-XXH64_hash_t getModelHash(const pxr::UsdPrim& prim) {
-  static const char* prefix = lss::prefix::mesh.c_str();
-  static const size_t len = strlen(prefix);
-  return getNamedHash(prim.GetName().GetString(), prefix, len);
-}
-
-XXH64_hash_t getLightHash(const pxr::UsdPrim& prim) {
-  static const char* prefix = lss::prefix::light.c_str();
-  static const size_t len = strlen(prefix);
-  if (prim.GetName().GetText()[0] == 's') {
-    // Handling for legacy `sphereLight_HASH` names.  TODO Remove once assets are updated
-    static const char* legacyPrefix = "sphereLight_";
-    static const size_t legacyLen = strlen(legacyPrefix);
-    return getNamedHash(prim.GetName().GetString(), legacyPrefix, legacyLen);
-  }
-  return getNamedHash(prim.GetName().GetString(), prefix, len);
-}
-
-XXH64_hash_t getMaterialHash(const pxr::UsdPrim& prim, const pxr::UsdPrim& shader) {
-  static const pxr::TfToken kMaterialType("Material");
-  static const char* prefix = lss::prefix::mat.c_str();
-  static const size_t len = strlen(prefix);
-  std::string name = prim.GetName().GetString();
-  XXH64_hash_t nameHash = getNamedHash(name, prefix, len);
-  if (nameHash != 0) {
-    return nameHash;
-  }
-  if (prim.GetTypeName() != kMaterialType) {
-    return 0;
-  }
-
-  if (!shader.IsValid()) {
-    return 0;
-  }
-  
-  XXH64_hash_t usdOriginHash = getStrongestOpinionatedPathHash(shader);
-
-  return usdOriginHash;
-}
-}  // namespace
 
 // Resolves full path for a texture in a shader from texture USD asset path and source USD path.
 // This method is used when real path to a texture asset was not resolved by USD, e.g. the asset
@@ -302,21 +240,11 @@ Rc<ManagedTexture> UsdMod::Impl::getTexture(const Args& args, const pxr::UsdPrim
 MaterialData* UsdMod::Impl::processMaterial(Args& args, const pxr::UsdPrim& matPrim) {
   ScopedCpuProfileZone();
 
-  static const pxr::TfToken kShaderToken("Shader");
   static const pxr::TfToken kIgnore("inputs:ignore_material");  // Any draw call or replacement using a material with this flag will be skipped by the SceneManager
   static const pxr::TfToken kPreloadTextures("inputs:preload_textures");  // Force textures to be loaded at highest mip
   static const pxr::TfToken kLegacyRayPortalIndexToken("rayPortalIndex");
 
-  pxr::UsdPrim shader = matPrim.GetChild(kShaderToken);
-  if (!shader.IsValid() || !shader.IsA<pxr::UsdShadeShader>()) {
-    auto children = matPrim.GetFilteredChildren(pxr::UsdPrimIsActive);
-    for (auto child : children) {
-      if (child.IsA<pxr::UsdShadeShader>()) {
-        shader = child;
-      }
-    }
-  }
-
+  pxr::UsdPrim shader = findShader(matPrim);
   if (!shader.IsValid()) {
     return nullptr;
   }
@@ -328,7 +256,7 @@ MaterialData* UsdMod::Impl::processMaterial(Args& args, const pxr::UsdPrim& matP
 
   // Check if the material has already been processed
   MaterialData* materialData;
-  if (m_owner.m_replacements->getObject(materialHash, materialData)) {
+  if (getProcessedObject(materialHash, materialData)) {
     return materialData;
   }
 
@@ -369,11 +297,11 @@ MaterialData* UsdMod::Impl::processMaterial(Args& args, const pxr::UsdPrim& matP
 
   switch (materialType) {
   case RtSurfaceMaterialType::Opaque:
-    return &m_owner.m_replacements->storeObject(materialHash, MaterialData(OpaqueMaterialData::deserialize(getTextureFunctor, shader), shouldIgnore));
+    return &storeProcessedObject(materialHash, MaterialData(OpaqueMaterialData::deserialize(getTextureFunctor, shader), shouldIgnore));
   case RtSurfaceMaterialType::Translucent:
-    return &m_owner.m_replacements->storeObject(materialHash, MaterialData(TranslucentMaterialData::deserialize(getTextureFunctor, shader), shouldIgnore));
+    return &storeProcessedObject(materialHash, MaterialData(TranslucentMaterialData::deserialize(getTextureFunctor, shader), shouldIgnore));
   case RtSurfaceMaterialType::RayPortal:
-    return &m_owner.m_replacements->storeObject(materialHash, MaterialData(RayPortalMaterialData::deserialize(getTextureFunctor, shader)));
+    return &storeProcessedObject(materialHash, MaterialData(RayPortalMaterialData::deserialize(getTextureFunctor, shader)));
   }
 
   return nullptr;
@@ -395,7 +323,7 @@ void UsdMod::Impl::processPrim(Args& args, const pxr::UsdPrim& prim) {
 
 
   MeshReplacement* pTemp;
-  if (!m_owner.m_replacements->getObject(usdOriginHash, pTemp)) {
+  if (!getProcessedObject(usdOriginHash, pTemp)) {
     // First time seeing this mesh, then process it.
     if (!processMesh(prim, args)) {
       return;
@@ -740,6 +668,8 @@ void UsdMod::Impl::unload() {
     m_owner.m_replacements->clear();
     AssetDataManager::get().clearSearchPaths();
 
+    m_reload.clear();
+
     m_owner.setState(ProgressState::Unloaded);
   }
 }
@@ -748,31 +678,146 @@ bool UsdMod::Impl::haveFilesChanged() {
   if (m_openedFilePath.empty())
     return false;
 
-  fs::file_time_type newModTime;
-  if (m_owner.state().progressState == ProgressState::Loaded) {
-    newModTime = fs::last_write_time(fs::path(m_openedFilePath));
-  } else {
-    bool fileFound = false;
+  if (m_owner.state().progressState != ProgressState::Loaded) {
     const auto replacementsUsdPath = fs::path(m_openedFilePath);
-    fileFound = fs::exists(replacementsUsdPath);
-    if (fs::exists(replacementsUsdPath)) {
-      newModTime = fs::last_write_time(replacementsUsdPath);
-    } else {
+    if (!fs::exists(replacementsUsdPath)) {
       m_owner.setState(ProgressState::Unloaded);
       return false;
     }
   }
-  return (newModTime > m_fileModificationTime);
+
+  // Covers the sublayers and referenced files as well as the mod file itself
+  return m_reload.getLayerTracker().hasChanges();
 }
 
 bool UsdMod::Impl::checkForChanges(const Rc<DxvkContext>& context) {
-  if (m_usdChangeWatchdog.hasSignaled()) {
-    unload();
-    load(context);
-    return true;
+  if (!m_usdChangeWatchdog.hasSignaled()) {
+    return false;
   }
 
-  return false;
+  if (m_reload.getStage() && m_owner.state().progressState == ProgressState::Loaded) {
+    const std::vector<std::string> changedLayers = m_reload.getLayerTracker().collectChanges();
+    if (changedLayers.empty()) {
+      return false;
+    }
+
+    if (processChangedLayers(context, changedLayers)) {
+      return true;
+    }
+  }
+
+  unload();
+  load(context);
+  return true;
+}
+
+void UsdMod::Impl::updateStatus(const pxr::UsdStageRefPtr& stage) {
+  pxr::VtDictionary layerData = stage->GetRootLayer()->GetCustomLayerData();
+  if (layerData.empty()) {
+    m_owner.m_status = "Layer Data Missing";
+  } else {
+    const PXR_NS::VtValue* vtExportStatus = layerData.GetValueAtPath(kStatusKey);
+    if (vtExportStatus && !vtExportStatus->IsEmpty()) {
+      m_owner.m_status = vtExportStatus->Get<std::string>();
+    } else {
+      m_owner.m_status = "Status Missing";
+    }
+  }
+}
+
+bool UsdMod::Impl::processChangedLayers(const Rc<DxvkContext>& context, const std::vector<std::string>& changedLayers) {
+  ScopedCpuProfileZone();
+
+  UsdModReload::RootList roots;
+  if (!m_reload.reloadLayers(changedLayers, roots)) {
+    return false;
+  }
+
+  updateStatus(m_reload.getStage());
+
+  pxr::UsdGeomXformCache xformCache;
+  uint32_t numProcessed = 0;
+
+  auto& [dirtyMaterials, dirtyMaterialHashes, removedMaterials] = roots[UsdModReload::Materials];
+  auto& [dirtyMeshes, dirtyMeshHashes, removedMeshes] = roots[UsdModReload::Meshes];
+  auto& [dirtyLights, dirtyLightHashes, removedLights] = roots[UsdModReload::Lights];
+
+  // Materials are overwritten in place, so replacements bound to them don't need to be processed again.
+  // Removed materials are kept, as replacements outside of the changed layers may still point to them.
+  for (auto& [materialPrim, hash] : dirtyMaterials) {
+    std::vector<AssetReplacement> placeholder;
+    Args args = { context, xformCache, materialPrim, placeholder };
+    processMaterial(args, materialPrim);
+    ++numProcessed;
+  }
+
+  fast_unordered_cache<std::vector<AssetReplacement>> meshUpdates;
+  for (auto& [meshPrim, hash] : dirtyMeshes) {
+    std::vector<AssetReplacement> replacementVec;
+    Args args = { context, xformCache, meshPrim, replacementVec };
+    // Matches the full load, where the first root with a hash wins
+    if (processReplacement(args)) {
+      meshUpdates.emplace(hash, std::move(replacementVec));
+    }
+    ++numProcessed;
+  }
+
+  fast_unordered_cache<std::vector<AssetReplacement>> lightUpdates;
+  for (auto& [lightPrim, hash] : dirtyLights) {
+    std::vector<AssetReplacement> replacementVec;
+    Args args = { context, xformCache, lightPrim, replacementVec };
+    if (processReplacement(args)) {
+      lightUpdates.emplace(hash, std::move(replacementVec));
+    }
+    ++numProcessed;
+  }
+
+  for (XXH64_hash_t hash : dirtyLightHashes) {
+    auto update = lightUpdates.find(hash);
+    if (update != lightUpdates.end()) {
+      m_owner.m_replacements->replace<AssetReplacement::eLight>(hash, std::move(update->second));
+    } else {
+      m_owner.m_replacements->remove<AssetReplacement::eLight>(hash);
+    }
+  }
+
+  for (XXH64_hash_t hash : removedLights) {
+    m_owner.m_replacements->remove<AssetReplacement::eLight>(hash);
+  }
+
+  // Anything still stale wasn't reached from a dirty root, it will be processed if it is used again
+  m_reload.clearStaleObjects();
+
+  // flush entire cache, kinda a sledgehammer
+  context->emitMemoryBarrier(0,
+    VK_PIPELINE_STAGE_TRANSFER_BIT,
+    VK_ACCESS_TRANSFER_WRITE_BIT,
+    VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
+    VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR);
+
+  // Wait for the uploads of the re-processed meshes before swapping them in, a hot reload only touches a few of them
+  if (!dirtyMeshes.empty()) {
+    Rc<DxvkCommandList> cmdList = context->getCommandList();
+    context->flushCommandList();
+    cmdList->synchronize();
+  }
+
+  for (XXH64_hash_t hash : dirtyMeshHashes) {
+    auto update = meshUpdates.find(hash);
+    if (update != meshUpdates.end()) {
+      m_owner.m_replacements->replace<AssetReplacement::eMesh>(hash, std::move(update->second));
+    } else {
+      m_owner.m_replacements->remove<AssetReplacement::eMesh>(hash);
+    }
+  }
+
+  for (XXH64_hash_t hash : removedMeshes) {
+    m_owner.m_replacements->remove<AssetReplacement::eMesh>(hash);
+  }
+
+  Logger::info(str::format("[USD Mod] Reloaded ", changedLayers.size(), " changed layer(s) of ", m_openedFilePath,
+                           ", processed ", numProcessed, " of ", m_reload.getRootCount(), " replacement roots."));
+  return true;
 }
 
 void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
@@ -788,7 +833,7 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
   if (!stage) {
     Logger::err(str::format("USD mod file failed parsing: ", std::filesystem::weakly_canonical(replacementsUsdPath).string()));
     m_openedFilePath.clear();
-    m_fileModificationTime = fs::file_time_type();
+    m_reload.clear();
     m_owner.setState(ProgressState::Unloaded);
     return;
   }
@@ -809,20 +854,11 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
   // Add stage's base path last.
   AssetDataManager::get().addSearchPath(sublayers.size(), modBaseDirectory);
 
-  m_fileModificationTime = fs::last_write_time(fs::path(m_openedFilePath));
+  m_reload.beginLoad(stage);
+
   pxr::UsdGeomXformCache xformCache;
 
-  pxr::VtDictionary layerData = stage->GetRootLayer()->GetCustomLayerData();
-  if (layerData.empty()) {
-    m_owner.m_status = "Layer Data Missing";
-  } else {
-    const PXR_NS::VtValue* vtExportStatus = layerData.GetValueAtPath(kStatusKey);
-    if (vtExportStatus && !vtExportStatus->IsEmpty()) {
-      m_owner.m_status = vtExportStatus->Get<std::string>();
-    } else {
-      m_owner.m_status = "Status Missing";
-    }
-  }
+  updateStatus(stage);
 
   // Process Materials
 
@@ -838,6 +874,7 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
 
     for (pxr::UsdPrim materialPrim : children) {
       processMaterial(args, materialPrim);
+      m_reload.addRoot(UsdModReload::Materials, materialPrim, getPrimPathHash(materialPrim));
 
       // Note: Update the state progress only every 16 materials to reduce the number of atomic writes.
       if ((++currentMaterialCount & 0b1111u) == 0u) {
@@ -868,6 +905,7 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
 
           addReplacementsSync(args.context->getCommandList(), hash, replacementVec);
         }
+        m_reload.addRoot(UsdModReload::Meshes, child, hash);
       }
 
       // Note: Update the state progress only every 16 meshes to reduce the number of atomic writes.
@@ -927,6 +965,7 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
         if (processReplacement(args)) {
           m_owner.m_replacements->set<AssetReplacement::eLight>(hash, std::move(replacementVec));
         }
+        m_reload.addRoot(UsdModReload::Lights, child, hash);
       }
 
       // Note: Update the state progress only every 16 lights to reduce the number of atomic writes.
@@ -943,6 +982,8 @@ void UsdMod::Impl::processUSD(const Rc<DxvkContext>& context) {
     VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR,
     VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR);
 
+  m_reload.endLoad();
+
   m_owner.setState(ProgressState::Loaded);
 }
 
@@ -1246,8 +1287,8 @@ bool UsdMod::Impl::processMesh(const pxr::UsdPrim& prim, Args& args) {
 
     XXH64_hash_t usdOriginHash = getStrongestOpinionatedPathHash(submesh.prim);
     MeshReplacement* childGeometryData;
-    if (!m_owner.m_replacements->getObject(usdOriginHash, childGeometryData)) {
-      MeshReplacement& newReplacement = m_owner.m_replacements->storeObject(usdOriginHash, MeshReplacement(replacement));
+    if (!getProcessedObject(usdOriginHash, childGeometryData)) {
+      MeshReplacement& newReplacement = storeProcessedObject(usdOriginHash, MeshReplacement(replacement));
       RasterGeometry& newGeomData = newReplacement.data;
 
       const size_t indexDataSize = submesh.GetNumIndices() * sizeof(uint32_t);
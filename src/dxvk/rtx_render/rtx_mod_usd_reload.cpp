@@ -0,0 +1,338 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_mod_usd_reload.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+#include "../../lssusd/usd_include_begin.h"
+#include <pxr/usd/sdf/layer.h>
+#include <pxr/usd/sdf/primSpec.h>
+#include <pxr/usd/usdGeom/mesh.h>
+#include <pxr/usd/usdGeom/subset.h>
+#include <pxr/usd/usdShade/material.h>
+#include <pxr/usd/usdShade/shader.h>
+#include "../../lssusd/usd_include_end.h"
+
+#include "../../lssusd/game_exporter_paths.h"
+#include "../../util/log/log.h"
+#include "../../util/util_string.h"
+
+namespace fs = std::filesystem;
+
+namespace dxvk {
+
+  namespace {
+    // Same as StringToXXH64, without pulling in rtx_utils.h and with it the device headers
+    XXH64_hash_t stringToXXH64(const std::string& str, const XXH64_hash_t seed) {
+      return XXH64(str.c_str(), str.size(), seed);
+    }
+
+    XXH64_hash_t getNamedHash(const std::string& name, const char* prefix, const size_t len) {
+      if (name.compare(0, len, prefix) == 0) {
+        // is a mesh replacement.
+        return std::strtoull(name.c_str()+len, nullptr, 16);
+      } else {
+        // Not a mesh replacements
+        return 0;
+      }
+    }
+  }
+
+  // Find the first prim in the layer stack that has a non-xform or material binding attribute
+  // return the hash of the filename and prim path.
+  XXH64_hash_t getStrongestOpinionatedPathHash(const pxr::UsdPrim& prim) {
+    static const char* kXformPrefix = "xform";
+    static const size_t kXformLen = strlen(kXformPrefix);
+    static const pxr::TfToken kMaterialBinding("material:binding");
+    auto stack = prim.GetPrimStack();
+    for (auto spec : stack) {
+      for (auto property : spec->GetProperties()) {
+        if (property->GetName().compare(0, kXformLen, kXformPrefix) == 0) {
+          // xform property
+          continue;
+        } else if (property->GetNameToken() == kMaterialBinding) {
+          //material binding
+          continue;
+        }
+        // This is the primSpec to use
+        std::string originOfMeshFile = spec->GetLayer()->GetRealPath();
+        std::string originPath = spec->GetPath().GetString();
+
+        XXH64_hash_t usdOriginHash = 0;
+        usdOriginHash = stringToXXH64(originOfMeshFile, usdOriginHash);
+        usdOriginHash = stringToXXH64(originPath, usdOriginHash);
+
+        return usdOriginHash;
+      }
+    }
+    Logger::err(str::format("Asset Replacement failed to find a source prim for ", prim.GetPath().GetString()));
+    // fall back to using the prim's path in replacements.usda.  Potentially worse performance, since it may lead to duplicates.
+    std::string name = prim.GetPath().GetString();
+    return XXH3_64bits(name.c_str(), name.size());
+  }
+
+  XXH64_hash_t getModelHash(const pxr::UsdPrim& prim) {
+    static const char* prefix = lss::prefix::mesh.c_str();
+    static const size_t len = strlen(prefix);
+    return getNamedHash(prim.GetName().GetString(), prefix, len);
+  }
+
+  XXH64_hash_t getLightHash(const pxr::UsdPrim& prim) {
+    static const char* prefix = lss::prefix::light.c_str();
+    static const size_t len = strlen(prefix);
+    if (prim.GetName().GetText()[0] == 's') {
+      // Handling for legacy `sphereLight_HASH` names.  TODO Remove once assets are updated
+      static const char* legacyPrefix = "sphereLight_";
+      static const size_t legacyLen = strlen(legacyPrefix);
+      return getNamedHash(prim.GetName().GetString(), legacyPrefix, legacyLen);
+    }
+    return getNamedHash(prim.GetName().GetString(), prefix, len);
+  }
+
+  XXH64_hash_t getMaterialHash(const pxr::UsdPrim& prim, const pxr::UsdPrim& shader) {
+    static const pxr::TfToken kMaterialType("Material");
+    static const char* prefix = lss::prefix::mat.c_str();
+    static const size_t len = strlen(prefix);
+    std::string name = prim.GetName().GetString();
+    XXH64_hash_t nameHash = getNamedHash(name, prefix, len);
+    if (nameHash != 0) {
+      return nameHash;
+    }
+    if (prim.GetTypeName() != kMaterialType) {
+      return 0;
+    }
+
+    if (!shader.IsValid()) {
+      return 0;
+    }
+    
+    XXH64_hash_t usdOriginHash = getStrongestOpinionatedPathHash(shader);
+
+    return usdOriginHash;
+  }
+
+  pxr::UsdPrim findShader(const pxr::UsdPrim& matPrim) {
+    static const pxr::TfToken kShaderToken("Shader");
+
+    pxr::UsdPrim shader = matPrim.GetChild(kShaderToken);
+    if (!shader.IsValid() || !shader.IsA<pxr::UsdShadeShader>()) {
+      auto children = matPrim.GetFilteredChildren(pxr::UsdPrimIsActive);
+      for (auto child : children) {
+        if (child.IsA<pxr::UsdShadeShader>()) {
+          shader = child;
+        }
+      }
+    }
+    return shader;
+  }
+
+  std::vector<std::string> getLayerPaths(const pxr::UsdStageRefPtr& stage) {
+    std::vector<std::string> paths;
+    for (const pxr::SdfLayerHandle& layer : stage->GetUsedLayers()) {
+      const std::string& path = layer->GetRealPath();
+      if (!layer->IsAnonymous() && !path.empty()) {
+        paths.push_back(path);
+      }
+    }
+    return paths;
+  }
+
+  XXH64_hash_t getPrimPathHash(const pxr::UsdPrim& prim) {
+    return stringToXXH64(prim.GetPath().GetString(), 0);
+  }
+
+  void UsdModReload::beginLoad(const pxr::UsdStageRefPtr& stage) {
+    clear();
+
+    // Record every file the stage is composed from, so that edits to any of them can be hot reloaded
+    m_stage = stage;
+    const auto sublayers = stage->GetRootLayer()->GetSubLayerPaths();
+    m_sublayerPaths.assign(sublayers.begin(), sublayers.end());
+    m_layerTracker.setLayers(getLayerPaths(stage));
+
+    for (ModLayerDependencies& dependencies : m_dependencies) {
+      dependencies.beginUpdate({});
+    }
+  }
+
+  void UsdModReload::addRoot(RootType type, const pxr::UsdPrim& root, XXH64_hash_t hash) {
+    static const std::unordered_set<std::string> noChangedLayers;
+    m_dependencies[type].updateRoot(hash, scanRoot(root, noChangedLayers).layers);
+  }
+
+  void UsdModReload::endLoad() {
+    for (ModLayerDependencies& dependencies : m_dependencies) {
+      dependencies.endUpdate();
+    }
+  }
+
+  bool UsdModReload::reloadLayers(const std::vector<std::string>& changedLayers, RootList& roots) {
+    if (!m_stage) {
+      return false;
+    }
+
+    // Reload the edited layers in place, the stage recomposes the prims authored in them
+    for (const std::string& layerPath : changedLayers) {
+      pxr::SdfLayerHandle layer = pxr::SdfLayer::Find(layerPath);
+      if (layer && (!fs::exists(fs::path(layerPath)) || !layer->Reload())) {
+        return false;
+      }
+    }
+
+    // The sublayer order defines the asset search paths, fall back to a full reload when it changes
+    const auto sublayers = m_stage->GetRootLayer()->GetSubLayerPaths();
+    const std::vector<std::string> sublayerPaths(sublayers.begin(), sublayers.end());
+    if (sublayerPaths != m_sublayerPaths) {
+      return false;
+    }
+
+    // Newly referenced or no longer referenced files count as changed too
+    std::unordered_set<std::string> changed(changedLayers.begin(), changedLayers.end());
+    for (std::string& layerPath : m_layerTracker.setLayers(getLayerPaths(m_stage))) {
+      changed.insert(std::move(layerPath));
+    }
+
+    for (uint32_t type = 0; type < RootTypeCount; type++) {
+      roots[type] = Roots();
+      findDirtyRoots(RootType(type), changed, roots[type]);
+    }
+
+    return true;
+  }
+
+  void UsdModReload::clear() {
+    m_stage = nullptr;
+    m_sublayerPaths.clear();
+    m_layerTracker.clear();
+    for (ModLayerDependencies& dependencies : m_dependencies) {
+      dependencies.clear();
+    }
+    m_staleObjects.clear();
+  }
+
+  size_t UsdModReload::getRootCount() const {
+    size_t count = 0;
+    for (const ModLayerDependencies& dependencies : m_dependencies) {
+      count += dependencies.getRootCount();
+    }
+    return count;
+  }
+
+  const char* UsdModReload::getRootPath(RootType type) {
+    switch (type) {
+    case Materials: return "/RootNode/Looks";
+    case Meshes:    return "/RootNode/meshes";
+    case Lights:    return "/RootNode/lights";
+    default:        return "";
+    }
+  }
+
+  XXH64_hash_t UsdModReload::getRootHash(RootType type, const pxr::UsdPrim& root) {
+    switch (type) {
+    case Materials: return getPrimPathHash(root);
+    case Meshes:    return getModelHash(root);
+    case Lights:    return getLightHash(root);
+    default:        return 0;
+    }
+  }
+
+  void UsdModReload::scanPrim(const pxr::UsdPrim& prim, const std::unordered_set<std::string>& changedLayers, bool arcsChanged, RootScan& scan) {
+    bool authoredInChangedLayer = false;
+    for (const pxr::SdfPrimSpecHandle& spec : prim.GetPrimStack()) {
+      const std::string& layerPath = spec->GetLayer()->GetRealPath();
+      if (std::find(scan.layers.begin(), scan.layers.end(), layerPath) == scan.layers.end()) {
+        scan.layers.push_back(layerPath);
+      }
+
+      if (changedLayers.count(layerPath) > 0) {
+        authoredInChangedLayer = true;
+        // Changed composition arcs can swap out everything below this prim, even prims that aren't authored in the changed layer
+        arcsChanged |= spec->HasReferences() || spec->HasPayloads() || !spec->GetVariantSelections().empty();
+      }
+    }
+
+    if (authoredInChangedLayer || arcsChanged) {
+      if (prim.IsA<pxr::UsdGeomMesh>()) {
+        // Subsets are built from the mesh's geometry, so they go stale with it
+        scan.staleObjects.push_back(getStrongestOpinionatedPathHash(prim));
+        for (const pxr::UsdPrim& child : prim.GetFilteredChildren(pxr::UsdPrimIsActive)) {
+          if (child.IsA<pxr::UsdGeomSubset>()) {
+            scan.staleObjects.push_back(getStrongestOpinionatedPathHash(child));
+          }
+        }
+      } else if (prim.IsA<pxr::UsdGeomSubset>()) {
+        scan.staleObjects.push_back(getStrongestOpinionatedPathHash(prim));
+      } else if (prim.IsA<pxr::UsdShadeMaterial>() || prim.IsA<pxr::UsdShadeShader>()) {
+        const pxr::UsdPrim matPrim = prim.IsA<pxr::UsdShadeShader>() ? prim.GetParent() : prim;
+        const pxr::UsdPrim shader = findShader(matPrim);
+        if (shader.IsValid()) {
+          scan.staleObjects.push_back(getMaterialHash(matPrim, shader));
+        }
+      }
+    }
+
+    for (const pxr::UsdPrim& child : prim.GetFilteredChildren(pxr::UsdPrimIsActive)) {
+      scanPrim(child, changedLayers, arcsChanged, scan);
+    }
+  }
+
+  UsdModReload::RootScan UsdModReload::scanRoot(const pxr::UsdPrim& root, const std::unordered_set<std::string>& changedLayers) {
+    RootScan scan;
+    scanPrim(root, changedLayers, false, scan);
+    return scan;
+  }
+
+  void UsdModReload::findDirtyRoots(RootType type, const std::unordered_set<std::string>& changedLayers, Roots& roots) {
+    const std::vector<std::string> changedList(changedLayers.begin(), changedLayers.end());
+    std::vector<std::pair<pxr::UsdPrim, XXH64_hash_t>> allRoots;
+
+    ModLayerDependencies& dependencies = m_dependencies[type];
+    dependencies.beginUpdate(changedList);
+
+    const pxr::UsdPrim parent = m_stage->GetPrimAtPath(pxr::SdfPath(getRootPath(type)));
+    if (parent.IsValid()) {
+      for (const pxr::UsdPrim& child : parent.GetFilteredChildren(pxr::UsdPrimIsActive)) {
+        const XXH64_hash_t hash = getRootHash(type, child);
+        if (hash == 0) {
+          continue;
+        }
+
+        RootScan scan = scanRoot(child, changedLayers);
+        if (dependencies.updateRoot(hash, scan.layers)) {
+          roots.dirtyHashes.insert(hash);
+        }
+        m_staleObjects.insert(scan.staleObjects.begin(), scan.staleObjects.end());
+        allRoots.emplace_back(child, hash);
+      }
+    }
+    roots.removed = dependencies.endUpdate();
+
+    for (auto& root : allRoots) {
+      if (roots.dirtyHashes.count(root.second) > 0) {
+        roots.dirty.push_back(std::move(root));
+      }
+    }
+  }
+
+}
@@ -0,0 +1,136 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <array>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "rtx_mod_layer_tracker.h"
+#include "../../util/util_fast_cache.h"
+
+#include "../../lssusd/usd_include_begin.h"
+#include <pxr/usd/usd/prim.h>
+#include <pxr/usd/usd/stage.h>
+#include "../../lssusd/usd_include_end.h"
+
+namespace dxvk {
+
+  // Hashes identifying the replacement roots and the objects processed from a USD mod
+  XXH64_hash_t getStrongestOpinionatedPathHash(const pxr::UsdPrim& prim);
+  XXH64_hash_t getModelHash(const pxr::UsdPrim& prim);
+  XXH64_hash_t getLightHash(const pxr::UsdPrim& prim);
+  XXH64_hash_t getMaterialHash(const pxr::UsdPrim& prim, const pxr::UsdPrim& shader);
+  XXH64_hash_t getPrimPathHash(const pxr::UsdPrim& prim);
+  pxr::UsdPrim findShader(const pxr::UsdPrim& matPrim);
+
+  // Files the stage is composed from, sublayers and referenced files included
+  std::vector<std::string> getLayerPaths(const pxr::UsdStageRefPtr& stage);
+
+  /*
+  *  USD Mod Reload
+  *
+  *  Keeps the stage of a loaded mod open along with the layers its replacement roots were composed from,
+  *  so that a hot reload only has to reload the edited layers and process the roots composed from them.
+  *  Processing the roots is left to the caller, this only decides what needs to be processed again.
+  */
+  class UsdModReload {
+  public:
+    enum RootType : uint32_t {
+      Materials,
+      Meshes,
+      Lights,
+      RootTypeCount
+    };
+
+    struct Roots {
+      // Roots to process again, every root sharing a dirty hash is listed so the replacements for it are rebuilt in full
+      std::vector<std::pair<pxr::UsdPrim, XXH64_hash_t>> dirty;
+      fast_unordered_set dirtyHashes;
+      // Hashes no root is using anymore
+      std::vector<XXH64_hash_t> removed;
+    };
+
+    using RootList = std::array<Roots, RootTypeCount>;
+
+    // Starts tracking a freshly opened stage, followed by addRoot for each root processed by the full load
+    void beginLoad(const pxr::UsdStageRefPtr& stage);
+    void addRoot(RootType type, const pxr::UsdPrim& root, XXH64_hash_t hash);
+    void endLoad();
+
+    // Reloads the edited layers and finds the roots composed from them.  The objects authored in those layers
+    // are marked stale before anything is processed, as objects may be shared between roots.
+    // Returns false if the mod needs a full reload instead.
+    bool reloadLayers(const std::vector<std::string>& changedLayers, RootList& roots);
+
+    // Stale objects are processed again instead of being reused, until they are stored again
+    bool isStale(XXH64_hash_t hash) const {
+      return m_staleObjects.count(hash) > 0;
+    }
+
+    bool clearStale(XXH64_hash_t hash) {
+      return m_staleObjects.erase(hash) > 0;
+    }
+
+    void clearStaleObjects() {
+      m_staleObjects.clear();
+    }
+
+    void clear();
+
+    const pxr::UsdStageRefPtr& getStage() const {
+      return m_stage;
+    }
+
+    // Polled from the mod's watchdog thread
+    ModLayerTracker& getLayerTracker() {
+      return m_layerTracker;
+    }
+
+    size_t getRootCount() const;
+
+    static const char* getRootPath(RootType type);
+
+  private:
+    // Layers a replacement root is composed from, and the objects in it authored by a changed layer
+    struct RootScan {
+      std::vector<std::string> layers;
+      std::vector<XXH64_hash_t> staleObjects;
+    };
+
+    static RootScan scanRoot(const pxr::UsdPrim& root, const std::unordered_set<std::string>& changedLayers);
+    static void scanPrim(const pxr::UsdPrim& prim, const std::unordered_set<std::string>& changedLayers, bool arcsChanged, RootScan& scan);
+
+    static XXH64_hash_t getRootHash(RootType type, const pxr::UsdPrim& root);
+
+    void findDirtyRoots(RootType type, const std::unordered_set<std::string>& changedLayers, Roots& roots);
+
+    pxr::UsdStageRefPtr m_stage;
+    std::vector<std::string> m_sublayerPaths;
+    ModLayerTracker m_layerTracker;
+    std::array<ModLayerDependencies, RootTypeCount> m_dependencies;
+    fast_unordered_set m_staleObjects;
+  };
+
+}
@@ -0,0 +1,544 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "rtx_opacity_micromap_disk_cache.h"
+
+#include <cstring>
+#include <filesystem>
+
+#include "../../util/log/log.h"
+#include "../../util/util_once.h"
+#include "../../util/util_string.h"
+
+namespace dxvk {
+
+  namespace {
+    uint64_t alignPayloadOffset(uint64_t offset) {
+      const uint64_t alignment = OpacityMicromapDiskCache::kPayloadAlignment;
+      return (offset + alignment - 1) & ~(alignment - 1);
+    }
+  }
+
+  const OpacityMicromapDiskCacheEntry* OpacityMicromapDiskCacheIndex::find(XXH64_hash_t ommSrcHash) const {
+    auto iter = m_entries.find(ommSrcHash);
+    return iter != m_entries.end() ? &iter->second : nullptr;
+  }
+
+  void OpacityMicromapDiskCacheIndex::touch(XXH64_hash_t ommSrcHash) {
+    m_lru.touch(ommSrcHash);
+  }
+
+  void OpacityMicromapDiskCacheIndex::setPayloadOffset(XXH64_hash_t ommSrcHash, uint64_t payloadOffset) {
+    auto iter = m_entries.find(ommSrcHash);
+    if (iter != m_entries.end()) {
+      iter->second.payloadOffset = payloadOffset;
+    }
+  }
+
+  std::vector<XXH64_hash_t> OpacityMicromapDiskCacheIndex::insert(const OpacityMicromapDiskCacheEntry& entry) {
+    // Entries larger than the whole cache are never admitted
+    if (entry.payloadSize > m_maxPayloadSize) {
+      return { };
+    }
+
+    remove(entry.ommSrcHash);
+
+    m_entries[entry.ommSrcHash] = entry;
+    m_lru.insert(entry.ommSrcHash);
+    m_payloadSize += entry.payloadSize;
+
+    return evict();
+  }
+
+  void OpacityMicromapDiskCacheIndex::remove(XXH64_hash_t ommSrcHash) {
+    auto iter = m_entries.find(ommSrcHash);
+    if (iter == m_entries.end()) {
+      return;
+    }
+
+    m_payloadSize -= iter->second.payloadSize;
+    m_lru.remove(ommSrcHash);
+    m_entries.erase(iter);
+  }
+
+  std::vector<XXH64_hash_t> OpacityMicromapDiskCacheIndex::setMaxPayloadSize(uint64_t maxPayloadSize) {
+    m_maxPayloadSize = maxPayloadSize;
+    return evict();
+  }
+
+  std::vector<OpacityMicromapDiskCacheEntry> OpacityMicromapDiskCacheIndex::getEntriesInLruOrder() const {
+    std::vector<OpacityMicromapDiskCacheEntry> entries;
+    entries.reserve(m_entries.size());
+
+    for (auto iter = m_lru.leastRecentlyUsedIter(); iter != m_lru.leastRecentlyUsedEndIter(); ++iter) {
+      entries.push_back(m_entries.at(*iter));
+    }
+
+    return entries;
+  }
+
+  void OpacityMicromapDiskCacheIndex::clear() {
+    while (m_lru.size() > 0) {
+      m_lru.remove(m_lru.leastRecentlyUsedIter());
+    }
+    m_entries.clear();
+    m_payloadSize = 0;
+  }
+
+  std::vector<XXH64_hash_t> OpacityMicromapDiskCacheIndex::evict() {
+    std::vector<XXH64_hash_t> evictedHashes;
+
+    while (m_payloadSize > m_maxPayloadSize && m_lru.size() > 0) {
+      const XXH64_hash_t ommSrcHash = *m_lru.leastRecentlyUsedIter();
+      evictedHashes.push_back(ommSrcHash);
+      remove(ommSrcHash);
+    }
+
+    return evictedHashes;
+  }
+
+  static_assert(OpacityMicromapDiskCache::kPayloadBaseOffset >= sizeof(OpacityMicromapDiskCacheHeader));
+
+  OpacityMicromapDiskCache::OpacityMicromapDiskCache(const std::string& filePath, uint64_t maxPayloadSize)
+    : m_filePath(filePath)
+    , m_index(maxPayloadSize) { }
+
+  OpacityMicromapDiskCache::~OpacityMicromapDiskCache() {
+    if (m_compaction) {
+      m_compaction->thread.join();
+    }
+  }
+
+  bool OpacityMicromapDiskCache::readIndex(std::istream& stream, std::vector<OpacityMicromapDiskCacheEntry>& entries) {
+    const OpacityMicromapDiskCacheHeader expected;
+    OpacityMicromapDiskCacheHeader header;
+
+    if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+      return false;
+    }
+
+    if (memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0 ||
+        header.version != expected.version ||
+        header.entrySize != sizeof(OpacityMicromapDiskCacheEntry)) {
+      return false;
+    }
+
+    if (header.entryTableOffset < kPayloadBaseOffset) {
+      return false;
+    }
+
+    if (header.entryCount == 0) {
+      entries.clear();
+      return true;
+    }
+
+    // Reject entry counts the file can't hold before allocating the entry table for them
+    if (!stream.seekg(0, std::ios_base::end)) {
+      return false;
+    }
+    const std::streampos endPos = stream.tellg();
+    if (endPos < 0 || header.entryTableOffset > uint64_t(endPos) ||
+        uint64_t(header.entryCount) * sizeof(OpacityMicromapDiskCacheEntry) > uint64_t(endPos) - header.entryTableOffset ||
+        !stream.seekg(static_cast<std::streamoff>(header.entryTableOffset))) {
+      return false;
+    }
+
+    entries.resize(header.entryCount);
+
+    if (!stream.read(reinterpret_cast<char*>(entries.data()), sizeof(OpacityMicromapDiskCacheEntry) * header.entryCount)) {
+      entries.clear();
+      return false;
+    }
+
+    // Validate the entry table against the payload section before trusting any of it
+    for (const OpacityMicromapDiskCacheEntry& entry : entries) {
+      if (entry.payloadOffset < kPayloadBaseOffset ||
+          entry.payloadOffset % kPayloadAlignment != 0 ||
+          entry.payloadOffset + entry.payloadSize > header.entryTableOffset) {
+        entries.clear();
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool OpacityMicromapDiskCache::readPayload(std::istream& stream, const OpacityMicromapDiskCacheEntry& entry, std::vector<uint8_t>& payload) {
+    payload.resize(entry.payloadSize);
+
+    stream.clear();
+    if (!stream.seekg(entry.payloadOffset) ||
+        !stream.read(reinterpret_cast<char*>(payload.data()), entry.payloadSize)) {
+      payload.clear();
+      return false;
+    }
+
+    if (XXH3_64bits(payload.data(), payload.size()) != entry.payloadHash) {
+      payload.clear();
+      return false;
+    }
+
+    return true;
+  }
+
+  std::ifstream& OpacityMicromapDiskCache::getReadStream() {
+    if (!m_readStream.is_open()) {
+      m_readStream.open(m_filePath, std::ios_base::binary);
+    }
+    return m_readStream;
+  }
+
+  bool OpacityMicromapDiskCache::load() {
+    m_index.clear();
+    m_pendingPayloads.clear();
+    m_fileEnd = 0;
+    m_isDirty = false;
+    m_isLruOrderStale = false;
+
+    std::ifstream& stream = getReadStream();
+
+    if (!stream.is_open()) {
+      return false;
+    }
+
+    std::vector<OpacityMicromapDiskCacheEntry> entries;
+
+    if (!readIndex(stream, entries)) {
+      Logger::warn(str::format("[RTX Opacity Micromap] Ignoring incompatible or corrupted disk cache: ", m_filePath));
+      m_readStream.close();
+      // Rewrite the container on the next flush
+      m_isDirty = true;
+      return false;
+    }
+
+    // Entries are stored in LRU order, so inserting them in order restores the LRU state
+    for (const OpacityMicromapDiskCacheEntry& entry : entries) {
+      releasePayloads(m_index.insert(entry));
+    }
+
+    // Anything past the entry table is left over from an interrupted flush and gets overwritten
+    OpacityMicromapDiskCacheHeader header;
+    stream.clear();
+    stream.seekg(0);
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    m_fileEnd = header.entryTableOffset + uint64_t(header.entryCount) * sizeof(OpacityMicromapDiskCacheEntry);
+
+    Logger::info(str::format("[RTX Opacity Micromap] Loaded disk cache with ", m_index.size(), " entries (", m_index.getPayloadSize() >> 10, " kB) from ", m_filePath));
+
+    return true;
+  }
+
+  const OpacityMicromapDiskCacheEntry* OpacityMicromapDiskCache::find(XXH64_hash_t ommSrcHash, XXH64_hash_t bakeSettingsHash, uint32_t numTriangles) {
+    const OpacityMicromapDiskCacheEntry* entry = m_index.find(ommSrcHash);
+
+    if (entry == nullptr || entry->bakeSettingsHash != bakeSettingsHash || entry->numTriangles != numTriangles) {
+      ++m_statistics.numMisses;
+      return nullptr;
+    }
+
+    return entry;
+  }
+
+  bool OpacityMicromapDiskCache::read(const OpacityMicromapDiskCacheEntry& entry, std::vector<uint8_t>& payload) {
+    const XXH64_hash_t ommSrcHash = entry.ommSrcHash;
+
+    auto pendingIter = m_pendingPayloads.find(ommSrcHash);
+
+    if (pendingIter != m_pendingPayloads.end()) {
+      payload = pendingIter->second;
+    } else if (!readPayload(getReadStream(), entry, payload)) {
+      ONCE(Logger::warn(str::format("[RTX Opacity Micromap] Encountered a corrupted entry in the disk cache: ", m_filePath)));
+      ++m_statistics.numCorrupted;
+      m_index.remove(ommSrcHash);
+      m_isDirty = true;
+      return false;
+    }
+
+    ++m_statistics.numHits;
+    m_index.touch(ommSrcHash);
+    m_isLruOrderStale = true;
+    return true;
+  }
+
+  void OpacityMicromapDiskCache::store(XXH64_hash_t ommSrcHash, XXH64_hash_t bakeSettingsHash, uint32_t numTriangles, const void* data, uint32_t size) {
+    OpacityMicromapDiskCacheEntry entry;
+    entry.ommSrcHash = ommSrcHash;
+    entry.bakeSettingsHash = bakeSettingsHash;
+    entry.payloadHash = XXH3_64bits(data, size);
+    entry.payloadSize = size;
+    entry.numTriangles = numTriangles;
+
+    if (size > m_index.getMaxPayloadSize()) {
+      return;
+    }
+
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+    m_pendingPayloads[ommSrcHash].assign(bytes, bytes + size);
+    releasePayloads(m_index.insert(entry));
+
+    ++m_statistics.numStored;
+    m_isDirty = true;
+  }
+
+  void OpacityMicromapDiskCache::setMaxPayloadSize(uint64_t maxPayloadSize) {
+    if (maxPayloadSize == m_index.getMaxPayloadSize()) {
+      return;
+    }
+
+    const std::vector<XXH64_hash_t> evictedHashes = m_index.setMaxPayloadSize(maxPayloadSize);
+    releasePayloads(evictedHashes);
+    m_isDirty |= !evictedHashes.empty();
+  }
+
+  void OpacityMicromapDiskCache::releasePayloads(const std::vector<XXH64_hash_t>& evictedHashes) {
+    for (XXH64_hash_t ommSrcHash : evictedHashes) {
+      m_pendingPayloads.erase(ommSrcHash);
+    }
+  }
+
+  bool OpacityMicromapDiskCache::flush(bool isShutdown) {
+    if (m_compaction) {
+      // The container is being rewritten, appends wait until the compacted one replaces it
+      if (!isShutdown && !m_compaction->isDone) {
+        return true;
+      }
+      finishCompaction();
+    }
+
+    if (!m_isDirty && !(isShutdown && m_isLruOrderStale)) {
+      return true;
+    }
+
+    if (!append()) {
+      return false;
+    }
+
+    m_isDirty = false;
+    m_isLruOrderStale = false;
+
+    if (!isShutdown && isCompactionNeeded()) {
+      startCompaction();
+    }
+
+    return true;
+  }
+
+  bool OpacityMicromapDiskCache::append() {
+    std::vector<OpacityMicromapDiskCacheEntry> entries = m_index.getEntriesInLruOrder();
+
+    // Readers must not see the file while it is being extended
+    m_readStream.close();
+
+    std::fstream file;
+    if (m_fileEnd != 0) {
+      file.open(m_filePath, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+    }
+
+    if (!file.is_open()) {
+      // No valid container to append to, start a new one
+      file.open(m_filePath, std::ios_base::binary | std::ios_base::out | std::ios_base::trunc);
+      m_fileEnd = kPayloadBaseOffset;
+    }
+
+    if (!file.is_open()) {
+      Logger::warn(str::format("[RTX Opacity Micromap] Failed to open disk cache for writing: ", m_filePath));
+      return false;
+    }
+
+    // New payloads go after the current entry table, which stays valid until the header is replaced
+    uint64_t offset = alignPayloadOffset(m_fileEnd);
+
+    for (OpacityMicromapDiskCacheEntry& entry : entries) {
+      auto pendingIter = m_pendingPayloads.find(entry.ommSrcHash);
+      if (pendingIter == m_pendingPayloads.end()) {
+        continue;
+      }
+
+      entry.payloadOffset = offset;
+      file.seekp(offset);
+      file.write(reinterpret_cast<const char*>(pendingIter->second.data()), pendingIter->second.size());
+      offset = alignPayloadOffset(offset + entry.payloadSize);
+    }
+
+    OpacityMicromapDiskCacheHeader header;
+    header.entryCount = static_cast<uint32_t>(entries.size());
+    header.entrySize = sizeof(OpacityMicromapDiskCacheEntry);
+    header.entryTableOffset = offset;
+
+    file.seekp(offset);
+    if (!entries.empty()) {
+      file.write(reinterpret_cast<const char*>(entries.data()), sizeof(OpacityMicromapDiskCacheEntry) * entries.size());
+    }
+
+    // The header goes last so that it only references data that has been written
+    file.flush();
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    if (file.fail()) {
+      Logger::warn(str::format("[RTX Opacity Micromap] Failed to write disk cache: ", m_filePath));
+      // The state of the file is unknown, so the next flush starts a new container
+      m_fileEnd = 0;
+      return false;
+    }
+
+    m_fileEnd = offset + sizeof(OpacityMicromapDiskCacheEntry) * entries.size();
+
+    // Appended payloads are read from the container from now on
+    for (const OpacityMicromapDiskCacheEntry& entry : entries) {
+      if (m_pendingPayloads.erase(entry.ommSrcHash) != 0) {
+        m_index.setPayloadOffset(entry.ommSrcHash, entry.payloadOffset);
+      }
+    }
+
+    return true;
+  }
+
+  bool OpacityMicromapDiskCache::isCompactionNeeded() const {
+    if (m_isCompactionFailed || m_fileEnd == 0) {
+      return false;
+    }
+
+    // All pending payloads have just been appended, so every entry in the index lives in the container
+    uint64_t liveSize = kPayloadBaseOffset + sizeof(OpacityMicromapDiskCacheEntry) * m_index.size();
+    for (const OpacityMicromapDiskCacheEntry& entry : m_index.getEntriesInLruOrder()) {
+      liveSize += alignPayloadOffset(entry.payloadSize);
+    }
+
+    // Compact once evicted payloads and old entry tables take up more than half of the container
+    return m_fileEnd > 2 * liveSize;
+  }
+
+  void OpacityMicromapDiskCache::startCompaction() {
+    m_compaction = std::make_unique<Compaction>();
+    m_compaction->entries = m_index.getEntriesInLruOrder();
+
+    Compaction* compaction = m_compaction.get();
+    const std::string srcFilePath = m_filePath;
+
+    m_compaction->thread = dxvk::thread([compaction, srcFilePath] {
+      compaction->succeeded = writeCompacted(srcFilePath, srcFilePath + ".tmp", compaction->entries, compaction->fileEnd);
+      compaction->isDone = true;
+    });
+  }
+
+  void OpacityMicromapDiskCache::finishCompaction() {
+    m_compaction->thread.join();
+    std::unique_ptr<Compaction> compaction = std::move(m_compaction);
+
+    const std::string tempFilePath = m_filePath + ".tmp";
+    std::error_code ec;
+
+    if (!compaction->succeeded) {
+      Logger::warn(str::format("[RTX Opacity Micromap] Failed to compact disk cache: ", m_filePath));
+      std::filesystem::remove(tempFilePath, ec);
+      m_isCompactionFailed = true;
+      return;
+    }
+
+    m_readStream.close();
+    std::filesystem::rename(tempFilePath, m_filePath, ec);
+
+    if (ec) {
+      Logger::warn(str::format("[RTX Opacity Micromap] Failed to replace disk cache ", m_filePath, ": ", ec.message()));
+      std::filesystem::remove(tempFilePath, ec);
+      m_isCompactionFailed = true;
+      return;
+    }
+
+    std::unordered_map<XXH64_hash_t, const OpacityMicromapDiskCacheEntry*> compactedEntries;
+    for (const OpacityMicromapDiskCacheEntry& entry : compaction->entries) {
+      compactedEntries[entry.ommSrcHash] = &entry;
+    }
+
+    // Nothing was appended while compacting, so every entry on disk was part of the compaction. Entries
+    // stored since then are still pending, and entries whose payloads couldn't be copied are dropped.
+    for (const OpacityMicromapDiskCacheEntry& entry : m_index.getEntriesInLruOrder()) {
+      if (m_pendingPayloads.count(entry.ommSrcHash) != 0) {
+        continue;
+      }
+
+      auto iter = compactedEntries.find(entry.ommSrcHash);
+      if (iter != compactedEntries.end() && iter->second->payloadHash == entry.payloadHash) {
+        m_index.setPayloadOffset(entry.ommSrcHash, iter->second->payloadOffset);
+      } else {
+        m_index.remove(entry.ommSrcHash);
+        m_isDirty = true;
+      }
+    }
+
+    m_fileEnd = compaction->fileEnd;
+    ++m_statistics.numCompactions;
+  }
+
+  bool OpacityMicromapDiskCache::writeCompacted(const std::string& srcFilePath, const std::string& dstFilePath,
+                                                std::vector<OpacityMicromapDiskCacheEntry>& entries, uint64_t& fileEnd) {
+    std::ifstream src(srcFilePath, std::ios_base::binary);
+    std::ofstream dst(dstFilePath, std::ios_base::binary | std::ios_base::trunc);
+
+    if (!src.is_open() || !dst.is_open()) {
+      return false;
+    }
+
+    std::vector<OpacityMicromapDiskCacheEntry> compactedEntries;
+    compactedEntries.reserve(entries.size());
+
+    uint64_t offset = kPayloadBaseOffset;
+    std::vector<uint8_t> payload;
+
+    for (OpacityMicromapDiskCacheEntry entry : entries) {
+      // Drop entries whose payloads can't be recovered
+      if (!readPayload(src, entry, payload)) {
+        continue;
+      }
+
+      entry.payloadOffset = offset;
+      dst.seekp(offset);
+      dst.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+      offset = alignPayloadOffset(offset + entry.payloadSize);
+
+      compactedEntries.push_back(entry);
+    }
+
+    OpacityMicromapDiskCacheHeader header;
+    header.entryCount = static_cast<uint32_t>(compactedEntries.size());
+    header.entrySize = sizeof(OpacityMicromapDiskCacheEntry);
+    header.entryTableOffset = offset;
+
+    dst.seekp(offset);
+    if (!compactedEntries.empty()) {
+      dst.write(reinterpret_cast<const char*>(compactedEntries.data()), sizeof(OpacityMicromapDiskCacheEntry) * compactedEntries.size());
+    }
+
+    dst.seekp(0);
+    dst.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    dst.close();
+
+    if (dst.fail()) {
+      return false;
+    }
+
+    entries = std::move(compactedEntries);
+    fileEnd = offset + sizeof(OpacityMicromapDiskCacheEntry) * entries.size();
+    return true;
+  }
+}
@@ -0,0 +1,204 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../../util/xxHash/xxhash.h"
+#include "../../util/util_lru.h"
+#include "../../util/thread.h"
+
+namespace dxvk {
+
+  /*
+  *  Opacity Micromap Disk Cache
+  *
+  *  Persists baked OMM arrays across sessions, keyed by the OMM source hash.
+  *
+  *  Container layout (all offsets are from the start of the file):
+  *    [Header]
+  *    [Payload, each aligned to kPayloadAlignment]
+  *    [Entry x entryCount, at entryTableOffset]
+  *
+  *  Payloads are aligned so that the file can be memory mapped and the payloads uploaded
+  *  directly. A flush appends the new payloads and a new entry table after the current
+  *  table, then points the header at it, so payloads already on disk are never rewritten
+  *  and a torn flush leaves the previous table intact. The entry order in the table is the
+  *  LRU order at the time of the flush, starting with the least recently used.
+  *
+  *  Evicted payloads and old tables stay behind as dead space until a compaction rewrites
+  *  the container on a worker thread.
+  */
+  struct OpacityMicromapDiskCacheHeader {
+    char     magic[4] = { 'R', 'O', 'M', 'M' };
+    uint32_t version = 2;
+    uint32_t entryCount = 0;
+    uint32_t entrySize = 0;
+    uint64_t entryTableOffset = 0;
+  };
+
+  static_assert(sizeof(OpacityMicromapDiskCacheHeader) == 24);
+
+  struct OpacityMicromapDiskCacheEntry {
+    XXH64_hash_t ommSrcHash = 0;
+    // Hash of the baking settings the payload was produced with (subdivision level, format and estimation settings)
+    XXH64_hash_t bakeSettingsHash = 0;
+    // Hash of the payload, used to detect a corrupted container
+    XXH64_hash_t payloadHash = 0;
+    uint64_t payloadOffset = 0;
+    uint32_t payloadSize = 0;
+    uint32_t numTriangles = 0;
+  };
+
+  static_assert(sizeof(OpacityMicromapDiskCacheEntry) == 40);
+
+  // In-memory index of the disk cache. Tracks entries in LRU order and evicts least recently used
+  // entries once the total payload size exceeds the size cap.
+  class OpacityMicromapDiskCacheIndex {
+  public:
+    explicit OpacityMicromapDiskCacheIndex(uint64_t maxPayloadSize)
+      : m_maxPayloadSize(maxPayloadSize) { }
+
+    const OpacityMicromapDiskCacheEntry* find(XXH64_hash_t ommSrcHash) const;
+
+    // Marks an entry as most recently used
+    void touch(XXH64_hash_t ommSrcHash);
+
+    // Moves an entry's payload without changing its LRU position
+    void setPayloadOffset(XXH64_hash_t ommSrcHash, uint64_t payloadOffset);
+
+    // Inserts or replaces an entry as the most recently used one.
+    // Returns hashes of entries evicted to stay within the size cap.
+    std::vector<XXH64_hash_t> insert(const OpacityMicromapDiskCacheEntry& entry);
+
+    void remove(XXH64_hash_t ommSrcHash);
+
+    // Changes the size cap, evicting any entries over the new cap
+    std::vector<XXH64_hash_t> setMaxPayloadSize(uint64_t maxPayloadSize);
+
+    // Entries ordered from the least to the most recently used
+    std::vector<OpacityMicromapDiskCacheEntry> getEntriesInLruOrder() const;
+
+    uint64_t getPayloadSize() const { return m_payloadSize; }
+    uint64_t getMaxPayloadSize() const { return m_maxPayloadSize; }
+    uint32_t size() const { return m_lru.size(); }
+
+    void clear();
+
+  private:
+    std::vector<XXH64_hash_t> evict();
+
+    uint64_t m_maxPayloadSize;
+    uint64_t m_payloadSize = 0;
+    std::unordered_map<XXH64_hash_t, OpacityMicromapDiskCacheEntry> m_entries;
+    lru_list<XXH64_hash_t> m_lru;
+  };
+
+  class OpacityMicromapDiskCache {
+  public:
+    static constexpr uint32_t kPayloadAlignment = 256;
+    // Payloads start right after the header
+    static constexpr uint64_t kPayloadBaseOffset = kPayloadAlignment;
+
+    OpacityMicromapDiskCache(const std::string& filePath, uint64_t maxPayloadSize);
+    ~OpacityMicromapDiskCache();
+
+    // Loads the index from the container on disk. Payloads are read lazily.
+    // Returns false if the file is missing, has an unsupported version or is corrupted.
+    bool load();
+
+    // Appends the payloads stored since the last flush and a new entry table. Reads alone only
+    // change the LRU order, which is written along with the next new entries or on shutdown.
+    // Starts a compaction on a worker thread once most of the container is dead space, appends
+    // are deferred until it finishes. On shutdown a running compaction is waited for.
+    bool flush(bool isShutdown = false);
+
+    // Returns a matching entry, or nullptr if there is no entry or it was baked with different settings
+    const OpacityMicromapDiskCacheEntry* find(XXH64_hash_t ommSrcHash, XXH64_hash_t bakeSettingsHash, uint32_t numTriangles);
+
+    // Reads a payload and validates it against its hash. Invalid entries are removed from the cache.
+    bool read(const OpacityMicromapDiskCacheEntry& entry, std::vector<uint8_t>& payload);
+
+    void store(XXH64_hash_t ommSrcHash, XXH64_hash_t bakeSettingsHash, uint32_t numTriangles, const void* data, uint32_t size);
+
+    void setMaxPayloadSize(uint64_t maxPayloadSize);
+
+    const OpacityMicromapDiskCacheIndex& getIndex() const { return m_index; }
+    bool isDirty() const { return m_isDirty; }
+
+    // Container (de)serialization, exposed for testing
+    static bool readIndex(std::istream& stream, std::vector<OpacityMicromapDiskCacheEntry>& entries);
+    static bool readPayload(std::istream& stream, const OpacityMicromapDiskCacheEntry& entry, std::vector<uint8_t>& payload);
+    // Writes a container with the given entries, copying their payloads over from another container.
+    // Entries whose payloads can't be read are dropped, the rest get their new offsets.
+    static bool writeCompacted(const std::string& srcFilePath, const std::string& dstFilePath,
+                               std::vector<OpacityMicromapDiskCacheEntry>& entries, uint64_t& fileEnd);
+
+    struct Statistics {
+      uint32_t numHits = 0;
+      uint32_t numMisses = 0;
+      uint32_t numStored = 0;
+      uint32_t numCorrupted = 0;
+      uint32_t numCompactions = 0;
+    };
+
+    const Statistics& getStatistics() const { return m_statistics; }
+
+  private:
+    struct Compaction {
+      dxvk::thread thread;
+      std::atomic<bool> isDone = false;
+      bool succeeded = false;
+      std::vector<OpacityMicromapDiskCacheEntry> entries;
+      uint64_t fileEnd = 0;
+    };
+
+    void releasePayloads(const std::vector<XXH64_hash_t>& evictedHashes);
+    std::ifstream& getReadStream();
+    bool append();
+    bool isCompactionNeeded() const;
+    void startCompaction();
+    void finishCompaction();
+
+    std::string m_filePath;
+    OpacityMicromapDiskCacheIndex m_index;
+    // Payloads added this session that are not yet part of the container on disk
+    std::unordered_map<XXH64_hash_t, std::vector<uint8_t>> m_pendingPayloads;
+    std::ifstream m_readStream;
+    // End of the entry table on disk, 0 if there's no valid container to append to
+    uint64_t m_fileEnd = 0;
+    // Entries were added or removed since the last flush
+    bool m_isDirty = false;
+    // Only the LRU order changed since the last flush
+    bool m_isLruOrderStale = false;
+    bool m_isCompactionFailed = false;
+    std::unique_ptr<Compaction> m_compaction;
+    Statistics m_statistics;
+  };
+}
@@ -252,12 +252,29 @@ namespace dxvk {
     return m_scratchBuffer;
   }
 
-  OpacityMicromapManager::OpacityMicromapManager(DxvkDevice* device)
+  OpacityMicromapManager::OpacityMicromapManager(DxvkDevice* device, OpacityMicromapDiskCache* diskCache)
     : CommonDeviceObject(device)
-    , m_memoryManager(device) {
+    , m_memoryManager(device)
+    , m_diskCache(diskCache) {
+    // NV-DXVK start: option snapshots
+    auto onBuildSettingChanged = [this](const auto&) { m_buildSettingsChanged = true; };
+    m_optionCallbacks = {
+      OpacityMicromapOptions::Building::ConservativeEstimation::enableObject().addOnChangeCallback(onBuildSettingChanged),
+      OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangleObject().addOnChangeCallback(onBuildSettingChanged),
+      OpacityMicromapOptions::Building::ConservativeEstimation::minValidOMMTrianglesInMeshPercentageObject().addOnChangeCallback(onBuildSettingChanged),
+      OpacityMicromapOptions::Building::subdivisionLevelObject().addOnChangeCallback(onBuildSettingChanged),
+      OpacityMicromapOptions::Building::enableVertexAndTextureOperationsObject().addOnChangeCallback(onBuildSettingChanged)
+    };
+    // NV-DXVK end
   }
 
   OpacityMicromapManager::~OpacityMicromapManager() { 
+    // NV-DXVK start: option snapshots
+    for (const uint64_t callback : m_optionCallbacks) {
+      RtxOptionImpl::getSnapshotPublisher().removeCallback(callback);
+    }
+    // NV-DXVK end
+
 #ifdef VALIDATION_MODE
     // Delink instances so that the assert on cache data destruction doesn't trigger
     for (auto& sourceData : m_cachedSourceData) {
@@ -569,6 +586,16 @@ namespace dxvk {
       ADVANCED(ImGui::Text("# Baked uTriagles [million]: %.1f", m_numMicroTrianglesBaked / 1e6));
 
       ADVANCED(ImGui::Text("# Built uTriagles [million]: %.1f", m_numMicroTrianglesBuilt / 1e6));
+
+      if (m_diskCache) {
+        const OpacityMicromapDiskCache::Statistics& diskCacheStatistics = m_diskCache->getStatistics();
+        ImGui::Text("Disk cache usage/budget [MB]: %d/%d", m_diskCache->getIndex().getPayloadSize() / (1024 * 1024), m_diskCache->getIndex().getMaxPayloadSize() / (1024 * 1024));
+        ADVANCED(ImGui::Text("# Disk cache items: %d", m_diskCache->getIndex().size()));
+        ADVANCED(ImGui::Text("# Disk cache hits/misses: %d/%d", diskCacheStatistics.numHits, diskCacheStatistics.numMisses));
+        ADVANCED(ImGui::Text("# Disk cache compactions: %d", diskCacheStatistics.numCompactions));
+        ADVANCED(ImGui::Text("# Loaded from disk cache this frame: %d", m_numArraysLoadedFromDiskCache));
+        ADVANCED(ImGui::Text("# Pending disk cache readbacks: %d", m_diskCacheReadbacks.size()));
+      }
       ImGui::Unindent();
     }
 
@@ -589,6 +616,15 @@ namespace dxvk {
       ImGui::Unindent();
     }
 
+    if (ImGui::CollapsingHeader("Disk Cache", collapsingHeaderClosedFlags)) {
+      ImGui::Indent();
+      ImGui::Checkbox("Enable", &OpacityMicromapOptions::DiskCache::enableObject());
+      ImGui::DragInt("Max Size [MB]", &OpacityMicromapOptions::DiskCache::maxSizeMBObject(), 8.f, 0, 256 * 1024, "%d", sliderFlags);
+      ADVANCED(ImGui::DragInt("Max Load Size Per Frame [KB]", &OpacityMicromapOptions::DiskCache::maxLoadSizeKBPerFrameObject(), 64.f, 0, 1024 * 1024, "%d", sliderFlags));
+      ADVANCED(ImGui::DragInt("Max Pending Readbacks", &OpacityMicromapOptions::DiskCache::maxPendingReadbacksObject(), 1.f, 0, 4096, "%d", sliderFlags));
+      ImGui::Unindent();
+    }
+
 
     if (ImGui::CollapsingHeader("Requests Filter", collapsingHeaderClosedFlags)) {
       ImGui::Indent();
@@ -646,7 +682,9 @@ namespace dxvk {
       "\t# Built Items: ", m_builtList.size(), "\n",
       "\t# Cache Items: ", m_ommCache.size(), "\n",
       "\t# Black Listed Items: ", m_blackListedList.size(), "\n",
-      "\tVRAM usage/budget [MB]: ", m_memoryManager.getUsed() / (1024 * 1024), "/", m_memoryManager.getBudget() / (1024 * 1024)));
+      "\tVRAM usage/budget [MB]: ", m_memoryManager.getUsed() / (1024 * 1024), "/", m_memoryManager.getBudget() / (1024 * 1024), "\n",
+      "\t# Disk Cache Items: ", m_diskCache ? m_diskCache->getIndex().size() : 0, "\n",
+      "\t# Disk Cache Hits/Misses: ", m_diskCache ? m_diskCache->getStatistics().numHits : 0, "/", m_diskCache ? m_diskCache->getStatistics().numMisses : 0));
   }
 
   bool OpacityMicromapManager::checkIsOpacityMicromapSupported(DxvkDevice& device) {
@@ -1650,49 +1688,15 @@ namespace dxvk {
     return numTexelsPerMicroTriangleCalculationData->status;
   }
 
-  OpacityMicromapManager::OmmResult OpacityMicromapManager::bakeOpacityMicromapArray(
-    Rc<DxvkContext> ctx,
-    XXH64_hash_t ommSrcHash,
+  OpacityMicromapManager::OmmResult OpacityMicromapManager::allocateOpacityMicromapArray(
     OpacityMicromapCacheItem& ommCacheItem,
-    CachedSourceData& sourceData,
-    const std::vector<TextureRef>& textures,
-    uint32_t& availableBakingBudget) {
-    
-    const RtInstance& instance = *sourceData.getInstance();
-
-    if (!areInstanceTexturesResident(instance, textures)) {
-      return OmmResult::DependenciesUnavailable;
-    }
+    uint32_t numTriangles) {
 
-    // Check if the data has already been calculated
-    NumTexelsPerMicroTriangle* numTexelsPerMicroTriangle;
-    const OmmResult texelBudgetCheckResult = getNumTexelsPerMicroTriangle(instance, &numTexelsPerMicroTriangle);
-    if (texelBudgetCheckResult != OmmResult::Success) {
-      // If the instance hasn't been updated this frame, it means it's kept around by other means 
-      // and NumTexelsPerMicroTriangle won't be able to be generated since the draw calls for it are no longer being issued.
-      // Therefore, let's get rid of the instance being linked to OMMs. We can't call destroyInstance() from within baking call stack, 
-      // since multiple OMM items linked to it may get purged because of it and baking iterates through a list of OMMs.
-      // Instead queue up the instance destruction
-      if (instance.getFrameLastUpdated() != m_device->getCurrentFrameId()) {
-        m_instancesToDestroy.push_back(&instance);
-      }
-      return texelBudgetCheckResult;
-    }
-
-    BlasEntry& blasEntry = *instance.getBlas();
-
-    const uint32_t numTriangles = sourceData.numTriangles;
     const uint32_t numMicroTrianglesPerTriangle = calculateNumMicroTriangles(ommCacheItem.subdivisionLevel);
-    const uint32_t numMicroTriangles = numTriangles * numMicroTrianglesPerTriangle;
     const uint8_t numOpacityMicromapBitsPerMicroTriangle = ommCacheItem.ommFormat == VK_OPACITY_MICROMAP_FORMAT_2_STATE_EXT ? 1 : 2;
     const uint32_t opacityMicromapPerTriangleBufferSize = dxvk::util::ceilDivide(numMicroTrianglesPerTriangle * numOpacityMicromapBitsPerMicroTriangle, 8);
     const uint32_t opacityMicromapBufferSize = numTriangles * opacityMicromapPerTriangleBufferSize;
 
-    omm_validation_assert((usesSplitBillboardOpacityMicromap(instance) || numTriangles == instance.getBlas()->input.getGeometryData().calculatePrimitiveCount()) &&
-                          instance.getBlas()->input.getGeometryData().calculatePrimitiveCount() ==
-                          instance.getBlas()->modifiedGeometryData.calculatePrimitiveCount() &&
-                          "Number of triangles must match and be consistent");
-
     // Preallocate all the device memory needed to build the OMM item
     if (ommCacheItem.getDeviceSize() == 0)
     {
@@ -1718,7 +1722,9 @@ namespace dxvk {
     if (!ommCacheItem.ommArrayBuffer.ptr())
     {
       DxvkBufferCreateInfo ommBufferInfo = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
-      ommBufferInfo.usage = VK_BUFFER_USAGE_MICROMAP_BUILD_INPUT_READ_ONLY_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+      // Transfer usages are needed for loading from and storing to the disk cache
+      ommBufferInfo.usage = VK_BUFFER_USAGE_MICROMAP_BUILD_INPUT_READ_ONLY_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                            VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
       ommBufferInfo.access = VK_ACCESS_SHADER_WRITE_BIT;
       ommBufferInfo.size = opacityMicromapBufferSize;
       ommBufferInfo.requiredAlignmentOverride = 256;
@@ -1730,6 +1736,54 @@ namespace dxvk {
       }
     }
 
+    return OmmResult::Success;
+  }
+
+  OpacityMicromapManager::OmmResult OpacityMicromapManager::bakeOpacityMicromapArray(
+    Rc<DxvkContext> ctx,
+    XXH64_hash_t ommSrcHash,
+    OpacityMicromapCacheItem& ommCacheItem,
+    CachedSourceData& sourceData,
+    const std::vector<TextureRef>& textures,
+    uint32_t& availableBakingBudget) {
+    
+    const RtInstance& instance = *sourceData.getInstance();
+
+    if (!areInstanceTexturesResident(instance, textures)) {
+      return OmmResult::DependenciesUnavailable;
+    }
+
+    // Check if the data has already been calculated
+    NumTexelsPerMicroTriangle* numTexelsPerMicroTriangle;
+    const OmmResult texelBudgetCheckResult = getNumTexelsPerMicroTriangle(instance, &numTexelsPerMicroTriangle);
+    if (texelBudgetCheckResult != OmmResult::Success) {
+      // If the instance hasn't been updated this frame, it means it's kept around by other means 
+      // and NumTexelsPerMicroTriangle won't be able to be generated since the draw calls for it are no longer being issued.
+      // Therefore, let's get rid of the instance being linked to OMMs. We can't call destroyInstance() from within baking call stack, 
+      // since multiple OMM items linked to it may get purged because of it and baking iterates through a list of OMMs.
+      // Instead queue up the instance destruction
+      if (instance.getFrameLastUpdated() != m_device->getCurrentFrameId()) {
+        m_instancesToDestroy.push_back(&instance);
+      }
+      return texelBudgetCheckResult;
+    }
+
+    BlasEntry& blasEntry = *instance.getBlas();
+
+    const uint32_t numTriangles = sourceData.numTriangles;
+
+    omm_validation_assert((usesSplitBillboardOpacityMicromap(instance) || numTriangles == instance.getBlas()->input.getGeometryData().calculatePrimitiveCount()) &&
+                          instance.getBlas()->input.getGeometryData().calculatePrimitiveCount() ==
+                          instance.getBlas()->modifiedGeometryData.calculatePrimitiveCount() &&
+                          "Number of triangles must match and be consistent");
+
+    {
+      const OmmResult allocationResult = allocateOpacityMicromapArray(ommCacheItem, numTriangles);
+      if (allocationResult != OmmResult::Success) {
+        return allocationResult;
+      }
+    }
+
     // Generate OMM array
     {
       RtxGeometryUtils::BakeOpacityMicromapDesc desc(*numTexelsPerMicroTriangle);
@@ -1781,6 +1835,150 @@ namespace dxvk {
     return OmmResult::Success;
   }
 
+  XXH64_hash_t OpacityMicromapManager::calculateBakeSettingsHash(const OpacityMicromapCacheItem& ommCacheItem, const RtInstance& instance) {
+    // Bump this whenever the baking shader's output changes to invalidate OMM arrays stored in the disk cache
+    const uint32_t kBakeVersion = 1;
+
+    // Note: this must mirror the BakeOpacityMicromapDesc setup in bakeOpacityMicromapArray()
+    float resolveTransparencyThreshold = RtxOptions::Get()->getResolveTransparencyThreshold();
+    if ((instance.surface.alphaState.isDecalAndParticleLighting && instance.surface.alphaState.isParticle == false))
+      resolveTransparencyThreshold = std::max(resolveTransparencyThreshold, OpacityMicromapOptions::Building::decalsMinResolveTransparencyThreshold());
+
+    const uint32_t bakeSettings[] = {
+      kBakeVersion,
+      ommCacheItem.subdivisionLevel,
+      static_cast<uint32_t>(ommCacheItem.ommFormat),
+      ommCacheItem.useVertexAndTextureOperations,
+      OpacityMicromapOptions::Building::ConservativeEstimation::enable(),
+      static_cast<uint32_t>(OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle()),
+      bit::cast<uint32_t>(resolveTransparencyThreshold),
+      bit::cast<uint32_t>(RtxOptions::Get()->getResolveOpaquenessThreshold()),
+      static_cast<uint32_t>(instance.getMaterialType())
+    };
+
+    return XXH3_64bits(bakeSettings, sizeof(bakeSettings));
+  }
+
+  OpacityMicromapManager::OmmResult OpacityMicromapManager::loadOpacityMicromapArrayFromDiskCache(
+    Rc<DxvkContext> ctx,
+    XXH64_hash_t ommSrcHash,
+    OpacityMicromapCacheItem& ommCacheItem,
+    CachedSourceData& sourceData,
+    uint32_t& availableLoadBudget) {
+
+    const RtInstance& instance = *sourceData.getInstance();
+    const uint32_t numTriangles = sourceData.numTriangles;
+
+    ommCacheItem.bakeSettingsHash = calculateBakeSettingsHash(ommCacheItem, instance);
+
+    const OpacityMicromapDiskCacheEntry* entry = m_diskCache->find(ommSrcHash, ommCacheItem.bakeSettingsHash, numTriangles);
+
+    if (!entry) {
+      return OmmResult::Failure;
+    }
+
+    // Loads are at per OMM item granularity
+    if (entry->payloadSize > availableLoadBudget) {
+      return OmmResult::OutOfBudget;
+    }
+
+    const OmmResult allocationResult = allocateOpacityMicromapArray(ommCacheItem, numTriangles);
+    if (allocationResult != OmmResult::Success) {
+      return allocationResult;
+    }
+
+    std::vector<uint8_t> ommArray;
+    if (!m_diskCache->read(*entry, ommArray)) {
+      return OmmResult::Failure;
+    }
+
+    if (ommArray.size() != ommCacheItem.ommArrayBuffer->info().size) {
+      ONCE(Logger::warn(str::format("[RTX Opacity Micromap] Ignoring a disk cache entry with an unexpected size for hash ", ommSrcHash, ".")));
+      return OmmResult::Failure;
+    }
+
+    ctx->writeToBuffer(ommCacheItem.ommArrayBuffer, 0, ommArray.size(), ommArray.data());
+    ctx->getCommandList()->trackResource<DxvkAccess::Write>(ommCacheItem.ommArrayBuffer);
+
+    // Mark the array as fully baked
+    const uint32_t numMicroTriangles = numTriangles * calculateNumMicroTriangles(ommCacheItem.subdivisionLevel);
+    ommCacheItem.bakingState.initialized = true;
+    ommCacheItem.bakingState.numTriangles = numTriangles;
+    ommCacheItem.bakingState.numMicroTrianglesToBake = numMicroTriangles;
+    ommCacheItem.bakingState.numMicroTrianglesBaked = numMicroTriangles;
+    ommCacheItem.bakingState.numMicroTrianglesBakedInLastBake = 0;
+
+    availableLoadBudget -= static_cast<uint32_t>(ommArray.size());
+    ++m_numArraysLoadedFromDiskCache;
+
+    return OmmResult::Success;
+  }
+
+  void OpacityMicromapManager::requestDiskCacheReadback(
+    Rc<DxvkContext> ctx,
+    XXH64_hash_t ommSrcHash,
+    const OpacityMicromapCacheItem& ommCacheItem,
+    uint32_t numTriangles) {
+
+    if (m_diskCacheReadbacks.size() >= static_cast<size_t>(std::max(OpacityMicromapOptions::DiskCache::maxPendingReadbacks(), 0))) {
+      return;
+    }
+
+    const VkDeviceSize size = ommCacheItem.ommArrayBuffer->info().size;
+
+    DxvkBufferCreateInfo info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
+    info.size = size;
+    info.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_HOST_BIT;
+    info.access = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_HOST_READ_BIT;
+
+    const VkMemoryPropertyFlags memType =
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+      VK_MEMORY_PROPERTY_HOST_COHERENT_BIT |
+      VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+
+    Rc<DxvkBuffer> readbackBuffer = m_device->createBuffer(info, memType, DxvkMemoryStats::Category::RTXOpacityMicromap, "OMM disk cache readback buffer");
+
+    if (readbackBuffer == nullptr) {
+      return;
+    }
+
+    ctx->copyBuffer(readbackBuffer, 0, ommCacheItem.ommArrayBuffer, 0, size);
+    ctx->emitMemoryBarrier(0,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_PIPELINE_STAGE_HOST_BIT,
+      VK_ACCESS_HOST_READ_BIT);
+
+    m_diskCacheReadbacks.push_back({ ommSrcHash, ommCacheItem.bakeSettingsHash, numTriangles, std::move(readbackBuffer) });
+  }
+
+  void OpacityMicromapManager::storeCompletedDiskCacheReadbacks() {
+    if (!m_diskCache) {
+      return;
+    }
+
+    ScopedCpuProfileZone();
+
+    m_diskCache->setMaxPayloadSize(static_cast<uint64_t>(std::max(OpacityMicromapOptions::DiskCache::maxSizeMB(), 0)) * 1024 * 1024);
+
+    for (auto readbackIter = m_diskCacheReadbacks.begin(); readbackIter != m_diskCacheReadbacks.end(); ) {
+      // The readback buffer is released by the command list once the copy has completed
+      if (readbackIter->buffer->isInUse()) {
+        ++readbackIter;
+        continue;
+      }
+
+      const void* ommArray = readbackIter->buffer->mapPtr(0);
+      if (ommArray) {
+        m_diskCache->store(readbackIter->ommSrcHash, readbackIter->bakeSettingsHash, readbackIter->numTriangles,
+                           ommArray, static_cast<uint32_t>(readbackIter->buffer->info().size));
+      }
+
+      readbackIter = m_diskCacheReadbacks.erase(readbackIter);
+    }
+  }
+
   OpacityMicromapManager::OmmResult OpacityMicromapManager::buildOpacityMicromap(
     Rc<DxvkContext> ctx,
     XXH64_hash_t ommSrcHash,
@@ -1960,6 +2158,8 @@ namespace dxvk {
       availableBakingBudget = UINT32_MAX;
     }
 
+    uint32_t availableDiskCacheLoadBudget = static_cast<uint32_t>(std::max(OpacityMicromapOptions::DiskCache::maxLoadSizeKBPerFrame(), 0)) * 1024;
+
     for (auto ommSrcHashIter = m_unprocessedList.begin(); ommSrcHashIter != m_unprocessedList.end() && availableBakingBudget > 0; ) {
       XXH64_hash_t ommSrcHash = *ommSrcHashIter;
 
@@ -1986,12 +2186,39 @@ namespace dxvk {
       OpacityMicromapCacheItem& ommCacheItem = cacheItemIter->second;
       ommCacheItem.cacheState = OpacityMicromapCacheState::eStep1_Baking;
 
-      OmmResult result = bakeOpacityMicromapArray(ctx, ommSrcHash, ommCacheItem, sourceData, textures, availableBakingBudget);
+      OmmResult result = OmmResult::Failure;
+      bool isLoadedFromDiskCache = false;
+
+      // Try the disk cache first for items that haven't started baking yet
+      if (m_diskCache && !ommCacheItem.bakingState.initialized) {
+        result = loadOpacityMicromapArrayFromDiskCache(ctx, ommSrcHash, ommCacheItem, sourceData, availableDiskCacheLoadBudget);
+        isLoadedFromDiskCache = result == OmmResult::Success;
+
+        if (result == OmmResult::OutOfBudget) {
+          // The array is on disk, so load it in a later frame rather than baking it again
+          ommSrcHashIter++;
+          continue;
+        }
+      }
+
+      // Running out of memory while allocating for a disk cache load is handled like a baking one below,
+      // baking would need the same allocation
+      if (!isLoadedFromDiskCache && result != OmmResult::OutOfMemory) {
+        result = bakeOpacityMicromapArray(ctx, ommSrcHash, ommCacheItem, sourceData, textures, availableBakingBudget);
+      }
 
       if (result == OmmResult::Success) {
         // Use >= as the number of baked micro triangles is aligned up
         if (ommCacheItem.bakingState.numMicroTrianglesBaked >= ommCacheItem.bakingState.numMicroTrianglesToBake) {
 
+          // Store freshly baked arrays to the disk cache
+          if (m_diskCache && !isLoadedFromDiskCache) {
+            if (ommCacheItem.bakeSettingsHash == kEmptyHash) {
+              ommCacheItem.bakeSettingsHash = calculateBakeSettingsHash(ommCacheItem, *sourceData.getInstance());
+            }
+            requestDiskCacheReadback(ctx, ommSrcHash, ommCacheItem, sourceData.numTriangles);
+          }
+
           // Unlink the referenced RtInstance
           sourceData.setInstance(nullptr, m_instanceOmmRequests, *this);
 
@@ -2163,20 +2390,16 @@ namespace dxvk {
     m_numBoundOMMs = 0;
     m_numRequestedOMMBindings = 0;
     m_scratchMemoryUsedThisFrame = 0;
+    m_numArraysLoadedFromDiskCache = 0;
+
+    storeCompletedDiskCacheReadbacks();
 
     // Clear caches if we need to rebuild OMMs
     {
       bool forceRebuildOMMs = OpacityMicromapOptions::enableResetEveryFrame();
-      forceRebuildOMMs |= hasValueChanged(OpacityMicromapOptions::Building::ConservativeEstimation::enable(), 
-                                          m_prevConservativeEstimationEnable);
-      forceRebuildOMMs |= hasValueChanged(OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle(), 
-                                          m_prevConservativeEstimationMaxTexelTapsPerMicroTriangle);
-      forceRebuildOMMs |= hasValueChanged(OpacityMicromapOptions::Building::ConservativeEstimation::minValidOMMTrianglesInMeshPercentage(),
-                                          m_prevConservativeEstimationMinValidOMMTrianglesInMeshPercentage);
-      forceRebuildOMMs |= hasValueChanged(OpacityMicromapOptions::Building::subdivisionLevel(), 
-                                          m_prevBuildingSubdivisionLevel);
-      forceRebuildOMMs |= hasValueChanged(OpacityMicromapOptions::Building::enableVertexAndTextureOperations(), 
-                                          m_prevBuildingEnableVertexAndTextureOperations);
+      // NV-DXVK start: option snapshots
+      forceRebuildOMMs |= m_buildSettingsChanged.exchange(false);
+      // NV-DXVK end
 
       if (forceRebuildOMMs) {
         clear();
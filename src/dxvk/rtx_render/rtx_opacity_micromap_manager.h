@@ -27,6 +27,7 @@
 #include "rtx_option.h"
 #include "rtx_common_object.h"
 #include "rtx_staging.h"
+#include "rtx_opacity_micromap_disk_cache.h"
 #include <vector>
 #include <list>
 #include <unordered_map>
@@ -75,6 +76,25 @@ namespace dxvk {
     };
 
 
+    struct DiskCache {
+      friend class OpacityMicromapManager;
+
+      RTX_OPTION_ENV("rtx.opacityMicromap.diskCache", bool, enable, true, "RTX_OPACITY_MICROMAP_DISK_CACHE_ENABLE",
+                     "Enables persisting baked Opacity Micromap arrays to disk.\n"
+                     "Baked arrays are stored keyed by the Opacity Micromap source hash and are reused across area loads and sessions\n"
+                     "instead of being baked again.");
+      RTX_OPTION("rtx.opacityMicromap.diskCache", int, maxSizeMB, 1024,
+                 "Max size [MB] of baked Opacity Micromap arrays kept in the disk cache. Least recently used arrays are evicted once the cache exceeds this size.");
+      RTX_OPTION("rtx.opacityMicromap.diskCache", int, maxLoadSizeKBPerFrame, 8 * 1024,
+                 "Max size [KB] of baked Opacity Micromap arrays loaded from the disk cache per frame.");
+      RTX_OPTION("rtx.opacityMicromap.diskCache", int, maxPendingReadbacks, 64,
+                 "Max number of freshly baked Opacity Micromap arrays being read back from the GPU for storing in the disk cache at a time.");
+      RTX_OPTION("rtx.opacityMicromap.diskCache", int, flushIntervalSeconds, 300,
+                 "Interval [s] at which newly stored Opacity Micromap arrays are flushed to the disk cache file. The cache is also flushed on area changes and on exit.\n"
+                 "Set to 0 to only flush on area changes and on exit.");
+    };
+
+
     struct BuildRequests {
       friend class OpacityMicromapManager;
 
@@ -264,6 +284,7 @@ namespace dxvk {
     uint16_t subdivisionLevel = UINT16_MAX;
     uint32_t numTriangles = UINT32_MAX;
     VkOpacityMicromapFormatEXT ommFormat = VK_OPACITY_MICROMAP_FORMAT_2_STATE_EXT;
+    XXH64_hash_t bakeSettingsHash = kEmptyHash;   // Baking settings the OMM array was generated with, used for disk cache lookups
     std::list<XXH64_hash_t>::iterator leastRecentlyUsedListIter;
 
     // Iterator to a cache state list for the current cacheState.
@@ -295,6 +316,7 @@ namespace dxvk {
     , useVertexAndTextureOperations(src.useVertexAndTextureOperations)
     , subdivisionLevel(src.subdivisionLevel)
     , ommFormat(src.ommFormat)
+    , bakeSettingsHash(src.bakeSettingsHash)
     , leastRecentlyUsedListIter(src.leastRecentlyUsedListIter)
     , cacheStateListIter(src.cacheStateListIter)
     , isUnprocessedCacheStateListIterValid(src.isUnprocessedCacheStateListIterValid) { }
@@ -362,7 +384,8 @@ namespace dxvk {
       DependenciesUnavailable
     };
 
-    explicit OpacityMicromapManager(DxvkDevice* device);
+    // diskCache is optional and is owned by the caller as it outlives OMM manager resets on camera cuts
+    OpacityMicromapManager(DxvkDevice* device, OpacityMicromapDiskCache* diskCache = nullptr);
     ~OpacityMicromapManager();
 
     void onDestroy();
@@ -474,6 +497,15 @@ namespace dxvk {
 
     Rc<DxvkBuffer> getScratchMemory(const size_t requiredScratchAllocSize);
 
+    OmmResult allocateOpacityMicromapArray(OpacityMicromapCacheItem& ommCacheItem, uint32_t numTriangles);
+
+    // Disk cache
+    static XXH64_hash_t calculateBakeSettingsHash(const OpacityMicromapCacheItem& ommCacheItem, const RtInstance& instance);
+    OmmResult loadOpacityMicromapArrayFromDiskCache(Rc<DxvkContext> ctx, XXH64_hash_t ommSrcHash, OpacityMicromapCacheItem& ommCacheItem,
+                                                    CachedSourceData& sourceData, uint32_t& availableLoadBudget);
+    void requestDiskCacheReadback(Rc<DxvkContext> ctx, XXH64_hash_t ommSrcHash, const OpacityMicromapCacheItem& ommCacheItem, uint32_t numTriangles);
+    void storeCompletedDiskCacheReadbacks();
+
     typedef std::vector<uint16_t> NumTexelsPerMicroTriangle;
     struct NumTexelsPerMicroTriangleCalculationData {
       NumTexelsPerMicroTriangle result;
@@ -556,12 +588,23 @@ namespace dxvk {
     Rc<DxvkBuffer> m_scratchBuffer;
     size_t m_scratchMemoryUsedThisFrame = 0;
 
-    // Prev RtxOption states
-    bool m_prevConservativeEstimationEnable = OpacityMicromapOptions::Building::ConservativeEstimation::enable();
-    int m_prevConservativeEstimationMaxTexelTapsPerMicroTriangle = OpacityMicromapOptions::Building::ConservativeEstimation::maxTexelTapsPerMicroTriangle();
-    float m_prevConservativeEstimationMinValidOMMTrianglesInMeshPercentage = OpacityMicromapOptions::Building::ConservativeEstimation::minValidOMMTrianglesInMeshPercentage();
-    int m_prevBuildingSubdivisionLevel = OpacityMicromapOptions::Building::subdivisionLevel();
-    bool m_prevBuildingEnableVertexAndTextureOperations = OpacityMicromapOptions::Building::enableVertexAndTextureOperations();
+    OpacityMicromapDiskCache* m_diskCache = nullptr;
+
+    // Baked OMM arrays being copied to host memory for storing in the disk cache
+    struct DiskCacheReadback {
+      XXH64_hash_t ommSrcHash;
+      XXH64_hash_t bakeSettingsHash;
+      uint32_t numTriangles;
+      Rc<DxvkBuffer> buffer;
+    };
+    std::vector<DiskCacheReadback> m_diskCacheReadbacks;
+    uint32_t m_numArraysLoadedFromDiskCache = 0;    // Per frame
+
+    // NV-DXVK start: option snapshots
+    // Set from the option change callbacks when a setting the baked OMMs depend on changes
+    std::atomic<bool> m_buildSettingsChanged = { false };
+    std::vector<uint64_t> m_optionCallbacks;
+    // NV-DXVK end
 
     uint32_t m_numTrianglesToCalculateForNumTexelsPerMicroTriangle = 
       OpacityMicromapOptions::Building::ConservativeEstimation::maxTrianglesToCalculateTexelDensityForPerFrame();
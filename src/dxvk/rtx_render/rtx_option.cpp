@@ -25,26 +25,21 @@ namespace dxvk {
   Config RtxOptionImpl::s_startupOptions;
   Config RtxOptionImpl::s_customOptions;
 
-  void fillHashTable(const std::vector<std::string>& rawInput, fast_unordered_set& hashTableOutput) {
-    for (auto&& hashStr : rawInput) {
-      const XXH64_hash_t h = std::stoull(hashStr, nullptr, 16);
+  // NV-DXVK start: hash and integer lists are parsed by the config
+  void fillHashTable(const std::vector<uint64_t>& hashes, fast_unordered_set& hashTableOutput) {
+    for (const uint64_t h : hashes) {
       hashTableOutput.insert(h);
     }
   }
 
-  void fillHashVector(const std::vector<std::string>& rawInput, std::vector<XXH64_hash_t>& hashVectorOutput) {
-    for (auto&& hashStr : rawInput) {
-      const XXH64_hash_t h = std::stoull(hashStr, nullptr, 16);
-      hashVectorOutput.emplace_back(h);
-    }
+  void fillHashVector(const std::vector<uint64_t>& hashes, std::vector<XXH64_hash_t>& hashVectorOutput) {
+    hashVectorOutput.insert(hashVectorOutput.end(), hashes.begin(), hashes.end());
   }
 
-  void fillIntVector(const std::vector<std::string>& rawInput, std::vector<int32_t>& intVectorOutput) {
-    for (auto&& intStr : rawInput) {
-      const int32_t i = std::stoi(intStr);
-      intVectorOutput.emplace_back(i);
-    }
+  void fillIntVector(const std::vector<int32_t>& values, std::vector<int32_t>& intVectorOutput) {
+    intVectorOutput.insert(intVectorOutput.end(), values.begin(), values.end());
   }
+  // NV-DXVK end
 
   std::string hashTableToString(const fast_unordered_set& hashTable) {
     std::stringstream ss;
@@ -157,13 +152,13 @@ namespace dxvk {
       value.f = options.getOption<float>(fullName.c_str(), value.f, env);
       break;
     case OptionType::HashSet:
-      fillHashTable(options.getOption<std::vector<std::string>>(fullName.c_str()), *value.hashSet);
+      fillHashTable(options.getOption<std::vector<uint64_t>>(fullName.c_str()), *value.hashSet);
       break;
     case OptionType::HashVector:
-      fillHashVector(options.getOption<std::vector<std::string>>(fullName.c_str()), *value.hashVector);
+      fillHashVector(options.getOption<std::vector<uint64_t>>(fullName.c_str()), *value.hashVector);
       break;
     case OptionType::IntVector:
-      fillIntVector(options.getOption<std::vector<std::string>>(fullName.c_str()), *value.intVector);
+      fillIntVector(options.getOption<std::vector<int32_t>>(fullName.c_str()), *value.intVector);
       break;
     case OptionType::Vector2:
       *value.v2 = options.getOption<Vector2>(fullName.c_str(), *value.v2, env);
@@ -509,6 +504,14 @@ Tables below enumerate all the options and their defaults set by RTX Remix. Note
     return s_rtxOptions;
   }
 
+  // NV-DXVK start: option snapshots
+  RtxOptionPublisher& RtxOptionImpl::getSnapshotPublisher() {
+    // Options register themselves during static initialization, same as the option map
+    static RtxOptionPublisher s_publisher;
+    return s_publisher;
+  }
+  // NV-DXVK end
+
    bool writeMarkdownDocumentation(const char* outputMarkdownFilePath) {
     return dxvk::RtxOptionImpl::writeMarkdownDocumentation(outputMarkdownFilePath);
   }
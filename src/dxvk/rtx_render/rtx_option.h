@@ -31,6 +31,9 @@
 #include "../util/util_math.h"
 #include "../util/util_env.h"
 #include "rtx_utils.h"
+// NV-DXVK start: option snapshots
+#include "rtx_option_snapshot.h"
+// NV-DXVK end
 
 namespace dxvk {
   // RtxOption refers to a serializable option, which can be of a basic type (i.e. int) or a class type (i.e. vector hash value)
@@ -88,6 +91,9 @@ namespace dxvk {
     OptionType type;
     GenericValue valueList[(int)ValueType::Count];
     uint32_t flags;
+    // NV-DXVK start: option snapshots
+    uint32_t snapshotIndex = UINT32_MAX;
+    // NV-DXVK end
 
     RtxOptionImpl(const char* optionName, const char* optionCategory, const char* optionEnvironment, OptionType optionType, uint32_t optionFlags, const char* optionDescription) :
       name(optionName), 
@@ -124,6 +130,16 @@ namespace dxvk {
     // Returns a global container holding all serializable options
     static RtxOptionMap& getGlobalRtxOptionMap();
 
+    // NV-DXVK start: option snapshots
+    static RtxOptionPublisher& getSnapshotPublisher();
+
+    // Publishes the options changed since the last call, called once per frame
+    // on the thread that writes the options
+    static uint64_t publishSnapshot() { return getSnapshotPublisher().publish(); }
+
+    static std::shared_ptr<const RtxOptionSnapshot> acquireSnapshot() { return getSnapshotPublisher().acquire(); }
+    // NV-DXVK end
+
     // Config object holding start up settings
     static Config s_startupOptions;
     static Config s_customOptions;
@@ -140,6 +156,9 @@ namespace dxvk {
           pImpl->valueList[i].value = 0;
           *reinterpret_cast<BasicType*>(&pImpl->valueList[i].value) = value;
         }
+        // NV-DXVK start: option snapshots
+        pImpl->snapshotIndex = RtxOptionImpl::getSnapshotPublisher().addOption(&getValue());
+        // NV-DXVK end
       }
     }
 
@@ -150,6 +169,9 @@ namespace dxvk {
         for (int i = 0; i < (int)RtxOptionImpl::ValueType::Count; i++) {
           pImpl->valueList[i].pointer = new ClassType(value);
         }
+        // NV-DXVK start: option snapshots
+        pImpl->snapshotIndex = RtxOptionImpl::getSnapshotPublisher().addOption(&getValue());
+        // NV-DXVK end
       }
     }
 
@@ -208,6 +230,26 @@ namespace dxvk {
       setValue(getDefaultValue());
     }
 
+    // NV-DXVK start: option snapshots
+    // Value of the option as of the given snapshot, safe to call from any thread
+    const T& get(const RtxOptionSnapshot& snapshot) const {
+      const T* value = snapshot.get<T>(pImpl->snapshotIndex);
+      // Options created after the snapshot was published fall back to the live value
+      return value != nullptr ? *value : getValue();
+    }
+
+    // Calls the callback on the publishing thread whenever a new value is published.
+    // Returns an id for removeOnChangeCallback().
+    uint64_t addOnChangeCallback(std::function<void(const T&)> callback) const {
+      return RtxOptionImpl::getSnapshotPublisher().addCallback(pImpl->snapshotIndex,
+        [callback = std::move(callback)](const void* value) { callback(*static_cast<const T*>(value)); });
+    }
+
+    static void removeOnChangeCallback(uint64_t id) {
+      RtxOptionImpl::getSnapshotPublisher().removeCallback(id);
+    }
+    // NV-DXVK end
+
     std::string getName() const {
       return pImpl->getFullName();
     }
@@ -261,6 +303,10 @@ namespace dxvk {
         rtxOption.readOption(RtxOptionImpl::s_startupOptions, RtxOptionImpl::ValueType::DefaultValue);
         rtxOption.readOption(RtxOptionImpl::s_customOptions, RtxOptionImpl::ValueType::Value);
       }
+
+      // NV-DXVK start: option snapshots
+      RtxOptionImpl::publishSnapshot();
+      // NV-DXVK end
     }
 
     operator T() const {
@@ -302,7 +348,8 @@ namespace dxvk {
   };
 
   // Checks if value has changed from prevValue and updates prevValue if it did.
-  // This can be used to check if an RtxOption value changed. 
+  // This can be used to check if an RtxOption value changed, though subsystems on other
+  // threads should prefer RtxOption::addOnChangeCallback() over polling the live value. 
   // PrevValue variable should be declared as a local/member variable rather than a static one due to:
   //      Using static variables with local initialization burns a branch predictor slot and 
   //      does an extra memory load from an unrelated chunk of memory 
@@ -0,0 +1,205 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "../../util/thread.h"
+#include "../../util/sync/sync_spinlock.h"
+
+namespace dxvk {
+  // Immutable copy of all published option values. Values that did not change between two
+  // publishes are shared by both snapshots, so a publish only copies the options that changed.
+  struct RtxOptionSnapshot {
+    uint64_t generation = 0;
+    std::vector<std::shared_ptr<const void>> values;
+
+    // Returns nullptr if the option had not been registered when the snapshot was published
+    template<typename T>
+    const T* get(uint32_t index) const {
+      return index < values.size() ? static_cast<const T*>(values[index].get()) : nullptr;
+    }
+  };
+
+  // Publishes the live option values as immutable snapshots.
+  //
+  // Live values are owned by the thread that writes them (the main thread, where ImGui and the
+  // config code run), which calls publish() once per frame. Any other thread reads options through
+  // a snapshot: acquiring one is a pointer copy under a short lock, after which every read is a
+  // plain load from memory nobody writes to, so a frame observes one consistent set of values.
+  //
+  // Subsystems that need to react to a change register a callback instead of polling the value.
+  // Callbacks run on the publishing thread right after the snapshot containing the change became
+  // visible, and must not add options or callbacks, or remove callbacks.
+  class RtxOptionPublisher {
+  public:
+    using CopyFn = std::shared_ptr<const void>(*)(const void* live);
+    using EqualFn = bool(*)(const void* live, const void* published);
+    using Callback = std::function<void(const void* value)>;
+
+    template<typename T>
+    static std::shared_ptr<const void> copyValue(const void* live) {
+      return std::make_shared<const T>(*static_cast<const T*>(live));
+    }
+
+    template<typename T>
+    static bool isEqual(const void* live, const void* published) {
+      // Compare POD types bitwise so that enums and NaNs don't need special handling
+      if constexpr (std::is_pod_v<T>) {
+        return std::memcmp(live, published, sizeof(T)) == 0;
+      } else {
+        return *static_cast<const T*>(live) == *static_cast<const T*>(published);
+      }
+    }
+
+    // Registers the live value of an option and returns its index in the snapshots.
+    // The pointer must stay valid for as long as snapshots are published.
+    template<typename T>
+    uint32_t addOption(const T* live) {
+      return addOption(live, &copyValue<T>, &isEqual<T>);
+    }
+
+    uint32_t addOption(const void* live, CopyFn copy, EqualFn equal) {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_options.push_back({ live, copy, equal });
+      return uint32_t(m_options.size() - 1);
+    }
+
+    // Returns an id to pass to removeCallback(). Once removeCallback() returns, the callback is
+    // not running and won't be called again.
+    uint64_t addCallback(uint32_t index, Callback callback) {
+      std::lock_guard<dxvk::mutex> lock(m_callbackMutex);
+      const uint64_t id = ++m_lastCallbackId;
+      m_callbacks.push_back({ id, index, std::move(callback) });
+      return id;
+    }
+
+    void removeCallback(uint64_t id) {
+      std::lock_guard<dxvk::mutex> lock(m_callbackMutex);
+      for (auto it = m_callbacks.begin(); it != m_callbacks.end(); ++it) {
+        if (it->id == id) {
+          m_callbacks.erase(it);
+          return;
+        }
+      }
+    }
+
+    // Publishes the options whose live value differs from the current snapshot, and notifies
+    // their callbacks. Must be called on the thread writing the live values.
+    // Returns the generation of the current snapshot.
+    uint64_t publish() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      const std::shared_ptr<const RtxOptionSnapshot> prev = acquire();
+
+      std::vector<std::shared_ptr<const void>> values = prev->values;
+      values.resize(m_options.size());
+      m_changed.clear();
+
+      for (uint32_t i = 0; i < m_options.size(); i++) {
+        const Option& option = m_options[i];
+
+        if (values[i] == nullptr || !option.equal(option.live, values[i].get())) {
+          values[i] = option.copy(option.live);
+          m_changed.push_back(i);
+        }
+      }
+
+      if (m_changed.empty()) {
+        return prev->generation;
+      }
+
+      auto next = std::make_shared<RtxOptionSnapshot>();
+      next->generation = prev->generation + 1;
+      next->values = std::move(values);
+
+      {
+        std::lock_guard<sync::Spinlock> snapshotLock(m_snapshotLock);
+        m_snapshot = next;
+      }
+
+      m_generation.store(next->generation, std::memory_order_release);
+
+      std::lock_guard<dxvk::mutex> callbackLock(m_callbackMutex);
+      for (const uint32_t index : m_changed) {
+        for (const CallbackEntry& entry : m_callbacks) {
+          if (entry.index == index) {
+            entry.callback(next->values[index].get());
+          }
+        }
+      }
+
+      return next->generation;
+    }
+
+    std::shared_ptr<const RtxOptionSnapshot> acquire() const {
+      std::lock_guard<sync::Spinlock> lock(m_snapshotLock);
+      return m_snapshot;
+    }
+
+    // Replaces snapshot with the current one if a newer one was published. The check is a single
+    // atomic load, so threads can call this at the start of every work item.
+    bool refresh(std::shared_ptr<const RtxOptionSnapshot>& snapshot) const {
+      if (snapshot != nullptr && snapshot->generation == m_generation.load(std::memory_order_acquire)) {
+        return false;
+      }
+
+      snapshot = acquire();
+      return true;
+    }
+
+    uint64_t getGeneration() const {
+      return m_generation.load(std::memory_order_acquire);
+    }
+
+  private:
+    struct Option {
+      const void* live;
+      CopyFn copy;
+      EqualFn equal;
+    };
+
+    struct CallbackEntry {
+      uint64_t id;
+      uint32_t index;
+      Callback callback;
+    };
+
+    dxvk::mutex m_mutex;
+    std::vector<Option> m_options;
+    std::vector<uint32_t> m_changed;
+
+    mutable sync::Spinlock m_snapshotLock;
+    std::shared_ptr<const RtxOptionSnapshot> m_snapshot = std::make_shared<RtxOptionSnapshot>();
+    std::atomic<uint64_t> m_generation = { 0 };
+
+    dxvk::mutex m_callbackMutex;
+    std::vector<CallbackEntry> m_callbacks;
+    uint64_t m_lastCallbackId = 0;
+  };
+}
@@ -170,6 +170,25 @@ namespace dxvk {
     RTX_OPTION("rtx.gameConfig", uint, customCameraYSpeed, 10, "Vertical speed of custom camera");
     // MHFZ end
 
+    // MHFZ start : shader constant semantics
+    RTX_OPTION("rtx.gameConfig", std::string, shaderConstantSemantics, "",
+               "Table of the shader constants read to extract materials and transforms, empty for the built-in table matching the game's shaders.\n"
+               "Entries are separated by ';' and have the form role,name,register,stages,combine[,unless], e.g. 'ambientColor,gAmbientColor,1,vs,multiply,materialDiffuse|fadeColor'.\n"
+               "The register is used when the shader's constant table doesn't name the constant, stages are vs, ps or vs|ps and combine is none, multiply or powW.\n"
+               "Roles: fadeColor, materialDiffuse, materialAlbedo, ambientColor, materialPower, depthView, lightDirection, worldMatrix, worldTransform.\n"
+               "Read when the device is created.");
+    // MHFZ end
+
+    // MHFZ start : on demand area loading
+    RTX_OPTION("rtx.gameConfig", uint, areaCacheSize, 8,
+               "Maximum number of areas kept loaded, areas edited in the developer menu are kept until they are saved.\n"
+               "Read when the device is created.");
+    RTX_OPTION("rtx.gameConfig", std::string, areaPrefetchGraph, "200:500;173:501;174:501;175:501;256:502",
+               "Areas loaded in the background when entering an area, so that moving to them doesn't wait for their data.\n"
+               "Entries are separated by ';' and have the form area:neighbour|neighbour, e.g. '200:500|501'.\n"
+               "Read when the device is created.");
+    // MHFZ end
+
     RW_RTX_OPTION("rtx", fast_unordered_set, lightmapTextures, {},
                   "Textures used for lightmapping (baked static lighting on surfaces) in older games.\n"
                   "These textures will be ignored when attempting to determine the desired textures from a draw to use for ray tracing.");
@@ -924,6 +943,9 @@ namespace dxvk {
     RTX_OPTION("rtx", float, captureMeshTexcoordDelta, 0.3f, "Inter-frame texcoord min delta warrants new time sample.");
     RTX_OPTION("rtx", float, captureMeshColorDelta, 0.3f, "Inter-frame color min delta warrants new time sample.");
     RTX_OPTION("rtx", float, captureMeshBlendWeightDelta, 0.01f, "Inter-frame blend weight min delta warrants new time sample.");
+    RTX_OPTION("rtx", bool, captureMeshSparseDeltas, false,
+               "Stores time samples in which only a few elements of a mesh buffer changed as sparse deltas, which are expanded back into full buffers at export time.\n"
+               "Reduces the memory used by long captures of animated meshes, the exported time samples are unchanged.");
 
     RTX_OPTION("rtx", bool, useVirtualShadingNormalsForDenoising, true,
                "A flag to enable or disable the usage of virtual shading normals for denoising passes.\n"
@@ -1382,6 +1404,7 @@ namespace dxvk {
     float getCaptureMeshTexcoordDelta() const { return captureMeshTexcoordDelta(); }
     float getCaptureMeshColorDelta() const { return captureMeshColorDelta(); }
     float getCaptureMeshBlendWeightDelta() const { return captureMeshBlendWeightDelta(); }
+    bool getCaptureMeshSparseDeltas() const { return captureMeshSparseDeltas(); }
     
     bool isUseVirtualShadingNormalsForDenoisingEnabled() const { return useVirtualShadingNormalsForDenoising(); }
     bool isResetDenoiserHistoryOnSettingsChangeEnabled() const { return resetDenoiserHistoryOnSettingsChange(); }
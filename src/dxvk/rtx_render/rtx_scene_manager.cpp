@@ -25,6 +25,8 @@
 #include "rtx_asset_replacer.h"
 #include "rtx_scene_manager.h"
 #include "rtx_opacity_micromap_manager.h"
+#include "rtx_opacity_micromap_disk_cache.h"
+#include "../../util/util_filesys.h"
 #include "dxvk_device.h"
 #include "dxvk_context.h"
 #include "dxvk_buffer.h"
@@ -61,6 +63,8 @@ namespace dxvk {
     , m_cameraManager(device)
     , m_startTime(std::chrono::steady_clock::now())
     , m_uniqueObjectSearchDistance(RtxOptions::uniqueObjectDistance()) {
+    m_stagingAlloc = std::make_unique<RtxStagingDataAlloc>(device, "RtxStagingDataAlloc: Scene Material Tables");
+
     InstanceEventHandler instanceEvents(this);
     instanceEvents.onInstanceAddedCallback = [this](RtInstance& instance) { onInstanceAdded(instance); };
     instanceEvents.onInstanceUpdatedCallback = [this](RtInstance& instance, const RtSurfaceMaterial& material, bool hasTransformChanged, bool hasVerticesChanged) { onInstanceUpdated(instance, material, hasTransformChanged, hasVerticesChanged); };
@@ -184,8 +188,8 @@ namespace dxvk {
 
     const size_t oldestFrame = m_device->getCurrentFrameId() - RtxOptions::Get()->numFramesToKeepGeometryData();
     auto blasEntryGarbageCollection = [&](auto& iter, auto& entries) -> void {
-      if (iter->second.frameLastTouched < oldestFrame) {
-        onSceneObjectDestroyed(iter->second);
+      if (iter->frameLastTouched < oldestFrame) {
+        onSceneObjectDestroyed(*iter);
         iter = entries.erase(iter);
       } else {
         ++iter;
@@ -210,7 +214,7 @@ namespace dxvk {
       auto& entries = m_drawCallCache.getEntries();
       for (auto iter = entries.begin(); iter != entries.end();) {
         bool isAllInstancesInCurrentBlasInsideFrustum = true;
-        for (const RtInstance* instance : iter->second.getLinkedInstances()) {
+        for (const RtInstance* instance : iter->getLinkedInstances()) {
           const Matrix4 objectToView = getCamera().getWorldToView(false) * instance->getTransform();
 
           bool isInsideFrustum = true;
@@ -289,6 +293,9 @@ namespace dxvk {
     if (m_opacityMicromapManager) {
       m_opacityMicromapManager->onDestroy();
     }
+    if (m_opacityMicromapDiskCache) {
+      m_opacityMicromapDiskCache->flush(true);
+    }
   }
 
   template<bool isNew>
@@ -447,6 +454,8 @@ namespace dxvk {
 
     manageTextureVram();
 
+    flushOpacityMicromapDiskCache();
+
     if (m_enqueueDelayedClear || m_pReplacer->checkForChanges(ctx)) {
       clear(ctx, true);
       m_enqueueDelayedClear = false;
@@ -488,6 +497,33 @@ namespace dxvk {
     m_preCreationSurfaceMaterialMap.clear();
   }
 
+  void SceneManager::flushOpacityMicromapDiskCache() {
+    if (!m_opacityMicromapDiskCache) {
+      return;
+    }
+
+    // Flush on area changes and camera cuts, which usually coincide with loading screens, and
+    // periodically otherwise so a crash doesn't lose every array stored during a long session
+    const uint32_t areaId = m_device->getAreaManager().getCurrentAreaID();
+    const auto now = std::chrono::steady_clock::now();
+    const int flushIntervalSeconds = OpacityMicromapOptions::DiskCache::flushIntervalSeconds();
+
+    const bool areaChanged = areaId != m_opacityMicromapDiskCacheAreaId;
+    const bool intervalElapsed = flushIntervalSeconds > 0 &&
+      now - m_opacityMicromapDiskCacheFlushTime >= std::chrono::seconds(flushIntervalSeconds);
+
+    if (!areaChanged && !intervalElapsed && !m_enqueueDelayedClear) {
+      return;
+    }
+
+    m_opacityMicromapDiskCacheAreaId = areaId;
+    m_opacityMicromapDiskCacheFlushTime = now;
+
+    if (m_opacityMicromapDiskCache->isDirty()) {
+      m_opacityMicromapDiskCache->flush();
+    }
+  }
+
   void SceneManager::onFrameEndNoRTX() {
     m_cameraManager.onFrameEnd();
     m_instanceManager.onFrameEnd();
@@ -1020,6 +1056,7 @@ namespace dxvk {
     // MHFZ start : spawn area particle systems
     AreaManager& areaManager = m_device->getAreaManager();
     if (areaManager.isParticleSystemFetched() == false) {
+      auto areaLock = areaManager.lockCurrentArea();
       auto& particleSystems = areaManager.getCurrentParticleSystemList();
       RtxParticleSystemManager& particleSystem = device()->getCommon()->metaParticleSystem();
       uint32_t index = 0;
@@ -1645,7 +1682,15 @@ namespace dxvk {
         if (m_opacityMicromapManager.get())
           m_instanceManager.removeEventHandler(m_opacityMicromapManager.get());
 
-        m_opacityMicromapManager = std::make_unique<OpacityMicromapManager>(m_device);
+        if (OpacityMicromapOptions::DiskCache::enable() && !m_opacityMicromapDiskCache) {
+          const std::string diskCachePath = (util::RtxFileSys::path(util::RtxFileSys::Caches) / "opacity_micromaps.rtxcache").string();
+          const uint64_t maxDiskCacheSize = static_cast<uint64_t>(std::max(OpacityMicromapOptions::DiskCache::maxSizeMB(), 0)) * 1024 * 1024;
+          m_opacityMicromapDiskCache = std::make_unique<OpacityMicromapDiskCache>(diskCachePath, maxDiskCacheSize);
+          m_opacityMicromapDiskCache->load();
+        }
+
+        m_opacityMicromapManager = std::make_unique<OpacityMicromapManager>(m_device,
+          OpacityMicromapOptions::DiskCache::enable() ? m_opacityMicromapDiskCache.get() : nullptr);
         m_instanceManager.addEventHandler(m_opacityMicromapManager->getInstanceEventHandler());
         Logger::info("[RTX] Opacity Micromap: enabled");
       }
@@ -1675,8 +1720,9 @@ namespace dxvk {
     // Build the TLAS
     m_accelManager.buildTlas(ctx);
 
-    // Todo: These updates require a lot of temporary buffer allocations and memcopies, ideally we should memcpy directly into a mapped pointer provided by Vulkan,
-    // but we have to create a buffer to pass to DXVK's updateBuffer for now.
+    // The material tables are kept as CPU copies, only the elements that changed since the last frame are rewritten
+    // and uploaded (coalesced into as few copies as possible) through the staging allocator.
+    size_t materialUploadBytes = 0;
     {
       // Allocate the instance buffer and copy its contents from host to device memory
       DxvkBufferCreateInfo info = { VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO };
@@ -1684,6 +1730,25 @@ namespace dxvk {
       info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR;
       info.access = VK_ACCESS_TRANSFER_WRITE_BIT;
 
+      // The translucent and opaque material encodings depend on these options rather than just on the cached material
+      const bool diffuseLayerOverrideChanged = hasValueChanged(getEnableDiffuseLayerOverrideHack(), m_prevEnableDiffuseLayerOverride);
+      const bool displacementFactorChanged = hasValueChanged(RtxOptions::Displacement::displacementFactor(), m_prevDisplacementFactor);
+      if (diffuseLayerOverrideChanged || displacementFactorChanged) {
+        m_surfaceMaterialTable.tracker.invalidate();
+        m_surfaceMaterialExtensionTable.tracker.invalidate();
+      }
+
+      auto prepareTable = [&](GpuTableState& table, Rc<DxvkBuffer>& buffer, size_t size, size_t stride, const char* name) {
+        info.size = align(size, kBufferAlignment);
+        info.usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+        if (buffer == nullptr || info.size > buffer->info().size) {
+          buffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXBuffer, name);
+          table.tracker.invalidate();
+        }
+        table.data.resize(size);
+        table.tracker.beginFrame(static_cast<uint32_t>(size / stride));
+      };
+
       // Surface Material buffer
       if (m_surfaceMaterialCache.getTotalCount() > 0) {
         ScopedGpuProfileZone(ctx, "updateSurfaceMaterials");
@@ -1693,32 +1758,33 @@ namespace dxvk {
           surfaceMaterialsGPUSize += kSurfaceMaterialGPUSize;
         }
 
-        info.size = align(surfaceMaterialsGPUSize, kBufferAlignment);
-        info.usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-        if (m_surfaceMaterialBuffer == nullptr || info.size > m_surfaceMaterialBuffer->info().size) {
-          m_surfaceMaterialBuffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXBuffer, "Surface Material Buffer");
-        }
+        prepareTable(m_surfaceMaterialTable, m_surfaceMaterialBuffer, surfaceMaterialsGPUSize, kSurfaceMaterialGPUSize, "Surface Material Buffer");
+
+        // The tag of each surface is the cache slot and generation of the material it references
+        auto writeSurfaceMaterial = [&](uint32_t surfaceIndex, uint32_t indexInCache) {
+          const uint64_t tag = uint64_t(indexInCache) << 32 | m_surfaceMaterialCache.getGeneration(indexInCache);
+          if (m_surfaceMaterialTable.tracker.update(surfaceIndex, tag)) {
+            std::size_t dataOffset = surfaceIndex * kSurfaceMaterialGPUSize;
+            m_surfaceMaterialCache.getObjectTable()[indexInCache].writeGPUData(m_surfaceMaterialTable.data.data(), dataOffset, surfaceIndex);
+            assert(dataOffset == (surfaceIndex + 1) * kSurfaceMaterialGPUSize);
+          }
+        };
 
-        std::size_t dataOffset = 0;
         uint16_t surfaceIndex = 0;
-        std::vector<unsigned char> surfaceMaterialsGPUData(surfaceMaterialsGPUSize);
         for (auto&& pInstance : m_accelManager.getOrderedInstances()) {
-          auto&& surfaceMaterial = m_surfaceMaterialCache.getObjectTable()[pInstance->surface.surfaceMaterialIndex];
-          surfaceMaterial.writeGPUData(surfaceMaterialsGPUData.data(), dataOffset, surfaceIndex);
+          writeSurfaceMaterial(surfaceIndex, pInstance->surface.surfaceMaterialIndex);
           surfaceIndex++;
         }
 
         if (m_startInMediumMaterialIndex_inCache != UINT32_MAX) {
-          auto&& surfaceMaterial = m_surfaceMaterialCache.getObjectTable()[m_startInMediumMaterialIndex_inCache];
-          surfaceMaterial.writeGPUData(surfaceMaterialsGPUData.data(), dataOffset, surfaceIndex);
+          writeSurfaceMaterial(surfaceIndex, m_startInMediumMaterialIndex_inCache);
           m_startInMediumMaterialIndex = surfaceIndex;
           surfaceIndex++;
         }
 
-        assert(dataOffset == surfaceMaterialsGPUSize);
-        assert(surfaceMaterialsGPUData.size() == surfaceMaterialsGPUSize);
+        assert(surfaceIndex * kSurfaceMaterialGPUSize == surfaceMaterialsGPUSize);
 
-        ctx->writeToBuffer(m_surfaceMaterialBuffer, 0, surfaceMaterialsGPUData.size(), surfaceMaterialsGPUData.data());
+        materialUploadBytes += m_surfaceMaterialTable.tracker.upload(ctx, *m_stagingAlloc, m_surfaceMaterialBuffer, m_surfaceMaterialTable.data.data(), kSurfaceMaterialGPUSize);
       }
 
       // Surface Material Extension Buffer
@@ -1726,25 +1792,16 @@ namespace dxvk {
         ScopedGpuProfileZone(ctx, "updateSurfaceMaterialExtensions");
         const auto surfaceMaterialExtensionsGPUSize = m_surfaceMaterialExtensionCache.getTotalCount() * kSurfaceMaterialGPUSize;
 
-        info.size = align(surfaceMaterialExtensionsGPUSize, kBufferAlignment);
-        info.usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-        if (m_surfaceMaterialExtensionBuffer == nullptr || info.size > m_surfaceMaterialExtensionBuffer->info().size) {
-          m_surfaceMaterialExtensionBuffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXBuffer, "Surface Material Extension Buffer");
-        }
-
-        std::size_t dataOffset = 0;
-        std::vector<unsigned char> surfaceMaterialExtensionsGPUData(surfaceMaterialExtensionsGPUSize);
+        prepareTable(m_surfaceMaterialExtensionTable, m_surfaceMaterialExtensionBuffer, surfaceMaterialExtensionsGPUSize, kSurfaceMaterialGPUSize, "Surface Material Extension Buffer");
 
-        uint16_t surfaceIndex = 0;
-        for (auto&& surfaceMaterialExtension : m_surfaceMaterialExtensionCache.getObjectTable()) {
-          surfaceMaterialExtension.writeGPUData(surfaceMaterialExtensionsGPUData.data(), dataOffset, surfaceIndex);
-          surfaceIndex++;
+        for (uint32_t i = 0; i < m_surfaceMaterialExtensionCache.getTotalCount(); ++i) {
+          if (m_surfaceMaterialExtensionTable.tracker.update(i, m_surfaceMaterialExtensionCache.getGeneration(i))) {
+            std::size_t dataOffset = i * kSurfaceMaterialGPUSize;
+            m_surfaceMaterialExtensionCache.getObjectTable()[i].writeGPUData(m_surfaceMaterialExtensionTable.data.data(), dataOffset, i);
+          }
         }
 
-        assert(dataOffset == surfaceMaterialExtensionsGPUSize);
-        assert(surfaceMaterialExtensionsGPUData.size() == surfaceMaterialExtensionsGPUSize);
-
-        ctx->writeToBuffer(m_surfaceMaterialExtensionBuffer, 0, surfaceMaterialExtensionsGPUData.size(), surfaceMaterialExtensionsGPUData.data());
+        materialUploadBytes += m_surfaceMaterialExtensionTable.tracker.upload(ctx, *m_stagingAlloc, m_surfaceMaterialExtensionBuffer, m_surfaceMaterialExtensionTable.data.data(), kSurfaceMaterialGPUSize);
       }
 
       // Volume Material buffer
@@ -1752,23 +1809,16 @@ namespace dxvk {
         ScopedGpuProfileZone(ctx, "updateVolumeMaterials");
         const auto volumeMaterialsGPUSize = m_volumeMaterialCache.getTotalCount() * kVolumeMaterialGPUSize;
 
-        info.size = align(volumeMaterialsGPUSize, kBufferAlignment);
-        info.usage |= VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-        if (m_volumeMaterialBuffer == nullptr || info.size > m_volumeMaterialBuffer->info().size) {
-          m_volumeMaterialBuffer = m_device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, DxvkMemoryStats::Category::RTXBuffer, "Volume Material Buffer");
-        }
-
-        std::size_t dataOffset = 0;
-        std::vector<unsigned char> volumeMaterialsGPUData(volumeMaterialsGPUSize);
+        prepareTable(m_volumeMaterialTable, m_volumeMaterialBuffer, volumeMaterialsGPUSize, kVolumeMaterialGPUSize, "Volume Material Buffer");
 
-        for (auto&& volumeMaterial : m_volumeMaterialCache.getObjectTable()) {
-          volumeMaterial.writeGPUData(volumeMaterialsGPUData.data(), dataOffset);
+        for (uint32_t i = 0; i < m_volumeMaterialCache.getTotalCount(); ++i) {
+          if (m_volumeMaterialTable.tracker.update(i, m_volumeMaterialCache.getGeneration(i))) {
+            std::size_t dataOffset = i * kVolumeMaterialGPUSize;
+            m_volumeMaterialCache.getObjectTable()[i].writeGPUData(m_volumeMaterialTable.data.data(), dataOffset);
+          }
         }
 
-        assert(dataOffset == volumeMaterialsGPUSize);
-        assert(volumeMaterialsGPUData.size() == volumeMaterialsGPUSize);
-
-        ctx->writeToBuffer(m_volumeMaterialBuffer, 0, volumeMaterialsGPUData.size(), volumeMaterialsGPUData.data());
+        materialUploadBytes += m_volumeMaterialTable.tracker.upload(ctx, *m_stagingAlloc, m_volumeMaterialBuffer, m_volumeMaterialTable.data.data(), kVolumeMaterialGPUSize);
       }
     }
 
@@ -1788,6 +1838,7 @@ namespace dxvk {
     m_device->statCounters().setCtr(DxvkStatCounter::RtxVolumeMaterialCount, m_volumeMaterialCache.getActiveCount());
     m_device->statCounters().setCtr(DxvkStatCounter::RtxLightCount, m_lightManager.getActiveCount());
     m_device->statCounters().setCtr(DxvkStatCounter::RtxSamplers, m_samplerCache.getActiveCount());
+    m_device->statCounters().setCtr(DxvkStatCounter::RtxSceneDataUploadBytes, materialUploadBytes + m_accelManager.getSurfaceUploadBytes());
 
     auto capturer = m_device->getCommon()->capturer();
     if (m_device->getCurrentFrameId() == m_beginUsdExportFrameNum) {
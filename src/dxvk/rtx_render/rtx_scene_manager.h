@@ -41,6 +41,7 @@
 #include "rtx_camera_manager.h"
 #include "rtx_draw_call_cache.h"
 #include "rtx_sparse_unique_cache.h"
+#include "rtx_dirty_range_tracker.h"
 #include "rtx_light_manager.h"
 #include "rtx_instance_manager.h"
 #include "rtx_accel_manager.h"
@@ -57,6 +58,7 @@ class DxvkDevice;
 struct AssetReplacement;
 struct AssetReplacer;
 class OpacityMicromapManager;
+class OpacityMicromapDiskCache;
 class TerrainBaker;
 
 // The resource cache can be *searched* by other users
@@ -222,6 +224,8 @@ public:
   void manageTextureVram();
 
 private:
+  void flushOpacityMicromapDiskCache();
+
   enum class ObjectCacheState
   {
     kUpdateInstance = 0,
@@ -278,6 +282,10 @@ private:
   RayPortalManager m_rayPortalManager;
   BindlessResourceManager m_bindlessResourceManager;
   std::unique_ptr<OpacityMicromapManager> m_opacityMicromapManager;
+  // Outlives OMM manager resets on camera cuts so baked OMM arrays can be reused across area loads
+  std::unique_ptr<OpacityMicromapDiskCache> m_opacityMicromapDiskCache;
+  uint32_t m_opacityMicromapDiskCacheAreaId = UINT32_MAX;
+  std::chrono::time_point<std::chrono::steady_clock> m_opacityMicromapDiskCacheFlushTime;
 
   DrawCallCache m_drawCallCache;
 
@@ -297,6 +305,18 @@ private:
   Rc<DxvkBuffer> m_surfaceMaterialExtensionBuffer;
   Rc<DxvkBuffer> m_volumeMaterialBuffer;
 
+  // CPU copies of the material buffers, only the dirty ranges are rewritten and uploaded each frame
+  struct GpuTableState {
+    std::vector<uint8_t> data;
+    DirtyRangeTracker tracker;
+  };
+  GpuTableState m_surfaceMaterialTable;
+  GpuTableState m_surfaceMaterialExtensionTable;
+  GpuTableState m_volumeMaterialTable;
+  std::unique_ptr<RtxStagingDataAlloc> m_stagingAlloc;
+  bool m_prevEnableDiffuseLayerOverride = false;
+  float m_prevDisplacementFactor = 1.0f;
+
   uint32_t m_currentFrameIdx = -1;
   bool m_useFixedFrameTime = false;
   std::chrono::time_point<std::chrono::steady_clock> m_startTime;
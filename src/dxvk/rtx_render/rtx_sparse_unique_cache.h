@@ -22,9 +22,10 @@
 #pragma once
 
 #include <vector>
-#include <queue>
 #include <unordered_map>
 
+#include "../../util/util_fast_cache.h"
+
 namespace dxvk 
 {
 /*
@@ -50,6 +51,13 @@ namespace dxvk
 *  This structure is particularly useful for tracking GPU objects, where persistent
 *  indices for large, dynamic arrays are required.  e.g. bindless resources.
 * 
+*  Lookups only index the hash of an object, objects with colliding hashes are chained
+*  and resolved with KeyEqual against the stored object, so the index never holds copies
+*  of T.  Each slot carries a generation which is renewed every time the slot is
+*  (re)populated or freed.  Generations are unique across the lifetime of the cache
+*  (including clears), so they can be used to detect which slots changed since a
+*  previous frame.
+* 
 *  NOTE: This object does no ref counting - its expected that the user supply T 
    as a ref-counted object if that behavior is desired.
 */
@@ -64,59 +72,143 @@ public:
   ~SparseUniqueCache() {}
 
   void clear() {
-    m_freeBuffers = {};
     m_objects.clear();
-    m_bufferMap.clear();
+    m_slots.clear();
+    m_hashIndex.clear();
+    m_freeHead = kInvalidIndex;
+    m_freeTail = kInvalidIndex;
+    m_freeCount = 0;
+  }
+
+  uint32_t track(const T& obj) {
+    return track(obj, [](const T& in) -> const T& { return in; });
   }
 
-  uint32_t track(const T& obj, std::function<T(const T&)> onFirstCache = [](const T& in) { return in; }) {
-    uint32_t idx;
-    if (!find(obj, idx)) {
-      const T& objectToCache = onFirstCache(obj);
-      if (!m_freeBuffers.empty()) {
-        idx = m_freeBuffers.front();
-        m_freeBuffers.pop();
-        m_objects.at(idx) = objectToCache;
-      } else {
-        idx = m_objects.size();
-        m_objects.push_back(objectToCache);
+  // onFirstCache is called with obj when it is not yet tracked, and returns the object to store
+  template<typename OnFirstCache>
+  uint32_t track(const T& obj, OnFirstCache&& onFirstCache) {
+    const size_t hash = HashFn()(obj);
+    uint32_t idx = findWithHash(obj, hash);
+    if (idx != kInvalidIndex) {
+      return idx;
+    }
+
+    if (m_freeHead != kInvalidIndex) {
+      idx = m_freeHead;
+      m_freeHead = m_slots[idx].next;
+      if (m_freeHead == kInvalidIndex) {
+        m_freeTail = kInvalidIndex;
       }
-      m_bufferMap.insert({ objectToCache, idx });
+      --m_freeCount;
+      m_objects[idx] = onFirstCache(obj);
+    } else {
+      idx = m_objects.size();
+      m_objects.push_back(onFirstCache(obj));
+      m_slots.emplace_back();
     }
+
+    // Note: the hash of the cached object is what the index is keyed on, as onFirstCache may alter it
+    Slot& slot = m_slots[idx];
+    slot.hash = HashFn()(m_objects[idx]);
+    slot.generation = ++m_generationCounter;
+
+    auto [iter, inserted] = m_hashIndex.try_emplace(slot.hash, idx);
+    slot.next = inserted ? kInvalidIndex : iter->second;
+    iter->second = idx;
     return idx;
   }
 
   bool find(const T& buf, uint32_t& outIdx) const {
-    const auto& vtxBuffer = m_bufferMap.find(buf);
-    if (vtxBuffer != m_bufferMap.end()) {
-      outIdx = vtxBuffer->second;
+    const uint32_t idx = findWithHash(buf, HashFn()(buf));
+    if (idx != kInvalidIndex) {
+      outIdx = idx;
       return true;
     }
     return false;
   }
 
   void free(const T& buf) {
-    auto iter = m_bufferMap.find(buf);
-    if (iter != m_bufferMap.end()) {
-      m_objects.at(iter->second) = T();
-      m_freeBuffers.push(iter->second);
-      m_bufferMap.erase(iter);
+    const size_t hash = HashFn()(buf);
+    auto iter = m_hashIndex.find(hash);
+    if (iter == m_hashIndex.end()) {
+      return;
+    }
+
+    // Unlink from the hash chain
+    uint32_t prev = kInvalidIndex;
+    uint32_t idx = iter->second;
+    while (idx != kInvalidIndex && !KeyEqual()(m_objects[idx], buf)) {
+      prev = idx;
+      idx = m_slots[idx].next;
+    }
+    if (idx == kInvalidIndex) {
+      return;
+    }
+    if (prev != kInvalidIndex) {
+      m_slots[prev].next = m_slots[idx].next;
+    } else if (m_slots[idx].next != kInvalidIndex) {
+      iter->second = m_slots[idx].next;
+    } else {
+      m_hashIndex.erase(iter);
     }
+
+    m_objects[idx] = T();
+
+    // Append to the free list, the vacated slot holds the link
+    Slot& slot = m_slots[idx];
+    slot.generation = ++m_generationCounter;
+    slot.next = kInvalidIndex;
+    if (m_freeTail != kInvalidIndex) {
+      m_slots[m_freeTail].next = idx;
+    } else {
+      m_freeHead = idx;
+    }
+    m_freeTail = idx;
+    ++m_freeCount;
   }
 
-  uint32_t getActiveCount() const { return m_objects.size() - m_freeBuffers.size(); }
+  uint32_t getActiveCount() const { return m_objects.size() - m_freeCount; }
   uint32_t getTotalCount() const { return m_objects.size(); }
 
+  // Note: modifying an object through at() does not bump its generation
   T& at(const uint32_t i) { return m_objects[i]; }
+
+  uint32_t getGeneration(const uint32_t i) const { return m_slots[i].generation; }
   
   const std::vector<T>& getObjectTable() const { return m_objects; }
   std::vector<T>& getObjectTable() { return m_objects; }
 
 private:
-  std::queue<uint32_t> m_freeBuffers;
+  static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+  struct Slot {
+    size_t hash = 0;
+    // Next slot with the same hash while tracked, next free slot while vacated
+    uint32_t next = kInvalidIndex;
+    uint32_t generation = 0;
+  };
+
+  uint32_t findWithHash(const T& obj, const size_t hash) const {
+    auto iter = m_hashIndex.find(hash);
+    if (iter == m_hashIndex.end()) {
+      return kInvalidIndex;
+    }
+    for (uint32_t idx = iter->second; idx != kInvalidIndex; idx = m_slots[idx].next) {
+      if (KeyEqual()(m_objects[idx], obj)) {
+        return idx;
+      }
+    }
+    return kInvalidIndex;
+  }
+
   std::vector<T> m_objects;
-  std::unordered_map<T, uint32_t, HashFn, KeyEqual> m_bufferMap;
+  std::vector<Slot> m_slots;
+  std::unordered_map<size_t, uint32_t, XXH64_hash_passthrough> m_hashIndex;
+  uint32_t m_freeHead = kInvalidIndex;
+  uint32_t m_freeTail = kInvalidIndex;
+  uint32_t m_freeCount = 0;
+  // Not reset on clear, so generations are never reused
+  uint32_t m_generationCounter = 0;
 };
 
 }  // namespace dxvk
-
@@ -21,6 +21,7 @@
 */
 #include "game_exporter.h"
 #include "game_exporter_common.h"
+#include "game_exporter_reduce.h"
 #include "mdl_helpers.h"
 #include "../util/log/log.h"
 #include "../util/util_env.h"
@@ -74,6 +75,7 @@
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <thread>
 
 // Embedded MDLs
 #include <AperturePBR_Opacity.mdl.h>
@@ -165,11 +167,53 @@ lss::Skeleton generateSkeleton(const size_t numBones,
   return output;
 }
 
+// Assets in the order they are authored to the instance stage, which keeps the export deterministic
+// no matter which order the workers finish in.
+template<typename T>
+std::vector<std::pair<lss::Id, const T*>> gatherAssets(const lss::IdMap<T>& assets) {
+  std::vector<std::pair<lss::Id, const T*>> gathered;
+  gathered.reserve(assets.size());
+  for (const auto& [id, asset] : assets) {
+    gathered.emplace_back(id, &asset);
+  }
+  return gathered;
+}
+
+// Calls job(i) for every i in [0, count), spread over up to numThreads threads including the calling one.
+template<typename JobFn>
+void parallelFor(const size_t count, const uint32_t numThreads, const JobFn& job) {
+  const size_t numWorkers = std::min<size_t>(numThreads, count);
+  if (numWorkers <= 1) {
+    for (size_t i = 0; i < count; ++i) {
+      job(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> nextJob = 0;
+  auto worker = [&]() {
+    for (size_t i = nextJob++; i < count; i = nextJob++) {
+      job(i);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(numWorkers - 1);
+  for (size_t i = 1; i < numWorkers; ++i) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
 }
 
 namespace lss {
 
 bool GameExporter::s_bMultiThreadSafety = false;
+uint32_t GameExporter::s_numWorkerThreads = 0;
 std::mutex GameExporter::s_mutex;
 
 std::string computeLocalPath(const std::string& assetPath) {  
@@ -179,12 +223,12 @@ std::string computeLocalPath(const std::string& assetPath) {
   return resolvedPath.GetPathString();
 }
 
-void GameExporter::exportUsd(const Export& exportData) {
+bool GameExporter::exportUsd(const Export& exportData, ExportProgress* pProgress) {
   if(s_bMultiThreadSafety) {
     std::scoped_lock lock(s_mutex);
-    exportUsdInternal(exportData);
+    return exportUsdInternal(exportData, pProgress);
   } else {
-    exportUsdInternal(exportData);
+    return exportUsdInternal(exportData, pProgress);
   }
 }
 
@@ -192,27 +236,45 @@ std::string getExtension(std::filesystem::path path) {
   return path.extension().generic_string();
 }
 
-void GameExporter::exportUsdInternal(const Export& exportData) {
+bool GameExporter::exportUsdInternal(const Export& exportData, ExportProgress* pProgress) {
   dxvk::Logger::info("[GameExporter][" + exportData.debugId + "] Export start");
   ExportContext ctx;
+  ctx.pProgress = pProgress;
+  ctx.numThreads = (s_numWorkerThreads > 0) ? s_numWorkerThreads : std::max(std::thread::hardware_concurrency(), 1u);
+  if (pProgress != nullptr) {
+    size_t numSkeletons = 0;
+    for (const auto& [meshId, mesh] : exportData.meshes) {
+      numSkeletons += (mesh.numBones > 0) ? 1 : 0;
+    }
+    const size_t numSphereLights = (exportData.bExportInstanceStage) ? exportData.sphereLights.size() : 0;
+    pProgress->numAssetsExported = 0;
+    pProgress->numAssetsTotal = exportData.materials.size() + exportData.meshes.size() + numSkeletons + numSphereLights;
+  }
   lss::GameExporter::createApertureMdls(exportData.baseExportPath);
   ctx.instanceStage = (exportData.bExportInstanceStage) ? createInstanceStage(exportData) : pxr::UsdStageRefPtr();
   ctx.extension = (exportData.bExportInstanceStage) ? getExtension(exportData.instanceStagePath) : lss::ext::usd;
   exportMaterials(exportData, ctx);
   exportMeshes(exportData, ctx);
   exportSkeletons(exportData, ctx);
-  if(ctx.instanceStage) {
+  if(ctx.instanceStage && !ctx.isCancelled()) {
     exportCamera(exportData, ctx);
     exportSphereLights(exportData, ctx);
     exportDistantLights(exportData, ctx);
     exportInstances(exportData, ctx);
     exportSky(exportData, ctx);
+  }
+  if (ctx.isCancelled()) {
+    dxvk::Logger::info("[GameExporter][" + exportData.debugId + "] Export cancelled");
+    return false;
+  }
+  if(ctx.instanceStage) {
     setCommonStageMetaData(ctx.instanceStage, exportData);
     ctx.instanceStage->SetStartTimeCode(exportData.meta.startTimeCode);
     ctx.instanceStage->SetEndTimeCode(exportData.meta.endTimeCode);
     ctx.instanceStage->Save();
   }
   dxvk::Logger::info("[GameExporter][" + exportData.debugId + "] Export end");
+  return true;
 }
 
 pxr::UsdStageRefPtr GameExporter::createInstanceStage(const Export& exportData) {
@@ -344,88 +406,34 @@ void GameExporter::exportMaterials(const Export& exportData, ExportContext& ctx)
   const std::string fullMaterialBasePath = computeLocalPath(matDirPath);
   
   dxvk::env::createDirectory(matDirPath);
-  for(const auto& [matId, matData] : exportData.materials) {
-    // Build material stage
-    const std::string matName = prefix::mat + matData.matName;
-    const std::string matStageName = matName + ctx.extension;
-    const std::string matStagePath = matDirPath + matStageName;
-    pxr::UsdStageRefPtr matStage = findOpenOrCreateStage(matStagePath, true);
-    assert(matStage);
-    setCommonStageMetaData(matStage, exportData);
-
-    // Add Looks + RootPrim prims
-    const auto looksSdfPath = gStageRootPath.AppendChild(gTokLooks);
-    const auto looksScopePrim = matStage->DefinePrim(looksSdfPath, gTokScope);
-    assert(looksScopePrim);
-    matStage->SetDefaultPrim(looksScopePrim);
-
-    // Create material prim
-    const auto matSdfPath = looksSdfPath.AppendElementString(matName);
-    const auto matSchema = pxr::UsdShadeMaterial::Define(matStage, matSdfPath);
-    assert(matSchema);
-    const auto matPrim = matSchema.GetPrim();
-    assert(matPrim);
-
-    // Create shader prim under material prim
-    static const pxr::TfToken kTokShader("Shader");
-    const auto shaderPath = matPrim.GetPath().AppendChild(kTokShader);
-    const auto shader = pxr::UsdShadeShader::Define(matStage, shaderPath);
-    const auto shaderPrim = shader.GetPrim();
-    assert(shaderPrim);
-
-    std::unordered_map<ShaderAttr::Enum, pxr::UsdAttribute> shaderAttrs;
-    for(const auto& [attrEnum, desc] : ShaderAttr::attrDescs) {
-      shaderAttrs[attrEnum] =
-        shaderPrim.CreateAttribute(desc.attrName, desc.typeName, desc.custom, desc.sdfVariability);
-      // Cannot assert. Attr "outputs:out" asserts false, but authoring + Setting works just fine.
-      // assert(shaderAttrs[attrEnum]); 
-    }
-
-    // Create and connect material outputs to shader outputs
-    static const pxr::TfToken kTokOutputsMdlSurface("outputs:mdl:surface");
-    const auto outputsMdlSurfaceAttr =
-      matPrim.CreateAttribute(kTokOutputsMdlSurface, pxr::SdfValueTypeNames->Token, false, pxr::SdfVariabilityVarying);
-    outputsMdlSurfaceAttr.AddConnection(shaderAttrs[ShaderAttr::OutputsOut].GetPath(), pxr::UsdListPositionFrontOfAppendList);
-
-    // Set shader "Kind"
-    static const pxr::TfToken kTokMaterial("Material");
-    pxr::UsdModelAPI(shader).SetKind(kTokMaterial);
-
-    // Create and set textures asset paths on material
-    const auto relToMaterialsTexPath =
-      std::filesystem::relative(computeLocalPath(matData.albedoTexPath), fullMaterialBasePath).string();
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::DiffuseTex].Set(pxr::SdfAssetPath(relToMaterialsTexPath)));
-    shaderAttrs[ShaderAttr::DiffuseTex].SetColorSpace(pxr::TfToken("auto"));
-
-    // Create and set OmniPBR MDL boilerplate attributes on shader
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::ImplSrc].Set(pxr::TfToken("sourceAsset")));
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::MdlSrcAsset].Set(pxr::SdfAssetPath("./AperturePBR_Opacity.mdl")));
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::MdlSrcAssetSubId].Set(pxr::TfToken("AperturePBR_Opacity")));
-
-    // Mark whether to enable varying opacity
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::Opacity].Set(matData.enableOpacity));
 
-    // Sampler State
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::FilterMode].Set((uint32_t)lss::Mdl::Filter::vkToMdl(matData.sampler.filter)));
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::WrapModeU].Set((uint32_t)lss::Mdl::WrapMode::vkToMdl(matData.sampler.addrModeU)));
-    ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::WrapModeV].Set((uint32_t)lss::Mdl::WrapMode::vkToMdl(matData.sampler.addrModeV)));
+  // Material stages don't depend on each other, so they are authored in parallel
+  const auto materials = gatherAssets(exportData.materials);
+  std::vector<Reference> matReferences(materials.size());
+  parallelFor(materials.size(), ctx.numThreads, [&](const size_t i) {
+    if (!ctx.isCancelled()) {
+      matReferences[i] = exportMaterialStage(exportData, ctx, *materials[i].second, matDirPath, fullMaterialBasePath);
+      ctx.onAssetExported();
+    }
+  });
+  if (ctx.isCancelled()) {
+    return;
+  }
 
-    matStage->Save();
-    
-    // Cache material reference
-    Reference matLssReference;
-    matLssReference.stagePath = matStagePath;
-    matLssReference.ogSdfPath = matSdfPath;
+  for (size_t i = 0; i < materials.size(); ++i) {
+    const auto& [matId, pMatData] = materials[i];
+    Reference& matLssReference = matReferences[i];
 
     // Build matSchema prim on instance stage
     if(ctx.instanceStage != nullptr) {
+      const std::string matName = prefix::mat + pMatData->matName;
       const auto matInstanceSdfPath = gRootMaterialsPath.AppendElementString(matName);
       auto matInstanceSchema = pxr::UsdShadeMaterial::Define(ctx.instanceStage, matInstanceSdfPath);
       assert(matInstanceSchema);
       
       const std::string relMeshStagePath = commonDirName::matDir + matName + ctx.extension;
       auto matInstanceUsdReferences = matInstanceSchema.GetPrim().GetReferences();
-      matInstanceUsdReferences.AddReference(relMeshStagePath, matSdfPath);
+      matInstanceUsdReferences.AddReference(relMeshStagePath, matLssReference.ogSdfPath);
       
       matLssReference.instanceSdfPath = matInstanceSdfPath;
     }
@@ -435,72 +443,119 @@ void GameExporter::exportMaterials(const Export& exportData, ExportContext& ctx)
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportMaterials] End");
 }
 
+GameExporter::Reference GameExporter::exportMaterialStage(const Export& exportData,
+                                                          const ExportContext& ctx,
+                                                          const Material& matData,
+                                                          const std::string& matDirPath,
+                                                          const std::string& fullMaterialBasePath) {
+  // Build material stage
+  const std::string matName = prefix::mat + matData.matName;
+  const std::string matStageName = matName + ctx.extension;
+  const std::string matStagePath = matDirPath + matStageName;
+  pxr::UsdStageRefPtr matStage = findOpenOrCreateStage(matStagePath, true);
+  assert(matStage);
+  setCommonStageMetaData(matStage, exportData);
+
+  // Add Looks + RootPrim prims
+  const auto looksSdfPath = gStageRootPath.AppendChild(gTokLooks);
+  const auto looksScopePrim = matStage->DefinePrim(looksSdfPath, gTokScope);
+  assert(looksScopePrim);
+  matStage->SetDefaultPrim(looksScopePrim);
+
+  // Create material prim
+  const auto matSdfPath = looksSdfPath.AppendElementString(matName);
+  const auto matSchema = pxr::UsdShadeMaterial::Define(matStage, matSdfPath);
+  assert(matSchema);
+  const auto matPrim = matSchema.GetPrim();
+  assert(matPrim);
+
+  // Create shader prim under material prim
+  static const pxr::TfToken kTokShader("Shader");
+  const auto shaderPath = matPrim.GetPath().AppendChild(kTokShader);
+  const auto shader = pxr::UsdShadeShader::Define(matStage, shaderPath);
+  const auto shaderPrim = shader.GetPrim();
+  assert(shaderPrim);
+
+  std::unordered_map<ShaderAttr::Enum, pxr::UsdAttribute> shaderAttrs;
+  for(const auto& [attrEnum, desc] : ShaderAttr::attrDescs) {
+    shaderAttrs[attrEnum] =
+      shaderPrim.CreateAttribute(desc.attrName, desc.typeName, desc.custom, desc.sdfVariability);
+    // Cannot assert. Attr "outputs:out" asserts false, but authoring + Setting works just fine.
+    // assert(shaderAttrs[attrEnum]); 
+  }
+
+  // Create and connect material outputs to shader outputs
+  static const pxr::TfToken kTokOutputsMdlSurface("outputs:mdl:surface");
+  const auto outputsMdlSurfaceAttr =
+    matPrim.CreateAttribute(kTokOutputsMdlSurface, pxr::SdfValueTypeNames->Token, false, pxr::SdfVariabilityVarying);
+  outputsMdlSurfaceAttr.AddConnection(shaderAttrs[ShaderAttr::OutputsOut].GetPath(), pxr::UsdListPositionFrontOfAppendList);
+
+  // Set shader "Kind"
+  static const pxr::TfToken kTokMaterial("Material");
+  pxr::UsdModelAPI(shader).SetKind(kTokMaterial);
+
+  // Create and set textures asset paths on material
+  const auto relToMaterialsTexPath =
+    std::filesystem::relative(computeLocalPath(matData.albedoTexPath), fullMaterialBasePath).string();
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::DiffuseTex].Set(pxr::SdfAssetPath(relToMaterialsTexPath)));
+  shaderAttrs[ShaderAttr::DiffuseTex].SetColorSpace(pxr::TfToken("auto"));
+
+  // Create and set OmniPBR MDL boilerplate attributes on shader
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::ImplSrc].Set(pxr::TfToken("sourceAsset")));
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::MdlSrcAsset].Set(pxr::SdfAssetPath("./AperturePBR_Opacity.mdl")));
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::MdlSrcAssetSubId].Set(pxr::TfToken("AperturePBR_Opacity")));
+
+  // Mark whether to enable varying opacity
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::Opacity].Set(matData.enableOpacity));
+
+  // Sampler State
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::FilterMode].Set((uint32_t)lss::Mdl::Filter::vkToMdl(matData.sampler.filter)));
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::WrapModeU].Set((uint32_t)lss::Mdl::WrapMode::vkToMdl(matData.sampler.addrModeU)));
+  ASSERT_OR_EXECUTE(shaderAttrs[ShaderAttr::WrapModeV].Set((uint32_t)lss::Mdl::WrapMode::vkToMdl(matData.sampler.addrModeV)));
+
+  matStage->Save();
+
+  // Cache material reference
+  Reference matLssReference;
+  matLssReference.stagePath = matStagePath;
+  matLssReference.ogSdfPath = matSdfPath;
+  return matLssReference;
+}
+
 void GameExporter::exportSkeletons(const Export& exportData, ExportContext& ctx) {
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportSkeletons] Begin");
-  static const pxr::GfMatrix4d identity(1);
   const std::string relDirPath = commonDirName::skeletonDir + "/";
   const std::string dirPath = exportData.baseExportPath + "/" + relDirPath;
-  const std::string fullStagePath = computeLocalPath(dirPath);
   dxvk::env::createDirectory(dirPath);
-  for (const auto& [meshId, mesh] : exportData.meshes) {
-    if (mesh.numBones == 0) {
-      continue;
-    }
-
-    // Build skeleton stage
-    const std::string name = prefix::skeleton + mesh.meshName;
-    const std::string stagePath = dirPath + name + ctx.extension;
-    pxr::UsdStageRefPtr stage = findOpenOrCreateStage(stagePath, true);
-    assert(stage);
-    setCommonStageMetaData(stage, exportData);
 
-    pxr::VtDictionary customLayerData = stage->GetRootLayer()->GetCustomLayerData();
-    for (auto& component : mesh.componentHashes) {
-      customLayerData.SetValueAtPath(component.first, pxr::VtValue(component.second));
+  std::vector<std::pair<Id, const Mesh*>> skinnedMeshes;
+  for (const auto& [meshId, pMesh] : gatherAssets(exportData.meshes)) {
+    if (pMesh->numBones > 0) {
+      skinnedMeshes.emplace_back(meshId, pMesh);
     }
-    stage->GetRootLayer()->SetCustomLayerData(customLayerData);
-
-    // Build skel root prim on stage
-    const auto defaultPrimPath = gStageRootPath.AppendElementString(name);
-    pxr::UsdSkelRoot skelRootSchema = pxr::UsdSkelRoot::Define(stage, defaultPrimPath);
-
-    assert(skelRootSchema);
-    stage->SetDefaultPrim(skelRootSchema.GetPrim());
-
-    // Build skeleton prim under above xform
-    const auto skeletonSdfPath = defaultPrimPath.AppendChild(gTokSkel);
-    auto skelSchema = pxr::UsdSkelSkeleton::Define(stage, skeletonSdfPath);
-    assert(skelSchema);
-
-
-    // Set bindTransforms attribute
-    auto bindTransformsAttr = skelSchema.CreateBindTransformsAttr();
-    assert(bindTransformsAttr);
-    ctx.skeletons[meshId] = generateSkeleton(mesh.numBones,
-                                             mesh.bonesPerVertex,
-                                             mesh.buffers.positionBufs.begin()->second,
-                                             mesh.buffers.blendWeightBufs.empty() ? nullptr : &mesh.buffers.blendWeightBufs.begin()->second,
-                                             mesh.buffers.blendIndicesBufs.empty() ? nullptr : &mesh.buffers.blendIndicesBufs.begin()->second);
-    const Skeleton& skel = ctx.skeletons[meshId];
-    // pxr::VtMatrix4dArray identities(mesh.numBones, pxr::GfMatrix4d(1));
-    bindTransformsAttr.Set(skel.bindPose);
-
-    // Set restTransforms attribute
-    auto restTransformsAttr = skelSchema.CreateRestTransformsAttr();
-    assert(restTransformsAttr);
-    restTransformsAttr.Set(skel.restPose);
+  }
 
-    // Set joints attribute on both the skeleton and the pose
-    auto jointsAttr = skelSchema.CreateJointsAttr();
-    assert(jointsAttr);
-    jointsAttr.Set(skel.jointNames);
+  std::vector<Skeleton> skeletons(skinnedMeshes.size());
+  parallelFor(skinnedMeshes.size(), ctx.numThreads, [&](const size_t i) {
+    if (!ctx.isCancelled()) {
+      skeletons[i] = exportSkeletonStage(exportData, ctx, *skinnedMeshes[i].second, dirPath);
+      ctx.onAssetExported();
+    }
+  });
+  if (ctx.isCancelled()) {
+    return;
+  }
 
-    stage->Save();
+  for (size_t i = 0; i < skinnedMeshes.size(); ++i) {
+    const auto& [meshId, pMesh] = skinnedMeshes[i];
+    ctx.skeletons[meshId] = std::move(skeletons[i]);
 
     // Build meshSchema prim on instance stage
     if (ctx.instanceStage != nullptr) {
-      const std::string mesh_name = prefix::mesh + mesh.meshName;
+      const std::string name = prefix::skeleton + pMesh->meshName;
+      const std::string mesh_name = prefix::mesh + pMesh->meshName;
       const std::string relSkelStagePath = relDirPath + name + ctx.extension;
+      const pxr::SdfPath skeletonSdfPath = gStageRootPath.AppendElementString(name).AppendChild(gTokSkel);
       const pxr::SdfPath skelInstancePath = gRootMeshesPath.AppendElementString(mesh_name).AppendElementString(gTokSkel);
 
       auto skelSchema = pxr::UsdSkelSkeleton::Define(ctx.instanceStage, skelInstancePath);
@@ -511,195 +566,89 @@ void GameExporter::exportSkeletons(const Export& exportData, ExportContext& ctx)
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportSkeletons] End");
 }
 
+Skeleton GameExporter::exportSkeletonStage(const Export& exportData,
+                                           const ExportContext& ctx,
+                                           const Mesh& mesh,
+                                           const std::string& dirPath) {
+  // Build skeleton stage
+  const std::string name = prefix::skeleton + mesh.meshName;
+  const std::string stagePath = dirPath + name + ctx.extension;
+  pxr::UsdStageRefPtr stage = findOpenOrCreateStage(stagePath, true);
+  assert(stage);
+  setCommonStageMetaData(stage, exportData);
+
+  pxr::VtDictionary customLayerData = stage->GetRootLayer()->GetCustomLayerData();
+  for (auto& component : mesh.componentHashes) {
+    customLayerData.SetValueAtPath(component.first, pxr::VtValue(component.second));
+  }
+  stage->GetRootLayer()->SetCustomLayerData(customLayerData);
+
+  // Build skel root prim on stage
+  const auto defaultPrimPath = gStageRootPath.AppendElementString(name);
+  pxr::UsdSkelRoot skelRootSchema = pxr::UsdSkelRoot::Define(stage, defaultPrimPath);
+
+  assert(skelRootSchema);
+  stage->SetDefaultPrim(skelRootSchema.GetPrim());
+
+  // Build skeleton prim under above xform
+  const auto skeletonSdfPath = defaultPrimPath.AppendChild(gTokSkel);
+  auto skelSchema = pxr::UsdSkelSkeleton::Define(stage, skeletonSdfPath);
+  assert(skelSchema);
+
+
+  // Set bindTransforms attribute
+  auto bindTransformsAttr = skelSchema.CreateBindTransformsAttr();
+  assert(bindTransformsAttr);
+  const Skeleton skel = generateSkeleton(mesh.numBones,
+                                         mesh.bonesPerVertex,
+                                         mesh.buffers.positionBufs.begin()->second,
+                                         mesh.buffers.blendWeightBufs.empty() ? nullptr : &mesh.buffers.blendWeightBufs.begin()->second,
+                                         mesh.buffers.blendIndicesBufs.empty() ? nullptr : &mesh.buffers.blendIndicesBufs.begin()->second);
+  // pxr::VtMatrix4dArray identities(mesh.numBones, pxr::GfMatrix4d(1));
+  bindTransformsAttr.Set(skel.bindPose);
+
+  // Set restTransforms attribute
+  auto restTransformsAttr = skelSchema.CreateRestTransformsAttr();
+  assert(restTransformsAttr);
+  restTransformsAttr.Set(skel.restPose);
+
+  // Set joints attribute on both the skeleton and the pose
+  auto jointsAttr = skelSchema.CreateJointsAttr();
+  assert(jointsAttr);
+  jointsAttr.Set(skel.jointNames);
+
+  stage->Save();
+  return skel;
+}
+
 void GameExporter::exportMeshes(const Export& exportData, ExportContext& ctx) {
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportMeshes] Begin");
-  static const pxr::GfMatrix4d identity(1);
   const std::string relMeshDirPath = commonDirName::meshDir + "/";
   const std::string meshDirPath = exportData.baseExportPath + "/" + relMeshDirPath;
   const std::string fullMeshStagePath = computeLocalPath(meshDirPath);
   dxvk::env::createDirectory(meshDirPath);
-  // Determine whether meshes need to be inverted
-  const bool bInvX = (!exportData.camera.view.bInv) && (exportData.camera.proj.bInv || exportData.camera.isLHS());
-  const bool bInvY = (!exportData.camera.view.bInv) && exportData.camera.proj.bInv;
-  for(const auto& [meshId,mesh] : exportData.meshes) {
-    assert(mesh.numVertices > 0);
-    assert(mesh.numIndices > 0);
-
-    const bool isSkeleton = mesh.numBones > 0;
-
-    // Build mesh stage
-    const std::string meshName = prefix::mesh + mesh.meshName;
-    const std::string meshStagePath = meshDirPath + meshName + ctx.extension;
-    pxr::UsdStageRefPtr meshStage = findOpenOrCreateStage(meshStagePath, true);
-    assert(meshStage);
-    setCommonStageMetaData(meshStage, exportData);
-
-    pxr::VtDictionary customLayerData = meshStage->GetRootLayer()->GetCustomLayerData();
-    for (auto& component : mesh.componentHashes) {
-      customLayerData.SetValueAtPath(component.first, pxr::VtValue(component.second));
-    }
-    meshStage->GetRootLayer()->SetCustomLayerData(customLayerData);
-
-    pxr::SdfPath meshXformSdfPath;
-    const bool visualCorrectionReqd = exportData.meta.bCorrectBakedTransforms || bInvX || bInvY;
-    if (visualCorrectionReqd) {
-      const auto correctionXformSdfPath = gStageRootPath.AppendElementString("visual_correction");
-      auto correctionXformSchema = pxr::UsdGeomXform::Define(meshStage, correctionXformSdfPath);
-      auto correctionXformOp = correctionXformSchema.AddTransformOp();
-      assert(correctionXformOp);
-      pxr::GfMatrix4d xform { 1.0 };
-      const pxr::GfVec3d scale{ (bInvX) ? -1.0 : 1.0,
-                                (bInvY) ? -1.0 : 1.0, 1.0};
-      xform.SetScale(scale);
-      const pxr::GfVec3d dOrigin{
-        (bInvX) ? -mesh.origin[0] : mesh.origin[0],
-        (bInvY) ? -mesh.origin[1] : mesh.origin[1],
-        mesh.origin[2]};
-      xform.SetTranslateOnly(-dOrigin);
-      correctionXformOp.Set(xform);
-      meshXformSdfPath = correctionXformSdfPath.AppendElementString(meshName);
-    } else {
-      meshXformSdfPath = gStageRootPath.AppendElementString(meshName);
-    }
 
-    // Build mesh xform prim on mesh stage, make it visible
-    pxr::UsdGeomXformable meshXformSchema;
-    if (isSkeleton) {
-      meshXformSchema = pxr::UsdSkelRoot::Define(meshStage, meshXformSdfPath);
-    } else {
-      meshXformSchema = pxr::UsdGeomXform::Define(meshStage, meshXformSdfPath);
-    }
-    assert(meshXformSchema);
-    meshStage->SetDefaultPrim(meshXformSchema.GetPrim());
-    auto meshXformVisibilityAttr = meshXformSchema.CreateVisibilityAttr();
-    assert(meshXformVisibilityAttr);
-    meshXformVisibilityAttr.Set(gVisibilityInherited);
-
-    // Build mesh geometry prim under above xform
-    const auto meshSchemaSdfPath = meshXformSdfPath.AppendChild(gTokMesh);
-    pxr::UsdGeomMesh meshSchema = pxr::UsdGeomMesh::Define(meshStage, meshSchemaSdfPath);
-    pxr::UsdGeomPrimvarsAPI primvarsAPI(meshSchema.GetPrim());
-
-    assert(meshSchema);
-    auto meshVisibilityAttr = meshSchema.CreateVisibilityAttr();
-    assert(meshVisibilityAttr);
-    meshVisibilityAttr.Set(gVisibilityInherited);
-
-    auto meshXformOp = meshSchema.AddTransformOp();
-    assert(meshXformOp);
-    pxr::GfMatrix4d xform { 1.0 };
-    xform = mesh.isLhs ? dxvk::swapBasis(xform) : xform;
-    meshXformOp.Set(xform);
-
-    // Set double-sidedness attribute
-    auto doubleSidedAttr = meshSchema.CreateDoubleSidedAttr();
-    assert(doubleSidedAttr);
-    doubleSidedAttr.Set(mesh.isDoubleSided);
-
-    // Set orientation attribute
-    auto orientationAttr = meshSchema.CreateOrientationAttr();
-    assert(orientationAttr);
-    orientationAttr.Set(pxr::VtValue(pxr::UsdGeomTokens->rightHanded));
-
-    // Create corresponding attribute arrays using above populated VtArrays
-    pxr::VtArray<int> faceVertexCounts;
-    faceVertexCounts.assign(mesh.numIndices / 3, 3);
-    auto faceVertexCountsAttr = meshSchema.CreateFaceVertexCountsAttr();
-    assert(faceVertexCountsAttr);
-    faceVertexCountsAttr.Set(faceVertexCounts);
-
-    for (auto& pair : mesh.categoryFlags) {
-      const auto attribute = meshSchema.GetPrim().CreateAttribute(pxr::TfToken(pair.first), pxr::SdfValueTypeNames->Bool, true, pxr::SdfVariabilityUniform);
-      attribute.Set(pxr::VtValue(pair.second));
-    }
-
-    // Indices
-    const bool reduce = exportData.meta.bReduceMeshBuffers;
-    ReducedIdxBufSet reducedIdxBufSet = reduce ? reduceIdxBufferSet(mesh.buffers.idxBufs) : ReducedIdxBufSet();
-    const BufSet<Index>& idxBufSet = reduce ? reducedIdxBufSet.bufSet : mesh.buffers.idxBufs;
-    auto indexAttr = meshSchema.CreateFaceVertexIndicesAttr();
-    assert(indexAttr);
-    exportBufferSet(idxBufSet, indexAttr);
-    // Vertices
-    const auto& posBufs = mesh.buffers.positionBufs;
-    auto pointsAttr = meshSchema.CreatePointsAttr();
-    assert(pointsAttr);
-    exportBufferSet(reduce ? reduceBufferSet(posBufs, reducedIdxBufSet) : posBufs, pointsAttr);
-    // Normals
-    auto normalsAttr = meshSchema.CreateNormalsAttr();
-    assert(normalsAttr);
-    exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.normalBufs, reducedIdxBufSet) : mesh.buffers.normalBufs, normalsAttr);
-    // Set subdivision scheme to None (USD defaults to catmull clark)
-    auto subdivAttr = meshSchema.CreateSubdivisionSchemeAttr();
-    assert(subdivAttr);
-    subdivAttr.Set(pxr::UsdGeomTokens->none);
-    // Texture Coordinates
-    static const pxr::TfToken kTokSt("st");
-    auto stAttr = primvarsAPI.CreatePrimvar(kTokSt, pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->vertex);
-    assert(stAttr);
-    exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.texcoordBufs, reducedIdxBufSet) : mesh.buffers.texcoordBufs, stAttr);
-
-    // Vertex Colors
-    if (mesh.buffers.colorBufs.size() > 0) {
-      auto displayColorPrimvar = meshSchema.CreateDisplayColorPrimvar(pxr::UsdGeomTokens->vertex);
-      auto displayOpacityPrimvar = meshSchema.CreateDisplayOpacityPrimvar(pxr::UsdGeomTokens->vertex);
-      assert(displayColorPrimvar);
-      assert(displayOpacityPrimvar);
-      if (mesh.buffers.colorBufs.cbegin()->second.size() == 1) {
-        // Constant Color
-        displayColorPrimvar.SetInterpolation(pxr::UsdGeomTokens->constant);
-        displayOpacityPrimvar.SetInterpolation(pxr::UsdGeomTokens->constant);
-      }
-      exportColorOpacityBufferSet(reduce ? reduceBufferSet(mesh.buffers.colorBufs, reducedIdxBufSet) : mesh.buffers.colorBufs, displayColorPrimvar, displayOpacityPrimvar);
-    }
-    
-    if (isSkeleton) {
-      pxr::UsdSkelBindingAPI skelBind = pxr::UsdSkelBindingAPI::Apply(meshSchema.GetPrim());
-
-      auto jointWeightsAttr = skelBind.CreateJointWeightsPrimvar(0, mesh.bonesPerVertex);
-      assert(jointWeightsAttr);
-      exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.blendWeightBufs, reducedIdxBufSet, mesh.bonesPerVertex) : mesh.buffers.blendWeightBufs, jointWeightsAttr);
-
-      auto jointIndicesAttr = skelBind.CreateJointIndicesPrimvar(0, mesh.bonesPerVertex);
-      assert(jointIndicesAttr);
-      if (mesh.buffers.blendIndicesBufs.size() > 0) {
-        exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.blendIndicesBufs, reducedIdxBufSet, mesh.bonesPerVertex) : mesh.buffers.blendIndicesBufs, jointIndicesAttr);
-      } else {
-        // D3D9 allows for default bone indices of "0, 1, ... bonesPerVertex" if no joint indices are set.
-        pxr::VtArray<int> defaultIndices(mesh.bonesPerVertex * mesh.numVertices);
-        for (int i = 0; i < mesh.numVertices; ++i) {
-          for (int j = 0; j < mesh.bonesPerVertex; ++j) {
-            defaultIndices[i * mesh.bonesPerVertex + j] = j;
-          }
-        }
-        jointIndicesAttr.Set(defaultIndices);
-      }
-
-      auto skelRel = skelBind.CreateSkeletonRel();
-      skelRel.AddTarget(meshXformSdfPath.AppendChild(gTokSkel));
+  // Each mesh is authored to its own stage on the worker threads, only the instance stage is shared
+  const auto meshes = gatherAssets(exportData.meshes);
+  std::vector<Reference> meshReferences(meshes.size());
+  parallelFor(meshes.size(), ctx.numThreads, [&](const size_t i) {
+    if (!ctx.isCancelled()) {
+      meshReferences[i] = exportMeshStage(exportData, ctx, *meshes[i].second, meshDirPath, fullMeshStagePath);
+      ctx.onAssetExported();
     }
+  });
+  if (ctx.isCancelled()) {
+    return;
+  }
 
-    const bool bHasMat = mesh.matId != kInvalidId;
-    const Reference& matLssReference = (bHasMat) ? ctx.matReferences[mesh.matId] : Reference();
-    if(bHasMat) {
-      const auto shaderMatSchema = pxr::UsdShadeMaterial::Define(meshStage, matLssReference.ogSdfPath);
-      assert(shaderMatSchema);
-      auto shaderMatUsdReferences = shaderMatSchema.GetPrim().GetReferences();
-      const std::string fullMatStagePath = computeLocalPath(matLssReference.stagePath);
-      const std::string relMatRefStagePath = std::filesystem::relative(fullMatStagePath,fullMeshStagePath).string();
-      shaderMatUsdReferences.AddReference(relMatRefStagePath, matLssReference.ogSdfPath);
-      pxr::UsdShadeMaterialBindingAPI(meshXformSchema.GetPrim()).Bind(shaderMatSchema);
-    }
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    const auto& [meshId, pMesh] = meshes[i];
+    Reference& meshLssReference = meshReferences[i];
 
-    meshStage->Save();
-    
-    // Cache material reference
-    Reference meshLssReference;
-    meshLssReference.stagePath = meshStagePath;
-    meshLssReference.ogSdfPath = meshXformSdfPath;
-    
     // Build meshSchema prim on instance stage
     if(ctx.instanceStage != nullptr) {
+      const bool isSkeleton = pMesh->numBones > 0;
+      const std::string meshName = prefix::mesh + pMesh->meshName;
       const auto meshInstanceXformSdfPath = gRootMeshesPath.AppendElementString(meshName);
       pxr::UsdGeomXformable meshInstanceXformSchema;
       if (isSkeleton) {
@@ -711,13 +660,14 @@ void GameExporter::exportMeshes(const Export& exportData, ExportContext& ctx) {
 
       const std::string relMeshStagePath = relMeshDirPath + meshName + ctx.extension;
       auto meshInstanceUsdReferences = meshInstanceXformSchema.GetPrim().GetReferences();
-      meshInstanceUsdReferences.AddReference(relMeshStagePath, meshXformSdfPath);
+      meshInstanceUsdReferences.AddReference(relMeshStagePath, meshLssReference.ogSdfPath);
 
       auto meshInstanceXformVisibilityAttr = meshInstanceXformSchema.CreateVisibilityAttr();
       assert(meshInstanceXformVisibilityAttr);
       meshInstanceXformVisibilityAttr.Set(gVisibilityInvisible);
       
-      if(bHasMat) {
+      if(pMesh->matId != kInvalidId) {
+        const Reference& matLssReference = ctx.matReferences[pMesh->matId];
         const auto shaderMatInstanceSchema = pxr::UsdShadeMaterial::Get(ctx.instanceStage, matLssReference.instanceSdfPath);
         assert(shaderMatInstanceSchema);
         pxr::UsdShadeMaterialBindingAPI(meshInstanceXformSchema.GetPrim()).Bind(shaderMatInstanceSchema);
@@ -731,60 +681,192 @@ void GameExporter::exportMeshes(const Export& exportData, ExportContext& ctx) {
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportMeshes] End");
 }
 
-GameExporter::ReducedIdxBufSet GameExporter::reduceIdxBufferSet(const BufSet<Index>& idxBufSet) {
-  ReducedIdxBufSet reducedIdxBufSet;
-  for(const auto& [timeCode, idxBuf] : idxBufSet) {
-    const std::set<int> orderedIndices(idxBuf.cbegin(), idxBuf.cend());
-    int newIdx = 0;
-    ReducedIdxBufSet::IdxMap ogToRed;
-    for(const auto index : orderedIndices) {
-      ogToRed[index] = newIdx++;
-    }
-    for(const auto ogIdx : idxBuf) {
-      const auto redIdx = ogToRed[ogIdx];
-      assert(redIdx <= ogIdx);
-      reducedIdxBufSet.bufSet[timeCode].push_back(redIdx);
-      reducedIdxBufSet.redToOgSet[timeCode][redIdx] = ogIdx;
-    }
+GameExporter::Reference GameExporter::exportMeshStage(const Export& exportData,
+                                                      const ExportContext& ctx,
+                                                      const Mesh& mesh,
+                                                      const std::string& meshDirPath,
+                                                      const std::string& fullMeshStagePath) {
+  // Determine whether meshes need to be inverted
+  const bool bInvX = (!exportData.camera.view.bInv) && (exportData.camera.proj.bInv || exportData.camera.isLHS());
+  const bool bInvY = (!exportData.camera.view.bInv) && exportData.camera.proj.bInv;
+
+  assert(mesh.numVertices > 0);
+  assert(mesh.numIndices > 0);
+
+  const bool isSkeleton = mesh.numBones > 0;
+
+  // Build mesh stage
+  const std::string meshName = prefix::mesh + mesh.meshName;
+  const std::string meshStagePath = meshDirPath + meshName + ctx.extension;
+  pxr::UsdStageRefPtr meshStage = findOpenOrCreateStage(meshStagePath, true);
+  assert(meshStage);
+  setCommonStageMetaData(meshStage, exportData);
+
+  pxr::VtDictionary customLayerData = meshStage->GetRootLayer()->GetCustomLayerData();
+  for (auto& component : mesh.componentHashes) {
+    customLayerData.SetValueAtPath(component.first, pxr::VtValue(component.second));
+  }
+  meshStage->GetRootLayer()->SetCustomLayerData(customLayerData);
+
+  pxr::SdfPath meshXformSdfPath;
+  const bool visualCorrectionReqd = exportData.meta.bCorrectBakedTransforms || bInvX || bInvY;
+  if (visualCorrectionReqd) {
+    const auto correctionXformSdfPath = gStageRootPath.AppendElementString("visual_correction");
+    auto correctionXformSchema = pxr::UsdGeomXform::Define(meshStage, correctionXformSdfPath);
+    auto correctionXformOp = correctionXformSchema.AddTransformOp();
+    assert(correctionXformOp);
+    pxr::GfMatrix4d xform { 1.0 };
+    const pxr::GfVec3d scale{ (bInvX) ? -1.0 : 1.0,
+                              (bInvY) ? -1.0 : 1.0, 1.0};
+    xform.SetScale(scale);
+    const pxr::GfVec3d dOrigin{
+      (bInvX) ? -mesh.origin[0] : mesh.origin[0],
+      (bInvY) ? -mesh.origin[1] : mesh.origin[1],
+      mesh.origin[2]};
+    xform.SetTranslateOnly(-dOrigin);
+    correctionXformOp.Set(xform);
+    meshXformSdfPath = correctionXformSdfPath.AppendElementString(meshName);
+  } else {
+    meshXformSdfPath = gStageRootPath.AppendElementString(meshName);
   }
-  return reducedIdxBufSet;
-}
 
-template<typename T>
-BufSet<T> GameExporter::reduceBufferSet(const BufSet<T>& bufSet, const ReducedIdxBufSet& reducedIdxBufSet, size_t elemsPerIdx) {
-  BufSet<T> reducedBufSet;
-  for(const auto& [timeCode, buf] : bufSet) {
-    // There may not be a 1:1 mapping in timecodes b/w index buffers and other buffers
-    float idxBufTimeCode = -1.f;
-    if(reducedIdxBufSet.bufSet.size() > 1) {
-      const auto iPair_timeCode_idxBuf = reducedIdxBufSet.bufSet.lower_bound(timeCode);
-      assert(iPair_timeCode_idxBuf != reducedIdxBufSet.bufSet.cend());
-      const float idxTimeCode = iPair_timeCode_idxBuf->first;
-      idxBufTimeCode = iPair_timeCode_idxBuf->first;
-    } else {
-      idxBufTimeCode = reducedIdxBufSet.bufSet.cbegin()->first;
+  // Build mesh xform prim on mesh stage, make it visible
+  pxr::UsdGeomXformable meshXformSchema;
+  if (isSkeleton) {
+    meshXformSchema = pxr::UsdSkelRoot::Define(meshStage, meshXformSdfPath);
+  } else {
+    meshXformSchema = pxr::UsdGeomXform::Define(meshStage, meshXformSdfPath);
+  }
+  assert(meshXformSchema);
+  meshStage->SetDefaultPrim(meshXformSchema.GetPrim());
+  auto meshXformVisibilityAttr = meshXformSchema.CreateVisibilityAttr();
+  assert(meshXformVisibilityAttr);
+  meshXformVisibilityAttr.Set(gVisibilityInherited);
+
+  // Build mesh geometry prim under above xform
+  const auto meshSchemaSdfPath = meshXformSdfPath.AppendChild(gTokMesh);
+  pxr::UsdGeomMesh meshSchema = pxr::UsdGeomMesh::Define(meshStage, meshSchemaSdfPath);
+  pxr::UsdGeomPrimvarsAPI primvarsAPI(meshSchema.GetPrim());
+
+  assert(meshSchema);
+  auto meshVisibilityAttr = meshSchema.CreateVisibilityAttr();
+  assert(meshVisibilityAttr);
+  meshVisibilityAttr.Set(gVisibilityInherited);
+
+  auto meshXformOp = meshSchema.AddTransformOp();
+  assert(meshXformOp);
+  pxr::GfMatrix4d xform { 1.0 };
+  xform = mesh.isLhs ? dxvk::swapBasis(xform) : xform;
+  meshXformOp.Set(xform);
+
+  // Set double-sidedness attribute
+  auto doubleSidedAttr = meshSchema.CreateDoubleSidedAttr();
+  assert(doubleSidedAttr);
+  doubleSidedAttr.Set(mesh.isDoubleSided);
+
+  // Set orientation attribute
+  auto orientationAttr = meshSchema.CreateOrientationAttr();
+  assert(orientationAttr);
+  orientationAttr.Set(pxr::VtValue(pxr::UsdGeomTokens->rightHanded));
+
+  // Create corresponding attribute arrays using above populated VtArrays
+  pxr::VtArray<int> faceVertexCounts;
+  faceVertexCounts.assign(mesh.numIndices / 3, 3);
+  auto faceVertexCountsAttr = meshSchema.CreateFaceVertexCountsAttr();
+  assert(faceVertexCountsAttr);
+  faceVertexCountsAttr.Set(faceVertexCounts);
+
+  for (auto& pair : mesh.categoryFlags) {
+    const auto attribute = meshSchema.GetPrim().CreateAttribute(pxr::TfToken(pair.first), pxr::SdfValueTypeNames->Bool, true, pxr::SdfVariabilityUniform);
+    attribute.Set(pxr::VtValue(pair.second));
+  }
+
+  // Indices
+  const bool reduce = exportData.meta.bReduceMeshBuffers;
+  ReducedIdxBufSet reducedIdxBufSet = reduce ? reduceIdxBufferSet(mesh.buffers.idxBufs) : ReducedIdxBufSet();
+  const BufSet<Index>& idxBufSet = reduce ? reducedIdxBufSet.bufSet : mesh.buffers.idxBufs;
+  auto indexAttr = meshSchema.CreateFaceVertexIndicesAttr();
+  assert(indexAttr);
+  exportBufferSet(idxBufSet, indexAttr);
+  // Vertices
+  const auto& posBufs = mesh.buffers.positionBufs;
+  auto pointsAttr = meshSchema.CreatePointsAttr();
+  assert(pointsAttr);
+  exportBufferSet(reduce ? reduceBufferSet(posBufs, reducedIdxBufSet) : posBufs, pointsAttr);
+  // Normals
+  auto normalsAttr = meshSchema.CreateNormalsAttr();
+  assert(normalsAttr);
+  exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.normalBufs, reducedIdxBufSet) : mesh.buffers.normalBufs, normalsAttr);
+  // Set subdivision scheme to None (USD defaults to catmull clark)
+  auto subdivAttr = meshSchema.CreateSubdivisionSchemeAttr();
+  assert(subdivAttr);
+  subdivAttr.Set(pxr::UsdGeomTokens->none);
+  // Texture Coordinates
+  static const pxr::TfToken kTokSt("st");
+  auto stAttr = primvarsAPI.CreatePrimvar(kTokSt, pxr::SdfValueTypeNames->TexCoord2fArray, pxr::UsdGeomTokens->vertex);
+  assert(stAttr);
+  exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.texcoordBufs, reducedIdxBufSet) : mesh.buffers.texcoordBufs, stAttr);
+
+  // Vertex Colors
+  if (mesh.buffers.colorBufs.size() > 0) {
+    auto displayColorPrimvar = meshSchema.CreateDisplayColorPrimvar(pxr::UsdGeomTokens->vertex);
+    auto displayOpacityPrimvar = meshSchema.CreateDisplayOpacityPrimvar(pxr::UsdGeomTokens->vertex);
+    assert(displayColorPrimvar);
+    assert(displayOpacityPrimvar);
+    if (mesh.buffers.colorBufs.cbegin()->second.size() == 1) {
+      // Constant Color
+      displayColorPrimvar.SetInterpolation(pxr::UsdGeomTokens->constant);
+      displayOpacityPrimvar.SetInterpolation(pxr::UsdGeomTokens->constant);
     }
-    assert(idxBufTimeCode >= 0.f);
+    exportColorOpacityBufferSet(reduce ? reduceBufferSet(mesh.buffers.colorBufs, reducedIdxBufSet) : mesh.buffers.colorBufs, displayColorPrimvar, displayOpacityPrimvar);
+  }
+  
+  if (isSkeleton) {
+    pxr::UsdSkelBindingAPI skelBind = pxr::UsdSkelBindingAPI::Apply(meshSchema.GetPrim());
 
-    // Create a scratch space to assign values for new, reduce VtArray, in case there are holes in the indices
-    const auto& redIdxToOgIdx = reducedIdxBufSet.redToOgSet.at(idxBufTimeCode);
-    const int numIdxs = redIdxToOgIdx.size();
-    const size_t numElems = numIdxs * elemsPerIdx;
-    T* const reducedBufScratch = new T[numElems];
-    
-    // Init potential holes to 0
-    memset(reducedBufScratch, 0, sizeof(T) * numElems);
-    for(const auto [redIndex,ogIndex] : redIdxToOgIdx) {
-      for (int elemNum = 0; elemNum < elemsPerIdx; ++elemNum) {
-        const auto ogIdx = (ogIndex * elemsPerIdx) + elemNum;
-        const auto redIdx = (redIndex * elemsPerIdx) + elemNum;
-        assert(redIdx <= ogIdx);
-        reducedBufScratch[redIdx] = buf[ogIdx];
+    auto jointWeightsAttr = skelBind.CreateJointWeightsPrimvar(0, mesh.bonesPerVertex);
+    assert(jointWeightsAttr);
+    exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.blendWeightBufs, reducedIdxBufSet, mesh.bonesPerVertex) : mesh.buffers.blendWeightBufs, jointWeightsAttr);
+
+    auto jointIndicesAttr = skelBind.CreateJointIndicesPrimvar(0, mesh.bonesPerVertex);
+    assert(jointIndicesAttr);
+    if (mesh.buffers.blendIndicesBufs.size() > 0) {
+      exportBufferSet(reduce ? reduceBufferSet(mesh.buffers.blendIndicesBufs, reducedIdxBufSet, mesh.bonesPerVertex) : mesh.buffers.blendIndicesBufs, jointIndicesAttr);
+    } else {
+      // D3D9 allows for default bone indices of "0, 1, ... bonesPerVertex" if no joint indices are set.
+      pxr::VtArray<int> defaultIndices(mesh.bonesPerVertex * mesh.numVertices);
+      for (int i = 0; i < mesh.numVertices; ++i) {
+        for (int j = 0; j < mesh.bonesPerVertex; ++j) {
+          defaultIndices[i * mesh.bonesPerVertex + j] = j;
+        }
       }
+      jointIndicesAttr.Set(defaultIndices);
     }
-    reducedBufSet[timeCode] = pxr::VtArray<T>(reducedBufScratch, reducedBufScratch + numElems);
+
+    auto skelRel = skelBind.CreateSkeletonRel();
+    skelRel.AddTarget(meshXformSdfPath.AppendChild(gTokSkel));
   }
-  return reducedBufSet;
+
+  // Note: Runs on the worker threads, the material references must not be modified here
+  const auto matLssReference = ctx.matReferences.find(mesh.matId);
+  const bool bHasMat = matLssReference != ctx.matReferences.cend();
+  if(bHasMat) {
+    const auto shaderMatSchema = pxr::UsdShadeMaterial::Define(meshStage, matLssReference->second.ogSdfPath);
+    assert(shaderMatSchema);
+    auto shaderMatUsdReferences = shaderMatSchema.GetPrim().GetReferences();
+    const std::string fullMatStagePath = computeLocalPath(matLssReference->second.stagePath);
+    const std::string relMatRefStagePath = std::filesystem::relative(fullMatStagePath,fullMeshStagePath).string();
+    shaderMatUsdReferences.AddReference(relMatRefStagePath, matLssReference->second.ogSdfPath);
+    pxr::UsdShadeMaterialBindingAPI(meshXformSchema.GetPrim()).Bind(shaderMatSchema);
+  }
+
+  meshStage->Save();
+
+  // Cache mesh reference
+  Reference meshLssReference;
+  meshLssReference.stagePath = meshStagePath;
+  meshLssReference.ogSdfPath = meshXformSdfPath;
+  return meshLssReference;
 }
 
 template<typename T>
@@ -982,79 +1064,28 @@ void GameExporter::exportCamera(const Export& exportData, ExportContext& ctx) {
 void GameExporter::exportSphereLights(const Export& exportData, ExportContext& ctx) {
   const std::string relLightDirPath = commonDirName::lightDir + "/";
   const std::string lightDirPath = exportData.baseExportPath + "/" + relLightDirPath;
-  const std::string fullLightStagePath = computeLocalPath(lightDirPath);
   auto rootLightsXformSchema = pxr::UsdGeomXform::Get(ctx.instanceStage,gRootLightsPath);
   assert(rootLightsXformSchema);
   auto transformOp = rootLightsXformSchema.AddTransformOp();
   assert(transformOp);
   transformOp.Set(exportData.globalXform);
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportSphereLights] Begin");
-  for(const auto& [id,sphereLightData] : exportData.sphereLights) {
-    // Build light stage
-    const std::string lightName = prefix::light + sphereLightData.lightName;
-    const std::string lightStagePath = lightDirPath + lightName + ctx.extension;
-    pxr::UsdStageRefPtr lightStage = findOpenOrCreateStage(lightStagePath, true);
-    assert(lightStage);
-    setCommonStageMetaData(lightStage, exportData);
-
-    // Build sphere light prim
-    const auto lightAssetSdfPath = gStageRootPath.AppendElementString(lightName);
-    auto sphereLight = pxr::UsdLuxSphereLight::Define(lightStage, lightAssetSdfPath);
-    assert(sphereLight);
-    lightStage->SetDefaultPrim(sphereLight.GetPrim());
-
-    auto colorAttr = sphereLight.CreateColorAttr();
-    assert(colorAttr);
-    colorAttr.Set(pxr::GfVec3f(sphereLightData.color[0], sphereLightData.color[1], sphereLightData.color[2]));
-
-    auto intensityAttr = sphereLight.CreateIntensityAttr();
-    assert(intensityAttr);
-    intensityAttr.Set(sphereLightData.intensity);
 
-    auto radiusAttr = sphereLight.CreateRadiusAttr();
-    assert(radiusAttr);
-    radiusAttr.Set(sphereLightData.radius);
-
-    auto shaping = pxr::UsdLuxShapingAPI(sphereLight.GetPrim());
-
-    // Note: Remix uses a different default from USD, so 180 must be specified here.
-    auto coneAngleAttr = shaping.CreateShapingConeAngleAttr(pxr::VtValue(180.0f));
-    assert(coneAngleAttr);
-
-    auto coneSoftnessAttr = shaping.CreateShapingConeSoftnessAttr();
-    assert(coneSoftnessAttr);
-    
-    auto FocusExponentAttr = shaping.CreateShapingFocusAttr();
-    assert(FocusExponentAttr);
-
-    // Note: Set the shaping attribute values only if shaping is enabled. Shaping attributes must still
-    // be created though even if shaping is disabled to ensure proper exporting of all the required
-    // attributes on a captured light (as external programs expect this to be the case).
-    if (sphereLightData.shapingEnabled) {
-      coneAngleAttr.Set(sphereLightData.coneAngleDegrees);
-      coneSoftnessAttr.Set(sphereLightData.coneSoftness);
-      FocusExponentAttr.Set(sphereLightData.focusExponent);
+  const auto sphereLights = gatherAssets(exportData.sphereLights);
+  parallelFor(sphereLights.size(), ctx.numThreads, [&](const size_t i) {
+    if (!ctx.isCancelled()) {
+      exportSphereLightStage(exportData, ctx, *sphereLights[i].second, lightDirPath);
+      ctx.onAssetExported();
     }
+  });
+  if (ctx.isCancelled()) {
+    return;
+  }
 
-    shaping.Apply(sphereLight.GetPrim());
-
-    setTimeSampledXforms(lightStage, lightAssetSdfPath,
-                         sphereLightData.firstTime, sphereLightData.finalTime, sphereLightData.xforms,
-                         exportData.meta, false);
-    
-    pxr::UsdLuxLightAPI lightAPI(sphereLight.GetPrim());
-    setLightIntensityOnTimeSpan(lightAPI, sphereLightData.intensity, sphereLightData.firstTime, sphereLightData.finalTime, exportData.meta.numFramesCaptured);
-    lightAPI.Apply(sphereLight.GetPrim());
-
-    lightStage->Save(); 
-
-    // Cache light reference
-    Reference lightLssReference;
-    lightLssReference.stagePath = lightStagePath;
-    lightLssReference.ogSdfPath = lightAssetSdfPath;
-
+  for (const auto& [id, pSphereLightData] : sphereLights) {
     // Build sphere light prim on instance stage
     if(ctx.instanceStage != nullptr) {
+      const std::string lightName = prefix::light + pSphereLightData->lightName;
       const pxr::SdfPath fullSphereLightPath = gRootLightsPath.AppendElementString(lightName);
       auto sphereLightInstance = pxr::UsdLuxSphereLight::Define(ctx.instanceStage, fullSphereLightPath);
 
@@ -1066,6 +1097,69 @@ void GameExporter::exportSphereLights(const Export& exportData, ExportContext& c
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportSphereLights] End");
 }
 
+void GameExporter::exportSphereLightStage(const Export& exportData,
+                                          const ExportContext& ctx,
+                                          const SphereLight& sphereLightData,
+                                          const std::string& lightDirPath) {
+  // Build light stage
+  const std::string lightName = prefix::light + sphereLightData.lightName;
+  const std::string lightStagePath = lightDirPath + lightName + ctx.extension;
+  pxr::UsdStageRefPtr lightStage = findOpenOrCreateStage(lightStagePath, true);
+  assert(lightStage);
+  setCommonStageMetaData(lightStage, exportData);
+
+  // Build sphere light prim
+  const auto lightAssetSdfPath = gStageRootPath.AppendElementString(lightName);
+  auto sphereLight = pxr::UsdLuxSphereLight::Define(lightStage, lightAssetSdfPath);
+  assert(sphereLight);
+  lightStage->SetDefaultPrim(sphereLight.GetPrim());
+
+  auto colorAttr = sphereLight.CreateColorAttr();
+  assert(colorAttr);
+  colorAttr.Set(pxr::GfVec3f(sphereLightData.color[0], sphereLightData.color[1], sphereLightData.color[2]));
+
+  auto intensityAttr = sphereLight.CreateIntensityAttr();
+  assert(intensityAttr);
+  intensityAttr.Set(sphereLightData.intensity);
+
+  auto radiusAttr = sphereLight.CreateRadiusAttr();
+  assert(radiusAttr);
+  radiusAttr.Set(sphereLightData.radius);
+
+  auto shaping = pxr::UsdLuxShapingAPI(sphereLight.GetPrim());
+
+  // Note: Remix uses a different default from USD, so 180 must be specified here.
+  auto coneAngleAttr = shaping.CreateShapingConeAngleAttr(pxr::VtValue(180.0f));
+  assert(coneAngleAttr);
+
+  auto coneSoftnessAttr = shaping.CreateShapingConeSoftnessAttr();
+  assert(coneSoftnessAttr);
+  
+  auto FocusExponentAttr = shaping.CreateShapingFocusAttr();
+  assert(FocusExponentAttr);
+
+  // Note: Set the shaping attribute values only if shaping is enabled. Shaping attributes must still
+  // be created though even if shaping is disabled to ensure proper exporting of all the required
+  // attributes on a captured light (as external programs expect this to be the case).
+  if (sphereLightData.shapingEnabled) {
+    coneAngleAttr.Set(sphereLightData.coneAngleDegrees);
+    coneSoftnessAttr.Set(sphereLightData.coneSoftness);
+    FocusExponentAttr.Set(sphereLightData.focusExponent);
+  }
+
+  shaping.Apply(sphereLight.GetPrim());
+
+  setTimeSampledXforms(lightStage, lightAssetSdfPath,
+                       sphereLightData.firstTime, sphereLightData.finalTime, sphereLightData.xforms,
+                       exportData.meta, false);
+  
+  pxr::UsdLuxLightAPI lightAPI(sphereLight.GetPrim());
+  setLightIntensityOnTimeSpan(lightAPI, sphereLightData.intensity, sphereLightData.firstTime, sphereLightData.finalTime, exportData.meta.numFramesCaptured);
+  lightAPI.Apply(sphereLight.GetPrim());
+
+  lightStage->Save();
+}
+
 void GameExporter::exportDistantLights(const Export& exportData, ExportContext& ctx) {
   dxvk::Logger::debug("[GameExporter][" + exportData.debugId + "][exportDistantLights] Begin");
   for(const auto& [id,distantLightData] : exportData.distantLights) {
@@ -41,7 +41,12 @@ public:
   static void setMultiThreadSafety(const bool enable) {
     s_bMultiThreadSafety = enable;
   }
-  static void exportUsd(const Export& exportData);
+  // Number of threads authoring the per-asset stages, 0 uses every hardware thread
+  static void setNumWorkerThreads(const uint32_t numThreads) {
+    s_numWorkerThreads = numThreads;
+  }
+  // Returns false if the export was cancelled, the instance stage is not written in that case
+  static bool exportUsd(const Export& exportData, ExportProgress* pProgress = nullptr);
 private:
   struct Reference {
     std::string  stagePath;
@@ -54,34 +59,51 @@ private:
     IdMap<Reference> matReferences;
     IdMap<Reference> meshReferences;
     IdMap<Skeleton> skeletons;
-    
+    ExportProgress* pProgress = nullptr;
+    uint32_t numThreads = 1;
+
+    bool isCancelled() const {
+      return pProgress != nullptr && pProgress->bCancel;
+    }
+    void onAssetExported() const {
+      if (pProgress != nullptr) {
+        ++pProgress->numAssetsExported;
+      }
+    }
   };
-  static void exportUsdInternal(const Export& exportData);
+  static bool exportUsdInternal(const Export& exportData, ExportProgress* pProgress);
   static pxr::UsdStageRefPtr createInstanceStage(const Export& exportData);
   static void setCommonStageMetaData(pxr::UsdStageRefPtr stage, const Export& exportData);
   static void createApertureMdls(const std::string& baseExportPath);
   static void exportMaterials(const Export& exportData, ExportContext& ctx);
+  static Reference exportMaterialStage(const Export& exportData,
+                                       const ExportContext& ctx,
+                                       const Material& matData,
+                                       const std::string& matDirPath,
+                                       const std::string& fullMaterialBasePath);
   static void exportMeshes(const Export& exportData, ExportContext& ctx);
-  struct ReducedIdxBufSet {
-    BufSet<Index> bufSet;
-    // Per-timecode idx mapping
-    using IdxMap = std::unordered_map<int,int>;
-    std::map<float,IdxMap> redToOgSet;
-  };
-  static ReducedIdxBufSet reduceIdxBufferSet(const BufSet<Index>& idxBufSet);
-  template<typename T>
-  static BufSet<T> reduceBufferSet(const BufSet<T>& bufSet,
-                                   const ReducedIdxBufSet& reducedIdxBufSet,
-                                   size_t elemsPerIdx = 1);
+  static Reference exportMeshStage(const Export& exportData,
+                                   const ExportContext& ctx,
+                                   const Mesh& mesh,
+                                   const std::string& meshDirPath,
+                                   const std::string& fullMeshStagePath);
   template<typename BufferT>
   static void exportBufferSet(const BufSet<BufferT>& bufSet, pxr::UsdAttribute attr);
   static void exportColorOpacityBufferSet(const BufSet<Color>& bufSet,
                                           pxr::UsdAttribute color,
                                           pxr::UsdAttribute opacity);
   static void exportSkeletons(const Export& exportData, ExportContext& ctx);
+  static Skeleton exportSkeletonStage(const Export& exportData,
+                                      const ExportContext& ctx,
+                                      const Mesh& mesh,
+                                      const std::string& dirPath);
   static void exportInstances(const Export& exportData, ExportContext& ctx);
   static void exportCamera(const Export& exportData, ExportContext& ctx);
   static void exportSphereLights(const Export& exportData, ExportContext& ctx);
+  static void exportSphereLightStage(const Export& exportData,
+                                     const ExportContext& ctx,
+                                     const SphereLight& sphereLightData,
+                                     const std::string& lightDirPath);
   static void exportDistantLights(const Export& exportData, ExportContext& ctx);
   static void exportSky(const Export& exportData, ExportContext& ctx);
   static void setTimeSampledXforms(const pxr::UsdStageRefPtr stage,
@@ -113,6 +135,7 @@ private:
   static pxr::UsdStageRefPtr findOpenOrCreateStage(const std::string path, const bool bClearIfExists = false);
 
   static bool s_bMultiThreadSafety;
+  static uint32_t s_numWorkerThreads;
   static std::mutex s_mutex;
 };
 
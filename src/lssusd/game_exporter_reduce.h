@@ -0,0 +1,139 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include "game_exporter_types.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace lss {
+
+// Index buffers with unused vertices removed, and the per-timecode tables mapping the remaining vertices
+// back to the original vertex buffers.
+struct ReducedIdxBufSet {
+  BufSet<Index> bufSet;
+  // Reduced index -> original index, time codes with identical index buffers share one table
+  using IdxTable = std::vector<Index>;
+  std::map<float, std::shared_ptr<const IdxTable>> redToOgSet;
+
+  const IdxTable& getIdxTable(const float timeCode) const {
+    // There may not be a 1:1 mapping in timecodes b/w index buffers and other buffers
+    auto iTable = redToOgSet.lower_bound(timeCode);
+    if (iTable == redToOgSet.cend()) {
+      assert(!redToOgSet.empty());
+      iTable = std::prev(iTable);
+    }
+    return *iTable->second;
+  }
+};
+
+// Renumbers the used vertices of every index buffer in ascending order, in linear time.
+inline ReducedIdxBufSet reduceIdxBufferSet(const BufSet<Index>& idxBufSet) {
+  ReducedIdxBufSet reducedIdxBufSet;
+
+  // Scratch shared by all time codes, holds the new index of every used vertex
+  std::vector<Index> ogToRed;
+
+  struct Reduced {
+    const Buf<Index>* pOgBuf;
+    Buf<Index> redBuf;
+    std::shared_ptr<const ReducedIdxBufSet::IdxTable> redToOg;
+  };
+  std::unordered_multimap<XXH64_hash_t, Reduced> reducedByHash;
+
+  for (const auto& [timeCode, idxBuf] : idxBufSet) {
+    const XXH64_hash_t hash = XXH3_64bits(idxBuf.cdata(), idxBuf.size() * sizeof(Index));
+    const Reduced* pShared = nullptr;
+    const auto range = reducedByHash.equal_range(hash);
+    for (auto iReduced = range.first; iReduced != range.second; ++iReduced) {
+      if (*iReduced->second.pOgBuf == idxBuf) {
+        pShared = &iReduced->second;
+        break;
+      }
+    }
+    if (pShared != nullptr) {
+      // VtArray copies share their storage, so this is free
+      reducedIdxBufSet.bufSet[timeCode] = pShared->redBuf;
+      reducedIdxBufSet.redToOgSet[timeCode] = pShared->redToOg;
+      continue;
+    }
+
+    // Mark the used vertices
+    Index maxIdx = -1;
+    for (const Index ogIdx : idxBuf) {
+      assert(ogIdx >= 0);
+      maxIdx = std::max(maxIdx, ogIdx);
+    }
+    ogToRed.assign(static_cast<size_t>(maxIdx + 1), -1);
+    for (const Index ogIdx : idxBuf) {
+      ogToRed[ogIdx] = 0;
+    }
+
+    // Prefix sum over the used vertices gives the new indices
+    auto redToOg = std::make_shared<ReducedIdxBufSet::IdxTable>();
+    for (Index ogIdx = 0; ogIdx <= maxIdx; ++ogIdx) {
+      if (ogToRed[ogIdx] >= 0) {
+        ogToRed[ogIdx] = static_cast<Index>(redToOg->size());
+        redToOg->push_back(ogIdx);
+      }
+    }
+
+    Buf<Index> redBuf;
+    redBuf.resize(idxBuf.size());
+    Index* const pRedIdx = redBuf.data();
+    for (size_t i = 0; i < idxBuf.size(); ++i) {
+      pRedIdx[i] = ogToRed[idxBuf[i]];
+      assert(pRedIdx[i] <= idxBuf[i]);
+    }
+
+    reducedIdxBufSet.bufSet[timeCode] = redBuf;
+    reducedIdxBufSet.redToOgSet[timeCode] = redToOg;
+    reducedByHash.emplace(hash, Reduced { &idxBuf, std::move(redBuf), std::move(redToOg) });
+  }
+  return reducedIdxBufSet;
+}
+
+// Gathers the elements of the vertices kept by reduceIdxBufferSet, elemsPerIdx elements per vertex.
+template<typename T>
+BufSet<T> reduceBufferSet(const BufSet<T>& bufSet, const ReducedIdxBufSet& reducedIdxBufSet, const size_t elemsPerIdx = 1) {
+  BufSet<T> reducedBufSet;
+  for (const auto& [timeCode, buf] : bufSet) {
+    const ReducedIdxBufSet::IdxTable& redIdxToOgIdx = reducedIdxBufSet.getIdxTable(timeCode);
+
+    Buf<T>& reducedBuf = reducedBufSet[timeCode];
+    reducedBuf.resize(redIdxToOgIdx.size() * elemsPerIdx);
+    T* const pReduced = reducedBuf.data();
+    const T* const pOg = buf.cdata();
+    for (size_t redIdx = 0; redIdx < redIdxToOgIdx.size(); ++redIdx) {
+      const size_t ogElem = static_cast<size_t>(redIdxToOgIdx[redIdx]) * elemsPerIdx;
+      assert(ogElem + elemsPerIdx <= buf.size());
+      std::copy(pOg + ogElem, pOg + ogElem + elemsPerIdx, pReduced + redIdx * elemsPerIdx);
+    }
+  }
+  return reducedBufSet;
+}
+
+}
@@ -32,6 +32,7 @@
 
 
 #include <stdint.h>
+#include <atomic>
 #include <limits>
 #include <map>
 
@@ -226,4 +227,20 @@ struct Export {
   pxr::GfMatrix4d globalXform = pxr::GfMatrix4d{1.0};
 };
 
-}
\ No newline at end of file
+// Progress of an export, may be polled and cancelled from other threads while the export is running
+struct ExportProgress {
+  std::atomic<size_t> numAssetsTotal = 0;
+  std::atomic<size_t> numAssetsExported = 0;
+  std::atomic<bool>   bCancel = false;
+
+  void reset() {
+    numAssetsTotal = 0;
+    numAssetsExported = 0;
+    bCancel = false;
+  }
+  float getFraction() const {
+    const size_t total = numAssetsTotal;
+    return total == 0 ? 0.f : static_cast<float>(numAssetsExported) / static_cast<float>(total);
+  }
+};
+}
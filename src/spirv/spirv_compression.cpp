@@ -1,110 +1,252 @@
 #include "spirv_compression.h"
 
+// NV-DXVK start: vectorized packing and LZ4 tier
+#include <cstring>
+#include <tmmintrin.h>
+
+#include "../util/util_fastops.h"
+#include "../util/util_lz4.h"
+// NV-DXVK end
+
 namespace dxvk {
 
+  // NV-DXVK start: vectorized packing and LZ4 tier
+  namespace {
+    // The packed stream is the concatenation of the low bytes of each
+    // DWORD, since bit::pack fills the 64-bit words from the low end.
+    // Four DWORDs share one byte of the mask, which selects a shuffle
+    // that moves their bytes into or out of the stream.
+    struct ShuffleTables {
+      alignas(16) uint8_t pack[256][16];
+      alignas(16) uint8_t unpack[256][16];
+      uint8_t             length[256];
+    };
+
+    ShuffleTables createShuffleTables() {
+      ShuffleTables tables;
+      std::memset(&tables, 0x80, sizeof(tables));
+
+      for (uint32_t control = 0; control < 256; control++) {
+        uint32_t offset = 0;
+
+        for (uint32_t w = 0; w < 4; w++) {
+          const uint32_t bytes = ((control >> (2 * w)) & 3) + 1;
+
+          for (uint32_t b = 0; b < bytes; b++) {
+            tables.pack[control][offset + b] = uint8_t(4 * w + b);
+            tables.unpack[control][4 * w + b] = uint8_t(offset + b);
+          }
+
+          offset += bytes;
+        }
+
+        tables.length[control] = uint8_t(offset);
+      }
+
+      return tables;
+    }
+
+    const ShuffleTables g_shuffleTables = createShuffleTables();
+
+    bool useShuffles() {
+      // pshufb is SSSE3, which every CPU with SSE4.1 supports
+      static const bool supported = fast::getSimdSupportLevel() >= fast::SIMD::SSE4_1;
+      return supported;
+    }
+
+    inline uint32_t getByteCount(uint32_t word) {
+      if      (word < (1 <<  8)) return 0;
+      else if (word < (1 << 16)) return 1;
+      else if (word < (1 << 24)) return 2;
+      else                       return 3;
+    }
+
+    /**
+     * Packs count DWORDs into dst, which needs 16 bytes
+     * of space beyond the packed size, and returns the
+     * number of bytes written.
+     */
+    size_t pack(const uint32_t* src, uint32_t count, uint64_t* mask, uint8_t* dst) {
+      constexpr uint32_t NumMaskWords = 32;
+
+      size_t   pos = 0;
+      uint32_t i   = 0;
+
+      if (useShuffles()) {
+        // Unsigned compares through the sign bit, there is no _mm_cmpgt_epu32
+        const __m128i signBit = _mm_set1_epi32(INT32_MIN);
+        const __m128i limit8  = _mm_set1_epi32(int32_t(0x000000FFu ^ 0x80000000u));
+        const __m128i limit16 = _mm_set1_epi32(int32_t(0x0000FFFFu ^ 0x80000000u));
+        const __m128i limit24 = _mm_set1_epi32(int32_t(0x00FFFFFFu ^ 0x80000000u));
+        const __m128i lowBytes = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+        for (; i + 4 <= count; i += 4) {
+          const __m128i words  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+          const __m128i biased = _mm_xor_si128(words, signBit);
+
+          const __m128i negCounts = _mm_add_epi32(
+            _mm_add_epi32(_mm_cmpgt_epi32(biased, limit8), _mm_cmpgt_epi32(biased, limit16)),
+            _mm_cmpgt_epi32(biased, limit24));
+
+          // One byte count per lane, gathered into the two-bit fields of the control byte
+          const uint32_t counts = uint32_t(_mm_cvtsi128_si32(
+            _mm_shuffle_epi8(_mm_sub_epi32(_mm_setzero_si128(), negCounts), lowBytes)));
+          const uint32_t control = (counts | (counts >> 6) | (counts >> 12) | (counts >> 18)) & 0xFF;
+
+          const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(g_shuffleTables.pack[control]));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + pos), _mm_shuffle_epi8(words, shuffle));
+
+          mask[i / NumMaskWords] |= uint64_t(control) << (2 * (i % NumMaskWords));
+          pos += g_shuffleTables.length[control];
+        }
+      }
+
+      for (; i < count; i++) {
+        const uint32_t bytes = getByteCount(src[i]);
+        std::memcpy(dst + pos, &src[i], bytes + 1);
+
+        mask[i / NumMaskWords] |= uint64_t(bytes) << (2 * (i % NumMaskWords));
+        pos += bytes + 1;
+      }
+
+      return pos;
+    }
+
+    void unpack(const uint8_t* src, size_t srcSize, const uint64_t* mask, uint32_t count, uint32_t* dst) {
+      constexpr uint32_t NumMaskWords = 32;
+
+      size_t   pos = 0;
+      uint32_t i   = 0;
+
+      if (useShuffles()) {
+        // Each group reads 16 bytes, the rest is unpacked one DWORD at a time
+        for (; i + 4 <= count && pos + 16 <= srcSize; i += 4) {
+          const uint32_t control = uint32_t(mask[i / NumMaskWords] >> (2 * (i % NumMaskWords))) & 0xFF;
+
+          const __m128i bytes   = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + pos));
+          const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(g_shuffleTables.unpack[control]));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_shuffle_epi8(bytes, shuffle));
+
+          pos += g_shuffleTables.length[control];
+        }
+      }
+
+      for (; i < count; i++) {
+        const uint32_t bytes = uint32_t(mask[i / NumMaskWords] >> (2 * (i % NumMaskWords))) & 3;
+
+        if (unlikely(pos + bytes + 1 > srcSize))
+          break;
+
+        uint32_t word = 0;
+        std::memcpy(&word, src + pos, bytes + 1);
+
+        dst[i] = word;
+        pos += bytes + 1;
+      }
+    }
+  }
+  // NV-DXVK end
+
+
   SpirvCompressedBuffer::SpirvCompressedBuffer()
   : m_size(0) {
 
   }
 
 
+  // NV-DXVK start: vectorized packing and LZ4 tier
   SpirvCompressedBuffer::SpirvCompressedBuffer(
-    const SpirvCodeBuffer& code)
+    const SpirvCodeBuffer& code,
+          bool             allowLz4)
   : m_size(code.dwords()) {
-    const uint32_t* data = code.data();
-
     // The compression works by eliminating leading null bytes
     // from DWORDs, exploiting that SPIR-V IDs are consecutive
     // integers that usually fall into the 16-bit range. For
     // each DWORD, a two-bit integer is stored which indicates
     // the number of bytes it takes in the compressed buffer.
     // This way, it can achieve a compression ratio of ~50%.
-    m_mask.reserve((m_size + NumMaskWords - 1) / NumMaskWords);
-    m_code.reserve((m_size + 1) / 2);
-
-    uint64_t dstWord  = 0;
-    uint32_t dstShift = 0;
+    m_mask.resize((m_size + NumMaskWords - 1) / NumMaskWords);
 
-    for (uint32_t i = 0; i < m_size; i += NumMaskWords) {
-      uint64_t byteCounts = 0;
+    // Room for the worst case plus one 16-byte store past the end
+    m_code.resize((size_t(m_size) * sizeof(uint32_t) + 16 + 7) / 8);
 
-      for (uint32_t w = 0; w < NumMaskWords && i + w < m_size; w++) {
-        uint64_t word = data[i + w];
-        uint64_t bytes = 0;
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(m_code.data());
+    const size_t packedSize = pack(code.data(), m_size, m_mask.data(), bytes);
 
-        if      (word < (1 <<  8)) bytes = 0;
-        else if (word < (1 << 16)) bytes = 1;
-        else if (word < (1 << 24)) bytes = 2;
-        else                       bytes = 3;
-
-        byteCounts |= bytes << (2 * w);
+    // Bytes past the end of the stream were written by the last store
+    m_code.resize((packedSize + 7) / 8);
+    std::memset(bytes + packedSize, 0, m_code.size() * sizeof(uint64_t) - packedSize);
+    m_code.shrink_to_fit();
 
-        uint32_t bits = 8 * bytes + 8;
-        uint32_t rem  = bit::pack(dstWord, dstShift, word, bits);
+    // Shaders that stay in memory can trade a pass over the
+    // packed stream per decompression for another ~2x in size
+    const size_t packedBytes = m_code.size() * sizeof(uint64_t);
 
-        if (unlikely(rem != 0)) {
-          m_code.push_back(dstWord);
+    if (allowLz4 && packedBytes >= Lz4MinPackedSize) {
+      std::vector<uint8_t> compressed(lz4::compressBound(packedBytes));
+      compressed.resize(lz4::compress(reinterpret_cast<const uint8_t*>(m_code.data()), packedBytes, compressed.data()));
 
-          dstWord  = 0;
-          dstShift = 0;
+      if (compressed.size() <= packedBytes - packedBytes / 4) {
+        compressed.shrink_to_fit();
 
-          bit::pack(dstWord, dstShift, word >> (bits - rem), rem);
-        }
+        m_codeWords = uint32_t(m_code.size());
+        m_lz4 = std::move(compressed);
+        m_code = std::vector<uint64_t>();
       }
-
-      m_mask.push_back(byteCounts);
     }
+  }
+  // NV-DXVK end
 
-    if (dstShift)
-      m_code.push_back(dstWord);
 
-    m_mask.shrink_to_fit();
-    m_code.shrink_to_fit();
+  // NV-DXVK start: restore compressed code, e.g. from a disk cache
+  SpirvCompressedBuffer::SpirvCompressedBuffer(
+          uint32_t              size,
+          std::vector<uint64_t> mask,
+          std::vector<uint64_t> code)
+  : m_size(size), m_mask(std::move(mask)), m_code(std::move(code)) {
+
   }
+  // NV-DXVK end
+
 
-    
   SpirvCompressedBuffer::~SpirvCompressedBuffer() {
 
   }
 
 
-  SpirvCodeBuffer SpirvCompressedBuffer::decompress() const {
-    SpirvCodeBuffer code(m_size);
-    uint32_t* data = code.data();
-
-    if (m_size == 0)
-      return code;
+  // NV-DXVK start: vectorized packing and LZ4 tier
+  std::vector<uint64_t> SpirvCompressedBuffer::getCode() const {
+    if (m_lz4.empty())
+      return m_code;
 
-    uint32_t maskIdx = 0;
-    uint32_t codeIdx = 0;
+    std::vector<uint64_t> code(m_codeWords);
 
-    uint64_t srcWord  = m_code[codeIdx++];
-    uint32_t srcShift = 0;
+    if (!lz4::decompress(m_lz4.data(), m_lz4.size(),
+          reinterpret_cast<uint8_t*>(code.data()), code.size() * sizeof(uint64_t)))
+      throw DxvkError("SpirvCompressedBuffer: Failed to decompress LZ4 code");
 
-    for (uint32_t i = 0; i < m_size; i += NumMaskWords) {
-      uint64_t srcMask = m_mask[maskIdx++];
+    return code;
+  }
 
-      for (uint32_t w = 0; w < NumMaskWords && i + w < m_size; w++) {
-        uint32_t bits = 8 * ((srcMask & 3) + 1);
 
-        uint64_t word = 0;
-        uint32_t rem = bit::unpack(word, srcWord, srcShift, bits);
+  SpirvCodeBuffer SpirvCompressedBuffer::decompress() const {
+    SpirvCodeBuffer code(m_size);
 
-        if (unlikely(rem != 0)) {
-          srcWord  = m_code[codeIdx++];
-          srcShift = 0;
+    if (m_size == 0)
+      return code;
 
-          uint64_t tmp = 0;
-          bit::unpack(tmp, srcWord, srcShift, rem);
-          word |= tmp << (bits - rem);
-        }
+    if (m_lz4.empty()) {
+      unpack(reinterpret_cast<const uint8_t*>(m_code.data()), m_code.size() * sizeof(uint64_t),
+        m_mask.data(), m_size, code.data());
+    } else {
+      const std::vector<uint64_t> packed = getCode();
 
-        data[i + w] = word;
-        srcMask >>= 2;
-      }
+      unpack(reinterpret_cast<const uint8_t*>(packed.data()), packed.size() * sizeof(uint64_t),
+        m_mask.data(), m_size, code.data());
     }
 
     return code;
   }
+  // NV-DXVK end
 
-}
\ No newline at end of file
+}
@@ -37,18 +37,70 @@ namespace dxvk {
     constexpr static uint32_t NumMaskWords = 32;
   public:
 
+    // NV-DXVK start: LZ4 tier for long-lived shaders
+    /**
+     * \brief Packed code size from which LZ4 is tried
+     *
+     * Only applies to buffers created with \c allowLz4.
+     * Smaller shaders don't save enough memory to be
+     * worth the extra pass in \ref decompress.
+     */
+    constexpr static size_t Lz4MinPackedSize = 4096;
+    // NV-DXVK end
+
     SpirvCompressedBuffer();
 
+    // NV-DXVK start: LZ4 tier for long-lived shaders
+    SpirvCompressedBuffer(
+      const SpirvCodeBuffer&  code,
+            bool              allowLz4 = false);
+    // NV-DXVK end
+
+    // NV-DXVK start: restore compressed code, e.g. from a disk cache
     SpirvCompressedBuffer(
-      const SpirvCodeBuffer&  code);
+            uint32_t              size,
+            std::vector<uint64_t> mask,
+            std::vector<uint64_t> code);
+    // NV-DXVK end
     
     ~SpirvCompressedBuffer();
     
     SpirvCodeBuffer decompress() const;
 
-    const std::vector<uint64_t>& getCode() const {
-      return m_code;
+    // NV-DXVK start: LZ4 tier for long-lived shaders
+    /**
+     * \brief Packed code
+     *
+     * Independent of whether the LZ4 tier is used,
+     * the returned code is always the packed stream.
+     */
+    std::vector<uint64_t> getCode() const;
+    // NV-DXVK end
+
+    // NV-DXVK start: expose the compressed representation
+    uint32_t getDwordCount() const {
+      return m_size;
+    }
+
+    const std::vector<uint64_t>& getMask() const {
+      return m_mask;
     }
+    // NV-DXVK end
+
+    // NV-DXVK start: LZ4 tier for long-lived shaders
+    bool isLz4Compressed() const {
+      return !m_lz4.empty();
+    }
+
+    /**
+     * \brief Memory held by the buffer, in bytes
+     */
+    size_t getAllocatedSize() const {
+      return m_mask.capacity() * sizeof(uint64_t)
+           + m_code.capacity() * sizeof(uint64_t)
+           + m_lz4.capacity();
+    }
+    // NV-DXVK end
 
   private:
 
@@ -56,6 +108,13 @@ namespace dxvk {
     std::vector<uint64_t> m_mask;
     std::vector<uint64_t> m_code;
 
+    // NV-DXVK start: LZ4 tier for long-lived shaders
+    // With the LZ4 tier, m_code is empty and m_lz4
+    // holds the packed stream of m_codeWords words
+    uint32_t              m_codeWords = 0;
+    std::vector<uint8_t>  m_lz4;
+    // NV-DXVK end
+
   };
 
 }
\ No newline at end of file
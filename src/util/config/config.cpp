@@ -20,9 +20,13 @@
 * DEALINGS IN THE SOFTWARE.
 */
 #include <array>
+#include <cctype>
+#include <charconv>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <optional>
 #include <regex>
 #include <utility>
 #include <filesystem>
@@ -966,7 +970,8 @@ namespace dxvk {
   }
 
 
-  static size_t skipWhitespace(const std::string& line, size_t n) {
+  // NV-DXVK start: parse lines in place
+  static size_t skipWhitespace(std::string_view line, size_t n) {
     while (n < line.size() && isWhitespace(line[n]))
       n += 1;
     return n;
@@ -974,14 +979,12 @@ namespace dxvk {
 
 
   struct ConfigContext {
-    bool active;
+    bool        active;
+    std::string exeName;
   };
 
 
-  static void parseUserConfigLine(Config& config, ConfigContext& ctx, const std::string& line) {
-    std::stringstream key;
-    std::stringstream value;
-
+  static void parseUserConfigLine(Config& config, ConfigContext& ctx, std::string_view line) {
     // Extract the key
     size_t n = skipWhitespace(line, 0);
 
@@ -992,38 +995,92 @@ namespace dxvk {
       while (e > n && line[e] != ']')
         e -= 1;
 
-      while (n < e)
-        key << line[n++];
-      
-      ctx.active = key.str() == env::getExeName();
+      ctx.active = line.substr(n, e - n) == ctx.exeName;
     } else {
+      const size_t keyBegin = n;
+
       while (n < line.size() && isValidKeyChar(line[n]))
-        key << line[n++];
-      
+        n += 1;
+
+      const std::string_view key = line.substr(keyBegin, n - keyBegin);
+
       // Check whether the next char is a '='
       n = skipWhitespace(line, n);
       if (n >= line.size() || line[n] != '=')
         return;
 
-      // Extract the value
-      bool insideString = false;
+      if (!ctx.active)
+        return;
+
+      // Extract the value, dropping the quotes around strings
       n = skipWhitespace(line, n + 1);
 
+      std::string value;
+      value.reserve(line.size() - n);
+
       while (n < line.size()) {
-        // NV-DXVK start: allow white-space in vector entries within a line
-        // NV-DXVK end
-        if (line[n] == '"') {
-          insideString = !insideString;
-          n++;
-        } else
-          value << line[n++];
+        const size_t quote = line.find('"', n);
+        value.append(line.substr(n, quote - n));
+        n = quote == std::string_view::npos ? line.size() : quote + 1;
       }
-      
-      if (ctx.active)
-        config.setOption(key.str(), value.str());
+
+      config.setOptionMove(std::string(key), std::move(value));
     }
   }
 
+
+  /**
+   * \brief Splits a list option at commas
+   *
+   * Matches \c std::getline on a string stream: entries are not
+   * trimmed, and an empty entry at the end of the list is dropped.
+   */
+  template<typename Fn>
+  static void forEachListEntry(std::string_view value, Fn&& fn) {
+    size_t n = 0;
+
+    while (n < value.size()) {
+      size_t e = value.find(',', n);
+
+      if (e == std::string_view::npos)
+        e = value.size();
+
+      fn(value.substr(n, e - n));
+      n = e + 1;
+    }
+  }
+
+
+  static std::string_view trimWhitespace(std::string_view str) {
+    while (!str.empty() && (isWhitespace(str.front()) || str.front() == '\n'))
+      str.remove_prefix(1);
+    while (!str.empty() && (isWhitespace(str.back()) || str.back() == '\n'))
+      str.remove_suffix(1);
+    return str;
+  }
+
+
+  template<typename T, size_t N>
+  static bool parseVectorOption(std::string_view value, T& result) {
+    size_t count = 0;
+
+    forEachListEntry(value, [&] (std::string_view entry) {
+      if (count >= N || count == size_t(-1))
+        return;
+
+      float element;
+      if (!Config::parseOptionValue(std::string(entry), element)) {
+        count = size_t(-1);
+        return;
+      }
+
+      result[count++] = element;
+    });
+
+    return count == N;
+  }
+  // NV-DXVK end
+
   // NV-DXVK start: Configuration parsing logic moved out for sharing between multiple configuration loading functions
   static Config parseConfigFile(std::string filePath) {
     Config config;
@@ -1043,12 +1100,30 @@ namespace dxvk {
     // Initialize parser context
     ConfigContext ctx;
     ctx.active = true;
+    ctx.exeName = env::getExeName();
+
+    // NV-DXVK start: parse lines in place
+    // Read the whole file at once and parse it line by line
+    const std::string contents { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+    const std::string_view text = contents;
 
-    // Parse the file line by line
-    std::string line;
+    size_t n = 0;
+
+    while (n < text.size()) {
+      size_t e = text.find('\n', n);
+
+      if (e == std::string_view::npos)
+        e = text.size();
+
+      std::string_view line = text.substr(n, e - n);
+
+      if (!line.empty() && line.back() == '\r')
+        line.remove_suffix(1);
 
-    while (std::getline(stream, line))
       parseUserConfigLine(config, ctx, line);
+      n = e + 1;
+    }
+    // NV-DXVK end
     
     Logger::info("Parsed config file.");
     return config;
@@ -1064,8 +1139,16 @@ namespace dxvk {
 
 
   void Config::merge(const Config& other) {
-    for (auto& pair : other.m_options)
+    // NV-DXVK start: cache parsed option values
+    std::lock_guard<dxvk::mutex> lock(m_parsedValues.mutex);
+    // NV-DXVK end
+
+    for (auto& pair : other.m_options) {
       m_options[pair.first] = pair.second;
+      // NV-DXVK start: cache parsed option values
+      m_parsedValues.values.erase(pair.first);
+      // NV-DXVK end
+    }
   }
 
   // NV-DXVK start: new methods
@@ -1126,11 +1209,15 @@ namespace dxvk {
   // NV-DXVK end
 
   void Config::setOption(const std::string& key, const std::string& value) {
+    // NV-DXVK start: cache parsed option values
+    invalidateParsedValue(key);
+    // NV-DXVK end
     m_options.insert_or_assign(key, value);
   }
 
   // NV-DXVK start: rvalue variant for less allocations
   void Config::setOptionMove(std::string&& key, std::string&& value) {
+    invalidateParsedValue(key);
     m_options.insert_or_assign(std::move(key), std::move(value));
   }
   // NV-DXVK end
@@ -1173,12 +1260,19 @@ namespace dxvk {
     setOption(key, generateOptionString(value));
   }
 
-  std::string Config::getOptionValue(const char* option) const {
+  // NV-DXVK start: cache parsed option values
+  const std::string* Config::findOptionValue(const char* option) const {
     auto iter = m_options.find(option);
 
     return iter != m_options.end()
-      ? iter->second : std::string();
+      ? &iter->second : nullptr;
+  }
+
+  void Config::invalidateParsedValue(const std::string& key) {
+    std::lock_guard<dxvk::mutex> lock(m_parsedValues.mutex);
+    m_parsedValues.values.erase(key);
   }
+  // NV-DXVK end
 
   bool Config::parseOptionValue(
     const std::string&  value,
@@ -1192,14 +1286,62 @@ namespace dxvk {
   bool Config::parseOptionValue(
     const std::string& value,
     std::vector<std::string>& result) {
-    std::stringstream ss(value);
-    std::string s;
-    while (std::getline(ss, s, ',')) {
-      result.push_back(s);
-    }
+    // NV-DXVK start: split lists in place
+    forEachListEntry(value, [&result] (std::string_view entry) {
+      result.emplace_back(entry);
+    });
+    // NV-DXVK end
     return true;
   }
 
+  // NV-DXVK start: typed list options
+  bool Config::parseOptionValue(
+    const std::string& value,
+    std::vector<uint64_t>& result) {
+    result.clear();
+
+    forEachListEntry(value, [&result] (std::string_view entry) {
+      entry = trimWhitespace(entry);
+
+      if (entry.size() >= 2 && entry[0] == '0' && (entry[1] == 'x' || entry[1] == 'X'))
+        entry.remove_prefix(2);
+
+      uint64_t hash = 0;
+      auto [end, ec] = std::from_chars(entry.data(), entry.data() + entry.size(), hash, 16);
+
+      if (ec == std::errc() && end == entry.data() + entry.size())
+        result.push_back(hash);
+      else if (!entry.empty())
+        Logger::warn(str::format("Config: Skipping invalid hash \"", entry, "\""));
+    });
+
+    return true;
+  }
+
+  bool Config::parseOptionValue(
+    const std::string& value,
+    std::vector<int32_t>& result) {
+    result.clear();
+
+    forEachListEntry(value, [&result] (std::string_view entry) {
+      entry = trimWhitespace(entry);
+
+      if (!entry.empty() && entry[0] == '+')
+        entry.remove_prefix(1);
+
+      int32_t element = 0;
+      auto [end, ec] = std::from_chars(entry.data(), entry.data() + entry.size(), element);
+
+      if (ec == std::errc() && end == entry.data() + entry.size())
+        result.push_back(element);
+      else if (!entry.empty())
+        Logger::warn(str::format("Config: Skipping invalid integer \"", entry, "\""));
+    });
+
+    return true;
+  }
+  // NV-DXVK end
+
   bool Config::parseOptionValue(
     const std::string&  value,
           bool&         result) {
@@ -1270,97 +1412,62 @@ namespace dxvk {
   bool Config::parseOptionValue(
     const std::string& value,
     Vector2i& result) {
-    std::stringstream ss(value);
-    std::string s;
-    for (int i = 0; i < 2; ++i) {
-      if (!std::getline(ss, s, ',')) {
-        return false;
-      }
+    // NV-DXVK start: split lists in place
+    size_t count = 0;
+
+    forEachListEntry(value, [&] (std::string_view entry) {
+      if (count >= 2 || count == size_t(-1))
+        return;
 
-      int value;
-      if (!parseOptionValue(s, value)) {
-        return false;
+      int element;
+      if (!parseOptionValue(std::string(entry), element)) {
+        count = size_t(-1);
+        return;
       }
 
-      result[i] = value;
-    }
+      result[count++] = element;
+    });
 
-    return true;
+    return count == 2;
+    // NV-DXVK end
   }
 
   // NV-DXVK start: added a variant
   bool Config::parseOptionValue(
     const std::string& value,
     Vector2& result) {
-    std::stringstream ss(value);
-    std::string s;
-    for (int i = 0; i < 2; ++i) {
-      if (!std::getline(ss, s, ',')) {
-        return false;
-      }
-
-      float value;
-      if (!parseOptionValue(s, value)) {
-        return false;
-      }
-
-      result[i] = value;
-    }
-
-    return true;
+    // NV-DXVK start: split lists in place
+    return parseVectorOption<Vector2, 2>(value, result);
+    // NV-DXVK end
   }
 
 
   bool Config::parseOptionValue(
     const std::string& value,
     Vector4& result) {
-    std::stringstream ss(value);
-    std::string s;
-    for (int i = 0; i < 4; ++i) {
-      if (!std::getline(ss, s, ',')) {
-        return false;
-      }
-
-      float value;
-      if (!parseOptionValue(s, value)) {
-        return false;
-      }
-
-      result[i] = value;
-    }
-    return true;
+    // NV-DXVK start: split lists in place
+    return parseVectorOption<Vector4, 4>(value, result);
+    // NV-DXVK end
   }
   // NV-DXVK end
 
   bool Config::parseOptionValue(
     const std::string& value,
     Vector3& result) {
-    std::stringstream ss(value);
-    std::string s;
-    for (int i = 0; i < 3; ++i) {
-      if (!std::getline(ss, s, ',')) {
-        return false;
-      }
-
-      float value;
-      if (!parseOptionValue(s, value)) {
-        return false;
-      }
-
-      result[i] = value;
-    }
-
-    return true;
+    // NV-DXVK start: split lists in place
+    return parseVectorOption<Vector3, 3>(value, result);
+    // NV-DXVK end
   }
   
   bool Config::parseOptionValue(
     const std::string& value,
     VirtualKeys& result) {
-    std::stringstream ss(value);
-    std::string s;
+    std::vector<std::string> entries;
+    parseOptionValue(value, entries);
+
     bool bFoundValidConfig = false;
     VirtualKeys virtKeys;
-    while (std::getline(ss, s, ',')) {
+    for (const std::string& s : entries) {
       VirtualKey vk;
       if(s.find("0x") != std::string::npos) {
         VkValue vkVal = std::stoul(s, nullptr, 16);
@@ -1453,12 +1560,80 @@ namespace dxvk {
   template Config Config::getConfig<Config::Type_RtxMod>(const std::string& adtlPath);
   // NV-DXVK end 
 
+  // NV-DXVK start: match app defaults without compiling every regex
+  /**
+   * \brief Matcher for an app defaults pattern
+   *
+   * Most patterns match a literal file name at the end of the
+   * executable path, those are compared directly. The others
+   * are compiled once, when the matchers are created.
+   */
+  struct AppDefaultsMatcher {
+    std::string               suffix;
+    std::optional<std::regex> regex;
+  };
+
+
+  static std::optional<std::string> getLiteralSuffix(const char* pattern) {
+    std::string suffix;
+
+    for (const char* p = pattern; *p; p++) {
+      if (*p == '\\') {
+        // Escaped letters and digits may be character classes
+        p += 1;
+        if (!*p || std::isalnum(static_cast<unsigned char>(*p)))
+          return std::nullopt;
+        suffix.push_back(*p);
+      } else if (*p == '$' && !p[1]) {
+        return Config::toLower(std::move(suffix));
+      } else if (std::strchr("^$.[]()|*+?{}", *p)) {
+        return std::nullopt;
+      } else {
+        suffix.push_back(*p);
+      }
+    }
+
+    // Not anchored to the end of the path
+    return std::nullopt;
+  }
+
+
+  static std::vector<AppDefaultsMatcher> createAppDefaultsMatchers() {
+    std::vector<AppDefaultsMatcher> matchers(g_appDefaults.size());
+
+    for (size_t i = 0; i < g_appDefaults.size(); i++) {
+      std::optional<std::string> suffix = getLiteralSuffix(g_appDefaults[i].first);
+
+      if (suffix)
+        matchers[i].suffix = std::move(*suffix);
+      else
+        matchers[i].regex.emplace(g_appDefaults[i].first, std::regex::extended | std::regex::icase);
+    }
+
+    return matchers;
+  }
+  // NV-DXVK end
+
   Config Config::getAppConfig(const std::string& appName) {
-    auto appConfig = std::find_if(g_appDefaults.begin(), g_appDefaults.end(),
-      [&appName] (const std::pair<const char*, Config>& pair) {
-        std::regex expr(pair.first, std::regex::extended | std::regex::icase);
-        return std::regex_search(appName, expr);
-      });
+    // NV-DXVK start: match app defaults without compiling every regex
+    static const std::vector<AppDefaultsMatcher> s_matchers = createAppDefaultsMatchers();
+
+    const std::string lowerAppName = toLower(appName);
+
+    auto appConfig = g_appDefaults.begin();
+
+    for (const AppDefaultsMatcher& matcher : s_matchers) {
+      const bool match = matcher.regex
+        ? std::regex_search(appName, *matcher.regex)
+        : lowerAppName.size() >= matcher.suffix.size()
+          && lowerAppName.compare(lowerAppName.size() - matcher.suffix.size(), matcher.suffix.size(), matcher.suffix) == 0;
+
+      if (match)
+        break;
+
+      ++appConfig;
+    }
+    // NV-DXVK end
     
     if (appConfig != g_appDefaults.end()) {
       // NV-DXVK change: Update getAppConfig logging
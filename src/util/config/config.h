@@ -22,12 +22,15 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <variant>
 #include <vector>
 
 #include "../util/util_vector.h"
 #include "../util/util_env.h"
 #include "../util/util_keybind.h"
+#include "../thread.h"
 
 namespace dxvk {
 
@@ -286,10 +289,17 @@ namespace dxvk {
      */
     template<typename T>
     T getOption(const char* option, T fallback = T(), const char* envVarName = nullptr) const {
-      const std::string& value = getOptionValue(option);
-
       T result = fallback;
-      parseOptionValue(value, result);
+
+      // NV-DXVK start: cache parsed option values
+      if constexpr (IsParsedType<T, ParsedValue>::value) {
+        getParsedOptionValue(option, result);
+      } else {
+        if (const std::string* value = findOptionValue(option))
+          parseOptionValue(*value, result);
+      }
+      // NV-DXVK end
+
       if (envVarName) {
         const std::string& envVarValue = env::getEnvVar(envVarName);
         if (envVarValue != "")
@@ -361,6 +371,28 @@ namespace dxvk {
       const std::string& value,
       std::vector<std::string>& result);
 
+    // NV-DXVK start: typed list options
+    /**
+     * \brief Parses a list of hexadecimal hashes
+     *
+     * Replaces the contents of \c result. Entries may have
+     * a \c 0x prefix, invalid entries are skipped.
+     */
+    static bool parseOptionValue(
+      const std::string& value,
+      std::vector<uint64_t>& result);
+
+    /**
+     * \brief Parses a list of integers
+     *
+     * Replaces the contents of \c result,
+     * invalid entries are skipped.
+     */
+    static bool parseOptionValue(
+      const std::string& value,
+      std::vector<int32_t>& result);
+    // NV-DXVK end
+
     static bool parseOptionValue(
       const std::string&  value,
             bool&         result);
@@ -412,10 +444,76 @@ namespace dxvk {
 
   private:
 
+    // NV-DXVK start: cache parsed option values
+    /**
+     * \brief Option types whose parsed values are cached
+     *
+     * Large configs are read by many option lookups, and hash
+     * lists can hold thousands of entries, so each value is
+     * only parsed on the first lookup of its key and type.
+     */
+    using ParsedValue = std::variant<
+      bool, int32_t, uint32_t, float, Tristate,
+      Vector2i, Vector2, Vector3, Vector4,
+      std::vector<uint64_t>, std::vector<int32_t>>;
+
+    template<typename T, typename V>
+    struct IsParsedType : std::false_type { };
+
+    template<typename T, typename... Ts>
+    struct IsParsedType<T, std::variant<Ts...>>
+    : std::bool_constant<(std::is_same_v<T, Ts> || ...)> { };
+
+    /**
+     * \brief Cache of parsed option values
+     *
+     * Copies start out empty, the values are
+     * parsed again from the copied options.
+     */
+    struct ParsedValueCache {
+      ParsedValueCache() { }
+      ParsedValueCache(const ParsedValueCache&) { }
+
+      ParsedValueCache& operator = (const ParsedValueCache&) {
+        std::lock_guard<dxvk::mutex> lock(mutex);
+        values.clear();
+        return *this;
+      }
+
+      dxvk::mutex                                  mutex;
+      std::unordered_map<std::string, ParsedValue> values;
+    };
+
+    template<typename T>
+    void getParsedOptionValue(const char* option, T& result) const {
+      std::lock_guard<dxvk::mutex> lock(m_parsedValues.mutex);
+
+      auto entry = m_parsedValues.values.find(option);
+
+      if (entry != m_parsedValues.values.end() && std::holds_alternative<T>(entry->second)) {
+        result = std::get<T>(entry->second);
+        return;
+      }
+
+      // Only successful parses are cached, since a failed
+      // one leaves the fallback of the caller in place
+      const std::string* value = findOptionValue(option);
+
+      if (value && parseOptionValue(*value, result))
+        m_parsedValues.values.insert_or_assign(option, result);
+    }
+
+    void invalidateParsedValue(const std::string& key);
+    // NV-DXVK end
+
     OptionMap m_options;
 
-    std::string getOptionValue(
+    // NV-DXVK start: cache parsed option values
+    mutable ParsedValueCache m_parsedValues;
+
+    const std::string* findOptionValue(
       const char*         option) const;
+    // NV-DXVK end
       
     // NV-DXVK start: Generic config parsing, reduce duped code
     static const inline std::array<Desc,Type_kSize> m_descs {
@@ -25,9 +25,15 @@
 #include "util_math.h"
 #include "util_fastops.h"
 #include <algorithm>
+#include <cfloat>
 #include <ppl.h>
+#include <vector>
 #include "util_fastops.h"
 
+// Inlined so that the XXH3 accumulator internals are visible to parallel_XXH3_64bits
+#define XXH_INLINE_ALL
+#include "xxHash/xxhash.h"
+
 #define SSE_ENABLE ((fast::g_simdSupportLevel != fast::SIMD::None) && 1)
 
 namespace fast {
@@ -931,6 +937,374 @@ namespace fast {
   template void copySubtract<uint16_t>(uint16_t* dstData, const uint16_t* srcData, const uint32_t count, const uint16_t value, const bool ignoreSentinel, const uint16_t sentinelValue);
   template void copySubtract<uint32_t>(uint32_t* dstData, const uint32_t* srcData, const uint32_t count, const uint32_t value, const bool ignoreSentinel, const uint32_t sentinelValue);
 
+  __forceinline bool anyDistanceExceeds_slow(const float* a, const float* b, const size_t count, const uint32_t numComponents, const float threshold) {
+    if (numComponents == 1) {
+      for (size_t i = 0; i < count; i++) {
+        if (std::abs(a[i] - b[i]) > threshold) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    const float thresholdSq = threshold * threshold;
+    for (size_t i = 0; i < count; i++) {
+      const float* elemA = a + i * numComponents;
+      const float* elemB = b + i * numComponents;
+      float d = elemA[0] - elemB[0];
+      float lengthSq = d * d;
+      for (uint32_t c = 1; c < numComponents; c++) {
+        d = elemA[c] - elemB[c];
+        lengthSq += d * d;
+      }
+      if (lengthSq > thresholdSq) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Each iteration loads 4 elements and transposes their differences into one register per component,
+  // so that the squared lengths are summed in the same order as the scalar path.
+  __forceinline bool anyDistanceExceeds_SSE(const float* a, const float* b, const size_t count, const uint32_t numComponents, const float threshold) {
+    const size_t numLanes = 4;
+    const size_t alignedCount = count & ~(numLanes - 1);
+
+    const __m128 thresholdSq = _mm_set1_ps(threshold * threshold);
+
+    for (size_t i = 0; i < alignedCount; i += numLanes) {
+      const float* srcA = a + i * numComponents;
+      const float* srcB = b + i * numComponents;
+
+      __m128 lengthSq;
+      switch (numComponents) {
+      case 1: {
+        const __m128 signMask = _mm_set1_ps(-0.f);
+        const __m128 d = _mm_andnot_ps(signMask, _mm_sub_ps(_mm_loadu_ps(srcA), _mm_loadu_ps(srcB)));
+        if (_mm_movemask_ps(_mm_cmpgt_ps(d, _mm_set1_ps(threshold))) != 0) {
+          return true;
+        }
+        continue;
+      }
+      case 2: {
+        // (x0 y0 x1 y1) (x2 y2 x3 y3)
+        const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(srcA + 0), _mm_loadu_ps(srcB + 0));
+        const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(srcA + 4), _mm_loadu_ps(srcB + 4));
+        const __m128 x = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 y = _mm_shuffle_ps(d0, d1, _MM_SHUFFLE(3, 1, 3, 1));
+        lengthSq = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+        break;
+      }
+      case 3: {
+        // (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3)
+        const __m128 d0 = _mm_sub_ps(_mm_loadu_ps(srcA + 0), _mm_loadu_ps(srcB + 0));
+        const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(srcA + 4), _mm_loadu_ps(srcB + 4));
+        const __m128 d2 = _mm_sub_ps(_mm_loadu_ps(srcA + 8), _mm_loadu_ps(srcB + 8));
+        const __m128 x = _mm_shuffle_ps(_mm_shuffle_ps(d0, d0, _MM_SHUFFLE(3, 0, 3, 0)),
+                                        _mm_shuffle_ps(d1, d2, _MM_SHUFFLE(1, 1, 2, 2)), _MM_SHUFFLE(2, 0, 1, 0));
+        const __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(d0, d1, _MM_SHUFFLE(0, 0, 1, 1)),
+                                        _mm_shuffle_ps(d1, d2, _MM_SHUFFLE(2, 2, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0));
+        const __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(d0, d1, _MM_SHUFFLE(1, 1, 2, 2)),
+                                        _mm_shuffle_ps(d2, d2, _MM_SHUFFLE(3, 3, 0, 0)), _MM_SHUFFLE(2, 0, 2, 0));
+        lengthSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+        break;
+      }
+      default: {
+        __m128 x = _mm_sub_ps(_mm_loadu_ps(srcA + 0), _mm_loadu_ps(srcB + 0));
+        __m128 y = _mm_sub_ps(_mm_loadu_ps(srcA + 4), _mm_loadu_ps(srcB + 4));
+        __m128 z = _mm_sub_ps(_mm_loadu_ps(srcA + 8), _mm_loadu_ps(srcB + 8));
+        __m128 w = _mm_sub_ps(_mm_loadu_ps(srcA + 12), _mm_loadu_ps(srcB + 12));
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        lengthSq = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)), _mm_mul_ps(w, w));
+        break;
+      }
+      }
+
+      if (_mm_movemask_ps(_mm_cmpgt_ps(lengthSq, thresholdSq)) != 0) {
+        return true;
+      }
+    }
+
+    // Process remaining elements
+    return anyDistanceExceeds_slow(a + alignedCount * numComponents, b + alignedCount * numComponents,
+                                   count - alignedCount, numComponents, threshold);
+  }
+
+  bool anyDistanceExceeds(const float* a, const float* b, const size_t count, const uint32_t numComponents, const float threshold) {
+    const bool useSSE = SSE_ENABLE && count >= 16 && numComponents <= 4;
+
+    if (useSSE) {
+      return anyDistanceExceeds_SSE(a, b, count, numComponents, threshold);
+    }
+    return anyDistanceExceeds_slow(a, b, count, numComponents, threshold);
+  }
+
+  // Kernel template arguments for strides that are only known at runtime, and for streams without colors
+  static constexpr uint32_t kRuntimeStride = 0;
+  static constexpr uint32_t kNoColors = ~0u;
+
+  __forceinline void initVertexBounds(VertexBounds& bounds) {
+    for (uint32_t c = 0; c < 3; c++) {
+      bounds.minPos[c] = FLT_MAX;
+      bounds.maxPos[c] = -FLT_MAX;
+    }
+    for (uint32_t c = 0; c < 4; c++) {
+      bounds.minColor[c] = 0xFF;
+      bounds.maxColor[c] = 0;
+    }
+  }
+
+  __forceinline void computeVertexBounds_slow(const uint8_t* positions, const size_t positionStride, const uint8_t* colors, const size_t colorStride, const uint32_t count, VertexBounds& bounds) {
+    for (uint32_t i = 0; i < count; i++) {
+      const float* position = reinterpret_cast<const float*>(positions + i * positionStride);
+      for (uint32_t c = 0; c < 3; c++) {
+        bounds.minPos[c] = std::min(bounds.minPos[c], position[c]);
+        bounds.maxPos[c] = std::max(bounds.maxPos[c], position[c]);
+      }
+
+      if (colors != nullptr) {
+        const uint8_t* color = colors + i * colorStride;
+        for (uint32_t c = 0; c < 4; c++) {
+          bounds.minColor[c] = std::min(bounds.minColor[c], color[c]);
+          bounds.maxColor[c] = std::max(bounds.maxColor[c], color[c]);
+        }
+      }
+    }
+  }
+
+  // Folds accumulator lanes into the bounds. Lane i of the flattened accumulators holds component i % period,
+  // components past the last one (the w lane of per vertex position loads) are ignored.
+  template<uint32_t Period, uint32_t NumFloats>
+  __forceinline void reducePositions(const float (&minLanes)[NumFloats], const float (&maxLanes)[NumFloats], VertexBounds& bounds) {
+    for (uint32_t i = 0; i < NumFloats; i++) {
+      const uint32_t c = i % Period;
+      if (c < 3) {
+        bounds.minPos[c] = std::min(bounds.minPos[c], minLanes[i]);
+        bounds.maxPos[c] = std::max(bounds.maxPos[c], maxLanes[i]);
+      }
+    }
+  }
+
+  template<uint32_t NumBytes>
+  __forceinline void reduceColors(const uint8_t (&minLanes)[NumBytes], const uint8_t (&maxLanes)[NumBytes], VertexBounds& bounds) {
+    for (uint32_t i = 0; i < NumBytes; i++) {
+      bounds.minColor[i % 4] = std::min(bounds.minColor[i % 4], minLanes[i]);
+      bounds.maxColor[i % 4] = std::max(bounds.maxColor[i % 4], maxLanes[i]);
+    }
+  }
+
+  __forceinline uint32_t loadColor(const uint8_t* color) {
+    return *reinterpret_cast<const uint32_t*>(color);
+  }
+
+  // Processes 4 vertices per iteration. Packed positions (stride 12) are loaded as 3 registers whose lanes repeat
+  // the same xyz pattern every iteration, so they need no shuffling, other strides load one position per register.
+  template<uint32_t PositionStride, uint32_t ColorStride>
+  void computeVertexBounds_SSE(const uint8_t* positions, const size_t positionStride, const uint8_t* colors, const size_t colorStride, const uint32_t count, VertexBounds& bounds) {
+    constexpr uint32_t numLanes = 4;
+    constexpr bool packedPositions = PositionStride == 3 * sizeof(float);
+    constexpr bool hasColors = ColorStride != kNoColors;
+
+    const size_t posStride = PositionStride != kRuntimeStride ? PositionStride : positionStride;
+    const size_t colStride = ColorStride != kRuntimeStride ? ColorStride : colorStride;
+
+    // The last vertex is left to the scalar path, a 16 byte load of its position can read past the buffer
+    const uint32_t alignedCount = (count - 1) & ~(numLanes - 1);
+
+    __m128 minPos[3] = { _mm_set1_ps(FLT_MAX), _mm_set1_ps(FLT_MAX), _mm_set1_ps(FLT_MAX) };
+    __m128 maxPos[3] = { _mm_set1_ps(-FLT_MAX), _mm_set1_ps(-FLT_MAX), _mm_set1_ps(-FLT_MAX) };
+    __m128i minColor = _mm_set1_epi8(-1);
+    __m128i maxColor = _mm_setzero_si128();
+
+    for (uint32_t i = 0; i < alignedCount; i += numLanes) {
+      const uint8_t* pos = positions + i * posStride;
+
+      if constexpr (packedPositions) {
+        for (uint32_t r = 0; r < 3; r++) {
+          const __m128 values = _mm_loadu_ps(reinterpret_cast<const float*>(pos) + r * 4);
+          minPos[r] = _mm_min_ps(minPos[r], values);
+          maxPos[r] = _mm_max_ps(maxPos[r], values);
+        }
+      } else {
+        // Alternate between two accumulators to shorten the dependency chains
+        for (uint32_t v = 0; v < numLanes; v++) {
+          const __m128 values = _mm_loadu_ps(reinterpret_cast<const float*>(pos + v * posStride));
+          minPos[v & 1] = _mm_min_ps(minPos[v & 1], values);
+          maxPos[v & 1] = _mm_max_ps(maxPos[v & 1], values);
+        }
+      }
+
+      if constexpr (hasColors) {
+        const uint8_t* col = colors + i * colStride;
+        __m128i values;
+        if constexpr (ColorStride == 4) {
+          values = _mm_loadu_si128((const __m128i*) col);
+        } else {
+          values = _mm_set_epi32(loadColor(col + 3 * colStride), loadColor(col + 2 * colStride), loadColor(col + colStride), loadColor(col));
+        }
+        minColor = _mm_min_epu8(minColor, values);
+        maxColor = _mm_max_epu8(maxColor, values);
+      }
+    }
+
+    float minLanes[12];
+    float maxLanes[12];
+    for (uint32_t r = 0; r < 3; r++) {
+      _mm_storeu_ps(&minLanes[r * 4], minPos[r]);
+      _mm_storeu_ps(&maxLanes[r * 4], maxPos[r]);
+    }
+    reducePositions<packedPositions ? 3 : 4>(minLanes, maxLanes, bounds);
+
+    if constexpr (hasColors) {
+      uint8_t minBytes[16];
+      uint8_t maxBytes[16];
+      _mm_storeu_si128((__m128i*) minBytes, minColor);
+      _mm_storeu_si128((__m128i*) maxBytes, maxColor);
+      reduceColors(minBytes, maxBytes, bounds);
+    }
+
+    computeVertexBounds_slow(positions + alignedCount * posStride, posStride,
+                             hasColors ? colors + alignedCount * colStride : nullptr, colStride,
+                             count - alignedCount, bounds);
+  }
+
+  // Same as computeVertexBounds_SSE with 8 vertices per iteration, positions at other strides are loaded two per register
+  template<uint32_t PositionStride, uint32_t ColorStride>
+  void computeVertexBounds_AVX2(const uint8_t* positions, const size_t positionStride, const uint8_t* colors, const size_t colorStride, const uint32_t count, VertexBounds& bounds) {
+    constexpr uint32_t numLanes = 8;
+    constexpr bool packedPositions = PositionStride == 3 * sizeof(float);
+    constexpr bool hasColors = ColorStride != kNoColors;
+
+    const size_t posStride = PositionStride != kRuntimeStride ? PositionStride : positionStride;
+    const size_t colStride = ColorStride != kRuntimeStride ? ColorStride : colorStride;
+
+    // The last vertex is left to the scalar path, a 16 byte load of its position can read past the buffer
+    const uint32_t alignedCount = (count - 1) & ~(numLanes - 1);
+
+    __m256 minPos[3] = { _mm256_set1_ps(FLT_MAX), _mm256_set1_ps(FLT_MAX), _mm256_set1_ps(FLT_MAX) };
+    __m256 maxPos[3] = { _mm256_set1_ps(-FLT_MAX), _mm256_set1_ps(-FLT_MAX), _mm256_set1_ps(-FLT_MAX) };
+    __m256i minColor = _mm256_set1_epi8(-1);
+    __m256i maxColor = _mm256_setzero_si256();
+
+    for (uint32_t i = 0; i < alignedCount; i += numLanes) {
+      const uint8_t* pos = positions + i * posStride;
+
+      if constexpr (packedPositions) {
+        for (uint32_t r = 0; r < 3; r++) {
+          const __m256 values = _mm256_loadu_ps(reinterpret_cast<const float*>(pos) + r * 8);
+          minPos[r] = _mm256_min_ps(minPos[r], values);
+          maxPos[r] = _mm256_max_ps(maxPos[r], values);
+        }
+      } else {
+        for (uint32_t v = 0; v < numLanes; v += 2) {
+          const __m128 lo = _mm_loadu_ps(reinterpret_cast<const float*>(pos + v * posStride));
+          const __m128 hi = _mm_loadu_ps(reinterpret_cast<const float*>(pos + (v + 1) * posStride));
+          const __m256 values = _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+          minPos[(v >> 1) & 1] = _mm256_min_ps(minPos[(v >> 1) & 1], values);
+          maxPos[(v >> 1) & 1] = _mm256_max_ps(maxPos[(v >> 1) & 1], values);
+        }
+      }
+
+      if constexpr (hasColors) {
+        const uint8_t* col = colors + i * colStride;
+        __m256i values;
+        if constexpr (ColorStride == 4) {
+          values = _mm256_loadu_si256((const __m256i*) col);
+        } else {
+          values = _mm256_set_epi32(loadColor(col + 7 * colStride), loadColor(col + 6 * colStride),
+                                    loadColor(col + 5 * colStride), loadColor(col + 4 * colStride),
+                                    loadColor(col + 3 * colStride), loadColor(col + 2 * colStride),
+                                    loadColor(col + colStride), loadColor(col));
+        }
+        minColor = _mm256_min_epu8(minColor, values);
+        maxColor = _mm256_max_epu8(maxColor, values);
+      }
+    }
+
+    float minLanes[24];
+    float maxLanes[24];
+    for (uint32_t r = 0; r < 3; r++) {
+      _mm256_storeu_ps(&minLanes[r * 8], minPos[r]);
+      _mm256_storeu_ps(&maxLanes[r * 8], maxPos[r]);
+    }
+    reducePositions<packedPositions ? 3 : 4>(minLanes, maxLanes, bounds);
+
+    if constexpr (hasColors) {
+      uint8_t minBytes[32];
+      uint8_t maxBytes[32];
+      _mm256_storeu_si256((__m256i*) minBytes, minColor);
+      _mm256_storeu_si256((__m256i*) maxBytes, maxColor);
+      reduceColors(minBytes, maxBytes, bounds);
+    }
+
+    computeVertexBounds_slow(positions + alignedCount * posStride, posStride,
+                             hasColors ? colors + alignedCount * colStride : nullptr, colStride,
+                             count - alignedCount, bounds);
+  }
+
+  template<SIMD V, uint32_t PositionStride, uint32_t ColorStride>
+  __forceinline void computeVertexBounds_kernel(const uint8_t* positions, const size_t positionStride, const uint8_t* colors, const size_t colorStride, const uint32_t count, VertexBounds& bounds) {
+    if constexpr (V == SIMD::AVX2) {
+      computeVertexBounds_AVX2<PositionStride, ColorStride>(positions, positionStride, colors, colorStride, count, bounds);
+    } else {
+      computeVertexBounds_SSE<PositionStride, ColorStride>(positions, positionStride, colors, colorStride, count, bounds);
+    }
+  }
+
+  template<SIMD V, uint32_t PositionStride>
+  __forceinline void computeVertexBounds_stride(const uint8_t* positions, const size_t positionStride, const uint8_t* colors, const size_t colorStride, const uint32_t count, VertexBounds& bounds) {
+    // Colors are either a packed stream of their own or interleaved with the positions
+    if (colors == nullptr) {
+      computeVertexBounds_kernel<V, PositionStride, kNoColors>(positions, positionStride, colors, colorStride, count, bounds);
+    } else if (colorStride == 4) {
+      computeVertexBounds_kernel<V, PositionStride, 4>(positions, positionStride, colors, colorStride, count, bounds);
+    } else if (PositionStride != kRuntimeStride && colorStride == PositionStride) {
+      computeVertexBounds_kernel<V, PositionStride, PositionStride>(positions, positionStride, colors, colorStride, count, bounds);
+    } else {
+      computeVertexBounds_kernel<V, PositionStride, kRuntimeStride>(positions, positionStride, colors, colorStride, count, bounds);
+    }
+  }
+
+  template<SIMD V>
+  __forceinline void computeVertexBounds_SIMD(const uint8_t* positions, const size_t positionStride, const uint8_t* colors, const size_t colorStride, const uint32_t count, VertexBounds& bounds) {
+    // Packed positions, and the vertex sizes of the common position, normal, color and texcoord layouts
+    switch (positionStride) {
+    case 12: computeVertexBounds_stride<V, 12>(positions, positionStride, colors, colorStride, count, bounds); break;
+    case 24: computeVertexBounds_stride<V, 24>(positions, positionStride, colors, colorStride, count, bounds); break;
+    case 32: computeVertexBounds_stride<V, 32>(positions, positionStride, colors, colorStride, count, bounds); break;
+    case 36: computeVertexBounds_stride<V, 36>(positions, positionStride, colors, colorStride, count, bounds); break;
+    default: computeVertexBounds_stride<V, kRuntimeStride>(positions, positionStride, colors, colorStride, count, bounds); break;
+    }
+  }
+
+  void computeVertexBounds(const void* positions, const size_t positionStride, const void* colors, const size_t colorStride, const uint32_t count, VertexBounds& boundsOut) {
+    const uint8_t* positionBytes = static_cast<const uint8_t*>(positions);
+    const uint8_t* colorBytes = static_cast<const uint8_t*>(colors);
+
+    initVertexBounds(boundsOut);
+
+    // Positions overlapping each other can't use the packed kernel, and short streams aren't worth the setup
+    if (count < 32 || positionStride < 3 * sizeof(float)) {
+      computeVertexBounds_slow(positionBytes, positionStride, colorBytes, colorStride, count, boundsOut);
+      return;
+    }
+
+    switch (g_simdSupportLevel) {
+    case SIMD::AVX512:
+    case SIMD::AVX2:
+      computeVertexBounds_SIMD<SIMD::AVX2>(positionBytes, positionStride, colorBytes, colorStride, count, boundsOut);
+      break;
+    case SIMD::SSE4_1:
+    case SIMD::SSE3:
+    case SIMD::SSE2:
+      computeVertexBounds_SIMD<SIMD::SSE2>(positionBytes, positionStride, colorBytes, colorStride, count, boundsOut);
+      break;
+    default:
+      computeVertexBounds_slow(positionBytes, positionStride, colorBytes, colorStride, count, boundsOut);
+      break;
+    }
+  }
+
   void parallel_memcpy(void* dst, const void* src, const size_t count, const size_t chunkSize) {
     const uint8_t* srcBytes = static_cast<const uint8_t*>(src);
     uint8_t* dstBytes = static_cast<uint8_t*>(dst);
@@ -952,6 +1326,50 @@ namespace fast {
   }
 
 
+  uint64_t parallel_XXH3_64bits(const void* data, const size_t count, const size_t chunkSize) {
+    // Mirrors XXH3_hashLong_64b_internal with the default secret
+    constexpr size_t secretSize = sizeof(XXH3_kSecret);
+    constexpr size_t stripesPerBlock = (secretSize - XXH_STRIPE_LEN) / XXH_SECRET_CONSUME_RATE;
+    constexpr size_t blockSize = XXH_STRIPE_LEN * stripesPerBlock;
+
+    const size_t blocksPerChunk = std::max<size_t>(chunkSize / blockSize, 1);
+    const size_t numBlocks = count > XXH3_MIDSIZE_MAX ? (count - 1) / blockSize : 0;
+    const size_t numChunks = (numBlocks + blocksPerChunk - 1) / blocksPerChunk;
+
+    // It's only worth the effort if theres at least 3 threads saturated
+    if (numChunks <= 3) {
+      return XXH3_64bits(data, count);
+    }
+
+    const xxh_u8* const input = static_cast<const xxh_u8*>(data);
+
+    // Sum of each block's stripe accumulations, these don't depend on the accumulator state
+    std::vector<xxh_u64> blockSums(numBlocks * XXH_ACC_NB);
+    concurrency::parallel_for<size_t>(0, numChunks, [&](size_t chunk) {
+      const size_t endBlock = std::min(numBlocks, (chunk + 1) * blocksPerChunk);
+      for (size_t block = chunk * blocksPerChunk; block < endBlock; block++) {
+        XXH_ALIGN(XXH_ACC_ALIGN) xxh_u64 sum[XXH_ACC_NB] = { };
+        XXH3_accumulate(sum, input + block * blockSize, XXH3_kSecret, stripesPerBlock, XXH3_accumulate_512);
+        std::memcpy(&blockSums[block * XXH_ACC_NB], sum, sizeof(sum));
+      }
+    });
+
+    XXH_ALIGN(XXH_ACC_ALIGN) xxh_u64 acc[XXH_ACC_NB] = XXH3_INIT_ACC;
+    for (size_t block = 0; block < numBlocks; block++) {
+      for (size_t i = 0; i < XXH_ACC_NB; i++) {
+        acc[i] += blockSums[block * XXH_ACC_NB + i];
+      }
+      XXH3_scrambleAcc(acc, XXH3_kSecret + secretSize - XXH_STRIPE_LEN);
+    }
+
+    // Last partial block and last stripe
+    const size_t numStripes = ((count - 1) - blockSize * numBlocks) / XXH_STRIPE_LEN;
+    XXH3_accumulate(acc, input + numBlocks * blockSize, XXH3_kSecret, numStripes, XXH3_accumulate_512);
+    XXH3_accumulate_512(acc, input + count - XXH_STRIPE_LEN, XXH3_kSecret + secretSize - XXH_STRIPE_LEN - XXH_SECRET_LASTACC_START);
+
+    return XXH3_mergeAccs(acc, XXH3_kSecret + XXH_SECRET_MERGEACCS_START, (xxh_u64) count * XXH_PRIME64_1);
+  }
+
   template<typename T>
   __forceinline T findNthBit_BMI2(const T num, const T n) {
     return _tzcnt_u32(_pdep_u32(1 << n, num));
@@ -70,6 +70,46 @@ namespace fast {
   template<typename T>
   void copySubtract(T* dstData, const T* srcData, const uint32_t count, const T value, const bool ignoreSentinel = false, const T sentinelValue = 0);
 
+  /**
+    * \brief Determines whether any element of two packed float vector arrays differs by more than a threshold
+    *
+    * a, b: arrays of count elements, each made of numComponents tightly packed floats
+    * count: number of elements
+    * numComponents: floats per element, 1 to 4
+    * threshold: elements differ when their euclidean distance is greater than this value
+    *
+    * Single component elements compare |a - b| > threshold, vectors compare the squared length of (a - b)
+    * against threshold * threshold, summed in component order.  Results are identical to the scalar path.
+    */
+  bool anyDistanceExceeds(const float* a, const float* b, const size_t count, const uint32_t numComponents, const float threshold);
+
+  /**
+    * \brief Bounds of a vertex stream, see computeVertexBounds
+    */
+  struct VertexBounds {
+    float minPos[3];
+    float maxPos[3];
+    // Per byte minimum and maximum of the colors, i.e. B, G, R, A for D3DCOLOR
+    uint8_t minColor[4];
+    uint8_t maxColor[4];
+  };
+
+  /**
+    * \brief Computes the bounding box of vertex positions and the range of their colors in a single pass
+    *
+    * positions: first vertex position, 3 floats
+    * positionStride: bytes from one position to the next
+    * colors: first vertex color, 4 bytes, or nullptr for vertices without colors
+    * colorStride: bytes from one color to the next
+    * count: number of vertices
+    * boundsOut: minPos and maxPos are FLT_MAX and -FLT_MAX without vertices, minColor and maxColor
+    *   are 255 and 0 without vertices or colors
+    *
+    * Packed streams and common strides have specialized kernels. Reads no memory past the last vertex
+    * position or color.  Bounds of positions that contain NaNs are undefined.
+    */
+  void computeVertexBounds(const void* positions, const size_t positionStride, const void* colors, const size_t colorStride, const uint32_t count, VertexBounds& boundsOut);
+
   /**
     * \brief Memory copy function that uses threads internally, can be useful for very large memcpy's
     *
@@ -80,6 +120,18 @@ namespace fast {
     */
   void parallel_memcpy(void* dest, const void* src, const size_t count, const size_t chunkSize = 4096);
 
+  /**
+    * \brief XXH3_64bits that hashes large inputs on multiple threads, the result is identical to XXH3_64bits
+    *
+    * data: memory to hash
+    * count: number of bytes to hash
+    * chunkSize: how many bytes to process per thread
+    *
+    * XXH3 folds each 1 KB block into its accumulators with additions only, so the per block sums are
+    * computed in parallel and then scrambled into the accumulators in order on the calling thread.
+    */
+  uint64_t parallel_XXH3_64bits(const void* data, const size_t count, const size_t chunkSize = 256 * 1024);
+
   /**
     * \brief Returns the index of the nth set bit
     *
@@ -91,6 +91,7 @@ void RtxFileSys::print() {
   Logger::debug(format("[RtxFileSys] Mods dir:    ", s_paths[Mods]));
   Logger::debug(format("[RtxFileSys] Capture dir: ", s_paths[Captures]));
   Logger::debug(format("[RtxFileSys] Logs dir:    ", s_paths[Logs]));
+  Logger::debug(format("[RtxFileSys] Caches dir:  ", s_paths[Caches]));
 }
 
 void RtxFileSys::mkDirs(const fspath& path) {
@@ -40,6 +40,7 @@ public:
     Mods,
     Captures,
     Logs,
+    Caches,
     kNumIds
   };
 private:
@@ -57,7 +58,8 @@ private:
   static inline const std::array<PathSpec,kNumIds> s_pathSpecs = {
     PathSpec{ Mods,     join(".", "rtx-remix", "mods"),     ""                  },
     PathSpec{ Captures, join(".", "rtx-remix", "captures"), "DXVK_CAPTURE_PATH" },
-    PathSpec{ Logs,     join(".", "rtx-remix", "logs"),     "DXVK_LOG_PATH"     }
+    PathSpec{ Logs,     join(".", "rtx-remix", "logs"),     "DXVK_LOG_PATH"     },
+    PathSpec{ Caches,   join(".", "rtx-remix", "cache"),    "DXVK_RTX_CACHE_PATH" }
   };
 
   static bool s_bInit;
@@ -0,0 +1,311 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "thread.h"
+#include "util_singleton.h"
+
+namespace dxvk {
+
+  // Linear allocator for short lived data, e.g. the per-draw and per-instance temporaries of a frame.
+  //
+  // Each thread bumps through its own blocks, so allocating takes no lock. Freeing is a no-op, except that a
+  // thread freeing its last allocation gets the memory back, so temporaries freed in reverse order (e.g. in a
+  // task that runs many times per frame) keep reusing the same memory. A thread's
+  // blocks are reused once the frame they were allocated in is kFrameCount frames old, at the thread's first
+  // allocation in that later frame, so memory allocated in a frame must not be used after kFrameCount - 1
+  // more frames passed, or by the allocating thread once it allocates again that much later. Data that can
+  // live longer (e.g. data stored in a cache) has to use the heap, see FrameAllocator.
+  //
+  // Allocations larger than a quarter block or aligned to more than kBlockAlignment fall back to the heap and
+  // are freed on deallocate(), which is why deallocate() needs the size and alignment of the allocation.
+  //
+  // Blocks of threads that exited are kept, and reused by a thread that gets the same id, until the arena is
+  // destroyed. FrameArena::get() is the arena of the renderer, nextFrame() is called on it at the end of a frame.
+  class FrameArena : public Singleton<FrameArena> {
+  public:
+    static constexpr uint32_t kFrameCount = 4;
+    static constexpr size_t kDefaultBlockSize = 1024 * 1024;
+    static constexpr size_t kBlockAlignment = 64;
+
+    struct Stats {
+      // Allocations and bytes served from the blocks
+      uint64_t allocations = 0;
+      uint64_t bytes = 0;
+      // Allocations that went to the heap
+      uint64_t heapFallbacks = 0;
+      // Blocks allocated from the heap
+      uint64_t blocks = 0;
+    };
+
+    explicit FrameArena(size_t blockSize = kDefaultBlockSize)
+      : m_blockSize(std::max(blockSize, kBlockAlignment))
+      , m_id(s_nextId.fetch_add(1, std::memory_order_relaxed)) { }
+
+    ~FrameArena() {
+      for (auto& [id, thread] : m_threads) {
+        for (Frame& frame : thread->frames) {
+          for (uint8_t* block : frame.blocks) {
+            ::operator delete(block, std::align_val_t(kBlockAlignment));
+          }
+        }
+      }
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment) {
+      ThreadArena& thread = getThreadArena();
+
+      if (isHeapAllocation(size, alignment)) {
+        increment(thread.stats.heapFallbacks, 1);
+        return ::operator new(size, std::align_val_t(alignment));
+      }
+
+      const uint64_t frameId = m_frame.load(std::memory_order_acquire);
+      Frame& frame = thread.frames[frameId % kFrameCount];
+
+      if (frame.id != frameId) {
+        frame.id = frameId;
+        frame.block = 0;
+        frame.offset = 0;
+      }
+
+      thread.current = &frame;
+
+      increment(thread.stats.allocations, 1);
+      increment(thread.stats.bytes, size);
+
+      while (true) {
+        if (frame.block == frame.blocks.size()) {
+          frame.blocks.push_back(static_cast<uint8_t*>(::operator new(m_blockSize, std::align_val_t(kBlockAlignment))));
+          increment(thread.stats.blocks, 1);
+        }
+
+        const size_t offset = (frame.offset + alignment - 1) & ~(alignment - 1);
+
+        if (offset + size <= m_blockSize) {
+          frame.offset = offset + size;
+          return frame.blocks[frame.block] + offset;
+        }
+
+        frame.block++;
+        frame.offset = 0;
+      }
+    }
+
+    void deallocate(void* p, size_t size, size_t alignment) {
+      if (isHeapAllocation(size, alignment)) {
+        ::operator delete(p, std::align_val_t(alignment));
+        return;
+      }
+
+      // Only the owning thread can rewind its blocks, other threads leave the memory to the frame reset
+      Frame* frame = t_cache.arenaId == m_id ? t_cache.arena->current : nullptr;
+
+      if (frame != nullptr && frame->block < frame->blocks.size() &&
+          frame->blocks[frame->block] + frame->offset == static_cast<uint8_t*>(p) + size) {
+        frame->offset -= size;
+      }
+    }
+
+    // Starts the next frame and returns the statistics of the frame that ended
+    Stats nextFrame() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      m_frame.fetch_add(1, std::memory_order_release);
+
+      const Stats total = getTotalStats();
+      Stats frame;
+      frame.allocations = total.allocations - m_lastTotal.allocations;
+      frame.bytes = total.bytes - m_lastTotal.bytes;
+      frame.heapFallbacks = total.heapFallbacks - m_lastTotal.heapFallbacks;
+      frame.blocks = total.blocks - m_lastTotal.blocks;
+      m_lastTotal = total;
+      return frame;
+    }
+
+    uint64_t getFrameId() const {
+      return m_frame.load(std::memory_order_acquire);
+    }
+
+    // Statistics since the arena was created
+    Stats getStats() {
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      return getTotalStats();
+    }
+
+  private:
+    struct AtomicStats {
+      std::atomic<uint64_t> allocations = { 0 };
+      std::atomic<uint64_t> bytes = { 0 };
+      std::atomic<uint64_t> heapFallbacks = { 0 };
+      std::atomic<uint64_t> blocks = { 0 };
+    };
+
+    struct Frame {
+      // Stale until the first allocation, which resets the frame
+      uint64_t id = ~0ull;
+      std::vector<uint8_t*> blocks;
+      size_t block = 0;
+      size_t offset = 0;
+    };
+
+    struct ThreadArena {
+      Frame frames[kFrameCount];
+      // Frame of the last allocation
+      Frame* current = nullptr;
+      // Only written by the owning thread, atomic so that getStats() can read them
+      AtomicStats stats;
+    };
+
+    // Zero initialized as a thread_local, arena ids start at 1
+    struct ThreadCache {
+      uint64_t arenaId;
+      ThreadArena* arena;
+    };
+
+    static inline std::atomic<uint64_t> s_nextId = { 1 };
+    // Threads mostly use a single arena, only switching arenas takes the lock
+    static inline thread_local ThreadCache t_cache;
+
+    const size_t m_blockSize;
+    const uint64_t m_id;
+    std::atomic<uint64_t> m_frame = { 0 };
+
+    dxvk::mutex m_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadArena>> m_threads;
+    Stats m_lastTotal;
+
+    bool isHeapAllocation(size_t size, size_t alignment) const {
+      return size > m_blockSize / 4 || alignment > kBlockAlignment;
+    }
+
+    static void increment(std::atomic<uint64_t>& counter, uint64_t value) {
+      // Single writer, so a plain load and store is enough
+      counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    ThreadArena& getThreadArena() {
+      if (t_cache.arenaId == m_id) {
+        return *t_cache.arena;
+      }
+
+      std::lock_guard<dxvk::mutex> lock(m_mutex);
+      std::unique_ptr<ThreadArena>& thread = m_threads[std::this_thread::get_id()];
+
+      if (thread == nullptr) {
+        thread = std::make_unique<ThreadArena>();
+      }
+
+      t_cache.arenaId = m_id;
+      t_cache.arena = thread.get();
+      return *thread;
+    }
+
+    Stats getTotalStats() const {
+      Stats total;
+
+      for (const auto& [id, thread] : m_threads) {
+        total.allocations += thread->stats.allocations.load(std::memory_order_relaxed);
+        total.bytes += thread->stats.bytes.load(std::memory_order_relaxed);
+        total.heapFallbacks += thread->stats.heapFallbacks.load(std::memory_order_relaxed);
+        total.blocks += thread->stats.blocks.load(std::memory_order_relaxed);
+      }
+
+      return total;
+    }
+  };
+
+  // STL allocator on a FrameArena, the frame arena of the renderer by default. An allocator without
+  // an arena uses the heap, for containers of the same type that have to outlive the frame.
+  template<typename T>
+  class FrameAllocator {
+  public:
+    using value_type = T;
+
+    FrameAllocator() noexcept
+      : m_arena(&FrameArena::get()) { }
+
+    explicit FrameAllocator(FrameArena* arena) noexcept
+      : m_arena(arena) { }
+
+    template<typename U>
+    FrameAllocator(const FrameAllocator<U>& other) noexcept
+      : m_arena(other.getArena()) { }
+
+    // Allocator of containers that outlive the frame
+    static FrameAllocator heap() noexcept {
+      return FrameAllocator(nullptr);
+    }
+
+    T* allocate(size_t count) {
+      if (m_arena == nullptr) {
+        return std::allocator<T>().allocate(count);
+      }
+
+      return static_cast<T*>(m_arena->allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T* p, size_t count) noexcept {
+      if (m_arena == nullptr) {
+        std::allocator<T>().deallocate(p, count);
+      } else {
+        m_arena->deallocate(p, count * sizeof(T), alignof(T));
+      }
+    }
+
+    FrameArena* getArena() const noexcept {
+      return m_arena;
+    }
+
+    template<typename U>
+    bool operator==(const FrameAllocator<U>& other) const noexcept {
+      return m_arena == other.getArena();
+    }
+
+    template<typename U>
+    bool operator!=(const FrameAllocator<U>& other) const noexcept {
+      return m_arena != other.getArena();
+    }
+
+  private:
+    FrameArena* m_arena;
+  };
+
+  template<typename T>
+  using frame_vector = std::vector<T, FrameAllocator<T>>;
+
+  template<typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+  using frame_unordered_map = std::unordered_map<K, V, Hash, KeyEqual, FrameAllocator<std::pair<const K, V>>>;
+
+}
@@ -0,0 +1,188 @@
+#include "util_lz4.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dxvk::lz4 {
+
+  namespace {
+    constexpr size_t   MinMatch    = 4;
+    // The format requires the last match to start at least 12 bytes
+    // before the end of the block, and the last 5 bytes to be literals
+    constexpr size_t   MatchFind   = 12;
+    constexpr size_t   LastLiterals = 5;
+    constexpr size_t   MaxOffset   = 65535;
+    constexpr uint32_t HashLog     = 12;
+
+    inline uint32_t read32(const uint8_t* ptr) {
+      uint32_t value;
+      std::memcpy(&value, ptr, sizeof(value));
+      return value;
+    }
+
+    inline uint32_t hash(uint32_t value) {
+      return (value * 2654435761u) >> (32 - HashLog);
+    }
+
+    inline uint8_t* writeLength(uint8_t* op, size_t length) {
+      while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+      }
+
+      *op++ = uint8_t(length);
+      return op;
+    }
+
+    inline uint8_t* writeLiterals(uint8_t* op, uint8_t* token, const uint8_t* literals, size_t count) {
+      *token = uint8_t(std::min<size_t>(count, 15) << 4);
+
+      if (count >= 15)
+        op = writeLength(op, count - 15);
+
+      std::memcpy(op, literals, count);
+      return op + count;
+    }
+  }
+
+
+  size_t compress(
+    const uint8_t*  src,
+          size_t    srcSize,
+          uint8_t*  dst) {
+    const uint8_t* ip     = src;
+    const uint8_t* anchor = src;
+    const uint8_t* iend   = src + srcSize;
+    uint8_t*       op     = dst;
+
+    if (srcSize > MatchFind) {
+      const uint8_t* mflimit    = iend - MatchFind;
+      const uint8_t* matchlimit = iend - LastLiterals;
+
+      uint32_t table[1u << HashLog] = { };
+
+      while (ip < mflimit) {
+        const uint32_t sequence = read32(ip);
+        const uint32_t h = hash(sequence);
+
+        const uint8_t* ref = src + table[h];
+        table[h] = uint32_t(ip - src);
+
+        if (ref >= ip || size_t(ip - ref) > MaxOffset || read32(ref) != sequence) {
+          // Skip ahead faster through data that doesn't compress
+          ip += 1 + ((ip - anchor) >> 6);
+          continue;
+        }
+
+        size_t matchLength = MinMatch;
+
+        while (ip + matchLength < matchlimit && ref[matchLength] == ip[matchLength])
+          matchLength++;
+
+        uint8_t* token = op++;
+        op = writeLiterals(op, token, anchor, size_t(ip - anchor));
+
+        const size_t offset = size_t(ip - ref);
+        *op++ = uint8_t(offset);
+        *op++ = uint8_t(offset >> 8);
+
+        const size_t matchCode = matchLength - MinMatch;
+        *token |= uint8_t(std::min<size_t>(matchCode, 15));
+
+        if (matchCode >= 15)
+          op = writeLength(op, matchCode - 15);
+
+        ip    += matchLength;
+        anchor = ip;
+      }
+    }
+
+    uint8_t* token = op++;
+    op = writeLiterals(op, token, anchor, size_t(iend - anchor));
+    return size_t(op - dst);
+  }
+
+
+  bool decompress(
+    const uint8_t*  src,
+          size_t    srcSize,
+          uint8_t*  dst,
+          size_t    dstSize) {
+    const uint8_t* ip   = src;
+    const uint8_t* iend = src + srcSize;
+    uint8_t*       op   = dst;
+    uint8_t*       oend = dst + dstSize;
+
+    while (ip < iend) {
+      const uint8_t token = *ip++;
+
+      size_t literalCount = token >> 4;
+
+      if (literalCount == 15) {
+        uint8_t b;
+
+        do {
+          if (ip == iend)
+            return false;
+
+          b = *ip++;
+          literalCount += b;
+        } while (b == 255);
+      }
+
+      if (literalCount > size_t(iend - ip) || literalCount > size_t(oend - op))
+        return false;
+
+      std::memcpy(op, ip, literalCount);
+      ip += literalCount;
+      op += literalCount;
+
+      // The last sequence only has literals
+      if (ip == iend)
+        break;
+
+      if (iend - ip < 2)
+        return false;
+
+      const size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+      ip += 2;
+
+      if (offset == 0 || offset > size_t(op - dst))
+        return false;
+
+      size_t matchLength = token & 15;
+
+      if (matchLength == 15) {
+        uint8_t b;
+
+        do {
+          if (ip == iend)
+            return false;
+
+          b = *ip++;
+          matchLength += b;
+        } while (b == 255);
+      }
+
+      matchLength += MinMatch;
+
+      if (matchLength > size_t(oend - op))
+        return false;
+
+      // Matches may overlap the bytes they produce
+      const uint8_t* match = op - offset;
+
+      if (offset >= matchLength) {
+        std::memcpy(op, match, matchLength);
+      } else {
+        for (size_t i = 0; i < matchLength; i++)
+          op[i] = match[i];
+      }
+
+      op += matchLength;
+    }
+
+    return op == oend;
+  }
+
+}
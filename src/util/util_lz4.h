@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dxvk::lz4 {
+
+  /**
+   * \brief Worst case size of compressed data
+   *
+   * \param [in] size Size of the uncompressed data
+   * \returns Size of the buffer to pass to \ref compress
+   */
+  inline size_t compressBound(size_t size) {
+    return size + size / 255 + 16;
+  }
+
+  /**
+   * \brief Compresses data in the LZ4 block format
+   *
+   * Uses a single pass with a small hash table, which favours
+   * speed over ratio. The output can be decoded by any LZ4
+   * block decoder.
+   * \param [in] src Data to compress
+   * \param [in] srcSize Size of the data
+   * \param [out] dst Output buffer, at least \ref compressBound bytes
+   * \returns Size of the compressed data
+   */
+  size_t compress(
+    const uint8_t*  src,
+          size_t    srcSize,
+          uint8_t*  dst);
+
+  /**
+   * \brief Decompresses an LZ4 block
+   *
+   * Validates the stream, so corrupted data never
+   * reads or writes outside of the given buffers.
+   * \param [in] src Compressed data
+   * \param [in] srcSize Size of the compressed data
+   * \param [out] dst Output buffer
+   * \param [in] dstSize Exact size of the uncompressed data
+   * \returns \c true if exactly \c dstSize bytes were decoded
+   */
+  bool decompress(
+    const uint8_t*  src,
+          size_t    srcSize,
+          uint8_t*  dst,
+          size_t    dstSize);
+
+}
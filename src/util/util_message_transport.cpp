@@ -0,0 +1,372 @@
+#include "util_message_transport.h"
+
+#include <chrono>
+#include <new>
+#include <thread>
+
+#include <immintrin.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace dxvk {
+
+  namespace {
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * \brief Waits for a condition with increasing back-off
+     *
+     * Spins first, since a busy peer usually answers within
+     * microseconds, then yields, then sleeps.
+     * \returns \c false if the condition is still not met after the timeout
+     */
+    template<typename Fn>
+    bool waitFor(uint32_t timeoutMs, const Fn& fn) {
+      const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+
+      for (uint32_t i = 0; !fn(); i++) {
+        if (i < 1024) {
+          _mm_pause();
+          continue;
+        }
+
+        if (Clock::now() >= deadline)
+          return false;
+
+        if (i < 4096)
+          std::this_thread::yield();
+        else
+          std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+
+      return true;
+    }
+
+#ifdef _WIN32
+    std::string getWakeEventName(const std::string& name) {
+      return name + "_wake";
+    }
+#else
+    std::string getPosixName(const std::string& name) {
+      return name.size() && name[0] == '/' ? name : "/" + name;
+    }
+#endif
+  }
+
+
+  SharedMemoryRegion::~SharedMemoryRegion() {
+    close();
+  }
+
+
+  bool SharedMemoryRegion::create(const std::string& name, size_t size) {
+    close();
+
+#ifdef _WIN32
+    HANDLE mapping = ::CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+      DWORD(uint64_t(size) >> 32), DWORD(size), name.c_str());
+
+    if (!mapping)
+      return false;
+
+    if (::GetLastError() == ERROR_ALREADY_EXISTS) {
+      ::CloseHandle(mapping);
+      return false;
+    }
+
+    m_data = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+    if (!m_data) {
+      ::CloseHandle(mapping);
+      return false;
+    }
+
+    m_handle = mapping;
+#else
+    const std::string posixName = getPosixName(name);
+    const int fd = ::shm_open(posixName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+
+    if (fd < 0)
+      return false;
+
+    void* data = ::ftruncate(fd, off_t(size)) == 0
+      ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+      : MAP_FAILED;
+
+    ::close(fd);
+
+    if (data == MAP_FAILED) {
+      ::shm_unlink(posixName.c_str());
+      return false;
+    }
+
+    m_data = data;
+#endif
+
+    m_name = name;
+    m_size = size;
+    m_owner = true;
+    return true;
+  }
+
+
+  bool SharedMemoryRegion::open(const std::string& name, size_t size) {
+    close();
+
+#ifdef _WIN32
+    HANDLE mapping = ::OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+
+    if (!mapping)
+      return false;
+
+    m_data = ::MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+
+    if (!m_data) {
+      ::CloseHandle(mapping);
+      return false;
+    }
+
+    m_handle = mapping;
+#else
+    const int fd = ::shm_open(getPosixName(name).c_str(), O_RDWR, 0600);
+
+    if (fd < 0)
+      return false;
+
+    // The creator may not have sized the object yet
+    struct stat info = { };
+
+    void* data = ::fstat(fd, &info) == 0 && size_t(info.st_size) >= size
+      ? ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+      : MAP_FAILED;
+
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+      return false;
+
+    m_data = data;
+#endif
+
+    m_name = name;
+    m_size = size;
+    m_owner = false;
+    return true;
+  }
+
+
+  void SharedMemoryRegion::close() {
+    if (!m_data)
+      return;
+
+#ifdef _WIN32
+    ::UnmapViewOfFile(m_data);
+    ::CloseHandle(HANDLE(m_handle));
+#else
+    ::munmap(m_data, m_size);
+
+    if (m_owner)
+      ::shm_unlink(getPosixName(m_name).c_str());
+#endif
+
+    m_name.clear();
+    m_data = nullptr;
+    m_size = 0;
+    m_owner = false;
+    m_handle = nullptr;
+  }
+
+
+  SharedMemoryRing::Header* SharedMemoryRing::initialize(void* memory, uint32_t capacity) {
+    Header* header = new (memory) Header();
+    header->version = Version;
+    header->capacity = capacity;
+    header->consumerWaiting.store(0, std::memory_order_relaxed);
+    header->writePos.store(0, std::memory_order_relaxed);
+    header->readPos.store(0, std::memory_order_relaxed);
+    header->magic.store(Magic, std::memory_order_release);
+    return header;
+  }
+
+
+  uint32_t SharedMemoryRing::getCapacity(const void* memory) {
+    const Header* header = reinterpret_cast<const Header*>(memory);
+
+    if (header->magic.load(std::memory_order_acquire) != Magic
+     || header->version != Version)
+      return 0;
+
+    return header->capacity;
+  }
+
+
+  SharedMemoryRing::Header* SharedMemoryRing::attach(void* memory, size_t size) {
+    if (size < sizeof(Header))
+      return nullptr;
+
+    Header* header = reinterpret_cast<Header*>(memory);
+
+    if (header->magic.load(std::memory_order_acquire) != Magic
+     || header->version != Version)
+      return nullptr;
+
+    const uint32_t capacity = header->capacity;
+
+    if (capacity < 64 || (capacity & (capacity - 1)) || getRequiredSize(capacity) > size)
+      return nullptr;
+
+    return header;
+  }
+
+
+  SharedMemoryTransport::~SharedMemoryTransport() {
+    if (m_ring && m_isSender)
+      flush();
+
+    closeWakeEvent();
+  }
+
+
+  void SharedMemoryTransport::closeWakeEvent() {
+#ifdef _WIN32
+    if (m_wakeEvent)
+      ::CloseHandle(HANDLE(m_wakeEvent));
+#endif
+    m_wakeEvent = nullptr;
+  }
+
+
+  bool SharedMemoryTransport::createSender(const std::string& name, uint32_t capacity) {
+    m_ring = nullptr;
+    closeWakeEvent();
+
+    uint32_t ringCapacity = 64;
+    while (ringCapacity < capacity && ringCapacity < (1u << 30))
+      ringCapacity <<= 1;
+
+    if (!m_region.create(name, SharedMemoryRing::getRequiredSize(ringCapacity)))
+      return false;
+
+    m_ring = std::make_unique<SharedMemoryRing>(
+      SharedMemoryRing::initialize(m_region.data(), ringCapacity));
+    m_isSender = true;
+
+#ifdef _WIN32
+    // Auto-reset, one signal wakes the receiver once
+    m_wakeEvent = ::CreateEventA(nullptr, FALSE, FALSE, getWakeEventName(name).c_str());
+#endif
+    return true;
+  }
+
+
+  bool SharedMemoryTransport::openReceiver(const std::string& name) {
+    m_ring = nullptr;
+    closeWakeEvent();
+
+    // Map the header first to learn the size of the ring
+    if (!m_region.open(name, sizeof(SharedMemoryRing::Header)))
+      return false;
+
+    const uint32_t capacity = SharedMemoryRing::getCapacity(m_region.data());
+
+    if (!capacity)
+      return false;
+
+    const size_t size = SharedMemoryRing::getRequiredSize(capacity);
+    SharedMemoryRing::Header* header = nullptr;
+
+    if (!m_region.open(name, size) || !(header = SharedMemoryRing::attach(m_region.data(), size)))
+      return false;
+
+    m_ring = std::make_unique<SharedMemoryRing>(header);
+    m_isSender = false;
+
+#ifdef _WIN32
+    // Receivers without the event fall back to polling
+    m_wakeEvent = ::OpenEventA(SYNCHRONIZE, FALSE, getWakeEventName(name).c_str());
+#endif
+    return true;
+  }
+
+
+  bool SharedMemoryTransport::send(uint32_t msg, const void* payload, uint32_t size) {
+    if (!canSend())
+      return false;
+
+    if (m_ring->push(msg, payload, size))
+      return true;
+
+    // Oversized payloads never fit, callers check getMaxPayloadSize
+    if (size > m_ring->getMaxPayloadSize())
+      return false;
+
+    // The ring is full, hand what we have to the receiver and wait for room
+    publish();
+
+    return waitFor(m_sendTimeoutMs, [&] {
+      return m_ring->push(msg, payload, size);
+    });
+  }
+
+
+  void SharedMemoryTransport::flush() {
+    if (canSend())
+      publish();
+  }
+
+
+  void SharedMemoryTransport::publish() {
+    const bool wake = m_ring->publish();
+
+#ifdef _WIN32
+    if (wake && m_wakeEvent)
+      ::SetEvent(HANDLE(m_wakeEvent));
+#else
+    (void) wake;
+#endif
+  }
+
+
+  bool SharedMemoryTransport::waitForDrain(uint32_t timeoutMs) {
+    if (!canSend())
+      return false;
+
+    publish();
+
+    return waitFor(timeoutMs, [&] {
+      return m_ring->isDrained();
+    });
+  }
+
+
+  bool SharedMemoryTransport::waitForMessages(uint32_t timeoutMs) {
+    if (!m_ring || m_isSender)
+      return false;
+
+    return waitFor(timeoutMs, [&] {
+      return m_ring->hasRecords();
+    });
+  }
+
+
+  bool SharedMemoryTransport::beginWait() {
+    if (!m_ring || m_isSender)
+      return false;
+
+    return m_ring->beginWait();
+  }
+
+
+  void SharedMemoryTransport::endWait() {
+    if (m_ring && !m_isSender)
+      m_ring->endWait();
+  }
+
+}
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+namespace dxvk {
+
+  /**
+   * \brief Message transport
+   *
+   * Moves messages with an ID and a payload from one process to
+   * another. Backends may queue messages in \ref send, they only
+   * have to be delivered once \ref flush has been called, which
+   * allows sending a batch of messages at the cost of one.
+   */
+  class MessageTransport {
+  public:
+    virtual ~MessageTransport() { }
+
+    virtual bool canSend() const = 0;
+
+    /**
+     * \brief Largest payload a single message can carry
+     */
+    virtual uint32_t getMaxPayloadSize() const = 0;
+
+    /**
+     * \brief Queues a message
+     *
+     * \param [in] msg Message ID
+     * \param [in] payload Message payload
+     * \param [in] size Payload size in bytes
+     * \returns \c false if the message could not be queued
+     */
+    virtual bool send(uint32_t msg, const void* payload, uint32_t size) = 0;
+
+    /**
+     * \brief Delivers all queued messages
+     */
+    virtual void flush() { }
+  };
+
+
+  /**
+   * \brief Named shared memory region
+   *
+   * A file mapping on Windows and a POSIX shared memory object
+   * elsewhere. The process that creates the region removes its
+   * name again when the region is destroyed.
+   */
+  class SharedMemoryRegion {
+  public:
+    SharedMemoryRegion() { }
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator = (const SharedMemoryRegion&) = delete;
+
+    /**
+     * \brief Creates a zero-initialized region
+     * \returns \c false if the region exists or can't be created
+     */
+    bool create(const std::string& name, size_t size);
+
+    /**
+     * \brief Opens a region created by another process
+     */
+    bool open(const std::string& name, size_t size);
+
+    void* data() const {
+      return m_data;
+    }
+
+    size_t size() const {
+      return m_size;
+    }
+
+  private:
+    void close();
+
+    std::string m_name;
+    void*       m_data = nullptr;
+    size_t      m_size = 0;
+    bool        m_owner = false;
+    void*       m_handle = nullptr;
+  };
+
+
+  /**
+   * \brief Ring buffer of variable size messages in shared memory
+   *
+   * Single producer, single consumer. Records are a message ID and
+   * payload size followed by the payload, padded to 8 bytes, so a
+   * record never has to be copied out before it is handed to the
+   * consumer. A record that doesn't fit at the end of the buffer
+   * starts at the beginning, after a padding record.
+   *
+   * The producer stages records and publishes them with a single
+   * store, the consumer releases the space of everything it has
+   * read at once. Neither side takes a lock. A consumer that wants
+   * to sleep announces it in the header, so that the producer knows
+   * when a publish has to wake it.
+   */
+  class SharedMemoryRing {
+    constexpr static uint32_t Magic = 0x474E5252; // "RRNG"
+    constexpr static uint32_t Version = 2;
+    constexpr static uint32_t PaddingMsg = ~0u;
+  public:
+
+    /**
+     * \brief Ring header, followed by the data
+     *
+     * The positions only ever grow and are wrapped when
+     * indexing the data. Each lives on its own cache line
+     * so that the two processes don't contend for it.
+     */
+    struct Header {
+      // Written last when the ring is initialized
+      std::atomic<uint32_t>              magic;
+      uint32_t                           version;
+      uint32_t                           capacity;
+      // Set while the consumer sleeps until records are published
+      std::atomic<uint32_t>              consumerWaiting;
+      alignas(64) std::atomic<uint64_t>  writePos;
+      alignas(64) std::atomic<uint64_t>  readPos;
+    };
+
+    static_assert(sizeof(Header) % 64 == 0);
+    static_assert(std::atomic<uint32_t>::is_always_lock_free
+               && std::atomic<uint64_t>::is_always_lock_free,
+      "Shared memory rings need lock-free atomics");
+
+    struct RecordHeader {
+      uint32_t msg;
+      uint32_t size;
+    };
+
+    /**
+     * \brief Memory needed for a ring
+     * \param [in] capacity Data size, a power of two
+     */
+    static size_t getRequiredSize(uint32_t capacity) {
+      return sizeof(Header) + capacity;
+    }
+
+    /**
+     * \brief Initializes a ring in zeroed memory
+     */
+    static Header* initialize(void* memory, uint32_t capacity);
+
+    /**
+     * \brief Capacity of an initialized ring
+     *
+     * Only needs the header to be mapped.
+     * \returns The capacity, or 0 if the ring isn't initialized
+     */
+    static uint32_t getCapacity(const void* memory);
+
+    /**
+     * \brief Validates a ring created by another process
+     * \returns The ring, or \c nullptr if it isn't initialized
+     */
+    static Header* attach(void* memory, size_t size);
+
+    explicit SharedMemoryRing(Header* header)
+    : m_header  (header),
+      m_data    (reinterpret_cast<uint8_t*>(header + 1)),
+      m_mask    (header->capacity - 1),
+      m_writePos      (header->writePos.load(std::memory_order_acquire)),
+      m_cachedReadPos (header->readPos.load(std::memory_order_acquire)),
+      m_readPos       (m_cachedReadPos),
+      m_cachedWritePos(m_writePos) { }
+
+    uint32_t getMaxPayloadSize() const {
+      // Keeps records small enough that padding can never starve the ring
+      return m_header->capacity / 4 - sizeof(RecordHeader);
+    }
+
+    /**
+     * \brief Stages a record
+     *
+     * The record is not visible to the consumer
+     * before \ref publish is called.
+     * \returns \c false if the ring is full
+     */
+    bool push(uint32_t msg, const void* payload, uint32_t size) {
+      if (size > getMaxPayloadSize() || msg == PaddingMsg)
+        return false;
+
+      const uint32_t capacity = m_header->capacity;
+      const uint32_t recordSize = getRecordSize(size);
+      const uint32_t offset = uint32_t(m_writePos) & m_mask;
+      const uint32_t padding = capacity - offset < recordSize ? capacity - offset : 0;
+
+      if (m_writePos + padding + recordSize - m_cachedReadPos > capacity) {
+        m_cachedReadPos = m_header->readPos.load(std::memory_order_acquire);
+
+        if (m_writePos + padding + recordSize - m_cachedReadPos > capacity)
+          return false;
+      }
+
+      if (padding) {
+        writeRecordHeader(offset, PaddingMsg, padding - sizeof(RecordHeader));
+        m_writePos += padding;
+      }
+
+      const uint32_t start = uint32_t(m_writePos) & m_mask;
+      writeRecordHeader(start, msg, size);
+
+      if (size)
+        std::memcpy(&m_data[start + sizeof(RecordHeader)], payload, size);
+
+      m_writePos += recordSize;
+      return true;
+    }
+
+    /**
+     * \brief Makes all staged records visible to the consumer
+     *
+     * Sequentially consistent with \ref beginWait, so either
+     * the consumer sees the records or the producer sees
+     * the consumer waiting.
+     * \returns \c true if the consumer is waiting to be woken up
+     */
+    bool publish() {
+      m_header->writePos.store(m_writePos, std::memory_order_seq_cst);
+      return m_header->consumerWaiting.load(std::memory_order_seq_cst) != 0;
+    }
+
+    /**
+     * \brief Announces that the consumer is about to sleep
+     *
+     * \returns \c false if records were published in the meantime,
+     *    in which case the consumer must not sleep
+     */
+    bool beginWait() {
+      m_header->consumerWaiting.store(1, std::memory_order_seq_cst);
+
+      if (m_readPos != m_header->writePos.load(std::memory_order_seq_cst)) {
+        endWait();
+        return false;
+      }
+
+      return true;
+    }
+
+    void endWait() {
+      m_header->consumerWaiting.store(0, std::memory_order_relaxed);
+    }
+
+    bool hasUnpublished() const {
+      return m_writePos != m_header->writePos.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Whether there are published records to consume
+     */
+    bool hasRecords() const {
+      return m_readPos != m_header->writePos.load(std::memory_order_acquire);
+    }
+
+    /**
+     * \brief Whether the consumer has read everything published
+     */
+    bool isDrained() const {
+      return m_header->readPos.load(std::memory_order_acquire)
+          == m_header->writePos.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \brief Hands published records to a callback
+     *
+     * The payload pointer is only valid during the callback.
+     * \param [in] fn Callback taking the message ID, payload and size
+     * \param [in] maxMessages Maximum number of messages to read
+     * \returns Number of messages read
+     */
+    template<typename Fn>
+    uint32_t consume(Fn&& fn, uint32_t maxMessages = ~0u) {
+      uint32_t count = 0;
+
+      if (m_readPos == m_cachedWritePos)
+        m_cachedWritePos = m_header->writePos.load(std::memory_order_acquire);
+
+      while (m_readPos != m_cachedWritePos && count < maxMessages) {
+        const uint32_t offset = uint32_t(m_readPos) & m_mask;
+
+        RecordHeader record;
+        std::memcpy(&record, &m_data[offset], sizeof(record));
+
+        // The other process may be broken, never read past the buffer
+        const uint32_t recordSize = getRecordSize(record.size);
+
+        if (recordSize > m_header->capacity - offset || m_cachedWritePos - m_readPos < recordSize) {
+          m_broken = true;
+          m_readPos = m_cachedWritePos;
+          break;
+        }
+
+        if (record.msg != PaddingMsg) {
+          fn(record.msg, &m_data[offset + sizeof(RecordHeader)], record.size);
+          count += 1;
+        }
+
+        m_readPos += recordSize;
+      }
+
+      m_header->readPos.store(m_readPos, std::memory_order_release);
+      return count;
+    }
+
+    /**
+     * \brief Whether a malformed record was encountered
+     */
+    bool isBroken() const {
+      return m_broken;
+    }
+
+  private:
+
+    Header*  m_header;
+    uint8_t* m_data;
+    uint32_t m_mask;
+
+    // Producer state
+    uint64_t m_writePos;
+    uint64_t m_cachedReadPos;
+
+    // Consumer state
+    uint64_t m_readPos;
+    uint64_t m_cachedWritePos;
+    bool     m_broken = false;
+
+    static uint32_t getRecordSize(uint32_t size) {
+      return (uint32_t(sizeof(RecordHeader)) + size + 7u) & ~7u;
+    }
+
+    void writeRecordHeader(uint32_t offset, uint32_t msg, uint32_t size) {
+      const RecordHeader record = { msg, size };
+      std::memcpy(&m_data[offset], &record, sizeof(record));
+    }
+
+  };
+
+
+  /**
+   * \brief Shared memory message transport
+   *
+   * One direction of a channel between two processes, a bidirectional
+   * channel uses one transport per direction. The sender creates the
+   * ring and the receiver opens it by name.
+   *
+   * Messages are staged by \ref send and published by \ref flush. When
+   * the ring is full, \ref send publishes what is staged and waits for
+   * the receiver to make room, up to the send timeout, so a slow receiver
+   * throttles the sender instead of losing messages.
+   *
+   * On Windows the sender also creates a wake event, which it signals
+   * when it publishes while the receiver sleeps. The receiver can block
+   * on it together with other handles instead of polling the ring.
+   */
+  class SharedMemoryTransport : public MessageTransport {
+  public:
+    constexpr static uint32_t DefaultCapacity = 1u << 20;
+    constexpr static uint32_t DefaultSendTimeoutMs = 1000;
+
+    SharedMemoryTransport() { }
+    ~SharedMemoryTransport();
+
+    /**
+     * \brief Creates the sending side of a channel
+     * \param [in] name Channel name, shared by both processes
+     * \param [in] capacity Ring size, rounded up to a power of two
+     */
+    bool createSender(const std::string& name, uint32_t capacity = DefaultCapacity);
+
+    /**
+     * \brief Opens the receiving side of a channel
+     */
+    bool openReceiver(const std::string& name);
+
+    void setSendTimeout(uint32_t timeoutMs) {
+      m_sendTimeoutMs = timeoutMs;
+    }
+
+    bool canSend() const override {
+      return m_ring != nullptr && m_isSender;
+    }
+
+    uint32_t getMaxPayloadSize() const override {
+      return m_ring ? m_ring->getMaxPayloadSize() : 0;
+    }
+
+    bool send(uint32_t msg, const void* payload, uint32_t size) override;
+
+    void flush() override;
+
+    /**
+     * \brief Waits for the receiver to read all messages
+     * \returns \c false on timeout
+     */
+    bool waitForDrain(uint32_t timeoutMs);
+
+    /**
+     * \brief Dispatches received messages
+     *
+     * \param [in] fn Callback taking the message ID, payload and size
+     * \param [in] maxMessages Maximum number of messages to dispatch
+     * \returns Number of messages dispatched
+     */
+    template<typename Fn>
+    uint32_t receive(Fn&& fn, uint32_t maxMessages = ~0u) {
+      if (!m_ring || m_isSender)
+        return 0;
+      return m_ring->consume(std::forward<Fn>(fn), maxMessages);
+    }
+
+    /**
+     * \brief Waits for messages to arrive
+     *
+     * Spins briefly before backing off to sleeping,
+     * which keeps the latency of busy channels low.
+     * \returns \c false on timeout
+     */
+    bool waitForMessages(uint32_t timeoutMs);
+
+    /**
+     * \brief Prepares the receiver to sleep on the wake event
+     *
+     * Must be followed by \ref endWait once the receiver is awake.
+     * \returns \c false if messages arrived and the receiver must not sleep
+     */
+    bool beginWait();
+
+    void endWait();
+
+    /**
+     * \brief Event the sender signals while the receiver waits
+     * \returns The event handle, or \c nullptr if there is none
+     */
+    void* getWakeEvent() const {
+      return m_wakeEvent;
+    }
+
+  private:
+
+    SharedMemoryRegion                 m_region;
+    std::unique_ptr<SharedMemoryRing>  m_ring;
+    bool                               m_isSender = false;
+    uint32_t                           m_sendTimeoutMs = DefaultSendTimeoutMs;
+    void*                              m_wakeEvent = nullptr;
+
+    void publish();
+    void closeWakeEvent();
+
+  };
+
+}
@@ -21,6 +21,9 @@
 */
 #include "util_messagechannel.h"
 
+#include <algorithm>
+#include <cstring>
+
 #if defined(TREX_BRIDGE_CLIENT) || defined(TREX_BRIDGE_SERVER)
 #include "config/global_options.h"
 #else
@@ -56,6 +59,30 @@ static std::string format_string(const std::string& format, Args... args) {
 
 #endif
 
+// NV-DXVK start: message transports
+bool ThreadMessageTransport::send(uint32_t msg, const void* payload, uint32_t size) {
+  if (!canSend() || size > sizeof(MessageParams)) {
+    return false;
+  }
+
+  MessageParams params = { };
+  std::memcpy(&params, payload, size);
+
+  return ::PostThreadMessage(m_threadId, msg, params.wParam, params.lParam) != FALSE;
+}
+
+bool WindowMessageTransport::send(uint32_t msg, const void* payload, uint32_t size) {
+  if (!canSend() || size > sizeof(MessageParams)) {
+    return false;
+  }
+
+  MessageParams params = { };
+  std::memcpy(&params, payload, size);
+
+  return ::PostMessage(m_window, msg, params.wParam, params.lParam) != 0;
+}
+// NV-DXVK end
+
 MessageChannelBase::MessageChannelBase(const char* handshakeMsgName)
 : m_handshakeMsgName(handshakeMsgName)
 {
@@ -68,11 +95,131 @@ MessageChannelBase::MessageChannelBase(const char* handshakeMsgName)
   }
 }
 
+// NV-DXVK start: message transports
+bool MessageChannelBase::onMessage(uint32_t msgId, const void* payload, uint32_t size) {
+  if (!IsRemixBridgeActive()) {
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> _(m_accessMutex);
+  return dispatch(msgId, payload, size);
+}
+
+uint32_t MessageChannelBase::receive(dxvk::SharedMemoryTransport& transport, uint32_t maxMessages) {
+  if (!IsRemixBridgeActive()) {
+    // Still consume the messages so the sender does not stall on a full ring
+    return transport.receive([](uint32_t, const void*, uint32_t) { }, maxMessages);
+  }
+
+  // One lock for the whole batch rather than one per message
+  std::lock_guard<std::recursive_mutex> _(m_accessMutex);
+
+  return transport.receive([this](uint32_t msg, const void* payload, uint32_t size) {
+    dispatch(msg, payload, size);
+  }, maxMessages);
+}
+
+bool MessageChannelBase::dispatch(uint32_t msgId, const void* payload, uint32_t size) {
+  const DispatchEntry* found = findDispatchEntry(msgId);
+
+  if (!found) {
+    return false;
+  }
+
+  // Copy the entry, a handler may register handlers and rebuild the table.
+  // The handler objects themselves live in map nodes and stay put.
+  const DispatchEntry entry = *found;
+
+  if (entry.handler && size <= sizeof(MessageParams)) {
+    MessageParams params = { };
+    std::memcpy(&params, payload, size);
+
+    if ((*entry.handler)(params.wParam, params.lParam)) {
+      return true;
+    }
+  }
+
+  if (entry.dataHandler) {
+    return (*entry.dataHandler)(payload, size);
+  }
+
+  return false;
+}
+
+const MessageChannelBase::DispatchEntry* MessageChannelBase::findDispatchEntry(uint32_t msg) const {
+  auto it = std::lower_bound(m_dispatchTable.begin(), m_dispatchTable.end(), msg,
+    [](const DispatchEntry& entry, uint32_t msg) {
+      return entry.msg < msg;
+    });
+
+  return it != m_dispatchTable.end() && it->msg == msg ? &*it : nullptr;
+}
+
+void MessageChannelBase::updateDispatchTable() {
+  m_dispatchTable.clear();
+  m_dispatchTable.reserve(m_handlers.size() + m_dataHandlers.size());
+
+  for (auto& handler : m_handlers) {
+    m_dispatchTable.push_back({ handler.first, &handler.second, nullptr });
+  }
+
+  for (auto& handler : m_dataHandlers) {
+    m_dispatchTable.push_back({ handler.first, nullptr, &handler.second });
+  }
+
+  std::sort(m_dispatchTable.begin(), m_dispatchTable.end(),
+    [](const DispatchEntry& a, const DispatchEntry& b) {
+      return a.msg < b.msg;
+    });
+
+  // Merge the handler and data handler entries of the same message
+  size_t count = 0;
+
+  for (const DispatchEntry& entry : m_dispatchTable) {
+    if (count && m_dispatchTable[count - 1].msg == entry.msg) {
+      if (entry.dataHandler) {
+        m_dispatchTable[count - 1].dataHandler = entry.dataHandler;
+      } else {
+        m_dispatchTable[count - 1].handler = entry.handler;
+      }
+    } else {
+      m_dispatchTable[count++] = entry;
+    }
+  }
+
+  m_dispatchTable.resize(count);
+}
+
+bool MessageChannelBase::registerDataHandler(uint32_t msg, DataHandlerType&& handler) {
+  if (msg) {
+    std::lock_guard<std::recursive_mutex> _(m_accessMutex);
+    m_dataHandlers[msg] = std::move(handler);
+    updateDispatchTable();
+    return true;
+  }
+
+  return false;
+}
+
+bool MessageChannelBase::registerDataHandler(const char* msgName, DataHandlerType&& handler) {
+  if (uint32_t msg = getMessageId(msgName)) {
+    return registerDataHandler(msg, std::move(handler));
+  }
+
+  Logger::err(format_string("Message data handler %s was not registered!", msgName));
+
+  return false;
+}
+// NV-DXVK end
+
 bool MessageChannelBase::registerHandler(uint32_t msg, HandlerType&& handler) {
   if (msg) {
     std::lock_guard<std::recursive_mutex> _(m_accessMutex);
 
     m_handlers[msg] = std::move(handler);
+    // NV-DXVK start: message transports
+    updateDispatchTable();
+    // NV-DXVK end
     return true;
   }
 
@@ -83,6 +230,9 @@ bool MessageChannelBase::registerHandler(const char* msgName, HandlerType&& hand
   if (uint32_t msg = getMessageId(msgName)) {
     std::lock_guard<std::recursive_mutex> _(m_accessMutex);
     m_handlers[msg] = std::move(handler);
+    // NV-DXVK start: message transports
+    updateDispatchTable();
+    // NV-DXVK end
     return true;
   }
 
@@ -94,12 +244,20 @@ bool MessageChannelBase::registerHandler(const char* msgName, HandlerType&& hand
 void MessageChannelBase::removeHandler(const char* msgName) {
   std::lock_guard<std::recursive_mutex> _(m_accessMutex);
   m_handlers.erase(m_msgs[msgName]);
+  // NV-DXVK start: message transports
+  m_dataHandlers.erase(m_msgs[msgName]);
+  updateDispatchTable();
+  // NV-DXVK end
   m_msgs.erase(msgName);
 }
 
 void MessageChannelBase::removeHandler(uint32_t msg) {
   std::lock_guard<std::recursive_mutex> _(m_accessMutex);
   m_handlers.erase(msg);
+  // NV-DXVK start: message transports
+  m_dataHandlers.erase(msg);
+  updateDispatchTable();
+  // NV-DXVK end
 }
 
 uint32_t MessageChannelBase::getMessageId(const char* msgName) {
@@ -132,23 +290,29 @@ bool MessageChannelBase::onMessage(uint32_t msgId, uint32_t wParam,
 
   std::lock_guard<std::recursive_mutex> _(m_accessMutex);
   
-  auto it = m_handlers.find(msgId);
-  if (it != m_handlers.end()) {
-    return it->second(wParam, lParam);
+  // NV-DXVK start: message transports
+  const DispatchEntry* entry = findDispatchEntry(msgId);
+  if (entry && entry->handler) {
+    return (*entry->handler)(wParam, lParam);
   }
+  // NV-DXVK end
 
   return false;
 }
 
 MessageChannelClient::MessageChannelClient(const char* handshakeMsgName)
 : MessageChannelBase(handshakeMsgName)
+, m_transport(std::make_unique<ThreadMessageTransport>())
 {
-  registerHandler(handshakeMsgName, [this](uint32_t wParam, uint32_t lParam) {
-    m_serverThreadId = wParam;
+  // NV-DXVK start: message transports
+  ThreadMessageTransport* threadTransport = static_cast<ThreadMessageTransport*>(m_transport.get());
+  registerHandler(handshakeMsgName, [this, threadTransport](uint32_t wParam, uint32_t lParam) {
+    threadTransport->setThreadId(wParam);
     Logger::info(format_string("Message channel %s handshake complete.",
                                m_handshakeMsgName));
     return true;
   });
+  // NV-DXVK end
 }
 
 bool MessageChannelClient::send(uint32_t msg, uint32_t wParam, uint32_t lParam) {
@@ -156,8 +320,31 @@ bool MessageChannelClient::send(uint32_t msg, uint32_t wParam, uint32_t lParam)
     return false;
   }
 
-  return ::PostThreadMessage(m_serverThreadId, msg, wParam, lParam) != FALSE;
+  const MessageParams params = { wParam, lParam };
+
+  // NV-DXVK start: message transports
+  // Delivered right away like the window messages they replace
+  std::lock_guard<std::mutex> _(m_sendMutex);
+
+  if (!m_transport->send(msg, &params, sizeof(params))) {
+    return false;
+  }
+
+  m_transport->flush();
+  return true;
+  // NV-DXVK end
+}
+
+// NV-DXVK start: message transports
+bool MessageChannelClient::send(uint32_t msg, const void* payload, uint32_t size) {
+  if (!IsRemixBridgeActive() || !canSend()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> _(m_sendMutex);
+  return m_transport->send(msg, payload, size);
 }
+// NV-DXVK end
 
 bool MessageChannelClient::send(const char* msgName, uint32_t wParam, uint32_t lParam) {
   if (!IsRemixBridgeActive() || !canSend()) {
@@ -201,6 +388,11 @@ bool MessageChannelServer::init(HWND clientWindow,
 
   m_clientWindow = clientWindow;
   m_windowHandler = std::move(windowHandler);
+  // NV-DXVK start: message transports
+  if (m_windowTransport) {
+    m_windowTransport->setWindow(clientWindow);
+  }
+  // NV-DXVK end
   // If we're creating a new thread, we need to release the old one first, just in case it hasnt cleaned itself up yet.
   if (m_worker.joinable()) {
     m_worker.detach();
@@ -218,8 +410,22 @@ bool MessageChannelServer::init(HWND clientWindow,
   return true;
 }
 
+// NV-DXVK start: message transports
+void MessageChannelServer::setTransport(std::unique_ptr<dxvk::MessageTransport> transport) {
+  m_transport = std::move(transport);
+  m_windowTransport = nullptr;
+}
+
+void MessageChannelServer::setReceiver(std::unique_ptr<dxvk::SharedMemoryTransport> receiver) {
+  m_receiver = std::move(receiver);
+}
+// NV-DXVK end
+
 bool MessageChannelServer::handshake() {
-  if (canSend()) {
+  // NV-DXVK start: message transports
+  // The handshake is always sent to the client window, whatever the transport
+  if (m_clientWindow) {
+  // NV-DXVK end
     // Run the handshake loop until success, error or destruction
     while (!m_isDestroying) {
       // do handshake with a timeout
@@ -261,6 +467,13 @@ void MessageChannelServer::workerJob() {
 
   env::setThreadName("dxvk-remix-message-channel");
 
+  // NV-DXVK start: message transports
+  if (m_receiver) {
+    pumpMessagesAndReceiver();
+    return;
+  }
+  // NV-DXVK end
+
   MSG msg;
   const HWND kCurrentThreadId = (HWND) (-1);
   while (GetMessage(&msg, kCurrentThreadId, 0, 0)) {
@@ -280,6 +493,43 @@ void MessageChannelServer::workerJob() {
   }
 }
 
+// NV-DXVK start: message transports
+void MessageChannelServer::pumpMessagesAndReceiver() {
+  // GetMessage can't wait on the shared memory ring, so wait for window messages
+  // and the wake event the sender signals when it publishes to a sleeping
+  // receiver. Without the event, wait with a short timeout and poll instead.
+  MSG msg;
+  const HWND kCurrentThreadId = (HWND) (-1);
+  HANDLE wakeEvent = HANDLE(m_receiver->getWakeEvent());
+  while (true) {
+    if (receive(*m_receiver) == 0 && m_receiver->beginWait()) {
+      if (wakeEvent) {
+        ::MsgWaitForMultipleObjects(1, &wakeEvent, FALSE, INFINITE, QS_ALLINPUT);
+      } else {
+        ::MsgWaitForMultipleObjects(0, nullptr, FALSE, kReceivePollMs, QS_ALLINPUT);
+      }
+
+      m_receiver->endWait();
+    }
+
+    while (PeekMessage(&msg, kCurrentThreadId, 0, 0, PM_REMOVE)) {
+      if (msg.message == WM_QUIT || msg.message == WM_DESTROY)
+        return;
+
+      TranslateMessage(&msg);
+
+      if (onMessage(msg.message, msg.wParam, msg.lParam)) {
+        continue;
+      }
+
+      if (m_windowHandler) {
+        m_windowHandler(m_clientWindow, msg.message, msg.wParam, msg.lParam);
+      }
+    }
+  }
+}
+// NV-DXVK end
+
 bool MessageChannelServer::send(const char* msgName,
                                 uint32_t wParam, uint32_t lParam) {
   if (!IsRemixBridgeActive() || !canSend()) {
@@ -301,14 +551,38 @@ bool MessageChannelServer::send(uint32_t msg,
     return false;
   }
 
-  LRESULT result = ::PostMessage(m_clientWindow, msg, wParam, lParam);
+  const MessageParams params = { wParam, lParam };
 
-  if (result != 0) {
+  // NV-DXVK start: message transports
+  // Delivered right away like the window messages they replace
+  std::lock_guard<std::mutex> _(m_sendMutex);
+
+  if (m_transport->send(msg, &params, sizeof(params))) {
+    m_transport->flush();
     return true;
   }
+  // NV-DXVK end
 
   Logger::err(format_string("Message %d was not sent (%d)!",
                             msg, GetLastError()));
 
   return false;
 }
+
+// NV-DXVK start: message transports
+bool MessageChannelServer::send(uint32_t msg, const void* payload, uint32_t size) {
+  if (!IsRemixBridgeActive() || !canSend()) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> _(m_sendMutex);
+
+  if (m_transport->send(msg, payload, size)) {
+    return true;
+  }
+
+  Logger::err(format_string("Message %d with a %d byte payload was not sent!", msg, size));
+
+  return false;
+}
+// NV-DXVK end
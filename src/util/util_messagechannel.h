@@ -22,11 +22,16 @@
 #pragma once
 
 #include "util_version.h"
+// NV-DXVK start: message transports
+#include "util_message_transport.h"
+// NV-DXVK end
 
 #include <stdint.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <functional>
+#include <memory>
 #include <mutex>
 
 // The code is shared between Remix Bridge and Remix Renderer
@@ -46,6 +51,59 @@ namespace version {
 }
 
 namespace UTIL_NS {
+  // NV-DXVK start: message transports
+  // Win32 message backends of MessageTransport. Payloads are the two
+  // 32-bit message parameters, bulk data needs a SharedMemoryTransport.
+  struct MessageParams {
+    uint32_t wParam;
+    uint32_t lParam;
+  };
+
+  class ThreadMessageTransport : public dxvk::MessageTransport {
+  public:
+    explicit ThreadMessageTransport(uint32_t threadId = 0)
+    : m_threadId(threadId)
+    {}
+
+    void setThreadId(uint32_t threadId) {
+      m_threadId = threadId;
+    }
+
+    bool canSend() const override {
+      return m_threadId != 0;
+    }
+
+    uint32_t getMaxPayloadSize() const override {
+      return sizeof(MessageParams);
+    }
+
+    bool send(uint32_t msg, const void* payload, uint32_t size) override;
+
+  private:
+    uint32_t m_threadId;
+  };
+
+  class WindowMessageTransport : public dxvk::MessageTransport {
+  public:
+    void setWindow(HWND window) {
+      m_window = window;
+    }
+
+    bool canSend() const override {
+      return m_window != nullptr;
+    }
+
+    uint32_t getMaxPayloadSize() const override {
+      return sizeof(MessageParams);
+    }
+
+    bool send(uint32_t msg, const void* payload, uint32_t size) override;
+
+  private:
+    HWND m_window = nullptr;
+  };
+  // NV-DXVK end
+
   // Bidirectional communication channel based on Windows GetMessage/PostThreadMessage.
   // Should only be used for low-frequency messaging like input and window messages.
   // 
@@ -63,16 +121,40 @@ namespace UTIL_NS {
   //    No handshake message is necessary. Client may be only given the server thread id.
   //    Server will not be able to send messages to the client.
   //
+  // Other transports:
+  //    Either side may send through any MessageTransport instead of the Win32 ones,
+  //    e.g. a SharedMemoryTransport for bulk data. The receiving side dispatches
+  //    a SharedMemoryTransport to the same handlers with receive(); the server
+  //    does so from its worker thread for the receiver given to setReceiver().
+  //    Payloads of up to 8 bytes reach the wParam/lParam handlers, larger ones
+  //    the data handlers.
+  //
   class MessageChannelBase {
   public:
     using HandlerType = std::function<bool(uint32_t, uint32_t)>;
+    // NV-DXVK start: message transports
+    using DataHandlerType = std::function<bool(const void*, uint32_t)>;
+    // NV-DXVK end
 
     bool onMessage(uint32_t msg, uint32_t wParam, uint32_t lParam);
+    // NV-DXVK start: message transports
+    bool onMessage(uint32_t msg, const void* payload, uint32_t size);
+
+    /**
+     * \brief Dispatches the messages received over shared memory
+     * \returns Number of messages dispatched
+     */
+    uint32_t receive(dxvk::SharedMemoryTransport& transport, uint32_t maxMessages = ~0u);
+    // NV-DXVK end
 
     bool registerHandler(uint32_t msg, HandlerType&& handler);
     bool registerHandler(const char* msg, HandlerType&& handler);
     void removeHandler(uint32_t msg);
     void removeHandler(const char* msg);
+    // NV-DXVK start: message transports
+    bool registerDataHandler(uint32_t msg, DataHandlerType&& handler);
+    bool registerDataHandler(const char* msg, DataHandlerType&& handler);
+    // NV-DXVK end
 
   protected:
     MessageChannelBase() = default;
@@ -84,9 +166,31 @@ namespace UTIL_NS {
     uint32_t m_handshakeMsgId = 0;
 
     mutable std::recursive_mutex m_accessMutex;
+    // NV-DXVK start: message transports
+    // Serializes sends, transports may have a single producer
+    std::mutex m_sendMutex;
+    // NV-DXVK end
 
     std::unordered_map<std::string, uint32_t> m_msgs;
     std::unordered_map<uint32_t, HandlerType> m_handlers;
+    // NV-DXVK start: message transports
+    std::unordered_map<uint32_t, DataHandlerType> m_dataHandlers;
+
+    // Handlers of a message ID, pointing into the maps above
+    struct DispatchEntry {
+      uint32_t msg;
+      HandlerType* handler;
+      DataHandlerType* dataHandler;
+    };
+
+    // Sorted by message ID, rebuilt whenever handlers are registered or removed
+    std::vector<DispatchEntry> m_dispatchTable;
+
+    void updateDispatchTable();
+    // Both require m_accessMutex to be held
+    const DispatchEntry* findDispatchEntry(uint32_t msg) const;
+    bool dispatch(uint32_t msg, const void* payload, uint32_t size);
+    // NV-DXVK end
   };
 
   class MessageChannelServer : public MessageChannelBase {
@@ -103,11 +207,26 @@ namespace UTIL_NS {
 
     bool init(HWND window, WindowMessageHandlerType&& windowHandler);
 
+    // NV-DXVK start: message transports
+    // Both must be set before init(). The transport replaces posting
+    // to the client window, the handshake still goes through it.
+    void setTransport(std::unique_ptr<dxvk::MessageTransport> transport);
+    void setReceiver(std::unique_ptr<dxvk::SharedMemoryTransport> receiver);
+    // NV-DXVK end
+
     bool send(const char* msgName, uint32_t wParam, uint32_t lParam);
     bool send(uint32_t msg, uint32_t wParam, uint32_t lParam);
+    // NV-DXVK start: message transports
+    bool send(uint32_t msg, const void* payload, uint32_t size);
+
+    void flush() {
+      std::lock_guard<std::mutex> _(m_sendMutex);
+      m_transport->flush();
+    }
+    // NV-DXVK end
 
     bool canSend() const {
-      return m_clientWindow != nullptr;
+      return m_transport->canSend();
     }
 
     uint32_t getWorkerThreadId() const {
@@ -115,11 +234,25 @@ namespace UTIL_NS {
     }
 
   private:
+    // NV-DXVK start: message transports
+    // Poll interval of the shared memory receiver when the sender
+    // provides no wake event
+    static constexpr uint32_t kReceivePollMs = 1;
+    // NV-DXVK end
+
     bool handshake();
     void workerJob();
+    // NV-DXVK start: message transports
+    void pumpMessagesAndReceiver();
+    // NV-DXVK end
 
     HWND m_clientWindow = nullptr;
     WindowMessageHandlerType m_windowHandler;
+    // NV-DXVK start: message transports
+    std::unique_ptr<dxvk::MessageTransport> m_transport = std::make_unique<WindowMessageTransport>();
+    WindowMessageTransport* m_windowTransport = static_cast<WindowMessageTransport*>(m_transport.get());
+    std::unique_ptr<dxvk::SharedMemoryTransport> m_receiver;
+    // NV-DXVK end
 
     ThreadType m_worker;
     uint32_t m_workerThreadId = 0;
@@ -132,17 +265,33 @@ namespace UTIL_NS {
     MessageChannelClient() = delete;
     explicit MessageChannelClient(const char* handshakeMsgName);
     explicit MessageChannelClient(uint32_t serverThreadId)
-    : m_serverThreadId(serverThreadId)
+    : m_transport(std::make_unique<ThreadMessageTransport>(serverThreadId))
+    {}
+    // NV-DXVK start: message transports
+    // One-way channel over any transport, e.g. a SharedMemoryTransport sender
+    explicit MessageChannelClient(std::unique_ptr<dxvk::MessageTransport> transport)
+    : m_transport(std::move(transport))
     {}
+    // NV-DXVK end
 
     bool send(uint32_t msg, uint32_t wParam, uint32_t lParam);
     bool send(const char* msgName, uint32_t wParam, uint32_t lParam);
+    // NV-DXVK start: message transports
+    bool send(uint32_t msg, const void* payload, uint32_t size);
+
+    void flush() {
+      std::lock_guard<std::mutex> _(m_sendMutex);
+      m_transport->flush();
+    }
+    // NV-DXVK end
 
     bool canSend() const {
-      return m_serverThreadId != 0;
+      return m_transport->canSend();
     }
 
   private:
-    uint32_t m_serverThreadId = 0;
+    // NV-DXVK start: message transports
+    std::unique_ptr<dxvk::MessageTransport> m_transport;
+    // NV-DXVK end
   };
 }
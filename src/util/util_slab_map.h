@@ -0,0 +1,375 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "xxHash/xxhash.h"
+
+namespace dxvk {
+
+  // A multimap from already hashed keys to values, for use with values that must have stable addresses.
+  //
+  // Values live in fixed size slabs which are never moved or freed until the map is destroyed, so pointers
+  // to values stay valid until the value is erased. Each slot carries a generation counter that is bumped
+  // on erase, so a handle to an erased value can be detected instead of aliasing whatever reuses the slot.
+  //
+  // Keys are resolved through a compact open-addressed index (linear probing, backward shift deletion)
+  // mapping each key to the first slot of its bucket. Values sharing a key are chained through the slots
+  // in insertion order. Iteration walks the slabs linearly.
+  template<typename T, uint32_t SlabSize = 256>
+  class slab_multimap {
+    static constexpr uint32_t kInvalidIndex = UINT32_MAX;
+
+    struct Slot {
+      XXH64_hash_t key = 0;
+      // Next slot in the bucket chain while live, next free slot otherwise
+      uint32_t next = kInvalidIndex;
+      uint32_t generation = 1;
+      bool live = false;
+      alignas(T) uint8_t storage[sizeof(T)];
+
+      T* get() { return std::launder(reinterpret_cast<T*>(storage)); }
+      const T* get() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+    };
+
+    struct IndexEntry {
+      XXH64_hash_t key = 0;
+      uint32_t head = kInvalidIndex;
+    };
+
+  public:
+    struct handle {
+      uint32_t index = kInvalidIndex;
+      uint32_t generation = 0;
+
+      bool isValid() const { return index != kInvalidIndex; }
+      bool operator==(const handle& other) const { return index == other.index && generation == other.generation; }
+      bool operator!=(const handle& other) const { return !(*this == other); }
+    };
+
+    class iterator {
+    public:
+      iterator(slab_multimap* map, uint32_t index) : m_map(map), m_index(index) { skipFree(); }
+
+      T& operator*() const { return *m_map->slot(m_index).get(); }
+      T* operator->() const { return m_map->slot(m_index).get(); }
+      XXH64_hash_t key() const { return m_map->slot(m_index).key; }
+      handle getHandle() const { return handle { m_index, m_map->slot(m_index).generation }; }
+
+      iterator& operator++() {
+        ++m_index;
+        skipFree();
+        return *this;
+      }
+
+      iterator operator++(int) {
+        iterator result = *this;
+        ++(*this);
+        return result;
+      }
+
+      bool operator==(const iterator& other) const { return m_index == other.m_index; }
+      bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+
+    private:
+      friend class slab_multimap;
+
+      void skipFree() {
+        while (m_index < m_map->m_slotCount && !m_map->slot(m_index).live) {
+          ++m_index;
+        }
+      }
+
+      slab_multimap* m_map;
+      uint32_t m_index;
+    };
+
+    // Walks the values sharing a key, in insertion order
+    class bucket_iterator {
+    public:
+      bucket_iterator(slab_multimap* map, uint32_t index) : m_map(map), m_index(index) { }
+
+      T& operator*() const { return *m_map->slot(m_index).get(); }
+      T* operator->() const { return m_map->slot(m_index).get(); }
+      handle getHandle() const { return handle { m_index, m_map->slot(m_index).generation }; }
+
+      bucket_iterator& operator++() {
+        m_index = m_map->slot(m_index).next;
+        return *this;
+      }
+
+      bucket_iterator operator++(int) {
+        bucket_iterator result = *this;
+        ++(*this);
+        return result;
+      }
+
+      bool operator==(const bucket_iterator& other) const { return m_index == other.m_index; }
+      bool operator!=(const bucket_iterator& other) const { return m_index != other.m_index; }
+
+    private:
+      slab_multimap* m_map;
+      uint32_t m_index;
+    };
+
+    struct bucket_range {
+      bucket_iterator first;
+      bucket_iterator second;
+
+      bucket_iterator begin() const { return first; }
+      bucket_iterator end() const { return second; }
+      bool empty() const { return first == second; }
+    };
+
+    slab_multimap() = default;
+    slab_multimap(const slab_multimap&) = delete;
+    slab_multimap& operator=(const slab_multimap&) = delete;
+
+    ~slab_multimap() {
+      destroyAll();
+    }
+
+    // Reserves slots and index space for the given number of values
+    void reserve(uint32_t count) {
+      while (m_slabs.size() * SlabSize < count) {
+        m_slabs.emplace_back(new Slot[SlabSize]);
+      }
+      if (count * 4 > m_index.size() * 3) {
+        rehash(count);
+      }
+    }
+
+    template<typename... Args>
+    T& emplace(XXH64_hash_t key, Args&&... args) {
+      const uint32_t index = allocateSlot();
+      Slot& s = slot(index);
+      new (s.storage) T(std::forward<Args>(args)...);
+      s.key = key;
+      s.next = kInvalidIndex;
+      s.live = true;
+      ++m_size;
+
+      if ((m_indexSize + 1) * 4 > m_index.size() * 3) {
+        rehash(m_indexSize + 1);
+      }
+
+      IndexEntry& entry = findIndexEntry(key);
+      if (entry.head == kInvalidIndex) {
+        entry.key = key;
+        entry.head = index;
+        ++m_indexSize;
+      } else {
+        // Append, so that equal keys are visited in insertion order
+        uint32_t tail = entry.head;
+        while (slot(tail).next != kInvalidIndex) {
+          tail = slot(tail).next;
+        }
+        slot(tail).next = index;
+      }
+
+      return *s.get();
+    }
+
+    bucket_range equal_range(XXH64_hash_t key) {
+      if (m_index.empty()) {
+        return bucket_range { bucket_iterator(this, kInvalidIndex), bucket_iterator(this, kInvalidIndex) };
+      }
+      const IndexEntry& entry = findIndexEntry(key);
+      return bucket_range { bucket_iterator(this, entry.head), bucket_iterator(this, kInvalidIndex) };
+    }
+
+    // Returns nullptr if the handle refers to a value that has since been erased
+    T* get(handle h) {
+      if (h.index >= m_slotCount) {
+        return nullptr;
+      }
+      Slot& s = slot(h.index);
+      return s.live && s.generation == h.generation ? s.get() : nullptr;
+    }
+
+    void erase(handle h) {
+      if (get(h) != nullptr) {
+        eraseSlot(h.index);
+      }
+    }
+
+    // Erases the value at iter and returns an iterator to the next value
+    iterator erase(iterator iter) {
+      eraseSlot(iter.m_index);
+      return ++iter;
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, m_slotCount); }
+
+    // Destroys all values. Slabs are kept for reuse, and generations keep counting up so that handles
+    // taken before the clear stay invalid.
+    void clear() {
+      destroyAll();
+      m_index.assign(m_index.size(), IndexEntry {});
+      m_indexSize = 0;
+    }
+
+    uint32_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    // Bytes owned by the map, including unused slab slots and index capacity
+    size_t getMemoryFootprint() const {
+      return m_slabs.size() * SlabSize * sizeof(Slot)
+           + m_slabs.capacity() * sizeof(std::unique_ptr<Slot[]>)
+           + m_index.capacity() * sizeof(IndexEntry);
+    }
+
+  private:
+    Slot& slot(uint32_t index) { return m_slabs[index / SlabSize][index % SlabSize]; }
+    const Slot& slot(uint32_t index) const { return m_slabs[index / SlabSize][index % SlabSize]; }
+
+    static size_t homeBucket(XXH64_hash_t key, size_t mask) {
+      // Keys are already hashed, just fold the upper bits in
+      return static_cast<size_t>(key ^ (key >> 32)) & mask;
+    }
+
+    // Returns the entry holding key, or the empty entry where it would be inserted
+    IndexEntry& findIndexEntry(XXH64_hash_t key) {
+      const size_t mask = m_index.size() - 1;
+      size_t bucket = homeBucket(key, mask);
+      while (m_index[bucket].head != kInvalidIndex && m_index[bucket].key != key) {
+        bucket = (bucket + 1) & mask;
+      }
+      return m_index[bucket];
+    }
+
+    void rehash(uint32_t minEntries) {
+      size_t capacity = m_index.empty() ? 64 : m_index.size();
+      while (minEntries * 4 > capacity * 3) {
+        capacity *= 2;
+      }
+
+      std::vector<IndexEntry> oldIndex(capacity);
+      std::swap(oldIndex, m_index);
+
+      const size_t mask = m_index.size() - 1;
+      for (const IndexEntry& entry : oldIndex) {
+        if (entry.head == kInvalidIndex) {
+          continue;
+        }
+        size_t bucket = homeBucket(entry.key, mask);
+        while (m_index[bucket].head != kInvalidIndex) {
+          bucket = (bucket + 1) & mask;
+        }
+        m_index[bucket] = entry;
+      }
+    }
+
+    void removeIndexEntry(IndexEntry& entry) {
+      // Backward shift deletion keeps probe sequences intact without tombstones
+      const size_t mask = m_index.size() - 1;
+      size_t hole = &entry - m_index.data();
+      size_t bucket = (hole + 1) & mask;
+      while (m_index[bucket].head != kInvalidIndex) {
+        const size_t home = homeBucket(m_index[bucket].key, mask);
+        // Move the entry into the hole unless its home lies cyclically within (hole, bucket]
+        const bool homeBetween = hole <= bucket ? (hole < home && home <= bucket) : (hole < home || home <= bucket);
+        if (!homeBetween) {
+          m_index[hole] = m_index[bucket];
+          hole = bucket;
+        }
+        bucket = (bucket + 1) & mask;
+      }
+      m_index[hole] = IndexEntry {};
+      --m_indexSize;
+    }
+
+    uint32_t allocateSlot() {
+      if (m_freeHead != kInvalidIndex) {
+        const uint32_t index = m_freeHead;
+        m_freeHead = slot(index).next;
+        return index;
+      }
+      if (m_slotCount == m_slabs.size() * SlabSize) {
+        m_slabs.emplace_back(new Slot[SlabSize]);
+      }
+      return m_slotCount++;
+    }
+
+    void eraseSlot(uint32_t index) {
+      Slot& s = slot(index);
+      assert(s.live);
+
+      IndexEntry& entry = findIndexEntry(s.key);
+      assert(entry.head != kInvalidIndex);
+      if (entry.head == index) {
+        if (s.next == kInvalidIndex) {
+          removeIndexEntry(entry);
+        } else {
+          entry.head = s.next;
+        }
+      } else {
+        uint32_t prev = entry.head;
+        while (slot(prev).next != index) {
+          prev = slot(prev).next;
+        }
+        slot(prev).next = s.next;
+      }
+
+      releaseSlot(index);
+    }
+
+    void releaseSlot(uint32_t index) {
+      Slot& s = slot(index);
+      s.get()->~T();
+      s.live = false;
+      ++s.generation;
+      s.next = m_freeHead;
+      m_freeHead = index;
+      --m_size;
+    }
+
+    void destroyAll() {
+      m_freeHead = kInvalidIndex;
+      for (uint32_t i = m_slotCount; i > 0; --i) {
+        Slot& s = slot(i - 1);
+        if (s.live) {
+          releaseSlot(i - 1);
+        } else {
+          // Rebuild the free list so that low slots are reused first
+          s.next = m_freeHead;
+          m_freeHead = i - 1;
+        }
+      }
+    }
+
+    std::vector<std::unique_ptr<Slot[]>> m_slabs;
+    std::vector<IndexEntry> m_index;
+    uint32_t m_slotCount = 0;
+    uint32_t m_freeHead = kInvalidIndex;
+    uint32_t m_size = 0;
+    uint32_t m_indexSize = 0;
+  };
+
+}
@@ -0,0 +1,199 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_bindless_slot_tracker.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_bindless_slot_tracker.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testUnchangedTable();
+      testChangedSlots();
+      testReusedHandles();
+      testFramesInFlight();
+      testResize();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    using Slot = BindlessSlotTracker::Slot;
+    using Range = BindlessSlotTracker::Range;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Bindless slot tracker test failed: ", message));
+      }
+    }
+
+    static bool equal(const std::vector<Range>& ranges, const std::vector<std::pair<uint32_t, uint32_t>>& expected) {
+      if (ranges.size() != expected.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < ranges.size(); i++) {
+        if (ranges[i].begin != expected[i].first || ranges[i].end != expected[i].second) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    // Stands in for a texture: the view cookie and the view handle
+    static Slot texture(uint64_t cookie, uint64_t handle) {
+      return Slot { cookie, handle, 0, 0 };
+    }
+
+    static void writeTable(BindlessSlotTracker& tracker, const std::vector<Slot>& table) {
+      tracker.beginFrame(static_cast<uint32_t>(table.size()));
+      for (uint32_t i = 0; i < table.size(); i++) {
+        tracker.update(i, table[i]);
+      }
+    }
+
+    static std::vector<Slot> createTable(uint32_t size) {
+      std::vector<Slot> table;
+      for (uint32_t i = 0; i < size; i++) {
+        table.push_back(texture(i + 1, 0x1000 + i));
+      }
+      return table;
+    }
+
+    void testUnchangedTable() {
+      const std::vector<Slot> table = createTable(1000);
+
+      BindlessSlotTracker tracker;
+      writeTable(tracker, table);
+      check(equal(tracker.getWriteRanges(), { { 0, 1000 } }), "first frame writes everything");
+      check(BindlessSlotTracker::getSlotCount(tracker.getWriteRanges()) == 1000, "first frame slot count");
+
+      writeTable(tracker, table);
+      check(tracker.getWriteRanges().empty(), "unchanged table writes descriptors");
+      check(BindlessSlotTracker::getSlotCount(tracker.getWriteRanges()) == 0, "unchanged table slot count");
+
+      // A newly allocated set has to be written in full
+      tracker.invalidate();
+      writeTable(tracker, table);
+      check(equal(tracker.getWriteRanges(), { { 0, 1000 } }), "invalidate");
+    }
+
+    void testChangedSlots() {
+      std::vector<Slot> table = createTable(100);
+
+      BindlessSlotTracker tracker;
+      writeTable(tracker, table);
+
+      // Nearby changes share a write, distant ones don't
+      const uint32_t gap = BindlessSlotTracker::kMaxCoalesceGap;
+      table[10] = texture(1000, 0x9000);
+      table[10 + gap + 1] = texture(1001, 0x9001);
+      table[60] = texture(1002, 0x9002);
+      table[99].offset = 1;
+
+      writeTable(tracker, table);
+      check(tracker.getDirtyCount() == 4, "dirty count");
+      check(equal(tracker.getWriteRanges(), { { 10, 10 + gap + 2 }, { 60, 61 }, { 99, 100 } }), "changed slot ranges");
+
+      writeTable(tracker, table);
+      check(tracker.getWriteRanges().empty(), "changes written twice");
+    }
+
+    void testReusedHandles() {
+      std::vector<Slot> table = createTable(16);
+
+      BindlessSlotTracker tracker;
+      writeTable(tracker, table);
+
+      // A new view that was given the handle of a destroyed one still needs its descriptor written
+      table[5].cookie = 5000;
+
+      writeTable(tracker, table);
+      check(equal(tracker.getWriteRanges(), { { 5, 6 } }), "reused handle");
+    }
+
+    void testFramesInFlight() {
+      // Every frame writes the next copy of the table, a change has to reach all of them
+      constexpr uint32_t kNumCopies = 2;
+      BindlessSlotTracker copies[kNumCopies];
+
+      std::vector<Slot> table = createTable(64);
+
+      uint32_t frame = 0;
+      auto writeNextCopy = [&]() {
+        BindlessSlotTracker& tracker = copies[frame++ % kNumCopies];
+        writeTable(tracker, table);
+        return tracker.getWriteRanges();
+      };
+
+      for (uint32_t i = 0; i < kNumCopies; i++) {
+        check(equal(writeNextCopy(), { { 0, 64 } }), "first write of each copy");
+      }
+
+      table[7] = texture(2000, 0x7000);
+      check(equal(writeNextCopy(), { { 7, 8 } }), "change in first copy");
+      check(equal(writeNextCopy(), { { 7, 8 } }), "change missed by second copy");
+      check(writeNextCopy().empty(), "change written again to first copy");
+      check(writeNextCopy().empty(), "change written again to second copy");
+
+      // Changed back and forth while a copy wasn't written: the copy still holds the original
+      table[3] = texture(2001, 0x7001);
+      check(equal(writeNextCopy(), { { 3, 4 } }), "transient change");
+      table[3] = createTable(64)[3];
+      check(writeNextCopy().empty(), "revert dirtied a copy that never saw the change");
+      check(equal(writeNextCopy(), { { 3, 4 } }), "revert not written to the changed copy");
+    }
+
+    void testResize() {
+      std::vector<Slot> table = createTable(32);
+
+      BindlessSlotTracker tracker;
+      writeTable(tracker, table);
+
+      // Slots that come back after a shrink may have been skipped, so they are written again
+      table.resize(8);
+      writeTable(tracker, table);
+      check(tracker.getWriteRanges().empty(), "shrink wrote descriptors");
+
+      table = createTable(32);
+      writeTable(tracker, table);
+      check(equal(tracker.getWriteRanges(), { { 8, 32 } }), "grow");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
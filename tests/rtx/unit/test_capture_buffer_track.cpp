@@ -0,0 +1,323 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <map>
+#include <random>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_game_capturer_utils.h"
+#include "../../../src/lssusd/usd_include_begin.h"
+#include <pxr/base/gf/vec2f.h>
+#include <pxr/base/gf/vec4f.h>
+#include "../../../src/lssusd/usd_include_end.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_capture_buffer_track.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testDistanceKernel();
+      testAnimatedCapture(false);
+      testAnimatedCapture(true);
+      testDedup();
+      testOutOfOrderSamples();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    template<typename T>
+    using BufSet = std::map<float, pxr::VtArray<T>>;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Capture buffer track test failed: ", message));
+      }
+    }
+
+    // The per element comparisons GameCapturer used before the vectorized kernel
+    static bool differentEnough(const pxr::GfVec2f& a, const pxr::GfVec2f& b, float delta) { return (a - b).GetLengthSq() > delta * delta; }
+    static bool differentEnough(const pxr::GfVec3f& a, const pxr::GfVec3f& b, float delta) { return (a - b).GetLengthSq() > delta * delta; }
+    static bool differentEnough(const pxr::GfVec4f& a, const pxr::GfVec4f& b, float delta) { return (a - b).GetLengthSq() > delta * delta; }
+    static bool differentEnough(const float& a, const float& b, float delta) { return std::abs(a - b) > delta; }
+    static bool differentEnough(const int& a, const int& b, float) { return a != b; }
+
+    // Reference capture: every sufficiently different buffer is stored in full
+    template<typename T>
+    static void referencePush(BufSet<T>& bufSet, float timeCode, const pxr::VtArray<T>& newBuffer, float delta) {
+      bool bDifferent = bufSet.empty();
+      if (!bDifferent) {
+        const pxr::VtArray<T>& prevBuf = (--bufSet.cend())->second;
+        for (size_t idx = 0; idx < newBuffer.size() && !bDifferent; ++idx) {
+          bDifferent = differentEnough(newBuffer[idx], prevBuf[idx], delta);
+        }
+      }
+      if (bDifferent) {
+        bufSet[timeCode] = newBuffer;
+      }
+    }
+
+    template<typename T>
+    static bool identical(const BufSet<T>& a, const BufSet<T>& b) {
+      if (a.size() != b.size()) {
+        return false;
+      }
+      for (auto itA = a.begin(), itB = b.begin(); itA != a.end(); ++itA, ++itB) {
+        if (itA->first != itB->first || itA->second.size() != itB->second.size() ||
+            std::memcmp(itA->second.cdata(), itB->second.cdata(), itA->second.size() * sizeof(T)) != 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void testDistanceKernel() {
+      std::mt19937 rng(11);
+      std::uniform_real_distribution<float> value(-10.f, 10.f);
+      std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+      for (uint32_t iter = 0; iter < 20000; iter++) {
+        const uint32_t numComponents = 1 + rng() % 4;
+        const size_t count = rng() % 70;
+        const float threshold = 0.05f * (rng() % 4);
+        std::vector<float> a(count * numComponents);
+        std::vector<float> b(count * numComponents);
+        for (size_t i = 0; i < a.size(); i++) {
+          a[i] = value(rng);
+          b[i] = a[i] + (rng() % 16 == 0 ? jitter(rng) : 0.f);
+        }
+
+        bool expected = false;
+        for (size_t i = 0; i < count && !expected; i++) {
+          const float* pA = &a[i * numComponents];
+          const float* pB = &b[i * numComponents];
+          switch (numComponents) {
+          case 1: expected = differentEnough(pA[0], pB[0], threshold); break;
+          case 2: expected = differentEnough(pxr::GfVec2f(pA), pxr::GfVec2f(pB), threshold); break;
+          case 3: expected = differentEnough(pxr::GfVec3f(pA), pxr::GfVec3f(pB), threshold); break;
+          case 4: expected = differentEnough(pxr::GfVec4f(pA), pxr::GfVec4f(pB), threshold); break;
+          }
+        }
+        check(fast::anyDistanceExceeds(a.data(), b.data(), count, numComponents, threshold) == expected,
+              "kernel disagrees with the per element comparison");
+      }
+    }
+
+    template<typename T>
+    static pxr::VtArray<T> animate(const pxr::VtArray<T>& buffer, std::mt19937& rng, uint32_t numChanged, float amount) {
+      pxr::VtArray<T> result = buffer;
+      T* pData = result.data();
+      for (uint32_t i = 0; i < numChanged; i++) {
+        float* pElem = reinterpret_cast<float*>(&pData[rng() % result.size()]);
+        pElem[rng() % (sizeof(T) / sizeof(float))] += amount;
+      }
+      return result;
+    }
+
+    template<typename T>
+    static pxr::VtArray<T> randomBuffer(std::mt19937& rng, size_t size) {
+      std::uniform_real_distribution<float> value(-1.f, 1.f);
+      pxr::VtArray<T> buffer(size);
+      float* pData = reinterpret_cast<float*>(buffer.data());
+      for (size_t i = 0; i < size * sizeof(T) / sizeof(float); i++) {
+        pData[i] = value(rng);
+      }
+      return buffer;
+    }
+
+    // Replays a capture of skinned meshes through the reference and the tracks, and compares the exported time samples
+    void testAnimatedCapture(bool bSparseDeltas) {
+      const size_t numMeshes = 6;
+      const size_t numVertices = 2000;
+      const uint32_t numFrames = 120;
+      const float posDelta = 0.3f;
+      const float texcoordDelta = 0.3f;
+      const float weightDelta = 0.01f;
+
+      CaptureBufferDedup<pxr::GfVec3f> dedupVec3;
+      CaptureBufferDedup<pxr::GfVec2f> dedupVec2;
+      CaptureBufferDedup<float> dedupScalar;
+      CaptureBufferDedup<int> dedupInt;
+
+      struct MeshState {
+        pxr::VtArray<pxr::GfVec3f> positions;
+        pxr::VtArray<pxr::GfVec2f> texcoords;
+        pxr::VtArray<float> weights;
+        pxr::VtArray<int> indices;
+        BufSet<pxr::GfVec3f> refPositions;
+        BufSet<pxr::GfVec2f> refTexcoords;
+        BufSet<float> refWeights;
+        BufSet<int> refIndices;
+        CaptureBufferTrack<pxr::GfVec3f> positionTrack;
+        CaptureBufferTrack<pxr::GfVec2f> texcoordTrack;
+        CaptureBufferTrack<float> weightTrack;
+        CaptureBufferTrack<int> indexTrack;
+      };
+      std::vector<MeshState> meshes(numMeshes);
+
+      std::mt19937 rng(1234);
+      for (MeshState& mesh : meshes) {
+        mesh.positions = randomBuffer<pxr::GfVec3f>(rng, numVertices);
+        mesh.texcoords = randomBuffer<pxr::GfVec2f>(rng, numVertices);
+        mesh.weights = randomBuffer<float>(rng, numVertices * 2);
+        mesh.indices = pxr::VtArray<int>(numVertices * 3);
+        for (size_t i = 0; i < mesh.indices.size(); i++) {
+          mesh.indices[i] = static_cast<int>(rng() % numVertices);
+        }
+        mesh.positionTrack.init(posDelta, bSparseDeltas, &dedupVec3);
+        mesh.texcoordTrack.init(texcoordDelta, bSparseDeltas, &dedupVec2);
+        mesh.weightTrack.init(weightDelta, bSparseDeltas, &dedupScalar);
+        mesh.indexTrack.init(0.f, bSparseDeltas, &dedupInt);
+      }
+      // Two instances of the same skinned mesh play the same animation
+      meshes[1].positions = meshes[0].positions;
+
+      for (uint32_t frame = 0; frame < numFrames; frame++) {
+        const float timeCode = static_cast<float>(frame);
+        for (size_t m = 0; m < numMeshes; m++) {
+          MeshState& mesh = meshes[m];
+          if (m == 1) {
+            mesh.positions = meshes[0].positions;
+          } else if (frame % 10 == 9) {
+            // Whole mesh moves
+            mesh.positions = animate(mesh.positions, rng, numVertices * 4, 0.5f);
+          } else {
+            // A few vertices move, some below the threshold
+            mesh.positions = animate(mesh.positions, rng, 20, (frame % 3 == 0) ? 0.1f : 0.4f);
+          }
+          mesh.texcoords = animate(mesh.texcoords, rng, frame % 4 == 0 ? 8 : 0, 0.5f);
+          mesh.weights = animate(mesh.weights, rng, 10, frame % 2 == 0 ? 0.005f : 0.02f);
+          if (frame % 30 == 29) {
+            mesh.indices[rng() % mesh.indices.size()] += 1;
+          }
+
+          referencePush(mesh.refPositions, timeCode, mesh.positions, posDelta);
+          referencePush(mesh.refTexcoords, timeCode, mesh.texcoords, texcoordDelta);
+          referencePush(mesh.refWeights, timeCode, mesh.weights, weightDelta);
+          referencePush(mesh.refIndices, timeCode, mesh.indices, 0.f);
+
+          // GameCapturer hands over the freshly read back buffer
+          mesh.positionTrack.push(timeCode, pxr::VtArray<pxr::GfVec3f>(mesh.positions));
+          mesh.texcoordTrack.push(timeCode, pxr::VtArray<pxr::GfVec2f>(mesh.texcoords));
+          mesh.weightTrack.push(timeCode, pxr::VtArray<float>(mesh.weights));
+          mesh.indexTrack.push(timeCode, pxr::VtArray<int>(mesh.indices));
+        }
+      }
+
+      std::vector<BufSet<pxr::GfVec3f>> resolvedPositions(numMeshes);
+      std::vector<BufSet<pxr::GfVec2f>> resolvedTexcoords(numMeshes);
+      std::vector<BufSet<float>> resolvedWeights(numMeshes);
+      std::vector<BufSet<int>> resolvedIndices(numMeshes);
+      {
+        std::cout << "Resolve " << (bSparseDeltas ? "sparse" : "full") << " samples: ";
+        Timer timer;
+        for (size_t m = 0; m < numMeshes; m++) {
+          meshes[m].positionTrack.resolve(resolvedPositions[m]);
+          meshes[m].texcoordTrack.resolve(resolvedTexcoords[m]);
+          meshes[m].weightTrack.resolve(resolvedWeights[m]);
+          meshes[m].indexTrack.resolve(resolvedIndices[m]);
+        }
+      }
+
+      size_t numSamples = 0;
+      size_t numDeltas = 0;
+      for (size_t m = 0; m < numMeshes; m++) {
+        const MeshState& mesh = meshes[m];
+        const BufSet<pxr::GfVec3f>& positions = resolvedPositions[m];
+        const BufSet<pxr::GfVec2f>& texcoords = resolvedTexcoords[m];
+        const BufSet<float>& weights = resolvedWeights[m];
+        const BufSet<int>& indices = resolvedIndices[m];
+        check(identical(positions, mesh.refPositions), "position time samples changed");
+        check(identical(texcoords, mesh.refTexcoords), "texcoord time samples changed");
+        check(identical(weights, mesh.refWeights), "blend weight time samples changed");
+        check(identical(indices, mesh.refIndices), "index time samples changed");
+        numSamples += positions.size() + texcoords.size() + weights.size() + indices.size();
+        numDeltas += mesh.positionTrack.getNumDeltas() + mesh.texcoordTrack.getNumDeltas() +
+                     mesh.weightTrack.getNumDeltas() + mesh.indexTrack.getNumDeltas();
+      }
+      check(bSparseDeltas == (numDeltas > 0), "sparse deltas not used");
+      check(dedupVec3.getNumShared() > 0, "instanced animation not shared");
+      std::cout << numSamples << " time samples, " << numDeltas << " stored as deltas, "
+                << dedupVec3.getNumShared() << " positions shared" << std::endl;
+    }
+
+    void testDedup() {
+      CaptureBufferDedup<pxr::GfVec3f> dedup;
+      std::mt19937 rng(5);
+      const pxr::VtArray<pxr::GfVec3f> buffer = randomBuffer<pxr::GfVec3f>(rng, 64);
+
+      pxr::VtArray<pxr::GfVec3f> a = pxr::VtArray<pxr::GfVec3f>(buffer.begin(), buffer.end());
+      pxr::VtArray<pxr::GfVec3f> b = pxr::VtArray<pxr::GfVec3f>(buffer.begin(), buffer.end());
+      check(!dedup.share(a), "first buffer shared");
+      check(dedup.share(b) && b.cdata() == a.cdata(), "identical buffers do not share storage");
+
+      pxr::VtArray<pxr::GfVec3f> c = animate(buffer, rng, 1, 1.f);
+      check(!dedup.share(c) && c.cdata() != a.cdata(), "different buffers shared");
+
+      // Same contents but a different length
+      pxr::VtArray<pxr::GfVec3f> d = pxr::VtArray<pxr::GfVec3f>(buffer.begin(), buffer.begin() + 32);
+      check(!dedup.share(d), "prefix shared");
+    }
+
+    void testOutOfOrderSamples() {
+      std::mt19937 rng(9);
+      pxr::VtArray<float> buffer = randomBuffer<float>(rng, 256);
+
+      BufSet<float> reference;
+      CaptureBufferTrack<float> track;
+      track.init(0.01f, true, nullptr);
+
+      auto push = [&](float timeCode, const pxr::VtArray<float>& newBuffer) {
+        referencePush(reference, timeCode, newBuffer, 0.01f);
+        track.push(timeCode, pxr::VtArray<float>(newBuffer));
+      };
+
+      push(0.f, buffer);
+      const pxr::VtArray<float> frame1 = animate(buffer, rng, 4, 1.f);
+      push(1.f, frame1);
+      push(2.f, animate(frame1, rng, 4, 1.f));
+      check(track.getNumDeltas() == 2, "sparse samples not stored as deltas");
+
+      // A late read back for frame 1 replaces the base of the frame 2 delta
+      push(1.f, animate(buffer, rng, 100, 1.f));
+
+      BufSet<float> resolved;
+      track.resolve(resolved);
+      check(identical(resolved, reference), "replacing a delta base changed later samples");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
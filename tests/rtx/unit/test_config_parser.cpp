@@ -0,0 +1,259 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "../../test_utils.h"
+#include "../../../src/util/config/config.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_config_parser.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    TestApp() {
+      m_directory = std::filesystem::temp_directory_path() / "test_config_parser";
+      std::filesystem::create_directories(m_directory);
+    }
+
+    ~TestApp() {
+      std::error_code ec;
+      std::filesystem::remove_all(m_directory, ec);
+    }
+
+    void run() {
+      testTokenizer();
+      testTypedValues();
+      testParsedValueCache();
+      testAppDefaults();
+      benchmark();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    std::filesystem::path m_directory;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Config parser test failed: ", message));
+      }
+    }
+
+    Config parse(const std::string& contents) {
+      {
+        std::ofstream stream(m_directory / "dxvk.conf", std::ios::binary | std::ios::trunc);
+        stream << contents;
+      }
+
+      return Config::getConfig<Config::Type_User>(m_directory.string());
+    }
+
+    void testTokenizer() {
+      const Config config = parse(
+        "# A comment = not an option\n"
+        "  rtx.a = 1\n"
+        "rtx.b=\"quoted value\"\r\n"
+        "\trtx.c  =  with spaces , and commas\n"
+        "rtx.d = \"partly\" quoted\n"
+        "not a key = ignored\n"
+        "rtx.e\n"
+        "\n"
+        "[some_other_app.exe]\n"
+        "rtx.f = hidden\n"
+        "[" + env::getExeName() + "]\n"
+        "rtx.g = visible\n"
+        "rtx.last = no newline at the end");
+
+      check(config.getOption<std::string>("rtx.a") == "1", "plain value");
+      check(config.getOption<std::string>("rtx.b") == "quoted value", "quoted value with CRLF");
+      check(config.getOption<std::string>("rtx.c") == "with spaces , and commas", "whitespace around value");
+      check(config.getOption<std::string>("rtx.d") == "partly quoted", "partly quoted value");
+      check(config.getOption<std::string>("not", "fallback") == "fallback", "invalid key parsed");
+      check(config.getOption<std::string>("rtx.e", "fallback") == "fallback", "key without value parsed");
+      check(config.getOption<std::string>("rtx.f", "fallback") == "fallback", "option of other app parsed");
+      check(config.getOption<std::string>("rtx.g") == "visible", "option of this app not parsed");
+      check(config.getOption<std::string>("rtx.last") == "no newline at the end", "last line");
+    }
+
+    void testTypedValues() {
+      const Config config = parse(
+        "b = True\n"
+        "i = -42\n"
+        "u = 7\n"
+        "f = 2.5\n"
+        "t = auto\n"
+        "v2i = 3, 4\n"
+        "v3 = 1.0, 2.0, 3.0\n"
+        "v4 = 1, 2, 3\n"
+        "hashes = 0x1A2B, 0XFFFFFFFFFFFFFFFF,deadbeef, ,not_a_hash,\n"
+        "ints = 1, -2, +3, x\n"
+        "strings = a, b,,c,\n");
+
+      check(config.getOption<bool>("b", false), "bool");
+      check(config.getOption<int32_t>("i") == -42, "int");
+      check(config.getOption<uint32_t>("u") == 7, "uint");
+      check(config.getOption<float>("f") == 2.5f, "float");
+      check(config.getOption<Tristate>("t", Tristate::True) == Tristate::Auto, "tristate");
+
+      const Vector2i v2i = config.getOption<Vector2i>("v2i");
+      check(v2i.x == 3 && v2i.y == 4, "int2");
+
+      const Vector3 v3 = config.getOption<Vector3>("v3");
+      check(v3.x == 1.0f && v3.y == 2.0f && v3.z == 3.0f, "float3");
+
+      // Too few elements keeps the fallback
+      const Vector4 v4 = config.getOption<Vector4>("v4", Vector4(9.0f));
+      check(v4.w == 9.0f, "float4 with three elements");
+
+      const std::vector<uint64_t> hashes = config.getOption<std::vector<uint64_t>>("hashes");
+      check(hashes == std::vector<uint64_t> { 0x1A2B, UINT64_MAX, 0xdeadbeef }, "hash list");
+
+      const std::vector<int32_t> ints = config.getOption<std::vector<int32_t>>("ints");
+      check(ints == std::vector<int32_t> { 1, -2, 3 }, "int list");
+
+      // String lists keep the entries as written
+      const std::vector<std::string> strings = config.getOption<std::vector<std::string>>("strings");
+      check(strings == std::vector<std::string> { "a", " b", "", "c" }, "string list");
+
+      check(config.getOption<int32_t>("missing", 5) == 5, "fallback of missing option");
+      check(config.getOption<int32_t>("strings", 5) == 5, "fallback of invalid option");
+    }
+
+    void testParsedValueCache() {
+      Config config;
+      config.setOption("v", std::string("1, 2"));
+      check(config.getOption<Vector2>("v").y == 2.0f, "first lookup");
+      check(config.getOption<Vector2>("v").y == 2.0f, "cached lookup");
+
+      // The same key can be read as a different type
+      check(config.getOption<std::vector<int32_t>>("v") == std::vector<int32_t> { 1, 2 }, "lookup as another type");
+
+      config.setOption("v", Vector2(3.0f, 4.0f));
+      check(config.getOption<Vector2>("v").y == 4.0f, "set option did not invalidate the cache");
+
+      const Config copy = config;
+      config.setOption("v", std::string("5, 6"));
+      check(copy.getOption<Vector2>("v").y == 4.0f && config.getOption<Vector2>("v").y == 6.0f, "copies share values");
+
+      Config merged;
+      merged.merge(config);
+      check(merged.getOption<Vector2>("v").y == 6.0f, "merged value");
+
+      // Merging over a key that was read before replaces the cached value
+      Config overrides;
+      overrides.setOption("v", std::string("7, 8"));
+      check(config.getOption<Vector2>("v").y == 6.0f, "value before the merge");
+      config.merge(overrides);
+      check(config.getOption<Vector2>("v").y == 8.0f, "merge did not invalidate the cache");
+
+      // Failed parses return the fallback every time
+      config.setOption("v", std::string("invalid"));
+      check(config.getOption<float>("v", 1.0f) == 1.0f && config.getOption<float>("v", 2.0f) == 2.0f, "fallback cached");
+    }
+
+    void testAppDefaults() {
+      // Literal patterns, matched case insensitively
+      check(Config::getAppConfig("C:\\Games\\ACS.exe").getOption<std::string>("dxgi.customVendorId") == "10de", "literal pattern");
+      check(Config::getAppConfig("C:\\Games\\acs.EXE").getOption<std::string>("dxgi.customVendorId") == "10de", "case insensitive literal pattern");
+      check(Config::getAppConfig("C:\\Games\\ACS.exe.bak").getOption<std::string>("dxgi.customVendorId").empty(), "literal pattern not anchored");
+      check(Config::getAppConfig("C:\\Games\\XACS.exe").getOption<std::string>("dxgi.customVendorId").empty(), "literal pattern matched a longer name");
+
+      // Patterns that need a regex
+      check(Config::getAppConfig("C:\\Games\\EvilWithinDemo.exe").getOption<std::string>("d3d11.dcSingleUseMode") == "False", "regex pattern");
+      check(Config::getAppConfig("C:\\Games\\evilwithin.exe").getOption<std::string>("d3d11.dcSingleUseMode") == "False", "case insensitive regex pattern");
+
+      check(Config::getAppConfig("C:\\Games\\unknown.exe").getOption<std::string>("dxgi.customVendorId").empty(), "unknown app");
+    }
+
+    void benchmark() {
+      // A large mod config: mostly scalar options and a few texture hash lists
+      std::mt19937_64 rng(3);
+      std::string contents;
+      std::vector<std::string> keys;
+
+      for (uint32_t i = 0; i < 10000; i++) {
+        std::string key = str::format("rtx.option", i);
+
+        if (i % 1000 == 0) {
+          std::string value;
+          for (uint32_t h = 0; h < 2000; h++) {
+            value += str::format(h ? ", " : "", "0x", std::hex, rng());
+          }
+          contents += str::format(key, " = ", value, "\n");
+        } else {
+          contents += str::format(key, " = ", float(i) * 0.5f, "\n");
+        }
+
+        keys.push_back(std::move(key));
+      }
+
+      using Clock = std::chrono::high_resolution_clock;
+
+      const auto t0 = Clock::now();
+      const Config config = parse(contents);
+      const auto t1 = Clock::now();
+
+      size_t numHashes = 0;
+      auto readAll = [&] () {
+        for (uint32_t i = 0; i < keys.size(); i++) {
+          if (i % 1000 == 0) {
+            numHashes += config.getOption<std::vector<uint64_t>>(keys[i].c_str()).size();
+          } else {
+            check(config.getOption<float>(keys[i].c_str()) == float(i) * 0.5f, "benchmark value");
+          }
+        }
+      };
+
+      readAll();
+      const auto t2 = Clock::now();
+      readAll();
+      const auto t3 = Clock::now();
+
+      check(numHashes == 2 * 10 * 2000, "benchmark hash lists");
+
+      auto ms = [] (Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+      };
+
+      std::cout << "10000 line config: parse " << ms(t0, t1) << " ms, first lookup " << ms(t1, t2)
+                << " ms, cached lookup " << ms(t2, t3) << " ms" << std::endl;
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,314 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_bound_shaders.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_d3d9_bound_shaders.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testSnapshot();
+      testFrameGenerations();
+      testDescriptorEdits();
+      testReplay();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Bound shaders test failed: ", message));
+      }
+    }
+
+    static ShaderDesc createDesc(std::initializer_list<uint32_t> constantVs, std::initializer_list<uint32_t> constantPs) {
+      ShaderDesc desc;
+      desc.constantVs = constantVs;
+      desc.constantPs = constantPs;
+      desc.updateConstantMasks();
+      return desc;
+    }
+
+    void testSnapshot() {
+      ShaderDesc vs = createDesc({ 2, 170, 186, 255, 300 }, { 171 });
+      ShaderDesc ps = createDesc({ 1 }, { 170 });
+      ps.flags = ShaderFlags::UI_Hook;
+
+      BoundShaders bound;
+      check(bound.isActivated() && !bound.hasFlag(ShaderFlags::UI_Hook), "nothing bound");
+
+      bound.bind(ShaderType::Vertex, 1, &vs);
+      bound.bind(ShaderType::Pixel, 2, &ps);
+
+      check(bound.hasConstant(170, ShaderType::Vertex) && bound.hasConstant(186, ShaderType::Vertex), "vertex constants");
+      check(bound.hasConstant(255, ShaderType::Vertex), "last register");
+      check(!bound.hasConstant(300, ShaderType::Vertex) && !bound.hasConstant(~0u, ShaderType::Vertex), "out of range register");
+      check(!bound.hasConstant(171, ShaderType::Vertex), "pixel constant of the vertex shader");
+      check(bound.hasConstant(170, ShaderType::Pixel) && !bound.hasConstant(1, ShaderType::Pixel), "pixel constants");
+      check(bound.hasFlag(ShaderFlags::UI_Hook), "flag of the pixel shader");
+      check(bound.get(ShaderType::Vertex).hash == 1 && bound.get(ShaderType::Pixel).hash == 2, "hashes");
+
+      // Shaders without a descriptor behave like shaders without any constants or flags
+      bound.bind(ShaderType::Pixel, 0, nullptr);
+      check(!bound.hasFlag(ShaderFlags::UI_Hook) && !bound.hasConstant(170, ShaderType::Pixel), "unknown shader");
+
+      check(!bound.isWorldBinded(), "world matrix");
+      bound.setWorldBinded(ShaderType::Vertex);
+      check(bound.isWorldBinded() && vs.bindedWorldMatrix, "world matrix not recorded");
+    }
+
+    void testFrameGenerations() {
+      ShaderDesc a = createDesc({ }, { });
+      ShaderDesc b = createDesc({ }, { });
+
+      BoundShaders bound;
+      check(!bound.wasBoundThisFrame(a), "never bound");
+
+      bound.bind(ShaderType::Vertex, 1, &a);
+      bound.bind(ShaderType::Vertex, 2, &b);
+      check(bound.wasBoundThisFrame(a) && bound.wasBoundThisFrame(b), "bound this frame");
+
+      // A shader that stays bound only counts once it is bound again
+      bound.nextFrame();
+      check(!bound.wasBoundThisFrame(a) && !bound.wasBoundThisFrame(b), "bound in the previous frame");
+      check(bound.get(ShaderType::Vertex).desc == &b, "bound shader lost");
+
+      bound.bind(ShaderType::Vertex, 1, &a);
+      check(bound.wasBoundThisFrame(a) && !bound.wasBoundThisFrame(b), "rebound");
+    }
+
+    void testDescriptorEdits() {
+      ShaderDesc desc = createDesc({ 4 }, { });
+
+      BoundShaders bound;
+      bound.bind(ShaderType::Vertex, 1, &desc);
+
+      // Edits from the developer menu show up with the next frame
+      desc.activated = false;
+      desc.constantVs.emplace(1);
+      desc.updateConstantMasks();
+      check(bound.isActivated() && !bound.hasConstant(1, ShaderType::Vertex), "snapshot changed before the next frame");
+
+      bound.nextFrame();
+      check(!bound.isActivated() && bound.hasConstant(1, ShaderType::Vertex), "edits not picked up");
+    }
+
+    // The lookups that every query used to do, kept to compare results and timings against
+    class ReferenceHasher {
+    public:
+      std::unordered_map<uint32_t, ShaderDesc> shaders[2];
+      std::unordered_map<uint64_t, uint32_t> shadersToHash[2];
+      std::unordered_set<uint64_t> shadersBinded[2];
+      uint64_t currentBinded[2] = { };
+
+      void bind(ShaderType type, uint64_t shader) {
+        currentBinded[(uint32_t) type] = shader;
+        shadersBinded[(uint32_t) type].emplace(shader);
+      }
+
+      void reset() {
+        shadersBinded[0].clear();
+        shadersBinded[1].clear();
+      }
+
+      const ShaderDesc* find(uint32_t i) const {
+        auto it = shadersToHash[i].find(currentBinded[i]);
+        if (it == shadersToHash[i].end()) {
+          return nullptr;
+        }
+        auto itShader = shaders[i].find(it->second);
+        return itShader != shaders[i].end() ? &itShader->second : nullptr;
+      }
+
+      bool isActivated() const {
+        for (uint32_t i = 0; i < 2; ++i) {
+          const ShaderDesc* desc = find(i);
+          if (desc != nullptr && !desc->activated) {
+            return false;
+          }
+        }
+        return true;
+      }
+
+      bool hasConstant(uint32_t constant, ShaderType type) const {
+        const ShaderDesc* desc = find((uint32_t) type);
+        if (desc == nullptr) {
+          return false;
+        }
+        const auto& constants = type == ShaderType::Vertex ? desc->constantVs : desc->constantPs;
+        return constants.find(constant) != constants.end();
+      }
+
+      bool isHashBinded(uint32_t hash, ShaderType type) const {
+        for (const auto& [shader, shaderHash] : shadersToHash[(uint32_t) type]) {
+          if (shaderHash == hash) {
+            return shadersBinded[(uint32_t) type].find(shader) != shadersBinded[(uint32_t) type].end();
+          }
+        }
+        return false;
+      }
+    };
+
+    struct Event {
+      enum Type : uint8_t { BindVs, BindPs, Draw, EndFrame } type;
+      uint32_t shader;
+    };
+
+    void testReplay() {
+      // A frame of a typical scene: a few hundred shaders, thousands of draws with a shader change every few draws
+      constexpr uint32_t kNumShaders = 400;
+      constexpr uint32_t kNumFrames = 20;
+      constexpr uint32_t kDrawsPerFrame = 3000;
+      constexpr uint32_t kQueriedHash = 0xCCF0D14;
+
+      std::mt19937 rng(42);
+      const uint32_t constants[] = { 1, 2, 4, 170, 171, 186 };
+
+      ReferenceHasher reference;
+      std::unordered_map<uint32_t, ShaderDesc> shaders[2];
+      std::unordered_map<uint64_t, std::pair<uint32_t, ShaderDesc*>> shadersToHash[2];
+
+      for (uint32_t type = 0; type < 2; type++) {
+        for (uint32_t i = 0; i < kNumShaders; i++) {
+          const uint32_t hash = i == 0 ? kQueriedHash : rng();
+          ShaderDesc desc;
+          for (uint32_t constant : constants) {
+            if (rng() % 3 == 0) {
+              (type == 0 ? desc.constantVs : desc.constantPs).emplace(constant);
+            }
+          }
+          desc.activated = rng() % 10 != 0;
+          desc.updateConstantMasks();
+
+          const uint64_t shader = 0x10000 + i * 0x100;
+          reference.shaders[type].emplace(hash, desc);
+          reference.shadersToHash[type].emplace(shader, hash);
+
+          auto [it, inserted] = shaders[type].emplace(hash, desc);
+          shadersToHash[type].emplace(shader, std::make_pair(hash, &it->second));
+        }
+      }
+
+      std::vector<Event> events;
+      for (uint32_t frame = 0; frame < kNumFrames; frame++) {
+        for (uint32_t draw = 0; draw < kDrawsPerFrame; draw++) {
+          if (draw % 4 == 0) {
+            // Hot shaders are bound much more often than the rest
+            const uint32_t index = rng() % 8 == 0 ? rng() % kNumShaders : rng() % 16;
+            events.push_back(Event { Event::BindVs, 0x10000 + index * 0x100 });
+            events.push_back(Event { Event::BindPs, 0x10000 + ((index * 7) % kNumShaders) * 0x100 });
+          }
+          events.push_back(Event { Event::Draw, 0 });
+        }
+        events.push_back(Event { Event::EndFrame, 0 });
+      }
+
+      using Clock = std::chrono::high_resolution_clock;
+      auto ms = [] (Clock::time_point start, Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - start).count();
+      };
+
+      // The queries D3D9Rtx makes for every draw
+      std::vector<uint8_t> referenceResults;
+      const auto t0 = Clock::now();
+      for (const Event& event : events) {
+        switch (event.type) {
+        case Event::BindVs: reference.bind(ShaderType::Vertex, event.shader); break;
+        case Event::BindPs: reference.bind(ShaderType::Pixel, event.shader); break;
+        case Event::EndFrame: reference.reset(); break;
+        case Event::Draw: {
+          uint32_t result = reference.isActivated() ? 1 : 0;
+          for (uint32_t i = 0; i < 6; i++) {
+            result |= reference.hasConstant(constants[i], ShaderType::Vertex) << (i + 1);
+          }
+          result |= reference.hasConstant(170, ShaderType::Pixel) << 7;
+          result |= reference.hasConstant(171, ShaderType::Pixel) << 8;
+          result |= reference.isHashBinded(kQueriedHash, ShaderType::Vertex) << 9;
+          referenceResults.push_back(uint8_t(result));
+          referenceResults.push_back(uint8_t(result >> 8));
+          break;
+        }
+        }
+      }
+      const auto t1 = Clock::now();
+
+      BoundShaders bound;
+      std::vector<uint8_t> results;
+      ShaderDesc* queriedDesc = &shaders[0].find(kQueriedHash)->second;
+
+      auto bind = [&] (ShaderType type, uint64_t shader) {
+        auto it = shadersToHash[(uint32_t) type].find(shader);
+        bound.bind(type, it->second.first, it->second.second);
+      };
+
+      const auto t2 = Clock::now();
+      for (const Event& event : events) {
+        switch (event.type) {
+        case Event::BindVs: bind(ShaderType::Vertex, event.shader); break;
+        case Event::BindPs: bind(ShaderType::Pixel, event.shader); break;
+        case Event::EndFrame: bound.nextFrame(); break;
+        case Event::Draw: {
+          uint32_t result = bound.isActivated() ? 1 : 0;
+          for (uint32_t i = 0; i < 6; i++) {
+            result |= bound.hasConstant(constants[i], ShaderType::Vertex) << (i + 1);
+          }
+          result |= bound.hasConstant(170, ShaderType::Pixel) << 7;
+          result |= bound.hasConstant(171, ShaderType::Pixel) << 8;
+          result |= bound.wasBoundThisFrame(*queriedDesc) << 9;
+          results.push_back(uint8_t(result));
+          results.push_back(uint8_t(result >> 8));
+          break;
+        }
+        }
+      }
+      const auto t3 = Clock::now();
+
+      check(results == referenceResults, "replay results differ from the map lookups");
+
+      std::cout << kNumFrames * kDrawsPerFrame << " draws replayed: map lookups " << ms(t0, t1)
+                << " ms, bound shader snapshot " << ms(t2, t3) << " ms" << std::endl;
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
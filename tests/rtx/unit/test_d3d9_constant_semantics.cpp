@@ -0,0 +1,304 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_constant_semantics.h"
+#include "../../../src/dxso/dxso_module.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_d3d9_constant_semantics.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testDefaultTable();
+      testParse();
+      testConstantTable();
+      testResolve();
+      testMaterialsMatchDefault();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    struct NamedConstant {
+      const char* name;
+      uint16_t    reg;
+      uint16_t    count;
+    };
+
+    using Registers = std::vector<std::array<float, 4>>;
+    using Mask = std::bitset<256>;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Constant semantics test failed: ", message));
+      }
+    }
+
+    /**
+     * Builds vs_3_0 bytecode with a comment before the constant
+     * table, like the ones compilers emit, and a few instructions.
+     */
+    static std::vector<uint32_t> buildShader(const std::vector<NamedConstant>& constants) {
+      constexpr uint32_t HeaderSize = 0x1c;
+      constexpr uint32_t InfoSize = 20;
+
+      // Constant table: header, constant infos, then the names
+      std::vector<uint8_t> ctab(HeaderSize + InfoSize * constants.size());
+      std::vector<uint32_t> nameOffsets;
+
+      for (const NamedConstant& constant : constants) {
+        nameOffsets.push_back(uint32_t(ctab.size()));
+        ctab.insert(ctab.end(), constant.name, constant.name + std::strlen(constant.name) + 1);
+      }
+
+      const uint32_t creator = uint32_t(ctab.size());
+      const char* creatorName = "Test compiler";
+      ctab.insert(ctab.end(), creatorName, creatorName + std::strlen(creatorName) + 1);
+      ctab.resize((ctab.size() + 3) & ~size_t(3));
+
+      const uint32_t header[7] = { HeaderSize, creator, 0xFFFE0300, uint32_t(constants.size()), HeaderSize, 0, creator };
+      std::memcpy(ctab.data(), header, sizeof(header));
+
+      for (uint32_t i = 0; i < constants.size(); i++) {
+        uint8_t* info = &ctab[HeaderSize + InfoSize * i];
+        const uint16_t registerInfo[4] = { 2, constants[i].reg, constants[i].count, 0 };
+        std::memcpy(info, &nameOffsets[i], sizeof(uint32_t));
+        std::memcpy(info + 4, registerInfo, sizeof(registerInfo));
+        std::memset(info + 12, 0, 8);
+      }
+
+      std::vector<uint32_t> code = { 0xFFFE0300 };
+
+      // Unrelated comment
+      code.push_back(0xFFFE | (2 << 16));
+      code.push_back(0x47554244); // "DBUG"
+      code.push_back(0);
+
+      code.push_back(0xFFFE | uint32_t((ctab.size() / 4 + 1) << 16));
+      code.push_back(0x42415443); // "CTAB"
+      const size_t offset = code.size();
+      code.resize(offset + ctab.size() / 4);
+      std::memcpy(&code[offset], ctab.data(), ctab.size());
+
+      // dcl_position v0, mov oPos, v0, end
+      const uint32_t instructions[] = {
+        0x0200001F, 0x80000000, 0x900F0000,
+        0x02000001, 0xC00F0000, 0x90E40000,
+        0x0000FFFF
+      };
+      code.insert(code.end(), std::begin(instructions), std::end(instructions));
+      return code;
+    }
+
+    // The shaders hasher gets the constant table the DXSO module decoded while analyzing the shader
+    static std::vector<DxsoCtab::Constant> readConstants(const std::vector<uint32_t>& code) {
+      DxsoReader reader(reinterpret_cast<const char*>(code.data()));
+      DxsoModule module(reader);
+      module.analyze();
+      return module.ctab().m_constantData;
+    }
+
+    void testDefaultTable() {
+      const D3D9ConstantSemanticTable table = D3D9ConstantSemanticTable::parse("");
+      const auto& semantics = table.getSemantics();
+
+      check(semantics.size() == 10, "default table has the wrong number of entries");
+      check(table.find(D3D9ConstantRole::MaterialDiffuse) == 1, "material diffuse is not the second entry");
+
+      const D3D9ConstantSemantic& ambient = semantics[table.find(D3D9ConstantRole::AmbientColor)];
+      check(ambient.name == "gAmbientColor" && ambient.reg == 1, "ambient color has the wrong name or register");
+      check(ambient.stages == D3D9ConstantStages::Vertex, "ambient color has the wrong stages");
+      check(ambient.unlessRoles == ((1u << uint32_t(D3D9ConstantRole::MaterialDiffuse)) | (1u << uint32_t(D3D9ConstantRole::FadeColor))),
+        "ambient color has the wrong exclusions");
+
+      const D3D9ConstantSemantic& diffuse = semantics[table.find(D3D9ConstantRole::MaterialDiffuse)];
+      check(diffuse.stages == (D3D9ConstantStages::Vertex | D3D9ConstantStages::Pixel), "material diffuse has the wrong stages");
+
+      const D3D9ConstantSemantic& world = semantics[table.find(D3D9ConstantRole::WorldMatrix)];
+      check(world.name.empty() && world.reg == 195 && world.combine == D3D9ConstantCombine::None, "world matrix is wrong");
+    }
+
+    void testParse() {
+      const D3D9ConstantSemanticTable table = D3D9ConstantSemanticTable::parse(
+        " materialAlbedo , gAlbedo , 12 , ps , multiply ;"
+        "materialPower,gPower,300,vs,powW;"       // register out of range
+        "materialPower,gPower,5,gs,powW;"         // unknown stage
+        "albedo,gAlbedo,12,ps,multiply;"          // unknown role
+        "ambientColor,gAmbient,3,vs,multiply,nothing;"
+        "materialPower,gPower,5,vs,powW;;");
+
+      const auto& semantics = table.getSemantics();
+      check(semantics.size() == 2, "malformed entries were not skipped");
+      check(semantics[0].role == D3D9ConstantRole::MaterialAlbedo && semantics[0].name == "gAlbedo"
+         && semantics[0].reg == 12 && semantics[0].stages == D3D9ConstantStages::Pixel, "entry with spaces was not trimmed");
+      check(semantics[1].combine == D3D9ConstantCombine::PowW && semantics[1].reg == 5, "last entry is wrong");
+
+      std::string many;
+      for (uint32_t i = 0; i < 40; i++)
+        many += "fadeColor,gFadeColor,2,vs,multiply;";
+
+      check(D3D9ConstantSemanticTable::parse(many).getSemantics().size() == D3D9ShaderSemantics::MaxSemantics,
+        "table was not limited to the maximum number of semantics");
+    }
+
+    void testConstantTable() {
+      const std::vector<uint32_t> code = buildShader({
+        { "gFadeColor", 2, 1 }, { "gWorld", 195, 4 }, { "gMaterialDiffuse", 20, 1 } });
+
+      const std::vector<DxsoCtab::Constant> constants = readConstants(code);
+      check(constants.size() == 3, "constant table has the wrong number of constants");
+      check(constants[1].name == "gWorld" && constants[1].registerIndex == 195 && constants[1].registerCount == 4,
+        "constant was read wrong");
+      check(constants[2].name == "gMaterialDiffuse" && constants[2].registerIndex == 20, "constant was read wrong");
+
+      // Shaders without a constant table
+      const std::vector<uint32_t> noTable = { 0xFFFE0300, 0x02000001, 0xC00F0000, 0x90E40000, 0x0000FFFF };
+      check(readConstants(noTable).empty(), "shader without constant table has constants");
+    }
+
+    void testResolve() {
+      const D3D9ConstantSemanticTable table = D3D9ConstantSemanticTable::parse("");
+      const int32_t fade = table.find(D3D9ConstantRole::FadeColor);
+      const int32_t diffuse = table.find(D3D9ConstantRole::MaterialDiffuse);
+      const int32_t albedo = table.find(D3D9ConstantRole::MaterialAlbedo);
+      const int32_t power = table.find(D3D9ConstantRole::MaterialPower);
+
+      // The material diffuse moved, the albedo only exists in pixel shaders of the default table
+      const std::vector<uint32_t> code = buildShader({
+        { "gFadeColor", 2, 1 }, { "gMaterialDiffuse", 20, 1 }, { "gMaterialAlbedo", 21, 1 } });
+
+      const D3D9ShaderSemantics vs = table.resolve(D3D9ConstantStages::Vertex, readConstants(code));
+      check(vs.isResolved(fade) && vs.getRegister(fade, 0) == 2, "fade color was not resolved");
+      check(vs.isResolved(diffuse) && vs.getRegister(diffuse, 170) == 20, "moved material diffuse was not resolved");
+      check(vs.isResolved(albedo), "material albedo was not resolved");
+      check(!vs.isResolved(power) && vs.getRegister(power, 4) == 4, "missing constant has no default register");
+
+      const D3D9ShaderSemantics ps = table.resolve(D3D9ConstantStages::Pixel, readConstants(code));
+      check(!ps.isResolved(fade), "vertex shader only semantic was resolved for a pixel shader");
+      check(ps.isResolved(diffuse) && ps.getRegister(diffuse, 170) == 20, "material diffuse was not resolved for a pixel shader");
+    }
+
+    // The material combination the default table replaces
+    static void combineReference(float* color, const Registers& vsConsts, const Mask& vsBound, const Registers& psConsts, const Mask& psBound) {
+      auto combineColor = [&](const std::array<float, 4>& input) {
+        for (uint32_t i = 0; i < 4; i++)
+          color[i] *= input[i];
+      };
+
+      const bool fadeColor = vsBound.test(2);
+      const bool materialDiffuseVertex = vsBound.test(170);
+
+      if (fadeColor)
+        combineColor(vsConsts[2]);
+
+      if (materialDiffuseVertex)
+        combineColor(vsConsts[170]);
+      else if (psBound.test(170))
+        combineColor(psConsts[170]);
+
+      if (vsBound.test(171))
+        combineColor(vsConsts[171]);
+      else if (psBound.test(171))
+        combineColor(psConsts[171]);
+
+      if (vsBound.test(1) && !materialDiffuseVertex && !fadeColor)
+        combineColor(vsConsts[1]);
+
+      if (vsBound.test(4)) {
+        for (uint32_t i = 0; i < 3; i++)
+          color[i] = std::pow(color[i], vsConsts[4][3]);
+      }
+    }
+
+    void testMaterialsMatchDefault() {
+      const D3D9ConstantSemanticTable table = D3D9ConstantSemanticTable::parse("");
+
+      // Shaders whose constant tables name the constants at the default registers
+      const D3D9ShaderSemantics vsSemantics = table.resolve(D3D9ConstantStages::Vertex, readConstants(buildShader({
+        { "gAmbientColor", 1, 1 }, { "gFadeColor", 2, 1 }, { "gMatPower", 4, 1 },
+        { "gMaterialDiffuse", 170, 1 }, { "gMaterialAlbedo", 171, 1 } })));
+      const D3D9ShaderSemantics psSemantics = table.resolve(D3D9ConstantStages::Pixel, readConstants(buildShader({
+        { "gMaterialDiffuse", 170, 1 }, { "gMaterialAlbedo", 171, 1 } })));
+
+      std::mt19937 rng(7);
+      std::uniform_real_distribution<float> value(0.0f, 2.0f);
+      const uint32_t registers[] = { 1, 2, 4, 170, 171 };
+
+      for (uint32_t iteration = 0; iteration < 1000; iteration++) {
+        Registers vsConsts(256), psConsts(256);
+        Mask vsBound, psBound;
+
+        for (uint32_t reg : registers) {
+          vsConsts[reg] = { value(rng), value(rng), value(rng), value(rng) };
+          psConsts[reg] = { value(rng), value(rng), value(rng), value(rng) };
+
+          if (rng() & 1)
+            vsBound.set(reg);
+          if (rng() & 1)
+            psBound.set(reg);
+        }
+
+        float expected[4] = { 0.5f, 0.75f, 1.0f, 1.0f };
+        float actual[4] = { 0.5f, 0.75f, 1.0f, 1.0f };
+        combineReference(expected, vsConsts, vsBound, psConsts, psBound);
+
+        table.combine(actual, [&](uint32_t semantic, uint32_t stage) -> const float* {
+          const D3D9ConstantSemantic& entry = table.getSemantics()[semantic];
+          const bool vertex = stage == D3D9ConstantStages::Vertex;
+          const uint32_t reg = (vertex ? vsSemantics : psSemantics).getRegister(semantic, entry.reg);
+
+          if (!(vertex ? vsBound : psBound).test(reg))
+            return nullptr;
+
+          return (vertex ? vsConsts : psConsts)[reg].data();
+        });
+
+        check(std::memcmp(expected, actual, sizeof(expected)) == 0, "default table doesn't match the built-in material combination");
+      }
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,184 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_constant_shadow.h"
+
+namespace {
+  std::atomic<uint64_t> g_allocationCount = { 0 };
+}
+
+// Counts heap allocations, so that writing constants can be checked not to allocate
+void* operator new(size_t size) {
+  g_allocationCount++;
+  if (void* ptr = std::malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  std::free(ptr);
+}
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_d3d9_constant_shadow.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testFloatConstants();
+      testOverlappingRanges();
+      testBoolConstants();
+      testNoAllocations();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Constant shadow test failed: ", message));
+      }
+    }
+
+    static std::vector<float> createData(uint32_t count, float base) {
+      std::vector<float> data(count * 4);
+      for (uint32_t i = 0; i < data.size(); i++) {
+        data[i] = base + float(i);
+      }
+      return data;
+    }
+
+    static bool hasRange(const std::vector<Constant>& constants, size_t index, uint32_t start, uint32_t count) {
+      return index < constants.size()
+          && constants[index].m_startRegister == start
+          && constants[index].m_vector4Count == count
+          && constants[index].m_copy.size() == count * 4;
+    }
+
+    void testFloatConstants() {
+      ConstantShadow shadow;
+      check(shadow.getConstants().empty(), "empty shadow has constants");
+
+      const std::vector<float> a = createData(4, 100.0f);
+      const std::vector<float> b = createData(2, 200.0f);
+      shadow.write(170, 4, a.data(), 4);
+      shadow.write(2, 2, b.data(), 4);
+
+      check(shadow.isWritten(2) && shadow.isWritten(173) && !shadow.isWritten(4) && !shadow.isWritten(174), "written registers");
+      check(!shadow.isWritten(100000), "register past the end");
+      check(shadow.get<float>(171, 2) == 106.0f, "register value");
+
+      // Ranges come back ordered by register, as they were set
+      const std::vector<Constant>& constants = shadow.getConstants();
+      check(constants.size() == 2, "range count");
+      check(hasRange(constants, 0, 2, 2) && hasRange(constants, 1, 170, 4), "ranges");
+      check(constants[1].m_copy == a && constants[0].m_copy == b, "range values");
+
+      // Setting the same range again updates the values in place
+      const std::vector<float> c = createData(4, 300.0f);
+      shadow.write(170, 4, c.data(), 4);
+      check(shadow.getConstants().size() == 2 && shadow.getConstants()[1].m_copy == c, "updated range");
+    }
+
+    void testOverlappingRanges() {
+      ConstantShadow shadow;
+
+      // Adjacent ranges stay separate
+      shadow.write(0, 4, createData(4, 0.0f).data(), 4);
+      shadow.write(4, 4, createData(4, 16.0f).data(), 4);
+      check(hasRange(shadow.getConstants(), 0, 0, 4) && hasRange(shadow.getConstants(), 1, 4, 4), "adjacent ranges");
+
+      // A range covering earlier ones replaces them
+      shadow.write(2, 8, createData(8, 50.0f).data(), 4);
+      const std::vector<Constant>& constants = shadow.getConstants();
+      check(constants.size() == 2 && hasRange(constants, 0, 0, 2) && hasRange(constants, 1, 2, 8), "covering range");
+      check(constants[0].m_copy[0] == 0.0f && constants[1].m_copy[0] == 50.0f, "covering range values");
+
+      // A range inside of another one splits it
+      shadow.write(5, 1, createData(1, 90.0f).data(), 4);
+      check(shadow.getConstants().size() == 3 && hasRange(shadow.getConstants(), 1, 2, 3) && hasRange(shadow.getConstants(), 2, 5, 5), "split range");
+      check(shadow.getConstants()[2].m_copy[0] == 90.0f && shadow.getConstants()[2].m_copy[4] == 66.0f, "split range values");
+    }
+
+    void testBoolConstants() {
+      ConstantShadow shadow;
+
+      // Only one value per register is read for bools
+      const uint32_t bools[3] = { 1, 0, 1 };
+      shadow.write(1, 3, bools, 1);
+
+      check(shadow.get<uint32_t>(1, 0) == 1 && shadow.get<uint32_t>(2, 0) == 0 && shadow.get<uint32_t>(3, 0) == 1, "bool values");
+      check(shadow.get<uint32_t>(3, 1) == 0 && shadow.get<uint32_t>(3, 3) == 0, "bool padding");
+      check(hasRange(shadow.getConstants(), 0, 1, 3), "bool range");
+    }
+
+    void testNoAllocations() {
+      ConstantShadow shadow;
+
+      // Hundreds of ranges per frame, as a game sets them
+      std::vector<float> data = createData(8, 1.0f);
+      auto frame = [&] (float value) {
+        for (uint32_t i = 0; i < 200; i++) {
+          data[0] = value + float(i);
+          shadow.write((i * 37) % 248, 1 + i % 8, data.data(), 4);
+        }
+      };
+
+      frame(0.0f);
+      const uint32_t registerCount = shadow.getRegisterCount();
+
+      const uint64_t allocations = g_allocationCount.load();
+      for (uint32_t i = 1; i < 100; i++) {
+        frame(float(i));
+      }
+      check(g_allocationCount.load() == allocations, "writing constants allocated memory");
+      check(shadow.getRegisterCount() == registerCount, "register file grew");
+
+      std::cout << "20000 constant ranges written without allocations, " << registerCount << " registers" << std::endl;
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,229 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <array>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_constant_upload.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_d3d9_constant_upload.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testRedundantUploads();
+      testShrinkAndGrow();
+      testDefinedConstants();
+      testRandomUploads();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    using Register = std::array<float, 4>;
+
+    // Mirrors DxsoDefinedConstant
+    struct DefinedConstant {
+      uint32_t uboIdx;
+      float    float32[4];
+    };
+
+    using DefinedConstants = std::vector<DefinedConstant>;
+
+    // Application constants plus the buffer the uploads go to
+    struct Stage {
+      std::vector<Register> ints = std::vector<Register>(16);
+      std::vector<Register> floats = std::vector<Register>(256);
+      std::vector<Register> bufferInts = std::vector<Register>(16);
+      std::vector<Register> bufferFloats = std::vector<Register>(256);
+      D3D9ConstantUploadShadow shadow;
+      uint32_t uploads = 0;
+
+      void setFloat(uint32_t reg, float value) {
+        floats[reg] = { value, value, value, value };
+        shadow.markFloats(reg, 1);
+      }
+
+      void setInt(uint32_t reg, float value) {
+        ints[reg] = { value, value, value, value };
+        shadow.markInts(reg, 1);
+      }
+
+      bool upload(uint32_t intCount, uint32_t floatCount, const DefinedConstants* copies = nullptr) {
+        if (!shadow.update(ints.data(), intCount, floats.data(), floatCount, copies))
+          return false;
+
+        if (shadow.getIntCount() != 0)
+          std::memcpy(bufferInts.data(), shadow.getInts(), shadow.getIntCount() * sizeof(Register));
+        if (shadow.getFloatCount() != 0)
+          std::memcpy(bufferFloats.data(), shadow.getFloats(), shadow.getFloatCount() * sizeof(Register));
+        uploads++;
+        return true;
+      }
+
+      // Whether the buffer holds what the shader should read
+      bool matches(uint32_t intCount, uint32_t floatCount, const DefinedConstants* copies = nullptr) const {
+        std::vector<Register> expected(floats.begin(), floats.begin() + floatCount);
+        if (copies != nullptr) {
+          for (const auto& constant : *copies) {
+            if (constant.uboIdx < floatCount)
+              std::memcpy(expected[constant.uboIdx].data(), constant.float32, sizeof(Register));
+          }
+        }
+
+        return std::memcmp(bufferInts.data(), ints.data(), intCount * sizeof(Register)) == 0
+            && std::memcmp(bufferFloats.data(), expected.data(), floatCount * sizeof(Register)) == 0;
+      }
+    };
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Constant upload test failed: ", message));
+      }
+    }
+
+    void testRedundantUploads() {
+      Stage stage;
+      stage.setFloat(0, 1.0f);
+      stage.setInt(2, 3.0f);
+
+      check(stage.upload(4, 32), "first upload was skipped");
+      check(stage.matches(4, 32), "first upload has wrong data");
+
+      // Nothing set since the last upload
+      check(!stage.upload(4, 32), "upload without changes was not skipped");
+
+      // The same material constants set again between draws
+      stage.setFloat(0, 1.0f);
+      stage.setInt(2, 3.0f);
+      check(!stage.upload(4, 32), "upload of identical constants was not skipped");
+
+      stage.setFloat(5, 2.0f);
+      check(stage.upload(4, 32), "changed constant was not uploaded");
+      check(stage.matches(4, 32), "changed upload has wrong data");
+
+      // Writes past the registers the shader reads don't matter
+      stage.setFloat(100, 7.0f);
+      check(!stage.upload(4, 32), "write outside of the upload range caused an upload");
+    }
+
+    void testShrinkAndGrow() {
+      Stage stage;
+      check(stage.upload(0, 64), "first upload was skipped");
+
+      // A shader reading fewer registers can use the current slice
+      check(!stage.upload(0, 16), "smaller upload of the same data was not skipped");
+
+      // Registers written while they weren't uploaded must not be lost
+      stage.setFloat(40, 5.0f);
+      check(!stage.upload(0, 16), "write outside of the upload range caused an upload");
+      check(stage.upload(0, 64), "register written while not uploaded was lost");
+      check(stage.matches(0, 64), "grown upload has wrong data");
+
+      check(stage.upload(0, 128), "larger upload was skipped");
+      check(stage.matches(0, 128), "larger upload has wrong data");
+    }
+
+    void testDefinedConstants() {
+      Stage stage;
+      stage.setFloat(3, 1.0f);
+
+      const DefinedConstants copies = { { 3, { 9.0f, 9.0f, 9.0f, 9.0f } } };
+
+      check(stage.upload(0, 16, &copies), "first upload was skipped");
+      check(stage.matches(0, 16, &copies), "defined constants were not applied");
+      check(!stage.upload(0, 16, &copies), "upload with the same defined constants was not skipped");
+
+      // Switching to a shader without defined constants restores the register
+      stage.shadow.invalidate();
+      check(stage.upload(0, 16), "shader change without defined constants was skipped");
+      check(stage.matches(0, 16), "register kept the defined constant");
+    }
+
+    void testRandomUploads() {
+      std::mt19937 rng(1234);
+      Stage stage;
+
+      const DefinedConstants copiesA = { { 1, { 1.5f, 2.5f, 3.5f, 4.5f } }, { 30, { -1.0f, 0.0f, 1.0f, 2.0f } } };
+      const DefinedConstants copiesB = { { 7, { 8.0f, 8.0f, 8.0f, 8.0f } } };
+      const DefinedConstants* shaderCopies[] = { nullptr, &copiesA, &copiesB };
+
+      uint32_t draws = 0;
+      uint32_t intCount = 4;
+      uint32_t floatCount = 32;
+      const DefinedConstants* copies = nullptr;
+
+      for (uint32_t i = 0; i < 20000; i++) {
+        // Mostly the same values set again, like material constants between draws
+        const uint32_t writes = rng() % 4;
+        for (uint32_t w = 0; w < writes; w++) {
+          const bool isInt = rng() % 8 == 0;
+          const uint32_t reg = isInt ? rng() % 16 : rng() % 64;
+          const float current = isInt ? stage.ints[reg][0] : stage.floats[reg][0];
+          const float value = rng() % 8 == 0 ? float(rng() % 3) : current;
+
+          if (isInt) {
+            stage.setInt(reg, value);
+          } else {
+            stage.setFloat(reg, value);
+          }
+        }
+
+        // Shader changes
+        if (rng() % 16 == 0) {
+          const DefinedConstants* next = shaderCopies[rng() % 3];
+          if (next != nullptr || copies != nullptr)
+            stage.shadow.invalidate();
+          copies = next;
+
+          intCount = rng() % 17;
+          floatCount = 16 * (1 + rng() % 4);
+        }
+
+        stage.upload(intCount, floatCount, copies);
+        check(stage.matches(intCount, floatCount, copies), "buffer doesn't match the constants");
+        draws++;
+      }
+
+      check(stage.uploads < draws / 2, "most redundant uploads were not skipped");
+      std::cout << draws << " draws, " << stage.uploads << " uploads" << std::endl;
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
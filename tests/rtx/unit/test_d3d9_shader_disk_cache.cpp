@@ -0,0 +1,453 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_fixed_function.h"
+#include "../../../src/d3d9/d3d9_shader_disk_cache.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_d3d9_shader_disk_cache.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testShaderRoundTrip();
+      testFixedFunctionKeys();
+      testSWVPKeys();
+      testModuleRoundTrip();
+      testCorruptedPayload();
+      testTruncatedFile();
+      testSettingsMismatch();
+      std::remove(kCachePath);
+      std::cout << "All passed\n";
+    }
+
+  private:
+    static constexpr const char* kCachePath = "test_d3d9_shader_disk_cache.rtxcache";
+    static constexpr XXH64_hash_t kSettingsHash = 0x5678;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("D3D9 shader disk cache test failed: ", message));
+      }
+    }
+
+    static D3D9CachedShader makeShader(uint32_t seed) {
+      D3D9CachedShader shader;
+      shader.stage = seed;
+      shader.slots = { { seed, 1, 2, 3, 4, 5 }, { 6, 7, 8, 9, seed + 10, 11 } };
+      shader.inputSlots = seed + 1;
+      shader.outputSlots = seed + 2;
+      shader.pushConstOffset = seed + 3;
+      shader.pushConstSize = seed + 4;
+      shader.rasterizedStream = -1;
+      shader.xfbStrides = { seed, seed + 1, seed + 2, seed + 3 };
+      shader.constData = { seed, 0xdeadbeef };
+      shader.codeDwords = 5 + seed;
+      shader.codeMask = { 0x1234, seed };
+      shader.code = { 0x0123456789abcdefull, seed, 42 };
+      return shader;
+    }
+
+    static bool equal(const D3D9CachedShader& a, const D3D9CachedShader& b) {
+      if (a.slots.size() != b.slots.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < a.slots.size(); i++) {
+        if (std::memcmp(&a.slots[i], &b.slots[i], sizeof(D3D9CachedShaderSlot)) != 0) {
+          return false;
+        }
+      }
+      return a.stage == b.stage
+          && a.inputSlots == b.inputSlots
+          && a.outputSlots == b.outputSlots
+          && a.pushConstOffset == b.pushConstOffset
+          && a.pushConstSize == b.pushConstSize
+          && a.rasterizedStream == b.rasterizedStream
+          && a.xfbStrides == b.xfbStrides
+          && a.constData == b.constData
+          && a.codeDwords == b.codeDwords
+          && a.codeMask == b.codeMask
+          && a.code == b.code;
+    }
+
+    void testShaderRoundTrip() {
+      const D3D9CachedShader shader = makeShader(3);
+
+      std::vector<uint8_t> data;
+      shader.serialize(data);
+
+      D3D9CachedShader result;
+      check(result.deserialize(data.data(), data.size()) && equal(shader, result), "serialization round trip");
+
+      // Truncated or padded data is rejected
+      check(!result.deserialize(data.data(), data.size() - 1), "truncated shader accepted");
+      data.push_back(0);
+      check(!result.deserialize(data.data(), data.size()), "padded shader accepted");
+
+      std::remove(kCachePath);
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        check(!cache.load(), "loaded a missing file");
+
+        const uint32_t key = 7;
+        cache.store(D3D9ShaderCacheKind::FixedFunctionVS, &key, sizeof(key), shader);
+        check(cache.find(D3D9ShaderCacheKind::FixedFunctionVS, &key, sizeof(key), result) && equal(shader, result), "lookup in the same session");
+
+        // The kind is part of the key
+        check(!cache.find(D3D9ShaderCacheKind::FixedFunctionFS, &key, sizeof(key), result), "kinds alias");
+      }
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        check(cache.load() && cache.size() == 1, "reload");
+
+        const uint32_t key = 7;
+        check(cache.find(D3D9ShaderCacheKind::FixedFunctionVS, &key, sizeof(key), result) && equal(shader, result), "lookup after reload");
+        check(cache.getStatistics().numHits == 1, "hit not counted");
+      }
+    }
+
+    static D3D9CachedShaderModule makeModule(uint32_t seed) {
+      D3D9CachedShaderModule module;
+      module.bytecode = { 0x00, 0x02, 0xFE, 0xFF, uint8_t(seed), 0xFF, 0xFF, 0x00, 0x00 };
+      module.permutationMask = 0x3;
+      module.shaders = { makeShader(seed), makeShader(seed + 1) };
+      module.isgn = { { 0, 1, 2, 3, 0xF, 0 }, { 4, 5, 10, seed, 0x3, 1 } };
+      module.osgn = { { seed, 0, 0, 0, 0xF, 0 } };
+      module.usedSamplers = seed << 17;
+      module.usedRTs = 0x1;
+      module.programType = 1;
+      module.minorVersion = 0;
+      module.majorVersion = 3;
+      module.needsConstantCopies = 1;
+      module.maxConstIndexF = 255;
+      module.maxConstIndexI = seed;
+      module.maxConstIndexB = 2;
+      module.boolConstantMask = 0xF0F0;
+      module.constants = { { 3, { 1.0f, -2.0f, 0.5f, float(seed) } } };
+      module.maxDefinedConst = 4;
+      return module;
+    }
+
+    static bool equal(const D3D9CachedShaderModule& a, const D3D9CachedShaderModule& b) {
+      if (a.shaders.size() != b.shaders.size()
+       || a.isgn.size() != b.isgn.size()
+       || a.osgn.size() != b.osgn.size()
+       || a.constants.size() != b.constants.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < a.shaders.size(); i++) {
+        if (!equal(a.shaders[i], b.shaders[i])) {
+          return false;
+        }
+      }
+      return a.bytecode == b.bytecode
+          && a.permutationMask == b.permutationMask
+          && std::memcmp(a.isgn.data(), b.isgn.data(), a.isgn.size() * sizeof(D3D9CachedIsgnEntry)) == 0
+          && std::memcmp(a.osgn.data(), b.osgn.data(), a.osgn.size() * sizeof(D3D9CachedIsgnEntry)) == 0
+          && std::memcmp(a.constants.data(), b.constants.data(), a.constants.size() * sizeof(D3D9CachedDefinedConstant)) == 0
+          && a.usedSamplers == b.usedSamplers
+          && a.usedRTs == b.usedRTs
+          && a.programType == b.programType
+          && a.minorVersion == b.minorVersion
+          && a.majorVersion == b.majorVersion
+          && a.needsConstantCopies == b.needsConstantCopies
+          && a.maxConstIndexF == b.maxConstIndexF
+          && a.maxConstIndexI == b.maxConstIndexI
+          && a.maxConstIndexB == b.maxConstIndexB
+          && a.boolConstantMask == b.boolConstantMask
+          && a.maxDefinedConst == b.maxDefinedConst;
+    }
+
+    void testModuleRoundTrip() {
+      const D3D9CachedShaderModule module = makeModule(5);
+
+      std::vector<uint8_t> data;
+      module.serialize(data);
+
+      D3D9CachedShaderModule result;
+      check(result.deserialize(data.data(), data.size()) && equal(module, result), "module serialization round trip");
+      check(!result.deserialize(data.data(), data.size() - 1), "truncated module accepted");
+
+      // The shader count has to match the permutation mask
+      D3D9CachedShaderModule mismatch = makeModule(5);
+      mismatch.permutationMask = 0x1;
+      data.clear();
+      mismatch.serialize(data);
+      check(!result.deserialize(data.data(), data.size()), "module with missing permutations accepted");
+
+      const uint8_t keys[2][24] = { { 1 }, { 2 } };
+
+      std::remove(kCachePath);
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        cache.load();
+        cache.store(D3D9ShaderCacheKind::Dxso, keys[0], sizeof(keys[0]), makeModule(0));
+        cache.store(D3D9ShaderCacheKind::Dxso, keys[1], sizeof(keys[1]), makeModule(1));
+        cache.store(D3D9ShaderCacheKind::FixedFunctionVS, keys[0], sizeof(keys[0]), makeShader(0));
+      }
+
+      D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+      check(cache.load() && cache.size() == 3, "reload with modules");
+
+      // Only the keys of the requested kind are listed, without the kind
+      std::vector<std::vector<uint8_t>> cachedKeys = cache.getKeys(D3D9ShaderCacheKind::Dxso);
+      std::sort(cachedKeys.begin(), cachedKeys.end());
+      check(cachedKeys.size() == 2
+         && cachedKeys[0] == std::vector<uint8_t>(std::begin(keys[0]), std::end(keys[0]))
+         && cachedKeys[1] == std::vector<uint8_t>(std::begin(keys[1]), std::end(keys[1])), "module keys");
+
+      for (uint32_t i = 0; i < 2; i++) {
+        check(cache.find(D3D9ShaderCacheKind::Dxso, keys[i], sizeof(keys[i]), result) && equal(result, makeModule(i)), "module lost");
+      }
+    }
+
+    template<typename Key>
+    void testKeys(D3D9ShaderCacheKind kind, const std::vector<Key>& keys, const char* message) {
+      // Every key must differ from the others, or a field is not part of the serialized key
+      for (size_t i = 0; i < keys.size(); i++) {
+        for (size_t j = 0; j < i; j++) {
+          check(std::memcmp(&keys[i], &keys[j], sizeof(Key)) != 0, message);
+        }
+      }
+
+      std::remove(kCachePath);
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        cache.load();
+        for (uint32_t i = 0; i < keys.size(); i++) {
+          cache.store(kind, &keys[i], sizeof(Key), makeShader(i));
+        }
+      }
+
+      D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+      check(cache.load() && cache.size() == keys.size(), message);
+
+      for (uint32_t i = 0; i < keys.size(); i++) {
+        D3D9CachedShader result;
+        check(cache.find(kind, &keys[i], sizeof(Key), result) && equal(result, makeShader(i)), message);
+      }
+    }
+
+    void testFixedFunctionKeys() {
+      // One key per field, with the field set to its maximum value
+      std::vector<D3D9FFShaderKeyVS> vsKeys(1);
+#define ADD_VS_KEY(field) { D3D9FFShaderKeyVS key; key.Data.Contents.field = ~0u; vsKeys.push_back(key); }
+      ADD_VS_KEY(TexcoordIndices)
+      ADD_VS_KEY(HasPositionT)
+      ADD_VS_KEY(HasColor0)
+      ADD_VS_KEY(HasColor1)
+      ADD_VS_KEY(HasPointSize)
+      ADD_VS_KEY(UseLighting)
+      ADD_VS_KEY(NormalizeNormals)
+      ADD_VS_KEY(LocalViewer)
+      ADD_VS_KEY(RangeFog)
+      ADD_VS_KEY(TexcoordFlags)
+      ADD_VS_KEY(DiffuseSource)
+      ADD_VS_KEY(AmbientSource)
+      ADD_VS_KEY(SpecularSource)
+      ADD_VS_KEY(EmissiveSource)
+      ADD_VS_KEY(TransformFlags)
+      ADD_VS_KEY(LightCount)
+      ADD_VS_KEY(TexcoordDeclMask)
+      ADD_VS_KEY(HasFog)
+      ADD_VS_KEY(VertexBlendMode)
+      ADD_VS_KEY(VertexBlendIndexed)
+      ADD_VS_KEY(VertexBlendCount)
+      ADD_VS_KEY(VertexClipping)
+#undef ADD_VS_KEY
+      testKeys(D3D9ShaderCacheKind::FixedFunctionVS, vsKeys, "fixed function VS key field lost");
+
+      std::vector<D3D9FFShaderKeyFS> fsKeys(1);
+      for (uint32_t stage = 0; stage < caps::TextureStageCount; stage++) {
+#define ADD_FS_KEY(field) { D3D9FFShaderKeyFS key; key.Stages[stage].Contents.field = ~0u; fsKeys.push_back(key); }
+        ADD_FS_KEY(ColorOp)
+        ADD_FS_KEY(ColorArg0)
+        ADD_FS_KEY(ColorArg1)
+        ADD_FS_KEY(ColorArg2)
+        ADD_FS_KEY(AlphaOp)
+        ADD_FS_KEY(AlphaArg0)
+        ADD_FS_KEY(AlphaArg1)
+        ADD_FS_KEY(AlphaArg2)
+        ADD_FS_KEY(Type)
+        ADD_FS_KEY(ResultIsTemp)
+        ADD_FS_KEY(Projected)
+        ADD_FS_KEY(ProjectedCount)
+        ADD_FS_KEY(GlobalSpecularEnable)
+        ADD_FS_KEY(GlobalFlatShade)
+        ADD_FS_KEY(allowActiveStagesBeyondDisabledStage)
+#undef ADD_FS_KEY
+      }
+      testKeys(D3D9ShaderCacheKind::FixedFunctionFS, fsKeys, "fixed function FS key field lost");
+    }
+
+    void testSWVPKeys() {
+      const D3DVERTEXELEMENT9 position = { 0, 0, D3DDECLTYPE_FLOAT3, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_POSITION, 0 };
+      const D3DVERTEXELEMENT9 texcoord = { 0, 12, D3DDECLTYPE_FLOAT2, D3DDECLMETHOD_DEFAULT, D3DDECLUSAGE_TEXCOORD, 1 };
+      const D3D9VertexElements declarations[] = {
+        { position },
+        { position, texcoord },
+        { texcoord, position },
+      };
+
+      std::remove(kCachePath);
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        cache.load();
+        for (uint32_t i = 0; i < std::size(declarations); i++) {
+          cache.store(D3D9ShaderCacheKind::SWVP, declarations[i].data(), declarations[i].size() * sizeof(D3DVERTEXELEMENT9), makeShader(i));
+        }
+      }
+
+      D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+      check(cache.load() && cache.size() == std::size(declarations), "SWVP reload");
+      for (uint32_t i = 0; i < std::size(declarations); i++) {
+        D3D9CachedShader result;
+        check(cache.find(D3D9ShaderCacheKind::SWVP, declarations[i].data(), declarations[i].size() * sizeof(D3DVERTEXELEMENT9), result)
+           && equal(result, makeShader(i)), "SWVP declaration lost");
+      }
+    }
+
+    void testCorruptedPayload() {
+      const uint32_t keys[] = { 1, 2 };
+
+      std::remove(kCachePath);
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        cache.load();
+        cache.store(D3D9ShaderCacheKind::FixedFunctionVS, &keys[0], sizeof(uint32_t), makeShader(0));
+        cache.store(D3D9ShaderCacheKind::FixedFunctionVS, &keys[1], sizeof(uint32_t), makeShader(1));
+      }
+
+      // Flip a byte in the last payload
+      const uintmax_t fileSize = std::filesystem::file_size(kCachePath);
+      {
+        std::fstream file(kCachePath, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+        file.seekg(fileSize - 5);
+        char byte = 0;
+        file.read(&byte, 1);
+        byte ^= 0x40;
+        file.seekp(fileSize - 5);
+        file.write(&byte, 1);
+      }
+
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        check(cache.load() && cache.size() == 2, "corrupted payload dropped at load, payloads should be read lazily");
+
+        D3D9CachedShader result;
+        check(cache.find(D3D9ShaderCacheKind::FixedFunctionVS, &keys[0], sizeof(uint32_t), result) && equal(result, makeShader(0)), "intact entry lost");
+        check(!cache.find(D3D9ShaderCacheKind::FixedFunctionVS, &keys[1], sizeof(uint32_t), result), "corrupted entry accepted");
+        check(cache.getStatistics().numCorrupted == 1, "corruption not counted");
+
+        // The regenerated shader replaces the corrupted entry
+        cache.store(D3D9ShaderCacheKind::FixedFunctionVS, &keys[1], sizeof(uint32_t), makeShader(1));
+      }
+
+      D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+      D3D9CachedShader result;
+      check(cache.load() && cache.find(D3D9ShaderCacheKind::FixedFunctionVS, &keys[1], sizeof(uint32_t), result) && equal(result, makeShader(1)),
+            "corrupted entry not replaced");
+    }
+
+    void testTruncatedFile() {
+      const uint32_t keys[] = { 1, 2, 3 };
+
+      std::remove(kCachePath);
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        cache.load();
+        cache.store(D3D9ShaderCacheKind::FixedFunctionFS, &keys[0], sizeof(uint32_t), makeShader(0));
+        cache.store(D3D9ShaderCacheKind::FixedFunctionFS, &keys[1], sizeof(uint32_t), makeShader(1));
+      }
+
+      // A session that stopped in the middle of writing an entry
+      std::filesystem::resize_file(kCachePath, std::filesystem::file_size(kCachePath) - 3);
+
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        check(cache.load() && cache.size() == 1, "truncated entry loaded");
+        cache.store(D3D9ShaderCacheKind::FixedFunctionFS, &keys[2], sizeof(uint32_t), makeShader(2));
+      }
+
+      D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+      check(cache.load() && cache.size() == 2, "append after a truncated entry");
+      D3D9CachedShader result;
+      check(cache.find(D3D9ShaderCacheKind::FixedFunctionFS, &keys[2], sizeof(uint32_t), result) && equal(result, makeShader(2)), "entry appended after truncation lost");
+      check(!cache.find(D3D9ShaderCacheKind::FixedFunctionFS, &keys[1], sizeof(uint32_t), result), "truncated entry found");
+    }
+
+    void testSettingsMismatch() {
+      const uint32_t key = 1;
+
+      std::remove(kCachePath);
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        cache.load();
+        cache.store(D3D9ShaderCacheKind::SWVP, &key, sizeof(key), makeShader(0));
+      }
+      {
+        // Shaders generated with different settings are discarded, and the file is rewritten
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash + 1);
+        D3D9CachedShader result;
+        check(!cache.load() && !cache.find(D3D9ShaderCacheKind::SWVP, &key, sizeof(key), result), "settings mismatch accepted");
+        cache.store(D3D9ShaderCacheKind::SWVP, &key, sizeof(key), makeShader(1));
+      }
+
+      D3D9ShaderDiskCache cache(kCachePath, kSettingsHash + 1);
+      D3D9CachedShader result;
+      check(cache.load() && cache.size() == 1, "file not rewritten");
+      check(cache.find(D3D9ShaderCacheKind::SWVP, &key, sizeof(key), result) && equal(result, makeShader(1)), "rewritten entry");
+
+      // Version mismatch
+      {
+        std::fstream file(kCachePath, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+        const uint32_t version = D3D9ShaderDiskCacheHeader().version + 1;
+        file.seekp(offsetof(D3D9ShaderDiskCacheHeader, version));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+      }
+      D3D9ShaderDiskCache newerCache(kCachePath, kSettingsHash + 1);
+      check(!newerCache.load(), "version mismatch accepted");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,208 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <random>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_dirty_range_tracker.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_dirty_range_tracker.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testTaggedUpdates();
+      testCoalescing();
+      testDataUpdates();
+      testStaticScene();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    using Range = DirtyRangeTracker::Range;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Dirty range tracker test failed: ", message));
+      }
+    }
+
+    static bool equal(const std::vector<Range>& ranges, const std::vector<std::pair<uint32_t, uint32_t>>& expected) {
+      if (ranges.size() != expected.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < ranges.size(); i++) {
+        if (ranges[i].begin != expected[i].first || ranges[i].end != expected[i].second) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void testTaggedUpdates() {
+      DirtyRangeTracker tracker;
+
+      tracker.beginFrame(8);
+      for (uint32_t i = 0; i < 8; i++) {
+        tracker.update(i, i);
+      }
+      check(equal(tracker.getDirtyRanges(), { { 0, 8 } }), "first frame uploads everything");
+
+      tracker.beginFrame(10);
+      for (uint32_t i = 0; i < 10; i++) {
+        tracker.update(i, i == 2 || i == 3 ? 100 + i : i);
+      }
+      check(equal(tracker.getDirtyRanges(), { { 2, 4 }, { 8, 10 } }), "changed and grown elements");
+      check(tracker.getDirtyCount() == 4, "dirty count");
+
+      tracker.beginFrame(10);
+      for (uint32_t i = 0; i < 10; i++) {
+        tracker.update(i, i == 2 || i == 3 ? 100 + i : i);
+      }
+      check(tracker.getDirtyRanges().empty(), "unchanged frame uploads data");
+
+      // Shrinking the table keeps the remaining tags
+      tracker.beginFrame(4);
+      for (uint32_t i = 0; i < 4; i++) {
+        tracker.update(i, i == 2 || i == 3 ? 100 + i : i);
+      }
+      check(tracker.getDirtyRanges().empty(), "shrink dirtied elements");
+
+      tracker.invalidate();
+      tracker.beginFrame(4);
+      for (uint32_t i = 0; i < 4; i++) {
+        tracker.update(i, i);
+      }
+      check(equal(tracker.getDirtyRanges(), { { 0, 4 } }), "invalidate");
+    }
+
+    void testCoalescing() {
+      DirtyRangeTracker tracker;
+      tracker.beginFrame(32);
+      for (uint32_t i = 0; i < 32; i++) {
+        tracker.update(i, 0);
+      }
+
+      // Dirty elements: 1, 3, 4, 10, 20, 21, 31
+      tracker.beginFrame(32);
+      for (uint32_t i = 0; i < 32; i++) {
+        const bool dirty = i == 1 || i == 3 || i == 4 || i == 10 || i == 20 || i == 21 || i == 31;
+        tracker.update(i, dirty ? 1 : 0);
+      }
+
+      check(equal(tracker.getDirtyRanges(0), { { 1, 2 }, { 3, 5 }, { 10, 11 }, { 20, 22 }, { 31, 32 } }), "no gap");
+      check(equal(tracker.getDirtyRanges(1), { { 1, 5 }, { 10, 11 }, { 20, 22 }, { 31, 32 } }), "gap of 1");
+      check(equal(tracker.getDirtyRanges(5), { { 1, 11 }, { 20, 22 }, { 31, 32 } }), "gap of 5");
+      check(equal(tracker.getDirtyRanges(100), { { 1, 32 } }), "everything merged");
+
+      // 64 byte elements merge gaps of up to 4 elements
+      check(DirtyRangeTracker::getMaxCoalesceGap(64) == 4, "gap for 64 byte elements");
+      const std::vector<Range> ranges = tracker.getDirtyRanges(DirtyRangeTracker::getMaxCoalesceGap(64));
+      check(equal(ranges, { { 1, 5 }, { 10, 11 }, { 20, 22 }, { 31, 32 } }), "default coalescing");
+      check(DirtyRangeTracker::getRangesSize(ranges, 64) == 8 * 64, "ranges size");
+    }
+
+    void testDataUpdates() {
+      const size_t stride = 16;
+      std::vector<uint8_t> table(8 * stride);
+      uint8_t element[stride];
+
+      DirtyRangeTracker tracker;
+      tracker.beginFrame(8);
+      for (uint32_t i = 0; i < 8; i++) {
+        memset(element, i, stride);
+        check(tracker.updateData(i, element, table.data(), stride), "first write not dirty");
+      }
+      check(table[5 * stride + 3] == 5, "element not copied");
+
+      tracker.beginFrame(8);
+      for (uint32_t i = 0; i < 8; i++) {
+        memset(element, i, stride);
+        if (i == 6) {
+          element[stride - 1] = 0xFF;
+        }
+        tracker.updateData(i, element, table.data(), stride);
+      }
+      check(equal(tracker.getDirtyRanges(), { { 6, 7 } }), "single changed byte");
+      check(table[6 * stride + stride - 1] == 0xFF, "changed element not copied");
+
+      // A recreated buffer needs all of the data even though the CPU copy is unchanged
+      tracker.invalidate();
+      tracker.beginFrame(8);
+      for (uint32_t i = 0; i < 8; i++) {
+        memcpy(element, table.data() + i * stride, stride);
+        tracker.updateData(i, element, table.data(), stride);
+      }
+      check(equal(tracker.getDirtyRanges(), { { 0, 8 } }), "invalidate with data updates");
+    }
+
+    void testStaticScene() {
+      // A mostly static table: fewer than 1% of the elements change per frame
+      const uint32_t numElements = 100000;
+      const size_t stride = 64;
+
+      std::mt19937 rng(7);
+      std::vector<uint32_t> generations(numElements, 0);
+
+      DirtyRangeTracker tracker;
+      tracker.beginFrame(numElements);
+      for (uint32_t i = 0; i < numElements; i++) {
+        tracker.update(i, generations[i]);
+      }
+
+      for (uint32_t frame = 0; frame < 4; frame++) {
+        for (uint32_t i = 0; i < numElements / 200; i++) {
+          generations[rng() % numElements]++;
+        }
+
+        tracker.beginFrame(numElements);
+        for (uint32_t i = 0; i < numElements; i++) {
+          tracker.update(i, generations[i]);
+        }
+
+        const std::vector<Range> ranges = tracker.getDirtyRanges(DirtyRangeTracker::getMaxCoalesceGap(stride));
+        const size_t uploadSize = DirtyRangeTracker::getRangesSize(ranges, stride);
+        check(tracker.getDirtyCount() > 0 && ranges.size() <= tracker.getDirtyCount(), "coalescing produced extra ranges");
+        check(uploadSize < numElements * stride / 20, "static scene uploads too much");
+
+        std::cout << "Frame " << frame << ": " << tracker.getDirtyCount() << " dirty elements, " << ranges.size()
+                  << " copies, " << uploadSize << " of " << numElements * stride << " bytes" << std::endl;
+      }
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,368 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "../../test_utils.h"
+#include "../../../src/d3d9/d3d9_shader_cache_util.h"
+#include "../../../src/dxso/dxso_modinfo.h"
+#include "../../../src/dxso/dxso_module.h"
+#include "../../../src/util/util_env.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_dxso_translation_cache.log");
+}
+
+namespace dxvk {
+  /**
+   * Translates DXSO shaders, stores the translations in a shader disk cache, and compares
+   * the restored shaders against a fresh translation.  Besides a few built-in shaders, every
+   * .dxso file dumped with DXVK_SHADER_DUMP_PATH in the directory given on the command line,
+   * or in DXVK_DXSO_CORPUS_PATH, is translated.
+   */
+  class TestApp {
+  public:
+    explicit TestApp(std::string corpusPath)
+    : m_corpusPath(std::move(corpusPath)) { }
+
+    void run() {
+      initOptions();
+      loadShaders();
+      testCacheKeys();
+      testTranslationCache();
+      std::remove(kCachePath);
+      std::cout << "All passed\n";
+    }
+
+  private:
+    static constexpr const char* kCachePath = "test_dxso_translation_cache.rtxcache";
+    static constexpr XXH64_hash_t kSettingsHash = 0x1234;
+
+    struct Shader {
+      std::string           name;
+      std::vector<uint32_t> bytecode;
+    };
+
+    struct Translation {
+      VkShaderStageFlagBits stage;
+      Sha1Hash              hash;
+      DxsoPermutations      shaders;
+      DxsoIsgn              isgn;
+      DxsoIsgn              osgn;
+      DxsoProgramInfo       info;
+      DxsoShaderMetaInfo    meta;
+      DxsoDefinedConstants  constants;
+      uint32_t              maxDefinedConst;
+      uint32_t              usedSamplers;
+      uint32_t              usedRTs;
+    };
+
+    std::string         m_corpusPath;
+    std::vector<Shader> m_shaders;
+    DxsoModuleInfo      m_moduleInfo;
+    D3D9ConstantLayout  m_vsLayout = { 256, 16, 16, 1 };
+    D3D9ConstantLayout  m_psLayout = { 224, 16, 16, 1 };
+
+    static void check(bool condition, const std::string& message) {
+      if (!condition) {
+        throw DxvkError(str::format("DXSO translation cache test failed: ", message));
+      }
+    }
+
+    void initOptions() {
+      DxsoOptions& options = m_moduleInfo.options;
+      options.useDemoteToHelperInvocation = true;
+      options.useSubgroupOpsForEarlyDiscard = false;
+      options.strictConstantCopies = false;
+      options.d3d9FloatEmulation = D3D9FloatEmulation::Enabled;
+      options.strictPow = true;
+      options.shaderModel = 3;
+      options.invariantPosition = true;
+      options.forceSamplerTypeSpecConstants = false;
+      options.vertexFloatConstantBufferAsSSBO = false;
+      options.longMad = false;
+      options.alphaTestWiggleRoom = false;
+      options.robustness2Supported = true;
+    }
+
+    void loadShaders() {
+      // vs_2_0: dcl_position v0; mov oPos, v0
+      m_shaders.push_back({ "vs_2_0_passthrough", {
+        0xFFFE0200,
+        0x0200001F, 0x80000000, 0x900F0000,
+        0x02000001, 0xC00F0000, 0x90E40000,
+        0x0000FFFF } });
+
+      // vs_3_0: passes the position and a texcoord through the output signature
+      m_shaders.push_back({ "vs_3_0_texcoord", {
+        0xFFFE0300,
+        0x0200001F, 0x80000000, 0x900F0000,
+        0x0200001F, 0x80000005, 0x900F0001,
+        0x0200001F, 0x80000000, 0xE00F0000,
+        0x0200001F, 0x80000005, 0xE00F0001,
+        0x02000001, 0xE00F0000, 0x90E40000,
+        0x02000001, 0xE00F0001, 0x90E40001,
+        0x0000FFFF } });
+
+      // ps_2_0: def c1, 1.0, 0.5, 0.25, 0.0; mov oC0, c1
+      m_shaders.push_back({ "ps_2_0_constant", {
+        0xFFFF0200,
+        0x05000051, 0xA00F0001, 0x3F800000, 0x3F000000, 0x3E800000, 0x00000000,
+        0x02000001, 0x800F0800, 0xA0E40001,
+        0x0000FFFF } });
+
+      if (m_corpusPath.empty()) {
+        return;
+      }
+
+      std::error_code ec;
+      for (const auto& entry : std::filesystem::directory_iterator(m_corpusPath, ec)) {
+        if (entry.path().extension() != ".dxso") {
+          continue;
+        }
+
+        std::ifstream file(entry.path(), std::ios_base::binary);
+        const size_t size = size_t(entry.file_size());
+
+        Shader shader;
+        shader.name = entry.path().stem().string();
+        shader.bytecode.resize((size + sizeof(uint32_t) - 1) / sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(shader.bytecode.data()), size);
+        check(file.good(), str::format("failed to read ", entry.path().string()));
+
+        m_shaders.push_back(std::move(shader));
+      }
+
+      std::cout << "Loaded " << m_shaders.size() << " shaders" << std::endl;
+    }
+
+    const D3D9ConstantLayout& getLayout(VkShaderStageFlagBits stage) const {
+      return stage == VK_SHADER_STAGE_VERTEX_BIT ? m_vsLayout : m_psLayout;
+    }
+
+    Translation translate(const Shader& shader) const {
+      DxsoReader reader(reinterpret_cast<const char*>(shader.bytecode.data()));
+      DxsoModule module(reader);
+
+      const DxsoAnalysisInfo analysis = module.analyze();
+
+      Translation result;
+      result.stage           = module.info().shaderStage();
+      result.hash            = Sha1Hash::compute(shader.bytecode.data(), analysis.bytecodeByteLength);
+      result.shaders         = module.compile(m_moduleInfo, shader.name, analysis, getLayout(result.stage));
+      result.isgn            = module.isgn();
+      result.osgn            = module.osgn();
+      result.info            = module.info();
+      result.meta            = module.meta();
+      result.constants       = module.constants();
+      result.maxDefinedConst = module.maxDefinedConstant();
+      result.usedSamplers    = module.usedSamplers();
+      result.usedRTs         = module.usedRTs();
+      return result;
+    }
+
+    // Mirrors what D3D9CommonShader stores for a translated shader
+    static D3D9CachedShaderModule toCachedModule(const Shader& shader, const Translation& translation) {
+      D3D9CachedShaderModule cached;
+      cached.bytecode.resize(shader.bytecode.size() * sizeof(uint32_t));
+      std::memcpy(cached.bytecode.data(), shader.bytecode.data(), cached.bytecode.size());
+
+      for (uint32_t i = 0; i < D3D9ShaderPermutations::Count; i++) {
+        if (translation.shaders[i] == nullptr) {
+          continue;
+        }
+        check(ToCachedShader(translation.shaders[i], cached.shaders.emplace_back()), str::format(shader.name, ": not cacheable"));
+        cached.permutationMask |= 1u << i;
+      }
+
+      ToCachedIsgn(translation.isgn, cached.isgn);
+      ToCachedIsgn(translation.osgn, cached.osgn);
+
+      cached.usedSamplers        = translation.usedSamplers;
+      cached.usedRTs             = translation.usedRTs;
+      cached.programType         = uint32_t(translation.info.type());
+      cached.minorVersion        = translation.info.minorVersion();
+      cached.majorVersion        = translation.info.majorVersion();
+      cached.needsConstantCopies = translation.meta.needsConstantCopies;
+      cached.maxConstIndexF      = translation.meta.maxConstIndexF;
+      cached.maxConstIndexI      = translation.meta.maxConstIndexI;
+      cached.maxConstIndexB      = translation.meta.maxConstIndexB;
+      cached.boolConstantMask    = translation.meta.boolConstantMask;
+
+      for (const auto& constant : translation.constants) {
+        D3D9CachedDefinedConstant& entry = cached.constants.emplace_back();
+        entry.uboIdx = constant.uboIdx;
+        std::memcpy(entry.float32, constant.float32, sizeof(entry.float32));
+      }
+
+      cached.maxDefinedConst = translation.maxDefinedConst;
+      return cached;
+    }
+
+    static bool equal(const DxsoIsgn& a, const DxsoIsgn& b) {
+      if (a.elemCount != b.elemCount) {
+        return false;
+      }
+      for (uint32_t i = 0; i < a.elemCount; i++) {
+        const DxsoIsgnEntry& x = a.elems[i];
+        const DxsoIsgnEntry& y = b.elems[i];
+        if (x.regNumber != y.regNumber || x.slot != y.slot || x.semantic != y.semantic
+         || x.mask != y.mask || x.centroid != y.centroid) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    static bool equal(const Rc<DxvkShader>& a, const Rc<DxvkShader>& b) {
+      const SpirvCodeBuffer codeA = a->compressedCode().decompress();
+      const SpirvCodeBuffer codeB = b->compressedCode().decompress();
+      const DxvkInterfaceSlots ifaceA = a->interfaceSlots();
+      const DxvkInterfaceSlots ifaceB = b->interfaceSlots();
+
+      return a->stage() == b->stage()
+          && codeA.size() == codeB.size()
+          && std::memcmp(codeA.data(), codeB.data(), codeA.size()) == 0
+          && a->resourceSlots().size() == b->resourceSlots().size()
+          && ifaceA.inputSlots == ifaceB.inputSlots
+          && ifaceA.outputSlots == ifaceB.outputSlots
+          && ifaceA.pushConstOffset == ifaceB.pushConstOffset
+          && ifaceA.pushConstSize == ifaceB.pushConstSize
+          && a->shaderConstants().sizeInBytes() == b->shaderConstants().sizeInBytes();
+    }
+
+    void testCacheKeys() {
+      const Sha1Hash hash = Sha1Hash::compute(m_shaders[0].bytecode.data(), m_shaders[0].bytecode.size() * sizeof(uint32_t));
+      const D3D9DxsoCacheKey key = MakeDxsoCacheKey(VK_SHADER_STAGE_VERTEX_BIT, hash, m_moduleInfo.options, m_vsLayout);
+
+      check(key.shaderKey().eq(DxvkShaderKey(VK_SHADER_STAGE_VERTEX_BIT, hash)), "shader key round trip");
+
+      const D3D9DxsoCacheKey same = MakeDxsoCacheKey(VK_SHADER_STAGE_VERTEX_BIT, hash, m_moduleInfo.options, m_vsLayout);
+      check(std::memcmp(&key, &same, sizeof(key)) == 0, "keys not deterministic");
+
+      // Anything the translation depends on must change the key
+      DxsoOptions options = m_moduleInfo.options;
+      options.longMad = !options.longMad;
+      const D3D9DxsoCacheKey otherOptions = MakeDxsoCacheKey(VK_SHADER_STAGE_VERTEX_BIT, hash, options, m_vsLayout);
+      check(std::memcmp(&key, &otherOptions, sizeof(key)) != 0, "options not part of the key");
+
+      D3D9ConstantLayout layout = m_vsLayout;
+      layout.floatCount = 8192;
+      const D3D9DxsoCacheKey otherLayout = MakeDxsoCacheKey(VK_SHADER_STAGE_VERTEX_BIT, hash, m_moduleInfo.options, layout);
+      check(std::memcmp(&key, &otherLayout, sizeof(key)) != 0, "constant layout not part of the key");
+
+      const D3D9DxsoCacheKey otherStage = MakeDxsoCacheKey(VK_SHADER_STAGE_FRAGMENT_BIT, hash, m_moduleInfo.options, m_vsLayout);
+      check(std::memcmp(&key, &otherStage, sizeof(key)) != 0, "stage not part of the key");
+    }
+
+    void testTranslationCache() {
+      std::vector<Translation> translations;
+      std::vector<D3D9DxsoCacheKey> keys;
+
+      std::remove(kCachePath);
+      {
+        D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+        cache.load();
+
+        for (const Shader& shader : m_shaders) {
+          Translation translation = translate(shader);
+          const D3D9DxsoCacheKey key = MakeDxsoCacheKey(translation.stage, translation.hash, m_moduleInfo.options, getLayout(translation.stage));
+
+          cache.store(D3D9ShaderCacheKind::Dxso, &key, sizeof(key), toCachedModule(shader, translation));
+
+          translations.push_back(std::move(translation));
+          keys.push_back(key);
+        }
+      }
+
+      D3D9ShaderDiskCache cache(kCachePath, kSettingsHash);
+      check(cache.load(), "reload");
+      check(cache.getKeys(D3D9ShaderCacheKind::Dxso).size() <= m_shaders.size(), "unexpected keys");
+
+      for (size_t i = 0; i < m_shaders.size(); i++) {
+        const std::string& name = m_shaders[i].name;
+
+        // The translation must be deterministic for the cache to be valid
+        const Translation fresh = translate(m_shaders[i]);
+        check(equal(fresh.shaders[0], translations[i].shaders[0]), str::format(name, ": translation not deterministic"));
+
+        D3D9CachedShaderModule cached;
+        check(cache.find(D3D9ShaderCacheKind::Dxso, &keys[i], sizeof(keys[i]), cached), str::format(name, ": not found"));
+        check(std::memcmp(cached.bytecode.data(), m_shaders[i].bytecode.data(), cached.bytecode.size()) == 0, str::format(name, ": bytecode"));
+
+        auto cachedShader = cached.shaders.begin();
+        for (uint32_t p = 0; p < D3D9ShaderPermutations::Count; p++) {
+          const bool present = (cached.permutationMask >> p) & 1u;
+          check(present == (fresh.shaders[p] != nullptr), str::format(name, ": permutation ", p, " mismatch"));
+
+          if (present) {
+            check(equal(FromCachedShader(*(cachedShader++)), fresh.shaders[p]), str::format(name, ": SPIR-V of permutation ", p, " differs"));
+          }
+        }
+
+        DxsoIsgn isgn;
+        DxsoIsgn osgn;
+        FromCachedIsgn(cached.isgn, isgn);
+        FromCachedIsgn(cached.osgn, osgn);
+        check(equal(isgn, fresh.isgn) && equal(osgn, fresh.osgn), str::format(name, ": signatures differ"));
+
+        check(cached.programType == uint32_t(fresh.info.type())
+           && cached.majorVersion == fresh.info.majorVersion()
+           && cached.minorVersion == fresh.info.minorVersion(), str::format(name, ": program info differs"));
+
+        check((cached.needsConstantCopies != 0) == fresh.meta.needsConstantCopies
+           && cached.maxConstIndexF == fresh.meta.maxConstIndexF
+           && cached.maxConstIndexI == fresh.meta.maxConstIndexI
+           && cached.maxConstIndexB == fresh.meta.maxConstIndexB
+           && cached.boolConstantMask == fresh.meta.boolConstantMask
+           && cached.usedSamplers == fresh.usedSamplers
+           && cached.usedRTs == fresh.usedRTs
+           && cached.maxDefinedConst == fresh.maxDefinedConst, str::format(name, ": metadata differs"));
+
+        check(cached.constants.size() == fresh.constants.size(), str::format(name, ": defined constants differ"));
+        for (size_t c = 0; c < cached.constants.size(); c++) {
+          check(cached.constants[c].uboIdx == fresh.constants[c].uboIdx
+             && std::memcmp(cached.constants[c].float32, fresh.constants[c].float32, sizeof(float) * 4) == 0,
+                str::format(name, ": defined constant ", c, " differs"));
+        }
+      }
+
+      check(cache.getStatistics().numHits == m_shaders.size(), "hits not counted");
+    }
+  };
+}
+
+int main(int argc, char** argv) {
+  try {
+    std::string corpusPath = argc > 1 ? argv[1] : dxvk::env::getEnvVar("DXVK_DXSO_CORPUS_PATH");
+    dxvk::TestApp testApp(std::move(corpusPath));
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
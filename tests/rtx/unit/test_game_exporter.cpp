@@ -0,0 +1,322 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+
+#include "../../test_utils.h"
+#include "../../../src/lssusd/game_exporter.h"
+#include "../../../src/lssusd/game_exporter_reduce.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_game_exporter.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      const std::filesystem::path basePath = std::filesystem::temp_directory_path() / "test_game_exporter";
+      std::filesystem::remove_all(basePath);
+
+      testIndexReduction();
+      testSharedIndexTables();
+      testDeterministicExport(basePath);
+      testProgress(basePath);
+      testCancel(basePath);
+
+      std::filesystem::remove_all(basePath);
+      std::cout << "All passed\n";
+    }
+
+  private:
+    static constexpr size_t kNumMaterials = 64;
+    static constexpr size_t kNumMeshes = 2048;
+    static constexpr size_t kSkinnedMeshInterval = 64;
+    static constexpr size_t kNumSphereLights = 16;
+
+    using FileTree = std::map<std::string, std::string>;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Game exporter test failed: ", message));
+      }
+    }
+
+    // A synthetic capture: quads with an unused vertex so the buffer reduction has work to do, a few
+    // skinned meshes, one instance per mesh and a handful of lights.
+    static lss::Export createExport(const std::filesystem::path& exportPath) {
+      const std::string basePath = exportPath.generic_string();
+
+      lss::Export exportData;
+      exportData.debugId = "test";
+      exportData.meta.windowTitle = "test";
+      exportData.meta.exeName = "test.exe";
+      exportData.meta.iconPath = basePath + "/icon.bmp";
+      exportData.meta.geometryHashRule = "positions,indices";
+      exportData.meta.metersPerUnit = 0.01;
+      exportData.meta.timeCodesPerSecond = 24.0;
+      exportData.meta.startTimeCode = 0.0;
+      exportData.meta.endTimeCode = 0.0;
+      exportData.meta.numFramesCaptured = 1;
+      exportData.meta.bReduceMeshBuffers = true;
+      exportData.meta.isZUp = false;
+      exportData.meta.bCorrectBakedTransforms = false;
+      exportData.baseExportPath = basePath;
+      exportData.bExportInstanceStage = true;
+      exportData.instanceStagePath = basePath + "/capture.usda";
+
+      exportData.camera.fov = 1.f;
+      exportData.camera.aspectRatio = 1.5f;
+      exportData.camera.nearPlane = 0.1f;
+      exportData.camera.farPlane = 1000.f;
+      exportData.camera.firstTime = 0.f;
+      exportData.camera.finalTime = 0.f;
+      exportData.camera.xforms.push_back({ 0.0, pxr::GfMatrix4d(1.0) });
+
+      for (size_t i = 0; i < kNumMaterials; ++i) {
+        lss::Material& material = exportData.materials[i];
+        material.matName = str::format("MAT_", i);
+        material.albedoTexPath = basePath + str::format("/textures/T_", i, ".dds");
+        material.enableOpacity = (i % 2) == 0;
+        material.sampler.addrModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        material.sampler.addrModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+        material.sampler.filter = VK_FILTER_LINEAR;
+        material.sampler.borderColor = {};
+      }
+
+      static const char* kPositionsHash = "positions";
+      for (size_t i = 0; i < kNumMeshes; ++i) {
+        lss::Mesh& mesh = exportData.meshes[i];
+        const float offset = static_cast<float>(i);
+        mesh.meshName = str::format("MESH_", i);
+        mesh.componentHashes[kPositionsHash] = i;
+        mesh.numVertices = 5;
+        mesh.numIndices = 6;
+        mesh.matId = i % kNumMaterials;
+        mesh.buffers.idxBufs[0.f] = lss::Buf<lss::Index> { 0, 1, 2, 2, 1, 4 };
+        mesh.buffers.positionBufs[0.f] = lss::Buf<lss::Pos> {
+          lss::Pos(offset, 0.f, 0.f), lss::Pos(offset + 1.f, 0.f, 0.f), lss::Pos(offset, 1.f, 0.f),
+          lss::Pos(-1.f, -1.f, -1.f), lss::Pos(offset + 1.f, 1.f, 0.f) };
+        mesh.buffers.normalBufs[0.f] = lss::Buf<lss::Norm>(5, lss::Norm(0.f, 0.f, 1.f));
+        mesh.buffers.texcoordBufs[0.f] = lss::Buf<lss::Texcoord> {
+          lss::Texcoord(0.f, 0.f), lss::Texcoord(1.f, 0.f), lss::Texcoord(0.f, 1.f), lss::Texcoord(0.f, 0.f), lss::Texcoord(1.f, 1.f) };
+
+        if (i % kSkinnedMeshInterval == 0) {
+          mesh.numBones = 2;
+          mesh.bonesPerVertex = 1;
+          mesh.buffers.blendWeightBufs[0.f] = lss::Buf<lss::BlendWeight>(5, 1.f);
+          mesh.buffers.blendIndicesBufs[0.f] = lss::Buf<lss::BlendIdx> { 0, 1, 0, 0, 1 };
+        }
+
+        lss::Instance& instance = exportData.instances[i];
+        instance.instanceName = str::format("INST_", i);
+        instance.firstTime = 0.f;
+        instance.finalTime = 0.f;
+        instance.matId = mesh.matId;
+        instance.meshId = i;
+        instance.isSky = false;
+        instance.metadata = {};
+        pxr::GfMatrix4d xform(1.0);
+        xform.SetTranslateOnly(pxr::GfVec3d(0.0, offset, 0.0));
+        instance.xforms.push_back({ 0.0, xform });
+      }
+
+      for (size_t i = 0; i < kNumSphereLights; ++i) {
+        lss::SphereLight& light = exportData.sphereLights[i];
+        light.lightName = str::format("LIGHT_", i);
+        light.color[0] = light.color[1] = light.color[2] = 1.f;
+        light.radius = 1.f;
+        light.intensity = static_cast<float>(i);
+        light.firstTime = 0.f;
+        light.finalTime = 0.f;
+        light.xforms.push_back({ 0.0, pxr::GfMatrix4d(1.0) });
+      }
+
+      return exportData;
+    }
+
+    void testIndexReduction() {
+      std::mt19937 rng(11);
+      for (uint32_t iteration = 0; iteration < 100; ++iteration) {
+        const lss::Index numVertices = 1 + rng() % 500;
+        const size_t elemsPerIdx = 1 + rng() % 4;
+
+        lss::BufSet<lss::Index> idxBufSet;
+        lss::BufSet<float> weightBufSet;
+        for (uint32_t t = 0; t < 3; ++t) {
+          lss::Buf<lss::Index> idxBuf(3 * (rng() % 100));
+          for (lss::Index& idx : idxBuf) {
+            idx = rng() % numVertices;
+          }
+          idxBufSet[static_cast<float>(t)] = idxBuf;
+
+          // Vertex buffers don't have to be sampled at the same time codes as the index buffers
+          lss::Buf<float> weightBuf(numVertices * elemsPerIdx);
+          for (size_t i = 0; i < weightBuf.size(); ++i) {
+            weightBuf[i] = static_cast<float>(i + t * 10000);
+          }
+          weightBufSet[static_cast<float>(t) + 0.5f] = weightBuf;
+        }
+
+        const lss::ReducedIdxBufSet reduced = lss::reduceIdxBufferSet(idxBufSet);
+        const lss::BufSet<float> reducedWeights = lss::reduceBufferSet(weightBufSet, reduced, elemsPerIdx);
+
+        // Reference: the used vertices of each index buffer in ascending order, built independently of the reduction
+        std::map<float, std::set<lss::Index>> usedVerticesSet;
+        for (const auto& [timeCode, idxBuf] : idxBufSet) {
+          const std::set<lss::Index>& usedVertices = usedVerticesSet[timeCode] = std::set<lss::Index>(idxBuf.cbegin(), idxBuf.cend());
+          std::map<lss::Index, lss::Index> ogToRed;
+          for (const lss::Index ogIdx : usedVertices) {
+            const lss::Index redIdx = static_cast<lss::Index>(ogToRed.size());
+            ogToRed[ogIdx] = redIdx;
+          }
+
+          const lss::Buf<lss::Index>& redIdxBuf = reduced.bufSet.at(timeCode);
+          check(redIdxBuf.size() == idxBuf.size(), "reduced index count");
+          for (size_t i = 0; i < idxBuf.size(); ++i) {
+            check(redIdxBuf[i] == ogToRed[idxBuf[i]], "reduced index");
+          }
+          const lss::ReducedIdxBufSet::IdxTable expectedTable(usedVertices.cbegin(), usedVertices.cend());
+          check(reduced.getIdxTable(timeCode) == expectedTable, "index table");
+        }
+
+        for (const auto& [timeCode, weightBuf] : weightBufSet) {
+          // A vertex buffer uses the first index buffer at or after its time code, or the last one
+          auto iUsedVertices = usedVerticesSet.lower_bound(timeCode);
+          if (iUsedVertices == usedVerticesSet.end()) {
+            iUsedVertices = std::prev(iUsedVertices);
+          }
+          const std::set<lss::Index>& usedVertices = iUsedVertices->second;
+
+          const lss::Buf<float>& redWeightBuf = reducedWeights.at(timeCode);
+          check(redWeightBuf.size() == usedVertices.size() * elemsPerIdx, "reduced buffer size");
+          size_t redIdx = 0;
+          for (const lss::Index ogIdx : usedVertices) {
+            for (size_t elem = 0; elem < elemsPerIdx; ++elem) {
+              check(redWeightBuf[redIdx * elemsPerIdx + elem] == weightBuf[ogIdx * elemsPerIdx + elem], "reduced buffer contents");
+            }
+            ++redIdx;
+          }
+        }
+      }
+    }
+
+    void testSharedIndexTables() {
+      const lss::Buf<lss::Index> idxBuf { 7, 3, 9, 9, 3, 12 };
+      lss::BufSet<lss::Index> idxBufSet;
+      idxBufSet[0.f] = idxBuf;
+      idxBufSet[1.f] = lss::Buf<lss::Index> { 0, 1, 2 };
+      // Equal contents in a separate allocation
+      idxBufSet[2.f] = lss::Buf<lss::Index>(idxBuf.cbegin(), idxBuf.cend());
+
+      const lss::ReducedIdxBufSet reduced = lss::reduceIdxBufferSet(idxBufSet);
+      check(reduced.redToOgSet.at(0.f) == reduced.redToOgSet.at(2.f), "identical index buffers don't share a table");
+      check(reduced.redToOgSet.at(0.f) != reduced.redToOgSet.at(1.f), "different index buffers share a table");
+      check(reduced.bufSet.at(2.f) == lss::Buf<lss::Index> { 1, 0, 2, 2, 0, 3 }, "shared reduced indices");
+      check(*reduced.redToOgSet.at(0.f) == lss::ReducedIdxBufSet::IdxTable { 3, 7, 9, 12 }, "shared index table");
+    }
+
+    static FileTree readFileTree(const std::filesystem::path& path) {
+      FileTree tree;
+      for (const auto& entry : std::filesystem::recursive_directory_iterator(path)) {
+        if (!entry.is_regular_file()) {
+          continue;
+        }
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        tree[std::filesystem::relative(entry.path(), path).generic_string()] = contents.str();
+      }
+      return tree;
+    }
+
+    static FileTree exportWithThreads(const std::filesystem::path& path, uint32_t numThreads) {
+      lss::GameExporter::setNumWorkerThreads(numThreads);
+      std::cout << "Export with " << numThreads << " thread(s): ";
+      {
+        Timer timer;
+        check(lss::GameExporter::exportUsd(createExport(path)), "export failed");
+      }
+      return readFileTree(path);
+    }
+
+    void testDeterministicExport(const std::filesystem::path& basePath) {
+      const FileTree serial = exportWithThreads(basePath / "serial", 1);
+      const FileTree parallel = exportWithThreads(basePath / "parallel", 8);
+      const FileTree parallelAgain = exportWithThreads(basePath / "parallel_again", 8);
+
+      check(serial.count("capture.usda") == 1, "instance stage not written");
+      check(serial.size() > kNumMeshes + kNumMaterials, "stages missing");
+      check(serial.size() == parallel.size(), "parallel export wrote a different set of files");
+
+      for (const auto& [relPath, contents] : serial) {
+        auto parallelFile = parallel.find(relPath);
+        check(parallelFile != parallel.end(), "file missing from parallel export");
+        check(parallelFile->second == contents, "parallel export differs from serial export");
+      }
+      check(parallel == parallelAgain, "parallel export is not deterministic");
+    }
+
+    void testProgress(const std::filesystem::path& basePath) {
+      lss::GameExporter::setNumWorkerThreads(4);
+
+      lss::ExportProgress progress;
+      check(lss::GameExporter::exportUsd(createExport(basePath / "progress"), &progress), "export with progress failed");
+
+      const size_t numSkinned = (kNumMeshes + kSkinnedMeshInterval - 1) / kSkinnedMeshInterval;
+      check(progress.numAssetsTotal == kNumMaterials + kNumMeshes + numSkinned + kNumSphereLights, "asset total");
+      check(progress.numAssetsExported == progress.numAssetsTotal, "not every asset reported");
+      check(progress.getFraction() == 1.f, "progress fraction");
+    }
+
+    void testCancel(const std::filesystem::path& basePath) {
+      lss::GameExporter::setNumWorkerThreads(4);
+
+      lss::ExportProgress progress;
+      progress.bCancel = true;
+      check(!lss::GameExporter::exportUsd(createExport(basePath / "cancelled"), &progress), "cancelled export reported success");
+      check(progress.numAssetsExported == 0, "assets exported after cancellation");
+      for (const auto& [relPath, contents] : readFileTree(basePath / "cancelled")) {
+        check(relPath.rfind("meshes/", 0) != 0 && relPath.rfind("materials/mat_", 0) != 0, "stages written after cancellation");
+      }
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
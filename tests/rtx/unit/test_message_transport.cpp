@@ -0,0 +1,437 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Note: no test_utils.h, this test is also part of the headless tests and builds without Win32
+#include "../../../src/util/util_message_transport.h"
+
+namespace dxvk {
+  namespace {
+    enum Msg : uint32_t {
+      Data = 1,
+      Done,
+      Ping,
+      Pong,
+      Quit,
+    };
+
+    struct Summary {
+      uint64_t count;
+      uint64_t bytes;
+      uint64_t errors;
+    };
+
+    constexpr uint32_t NumThroughputMessages = 1000000;
+    constexpr uint32_t NumLatencyRoundTrips = 20000;
+    constexpr uint32_t BatchSize = 64;
+    constexpr uint32_t TimeoutMs = 10000;
+
+    uint32_t getPayloadSize(uint32_t index) {
+      return (index * 37u) % 257u;
+    }
+
+    void fillPayload(uint32_t index, uint8_t* data, uint32_t size) {
+      for (uint32_t i = 0; i < size; i++) {
+        data[i] = uint8_t(index + i);
+      }
+    }
+
+    bool checkPayload(uint32_t index, const uint8_t* data, uint32_t size) {
+      if (size != getPayloadSize(index)) {
+        return false;
+      }
+      for (uint32_t i = 0; i < size; i++) {
+        if (data[i] != uint8_t(index + i)) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /**
+     * \brief Receiving process
+     *
+     * Checks every data message, reports a summary when the
+     * sender is done and answers pings until told to quit.
+     */
+    int runChild(const std::string& name) {
+      SharedMemoryTransport toParent;
+      if (!toParent.createSender(name + "_up")) {
+        return 1;
+      }
+
+      SharedMemoryTransport fromParent;
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TimeoutMs);
+      while (!fromParent.openReceiver(name + "_down")) {
+        if (std::chrono::steady_clock::now() > deadline) {
+          return 2;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+
+      Summary summary = { };
+      bool quit = false;
+
+      while (!quit) {
+        if (!fromParent.waitForMessages(TimeoutMs)) {
+          return 3;
+        }
+
+        fromParent.receive([&] (uint32_t msg, const void* payload, uint32_t size) {
+          switch (msg) {
+          case Data:
+            summary.errors += checkPayload(uint32_t(summary.count), static_cast<const uint8_t*>(payload), size) ? 0 : 1;
+            summary.count += 1;
+            summary.bytes += size;
+            break;
+          case Done:
+            toParent.send(Done, &summary, sizeof(summary));
+            toParent.flush();
+            break;
+          case Ping:
+            toParent.send(Pong, payload, size);
+            toParent.flush();
+            break;
+          case Quit:
+            quit = true;
+            break;
+          default:
+            summary.errors += 1;
+          }
+        });
+      }
+
+      toParent.waitForDrain(TimeoutMs);
+      return 0;
+    }
+  }
+
+  class TestApp {
+  public:
+    explicit TestApp(std::string exePath)
+    : m_exePath(std::move(exePath)) { }
+
+    void run() {
+      testRing();
+      testBackPressure();
+      testWake();
+      testMalformedRecords();
+      testTwoProcesses();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    std::string m_exePath;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw std::runtime_error(std::string("Message transport test failed: ") + message);
+      }
+    }
+
+    static std::vector<uint8_t> createRingMemory(uint32_t capacity) {
+      return std::vector<uint8_t>(SharedMemoryRing::getRequiredSize(capacity) + 64);
+    }
+
+    static void* alignMemory(std::vector<uint8_t>& memory) {
+      return reinterpret_cast<void*>((reinterpret_cast<uintptr_t>(memory.data()) + 63) & ~uintptr_t(63));
+    }
+
+    void testRing() {
+      // Variable size records wrap around a small ring many times
+      std::vector<uint8_t> memory = createRingMemory(1024);
+      SharedMemoryRing producer(SharedMemoryRing::initialize(alignMemory(memory), 1024));
+      SharedMemoryRing consumer(SharedMemoryRing::attach(alignMemory(memory), SharedMemoryRing::getRequiredSize(1024)));
+
+      check(producer.getMaxPayloadSize() == 1024 / 4 - sizeof(SharedMemoryRing::RecordHeader), "max payload size");
+      const std::vector<uint8_t> oversized(producer.getMaxPayloadSize() + 1);
+      check(!producer.push(Data, oversized.data(), uint32_t(oversized.size())), "oversized payload accepted");
+
+      uint8_t payload[256];
+      uint32_t sent = 0;
+      uint32_t received = 0;
+      uint32_t errors = 0;
+
+      while (received < 10000) {
+        // Staged records are invisible until published
+        while (sent < 10000) {
+          const uint32_t size = getPayloadSize(sent) % (producer.getMaxPayloadSize() + 1);
+          fillPayload(sent, payload, size);
+          if (!producer.push(Data, payload, size)) {
+            break;
+          }
+          sent += 1;
+        }
+
+        check(!consumer.hasRecords(), "unpublished records visible");
+        producer.publish();
+
+        // Consume in small batches, each releases the space it read
+        while (consumer.hasRecords()) {
+          consumer.consume([&] (uint32_t msg, const void* data, uint32_t size) {
+            const uint32_t expected = getPayloadSize(received) % (producer.getMaxPayloadSize() + 1);
+            if (msg != Data || size != expected || (size && static_cast<const uint8_t*>(data)[0] != uint8_t(received))) {
+              errors += 1;
+            }
+            received += 1;
+          }, 7);
+        }
+      }
+
+      check(errors == 0, "ring records corrupted");
+      check(producer.isDrained() && !consumer.hasRecords() && !consumer.isBroken(), "ring not drained");
+    }
+
+    void testBackPressure() {
+      std::vector<uint8_t> memory = createRingMemory(256);
+      SharedMemoryRing producer(SharedMemoryRing::initialize(alignMemory(memory), 256));
+      SharedMemoryRing consumer(SharedMemoryRing::attach(alignMemory(memory), SharedMemoryRing::getRequiredSize(256)));
+
+      uint32_t pushed = 0;
+      while (producer.push(Data, &pushed, sizeof(pushed))) {
+        pushed += 1;
+      }
+      check(pushed == 256 / 16, "full ring accepted records");
+
+      // Space is only returned once the consumer has read the records
+      producer.publish();
+      check(consumer.consume([] (uint32_t, const void*, uint32_t) { }, 2) == 2, "partial consume");
+      check(producer.push(Data, &pushed, sizeof(pushed)), "space not returned");
+      const uint8_t large[64] = { };
+      check(!producer.push(Data, large, sizeof(large)), "space returned twice");
+    }
+
+    void testWake() {
+      std::vector<uint8_t> memory = createRingMemory(256);
+      SharedMemoryRing producer(SharedMemoryRing::initialize(alignMemory(memory), 256));
+      SharedMemoryRing consumer(SharedMemoryRing::attach(alignMemory(memory), SharedMemoryRing::getRequiredSize(256)));
+
+      // Publishing only asks for a wake up while the consumer waits
+      const uint32_t value = 42;
+      producer.push(Data, &value, sizeof(value));
+      check(!producer.publish(), "wake requested without a waiting consumer");
+
+      // A consumer with pending records must not go to sleep
+      check(!consumer.beginWait(), "consumer slept on pending records");
+      check(!producer.publish(), "wait not ended");
+      consumer.consume([] (uint32_t, const void*, uint32_t) { });
+
+      check(consumer.beginWait(), "consumer could not wait on an empty ring");
+      producer.push(Data, &value, sizeof(value));
+      check(producer.publish(), "waiting consumer not woken");
+      consumer.endWait();
+      check(consumer.hasRecords() && !producer.publish(), "wait not ended");
+    }
+
+    void testMalformedRecords() {
+      std::vector<uint8_t> memory = createRingMemory(256);
+      SharedMemoryRing::Header* header = SharedMemoryRing::initialize(alignMemory(memory), 256);
+      SharedMemoryRing producer(header);
+
+      const uint32_t value = 42;
+      producer.push(Data, &value, sizeof(value));
+      producer.publish();
+
+      // A record claiming to be larger than the ring must not be read
+      SharedMemoryRing::RecordHeader record = { Data, 100000 };
+      std::memcpy(reinterpret_cast<uint8_t*>(header + 1), &record, sizeof(record));
+
+      SharedMemoryRing consumer(header);
+      check(consumer.consume([] (uint32_t, const void*, uint32_t) { }) == 0 && consumer.isBroken(), "malformed record read");
+
+      // Rings that were never initialized are rejected
+      std::vector<uint8_t> empty = createRingMemory(256);
+      check(SharedMemoryRing::attach(alignMemory(empty), SharedMemoryRing::getRequiredSize(256)) == nullptr, "uninitialized ring attached");
+    }
+
+    bool spawnChild(const std::string& name) {
+#ifdef _WIN32
+      std::string commandLine = "\"" + m_exePath + "\" --child " + name;
+      STARTUPINFOA startupInfo = { sizeof(startupInfo) };
+      PROCESS_INFORMATION processInfo = { };
+
+      if (!::CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo)) {
+        return false;
+      }
+
+      ::CloseHandle(processInfo.hThread);
+      m_child = processInfo.hProcess;
+#else
+      m_child = ::fork();
+
+      if (m_child == 0) {
+        ::_exit(runChild(name));
+      }
+#endif
+      return true;
+    }
+
+    int waitForChild() {
+#ifdef _WIN32
+      DWORD exitCode = 1;
+      ::WaitForSingleObject(m_child, INFINITE);
+      ::GetExitCodeProcess(m_child, &exitCode);
+      ::CloseHandle(m_child);
+      return int(exitCode);
+#else
+      int status = 0;
+      ::waitpid(m_child, &status, 0);
+      return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+    }
+
+    void testTwoProcesses() {
+#ifdef _WIN32
+      const std::string name = "dxvk_test_transport_" + std::to_string(::GetCurrentProcessId());
+#else
+      const std::string name = "dxvk_test_transport_" + std::to_string(::getpid());
+#endif
+
+      SharedMemoryTransport toChild;
+      check(toChild.createSender(name + "_down", 1u << 20), "create sender");
+      check(spawnChild(name), "spawn child process");
+
+      SharedMemoryTransport fromChild;
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TimeoutMs);
+      while (!fromChild.openReceiver(name + "_up")) {
+        check(std::chrono::steady_clock::now() < deadline, "child did not create its ring");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+
+      using Clock = std::chrono::high_resolution_clock;
+
+      // Throughput: batches of variable size messages
+      std::vector<uint8_t> payload(257);
+      uint64_t bytes = 0;
+
+      const auto t0 = Clock::now();
+      for (uint32_t i = 0; i < NumThroughputMessages; i++) {
+        const uint32_t size = getPayloadSize(i);
+        fillPayload(i, payload.data(), size);
+        check(toChild.send(Data, payload.data(), size), "send timed out");
+        bytes += size;
+
+        if ((i + 1) % BatchSize == 0) {
+          toChild.flush();
+        }
+      }
+
+      toChild.send(Done, nullptr, 0);
+      toChild.flush();
+
+      Summary summary = { };
+      bool done = false;
+      while (!done) {
+        check(fromChild.waitForMessages(TimeoutMs), "no summary from child");
+        fromChild.receive([&] (uint32_t msg, const void* data, uint32_t size) {
+          if (msg == Done && size == sizeof(summary)) {
+            std::memcpy(&summary, data, sizeof(summary));
+            done = true;
+          }
+        });
+      }
+      const auto t1 = Clock::now();
+
+      check(summary.count == NumThroughputMessages && summary.bytes == bytes, "messages lost");
+      check(summary.errors == 0, "messages corrupted");
+
+      // Latency: one message in flight at a time
+      std::vector<double> roundTrips;
+      roundTrips.reserve(NumLatencyRoundTrips);
+
+      for (uint32_t i = 0; i < NumLatencyRoundTrips; i++) {
+        const auto start = Clock::now();
+        toChild.send(Ping, &i, sizeof(i));
+        toChild.flush();
+
+        bool pong = false;
+        while (!pong) {
+          check(fromChild.waitForMessages(TimeoutMs), "no pong from child");
+          fromChild.receive([&] (uint32_t msg, const void* data, uint32_t size) {
+            uint32_t value = ~0u;
+            if (msg == Pong && size == sizeof(value)) {
+              std::memcpy(&value, data, sizeof(value));
+              pong = value == i;
+            }
+          });
+        }
+
+        roundTrips.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+      }
+
+      toChild.send(Quit, nullptr, 0);
+      toChild.flush();
+      check(waitForChild() == 0, "child process failed");
+
+      std::sort(roundTrips.begin(), roundTrips.end());
+      const double seconds = std::chrono::duration<double>(t1 - t0).count();
+
+      std::cout << "Throughput: " << uint64_t(NumThroughputMessages / seconds) << " messages/s, "
+                << uint64_t(double(bytes) / (1024.0 * 1024.0) / seconds) << " MB/s" << std::endl;
+      std::cout << "Round trip latency: median " << roundTrips[roundTrips.size() / 2] << " us, p99 "
+                << roundTrips[roundTrips.size() * 99 / 100] << " us" << std::endl;
+    }
+
+#ifdef _WIN32
+    HANDLE m_child = nullptr;
+#else
+    pid_t m_child = 0;
+#endif
+  };
+}
+
+int main(int argc, char** argv) {
+  if (argc > 2 && std::string(argv[1]) == "--child") {
+    return dxvk::runChild(argv[2]);
+  }
+
+  try {
+#ifdef _WIN32
+    char exePath[MAX_PATH] = { };
+    ::GetModuleFileNameA(nullptr, exePath, MAX_PATH);
+    dxvk::TestApp testApp(exePath);
+#else
+    dxvk::TestApp testApp(argv[0]);
+#endif
+    testApp.run();
+  }
+  catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,283 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_mod_layer_tracker.h"
+#include "../../../src/dxvk/rtx_render/rtx_mod_usd_reload.h"
+
+#include "../../../src/lssusd/usd_include_begin.h"
+#include <pxr/usd/usd/relationship.h>
+#include "../../../src/lssusd/usd_include_end.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_mod_layer_tracker.log");
+}
+
+namespace fs = std::filesystem;
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      m_modDir = fs::temp_directory_path() / "test_mod_layer_tracker";
+      fs::remove_all(m_modDir);
+      fs::create_directories(m_modDir);
+
+      writeMod();
+      testFileChanges();
+      testLayerSetChanges();
+      testDependencies();
+      testReload();
+
+      fs::remove_all(m_modDir);
+      std::cout << "All passed\n";
+    }
+
+  private:
+    fs::path m_modDir;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Mod layer tracker test failed: ", message));
+      }
+    }
+
+    std::string layerPath(const char* name) const {
+      return (m_modDir / name).string();
+    }
+
+    // Writes a layer, and moves its timestamp forward so the change is seen regardless of the file system's time resolution
+    void writeLayer(const char* name, const std::string& contents) const {
+      const fs::path path = m_modDir / name;
+      const bool existed = fs::exists(path);
+      const fs::file_time_type previousTime = existed ? fs::last_write_time(path) : fs::file_time_type();
+      {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << contents;
+      }
+      if (existed) {
+        fs::last_write_time(path, previousTime + std::chrono::seconds(2));
+      }
+    }
+
+    static std::string meshLayer(const char* mesh, const char* material) {
+      return str::format("#usda 1.0\n\nover \"RootNode\"\n{\n    over \"meshes\"\n    {\n        over \"", mesh,
+                         "\"\n        {\n            rel material:binding = </RootNode/Looks/", material, ">\n        }\n    }\n}\n");
+    }
+
+    void writeMod() const {
+      writeLayer("mod.usda", "#usda 1.0\n(\n    subLayers = [\n        @./characters.usda@,\n        @./props.usda@\n    ]\n)\n");
+      writeLayer("characters.usda", meshLayer("mesh_0123456789ABCDEF", "mat_Skin"));
+      writeLayer("props.usda", meshLayer("mesh_FEDCBA9876543210", "mat_Metal"));
+    }
+
+    std::vector<std::string> allLayers() const {
+      return { layerPath("mod.usda"), layerPath("characters.usda"), layerPath("props.usda") };
+    }
+
+    void testFileChanges() {
+      ModLayerTracker tracker;
+      tracker.setLayers(allLayers());
+      check(tracker.getLayerCount() == 3, "layer count");
+      check(!tracker.hasChanges() && tracker.collectChanges().empty(), "changes right after tracking");
+
+      // Saving a layer without changing it is not a change
+      writeLayer("props.usda", meshLayer("mesh_FEDCBA9876543210", "mat_Metal"));
+      check(!tracker.hasChanges(), "touched layer reported as changed");
+
+      writeLayer("props.usda", meshLayer("mesh_FEDCBA9876543210", "mat_Rust"));
+      check(tracker.hasChanges(), "edited layer not detected");
+      check(tracker.hasChanges(), "polling consumed the change");
+
+      const std::vector<std::string> changed = tracker.collectChanges();
+      check(changed.size() == 1 && changed[0] == layerPath("props.usda"), "edited layer not collected");
+      check(!tracker.hasChanges() && tracker.collectChanges().empty(), "change collected twice");
+
+      // A deleted layer is a change, as is it coming back
+      fs::remove(m_modDir / "characters.usda");
+      check(tracker.collectChanges() == std::vector<std::string> { layerPath("characters.usda") }, "deleted layer");
+      writeLayer("characters.usda", meshLayer("mesh_0123456789ABCDEF", "mat_Skin"));
+      check(tracker.collectChanges() == std::vector<std::string> { layerPath("characters.usda") }, "restored layer");
+    }
+
+    void testLayerSetChanges() {
+      ModLayerTracker tracker;
+      tracker.setLayers(allLayers());
+
+      writeLayer("lights.usda", "#usda 1.0\n");
+      std::vector<std::string> layers = allLayers();
+      layers.push_back(layerPath("lights.usda"));
+      layers.erase(layers.begin() + 2);
+
+      std::vector<std::string> addedOrRemoved = tracker.setLayers(layers);
+      std::sort(addedOrRemoved.begin(), addedOrRemoved.end());
+      check(addedOrRemoved == std::vector<std::string> { layerPath("lights.usda"), layerPath("props.usda") }, "added and removed layers");
+      check(tracker.getLayerCount() == 3 && tracker.collectChanges().empty(), "layer set");
+
+      // Layers that stay in the set keep their recorded state
+      writeLayer("mod.usda", "#usda 1.0\n(\n    subLayers = [\n        @./characters.usda@,\n        @./lights.usda@\n    ]\n)\n");
+      check(tracker.setLayers(layers).empty(), "unchanged layer set");
+      check(tracker.collectChanges() == std::vector<std::string> { layerPath("mod.usda") }, "edit before set change");
+    }
+
+    void testDependencies() {
+      const XXH64_hash_t kCharacter = 0x0123456789ABCDEF;
+      const XXH64_hash_t kProp = 0xFEDCBA9876543210;
+      const XXH64_hash_t kDoor = 0x1111;
+
+      ModLayerDependencies dependencies;
+
+      // Initial load, every root is new
+      dependencies.beginUpdate({});
+      check(dependencies.updateRoot(kCharacter, { layerPath("mod.usda"), layerPath("characters.usda") }), "new root");
+      check(dependencies.updateRoot(kProp, { layerPath("mod.usda"), layerPath("props.usda") }), "new root");
+      check(dependencies.updateRoot(kDoor, { layerPath("props.usda") }), "new root");
+      check(dependencies.endUpdate().empty() && dependencies.getRootCount() == 3, "initial load");
+
+      // Only the roots composed from the edited layer are dirty
+      dependencies.beginUpdate({ layerPath("characters.usda") });
+      check(dependencies.updateRoot(kCharacter, { layerPath("mod.usda"), layerPath("characters.usda") }), "edited root");
+      check(!dependencies.updateRoot(kProp, { layerPath("mod.usda"), layerPath("props.usda") }), "untouched root");
+      check(!dependencies.updateRoot(kDoor, { layerPath("props.usda") }), "untouched root");
+      check(dependencies.endUpdate().empty(), "no removed roots");
+
+      // A root that no longer has opinions in the edited layer still needs to be processed again
+      dependencies.beginUpdate({ layerPath("props.usda") });
+      check(dependencies.updateRoot(kProp, { layerPath("mod.usda") }), "root moved out of edited layer");
+      check(!dependencies.updateRoot(kCharacter, { layerPath("mod.usda"), layerPath("characters.usda") }), "untouched root");
+      // Roots sharing a hash accumulate their layers
+      check(!dependencies.updateRoot(kCharacter, { layerPath("lights.usda") }), "second root with the same hash");
+      const std::vector<XXH64_hash_t> removed = dependencies.endUpdate();
+      check(removed.size() == 1 && removed[0] == kDoor, "removed root");
+
+      dependencies.beginUpdate({ layerPath("lights.usda") });
+      check(dependencies.updateRoot(kCharacter, { layerPath("mod.usda") }), "accumulated layers lost");
+      check(!dependencies.updateRoot(kProp, { layerPath("mod.usda") }), "dependency on removed layer kept");
+      dependencies.endUpdate();
+    }
+
+    static std::string meshRootLayer(const char* mesh, const char* material) {
+      return str::format("#usda 1.0\n\nover \"RootNode\"\n{\n    over \"meshes\"\n    {\n        def Xform \"", mesh,
+                         "\"\n        {\n            rel material:binding = </RootNode/Looks/", material,
+                         ">\n\n            def Mesh \"mesh\"\n            {\n                int[] faceVertexCounts = [3]\n            }\n        }\n    }\n}\n");
+    }
+
+    static std::string reloadModLayer(const char* sublayers) {
+      return str::format("#usda 1.0\n(\n    subLayers = [", sublayers, "]\n)\n\ndef Xform \"RootNode\"\n{\n    def Scope \"meshes\"\n    {\n    }\n}\n");
+    }
+
+    void testReload() {
+      const XXH64_hash_t kCharacter = 0x0123456789ABCDEF;
+      const XXH64_hash_t kProp = 0xFEDCBA9876543210;
+      const XXH64_hash_t kDoor = 0x2222;
+
+      writeLayer("reload.usda", reloadModLayer("@./reload_characters.usda@, @./reload_props.usda@, @./reload_doors.usda@"));
+      writeLayer("reload_characters.usda", meshRootLayer("mesh_0123456789ABCDEF", "mat_Skin"));
+      writeLayer("reload_props.usda", meshRootLayer("mesh_FEDCBA9876543210", "mat_Metal"));
+      writeLayer("reload_doors.usda", meshRootLayer("mesh_0000000000002222", "mat_Wood"));
+
+      pxr::UsdStageRefPtr stage = pxr::UsdStage::Open(layerPath("reload.usda"));
+      check(bool(stage), "open stage");
+
+      // Stands in for the mesh replacements, records the material each root was processed with
+      std::unordered_map<XXH64_hash_t, std::string> replacements;
+      uint32_t numProcessed = 0;
+      auto process = [&](const pxr::UsdPrim& root, XXH64_hash_t hash) {
+        pxr::SdfPathVector targets;
+        root.GetRelationship(pxr::TfToken("material:binding")).GetTargets(&targets);
+        replacements[hash] = targets.empty() ? std::string() : targets[0].GetName();
+        ++numProcessed;
+      };
+
+      auto meshHash = [&](const char* root) {
+        return getStrongestOpinionatedPathHash(stage->GetPrimAtPath(pxr::SdfPath(str::format("/RootNode/meshes/", root, "/mesh"))));
+      };
+
+      UsdModReload reload;
+      reload.beginLoad(stage);
+      for (const pxr::UsdPrim& root : stage->GetPrimAtPath(pxr::SdfPath("/RootNode/meshes")).GetFilteredChildren(pxr::UsdPrimIsActive)) {
+        process(root, getModelHash(root));
+        reload.addRoot(UsdModReload::Meshes, root, getModelHash(root));
+      }
+      reload.endLoad();
+      check(numProcessed == 3 && reload.getRootCount() == 3 && reload.getLayerTracker().getLayerCount() == 4, "initial load");
+
+      const XXH64_hash_t characterMesh = meshHash("mesh_0123456789ABCDEF");
+      const XXH64_hash_t propMesh = meshHash("mesh_FEDCBA9876543210");
+
+      // Only the root composed from the edited sublayer is processed again
+      writeLayer("reload_props.usda", meshRootLayer("mesh_FEDCBA9876543210", "mat_Rust"));
+      const std::vector<std::string> changedLayers = reload.getLayerTracker().collectChanges();
+      check(changedLayers.size() == 1, "edited sublayer not detected");
+
+      UsdModReload::RootList roots;
+      check(reload.reloadLayers(changedLayers, roots), "incremental reload refused");
+
+      const UsdModReload::Roots& meshes = roots[UsdModReload::Meshes];
+      check(meshes.dirty.size() == 1 && meshes.dirty[0].second == kProp, "dirty roots");
+      check(meshes.dirtyHashes.size() == 1 && meshes.removed.empty(), "dirty hashes");
+      check(roots[UsdModReload::Materials].dirty.empty() && roots[UsdModReload::Lights].dirty.empty(), "other root types dirty");
+
+      // The meshes authored in the edited layer are processed again, the others are reused
+      check(reload.isStale(propMesh) && !reload.isStale(characterMesh), "stale meshes");
+
+      numProcessed = 0;
+      for (const auto& [root, hash] : meshes.dirty) {
+        process(root, hash);
+      }
+      reload.clearStaleObjects();
+
+      check(numProcessed == 1, "untouched roots processed again");
+      check(replacements[kProp] == "mat_Rust", "replacement not updated");
+      check(replacements[kCharacter] == "mat_Skin" && replacements[kDoor] == "mat_Wood", "untouched replacement changed");
+
+      // A root removed from its layer is reported as removed
+      writeLayer("reload_doors.usda", "#usda 1.0\n");
+      check(reload.reloadLayers(reload.getLayerTracker().collectChanges(), roots), "incremental reload refused");
+      check(roots[UsdModReload::Meshes].dirty.empty() && roots[UsdModReload::Meshes].removed == std::vector<XXH64_hash_t> { kDoor }, "removed root");
+
+      // A changed sublayer list needs a full reload
+      writeLayer("reload.usda", reloadModLayer("@./reload_props.usda@, @./reload_characters.usda@"));
+      check(!reload.reloadLayers(reload.getLayerTracker().collectChanges(), roots), "sublayer order change reloaded incrementally");
+
+      reload.clear();
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
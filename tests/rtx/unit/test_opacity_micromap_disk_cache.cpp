@@ -0,0 +1,324 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_opacity_micromap_disk_cache.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_opacity_micromap_disk_cache.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testIndexEviction();
+      testContainerRoundTrip();
+      testAppendAndCompaction();
+      testBakeSettingsMismatch();
+      testCorruptedPayload();
+      testVersionMismatch();
+      testTruncatedIndex();
+      std::remove(kCachePath);
+      std::remove(kAppendCachePath);
+      std::cout << "All passed\n";
+    }
+
+  private:
+    static constexpr const char* kCachePath = "test_opacity_micromap_disk_cache.rtxcache";
+    static constexpr const char* kAppendCachePath = "test_opacity_micromap_disk_cache_append.rtxcache";
+    static constexpr XXH64_hash_t kBakeSettingsHash = 0x1234;
+
+    static std::vector<uint8_t> makePayload(uint32_t size, uint8_t seed) {
+      std::vector<uint8_t> payload(size);
+      for (uint32_t i = 0; i < size; i++) {
+        payload[i] = static_cast<uint8_t>(seed + i * 7);
+      }
+      return payload;
+    }
+
+    static OpacityMicromapDiskCacheEntry makeEntry(XXH64_hash_t hash, uint32_t size) {
+      OpacityMicromapDiskCacheEntry entry;
+      entry.ommSrcHash = hash;
+      entry.payloadSize = size;
+      return entry;
+    }
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Opacity Micromap disk cache test failed: ", message));
+      }
+    }
+
+    void testIndexEviction() {
+      OpacityMicromapDiskCacheIndex index(300);
+
+      check(index.insert(makeEntry(1, 100)).empty(), "unexpected eviction");
+      check(index.insert(makeEntry(2, 100)).empty(), "unexpected eviction");
+      check(index.insert(makeEntry(3, 100)).empty(), "unexpected eviction");
+
+      // Entry 1 becomes the most recently used, so entry 2 is the next one to be evicted
+      index.touch(1);
+      std::vector<XXH64_hash_t> evicted = index.insert(makeEntry(4, 100));
+      check(evicted.size() == 1 && evicted[0] == 2, "LRU entry was not evicted");
+      check(index.getPayloadSize() == 300, "payload size not tracked");
+
+      // Replacing an entry must not double count its size
+      check(index.insert(makeEntry(4, 50)).empty(), "unexpected eviction on replace");
+      check(index.getPayloadSize() == 250 && index.size() == 3, "replace not tracked");
+
+      // Entries bigger than the cap are rejected
+      check(index.insert(makeEntry(5, 301)).empty() && index.find(5) == nullptr, "oversized entry admitted");
+
+      // Shrinking the cap evicts in LRU order
+      evicted = index.setMaxPayloadSize(100);
+      check(evicted.size() == 2 && evicted[0] == 3 && evicted[1] == 1, "cap shrink eviction order");
+      check(index.find(4) != nullptr, "most recently used entry evicted");
+
+      const std::vector<OpacityMicromapDiskCacheEntry> entries = index.getEntriesInLruOrder();
+      check(entries.size() == 1 && entries[0].ommSrcHash == 4, "LRU order");
+    }
+
+    void testContainerRoundTrip() {
+      std::remove(kCachePath);
+
+      {
+        OpacityMicromapDiskCache cache(kCachePath, 1 << 20);
+        check(!cache.load(), "loaded a missing container");
+
+        for (uint32_t i = 0; i < 16; i++) {
+          const std::vector<uint8_t> payload = makePayload(100 + i * 33, static_cast<uint8_t>(i));
+          cache.store(1000 + i, kBakeSettingsHash, i + 1, payload.data(), static_cast<uint32_t>(payload.size()));
+        }
+
+        // Pending payloads are readable before the flush
+        const OpacityMicromapDiskCacheEntry* entry = cache.find(1003, kBakeSettingsHash, 4);
+        std::vector<uint8_t> payload;
+        check(entry != nullptr && cache.read(*entry, payload) && payload == makePayload(100 + 3 * 33, 3), "pending read");
+
+        check(cache.flush(), "flush");
+        check(!cache.isDirty(), "dirty after flush");
+
+        // Reading payloads back from the freshly written container
+        entry = cache.find(1005, kBakeSettingsHash, 6);
+        check(entry != nullptr && cache.read(*entry, payload) && payload == makePayload(100 + 5 * 33, 5), "read after flush");
+        check(!cache.isDirty(), "read dirtied the cache");
+
+        // The LRU order changed by reads alone is written on shutdown
+        check(cache.flush(true), "shutdown flush");
+      }
+
+      {
+        std::ifstream stream(kCachePath, std::ios_base::binary);
+        std::vector<OpacityMicromapDiskCacheEntry> entries;
+        check(OpacityMicromapDiskCache::readIndex(stream, entries) && entries.size() == 16, "container index");
+
+        for (const OpacityMicromapDiskCacheEntry& entry : entries) {
+          check(entry.payloadOffset % OpacityMicromapDiskCache::kPayloadAlignment == 0, "payload alignment");
+        }
+
+        // 1005 was read last, so it's stored as the most recently used entry
+        check(entries.back().ommSrcHash == 1005, "LRU order persisted");
+      }
+
+      {
+        OpacityMicromapDiskCache cache(kCachePath, 1 << 20);
+        check(cache.load(), "load");
+        check(cache.getIndex().size() == 16, "entry count after load");
+
+        for (uint32_t i = 0; i < 16; i++) {
+          const OpacityMicromapDiskCacheEntry* entry = cache.find(1000 + i, kBakeSettingsHash, i + 1);
+          std::vector<uint8_t> payload;
+          check(entry != nullptr && cache.read(*entry, payload), "warm read");
+          check(payload == makePayload(100 + i * 33, static_cast<uint8_t>(i)), "payload mismatch");
+        }
+
+        check(cache.getStatistics().numHits == 16 && cache.getStatistics().numCorrupted == 0, "statistics");
+      }
+    }
+
+    static std::vector<OpacityMicromapDiskCacheEntry> readEntries(const char* path) {
+      std::ifstream stream(path, std::ios_base::binary);
+      std::vector<OpacityMicromapDiskCacheEntry> entries;
+      check(OpacityMicromapDiskCache::readIndex(stream, entries), "container index");
+      return entries;
+    }
+
+    static uint64_t getFileSize(const char* path) {
+      std::ifstream stream(path, std::ios_base::binary | std::ios_base::ate);
+      return static_cast<uint64_t>(stream.tellg());
+    }
+
+    void testAppendAndCompaction() {
+      std::remove(kAppendCachePath);
+
+      OpacityMicromapDiskCache cache(kAppendCachePath, 1 << 20);
+      cache.load();
+
+      for (uint32_t i = 0; i < 4; i++) {
+        const std::vector<uint8_t> payload = makePayload(1000, static_cast<uint8_t>(i));
+        cache.store(2000 + i, kBakeSettingsHash, 1, payload.data(), static_cast<uint32_t>(payload.size()));
+      }
+      check(cache.flush(), "flush");
+
+      std::unordered_map<XXH64_hash_t, uint64_t> offsets;
+      for (const OpacityMicromapDiskCacheEntry& entry : readEntries(kAppendCachePath)) {
+        offsets[entry.ommSrcHash] = entry.payloadOffset;
+      }
+      const uint64_t firstSize = getFileSize(kAppendCachePath);
+
+      for (uint32_t i = 4; i < 6; i++) {
+        const std::vector<uint8_t> payload = makePayload(1000, static_cast<uint8_t>(i));
+        cache.store(2000 + i, kBakeSettingsHash, 1, payload.data(), static_cast<uint32_t>(payload.size()));
+      }
+      check(cache.flush(), "append flush");
+
+      // Payloads already on disk are left in place, only the new ones are written past the old end
+      const std::vector<OpacityMicromapDiskCacheEntry> entries = readEntries(kAppendCachePath);
+      check(entries.size() == 6, "appended entry count");
+      for (const OpacityMicromapDiskCacheEntry& entry : entries) {
+        auto iter = offsets.find(entry.ommSrcHash);
+        check(iter != offsets.end() ? iter->second == entry.payloadOffset : entry.payloadOffset >= firstSize, "payload moved by append");
+      }
+
+      // Evicting most entries leaves mostly dead space, which is compacted on a worker thread
+      cache.setMaxPayloadSize(2000);
+      check(cache.isDirty() && cache.flush(), "eviction flush");
+      check(cache.flush(true) && cache.getStatistics().numCompactions == 1, "container not compacted");
+
+      const uint64_t compactedSize = OpacityMicromapDiskCache::kPayloadBaseOffset + 2 * 1024 + 2 * sizeof(OpacityMicromapDiskCacheEntry);
+      check(getFileSize(kAppendCachePath) == compactedSize, "dead space left after compaction");
+
+      // The index follows the payloads to their new offsets
+      for (uint32_t i = 4; i < 6; i++) {
+        const OpacityMicromapDiskCacheEntry* entry = cache.find(2000 + i, kBakeSettingsHash, 1);
+        std::vector<uint8_t> payload;
+        check(entry != nullptr && cache.read(*entry, payload) && payload == makePayload(1000, static_cast<uint8_t>(i)), "read after compaction");
+      }
+
+      OpacityMicromapDiskCache reloaded(kAppendCachePath, 1 << 20);
+      check(reloaded.load() && reloaded.getIndex().size() == 2, "compacted container");
+    }
+
+    void testBakeSettingsMismatch() {
+      OpacityMicromapDiskCache cache(kCachePath, 1 << 20);
+      check(cache.load(), "load");
+      check(cache.find(1000, kBakeSettingsHash + 1, 1) == nullptr, "bake settings mismatch accepted");
+      check(cache.find(1000, kBakeSettingsHash, 2) == nullptr, "triangle count mismatch accepted");
+      check(cache.find(1000, kBakeSettingsHash, 1) != nullptr, "valid entry rejected");
+    }
+
+    void testCorruptedPayload() {
+      OpacityMicromapDiskCacheEntry target;
+      {
+        std::ifstream stream(kCachePath, std::ios_base::binary);
+        std::vector<OpacityMicromapDiskCacheEntry> entries;
+        check(OpacityMicromapDiskCache::readIndex(stream, entries), "container index");
+        target = entries.front();
+      }
+
+      // Flip a byte inside the first payload
+      {
+        std::fstream file(kCachePath, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+        file.seekg(target.payloadOffset);
+        char byte = 0;
+        file.read(&byte, 1);
+        byte ^= 0xFF;
+        file.seekp(target.payloadOffset);
+        file.write(&byte, 1);
+      }
+
+      OpacityMicromapDiskCache cache(kCachePath, 1 << 20);
+      check(cache.load(), "load");
+
+      const OpacityMicromapDiskCacheEntry* entry = cache.find(target.ommSrcHash, kBakeSettingsHash, target.numTriangles);
+      std::vector<uint8_t> payload;
+      check(entry != nullptr && !cache.read(*entry, payload), "corrupted payload accepted");
+      check(cache.getStatistics().numCorrupted == 1, "corruption not counted");
+      check(cache.getIndex().find(target.ommSrcHash) == nullptr, "corrupted entry retained");
+
+      // The corrupted entry is dropped when the entry table is rewritten
+      check(cache.flush(), "flush");
+      OpacityMicromapDiskCache reloaded(kCachePath, 1 << 20);
+      check(reloaded.load() && reloaded.getIndex().size() == 15, "container not compacted");
+    }
+
+    void testVersionMismatch() {
+      {
+        std::fstream file(kCachePath, std::ios_base::binary | std::ios_base::in | std::ios_base::out);
+        OpacityMicromapDiskCacheHeader header;
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        header.version += 1;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      }
+
+      OpacityMicromapDiskCache cache(kCachePath, 1 << 20);
+      check(!cache.load() && cache.getIndex().size() == 0, "incompatible container accepted");
+
+      // A stale container is replaced on the next flush
+      check(cache.isDirty() && cache.flush(), "flush");
+      OpacityMicromapDiskCache reloaded(kCachePath, 1 << 20);
+      check(reloaded.load() && reloaded.getIndex().size() == 0, "stale container not replaced");
+    }
+
+    void testTruncatedIndex() {
+      // A header claiming far more entries than the file holds must be rejected before the entry table is allocated
+      OpacityMicromapDiskCacheHeader header;
+      header.entryCount = UINT32_MAX;
+      header.entrySize = sizeof(OpacityMicromapDiskCacheEntry);
+      header.entryTableOffset = OpacityMicromapDiskCache::kPayloadBaseOffset;
+
+      const OpacityMicromapDiskCacheEntry entry = makeEntry(1, 64);
+      std::string data(reinterpret_cast<const char*>(&header), sizeof(header));
+      data.resize(OpacityMicromapDiskCache::kPayloadBaseOffset);
+      data.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+
+      std::istringstream stream(data);
+      std::vector<OpacityMicromapDiskCacheEntry> entries;
+      check(!OpacityMicromapDiskCache::readIndex(stream, entries) && entries.empty(), "oversized entry count accepted");
+
+      // Same for a table cut short by a single entry
+      header.entryCount = 2;
+      data.replace(0, sizeof(header), reinterpret_cast<const char*>(&header), sizeof(header));
+      std::istringstream shortStream(data);
+      check(!OpacityMicromapDiskCache::readIndex(shortStream, entries) && entries.empty(), "truncated entry table accepted");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,301 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_area_cache.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_rtx_area_cache.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      AreaSet areas;
+
+      testParseGraph();
+      testPrefetch(areas);
+      testEviction(areas);
+      testPinned(areas);
+      testFailedLoads(areas);
+      testConcurrentAccess(areas);
+      std::cout << "All passed\n";
+    }
+
+  private:
+    struct Area {
+      uint32_t id;
+      std::vector<uint32_t> values;
+    };
+
+    // Synthetic area files on disk, area n holds n values derived from its id
+    struct AreaSet {
+      static constexpr uint32_t Count = 32;
+
+      std::filesystem::path path;
+      std::atomic<uint32_t> loads[Count] = { };
+
+      AreaSet() {
+        path = std::filesystem::temp_directory_path() / "test_rtx_area_cache";
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+
+        // Odd areas above 20 have no file, like areas without lighting data
+        for (uint32_t id = 0; id < Count; id++) {
+          if (id > 20 && (id & 1))
+            continue;
+
+          std::ofstream file(path / (std::to_string(id) + ".area"));
+          for (uint32_t i = 0; i < id; i++)
+            file << expected(id, i) << "\n";
+        }
+      }
+
+      ~AreaSet() {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+      }
+
+      static uint32_t expected(uint32_t id, uint32_t i) {
+        return id * 1000 + i;
+      }
+
+      AreaCache<Area>::Loader loader() {
+        return [this](uint32_t id) -> std::shared_ptr<const Area> {
+          std::ifstream file(path / (std::to_string(id) + ".area"));
+
+          if (!file)
+            return nullptr;
+
+          auto area = std::make_shared<Area>();
+          area->id = id;
+
+          for (uint32_t value; file >> value; )
+            area->values.push_back(value);
+
+          loads[id]++;
+          return area;
+        };
+      }
+
+      void resetLoads() {
+        for (auto& count : loads)
+          count = 0;
+      }
+
+      static bool isValid(const std::shared_ptr<const Area>& area, uint32_t id) {
+        if (area == nullptr || area->id != id || area->values.size() != id)
+          return false;
+
+        for (uint32_t i = 0; i < id; i++) {
+          if (area->values[i] != expected(id, i))
+            return false;
+        }
+        return true;
+      }
+    };
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Area cache test failed: ", message));
+      }
+    }
+
+    void testParseGraph() {
+      auto graph = AreaCache<Area>::parseGraph("200:500; 173:501|502;;bad;12:;7:x;173:3");
+
+      check(graph.size() == 2, "malformed entries were not skipped");
+      check(graph[200] == std::vector<uint32_t>{ 500 }, "single neighbour was not parsed");
+      check(graph[173] == std::vector<uint32_t>{ 501, 502, 3 }, "neighbours of repeated entries were not merged");
+      check(AreaCache<Area>::parseGraph("").empty(), "empty graph has entries");
+    }
+
+    void testPrefetch(AreaSet& areas) {
+      areas.resetLoads();
+
+      AreaCache<Area> cache(areas.loader(), 8);
+      cache.setGraph(AreaCache<Area>::parseGraph("1:2|3;3:1|4"));
+      cache.start();
+
+      cache.prefetch(1);
+      cache.waitIdle();
+
+      check(cache.size() == 3, "area and neighbours were not prefetched");
+      for (uint32_t id : { 1u, 2u, 3u })
+        check(AreaSet::isValid(cache.tryGet(id), id), "prefetched area has wrong data");
+      check(cache.tryGet(4) == nullptr, "area outside of the graph was prefetched");
+
+      // Moving to a neighbour only loads what isn't cached yet
+      check(AreaSet::isValid(cache.get(3), 3), "cached area has wrong data");
+      cache.prefetch(3);
+      cache.waitIdle();
+
+      check(areas.loads[1] == 1 && areas.loads[3] == 1, "cached area was loaded again");
+      check(areas.loads[4] == 1, "new neighbour was not prefetched");
+
+      const auto stats = cache.getStats();
+      check(stats.hits == 1 && stats.misses == 0 && stats.loads == 4, "unexpected cache statistics");
+
+      cache.stop();
+    }
+
+    void testEviction(AreaSet& areas) {
+      areas.resetLoads();
+
+      // Without the thread, misses load on the calling thread
+      AreaCache<Area> cache(areas.loader(), 3);
+
+      const auto first = cache.get(1);
+      cache.get(2);
+      cache.get(3);
+      cache.get(1);
+      cache.get(4);
+
+      check(cache.size() == 3, "cache grew past its capacity");
+      check(cache.tryGet(2) == nullptr, "least recently used area was not evicted");
+      check(cache.tryGet(1) != nullptr, "recently used area was evicted");
+
+      // Snapshots outlive their eviction
+      for (uint32_t id = 5; id < 10; id++)
+        cache.get(id);
+
+      check(cache.size() == 3 && cache.tryGet(1) == nullptr, "areas were not evicted");
+      check(AreaSet::isValid(first, 1), "evicted snapshot was modified");
+
+      // Loading an evicted area again gives a new snapshot
+      check(cache.get(1) != first && areas.loads[1] == 2, "evicted area was not loaded again");
+
+      cache.setCapacity(1);
+      check(cache.size() == 1 && cache.tryGet(1) != nullptr, "shrinking the cache kept old areas");
+      check(cache.getStats().evictions == 9, "unexpected eviction count");
+    }
+
+    void testPinned(AreaSet& areas) {
+      AreaCache<Area> cache(areas.loader(), 2);
+
+      auto edited = std::make_shared<Area>(*cache.get(5));
+      edited->values.push_back(42);
+      cache.put(5, edited, true);
+
+      for (uint32_t id = 6; id < 12; id++)
+        cache.get(id);
+
+      check(cache.tryGet(5) == edited, "pinned area was evicted or reloaded");
+      check(cache.size() == 2, "unpinned areas were not evicted");
+
+      const auto pinned = cache.getPinned();
+      check(pinned.size() == 1 && pinned[0].first == 5 && pinned[0].second == edited, "pinned areas are wrong");
+
+      // More pinned areas than the capacity are all kept
+      cache.put(6, cache.get(6), true);
+      cache.put(7, cache.get(7), true);
+      check(cache.size() == 3 && cache.getPinned().size() == 3, "pinned areas were evicted over capacity");
+
+      // Unpinned areas are evicted again once over capacity
+      cache.unpin(5);
+      cache.unpin(6);
+      check(cache.getPinned().size() == 1 && cache.size() == 2, "unpinned areas were kept over capacity");
+      check(cache.tryGet(7) != nullptr, "pinned area was evicted");
+    }
+
+    void testFailedLoads(AreaSet& areas) {
+      AreaCache<Area> cache(areas.loader(), 4);
+
+      check(cache.get(21) == nullptr, "missing area has data");
+      check(cache.size() == 0, "missing area was cached");
+
+      AreaCache<Area> throwing([](uint32_t id) -> std::shared_ptr<const Area> {
+        throw std::runtime_error("corrupt area");
+      }, 4);
+
+      throwing.start();
+      throwing.prefetch(3);
+      throwing.waitIdle();
+      check(!throwing.isPending(3) && throwing.tryGet(3) == nullptr, "failed load is still pending");
+      check(throwing.get(3) == nullptr, "area that failed to load has data");
+      check(throwing.getStats().loads == 2, "failed load was not retried on access");
+    }
+
+    void testConcurrentAccess(AreaSet& areas) {
+      constexpr uint32_t numThreads = 4;
+      constexpr uint32_t numAccesses = 2000;
+
+      AreaCache<Area> cache(areas.loader(), 6);
+      cache.setGraph(AreaCache<Area>::parseGraph("0:1|2;1:2|3;2:3|4;3:4|5;4:5|6;5:6|7;6:7|0;7:0|1"));
+      cache.start();
+
+      std::atomic<uint32_t> errors = { 0 };
+      std::vector<std::thread> threads;
+
+      // One thread moves between areas as the game would, the others read like the render thread
+      for (uint32_t t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t] {
+          std::mt19937 rng(t);
+
+          for (uint32_t i = 0; i < numAccesses; i++) {
+            const uint32_t id = rng() % AreaSet::Count;
+
+            if (t == 0)
+              cache.prefetch(id % 8);
+
+            const auto area = cache.get(id);
+            const bool missing = id > 20 && (id & 1);
+
+            if (missing ? area != nullptr : !AreaSet::isValid(area, id))
+              errors++;
+          }
+        });
+      }
+
+      for (auto& thread : threads)
+        thread.join();
+
+      cache.waitIdle();
+      check(errors == 0, "concurrent access returned wrong data");
+      check(cache.size() <= 6, "cache grew past its capacity");
+
+      cache.stop();
+      check(cache.getStats().hits + cache.getStats().misses == numThreads * numAccesses, "accesses were not counted");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
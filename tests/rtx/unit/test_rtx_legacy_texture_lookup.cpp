@@ -0,0 +1,156 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+// Doesn't use test_utils.h, which depends on Win32, so that the test also builds headless, see tests/rtx/headless
+#include "../../../src/dxvk/rtx_render/rtx_legacy_texture_lookup.h"
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      // Synthetic PBRData folder with the layout of the game's asset packs
+      m_root = std::filesystem::temp_directory_path() / "test_rtx_legacy_texture_lookup";
+      std::filesystem::remove_all(m_root);
+
+      createMap("stage", "1a2b3c4d.a.rtex.dds");
+      createMap("stage", "1a2b3c4d_roughness.r.rtex.dds");
+      // Maps of a texture can be split across packs
+      createMap("stage_normals", "1a2b3c4d_normal_dx_OTH_Normal.n.rtex.dds");
+      createMap("emmodel", "beef.a.rtex.dds");
+      createMap("emmodel", "beef_height.h.rtex.dds");
+      createMap("emmodel", "beef_emissive.e.rtex.dds");
+      createMap("npc", "abc_metallic.m.rtex.dds");
+      // Files next to the packs are ignored
+      createMap("", "readme.txt");
+
+      try {
+        testFind();
+        testOrigin();
+        testFilter();
+      } catch (...) {
+        std::filesystem::remove_all(m_root);
+        throw;
+      }
+
+      std::filesystem::remove_all(m_root);
+      std::cout << "All passed\n";
+    }
+
+  private:
+    std::filesystem::path m_root;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw std::runtime_error(std::string("Legacy texture lookup test failed: ") + message);
+      }
+    }
+
+    void createMap(const char* pack, const char* name) {
+      std::filesystem::create_directories(m_root / pack);
+      std::ofstream(m_root / pack / name) << "DDS";
+    }
+
+    bool isIn(const std::optional<std::string>& path, const char* pack) const {
+      return path.has_value() && std::filesystem::path(*path).parent_path() == m_root / pack;
+    }
+
+    void testFind() {
+      LegacyTexturePaths paths = findLegacyTexturePaths(m_root, 0x1a2b3c4d);
+      check(isIn(paths.albedo, "stage"), "albedo map was not found");
+      check(isIn(paths.roughness, "stage"), "roughness map was not found");
+      check(isIn(paths.normal, "stage_normals"), "map in another pack was not found");
+      check(!paths.metallic && !paths.height && !paths.emissive, "missing maps were found");
+
+      paths = findLegacyTexturePaths(m_root, 0xbeef);
+      check(isIn(paths.albedo, "emmodel") && isIn(paths.height, "emmodel") && isIn(paths.emissive, "emmodel"), "maps were not found");
+
+      // Without an albedo map the other maps aren't used
+      paths = findLegacyTexturePaths(m_root, 0xabc);
+      check(!paths.albedo && !paths.metallic, "maps of a texture without albedo were found");
+
+      paths = findLegacyTexturePaths(m_root / "missing", 0xbeef);
+      check(!paths.albedo, "maps were found without a PBRData folder");
+    }
+
+    void testOrigin() {
+      check(getLegacyTextureOrigin(findLegacyTexturePaths(m_root, 0x1a2b3c4d).albedo) == TextureOrigin::Stage, "stage texture was not categorized");
+      check(getLegacyTextureOrigin(findLegacyTexturePaths(m_root, 0xbeef).albedo) == TextureOrigin::Emmodel, "emmodel texture was not categorized");
+      check(getLegacyTextureOrigin(std::string("PBRData/parts/1.a.rtex.dds")) == TextureOrigin::Parts, "parts texture was not categorized");
+      check(getLegacyTextureOrigin(std::nullopt) == TextureOrigin::None, "texture without maps has an origin");
+
+      LegacyMaterialFeature features = LegacyMaterialFeature::Default | LegacyMaterialFeature::BackFaceCulling;
+      float normalStrength = 1.0f;
+      applyLegacyOriginDefaults(TextureOrigin::Emmodel, features, normalStrength);
+      check(normalStrength == -1.0f, "emmodel normals were not flipped");
+      check((features & LegacyMaterialFeature::BackFaceCulling) == LegacyMaterialFeature::None, "emmodel is culled");
+
+      features = LegacyMaterialFeature::Default;
+      applyLegacyOriginDefaults(TextureOrigin::NPC, features, normalStrength);
+      check(features == (LegacyMaterialFeature::Default | LegacyMaterialFeature::NoFade | LegacyMaterialFeature::RejectDecal), "npc defaults were not applied");
+
+      features = LegacyMaterialFeature::Default;
+      applyLegacyOriginDefaults(TextureOrigin::Effect, features, normalStrength);
+      check(features == (LegacyMaterialFeature::Default | LegacyMaterialFeature::RejectDecal), "effect defaults were not applied");
+    }
+
+    void testFilter() {
+      const LegacyTexturePaths found = findLegacyTexturePaths(m_root, 0x1a2b3c4d);
+
+      LegacyTexturePaths paths = found;
+      filterLegacyTexturePaths(LegacyMaterialFeature::Default, false, paths);
+      check(paths.albedo && paths.normal && paths.roughness, "enabled maps were dropped");
+
+      paths = found;
+      filterLegacyTexturePaths(LegacyMaterialFeature::Albedo, false, paths);
+      check(paths.albedo && !paths.normal && !paths.roughness, "disabled maps were kept");
+
+      paths = found;
+      filterLegacyTexturePaths(LegacyMaterialFeature::Albedo, true, paths);
+      check(paths.normal && paths.roughness, "disabled maps were dropped in development builds");
+
+      paths = found;
+      filterLegacyTexturePaths(LegacyMaterialFeature::Default | LegacyMaterialFeature::Sky, true, paths);
+      check(paths.albedo && !paths.normal && !paths.roughness, "sky kept its pbr maps");
+
+      paths = findLegacyTexturePaths(m_root, 0xbeef);
+      filterLegacyTexturePaths(LegacyMaterialFeature::All | LegacyMaterialFeature::Particle, true, paths);
+      check(!paths.albedo && !paths.height && paths.emissive, "particle kept its maps");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
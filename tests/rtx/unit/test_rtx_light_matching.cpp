@@ -0,0 +1,212 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <iostream>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Doesn't use test_utils.h, which depends on Win32, so that the test also builds headless, see tests/rtx/headless
+#include "../../../src/dxvk/rtx_render/rtx_light_matching.h"
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testSimilarity();
+      testFindMostSimilar();
+      testSyntheticScene();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    // Light types as in RtLightType
+    static constexpr uint32_t kSphere = 0;
+    static constexpr uint32_t kRect = 1;
+    static constexpr uint32_t kDistant = 4;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw std::runtime_error(std::string("Light matching test failed: ") + message);
+      }
+    }
+
+    static LightMatchVector vec(float x, float y, float z) {
+      return LightMatchVector { x, y, z };
+    }
+
+    static LightMatchVector normalize(const LightMatchVector& v) {
+      const float length = std::sqrt(dot(v, v));
+      return LightMatchVector { v.x / length, v.y / length, v.z / length };
+    }
+
+    static RtLightMatchKey sphere(const LightMatchVector& position) {
+      RtLightMatchKey key;
+      key.type = kSphere;
+      key.position = position;
+      return key;
+    }
+
+    static RtLightMatchKey distant(const LightMatchVector& direction) {
+      RtLightMatchKey key;
+      key.type = kDistant;
+      key.distant = true;
+      key.direction = normalize(direction);
+      return key;
+    }
+
+    void testSimilarity() {
+      const RtLightMatchKey a = sphere(vec(0.0f, 0.0f, 0.0f));
+
+      check(getLightSimilarity(a, a, 1.0f) == 1.0f, "identical lights are not fully similar");
+      check(std::abs(getLightSimilarity(a, sphere(vec(0.5f, 0.0f, 0.0f)), 1.0f) - 0.5f) < 1e-6f, "similarity does not fall off with distance");
+      check(getLightSimilarity(a, sphere(vec(1.5f, 0.0f, 0.0f)), 1.0f) == kLightNotSimilar, "distant lights are similar");
+
+      RtLightMatchKey rect = a;
+      rect.type = kRect;
+      check(getLightSimilarity(a, rect, 1.0f) == kLightNotSimilar, "lights of different types are similar");
+
+      // Shaping has to match on both sides
+      RtLightMatchKey shaped = a;
+      shaped.shapingEnabled = true;
+      shaped.shapingDirection = vec(0.0f, 0.0f, 1.0f);
+      shaped.cosConeAngle = 0.5f;
+      check(getLightSimilarity(a, shaped, 1.0f) == kLightNotSimilar, "shaped and unshaped lights are similar");
+      check(getLightSimilarity(shaped, shaped, 1.0f) == 1.0f, "identical shaped lights are not similar");
+
+      RtLightMatchKey wider = shaped;
+      wider.cosConeAngle = 0.6f;
+      check(getLightSimilarity(shaped, wider, 1.0f) == kLightNotSimilar, "lights with different cones are similar");
+
+      RtLightMatchKey turned = shaped;
+      turned.shapingDirection = normalize(vec(0.0f, 0.2f, 1.0f));
+      check(getLightSimilarity(shaped, turned, 1.0f) == kLightNotSimilar, "lights with different axes are similar");
+
+      // Distant lights ignore the position and compare directions within 5 degrees
+      RtLightMatchKey sun = distant(vec(0.0f, -1.0f, 0.0f));
+      RtLightMatchKey movedSun = distant(vec(0.05f, -1.0f, 0.0f));
+      movedSun.position = vec(100.0f, 0.0f, 0.0f);
+      check(getLightSimilarity(sun, movedSun, 1.0f) > 0.99f, "slightly rotated distant light is not similar");
+      check(getLightSimilarity(sun, distant(vec(0.2f, -1.0f, 0.0f)), 1.0f) == kLightNotSimilar, "rotated distant light is similar");
+    }
+
+    void testFindMostSimilar() {
+      const std::vector<RtLightMatchKey> lights = {
+        sphere(vec(0.9f, 0.0f, 0.0f)),
+        sphere(vec(0.2f, 0.0f, 0.0f)),
+        sphere(vec(-0.2f, 0.0f, 0.0f)),
+        sphere(vec(5.0f, 0.0f, 0.0f)),
+      };
+      auto getKey = [](const RtLightMatchKey& key) { return key; };
+      auto all = [](const RtLightMatchKey&) { return true; };
+
+      float similarity;
+      auto found = findMostSimilarLight(lights.begin(), lights.end(), sphere(vec(0.0f, 0.0f, 0.0f)), 1.0f, getKey, all, &similarity);
+      check(found == lights.begin() + 1, "first of the closest lights was not found");
+      check(std::abs(similarity - 0.8f) < 1e-6f, "similarity of the found light is wrong");
+
+      found = findMostSimilarLight(lights.begin(), lights.end(), sphere(vec(0.0f, 0.0f, 0.0f)), 1.0f, getKey,
+        [&](const RtLightMatchKey& key) { return &key != &lights[1]; });
+      check(found == lights.begin() + 2, "filtered light was matched");
+
+      found = findMostSimilarLight(lights.begin(), lights.end(), sphere(vec(0.0f, 10.0f, 0.0f)), 1.0f, getKey, all, &similarity);
+      check(found == lights.end() && similarity == kLightNotSimilar, "light without similar candidates was matched");
+    }
+
+    // Lights of a scene as the game submits them, with hashes that change every frame and positions
+    // that jitter from precision loss. Some lights move, which has to keep their identity.
+    void testSyntheticScene() {
+      constexpr uint32_t numLights = 64;
+      constexpr uint32_t numFrames = 100;
+      constexpr float threshold = 0.5f;
+
+      std::mt19937 rng(7);
+      std::uniform_real_distribution<float> jitter(-0.01f, 0.01f);
+
+      struct SceneLight {
+        RtLightMatchKey key;
+        LightMatchVector velocity;
+      };
+
+      std::vector<SceneLight> scene;
+      for (uint32_t i = 0; i < numLights; i++) {
+        // A grid of lights further apart than the threshold, every fourth light moving out of the grid
+        SceneLight light;
+        light.key = (i % 8 == 7) ? distant(vec(float(i), -40.0f, 0.0f)) : sphere(vec(float(i % 8) * 4.0f, 0.0f, float(i / 8) * 4.0f));
+        light.velocity = (i % 4 == 0) ? vec(0.1f, 0.2f, 0.0f) : vec(0.0f, 0.0f, 0.0f);
+        scene.push_back(light);
+      }
+
+      // Tracked light per scene index, keyed by the hash of the frame it was last seen in
+      std::map<uint64_t, std::pair<uint32_t, RtLightMatchKey>> tracked;
+      uint64_t nextHash = 0;
+      uint32_t mismatches = 0;
+
+      for (uint32_t frame = 0; frame < numFrames; frame++) {
+        std::map<uint64_t, std::pair<uint32_t, RtLightMatchKey>> current;
+
+        for (uint32_t i = 0; i < numLights; i++) {
+          SceneLight& light = scene[i];
+
+          if (!light.key.distant) {
+            light.key.position.x += light.velocity.x + jitter(rng);
+            light.key.position.y += light.velocity.y + jitter(rng);
+            light.key.position.z += light.velocity.z + jitter(rng);
+          }
+
+          const auto found = findMostSimilarLight(tracked.begin(), tracked.end(), light.key, threshold,
+            [](const auto& pair) { return pair.second.second; },
+            [](const auto&) { return true; });
+
+          if (frame > 0 && (found == tracked.end() || found->second.first != i)) {
+            mismatches++;
+          }
+
+          if (found != tracked.end()) {
+            tracked.erase(found);
+          }
+
+          current.emplace(nextHash++, std::make_pair(i, light.key));
+        }
+
+        check(tracked.empty(), "lights of the previous frame were left unmatched");
+        tracked = std::move(current);
+      }
+
+      check(mismatches == 0, "lights were matched to the wrong light of the previous frame");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,242 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_option_snapshot.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_rtx_option_snapshot.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testPublish();
+      testCallbacks();
+      testConcurrentReaders();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    // Stand-ins for the live values of a few options, including a heap backed hash set
+    struct Options {
+      int counter = 0;
+      float scale = 0.0f;
+      std::unordered_set<uint64_t> hashes;
+
+      uint32_t counterIndex;
+      uint32_t scaleIndex;
+      uint32_t hashesIndex;
+
+      explicit Options(RtxOptionPublisher& publisher)
+        : counterIndex(publisher.addOption(&counter))
+        , scaleIndex(publisher.addOption(&scale))
+        , hashesIndex(publisher.addOption(&hashes)) { }
+
+      // Writes a set of values that readers can check for consistency
+      void write(int value) {
+        counter = value;
+        scale = float(value) * 2.0f;
+        hashes.clear();
+        for (int i = 0; i <= value % 16; i++) {
+          hashes.insert(uint64_t(value) * 16 + i);
+        }
+      }
+    };
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Option snapshot test failed: ", message));
+      }
+    }
+
+    static bool isConsistent(const RtxOptionSnapshot& snapshot, const Options& options) {
+      const int* counter = snapshot.get<int>(options.counterIndex);
+      const float* scale = snapshot.get<float>(options.scaleIndex);
+      const auto* hashes = snapshot.get<std::unordered_set<uint64_t>>(options.hashesIndex);
+
+      if (counter == nullptr || scale == nullptr || hashes == nullptr) {
+        return false;
+      }
+
+      if (*scale != float(*counter) * 2.0f || hashes->size() != size_t(*counter % 16 + 1)) {
+        return false;
+      }
+
+      for (int i = 0; i <= *counter % 16; i++) {
+        if (hashes->count(uint64_t(*counter) * 16 + i) == 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void testPublish() {
+      RtxOptionPublisher publisher;
+      Options options(publisher);
+
+      check(publisher.getGeneration() == 0, "publisher starts with a snapshot");
+      check(publisher.acquire()->get<int>(options.counterIndex) == nullptr, "unpublished option has a value");
+
+      options.write(5);
+      check(publisher.publish() == 1, "first publish did not create a snapshot");
+
+      const auto first = publisher.acquire();
+      check(isConsistent(*first, options), "published values don't match");
+
+      // Nothing changed, the snapshot is kept
+      check(publisher.publish() == 1, "publish without changes created a snapshot");
+      check(publisher.acquire() == first, "publish without changes replaced the snapshot");
+
+      // Only the changed option is copied, the others are shared with the previous snapshot
+      options.scale = 3.0f;
+      check(publisher.publish() == 2, "changed option was not published");
+
+      const auto second = publisher.acquire();
+      check(*second->get<float>(options.scaleIndex) == 3.0f, "changed option has the old value");
+      check(*first->get<float>(options.scaleIndex) == 10.0f, "old snapshot was modified");
+      check(second->values[options.hashesIndex] == first->values[options.hashesIndex], "unchanged option was copied");
+
+      // Live writes are not visible until they are published
+      options.write(7);
+      check(*second->get<int>(options.counterIndex) == 5, "live write leaked into a snapshot");
+
+      std::shared_ptr<const RtxOptionSnapshot> cached = second;
+      check(!publisher.refresh(cached), "refresh replaced a current snapshot");
+      publisher.publish();
+      check(publisher.refresh(cached) && isConsistent(*cached, options), "refresh missed a new snapshot");
+    }
+
+    void testCallbacks() {
+      RtxOptionPublisher publisher;
+      Options options(publisher);
+      publisher.publish();
+
+      std::vector<int> counterValues;
+      uint32_t hashCalls = 0;
+      const uint64_t counterCallback = publisher.addCallback(options.counterIndex, [&](const void* value) {
+        counterValues.push_back(*static_cast<const int*>(value));
+      });
+      publisher.addCallback(options.hashesIndex, [&](const void*) { hashCalls++; });
+
+      options.counter = 1;
+      publisher.publish();
+      publisher.publish();
+      options.counter = 2;
+      options.counter = 3;
+      publisher.publish();
+
+      check(counterValues == std::vector<int>{ 1, 3 }, "callback was not called once per published change");
+      check(hashCalls == 0, "callback of an unchanged option was called");
+
+      options.hashes.insert(42);
+      publisher.publish();
+      check(hashCalls == 1, "hash set change was not notified");
+
+      publisher.removeCallback(counterCallback);
+      options.counter = 4;
+      publisher.publish();
+      check(counterValues.size() == 2, "removed callback was called");
+    }
+
+    void testConcurrentReaders() {
+      constexpr int numFrames = 20000;
+      constexpr uint32_t numReaders = 4;
+
+      RtxOptionPublisher publisher;
+      Options options(publisher);
+      options.write(0);
+      publisher.publish();
+
+      std::atomic<bool> done = { false };
+      std::atomic<uint32_t> inconsistent = { 0 };
+      std::atomic<uint32_t> callbackErrors = { 0 };
+      std::atomic<uint64_t> snapshotsSeen = { 0 };
+
+      // Callbacks run on the writer thread and see the value that was published
+      int lastNotified = 0;
+      publisher.addCallback(options.counterIndex, [&](const void* value) {
+        const int counter = *static_cast<const int*>(value);
+        if (counter != lastNotified + 1 || counter != options.counter) {
+          callbackErrors++;
+        }
+        lastNotified = counter;
+      });
+
+      std::vector<std::thread> readers;
+      for (uint32_t i = 0; i < numReaders; i++) {
+        readers.emplace_back([&] {
+          std::shared_ptr<const RtxOptionSnapshot> snapshot;
+          uint64_t lastGeneration = 0;
+
+          while (!done.load(std::memory_order_acquire)) {
+            if (publisher.refresh(snapshot)) {
+              // Generations only move forward
+              if (snapshot->generation < lastGeneration || !isConsistent(*snapshot, options)) {
+                inconsistent++;
+              }
+              lastGeneration = snapshot->generation;
+              snapshotsSeen++;
+            }
+          }
+        });
+      }
+
+      // The writer owns the live values, like the main thread does for the UI
+      for (int frame = 1; frame <= numFrames; frame++) {
+        options.write(frame);
+        publisher.publish();
+      }
+
+      done.store(true, std::memory_order_release);
+      for (auto& reader : readers) {
+        reader.join();
+      }
+
+      check(inconsistent == 0, "a reader saw an inconsistent snapshot");
+      check(callbackErrors == 0, "callbacks saw unexpected values");
+      check(lastNotified == numFrames, "callbacks missed a change");
+      check(isConsistent(*publisher.acquire(), options), "last snapshot doesn't match the live values");
+
+      std::cout << numFrames << " snapshots published, " << snapshotsSeen.load() << " acquired by " << numReaders << " readers" << std::endl;
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,150 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include "../../test_utils.h"
+#include "../../../src/dxvk/rtx_render/rtx_sparse_unique_cache.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_sparse_unique_cache.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testTrackAndFind();
+      testHashCollisions();
+      testFreeList();
+      testGenerations();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    // Only the low bits are hashed so that objects collide in the index
+    struct CollidingHashFn {
+      size_t operator() (const uint32_t& value) const {
+        return value % 4;
+      }
+    };
+
+    using Cache = SparseUniqueCache<uint32_t, CollidingHashFn>;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("SparseUniqueCache test failed: ", message));
+      }
+    }
+
+    void testTrackAndFind() {
+      Cache cache;
+      check(cache.track(10) == 0 && cache.track(20) == 1 && cache.track(10) == 0, "track indices");
+      check(cache.getActiveCount() == 2 && cache.getTotalCount() == 2, "counts");
+
+      uint32_t idx = UINT32_MAX;
+      check(cache.find(20, idx) && idx == 1, "find");
+      check(!cache.find(30, idx), "found untracked object");
+
+      // The callback is only invoked for objects not yet tracked
+      uint32_t numCallbacks = 0;
+      auto onFirstCache = [&](const uint32_t& in) { ++numCallbacks; return in; };
+      cache.track(10, onFirstCache);
+      cache.track(40, onFirstCache);
+      check(numCallbacks == 1 && cache.at(2) == 40, "first cache callback");
+
+      cache.clear();
+      check(cache.getTotalCount() == 0 && !cache.find(10, idx), "clear");
+    }
+
+    void testHashCollisions() {
+      Cache cache;
+      for (uint32_t i = 0; i < 32; i++) {
+        check(cache.track(i) == i, "colliding objects share an index");
+      }
+      for (uint32_t i = 0; i < 32; i++) {
+        uint32_t idx = UINT32_MAX;
+        check(cache.find(i, idx) && idx == i, "colliding object not found");
+      }
+
+      // Freeing from the head, middle and tail of a collision chain
+      cache.free(28);
+      cache.free(12);
+      cache.free(0);
+      for (uint32_t i = 0; i < 32; i++) {
+        uint32_t idx = UINT32_MAX;
+        const bool freed = i == 28 || i == 12 || i == 0;
+        check(cache.find(i, idx) != freed, "collision chain broken by free");
+      }
+    }
+
+    void testFreeList() {
+      Cache cache;
+      for (uint32_t i = 0; i < 8; i++) {
+        cache.track(100 + i);
+      }
+
+      cache.free(103);
+      cache.free(101);
+      cache.free(106);
+      cache.free(999);
+      check(cache.getActiveCount() == 5 && cache.getTotalCount() == 8, "counts after free");
+      check(cache.at(3) == 0, "freed slot not reset");
+
+      // Vacated slots are repopulated in FIFO order before the table grows
+      check(cache.track(200) == 3 && cache.track(201) == 1 && cache.track(202) == 6, "free list order");
+      check(cache.track(203) == 8, "table did not grow");
+      check(cache.getActiveCount() == 9, "active count");
+    }
+
+    void testGenerations() {
+      Cache cache;
+      const uint32_t idx = cache.track(5);
+      const uint32_t generation = cache.getGeneration(idx);
+
+      cache.track(5);
+      check(cache.getGeneration(idx) == generation, "generation changed on a hit");
+
+      cache.free(5);
+      const uint32_t freedGeneration = cache.getGeneration(idx);
+      check(freedGeneration != generation, "generation not renewed on free");
+
+      check(cache.track(6) == idx && cache.getGeneration(idx) != freedGeneration, "generation not renewed on reuse");
+
+      // Generations must not repeat after a clear, or dirty tracking would miss the new contents
+      const uint32_t beforeClear = cache.getGeneration(idx);
+      cache.clear();
+      check(cache.track(7) == 0 && cache.getGeneration(0) > beforeClear, "generation reused after clear");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,328 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <random>
+
+#include "../../test_utils.h"
+#include "../../../src/spirv/spirv_compression.h"
+#include "../../../src/util/util_env.h"
+#include "../../../src/util/util_lz4.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_spirv_compression.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    explicit TestApp(const char* corpusPath)
+    : m_corpusPath(corpusPath ? corpusPath : "") { }
+
+    void run() {
+      testSizes();
+      testValueRanges();
+      testLz4();
+      testCorruptedLz4();
+      testCorpus();
+      benchmark();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    std::string m_corpusPath;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("SPIR-V compression test failed: ", message));
+      }
+    }
+
+    // The original scalar encoder, the packed format must not change
+    // since compressed code is stored in the shader disk caches
+    static void referencePack(const std::vector<uint32_t>& data, std::vector<uint64_t>& mask, std::vector<uint64_t>& code) {
+      constexpr uint32_t NumMaskWords = 32;
+      const uint32_t size = uint32_t(data.size());
+
+      uint64_t dstWord  = 0;
+      uint32_t dstShift = 0;
+
+      for (uint32_t i = 0; i < size; i += NumMaskWords) {
+        uint64_t byteCounts = 0;
+
+        for (uint32_t w = 0; w < NumMaskWords && i + w < size; w++) {
+          uint64_t word = data[i + w];
+          uint64_t bytes = 0;
+
+          if      (word < (1 <<  8)) bytes = 0;
+          else if (word < (1 << 16)) bytes = 1;
+          else if (word < (1 << 24)) bytes = 2;
+          else                       bytes = 3;
+
+          byteCounts |= bytes << (2 * w);
+
+          uint32_t bits = 8 * bytes + 8;
+          uint32_t rem  = bit::pack(dstWord, dstShift, word, bits);
+
+          if (rem != 0) {
+            code.push_back(dstWord);
+
+            dstWord  = 0;
+            dstShift = 0;
+
+            bit::pack(dstWord, dstShift, word >> (bits - rem), rem);
+          }
+        }
+
+        mask.push_back(byteCounts);
+      }
+
+      if (dstShift)
+        code.push_back(dstWord);
+    }
+
+    // Mostly small IDs and opcodes with the occasional float constant
+    static std::vector<uint32_t> makeSpirvLike(uint32_t size, uint32_t seed) {
+      std::mt19937 rng(seed);
+      std::vector<uint32_t> data(size);
+
+      for (uint32_t i = 0; i < size; i++) {
+        const uint32_t kind = rng() % 16;
+
+        if (kind < 8)
+          data[i] = rng() % 0x100;
+        else if (kind < 13)
+          data[i] = rng() % 0x10000;
+        else if (kind < 14)
+          data[i] = rng() % 0x1000000;
+        else
+          data[i] = rng();
+      }
+
+      return data;
+    }
+
+    static void checkRoundTrip(const std::vector<uint32_t>& data, bool allowLz4, const char* message) {
+      const SpirvCodeBuffer code(uint32_t(data.size()), data.data());
+      const SpirvCompressedBuffer compressed(code, allowLz4);
+
+      std::vector<uint64_t> mask;
+      std::vector<uint64_t> packed;
+      referencePack(data, mask, packed);
+
+      check(compressed.getDwordCount() == data.size(), message);
+      check(compressed.getMask() == mask, message);
+      check(compressed.getCode() == packed, message);
+
+      const SpirvCodeBuffer decompressed = compressed.decompress();
+      check(decompressed.dwords() == data.size(), message);
+      check(data.empty() || !memcmp(decompressed.data(), data.data(), data.size() * sizeof(uint32_t)), message);
+
+      // Code restored from its packed form, as the disk caches do
+      const SpirvCompressedBuffer restored(compressed.getDwordCount(), compressed.getMask(), compressed.getCode());
+      const SpirvCodeBuffer restoredCode = restored.decompress();
+      check(data.empty() || !memcmp(restoredCode.data(), data.data(), data.size() * sizeof(uint32_t)), message);
+    }
+
+    void testSizes() {
+      const uint32_t sizes[] = { 0, 1, 2, 3, 4, 5, 7, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 1000, 4099 };
+
+      for (uint32_t size : sizes) {
+        checkRoundTrip(makeSpirvLike(size, size), false, "round trip");
+      }
+    }
+
+    void testValueRanges() {
+      // The boundaries of each byte count, in every position of a group of four
+      const uint32_t values[] = { 0u, 0xFFu, 0x100u, 0xFFFFu, 0x10000u, 0xFFFFFFu, 0x1000000u, 0x7FFFFFFFu, 0x80000000u, 0xFFFFFFFFu };
+
+      std::vector<uint32_t> data;
+      for (uint32_t a : values) {
+        for (uint32_t b : values) {
+          data.push_back(a);
+          data.push_back(b);
+          data.push_back(b);
+          data.push_back(a);
+        }
+      }
+
+      checkRoundTrip(data, false, "value ranges");
+
+      checkRoundTrip(std::vector<uint32_t>(37, 0xFFFFFFFFu), false, "all four byte words");
+      checkRoundTrip(std::vector<uint32_t>(37, 0u), false, "all one byte words");
+    }
+
+    void testLz4() {
+      // Real shaders repeat instruction sequences, which LZ4 picks up
+      std::vector<uint32_t> pattern = makeSpirvLike(64, 3);
+      std::vector<uint32_t> data;
+      for (uint32_t i = 0; i < 256; i++) {
+        data.insert(data.end(), pattern.begin(), pattern.end());
+        data.push_back(i);
+      }
+
+      const SpirvCodeBuffer code(uint32_t(data.size()), data.data());
+      const SpirvCompressedBuffer compressed(code, true);
+      check(compressed.isLz4Compressed(), "repetitive code not compressed with LZ4");
+      check(compressed.getAllocatedSize() < SpirvCompressedBuffer(code).getAllocatedSize(), "LZ4 tier uses more memory");
+      checkRoundTrip(data, true, "LZ4 round trip");
+
+      // Small and incompressible code keeps the packed form
+      check(!SpirvCompressedBuffer(SpirvCodeBuffer(uint32_t(pattern.size()), pattern.data()), true).isLz4Compressed(), "small code compressed with LZ4");
+
+      std::mt19937 rng(11);
+      std::vector<uint32_t> noise(8192);
+      for (uint32_t& word : noise) {
+        word = rng();
+      }
+      check(!SpirvCompressedBuffer(SpirvCodeBuffer(uint32_t(noise.size()), noise.data()), true).isLz4Compressed(), "noise compressed with LZ4");
+      checkRoundTrip(noise, true, "noise round trip");
+    }
+
+    void testCorruptedLz4() {
+      std::vector<uint8_t> data(20000);
+      for (size_t i = 0; i < data.size(); i++) {
+        data[i] = uint8_t((i * 7) % 61);
+      }
+
+      std::vector<uint8_t> compressed(lz4::compressBound(data.size()));
+      compressed.resize(lz4::compress(data.data(), data.size(), compressed.data()));
+
+      std::vector<uint8_t> output(data.size());
+      check(lz4::decompress(compressed.data(), compressed.size(), output.data(), output.size()) && output == data, "LZ4 codec round trip");
+      check(!lz4::decompress(compressed.data(), compressed.size(), output.data(), output.size() - 1), "short output accepted");
+      check(!lz4::decompress(compressed.data(), compressed.size() / 2, output.data(), output.size()), "truncated input accepted");
+
+      // Random corruption must only ever fail, never read or write out of bounds
+      std::mt19937 rng(5);
+      for (uint32_t i = 0; i < 1000; i++) {
+        std::vector<uint8_t> corrupted = compressed;
+        for (uint32_t j = 0; j < 4; j++) {
+          corrupted[rng() % corrupted.size()] = uint8_t(rng());
+        }
+        lz4::decompress(corrupted.data(), corrupted.size(), output.data(), output.size());
+      }
+    }
+
+    std::vector<std::filesystem::path> findCorpus() const {
+      std::string path = m_corpusPath;
+      if (path.empty()) {
+        path = env::getEnvVar("DXVK_SPIRV_CORPUS_PATH");
+      }
+
+      std::vector<std::filesystem::path> files;
+      std::error_code ec;
+
+      if (path.empty() || !std::filesystem::is_directory(path, ec)) {
+        return files;
+      }
+
+      for (const auto& entry : std::filesystem::recursive_directory_iterator(path, ec)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".spv") {
+          files.push_back(entry.path());
+        }
+      }
+
+      return files;
+    }
+
+    void testCorpus() {
+      const std::vector<std::filesystem::path> files = findCorpus();
+
+      for (const auto& file : files) {
+        std::ifstream stream(file, std::ios::binary);
+        const SpirvCodeBuffer code(stream);
+
+        const std::vector<uint32_t> data(code.data(), code.data() + code.dwords());
+        checkRoundTrip(data, false, "corpus round trip");
+        checkRoundTrip(data, true, "corpus LZ4 round trip");
+      }
+
+      std::cout << "Checked " << files.size() << " corpus shaders" << std::endl;
+    }
+
+    void benchmark() {
+      // A synthetic shader set, roughly the size a game loads over a session
+      std::vector<SpirvCodeBuffer> shaders;
+      size_t totalBytes = 0;
+
+      for (uint32_t i = 0; i < 256; i++) {
+        std::vector<uint32_t> pattern = makeSpirvLike(256 + i % 64, i);
+        std::vector<uint32_t> data;
+        for (uint32_t j = 0; j < 8; j++) {
+          data.insert(data.end(), pattern.begin(), pattern.end());
+          data.push_back(j);
+        }
+
+        shaders.emplace_back(uint32_t(data.size()), data.data());
+        totalBytes += data.size() * sizeof(uint32_t);
+      }
+
+      for (bool allowLz4 : { false, true }) {
+        std::vector<SpirvCompressedBuffer> compressed;
+        compressed.reserve(shaders.size());
+
+        const auto t0 = std::chrono::high_resolution_clock::now();
+        for (const SpirvCodeBuffer& shader : shaders) {
+          compressed.emplace_back(shader, allowLz4);
+        }
+
+        const auto t1 = std::chrono::high_resolution_clock::now();
+        size_t decodedDwords = 0;
+        for (const SpirvCompressedBuffer& shader : compressed) {
+          decodedDwords += shader.decompress().dwords();
+        }
+
+        const auto t2 = std::chrono::high_resolution_clock::now();
+        check(decodedDwords * sizeof(uint32_t) == totalBytes, "benchmark round trip");
+
+        size_t allocatedSize = 0;
+        for (const SpirvCompressedBuffer& shader : compressed) {
+          allocatedSize += shader.getAllocatedSize();
+        }
+
+        auto mbPerSecond = [totalBytes] (auto start, auto end) {
+          const double seconds = std::chrono::duration<double>(end - start).count();
+          return seconds > 0.0 ? double(totalBytes) / (1024.0 * 1024.0) / seconds : 0.0;
+        };
+
+        std::cout << (allowLz4 ? "Packed + LZ4" : "Packed") << ": encode " << uint32_t(mbPerSecond(t0, t1)) << " MB/s, decode "
+                  << uint32_t(mbPerSecond(t1, t2)) << " MB/s, " << allocatedSize << " of " << totalBytes << " bytes held" << std::endl;
+      }
+    }
+  };
+}
+
+int main(int argc, char** argv) {
+  try {
+    dxvk::TestApp testApp(argc > 1 ? argv[1] : nullptr);
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
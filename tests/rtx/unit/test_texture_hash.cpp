@@ -0,0 +1,147 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_fastops.h"
+#include "../../../src/util/util_threadpool.h"
+#include "../../../src/util/xxHash/xxhash.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_texture_hash.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testIdenticalHashes();
+      benchmark();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Texture hash test failed: ", message));
+      }
+    }
+
+    static std::vector<uint8_t> makeData(size_t size) {
+      std::mt19937_64 rng(size);
+      std::vector<uint8_t> data(size);
+      for (uint8_t& byte : data) {
+        byte = static_cast<uint8_t>(rng());
+      }
+      return data;
+    }
+
+    void testIdenticalHashes() {
+      // Sizes around the XXH3 block (1 KB) and stripe (64 bytes) boundaries, and the chunk boundaries
+      const size_t chunkSize = 4 * 1024;
+      const std::vector<uint8_t> data = makeData(chunkSize * 9 + 1024 + 77);
+      const size_t sizes[] = { 0, 1, 240, 241, 1024, 1025, chunkSize * 3, chunkSize * 4 - 1, chunkSize * 4, chunkSize * 4 + 1,
+                               chunkSize * 4 + 64, chunkSize * 5 + 1000, chunkSize * 8 + 1024, data.size() };
+
+      for (size_t size : sizes) {
+        const XXH64_hash_t expected = XXH3_64bits(data.data(), size);
+        check(fast::parallel_XXH3_64bits(data.data(), size, chunkSize) == expected, "chunked hash differs from XXH3_64bits");
+      }
+
+      // Default chunk size on a 4K RGBA8 mip
+      const std::vector<uint8_t> mip = makeData(4096 * 4096 * 4);
+      check(fast::parallel_XXH3_64bits(mip.data(), mip.size()) == XXH3_64bits(mip.data(), mip.size()), "4K mip hash differs from XXH3_64bits");
+    }
+
+    void benchmark() {
+      // A level load worth of textures, mostly 1K with a few 4K ones
+      std::vector<std::vector<uint8_t>> textures;
+      for (uint32_t i = 0; i < 32; i++) {
+        textures.push_back(makeData(i % 8 == 0 ? 4096 * 4096 * 4 : 1024 * 1024 * 4));
+      }
+
+      size_t totalSize = 0;
+      for (const auto& texture : textures) {
+        totalSize += texture.size();
+      }
+      const double totalMB = static_cast<double>(totalSize) / (1024 * 1024);
+
+      using Clock = std::chrono::high_resolution_clock;
+      auto msPerMB = [totalMB](Clock::time_point begin, Clock::time_point end) {
+        return std::chrono::duration<double, std::milli>(end - begin).count() / totalMB;
+      };
+
+      std::vector<XXH64_hash_t> expected(textures.size());
+      std::vector<XXH64_hash_t> hashes(textures.size());
+
+      std::cout << "Hashing " << textures.size() << " textures, " << totalMB << " MB" << std::endl;
+
+      Clock::time_point begin = Clock::now();
+      for (size_t i = 0; i < textures.size(); i++) {
+        expected[i] = XXH3_64bits(textures[i].data(), textures[i].size());
+      }
+      std::cout << "  XXH3_64bits on the main thread: " << msPerMB(begin, Clock::now()) << " ms/MB" << std::endl;
+
+      begin = Clock::now();
+      for (size_t i = 0; i < textures.size(); i++) {
+        hashes[i] = fast::parallel_XXH3_64bits(textures[i].data(), textures[i].size());
+      }
+      std::cout << "  parallel_XXH3_64bits on the main thread: " << msPerMB(begin, Clock::now()) << " ms/MB" << std::endl;
+      check(hashes == expected, "parallel hashes differ");
+
+      {
+        WorkerThreadPool<64, true, false> workers(2, "texture-hashing");
+        std::vector<Future<XXH64_hash_t>> futures;
+
+        begin = Clock::now();
+        for (const auto& texture : textures) {
+          futures.push_back(workers.Schedule([&texture] { return fast::parallel_XXH3_64bits(texture.data(), texture.size()); }));
+        }
+        const Clock::time_point scheduled = Clock::now();
+
+        for (size_t i = 0; i < futures.size(); i++) {
+          check(futures[i].valid(), "hash not scheduled");
+          hashes[i] = futures[i].get();
+        }
+        std::cout << "  scheduled on the texture hashing threads: " << msPerMB(begin, scheduled) << " ms/MB on the main thread, "
+                  << msPerMB(begin, Clock::now()) << " ms/MB until all hashes are ready" << std::endl;
+      }
+      check(hashes == expected, "scheduled hashes differ");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,322 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <thread>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_frame_arena.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_util_frame_arena.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testAlignment();
+      testFrameReuse();
+      testRewind();
+      testHeapFallback();
+      testContainers();
+      testStats();
+      testThreads();
+      benchmark();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    static constexpr size_t kBlockSize = 4096;
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Frame arena test failed: ", message));
+      }
+    }
+
+    static uintptr_t address(const void* p) {
+      return reinterpret_cast<uintptr_t>(p);
+    }
+
+    void testAlignment() {
+      FrameArena arena(kBlockSize);
+
+      void* a = arena.allocate(3, 1);
+      void* b = arena.allocate(8, 8);
+      void* c = arena.allocate(16, 64);
+      void* d = arena.allocate(1, 1);
+
+      check(address(a) % FrameArena::kBlockAlignment == 0, "first allocation not block aligned");
+      check(address(b) % 8 == 0, "8 byte alignment");
+      check(address(c) % 64 == 0, "64 byte alignment");
+      check(address(b) >= address(a) + 3, "allocations overlap");
+      check(address(c) >= address(b) + 8, "allocations overlap");
+      check(address(d) == address(c) + 16, "allocations not packed");
+
+      // Allocations that don't fit the rest of a block continue in a new one
+      std::vector<uint8_t*> ptrs;
+      for (uint32_t i = 0; i < 64; i++) {
+        uint8_t* p = static_cast<uint8_t*>(arena.allocate(kBlockSize / 4, 16));
+        std::memset(p, int(i), kBlockSize / 4);
+        ptrs.push_back(p);
+      }
+
+      for (uint32_t i = 0; i < ptrs.size(); i++) {
+        check(ptrs[i][0] == uint8_t(i) && ptrs[i][kBlockSize / 4 - 1] == uint8_t(i), "allocation overwritten");
+      }
+
+      check(arena.getStats().blocks >= 16, "blocks not added");
+    }
+
+    void testFrameReuse() {
+      FrameArena arena(kBlockSize);
+
+      void* first = arena.allocate(64, 16);
+
+      // Memory of a frame is kept until the frame is kFrameCount frames old
+      for (uint32_t i = 1; i < FrameArena::kFrameCount; i++) {
+        arena.nextFrame();
+        check(arena.allocate(64, 16) != first, "frame memory reused too early");
+      }
+
+      arena.nextFrame();
+      check(arena.allocate(64, 16) == first, "frame memory not reused");
+      check(arena.getFrameId() == FrameArena::kFrameCount, "frame id");
+
+      // A slot skipped for a few frames is reset on its next use too
+      for (uint32_t i = 0; i < 3 * FrameArena::kFrameCount; i++) {
+        arena.nextFrame();
+      }
+
+      check(arena.allocate(64, 16) == first, "stale frame not reset");
+      check(arena.getStats().blocks == FrameArena::kFrameCount, "blocks of a reused frame were reallocated");
+    }
+
+    void testRewind() {
+      FrameArena arena(kBlockSize);
+
+      void* a = arena.allocate(32, 16);
+      void* b = arena.allocate(48, 16);
+
+      // Only the last allocation is given back
+      arena.deallocate(a, 32, 16);
+      check(arena.allocate(16, 16) == static_cast<uint8_t*>(b) + 48, "freed an allocation that isn't the last one");
+
+      void* c = arena.allocate(128, 16);
+      arena.deallocate(c, 128, 16);
+      check(arena.allocate(128, 16) == c, "last allocation not given back");
+
+      // Temporaries freed in reverse order keep reusing the same memory
+      const uint64_t blocks = arena.getStats().blocks;
+
+      for (uint32_t i = 0; i < 10000; i++) {
+        void* x = arena.allocate(256, 16);
+        void* y = arena.allocate(512, 16);
+        arena.deallocate(y, 512, 16);
+        arena.deallocate(x, 256, 16);
+      }
+
+      check(arena.getStats().blocks == blocks, "rewound temporaries grew the arena");
+
+      // Other threads can't rewind, freeing there is a no-op
+      void* d = arena.allocate(64, 16);
+      std::thread([&] { arena.deallocate(d, 64, 16); }).join();
+      check(arena.allocate(16, 16) == static_cast<uint8_t*>(d) + 64, "other thread rewound the arena");
+    }
+
+    void testHeapFallback() {
+      FrameArena arena(kBlockSize);
+
+      void* large = arena.allocate(kBlockSize, 16);
+      void* aligned = arena.allocate(64, 256);
+
+      check(address(aligned) % 256 == 0, "over-aligned allocation");
+      check(arena.getStats().heapFallbacks == 2, "heap fallbacks not counted");
+      check(arena.getStats().allocations == 0, "heap fallbacks counted as arena allocations");
+      check(arena.getStats().blocks == 0, "heap fallbacks allocated blocks");
+
+      std::memset(large, 0, kBlockSize);
+
+      // Heap fallbacks are freed right away, ASan reports leaks otherwise
+      arena.deallocate(large, kBlockSize, 16);
+      arena.deallocate(aligned, 64, 256);
+    }
+
+    void testContainers() {
+      FrameArena arena(kBlockSize);
+      FrameAllocator<uint32_t> allocator(&arena);
+
+      frame_vector<uint32_t> vector(allocator);
+      for (uint32_t i = 0; i < 200; i++) {
+        vector.push_back(i);
+      }
+
+      for (uint32_t i = 0; i < 200; i++) {
+        check(vector[i] == i, "frame_vector content");
+      }
+
+      frame_unordered_map<uint32_t, frame_vector<uint32_t>> map(16, std::hash<uint32_t>(), std::equal_to<uint32_t>(), allocator);
+      for (uint32_t i = 0; i < 100; i++) {
+        map[i % 10].push_back(i);
+      }
+
+      check(map.size() == 10, "frame_unordered_map size");
+      check(map[3].size() == 10 && map[3][9] == 93, "frame_unordered_map content");
+      // Values created by the map get a default allocator, i.e. the arena of the renderer
+      check(map[3].get_allocator().getArena() == &FrameArena::get(), "nested container doesn't use the renderer arena");
+
+      // Vectors growing past a quarter block go to the heap and are freed with the container
+      frame_vector<uint64_t> large(kBlockSize, 1, FrameAllocator<uint64_t>(&arena));
+      check(arena.getStats().heapFallbacks == 1, "large container not on the heap");
+      large.clear();
+      large.shrink_to_fit();
+
+      // Heap allocators only compare equal to each other
+      frame_vector<uint32_t> heapVector(FrameAllocator<uint32_t>::heap());
+      heapVector.assign(1000, 7);
+      check(heapVector.get_allocator() == FrameAllocator<uint8_t>::heap(), "heap allocators differ");
+      check(heapVector.get_allocator() != allocator, "heap allocator equals arena allocator");
+      check(arena.getStats().heapFallbacks == 1, "heap allocator used the arena");
+    }
+
+    void testStats() {
+      FrameArena arena(kBlockSize);
+
+      arena.allocate(100, 4);
+      arena.allocate(200, 4);
+      void* large = arena.allocate(kBlockSize, 4);
+
+      FrameArena::Stats frame = arena.nextFrame();
+      check(frame.allocations == 2 && frame.bytes == 300, "frame allocations");
+      check(frame.heapFallbacks == 1 && frame.blocks == 1, "frame fallbacks and blocks");
+
+      arena.allocate(50, 4);
+      frame = arena.nextFrame();
+      check(frame.allocations == 1 && frame.bytes == 50 && frame.heapFallbacks == 0 && frame.blocks == 1, "second frame");
+
+      frame = arena.nextFrame();
+      check(frame.allocations == 0 && frame.bytes == 0, "empty frame");
+
+      const FrameArena::Stats total = arena.getStats();
+      check(total.allocations == 3 && total.bytes == 350 && total.heapFallbacks == 1 && total.blocks == 2, "total stats");
+
+      arena.deallocate(large, kBlockSize, 4);
+    }
+
+    void testThreads() {
+      FrameArena arena(kBlockSize);
+      constexpr uint32_t numThreads = 4;
+      constexpr uint32_t numFrames = 16;
+      constexpr uint32_t numAllocations = 1000;
+
+      for (uint32_t f = 0; f < numFrames; f++) {
+        std::vector<std::thread> threads;
+        std::atomic<bool> failed = { false };
+
+        for (uint32_t t = 0; t < numThreads; t++) {
+          threads.emplace_back([&, t] {
+            frame_vector<uint32_t*> ptrs { FrameAllocator<uint32_t*>(&arena) };
+
+            for (uint32_t i = 0; i < numAllocations; i++) {
+              uint32_t* p = static_cast<uint32_t*>(arena.allocate(sizeof(uint32_t) * 4, 16));
+              std::fill(p, p + 4, t * numAllocations + i);
+              ptrs.push_back(p);
+            }
+
+            for (uint32_t i = 0; i < numAllocations; i++) {
+              if (ptrs[i][0] != t * numAllocations + i || ptrs[i][3] != t * numAllocations + i) {
+                failed = true;
+              }
+            }
+          });
+        }
+
+        for (std::thread& thread : threads) {
+          thread.join();
+        }
+
+        check(!failed, "threads overwrote each other's allocations");
+
+        const FrameArena::Stats frame = arena.nextFrame();
+        check(frame.allocations >= numThreads * numAllocations, "thread allocations not counted");
+      }
+    }
+
+    void benchmark() {
+      constexpr uint32_t numFrames = 100;
+      constexpr uint32_t numDraws = 5000;
+      // Vertex ranges of MHFZ draws, from a few quads to skinned meshes
+      auto vertexCount = [](uint32_t draw) { return 64u + (draw * 2654435761u) % 8192u; };
+
+      FrameArena arena;
+      uint64_t sum = 0;
+
+      // Per-draw temporaries like the index bins of deduplicateSortIndices
+      std::cout << "std::vector, " << numFrames << " frames x " << numDraws << " draws" << std::endl;
+      {
+        std::cout << "  churn: ";
+        Timer timer;
+        for (uint32_t f = 0; f < numFrames; f++) {
+          for (uint32_t d = 0; d < numDraws; d++) {
+            std::vector<uint16_t> indices;
+            indices.resize(vertexCount(d), 0);
+            indices[d % indices.size()] = 1;
+            sum += indices.size() + indices[0];
+          }
+        }
+      }
+
+      std::cout << "frame_vector, " << numFrames << " frames x " << numDraws << " draws" << std::endl;
+      {
+        std::cout << "  churn: ";
+        Timer timer;
+        for (uint32_t f = 0; f < numFrames; f++) {
+          for (uint32_t d = 0; d < numDraws; d++) {
+            frame_vector<uint16_t> indices { FrameAllocator<uint16_t>(&arena) };
+            indices.resize(vertexCount(d), 0);
+            indices[d % indices.size()] = 1;
+            sum += indices.size() + indices[0];
+          }
+          arena.nextFrame();
+        }
+      }
+
+      std::cout << "  blocks: " << arena.getStats().blocks << std::endl;
+      check(sum != 0, "benchmark optimized out");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
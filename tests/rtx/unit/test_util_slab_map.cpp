@@ -0,0 +1,300 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <random>
+#include <unordered_map>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_slab_map.h"
+#include "../../../src/util/util_fast_cache.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_util_slab_map.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testBuckets();
+      testHandles();
+      testEraseWhileIterating();
+      testIndexDeletion();
+      benchmark();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    struct Value {
+      static inline int s_liveCount = 0;
+
+      explicit Value(uint32_t id_) : id(id_) { ++s_liveCount; }
+      ~Value() { --s_liveCount; }
+
+      uint32_t id;
+    };
+
+    // Stand-in for a BlasEntry sized payload
+    struct LargeValue {
+      uint64_t id;
+      uint8_t data[632];
+    };
+
+    // Tracks the bytes allocated by a std container
+    template<typename T>
+    struct CountingAllocator {
+      using value_type = T;
+
+      CountingAllocator(size_t* counter_) : counter(counter_) { }
+      template<typename U>
+      CountingAllocator(const CountingAllocator<U>& other) : counter(other.counter) { }
+
+      T* allocate(size_t n) {
+        *counter += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+      }
+
+      void deallocate(T* p, size_t n) {
+        *counter -= n * sizeof(T);
+        std::allocator<T>().deallocate(p, n);
+      }
+
+      template<typename U>
+      bool operator==(const CountingAllocator<U>& other) const { return counter == other.counter; }
+      template<typename U>
+      bool operator!=(const CountingAllocator<U>& other) const { return counter != other.counter; }
+
+      size_t* counter;
+    };
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Slab multimap test failed: ", message));
+      }
+    }
+
+    template<typename Map>
+    static std::vector<uint32_t> collectBucket(Map& map, XXH64_hash_t key) {
+      std::vector<uint32_t> ids;
+      for (auto& value : map.equal_range(key)) {
+        ids.push_back(value.id);
+      }
+      return ids;
+    }
+
+    void testBuckets() {
+      slab_multimap<Value, 4> map;
+      check(map.equal_range(1).empty(), "empty map lookup");
+
+      for (uint32_t i = 0; i < 10; i++) {
+        map.emplace(i % 3, i);
+      }
+
+      check(map.size() == 10, "size");
+      check(collectBucket(map, 0) == std::vector<uint32_t> { 0, 3, 6, 9 }, "bucket not in insertion order");
+      check(collectBucket(map, 1) == std::vector<uint32_t> { 1, 4, 7 }, "bucket contents");
+      check(map.equal_range(3).empty(), "missing key lookup");
+
+      map.clear();
+      check(map.size() == 0 && Value::s_liveCount == 0, "clear did not destroy values");
+      check(map.equal_range(0).empty(), "lookup after clear");
+    }
+
+    void testHandles() {
+      slab_multimap<Value, 4> map;
+
+      std::vector<Value*> pointers;
+      std::vector<slab_multimap<Value, 4>::handle> handles;
+      for (uint32_t i = 0; i < 64; i++) {
+        pointers.push_back(&map.emplace(i, i));
+        handles.push_back(map.equal_range(i).begin().getHandle());
+      }
+
+      // Growing the map must not move existing values
+      for (uint32_t i = 0; i < 64; i++) {
+        check(map.get(handles[i]) == pointers[i] && pointers[i]->id == i, "value moved");
+      }
+
+      map.erase(handles[5]);
+      check(map.get(handles[5]) == nullptr, "stale handle resolved");
+
+      // The freed slot is reused, but the old handle stays invalid
+      Value& reused = map.emplace(100, 100u);
+      check(&reused == pointers[5], "slot not reused");
+      check(map.get(handles[5]) == nullptr, "stale handle aliases a reused slot");
+      const auto reusedHandle = map.equal_range(100).begin().getHandle();
+      check(map.get(reusedHandle) == &reused, "handle for reused slot");
+
+      map.clear();
+      check(map.get(reusedHandle) == nullptr, "handle survived clear");
+    }
+
+    void testEraseWhileIterating() {
+      slab_multimap<Value, 8> map;
+      for (uint32_t i = 0; i < 100; i++) {
+        map.emplace(i % 7, i);
+      }
+
+      for (auto iter = map.begin(); iter != map.end(); ) {
+        if (iter->id % 2 == 0) {
+          iter = map.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+
+      check(map.size() == 50, "erase while iterating");
+      uint32_t count = 0;
+      for (Value& value : map) {
+        check(value.id % 2 == 1, "erased value visited");
+        ++count;
+      }
+      check(count == 50, "iteration count");
+
+      for (XXH64_hash_t key = 0; key < 7; key++) {
+        for (uint32_t id : collectBucket(map, key)) {
+          check(id % 7 == key && id % 2 == 1, "bucket chain after erase");
+        }
+      }
+    }
+
+    void testIndexDeletion() {
+      // Keys colliding in the index exercise the backward shift deletion
+      slab_multimap<Value> map;
+      std::vector<XXH64_hash_t> keys;
+      for (uint32_t i = 0; i < 40; i++) {
+        keys.push_back(static_cast<XXH64_hash_t>(i) << 48 | 5);
+      }
+      for (uint32_t i = 0; i < keys.size(); i++) {
+        map.emplace(keys[i], i);
+      }
+
+      for (uint32_t i = 0; i < keys.size(); i += 3) {
+        auto range = map.equal_range(keys[i]);
+        map.erase(range.begin().getHandle());
+      }
+
+      for (uint32_t i = 0; i < keys.size(); i++) {
+        const std::vector<uint32_t> bucket = collectBucket(map, keys[i]);
+        if (i % 3 == 0) {
+          check(bucket.empty(), "erased key still indexed");
+        } else {
+          check(bucket.size() == 1 && bucket[0] == i, "colliding key lost after deletion");
+        }
+      }
+    }
+
+    void benchmark() {
+      const uint32_t numEntries = 50000;
+      const uint32_t numLookups = 1000000;
+
+      std::mt19937_64 rng(0x5eed);
+      std::vector<XXH64_hash_t> keys(numEntries);
+      for (XXH64_hash_t& key : keys) {
+        key = rng();
+      }
+      std::vector<uint32_t> lookupOrder(numLookups);
+      for (uint32_t& idx : lookupOrder) {
+        idx = static_cast<uint32_t>(rng() % numEntries);
+      }
+
+      size_t multimapBytes = 0;
+      using CountedMultimap = std::unordered_multimap<XXH64_hash_t, LargeValue, XXH64_hash_passthrough, std::equal_to<XXH64_hash_t>,
+                                                      CountingAllocator<std::pair<const XXH64_hash_t, LargeValue>>>;
+      CountedMultimap multimap(1024, XXH64_hash_passthrough(), std::equal_to<XXH64_hash_t>(),
+                               CountingAllocator<std::pair<const XXH64_hash_t, LargeValue>>(&multimapBytes));
+      slab_multimap<LargeValue> slabMap;
+
+      uint64_t multimapSum = 0;
+      uint64_t slabSum = 0;
+
+      std::cout << "std::unordered_multimap, " << numEntries << " entries" << std::endl;
+      {
+        std::cout << "  insert: ";
+        Timer timer;
+        for (uint32_t i = 0; i < numEntries; i++) {
+          multimap.emplace(keys[i], LargeValue { i });
+        }
+      }
+      {
+        std::cout << "  lookup x" << numLookups << ": ";
+        Timer timer;
+        for (uint32_t idx : lookupOrder) {
+          auto range = multimap.equal_range(keys[idx]);
+          for (auto iter = range.first; iter != range.second; ++iter) {
+            multimapSum += iter->second.id;
+          }
+        }
+      }
+      {
+        std::cout << "  iterate: ";
+        Timer timer;
+        for (auto& pair : multimap) {
+          multimapSum += pair.second.id;
+        }
+      }
+      std::cout << "  memory: " << multimapBytes / 1024 << " KB" << std::endl;
+
+      std::cout << "slab_multimap, " << numEntries << " entries" << std::endl;
+      {
+        std::cout << "  insert: ";
+        Timer timer;
+        for (uint32_t i = 0; i < numEntries; i++) {
+          slabMap.emplace(keys[i], LargeValue { i });
+        }
+      }
+      {
+        std::cout << "  lookup x" << numLookups << ": ";
+        Timer timer;
+        for (uint32_t idx : lookupOrder) {
+          for (LargeValue& value : slabMap.equal_range(keys[idx])) {
+            slabSum += value.id;
+          }
+        }
+      }
+      {
+        std::cout << "  iterate: ";
+        Timer timer;
+        for (LargeValue& value : slabMap) {
+          slabSum += value.id;
+        }
+      }
+      std::cout << "  memory: " << slabMap.getMemoryFootprint() / 1024 << " KB" << std::endl;
+
+      check(multimapSum == slabSum, "benchmark results differ");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}
@@ -0,0 +1,284 @@
+/*
+* Copyright (c) 2025, NVIDIA CORPORATION. All rights reserved.
+*
+* Permission is hereby granted, free of charge, to any person obtaining a
+* copy of this software and associated documentation files (the "Software"),
+* to deal in the Software without restriction, including without limitation
+* the rights to use, copy, modify, merge, publish, distribute, sublicense,
+* and/or sell copies of the Software, and to permit persons to whom the
+* Software is furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in
+* all copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+* THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+* FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+* DEALINGS IN THE SOFTWARE.
+*/
+#include <cfloat>
+#include <random>
+#include <vector>
+
+#include "../../test_utils.h"
+#include "../../../src/util/util_fastops.h"
+#include "../../../src/util/util_timer.h"
+
+namespace dxvk {
+  // Note: Logger needed by some shared code used in this Unit Test.
+  Logger Logger::s_instance("test_vertex_bounds.log");
+}
+
+namespace dxvk {
+  class TestApp {
+  public:
+    void run() {
+      testLayouts();
+      testAlpha();
+      benchmark();
+      std::cout << "All passed\n";
+    }
+
+  private:
+    enum class ColorLayout {
+      None,
+      Packed,
+      Interleaved,
+      Strided,
+    };
+
+    // Vertex data sized so that the last position or color ends the buffer, reads past it are caught by ASan
+    struct Stream {
+      std::vector<uint8_t> positions;
+      std::vector<uint8_t> colors;
+      size_t positionStride = 0;
+      size_t colorStride = 0;
+      const uint8_t* pColors = nullptr;
+      uint32_t count = 0;
+    };
+
+    static void check(bool condition, const char* message) {
+      if (!condition) {
+        throw DxvkError(str::format("Vertex bounds test failed: ", message));
+      }
+    }
+
+    static size_t streamSize(uint32_t count, size_t stride, size_t elementSize) {
+      return count == 0 ? 0 : (count - 1) * stride + elementSize;
+    }
+
+    static Stream makeStream(std::mt19937& rng, uint32_t count, size_t positionStride, ColorLayout layout) {
+      std::uniform_real_distribution<float> value(-1000.f, 1000.f);
+
+      Stream stream;
+      stream.count = count;
+      stream.positionStride = positionStride;
+
+      // Interleaved colors follow the position within the vertex
+      const size_t size = streamSize(count, positionStride, layout == ColorLayout::Interleaved ? 16 : 12);
+      stream.positions.resize(size);
+      for (size_t i = 0; i < size; i++) {
+        stream.positions[i] = uint8_t(rng());
+      }
+
+      for (uint32_t i = 0; i < count; i++) {
+        float* position = reinterpret_cast<float*>(&stream.positions[i * positionStride]);
+        for (uint32_t c = 0; c < 3; c++) {
+          position[c] = value(rng);
+        }
+      }
+
+      switch (layout) {
+      case ColorLayout::None:
+        break;
+      case ColorLayout::Interleaved:
+        stream.colorStride = positionStride;
+        stream.pColors = stream.positions.data() + 12;
+        break;
+      case ColorLayout::Packed:
+      case ColorLayout::Strided:
+        stream.colorStride = layout == ColorLayout::Packed ? 4 : 12;
+        stream.colors.resize(streamSize(count, stream.colorStride, 4));
+        for (size_t i = 0; i < stream.colors.size(); i++) {
+          stream.colors[i] = uint8_t(rng());
+        }
+        stream.pColors = stream.colors.data();
+        break;
+      }
+
+      return stream;
+    }
+
+    // The loop D3D9Rtx::computeAxisAlignedBoundingBox ran before the kernel
+    static fast::VertexBounds reference(const Stream& stream) {
+      fast::VertexBounds bounds;
+      for (uint32_t c = 0; c < 3; c++) {
+        bounds.minPos[c] = FLT_MAX;
+        bounds.maxPos[c] = -FLT_MAX;
+      }
+      for (uint32_t c = 0; c < 4; c++) {
+        bounds.minColor[c] = 0xFF;
+        bounds.maxColor[c] = 0;
+      }
+
+      for (uint32_t i = 0; i < stream.count; i++) {
+        const float* position = reinterpret_cast<const float*>(&stream.positions[i * stream.positionStride]);
+        for (uint32_t c = 0; c < 3; c++) {
+          bounds.minPos[c] = std::min(bounds.minPos[c], position[c]);
+          bounds.maxPos[c] = std::max(bounds.maxPos[c], position[c]);
+        }
+
+        if (stream.pColors != nullptr) {
+          const uint8_t* color = stream.pColors + i * stream.colorStride;
+          for (uint32_t c = 0; c < 4; c++) {
+            bounds.minColor[c] = std::min(bounds.minColor[c], color[c]);
+            bounds.maxColor[c] = std::max(bounds.maxColor[c], color[c]);
+          }
+        }
+      }
+
+      return bounds;
+    }
+
+    static fast::VertexBounds compute(const Stream& stream) {
+      fast::VertexBounds bounds;
+      fast::computeVertexBounds(stream.positions.data(), stream.positionStride, stream.pColors, stream.colorStride, stream.count, bounds);
+      return bounds;
+    }
+
+    static bool equal(const fast::VertexBounds& a, const fast::VertexBounds& b) {
+      for (uint32_t c = 0; c < 3; c++) {
+        if (a.minPos[c] != b.minPos[c] || a.maxPos[c] != b.maxPos[c]) {
+          return false;
+        }
+      }
+      for (uint32_t c = 0; c < 4; c++) {
+        if (a.minColor[c] != b.minColor[c] || a.maxColor[c] != b.maxColor[c]) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    void testLayouts() {
+      std::mt19937 rng(1337);
+
+      const size_t strides[] = { 12, 16, 20, 24, 28, 32, 36, 44, 64 };
+      const uint32_t counts[] = { 0, 1, 2, 7, 8, 9, 31, 32, 33, 63, 64, 65, 100, 1001 };
+      const ColorLayout layouts[] = { ColorLayout::None, ColorLayout::Packed, ColorLayout::Interleaved, ColorLayout::Strided };
+
+      for (size_t stride : strides) {
+        for (ColorLayout layout : layouts) {
+          if (layout == ColorLayout::Interleaved && stride < 16) {
+            continue;
+          }
+
+          for (uint32_t count : counts) {
+            for (uint32_t iter = 0; iter < 4; iter++) {
+              const Stream stream = makeStream(rng, count, stride, layout);
+              check(equal(compute(stream), reference(stream)), "kernel disagrees with the scalar loop");
+            }
+          }
+        }
+      }
+
+      // Extremes in the first and last vertex, which the vector loop leaves to the scalar tail
+      for (size_t stride : strides) {
+        Stream stream = makeStream(rng, 257, stride, ColorLayout::Packed);
+        reinterpret_cast<float*>(stream.positions.data())[0] = -5000.f;
+        reinterpret_cast<float*>(&stream.positions[256 * stride])[2] = 5000.f;
+        stream.colors.back() = 0xFF;
+        stream.colors.front() = 0;
+
+        const fast::VertexBounds bounds = compute(stream);
+        check(bounds.minPos[0] == -5000.f && bounds.maxPos[2] == 5000.f, "first or last position missed");
+        check(bounds.minColor[0] == 0 && bounds.maxColor[3] == 0xFF, "first or last color missed");
+        check(equal(bounds, reference(stream)), "kernel disagrees with the scalar loop");
+      }
+
+      fast::VertexBounds empty;
+      fast::computeVertexBounds(nullptr, 12, nullptr, 4, 0, empty);
+      check(empty.minPos[0] == FLT_MAX && empty.maxPos[0] == -FLT_MAX, "empty stream bounds");
+      check(empty.minColor[3] == 0xFF && empty.maxColor[3] == 0, "empty stream colors");
+    }
+
+    // The custom blend detection only looks at the alpha byte
+    void testAlpha() {
+      std::mt19937 rng(42);
+
+      for (uint32_t count : { 1u, 8u, 40u, 333u }) {
+        for (uint32_t translucent = 0; translucent <= count; translucent++) {
+          Stream stream = makeStream(rng, count, 36, ColorLayout::Interleaved);
+          for (uint32_t i = 0; i < count; i++) {
+            stream.positions[i * 36 + 15] = i == translucent ? 0x80 : 0xFF;
+          }
+
+          const fast::VertexBounds bounds = compute(stream);
+          const bool fullyOpaque = translucent == count;
+          check((bounds.minColor[3] == 0xFF) == fullyOpaque, "alpha not detected");
+          check(bounds.maxColor[3] == (count == 1 && !fullyOpaque ? 0x80 : 0xFF), "alpha maximum");
+
+          if (count > 40) {
+            translucent += 17;
+          }
+        }
+      }
+
+      Stream stream = makeStream(rng, 100, 24, ColorLayout::None);
+      check(compute(stream).minColor[3] == 0xFF, "vertices without colors are not opaque");
+    }
+
+    void benchmark() {
+      std::mt19937 rng(7);
+      constexpr uint32_t numVertices = 1 << 20;
+      constexpr uint32_t numIterations = 20;
+      float sum = 0.f;
+
+      const std::pair<size_t, ColorLayout> cases[] = {
+        { 12, ColorLayout::Packed },
+        { 24, ColorLayout::Interleaved },
+        { 32, ColorLayout::Interleaved },
+        { 36, ColorLayout::Interleaved },
+        { 40, ColorLayout::Interleaved },
+      };
+
+      for (const auto& [stride, layout] : cases) {
+        const Stream stream = makeStream(rng, numVertices, stride, layout);
+        std::cout << "stride " << stride << (layout == ColorLayout::Packed ? ", packed colors" : ", interleaved colors")
+                  << ", " << numVertices << " vertices x" << numIterations << std::endl;
+        {
+          std::cout << "  scalar: ";
+          Timer timer;
+          for (uint32_t i = 0; i < numIterations; i++) {
+            sum += reference(stream).maxPos[0];
+          }
+        }
+        {
+          std::cout << "  kernel: ";
+          Timer timer;
+          for (uint32_t i = 0; i < numIterations; i++) {
+            sum += compute(stream).maxPos[0];
+          }
+        }
+      }
+
+      check(sum != 0.f, "benchmark optimized out");
+    }
+  };
+}
+
+int main() {
+  try {
+    dxvk::TestApp testApp;
+    testApp.run();
+  }
+  catch (const dxvk::DxvkError& error) {
+    std::cerr << error.message() << std::endl;
+    throw;
+  }
+
+  return 0;
+}